@@ -58,24 +58,23 @@ void example2_SerialProtocolParsing()
     
     const int FRAME_SIZE = 10;  // 假设协议帧长度为10字节
     
-    // 连接数据接收信号
-    QObject::connect(&serial, &DriverSerial::dataReceived, [&serial](const QByteArray &data) {
-        qInfo() << "接收到" << data.size() << "字节，读缓冲区总计:" << serial.bytesAvailable() << "字节";
+    // 设置定长分帧器（帧头0x7E同步，末尾8位和校验），读缓冲区由分帧器消费
+    SerialFixedLengthFramer *framer = new SerialFixedLengthFramer(FRAME_SIZE, QByteArray("\x7E", 1));
+    framer->setCrc(SerialFramer::CrcSum8);
+    serial.setFramer(framer);
+    
+    // 完整帧信号：帧视图直接指向读缓冲区，不拷贝
+    QObject::connect(&serial, &DriverSerial::frameReceived, [](const SerialFrameView &frame) {
+        qInfo() << "解析到完整帧:" << QByteArray::fromRawData(frame.data, frame.length).toHex(' ');
         
-        // 从读缓冲区提取完整帧
-        while (serial.bytesAvailable() >= FRAME_SIZE) {
-            QByteArray frame = serial.read(FRAME_SIZE);
-            qInfo() << "解析到完整帧:" << frame.toHex(' ');
-            
-            // 处理帧...
-        }
-        
-        // 剩余不完整的数据继续保留在缓冲区
-        if (serial.bytesAvailable() > 0) {
-            qInfo() << "剩余不完整数据:" << serial.bytesAvailable() << "字节，等待更多数据";
-        }
+        // 处理帧...需要保留数据时使用frame.toByteArray()
     });
     
+    // 半包自动等待后续数据，帧头前的垃圾数据和校验失败的帧自动丢弃
+    qInfo() << "已提取帧:" << framer->getFrameCount()
+            << "校验失败:" << framer->getCrcErrorCount()
+            << "丢弃字节:" << framer->getDiscardedBytes();
+    
     // 模拟数据接收...
 }
 
@@ -22,9 +22,11 @@
  *   - SPI (SPI总线)
  *   - Beep (蜂鸣器)
  *   - Temperature (温度传感器)
+ *   - CANModbus (CAN信号到Modbus寄存器的映射)
  *
  * History:
  *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 增加CANModbus映射配置节
  ***************************************************************/
 
 #ifndef HARDWARECONFIG_H
@@ -51,7 +53,8 @@ enum class HardwareType
     I2C,            // I2C总线
     SPI,            // SPI总线
     Beep,           // 蜂鸣器
-    Temperature     // 温度传感器
+    Temperature,    // 温度传感器
+    CANModbus       // CAN信号到Modbus寄存器的映射
 };
 
 /**
@@ -22,6 +22,7 @@
  *
  * History:
  *   1. 2025-10-15 创建文件，适配IMX6ULL项目
+ *   2. 2026-10-18 增加串口TCP桥服务
  ***************************************************************/
 
 #ifndef IMX6ULL_CORE_SERVICE_MANAGER_H
@@ -46,6 +47,7 @@ class ModbusSlaveService;
 class TimeService;
 class WeatherService;
 class AlarmService;
+class SerialBridgeService;
 
 /***************************************************************
  * 枚举: Enum_SysSvrTypeDef
@@ -68,6 +70,7 @@ enum Enum_SysSvrTypeDef {
     SYS_SVR_TYPE_NETWORK_SVR,           // 网络通信服务（预留）
     SYS_SVR_TYPE_STORAGE_SVR,           // 数据存储服务（预留）
     SYS_SVR_TYPE_DEBUG_SVR,             // 调试服务（预留）
+    SYS_SVR_TYPE_SERIAL_BRIDGE_SVR,     // 串口TCP桥服务
 };
 
 /***************************************************************
@@ -91,6 +94,7 @@ enum Enum_SysSvrIdDef {
     SYS_SVR_ID_NETWORK_SVR,             // 网络通信服务ID（预留）
     SYS_SVR_ID_STORAGE_SVR,             // 数据存储服务ID（预留）
     SYS_SVR_ID_DEBUG_SVR,               // 调试服务ID（预留）
+    SYS_SVR_ID_SERIAL_BRIDGE_SVR,       // 串口TCP桥服务ID
 };
 
 /***************************************************************
@@ -225,6 +229,12 @@ public:
      */
     AlarmService* GetAlarmSvrObj();
     
+    /**
+     * @brief 获取串口TCP桥服务对象
+     * @return SerialBridgeService* 返回串口桥服务指针
+     */
+    SerialBridgeService* GetSerialBridgeSvrObj();
+    
     // ========== 生命周期管理接口 ==========
     
     /**
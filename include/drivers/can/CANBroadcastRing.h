@@ -0,0 +1,243 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANBroadcastRing.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN接收帧多消费者广播环形缓冲区（Disruptor模型）
+ *
+ * 功能说明:
+ *   同一路CAN数据通常有多个独立消费者（日志、解码、网关、UI桥接），
+ *   通过信号分发时每个消费者都会得到一份拷贝。本环形缓冲区由接收线程
+ *   写入一次，每个消费者持有自己的读游标，直接在槽位上原地读取，
+ *   不产生任何按消费者的拷贝，分发开销与消费者数量无关。
+ *
+ * 设计要点:
+ *   - 单生产者（接收线程），多消费者，各自独立的序号游标
+ *   - 生产者以最慢消费者的游标为门限（gating），缓存门限值，
+ *     只有在接近套圈时才重新扫描各消费者游标，摊还O(1)
+ *   - 环满时不阻塞接收线程：丢弃新帧并计入溢出，同时记录
+ *     是哪个消费者拖慢了整个环（用于溢出诊断）
+ *   - 消费者批量处理后一次性提交游标，提交前槽位不会被覆盖
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_BROADCAST_RING_H
+#define IMX6ULL_DRIVERS_CAN_BROADCAST_RING_H
+
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInteger>
+#include <QCanBusFrame>
+
+/**
+ * @brief 环形缓冲区中的帧槽位（定长POD，避免QByteArray分配）
+ */
+struct CANRingEntry
+{
+    enum Flags {
+        ExtendedFormat = 0x01,      // 扩展帧（29位ID）
+        FlexibleDataRate = 0x02,    // CAN FD帧
+        BitrateSwitch = 0x04        // CAN FD速率切换
+    };
+
+    quint64 sequence;       // 全局序号
+    qint64 timestampUs;     // 接收时间戳（微秒）
+    quint32 frameId;        // 帧ID
+    quint8 frameType;       // QCanBusFrame::FrameType
+    quint8 flags;           // Flags组合
+    quint8 length;          // 数据长度（0-64）
+    quint8 reserved;
+    quint8 payload[64];     // 数据（CAN FD最多64字节）
+
+    bool isExtended() const { return (flags & ExtendedFormat) != 0; }
+
+    /**
+     * @brief 转换回QCanBusFrame（会分配payload，仅在需要时调用）
+     */
+    QCanBusFrame toFrame() const;
+
+    /**
+     * @brief 从QCanBusFrame填充槽位
+     */
+    void assign(const QCanBusFrame &frame);
+};
+
+/***************************************************************
+ * 类名: CANBroadcastRing
+ * 功能: 单生产者多消费者广播环形缓冲区
+ *
+ * 使用示例:
+ *   DriverCANHighPerf can("can0");
+ *   CANBroadcastRing *ring = can.enableBroadcastRing(4096);
+ *   int logger = ring->registerConsumer("logger");
+ *   can.open(500000);
+ *
+ *   // 在日志线程中
+ *   while (running) {
+ *       ring->waitForData(logger, 100);
+ *       ring->poll(logger, [](const CANRingEntry &e) {
+ *           writeLog(e.frameId, e.payload, e.length);
+ *       });
+ *   }
+ ***************************************************************/
+class CANBroadcastRing
+{
+public:
+    enum { MaxConsumers = 16 };
+
+    /**
+     * @brief 构造函数
+     * @param capacity 槽位数（向上取整为2的幂）
+     */
+    explicit CANBroadcastRing(int capacity = 4096);
+    ~CANBroadcastRing();
+
+    /**
+     * @brief 获取槽位数
+     */
+    int capacity() const { return static_cast<int>(m_mask + 1); }
+
+    // ========== 消费者管理 ==========
+
+    /**
+     * @brief 注册消费者，游标从当前写位置开始
+     * @param name 消费者名称（用于报告）
+     * @return 消费者ID，-1表示已达上限
+     */
+    int registerConsumer(const QString &name);
+
+    /**
+     * @brief 注销消费者（不再参与门限计算）
+     * @param consumerId 消费者ID
+     */
+    void unregisterConsumer(int consumerId);
+
+    // ========== 生产者（仅接收线程调用） ==========
+
+    /**
+     * @brief 发布一帧
+     * @param frame CAN帧
+     * @return true=已发布, false=环满（最慢消费者未跟上）已丢弃
+     */
+    bool publish(const QCanBusFrame &frame);
+
+    // ========== 消费者（各自线程调用） ==========
+
+    /**
+     * @brief 原地处理可读帧并提交游标
+     * @param consumerId 消费者ID
+     * @param handler 处理函数，签名 void(const CANRingEntry &)
+     * @param maxBatch 单次最多处理帧数
+     * @return 本次处理的帧数
+     * @note handler中拿到的是槽位引用，返回后槽位可能被覆盖，不要保存指针
+     */
+    template<typename Handler>
+    int poll(int consumerId, Handler handler, int maxBatch = 256)
+    {
+        if (consumerId < 0 || consumerId >= MaxConsumers ||
+            m_consumers[consumerId].active.loadAcquire() == 0) {
+            return 0;
+        }
+
+        ConsumerSlot &consumer = m_consumers[consumerId];
+        quint64 cursor = consumer.cursor.load();
+        quint64 available = m_published.loadAcquire();
+        quint64 end = qMin(available, cursor + static_cast<quint64>(maxBatch));
+
+        for (quint64 seq = cursor; seq < end; ++seq) {
+            handler(static_cast<const CANRingEntry &>(m_slots[seq & m_mask]));
+        }
+
+        // 批量提交，提交前生产者不会覆盖这些槽位
+        consumer.cursor.storeRelease(end);
+        return static_cast<int>(end - cursor);
+    }
+
+    /**
+     * @brief 等待新数据
+     * @param consumerId 消费者ID
+     * @param msecs 超时（毫秒）
+     * @return true=有可读数据, false=超时
+     */
+    bool waitForData(int consumerId, unsigned long msecs);
+
+    /**
+     * @brief 唤醒所有等待中的消费者（用于退出）
+     */
+    void wakeAll();
+
+    // ========== 统计 ==========
+
+    /**
+     * @brief 消费者落后的帧数
+     */
+    quint64 getLag(int consumerId) const;
+
+    /**
+     * @brief 已发布帧总数
+     */
+    quint64 getPublishedCount() const { return m_published.loadAcquire(); }
+
+    /**
+     * @brief 环满丢弃的帧数
+     */
+    quint64 getOverrunCount() const { return m_overruns.loadAcquire(); }
+
+    /**
+     * @brief 最近一次环满时拖慢环的消费者ID，-1表示从未溢出
+     */
+    int getSlowestConsumer() const { return m_slowestConsumer.loadAcquire(); }
+
+    /**
+     * @brief 获取消费者名称
+     */
+    QString getConsumerName(int consumerId) const;
+
+    /**
+     * @brief 生成广播环状态报告
+     */
+    QString generateReport() const;
+
+private:
+    /**
+     * @brief 消费者槽位（填充到缓存行，避免伪共享）
+     */
+    struct ConsumerSlot {
+        QAtomicInteger<quint64> cursor;     // 下一个要读的序号
+        QAtomicInt active;                  // 是否已注册
+        char padding[64 - sizeof(QAtomicInteger<quint64>) - sizeof(QAtomicInt)];
+    };
+
+    /**
+     * @brief 重新计算最慢消费者游标（仅生产者在接近套圈时调用）
+     * @param sequence 当前写序号
+     * @return 最慢游标，无消费者时返回sequence
+     */
+    quint64 computeGatingSequence(quint64 sequence);
+
+    QVector<CANRingEntry> m_entries;        // 槽位存储
+    CANRingEntry *m_slots;                  // 槽位数组（避免QVector分离检查）
+    quint64 m_mask;                         // 序号掩码（capacity-1）
+
+    QAtomicInteger<quint64> m_published;    // 已发布序号（下一个写位置）
+    quint64 m_cachedGate;                   // 缓存的门限序号（仅生产者访问）
+    int m_cachedEpoch;                      // 缓存门限时的消费者集合版本（仅生产者访问）
+    QAtomicInt m_consumerEpoch;             // 消费者集合版本（注册/注销时递增）
+    QAtomicInteger<quint64> m_overruns;     // 环满丢弃计数
+    QAtomicInt m_slowestConsumer;           // 最近一次溢出时最慢的消费者
+
+    ConsumerSlot m_consumers[MaxConsumers]; // 消费者游标
+    QString m_consumerNames[MaxConsumers];  // 消费者名称
+    mutable QMutex m_registerMutex;         // 注册/注销锁
+
+    QMutex m_waitMutex;                     // 等待锁
+    QWaitCondition m_dataReady;             // 新数据条件变量
+    QAtomicInt m_waiters;                   // 等待中的消费者数
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_BROADCAST_RING_H
@@ -0,0 +1,286 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANBusMonitor.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN控制器错误状态与错误计数器监测
+ *
+ * 功能说明:
+ *   QCanBusDevice::errorOccurred只给出错误字符串，看不到TEC/REC计数、
+ *   错误被动切换和总线关闭，往往要等到通信中断才发现问题。
+ *   本监测器：
+ *   - 在接收套接字上订阅CAN错误帧（CAN_ERR_MASK），事件驱动，无轮询
+ *   - 按需通过rtnetlink读取控制器状态、TEC/REC和设备错误统计
+ *   - 发布结构化的总线健康事件（告警/被动/总线关闭/恢复等）
+ *   - 总线关闭后按指数退避自动重启控制器
+ *
+ * 错误状态（ISO 11898）:
+ *   - 主动错误: TEC/REC < 96
+ *   - 错误告警: TEC/REC >= 96
+ *   - 被动错误: TEC/REC >= 128
+ *   - 总线关闭: TEC >= 256
+ *
+ * 注意:
+ *   重启控制器需要CAP_NET_ADMIN权限；若内核已配置restart-ms，
+ *   由内核自动重启，本监测器不再重复重启
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_BUS_MONITOR_H
+#define IMX6ULL_DRIVERS_CAN_BUS_MONITOR_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <QCanBusFrame>
+
+/**
+ * @brief 控制器状态快照（rtnetlink读取）
+ */
+struct CANControllerStatus
+{
+    int state;                  // CANBusMonitor::BusState
+    quint16 txErrorCount;       // TEC
+    quint16 rxErrorCount;       // REC
+    quint32 bitrate;            // 当前波特率
+    quint32 restartMs;          // 内核自动重启间隔（0=不自动重启）
+    quint32 busErrors;          // 总线错误次数（内核统计）
+    quint32 errorWarning;       // 进入错误告警次数
+    quint32 errorPassive;       // 进入被动错误次数
+    quint32 busOff;             // 总线关闭次数
+    quint32 arbitrationLost;    // 仲裁丢失次数
+    quint32 restarts;           // 控制器重启次数
+
+    CANControllerStatus()
+        : state(0), txErrorCount(0), rxErrorCount(0), bitrate(0), restartMs(0)
+        , busErrors(0), errorWarning(0), errorPassive(0), busOff(0)
+        , arbitrationLost(0), restarts(0)
+    {
+    }
+};
+
+/**
+ * @brief 总线健康事件
+ */
+struct CANBusHealthEvent
+{
+    enum Type {
+        StateChanged = 0,       // 错误状态变化
+        BusOff,                 // 总线关闭
+        Restarted,              // 控制器已重启
+        RestartScheduled,       // 已安排自动重启
+        RestartFailed,          // 自动重启失败
+        ProtocolError,          // 协议错误（位/填充/格式/CRC）
+        AckMissing,             // 无应答（总线上无其他节点）
+        ArbitrationLost,        // 仲裁丢失
+        ControllerOverflow,     // 控制器收发缓冲溢出
+        TxTimeout,              // 发送超时
+        TransceiverError        // 收发器错误（断线/短路）
+    };
+
+    Type type;                  // 事件类型
+    int state;                  // 事件发生后的总线状态
+    int previousState;          // 事件发生前的总线状态
+    quint16 txErrorCount;       // TEC（错误帧未携带计数时为最近已知值）
+    quint16 rxErrorCount;       // REC
+    quint32 errorClass;         // 错误帧类别（CAN_ERR_*）
+    qint64 timestampUs;         // 事件时间戳（微秒）
+    QString detail;             // 描述
+
+    CANBusHealthEvent()
+        : type(StateChanged), state(0), previousState(0)
+        , txErrorCount(0), rxErrorCount(0), errorClass(0), timestampUs(0)
+    {
+    }
+};
+
+Q_DECLARE_METATYPE(CANBusHealthEvent)
+
+/***************************************************************
+ * 类名: CANBusMonitor
+ * 功能: CAN总线健康监测与总线关闭自动恢复
+ *
+ * 使用示例:
+ *   DriverCAN can("can0");
+ *   CANBusMonitor *monitor = can.enableBusMonitor();
+ *   monitor->setRestartBackoff(100, 5000);
+ *   connect(monitor, &CANBusMonitor::busHealthEvent,
+ *           [](const CANBusHealthEvent &e) { qWarning() << e.detail; });
+ *   can.open(500000);
+ *
+ *   CANControllerStatus status;
+ *   if (monitor->readControllerStatus(status)) {
+ *       qInfo() << "TEC" << status.txErrorCount << "REC" << status.rxErrorCount;
+ *   }
+ ***************************************************************/
+class CANBusMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 总线错误状态（与内核enum can_state一致）
+     */
+    enum BusState {
+        ErrorActive = 0,        // 主动错误（正常）
+        ErrorWarning = 1,       // 错误告警
+        ErrorPassive = 2,       // 被动错误
+        BusOffState = 3,        // 总线关闭
+        Stopped = 4,            // 控制器停止
+        Sleeping = 5            // 控制器休眠
+    };
+    Q_ENUM(BusState)
+
+    /**
+     * @brief 构造函数
+     * @param interfaceName CAN接口名称
+     * @param parent 父对象指针
+     */
+    explicit CANBusMonitor(const QString &interfaceName, QObject *parent = nullptr);
+    ~CANBusMonitor();
+
+    // ========== 控制器状态 ==========
+
+    /**
+     * @brief 通过rtnetlink读取控制器状态与计数
+     * @param status 输出状态
+     * @return true=成功, false=失败
+     */
+    bool readControllerStatus(CANControllerStatus &status);
+
+    /**
+     * @brief 通过rtnetlink重启控制器（仅总线关闭时有效）
+     * @return true=成功, false=失败
+     */
+    bool restartController();
+
+    /**
+     * @brief 当前总线状态
+     */
+    BusState getState() const { return m_state; }
+
+    /**
+     * @brief 最近已知的TEC/REC
+     */
+    quint16 getTxErrorCount() const { return m_txErrorCount; }
+    quint16 getRxErrorCount() const { return m_rxErrorCount; }
+
+    // ========== 自动重启 ==========
+
+    /**
+     * @brief 启用/禁用总线关闭后自动重启
+     */
+    void setAutoRestart(bool enable);
+    bool isAutoRestart() const { return m_autoRestart; }
+
+    /**
+     * @brief 设置自动重启退避参数
+     * @param initialMs 首次重启延时（毫秒）
+     * @param maxMs 最大重启延时（毫秒），每次失败或短时间内再次总线关闭时翻倍
+     */
+    void setRestartBackoff(int initialMs, int maxMs);
+
+    /**
+     * @brief 设置稳定窗口：重启后保持该时长无总线关闭则退避复位
+     * @param msecs 稳定时长（毫秒）
+     */
+    void setStableWindow(int msecs) { m_stableWindowMs = qMax(0, msecs); }
+
+    // ========== 统计 ==========
+
+    quint64 getBusOffCount() const { return m_busOffCount; }
+    quint64 getProtocolErrorCount() const { return m_protocolErrors; }
+    quint64 getAckErrorCount() const { return m_ackErrors; }
+    quint64 getArbitrationLostCount() const { return m_arbitrationLost; }
+    quint64 getRestartCount() const { return m_restartCount; }
+
+    /**
+     * @brief 生成总线健康报告（含一次rtnetlink读取）
+     * @return 报告字符串
+     */
+    QString generateReport();
+
+    /**
+     * @brief 状态转字符串
+     */
+    static QString stateToString(int state);
+
+    /**
+     * @brief 事件类型转字符串
+     */
+    static QString eventTypeToString(int type);
+
+signals:
+    /**
+     * @brief 总线健康事件
+     * @param event 事件
+     */
+    void busHealthEvent(const CANBusHealthEvent &event);
+
+    /**
+     * @brief 总线状态变化
+     * @param state 新状态
+     * @param previous 旧状态
+     */
+    void busStateChanged(int state, int previous);
+
+public slots:
+    /**
+     * @brief 处理CAN错误帧（由接收路径调用）
+     * @param frame 错误帧
+     */
+    void processErrorFrame(const QCanBusFrame &frame);
+
+private slots:
+    void onRestartTimer();
+
+private:
+    /**
+     * @brief 切换状态并发布事件
+     */
+    void updateState(BusState newState, const CANBusHealthEvent &base);
+
+    /**
+     * @brief 发布事件
+     */
+    void publish(CANBusHealthEvent::Type type, const CANBusHealthEvent &base,
+                 const QString &detail);
+
+    /**
+     * @brief 安排下一次自动重启
+     */
+    void scheduleRestart();
+
+    /**
+     * @brief 由TEC/REC推导错误状态
+     */
+    static BusState stateFromCounters(quint16 tec, quint16 rec);
+
+    QString m_interfaceName;        // CAN接口名称
+    BusState m_state;               // 当前状态
+    quint16 m_txErrorCount;         // 最近已知TEC
+    quint16 m_rxErrorCount;         // 最近已知REC
+
+    bool m_autoRestart;             // 是否自动重启
+    int m_initialBackoffMs;         // 首次重启延时
+    int m_maxBackoffMs;             // 最大重启延时
+    int m_currentBackoffMs;         // 当前重启延时
+    int m_stableWindowMs;           // 退避复位所需稳定时长
+    QTimer *m_restartTimer;         // 重启定时器
+    QElapsedTimer m_sinceRestart;   // 距上次重启
+
+    quint64 m_busOffCount;          // 总线关闭次数
+    quint64 m_protocolErrors;       // 协议错误次数
+    quint64 m_ackErrors;            // 无应答次数
+    quint64 m_arbitrationLost;      // 仲裁丢失次数
+    quint64 m_overflows;            // 控制器溢出次数
+    quint64 m_txTimeouts;           // 发送超时次数
+    quint64 m_restartCount;         // 自动重启次数
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_BUS_MONITOR_H
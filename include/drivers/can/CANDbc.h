@@ -0,0 +1,197 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANDbc.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: DBC解码规则（报文/信号定义，含J1939 PGN匹配）
+ *
+ * 功能说明:
+ *   解析DBC文件中的BO_/SG_定义，编译为按ID索引的解码表，
+ *   位域提取使用CANSignalExtractor，与设备端CANModbusBridge一致。
+ *   - 支持intel/motorola字节序、有符号、factor/offset、单位
+ *   - 支持简单多路复用（M / mN）
+ *   - J1939: 报文的VFrameFormat属性为J1939PG，或启用setJ1939()时
+ *     所有扩展帧报文按PGN匹配（忽略优先级、源地址，PDU1忽略目的地址）
+ *
+ * 不支持:
+ *   超过32位的信号、扩展多路复用（SG_MUL_VAL_）、信号值表（VAL_）、
+ *   浮点信号（SIG_VALTYPE_）
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_DBC_H
+#define IMX6ULL_DRIVERS_CAN_DBC_H
+
+#include "drivers/can/CANSignal.h"
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+/***************************************************************
+ * 类名: CANDbcDatabase
+ * 功能: DBC解码规则
+ *
+ * 使用示例:
+ *   CANDbcDatabase dbc;
+ *   if (dbc.loadFile("vehicle.dbc")) {
+ *       dbc.compile();
+ *       dbc.decode(id, extended, padded, length, [](int signal, double value) {
+ *           ...
+ *       });
+ *   }
+ *
+ * 线程安全:
+ *   compile()之后只读，decode()可在多个线程中并发调用
+ ***************************************************************/
+class CANDbcDatabase
+{
+public:
+    /**
+     * @brief 信号定义
+     */
+    struct Signal
+    {
+        QString name;                   // 信号名
+        QString unit;                   // 单位
+        int message;                    // 所属报文序号
+        int startBit;                   // 起始位（DBC编号）
+        int length;                     // 位长度
+        bool motorola;                  // 大端（@0）
+        bool isSigned;                  // 有符号（-）
+        double factor;                  // 增益
+        double offset;                  // 偏移
+        bool multiplexor;               // 多路复用选择信号（M）
+        int muxValue;                   // 多路复用值（mN），-1表示不受复用控制
+        CANSignalExtractor extractor;   // 编译后的提取指令
+    };
+
+    /**
+     * @brief 报文定义
+     */
+    struct Message
+    {
+        QString name;                   // 报文名
+        quint32 canId;                  // CAN ID（不含扩展标志）
+        bool extended;                  // 扩展帧
+        int dlc;                        // 数据长度
+        bool j1939;                     // 按PGN匹配
+        int muxSignal;                  // 多路复用选择信号序号，-1表示无
+        QVector<int> signalIndexes;     // 信号序号
+    };
+
+    CANDbcDatabase();
+
+    /**
+     * @brief 从文件加载
+     * @return true=成功, false=失败（见getLastError）
+     */
+    bool loadFile(const QString &path);
+
+    /**
+     * @brief 解析DBC文本
+     */
+    bool parse(const QString &text);
+
+    /**
+     * @brief 所有扩展帧报文按J1939 PGN匹配
+     */
+    void setJ1939(bool enabled) { m_forceJ1939 = enabled; }
+
+    /**
+     * @brief 编译解码表（parse之后、decode之前调用）
+     * @return true=成功, false=没有可解码的信号（无效信号单独跳过）
+     */
+    bool compile();
+
+    const QVector<Message>& messages() const { return m_messages; }
+    const QVector<Signal>& signalList() const { return m_signals; }
+    QString getLastError() const { return m_lastError; }
+
+    /**
+     * @brief 计算J1939 PGN
+     */
+    static quint32 j1939Pgn(quint32 canId)
+    {
+        quint32 pf = (canId >> 16) & 0xFF;
+        return (pf < 240) ? ((canId >> 8) & 0x3FF00) : ((canId >> 8) & 0x3FFFF);
+    }
+
+    /**
+     * @brief 查找帧对应的报文
+     * @return 报文序号，-1表示不在DBC中
+     */
+    int findMessage(quint32 canId, bool extended) const
+    {
+        QHash<quint32, int>::const_iterator it = m_idIndex.constFind(makeKey(canId, extended));
+        if (it != m_idIndex.constEnd()) {
+            return it.value();
+        }
+        if (extended && !m_pgnIndex.isEmpty()) {
+            it = m_pgnIndex.constFind(j1939Pgn(canId));
+            if (it != m_pgnIndex.constEnd()) {
+                return it.value();
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief 解码一帧
+     * @param payload 带CAN_SIGNAL_PAD_BYTES余量的载荷缓冲区
+     * @param length 实际数据长度
+     * @param handler 回调handler(int signalIndex, double physicalValue)
+     * @return 解码的信号数
+     */
+    template<typename Handler>
+    int decode(quint32 canId, bool extended, const uchar *payload, int length,
+               Handler handler) const
+    {
+        int index = findMessage(canId, extended);
+        if (index < 0) {
+            return 0;
+        }
+
+        const Message &message = m_messages.at(index);
+        int muxValue = -1;
+        if (message.muxSignal >= 0) {
+            const Signal &mux = m_signals.at(message.muxSignal);
+            if (length >= mux.extractor.minLength) {
+                muxValue = static_cast<int>(mux.extractor.extractRaw(payload));
+            }
+        }
+
+        int count = 0;
+        for (int signalIndex : message.signalIndexes) {
+            const Signal &sig = m_signals.at(signalIndex);
+            if (length < sig.extractor.minLength) {
+                continue;
+            }
+            if (sig.muxValue >= 0 && sig.muxValue != muxValue) {
+                continue;
+            }
+            double value = double(sig.extractor.extractRaw(payload)) * sig.factor + sig.offset;
+            handler(signalIndex, value);
+            count++;
+        }
+        return count;
+    }
+
+private:
+    static quint32 makeKey(quint32 canId, bool extended)
+    {
+        return extended ? (canId | 0x80000000U) : canId;
+    }
+
+    QVector<Message> m_messages;        // 报文
+    QVector<Signal> m_signals;          // 信号
+    QHash<quint32, int> m_idIndex;      // 完整ID → 报文
+    QHash<quint32, int> m_pgnIndex;     // PGN → 报文（J1939）
+    QHash<quint32, bool> m_j1939Ids;    // VFrameFormat=J1939PG的报文ID
+    bool m_forceJ1939;                  // 所有扩展帧按PGN匹配
+    QString m_lastError;                // 最后错误
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_DBC_H
@@ -0,0 +1,51 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANFrameListener.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN接收路径监听接口
+ *
+ * 功能说明:
+ *   frameReceived信号每帧一次，跨线程时还要排队，高帧率下只为更新
+ *   几个数值就付出一次事件分发的代价。实现本接口并通过
+ *   DriverCAN::setFrameListener()挂接后，每个有效数据帧在接收路径中
+ *   被同步回调，不经过Qt事件循环
+ *
+ * 注意:
+ *   - DriverCANHighPerf在接收线程中回调，DriverCAN在所属线程中回调
+ *   - 回调内不要阻塞，也不要调用驱动的发送接口以外的非线程安全方法
+ *   - 取下保证: setFrameListener(nullptr)（或换成其他监听器）返回时，
+ *     旧监听器的回调都已结束且不会再被调用，之后即可释放旧监听器及其
+ *     引用的对象。DriverCANHighPerf在回调期间持有接收线程的监听器锁，
+ *     替换时等待该锁；DriverCAN在所属线程中回调，同线程替换天然有序
+ *     （须在驱动所属线程调用）
+ *   - 回调内调用setFrameListener只替换指针，不等待（当前回调仍在执行）
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 明确取下监听器时的回调结束保证
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_FRAME_LISTENER_H
+#define IMX6ULL_DRIVERS_CAN_FRAME_LISTENER_H
+
+#include <QCanBusFrame>
+
+/***************************************************************
+ * 类名: CANFrameListener
+ * 功能: 接收路径同步回调接口
+ ***************************************************************/
+class CANFrameListener
+{
+public:
+    virtual ~CANFrameListener() {}
+
+    /**
+     * @brief 收到有效帧（已通过载荷过滤，不含错误帧和本地回显）
+     * @param frame 接收到的帧
+     */
+    virtual void canFrameReceived(const QCanBusFrame &frame) = 0;
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_FRAME_LISTENER_H
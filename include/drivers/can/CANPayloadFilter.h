@@ -0,0 +1,202 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANPayloadFilter.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN载荷过滤器 - 声明式规则编译为内核BPF程序
+ *
+ * 功能说明:
+ *   ID/掩码过滤（CAN_RAW_FILTER）无法按载荷字节判断，例如多路复用帧
+ *   由第0字节选择子报文，不需要的子报文也会全部进入用户空间再丢弃。
+ *   本过滤器把简单的声明式规则编译为经典BPF程序，通过SO_ATTACH_FILTER
+ *   挂到CAN原始套接字上，在内核中丢弃不需要的帧。
+ *
+ * 规则语法:
+ *   - 多条规则用"|"分隔，满足任意一条即接收
+ *   - 一条规则内多个条件用空格分隔，全部满足才算匹配
+ *   - 条件:
+ *       id=<值>[/<掩码>]        ID匹配（值>0x7FF时默认扩展帧，否则标准帧）
+ *       ext / std               扩展帧 / 标准帧
+ *       rtr / data              远程帧 / 数据帧
+ *       dlc=<n> dlc>=<n> dlc<=<n>   数据长度
+ *       byte<N>=<值>[/<掩码>]    第N个数据字节（N=0~7）
+ *       byte<N>!=<值>[/<掩码>]   第N个数据字节不等于
+ *   - 数值支持十进制和0x十六进制
+ *   - 不要使用逗号（hardware.init中逗号会被解析为列表，容错处理为空格）
+ *
+ *   示例（只接收0x100的子报文1和3，以及所有0x200帧）:
+ *     id=0x100 byte0=0x01 | id=0x100 byte0=0x03 | id=0x200
+ *
+ * 固定行为:
+ *   - 本套接字的回显帧总是接收，发送调度器依赖回显
+ *   - 本机其他套接字发送的帧（PACKET_LOOPBACK）与总线帧一样按规则过滤。
+ *     内核中无法区分本套接字的回显与其他套接字的回环帧（vcan上echo=0时
+ *     全部帧都是回环帧），BPF程序放行全部回环帧，由accept()在接收路径
+ *     中对非回显帧再按规则判断一次，内核过滤与用户空间过滤结果一致
+ *   - 错误帧按passErrorFrames决定，默认接收（总线监测器依赖错误帧）
+ *   - 超出DLC的数据字节取can_frame中的填充值（通常为0），需要时配合dlc条件使用
+ *
+ * 注意:
+ *   QCanBusDevice不公开套接字，本过滤器通过socketcan插件内部的
+ *   QSocketNotifier获取描述符；无法获取时（如虚拟总线）退化为
+ *   在接收路径中按同样的规则过滤
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 内核过滤时回环帧在接收路径按规则再判断，与用户空间过滤一致
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_PAYLOAD_FILTER_H
+#define IMX6ULL_DRIVERS_CAN_PAYLOAD_FILTER_H
+
+#include <QString>
+#include <QVector>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QCanBusDevice>
+#include <QCanBusFrame>
+
+/***************************************************************
+ * 类名: CANPayloadFilter
+ * 功能: 声明式CAN载荷过滤规则的解析、BPF编译与挂载
+ *
+ * 使用示例:
+ *   DriverCANHighPerf can("can0");
+ *   can.setPayloadFilter("id=0x100 byte0=0x01 | id=0x200");
+ *   can.open(500000);      // 打开后自动挂载到接收套接字
+ *
+ * 线程安全:
+ *   accept()可在接收线程中调用，setRules()可在任意线程调用
+ ***************************************************************/
+class CANPayloadFilter
+{
+public:
+    /**
+     * @brief 过滤位置
+     */
+    enum Mode {
+        Disabled = 0,       // 无规则，全部接收
+        Kernel,             // BPF已挂载到套接字，内核过滤
+        UserSpace           // 无法挂载，在接收路径中过滤
+    };
+
+    CANPayloadFilter();
+
+    /**
+     * @brief 解析并编译规则
+     * @param rules 规则文本，空字符串表示清除
+     * @param passErrorFrames 是否接收错误帧
+     * @param errorMessage 解析失败时的错误描述（可为nullptr）
+     * @return true=成功, false=语法错误（原规则保持不变）
+     */
+    bool setRules(const QString &rules, bool passErrorFrames = true,
+                  QString *errorMessage = nullptr);
+
+    /**
+     * @brief 清除规则
+     */
+    void clear();
+
+    QString rules() const;
+    bool isEmpty() const;
+    int instructionCount() const;
+
+    // ========== 挂载 ==========
+
+    /**
+     * @brief 把当前程序挂载到套接字（无规则时卸载）
+     * @param fd CAN原始套接字描述符，<0表示无法获取
+     * @return true=内核过滤或无需过滤, false=退化为用户空间过滤
+     */
+    bool attach(int fd);
+
+    /**
+     * @brief 套接字已关闭，回到未挂载状态
+     */
+    void detached();
+
+    Mode getMode() const { return static_cast<Mode>(m_mode.load()); }
+
+    /**
+     * @brief 接收路径过滤判断（无规则或本套接字回显帧直接返回true）
+     * @param frame 接收到的帧
+     * @return true=接收, false=丢弃
+     * @note 内核过滤时同样要调用: BPF放行的回环帧在这里按规则判断
+     *       （已通过BPF的总线帧必然匹配，只多一次规则比较）
+     */
+    bool accept(const QCanBusFrame &frame) const;
+
+    /**
+     * @brief 接收路径丢弃的帧数（内核丢弃的帧不可见）
+     */
+    quint64 getFilteredCount() const { return m_filteredCount.load(); }
+
+    /**
+     * @brief 反汇编BPF程序（调试用）
+     */
+    QString dumpProgram() const;
+
+    /**
+     * @brief 获取socketcan设备的套接字描述符
+     * @param device CAN设备
+     * @return 描述符，无法获取返回-1
+     */
+    static int socketDescriptor(QCanBusDevice *device);
+
+private:
+    /**
+     * @brief 单个条件
+     */
+    struct Condition
+    {
+        enum Field { Dlc, Byte };
+        enum Op { Eq, Ne, Ge, Le };
+
+        Field field;
+        Op op;
+        int index;          // 字节序号（Byte）
+        quint8 value;
+        quint8 mask;
+    };
+
+    /**
+     * @brief 一条规则（条件的与）
+     */
+    struct Rule
+    {
+        quint32 idValue;    // can_id比较值（含EFF/RTR标志位）
+        quint32 idMask;     // can_id掩码，0表示不比较
+        QVector<Condition> conditions;
+    };
+
+    /**
+     * @brief BPF指令（与struct sock_filter布局一致）
+     */
+    struct Instruction
+    {
+        quint16 code;
+        quint8 jt;
+        quint8 jf;
+        quint32 k;
+    };
+
+    static bool parseRule(const QString &text, Rule &rule, QString *errorMessage);
+    static bool parseNumber(const QString &text, quint32 &value);
+    static bool compile(const QVector<Rule> &rules, bool passErrorFrames,
+                        QVector<Instruction> &program, QString *errorMessage);
+    static bool matchRule(const Rule &rule, quint32 canId, const QByteArray &payload);
+
+    mutable QReadWriteLock m_lock;      // 保护规则与程序
+    QString m_text;                     // 规则原文
+    QVector<Rule> m_rules;              // 解析后的规则
+    QVector<Instruction> m_program;     // 编译后的BPF程序
+    bool m_passErrorFrames;             // 是否接收错误帧
+
+    QAtomicInt m_mode;                  // 当前过滤位置（Mode）
+    int m_attachedFd;                   // 已挂载的套接字
+    mutable QAtomicInteger<quint64> m_filteredCount;  // 接收路径丢弃计数
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_PAYLOAD_FILTER_H
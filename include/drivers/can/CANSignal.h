@@ -0,0 +1,95 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANSignal.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN信号位域提取（设备端与离线解码共用）
+ *
+ * 功能说明:
+ *   把DBC风格的信号定义（起始位、长度、字节序、符号）编译为
+ *   固定的提取指令：从载荷的某个字节开始装载8字节窗口，移位、掩码、
+ *   符号扩展。CANModbusBridge（设备端）和离线解码工具使用同一套指令，
+ *   保证两边解出的数值一致。
+ *
+ * 信号定义（与DBC一致）:
+ *   - intel（小端，@1）: startBit为最低位的位号
+ *   - motorola（大端，@0）: startBit为最高位的位号（DBC锯齿编号）
+ *
+ * 注意:
+ *   extractRaw()固定读取8字节窗口，调用者需保证
+ *   payload + byteOffset之后至少有8字节可读（用CAN_SIGNAL_PAD_BYTES余量）
+ *
+ * History:
+ *   1. 2026-10-18 创建文件（从CANModbusBridge中提取）
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_SIGNAL_H
+#define IMX6ULL_DRIVERS_CAN_SIGNAL_H
+
+#include <QtGlobal>
+#include <QString>
+
+#define CAN_SIGNAL_MAX_PAYLOAD      64      // CAN FD最大数据长度
+#define CAN_SIGNAL_PAD_BYTES        8       // 8字节窗口所需的缓冲区余量
+
+/***************************************************************
+ * 结构名: CANSignalExtractor
+ * 功能: 编译后的信号提取指令
+ ***************************************************************/
+struct CANSignalExtractor
+{
+    quint8 byteOffset;      // 读取窗口起始字节
+    quint8 minLength;       // 帧至少需要的字节数
+    quint8 shift;           // 窗口内最低位的位置
+    quint8 length;          // 位长度
+    bool motorola;          // 窗口按大端装载
+    bool isSigned;          // 符号扩展
+    quint32 mask;           // 位掩码
+
+    CANSignalExtractor()
+        : byteOffset(0), minLength(0), shift(0), length(0)
+        , motorola(false), isSigned(false), mask(0)
+    {
+    }
+
+    /**
+     * @brief 编译信号定义
+     * @param startBit 起始位（含义见文件头）
+     * @param length 位长度（1~32）
+     * @param motorola 大端
+     * @param isSigned 有符号
+     * @param errorMessage 失败时的错误描述（可为nullptr）
+     * @return true=成功, false=定义超出64字节载荷或长度无效
+     */
+    bool compile(int startBit, int length, bool motorola, bool isSigned,
+                 QString *errorMessage = nullptr);
+
+    /**
+     * @brief 提取原始值（已做符号扩展）
+     * @param payload 带CAN_SIGNAL_PAD_BYTES余量的载荷缓冲区
+     */
+    qint64 extractRaw(const uchar *payload) const
+    {
+        const uchar *window = payload + byteOffset;
+        quint64 word = 0;
+        if (motorola) {
+            for (int i = 0; i < 8; i++) {
+                word = (word << 8) | window[i];
+            }
+        } else {
+            for (int i = 7; i >= 0; i--) {
+                word = (word << 8) | window[i];
+            }
+        }
+
+        quint32 raw = static_cast<quint32>(word >> shift) & mask;
+        qint64 value = raw;
+        if (isSigned && (raw & (1U << (length - 1)))) {
+            value -= (Q_INT64_C(1) << length);
+        }
+        return value;
+    }
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_SIGNAL_H
@@ -0,0 +1,174 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTimingAnalyzer.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN总线按ID的周期与抖动分析器
+ *
+ * 功能说明:
+ *   常驻接收路径，对每个CAN ID增量统计：
+ *   - EWMA周期、EWMA抖动
+ *   - 最小/最大帧间隔
+ *   - 丢帧估计（间隔超过1.5倍周期时按周期折算丢失帧数）
+ *   - DLC变化次数、最后一次接收距今时间
+ *
+ * 性能设计:
+ *   - 定长开放寻址哈希表，运行期不分配内存
+ *   - 每帧O(1)更新，全部整数运算（EWMA使用移位实现）
+ *   - 适合在满负载总线上长期开启
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_TIMING_ANALYZER_H
+#define IMX6ULL_DRIVERS_CAN_TIMING_ANALYZER_H
+
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QCanBusFrame>
+
+/**
+ * @brief 单个CAN ID的时序统计快照
+ */
+struct CANIdTimingStats
+{
+    quint32 frameId;            // 帧ID
+    bool extended;              // 是否扩展帧
+    quint64 frameCount;         // 接收帧数
+    qint64 periodUs;            // EWMA周期（微秒）
+    qint64 jitterUs;            // EWMA抖动（微秒，|间隔-周期|的平均）
+    qint64 minIntervalUs;       // 最小帧间隔（微秒）
+    qint64 maxIntervalUs;       // 最大帧间隔（微秒）
+    quint64 missingCount;       // 估计丢失帧数
+    quint8 lastDlc;             // 最近一帧DLC
+    quint32 dlcChanges;         // DLC变化次数
+    qint64 lastSeenAgeUs;       // 最后一次接收距快照时刻（微秒）
+
+    CANIdTimingStats()
+        : frameId(0), extended(false), frameCount(0)
+        , periodUs(0), jitterUs(0), minIntervalUs(0), maxIntervalUs(0)
+        , missingCount(0), lastDlc(0), dlcChanges(0), lastSeenAgeUs(0)
+    {
+    }
+};
+
+/***************************************************************
+ * 类名: CANTimingAnalyzer
+ * 功能: 按ID统计周期、抖动、丢帧与DLC变化
+ *
+ * 使用示例:
+ *   DriverCANHighPerf can("can0");
+ *   can.enableTimingAnalyzer();
+ *   can.open(500000);
+ *   ...
+ *   CANTimingAnalyzer *analyzer = can.getTimingAnalyzer();
+ *   qInfo().noquote() << analyzer->generateReport();
+ *   CANIdTimingStats s = analyzer->getStats(0x18FEF100, true);
+ ***************************************************************/
+class CANTimingAnalyzer
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param maxIds 最多跟踪的ID数（向上取整为2的幂的一半，保证装载率<=50%）
+     */
+    explicit CANTimingAnalyzer(int maxIds = 1024);
+
+    // ========== 接收路径 ==========
+
+    /**
+     * @brief 更新一帧（接收线程调用）
+     * @param frame CAN帧
+     */
+    void update(const QCanBusFrame &frame);
+
+    /**
+     * @brief 更新一帧（原始参数）
+     * @param frameId 帧ID
+     * @param extended 是否扩展帧
+     * @param dlc 数据长度
+     * @param timestampUs 接收时间戳（微秒，CLOCK_REALTIME），0表示取当前时间
+     */
+    void update(quint32 frameId, bool extended, quint8 dlc, qint64 timestampUs);
+
+    // ========== 查询 ==========
+
+    /**
+     * @brief 获取所有ID的统计快照（按ID排序）
+     */
+    QVector<CANIdTimingStats> snapshot() const;
+
+    /**
+     * @brief 获取单个ID的统计快照
+     * @return 统计信息，未见过该ID时frameCount为0
+     */
+    CANIdTimingStats getStats(quint32 frameId, bool extended = false) const;
+
+    /**
+     * @brief 已跟踪的ID数
+     */
+    int getTrackedIdCount() const;
+
+    /**
+     * @brief 表满未能跟踪的帧数
+     */
+    quint64 getUntrackedFrameCount() const;
+
+    /**
+     * @brief 清空所有统计
+     */
+    void reset();
+
+    /**
+     * @brief 生成按ID的时序报告
+     * @return 报告字符串
+     */
+    QString generateReport() const;
+
+    /**
+     * @brief 打印报告到控制台
+     */
+    void printReport() const;
+
+private:
+    enum {
+        EwmaShift = 4,          // EWMA系数 1/16
+        WarmupFrames = 8        // 周期稳定前不做丢帧估计
+    };
+
+    struct Slot {
+        quint32 key;            // ID | 扩展帧标志位(bit31)，0xFFFFFFFF表示空
+        quint8 lastDlc;
+        quint32 dlcChanges;
+        quint64 frameCount;
+        qint64 lastTimestampUs;
+        qint64 periodScaled;    // 周期 << EwmaShift
+        qint64 jitterScaled;    // 抖动 << EwmaShift
+        qint64 minIntervalUs;
+        qint64 maxIntervalUs;
+        quint64 missingCount;
+    };
+
+    static quint32 makeKey(quint32 frameId, bool extended);
+    static qint64 nowUs();
+    CANIdTimingStats toStats(const Slot &slot, qint64 now) const;
+
+    /**
+     * @brief 查找或插入槽位
+     * @return 槽位指针，表满返回nullptr
+     */
+    Slot* findSlot(quint32 key, bool insert);
+    const Slot* findSlot(quint32 key) const;
+
+    QVector<Slot> m_slots;          // 开放寻址哈希表
+    quint32 m_mask;                 // 表大小掩码
+    int m_maxIds;                   // 最多跟踪ID数
+    int m_trackedIds;               // 已跟踪ID数
+    quint64 m_untrackedFrames;      // 表满未跟踪的帧数
+    mutable QMutex m_mutex;         // 接收线程与查询线程互斥
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_TIMING_ANALYZER_H
@@ -0,0 +1,233 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTraceFormat.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN抓包文件与旁路索引的格式定义
+ *
+ * 功能说明:
+ *   抓包文件（*.cantrace）由记录组成，记录按块写入；每个块在旁路
+ *   索引文件（*.cantrace.idx）中有一个条目，记录块的文件偏移、
+ *   时间范围、帧数和按ID散列的位图。查询时先按时间二分定位，
+ *   再用位图跳过不含目标ID的块，只读取可能命中的块。
+ *
+ * 抓包文件（小端）:
+ *   文件头32字节:
+ *     magic(8)="CANTRACE" version(2)=1 headerSize(2)=32
+ *     flags(4)=0 createdUs(8) reserved(8)
+ *   记录14+N字节:
+ *     timestampUs(8) canId(4) flags(1) length(1) data(length)
+ *   canId按socketcan约定: bit31=扩展帧 bit30=远程帧
+ *   flags: bit0=CAN FD bit1=BRS bit2=ESI
+ *
+ * 索引文件（小端）:
+ *   文件头32字节:
+ *     magic(8)="CANTRIDX" version(2)=1 headerSize(2)=32
+ *     bitmapBytes(2)=128 reserved(2) blockCount(4) reserved(12)
+ *   块条目160字节:
+ *     offset(8) minUs(8) maxUs(8) frameCount(4) byteLength(4) bitmap(128)
+ *   blockCount在正常关闭时写入；异常退出时为0，读取方按文件大小计算，
+ *   未进入索引的尾部数据由读取方扫描补全
+ *
+ * ID位图:
+ *   1024位，每个ID置2位（两个独立散列），不含目标ID的块一定被跳过，
+ *   偶尔误判只会多读一个块，不影响结果正确性
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_TRACE_FORMAT_H
+#define IMX6ULL_DRIVERS_CAN_TRACE_FORMAT_H
+
+#include <QtGlobal>
+#include <QCanBusFrame>
+#include <QByteArray>
+#include <QtEndian>
+#include <string.h>
+
+#define CAN_TRACE_MAGIC             "CANTRACE"
+#define CAN_TRACE_INDEX_MAGIC       "CANTRIDX"
+#define CAN_TRACE_VERSION           1
+#define CAN_TRACE_HEADER_SIZE       32
+#define CAN_TRACE_RECORD_HEADER     14
+#define CAN_TRACE_MAX_RECORD        (CAN_TRACE_RECORD_HEADER + 64)
+#define CAN_TRACE_BITMAP_BYTES      128
+#define CAN_TRACE_INDEX_ENTRY_SIZE  (32 + CAN_TRACE_BITMAP_BYTES)
+
+#define CAN_TRACE_ID_EFF            0x80000000U
+#define CAN_TRACE_ID_RTR            0x40000000U
+#define CAN_TRACE_ID_MASK           0x1FFFFFFFU
+
+#define CAN_TRACE_FLAG_FD           0x01
+#define CAN_TRACE_FLAG_BRS          0x02
+#define CAN_TRACE_FLAG_ESI          0x04
+
+/**
+ * @brief 解码后的一条记录（data指向读取缓冲区，仅在回调内有效）
+ */
+struct CANTraceRecord
+{
+    qint64 timestampUs;     // 接收时间戳（微秒）
+    quint32 frameId;        // CAN ID（不含标志位）
+    bool extended;          // 扩展帧
+    bool remote;            // 远程帧
+    quint8 flags;           // CAN_TRACE_FLAG_*
+    quint8 length;          // 数据长度
+    const uchar *data;      // 数据
+
+    /**
+     * @brief 转换为QCanBusFrame（会分配payload）
+     */
+    QCanBusFrame toFrame() const
+    {
+        QCanBusFrame frame(frameId, QByteArray(reinterpret_cast<const char *>(data), length));
+        frame.setExtendedFrameFormat(extended);
+        if (remote) {
+            frame.setFrameType(QCanBusFrame::RemoteRequestFrame);
+        }
+        if (flags & CAN_TRACE_FLAG_FD) {
+            frame.setFlexibleDataRateFormat(true);
+            frame.setBitrateSwitch((flags & CAN_TRACE_FLAG_BRS) != 0);
+            frame.setErrorStateIndicator((flags & CAN_TRACE_FLAG_ESI) != 0);
+        }
+        frame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(timestampUs));
+        return frame;
+    }
+};
+
+/**
+ * @brief 一个块的索引条目
+ */
+struct CANTraceBlock
+{
+    qint64 offset;          // 块在抓包文件中的偏移
+    qint64 minUs;           // 块内最早时间戳
+    qint64 maxUs;           // 块内最晚时间戳
+    quint32 frameCount;     // 块内帧数
+    quint32 byteLength;     // 块字节数
+    uchar bitmap[CAN_TRACE_BITMAP_BYTES];  // ID散列位图
+
+    CANTraceBlock()
+        : offset(0), minUs(0), maxUs(0), frameCount(0), byteLength(0)
+    {
+        memset(bitmap, 0, sizeof(bitmap));
+    }
+
+    /**
+     * @brief 在位图中标记ID
+     */
+    void markId(quint32 frameId)
+    {
+        quint32 h1 = hash1(frameId);
+        quint32 h2 = hash2(frameId);
+        bitmap[h1 >> 3] |= static_cast<uchar>(1U << (h1 & 7));
+        bitmap[h2 >> 3] |= static_cast<uchar>(1U << (h2 & 7));
+    }
+
+    /**
+     * @brief 块中是否可能含有该ID（false表示一定没有）
+     */
+    bool mayContain(quint32 frameId) const
+    {
+        quint32 h1 = hash1(frameId);
+        quint32 h2 = hash2(frameId);
+        return (bitmap[h1 >> 3] & (1U << (h1 & 7))) &&
+               (bitmap[h2 >> 3] & (1U << (h2 & 7)));
+    }
+
+    /**
+     * @brief 追加一条记录的统计
+     */
+    void account(qint64 timestampUs, quint32 frameId, int recordBytes)
+    {
+        if (frameCount == 0) {
+            minUs = maxUs = timestampUs;
+        } else {
+            minUs = qMin(minUs, timestampUs);
+            maxUs = qMax(maxUs, timestampUs);
+        }
+        frameCount++;
+        byteLength += static_cast<quint32>(recordBytes);
+        markId(frameId);
+    }
+
+    /**
+     * @brief 序列化为索引条目
+     */
+    void serialize(uchar *out) const
+    {
+        qToLittleEndian<quint64>(static_cast<quint64>(offset), out);
+        qToLittleEndian<quint64>(static_cast<quint64>(minUs), out + 8);
+        qToLittleEndian<quint64>(static_cast<quint64>(maxUs), out + 16);
+        qToLittleEndian<quint32>(frameCount, out + 24);
+        qToLittleEndian<quint32>(byteLength, out + 28);
+        memcpy(out + 32, bitmap, CAN_TRACE_BITMAP_BYTES);
+    }
+
+    /**
+     * @brief 从索引条目反序列化
+     */
+    void deserialize(const uchar *in)
+    {
+        offset = static_cast<qint64>(qFromLittleEndian<quint64>(in));
+        minUs = static_cast<qint64>(qFromLittleEndian<quint64>(in + 8));
+        maxUs = static_cast<qint64>(qFromLittleEndian<quint64>(in + 16));
+        frameCount = qFromLittleEndian<quint32>(in + 24);
+        byteLength = qFromLittleEndian<quint32>(in + 28);
+        memcpy(bitmap, in + 32, CAN_TRACE_BITMAP_BYTES);
+    }
+
+private:
+    // 两个独立的乘法散列，取高10位作为位号
+    static quint32 hash1(quint32 id) { return (id * 0x9E3779B1U) >> 22; }
+    static quint32 hash2(quint32 id) { return ((id ^ 0x5BD1E995U) * 0x85EBCA77U) >> 22; }
+};
+
+/**
+ * @brief 编码一条记录
+ * @param out 输出缓冲区（至少CAN_TRACE_RECORD_HEADER+length字节）
+ * @return 写入字节数
+ */
+inline int canTraceEncodeRecord(uchar *out, qint64 timestampUs, quint32 canId,
+                                quint8 flags, const uchar *data, int length)
+{
+    qToLittleEndian<quint64>(static_cast<quint64>(timestampUs), out);
+    qToLittleEndian<quint32>(canId, out + 8);
+    out[12] = flags;
+    out[13] = static_cast<uchar>(length);
+    if (length > 0) {
+        memcpy(out + CAN_TRACE_RECORD_HEADER, data, static_cast<size_t>(length));
+    }
+    return CAN_TRACE_RECORD_HEADER + length;
+}
+
+/**
+ * @brief 解码一条记录
+ * @param in 输入数据
+ * @param available 可用字节数
+ * @param record 输出记录
+ * @return 记录字节数，数据不完整或格式错误返回-1
+ */
+inline int canTraceDecodeRecord(const uchar *in, qint64 available, CANTraceRecord &record)
+{
+    if (available < CAN_TRACE_RECORD_HEADER) {
+        return -1;
+    }
+    const int length = in[13];
+    if (length > 64 || available < CAN_TRACE_RECORD_HEADER + length) {
+        return -1;
+    }
+    const quint32 canId = qFromLittleEndian<quint32>(in + 8);
+    record.timestampUs = static_cast<qint64>(qFromLittleEndian<quint64>(in));
+    record.frameId = canId & CAN_TRACE_ID_MASK;
+    record.extended = (canId & CAN_TRACE_ID_EFF) != 0;
+    record.remote = (canId & CAN_TRACE_ID_RTR) != 0;
+    record.flags = in[12];
+    record.length = static_cast<quint8>(length);
+    record.data = in + CAN_TRACE_RECORD_HEADER;
+    return CAN_TRACE_RECORD_HEADER + length;
+}
+
+#endif // IMX6ULL_DRIVERS_CAN_TRACE_FORMAT_H
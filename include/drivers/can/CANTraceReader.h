@@ -0,0 +1,167 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTraceReader.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 带索引的CAN抓包文件读取与查询
+ *
+ * 功能说明:
+ *   读取CANTraceWriter生成的抓包文件，按时间窗口和ID集合查询:
+ *   - 打开时加载旁路索引；索引缺失或损坏时扫描抓包文件重建（仅内存）
+ *   - 写入器异常退出时，索引之后的尾部数据扫描补全，截断的最后一条记录丢弃
+ *   - 查询先按时间二分定位起始块，再用ID位图跳过不可能命中的块，
+ *     候选块整块一次读取后在内存中解码过滤
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 增加按文件句柄读取块的静态接口（并行离线解码）
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_TRACE_READER_H
+#define IMX6ULL_DRIVERS_CAN_TRACE_READER_H
+
+#include "drivers/can/CANTraceFormat.h"
+#include <QString>
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+#include <functional>
+
+/***************************************************************
+ * 类名: CANTraceReader
+ * 功能: 抓包文件的时间/ID查询
+ *
+ * 使用示例:
+ *   CANTraceReader reader;
+ *   if (reader.open("/data/trace/can0.cantrace")) {
+ *       QVector<quint32> ids;
+ *       ids << 0x18FF50E5;
+ *       reader.query(fromUs, toUs, ids, [](const CANTraceRecord &r) {
+ *           ...
+ *           return true;        // false停止查询
+ *       });
+ *       qInfo() << reader.getLastQueryStats().blocksRead;
+ *   }
+ *
+ * 线程安全:
+ *   单个实例不可并发使用；并行读取时每个线程用自己的QFile调用
+ *   静态readBlock()，块列表由一个实例加载后共享
+ ***************************************************************/
+class CANTraceReader
+{
+public:
+    /**
+     * @brief 记录回调，返回false停止查询
+     */
+    typedef std::function<bool(const CANTraceRecord &)> RecordHandler;
+
+    /**
+     * @brief 单次查询统计
+     */
+    struct QueryStats
+    {
+        int blocksTotal;            // 索引中的块数
+        int blocksSkippedTime;      // 时间范围外跳过的块
+        int blocksSkippedId;        // 位图判定不含目标ID跳过的块
+        int blocksRead;             // 实际读取的块
+        qint64 bytesRead;           // 读取字节数
+        qint64 framesDecoded;       // 解码的帧数
+        qint64 framesMatched;       // 命中的帧数
+
+        QueryStats()
+            : blocksTotal(0), blocksSkippedTime(0), blocksSkippedId(0)
+            , blocksRead(0), bytesRead(0), framesDecoded(0), framesMatched(0)
+        {
+        }
+    };
+
+    CANTraceReader();
+    ~CANTraceReader();
+
+    /**
+     * @brief 打开抓包文件并加载索引
+     * @return true=成功, false=失败（见getLastError）
+     */
+    bool open(const QString &path);
+
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    QString getLastError() const { return m_lastError; }
+
+    /**
+     * @brief 索引是否由扫描重建（索引文件缺失或损坏）
+     */
+    bool isIndexRebuilt() const { return m_indexRebuilt; }
+
+    /**
+     * @brief 尾部补扫的帧数（写入器未正常关闭时非0）
+     */
+    qint64 getRecoveredFrames() const { return m_recoveredFrames; }
+
+    /**
+     * @brief 块列表（按文件偏移排序）
+     */
+    const QVector<CANTraceBlock>& blocks() const { return m_blocks; }
+
+    qint64 frameCount() const { return m_frameCount; }
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const;
+
+    /**
+     * @brief 按时间窗口和ID集合查询
+     * @param fromUs 起始时间（含）
+     * @param toUs 结束时间（含）
+     * @param ids 目标ID集合（标志位会被忽略），为空表示全部ID
+     * @param handler 记录回调（文件顺序）
+     * @return 命中帧数，读取失败返回-1
+     */
+    qint64 query(qint64 fromUs, qint64 toUs, const QVector<quint32> &ids,
+                 const RecordHandler &handler);
+
+    QueryStats getLastQueryStats() const { return m_lastStats; }
+
+    /**
+     * @brief 读取一个块的原始数据
+     * @param index 块序号
+     * @param buffer 输出缓冲区（复用以避免重复分配）
+     * @return true=成功
+     */
+    bool readBlock(int index, QByteArray &buffer);
+
+    /**
+     * @brief 用调用者自己的文件句柄读取块（并行读取时每个线程一个句柄）
+     * @return true=成功
+     */
+    static bool readBlock(QFile &file, const CANTraceBlock &block, QByteArray &buffer);
+
+    /**
+     * @brief 解码一个块的全部记录
+     * @return 解码的记录数
+     */
+    static int decodeBlock(const QByteArray &buffer, const RecordHandler &handler);
+
+private:
+    bool loadIndex(const QString &indexFile);
+    bool scanRange(qint64 from, qint64 to);
+    void buildSearchTables();
+    int firstCandidate(qint64 fromUs) const;
+
+    QString m_path;                     // 抓包文件路径
+    QString m_lastError;                // 最后错误
+    QFile m_file;                       // 抓包文件
+    qint64 m_fileSize;                  // 打开时的文件大小
+
+    QVector<CANTraceBlock> m_blocks;    // 块索引
+    QVector<qint64> m_maxPrefix;        // maxUs前缀最大值（二分定位起始块）
+    QVector<qint64> m_minSuffix;        // minUs后缀最小值（提前结束扫描）
+    qint64 m_frameCount;                // 总帧数
+    bool m_indexRebuilt;                // 索引由扫描重建
+    qint64 m_recoveredFrames;           // 尾部补扫帧数
+
+    QByteArray m_buffer;                // 块读取缓冲区
+    QueryStats m_lastStats;             // 最近一次查询统计
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_TRACE_READER_H
@@ -0,0 +1,140 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTraceWriter.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 带旁路索引的CAN抓包写入器
+ *
+ * 功能说明:
+ *   作为广播环的一个消费者，在独立线程中把接收到的帧写入抓包文件，
+ *   同时生成旁路索引（格式见CANTraceFormat.h）:
+ *   - 块达到大小上限或时间跨度达到检查点间隔时封块
+ *   - 每个块整体一次写入，随后追加一条索引条目（时间→偏移检查点+ID位图）
+ *   - 停止时写入块数，异常退出时读取方仍可使用已写入的部分
+ *
+ * 注意:
+ *   错误帧不写入；广播环溢出时写入器会丢帧，getLag()可用于观察积压
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_TRACE_WRITER_H
+#define IMX6ULL_DRIVERS_CAN_TRACE_WRITER_H
+
+#include "drivers/can/CANTraceFormat.h"
+#include <QString>
+#include <QFile>
+#include <QByteArray>
+#include <QAtomicInteger>
+
+class CANBroadcastRing;
+class CANTraceWriterThread;
+
+/***************************************************************
+ * 类名: CANTraceWriter
+ * 功能: 把广播环中的帧写入带索引的抓包文件
+ *
+ * 使用示例:
+ *   DriverCANHighPerf can("can0");
+ *   can.open(500000);
+ *   can.startTrace("/data/trace/can0.cantrace");
+ *   ...
+ *   can.stopTrace();
+ *
+ * 线程安全:
+ *   start/stop在创建线程中调用；统计接口可在任意线程调用
+ ***************************************************************/
+class CANTraceWriter
+{
+public:
+    CANTraceWriter();
+    ~CANTraceWriter();
+
+    /**
+     * @brief 设置块大小上限
+     * @param bytes 4KB~4MB，默认64KB
+     */
+    void setBlockSize(int bytes);
+
+    /**
+     * @brief 设置检查点间隔（一个块的最大时间跨度）
+     * @param msecs 毫秒，默认1000
+     */
+    void setCheckpointInterval(int msecs);
+
+    /**
+     * @brief 创建抓包与索引文件并开始写入
+     * @param path 抓包文件路径，索引文件为path + ".idx"
+     * @param ring 广播环（写入器注册为其消费者）
+     * @return true=成功, false=失败（见getLastError）
+     */
+    bool start(const QString &path, CANBroadcastRing *ring);
+
+    /**
+     * @brief 写完剩余的帧并关闭文件
+     */
+    void stop();
+
+    bool isRunning() const { return m_thread != nullptr; }
+    QString getPath() const { return m_path; }
+    QString getLastError() const { return m_lastError; }
+
+    // ========== 统计 ==========
+
+    quint64 getFramesWritten() const { return m_framesWritten.load(); }
+    quint64 getBlocksWritten() const { return m_blocksWritten.load(); }
+    quint64 getBytesWritten() const { return m_bytesWritten.load(); }
+    quint64 getWriteErrors() const { return m_writeErrors.load(); }
+
+    /**
+     * @brief 写入器在广播环中的积压帧数
+     */
+    quint64 getLag() const;
+
+    /**
+     * @brief 索引文件路径
+     */
+    static QString indexPath(const QString &tracePath) { return tracePath + ".idx"; }
+
+private:
+    friend class CANTraceWriterThread;
+
+    /**
+     * @brief 追加一条记录到当前块（写入线程）
+     */
+    void append(qint64 timestampUs, quint32 canId, quint8 flags,
+                const uchar *data, int length);
+
+    /**
+     * @brief 封块：写入块数据和索引条目（写入线程）
+     */
+    void sealBlock();
+
+    bool writeHeaders();
+
+    QString m_path;                     // 抓包文件路径
+    QString m_lastError;                // 最后错误
+    QFile m_traceFile;                  // 抓包文件
+    QFile m_indexFile;                  // 索引文件
+
+    CANBroadcastRing *m_ring;           // 广播环
+    int m_consumerId;                   // 消费者ID
+    CANTraceWriterThread *m_thread;     // 写入线程
+
+    int m_blockSize;                    // 块大小上限
+    qint64 m_checkpointUs;              // 块最大时间跨度
+
+    // 当前块（只由写入线程访问）
+    QByteArray m_block;                 // 块数据
+    CANTraceBlock m_blockInfo;          // 块索引信息
+    qint64 m_fileOffset;                // 下一个块的文件偏移
+
+    QAtomicInteger<quint64> m_framesWritten;
+    QAtomicInteger<quint64> m_blocksWritten;
+    QAtomicInteger<quint64> m_bytesWritten;
+    QAtomicInteger<quint64> m_writeErrors;
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_TRACE_WRITER_H
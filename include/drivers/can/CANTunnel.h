@@ -0,0 +1,288 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTunnel.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN-over-UDP隧道 - 多帧打包成一个数据报转发到远端
+ *
+ * 功能说明:
+ *   远程机柜上的CAN总线需要经以太网访问。逐帧发送时每帧一个报文，
+ *   5000fps下报文头开销和系统调用次数都无法接受。本隧道端点:
+ *   - 把本地收到的帧打包进UDP数据报，每个数据报带序号和时间戳
+ *   - 数据报达到大小上限或最早一帧等待超过刷新期限时立即发送
+ *   - 对端拆包后写入本地CAN接口（可以是"sim:"虚拟总线）
+ *   - 按序号统计丢包、重复和乱序，过期数据报直接丢弃
+ *
+ * 帧来源:
+ *   - DriverCANHighPerf: 注册广播环消费者，由隧道线程批量读取，
+ *     不经过Qt信号，刷新期限由线程精确控制
+ *   - DriverCAN: 连接frameReceived信号，在主线程打包，定时器刷新
+ *
+ * 数据报格式（网络字节序）:
+ *   头部20字节:
+ *     magic(2)=0x4354 version(1)=1 flags(1)=0 sequence(4)
+ *     baseTimestampUs(8) frameCount(2) reserved(2)
+ *   每帧记录10+N字节:
+ *     timestampDeltaUs(4) canId(4) flags(1) length(1) data(length)
+ *   canId按socketcan约定: bit31=扩展帧 bit30=远程帧
+ *   flags: bit0=CAN FD bit1=BRS bit2=ESI
+ *
+ * 注意:
+ *   - 错误帧和本地回显帧不转发
+ *   - 对端写入的帧不会回到本端（本地回显不转发），两端可对称部署
+ *   - 时延统计依赖两端时钟同步（见TimeService），否则仅供参考
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_TUNNEL_H
+#define IMX6ULL_DRIVERS_CAN_TUNNEL_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QSocketNotifier>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QCanBusFrame>
+
+class DriverCAN;
+class CANBroadcastRing;
+class CANTunnelThread;
+
+/**
+ * @brief 隧道统计
+ */
+struct CANTunnelStats
+{
+    // 发送方向
+    quint64 datagramsSent;      // 已发送数据报数
+    quint64 framesSent;         // 已发送帧数
+    quint64 bytesSent;          // 已发送字节数（UDP载荷）
+    quint64 sizeFlushes;        // 因大小上限触发的发送次数
+    quint64 deadlineFlushes;    // 因刷新期限触发的发送次数
+    quint64 sendErrors;         // 发送失败的数据报数
+    quint64 framesDropped;      // 发送失败丢弃的帧数
+
+    // 接收方向
+    quint64 datagramsReceived;  // 已接收的有效数据报数
+    quint64 framesReceived;     // 已拆出的帧数
+    quint64 framesInjected;     // 成功写入本地接口的帧数
+    quint64 injectErrors;       // 写入本地接口失败的帧数
+    quint64 sequenceGaps;       // 序号跳变丢失的数据报数
+    quint64 lateDatagrams;      // 重复或乱序到达被丢弃的数据报数
+    quint64 decodeErrors;       // 格式错误的数据报数
+    qint64 lastLatencyUs;       // 最近一帧的端到端时延（需时钟同步）
+    qint64 maxLatencyUs;        // 最大端到端时延
+
+    CANTunnelStats()
+        : datagramsSent(0), framesSent(0), bytesSent(0)
+        , sizeFlushes(0), deadlineFlushes(0), sendErrors(0), framesDropped(0)
+        , datagramsReceived(0), framesReceived(0), framesInjected(0)
+        , injectErrors(0), sequenceGaps(0), lateDatagrams(0), decodeErrors(0)
+        , lastLatencyUs(0), maxLatencyUs(0)
+    {
+    }
+
+    /**
+     * @brief 平均每个数据报承载的帧数
+     */
+    double framesPerDatagram() const
+    {
+        return datagramsSent > 0 ? double(framesSent) / datagramsSent : 0.0;
+    }
+};
+
+/***************************************************************
+ * 类名: CANTunnel
+ * 功能: CAN-over-UDP隧道端点（双向）
+ *
+ * 使用示例:
+ *   // 机柜A
+ *   DriverCANHighPerf can("can0");
+ *   can.open(500000);
+ *   CANTunnel tunnel(&can);
+ *   tunnel.setFlushDeadline(2000);                  // 最多攒2ms
+ *   tunnel.start(47000, QHostAddress("192.168.1.20"), 47000);
+ *
+ *   // 机柜B（或本机测试: 两条sim:总线+回环地址）
+ *   DriverCAN can("sim:remote");
+ *   can.open();
+ *   CANTunnel tunnel(&can);
+ *   tunnel.start(47000, QHostAddress("192.168.1.10"), 47000);
+ *
+ * 线程安全:
+ *   所有公共接口在创建线程中调用；高性能模式下打包发送在隧道线程中进行
+ ***************************************************************/
+class CANTunnel : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param can 本地CAN驱动（需先打开，生命周期长于隧道）
+     * @param parent 父对象指针
+     */
+    explicit CANTunnel(DriverCAN *can, QObject *parent = nullptr);
+    ~CANTunnel();
+
+    // ========== 参数（start前设置） ==========
+
+    /**
+     * @brief 设置数据报大小上限（UDP载荷字节数）
+     * @param bytes 128~65000，默认1400（不超过以太网MTU，避免IP分片）
+     */
+    void setMaxDatagramSize(int bytes);
+    int getMaxDatagramSize() const { return m_maxDatagramSize; }
+
+    /**
+     * @brief 设置刷新期限：缓冲中最早一帧最多等待的时间
+     * @param usecs 微秒，默认2000；0表示不等待，每批收到的帧立即发送
+     */
+    void setFlushDeadline(int usecs);
+    int getFlushDeadline() const { return m_flushDeadlineUs; }
+
+    /**
+     * @brief 设置转发方向
+     * @param forwardLocal 是否把本地收到的帧发往对端
+     * @param injectRemote 是否把对端的帧写入本地接口
+     */
+    void setDirection(bool forwardLocal, bool injectRemote);
+
+    // ========== 运行控制 ==========
+
+    /**
+     * @brief 启动隧道
+     * @param localPort 本地监听端口
+     * @param peerAddress 对端地址
+     * @param peerPort 对端端口
+     * @return true=成功, false=失败（见getLastError）
+     */
+    bool start(quint16 localPort, const QHostAddress &peerAddress, quint16 peerPort);
+
+    /**
+     * @brief 停止隧道（发送缓冲中剩余的帧）
+     */
+    void stop();
+
+    bool isRunning() const { return m_socketFd >= 0; }
+    QString getLastError() const { return m_lastError; }
+
+    // ========== 统计 ==========
+
+    CANTunnelStats getStats() const;
+    void resetStats();
+
+    /**
+     * @brief 生成隧道统计报告
+     */
+    QString generateReport() const;
+
+signals:
+    /**
+     * @brief 收到对端的一批帧（每个数据报一次）
+     * @param frames 拆出的帧（时间戳为发送端接收时刻）
+     */
+    void framesReceived(const QVector<QCanBusFrame> &frames);
+
+    /**
+     * @brief 检测到序号跳变（数据报丢失）
+     * @param expected 期望序号
+     * @param received 实际序号
+     */
+    void sequenceGap(quint32 expected, quint32 received);
+
+    /**
+     * @brief 错误信号
+     * @param errorString 错误描述
+     */
+    void errorOccurred(const QString &errorString);
+
+private slots:
+    void onFrameReceived(const QCanBusFrame &frame);
+    void onFlushTimeout();
+    void onSocketReadable();
+
+private:
+    friend class CANTunnelThread;
+
+    enum Flush {
+        FlushSize,
+        FlushDeadline,
+        FlushStop
+    };
+
+    /**
+     * @brief 追加一帧到发送缓冲，放不下时先发送（调用者为缓冲所有者）
+     * @return true=缓冲由空变为非空
+     */
+    bool appendFrame(quint32 canId, quint8 flags, const char *data, int length,
+                     qint64 timestampUs);
+
+    /**
+     * @brief 发送缓冲中的帧
+     */
+    void flush(Flush reason);
+
+    /**
+     * @brief 缓冲中最早一帧已等待的微秒数，缓冲为空返回-1
+     */
+    qint64 pendingAgeUs() const;
+
+    /**
+     * @brief 解析一个数据报并写入本地接口
+     */
+    void unpackDatagram(const char *data, int size);
+
+    void setError(const QString &error);
+
+    static qint64 realtimeUs();
+
+    DriverCAN *m_can;                   // 本地CAN驱动
+    CANBroadcastRing *m_ring;           // 广播环（高性能模式）
+    int m_consumerId;                   // 广播环消费者ID
+    CANTunnelThread *m_thread;          // 隧道线程（高性能模式）
+    QTimer *m_flushTimer;               // 刷新定时器（普通模式）
+
+    int m_socketFd;                     // UDP套接字（已connect到对端）
+    QSocketNotifier *m_readNotifier;    // 接收通知
+    QString m_lastError;                // 最后错误
+
+    int m_maxDatagramSize;              // 数据报大小上限
+    int m_flushDeadlineUs;              // 刷新期限
+    bool m_forwardLocal;                // 转发本地帧
+    bool m_injectRemote;                // 注入对端帧
+
+    // 发送缓冲（高性能模式下只由隧道线程访问，普通模式下只由主线程访问）
+    QByteArray m_txBuffer;              // 数据报缓冲
+    int m_txFrames;                     // 缓冲中的帧数
+    qint64 m_txBaseUs;                  // 缓冲首帧时间戳
+    qint64 m_txFirstNs;                 // 首帧入缓冲的单调时刻
+    quint32 m_txSequence;               // 下一个发送序号
+    QElapsedTimer m_clock;              // 单调时钟
+
+    // 接收状态（主线程）
+    quint32 m_rxExpected;               // 期望的下一个序号
+    bool m_rxSynced;                    // 是否已收到第一个数据报
+    QByteArray m_rxBuffer;              // 接收缓冲
+
+    // 发送方向统计（隧道线程写入）
+    QAtomicInteger<quint64> m_datagramsSent;
+    QAtomicInteger<quint64> m_framesSent;
+    QAtomicInteger<quint64> m_bytesSent;
+    QAtomicInteger<quint64> m_sizeFlushes;
+    QAtomicInteger<quint64> m_deadlineFlushes;
+    QAtomicInteger<quint64> m_sendErrors;
+    QAtomicInteger<quint64> m_framesDropped;
+
+    CANTunnelStats m_rxStats;           // 接收方向统计（主线程）
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_TUNNEL_H
@@ -0,0 +1,299 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTxScheduler.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN发送调度器 - 按优先级排队的发送队列
+ *
+ * 功能说明:
+ *   CAN总线仲裁按ID优先级进行，但QCanBusDevice::writeFrame是严格FIFO，
+ *   低优先级的大批量发送排在急停帧前面时，急停帧要等整个积压发完。
+ *   本调度器在用户空间维护多级优先级队列，并限制已交给内核但尚未
+ *   上总线的帧数（in-flight），使高优先级帧可以超越已排队的低优先级帧。
+ *
+ * 在途帧跟踪:
+ *   - 打开ReceiveOwnKey（CAN_RAW_RECV_OWN_MSGS），帧真正发送到总线后
+ *     内核回送一份本地回显帧（hasLocalEcho），收到回显即释放一个额度
+ *   - 回显超时（总线离线、控制器复位等）时清零在途计数，避免调度卡死
+ *   - 关闭回显跟踪时退化为framesWritten释放额度（仅做写入节流）
+ *
+ * 注意:
+ *   同一优先级内保持FIFO，相同ID的帧不会被重排
+ *   所有接口必须在DriverCAN所在线程调用
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_TX_SCHEDULER_H
+#define IMX6ULL_DRIVERS_CAN_TX_SCHEDULER_H
+
+#include <QObject>
+#include <QQueue>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QCanBusDevice>
+#include <QCanBusFrame>
+
+/**
+ * @brief 单个优先级队列的统计信息
+ */
+struct CANTxClassStats
+{
+    quint64 queued;         // 入队帧数
+    quint64 sent;           // 已发送帧数
+    quint64 dropped;        // 队列满被拒绝的帧数
+    int depth;              // 当前排队帧数
+    int maxDepth;           // 历史最大排队帧数
+    qint64 lastDelayUs;     // 最近一帧排队时延（微秒）
+    qint64 maxDelayUs;      // 最大排队时延（微秒）
+    qint64 totalDelayUs;    // 累计排队时延（微秒）
+
+    CANTxClassStats()
+        : queued(0), sent(0), dropped(0), depth(0), maxDepth(0)
+        , lastDelayUs(0), maxDelayUs(0), totalDelayUs(0)
+    {
+    }
+
+    /**
+     * @brief 平均排队时延（微秒）
+     */
+    double avgDelayUs() const
+    {
+        return sent > 0 ? static_cast<double>(totalDelayUs) / sent : 0.0;
+    }
+};
+
+/***************************************************************
+ * 类名: CANTxScheduler
+ * 功能: CAN帧优先级发送调度器
+ *
+ * 使用示例:
+ *   DriverCAN can("can0");
+ *   can.enableTxScheduler(4);                 // 最多4帧在途
+ *   CANTxScheduler *tx = can.getTxScheduler();
+ *   tx->setIdPriority(0x000, 0x00F, CANTxScheduler::Emergency);
+ *   can.open(500000);
+ *   can.writeFrame(0x001, estopPayload);      // 自动归入Emergency队列
+ *   can.queueFrame(frame, CANTxScheduler::Low);
+ *   qInfo().noquote() << tx->generateReport();
+ ***************************************************************/
+class CANTxScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 发送优先级（数值越小优先级越高）
+     */
+    enum Priority {
+        Emergency = 0,      // 急停、安全相关
+        High = 1,           // 控制命令
+        Normal = 2,         // 周期数据（默认）
+        Low = 3,            // 批量传输、诊断
+        PriorityCount = 4
+    };
+    Q_ENUM(Priority)
+
+    /**
+     * @brief 构造函数
+     * @param maxInFlight 最多允许在途（已交给内核未上总线）的帧数
+     * @param parent 父对象指针
+     */
+    explicit CANTxScheduler(int maxInFlight = 4, QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数
+     */
+    ~CANTxScheduler();
+
+    /**
+     * @brief 绑定底层CAN设备
+     * @param device QCanBusDevice指针，nullptr表示解绑（设备关闭）
+     * @note 解绑时在途计数清零，已排队的帧保留，重新绑定后继续发送
+     */
+    void setDevice(QCanBusDevice *device);
+
+    // ========== 入队 ==========
+
+    /**
+     * @brief 按指定优先级入队
+     * @param frame CAN帧
+     * @param priority 优先级
+     * @return true=已入队, false=队列已满
+     */
+    bool enqueue(const QCanBusFrame &frame, Priority priority);
+
+    /**
+     * @brief 按ID优先级规则自动归类后入队
+     * @param frame CAN帧
+     * @return true=已入队, false=队列已满
+     */
+    bool enqueue(const QCanBusFrame &frame);
+
+    /**
+     * @brief 根据ID规则计算帧的优先级
+     * @param frameId 帧ID
+     * @return 匹配的优先级，无匹配返回默认优先级
+     */
+    Priority classify(quint32 frameId) const;
+
+    // ========== 配置 ==========
+
+    /**
+     * @brief 添加ID区间到优先级的映射规则（按添加顺序匹配）
+     * @param idFrom 起始ID（含）
+     * @param idTo 结束ID（含）
+     * @param priority 优先级
+     */
+    void setIdPriority(quint32 idFrom, quint32 idTo, Priority priority);
+
+    /**
+     * @brief 清除所有ID优先级规则
+     */
+    void clearIdPriorities();
+
+    /**
+     * @brief 设置无规则匹配时的默认优先级
+     */
+    void setDefaultPriority(Priority priority) { m_defaultPriority = priority; }
+
+    /**
+     * @brief 设置最大在途帧数
+     * @param maxInFlight 最大在途帧数（>=1）
+     */
+    void setMaxInFlight(int maxInFlight);
+    int getMaxInFlight() const { return m_maxInFlight; }
+
+    /**
+     * @brief 设置每个优先级队列的最大深度
+     * @param depth 最大排队帧数
+     */
+    void setMaxQueueDepth(int depth);
+
+    /**
+     * @brief 启用/禁用本地回显跟踪
+     * @param enable true=按回显释放额度, false=按framesWritten释放额度
+     * @note 需在打开设备前设置（通过ReceiveOwnKey生效）
+     */
+    void setLocalEchoTracking(bool enable);
+    bool isLocalEchoTracking() const { return m_echoTracking; }
+
+    /**
+     * @brief 设置回显超时时间
+     * @param msecs 超时（毫秒），超时后清零在途计数
+     */
+    void setEchoTimeout(int msecs);
+
+    // ========== 状态与统计 ==========
+
+    /**
+     * @brief 当前在途帧数
+     */
+    int getInFlightCount() const { return m_inFlight; }
+
+    /**
+     * @brief 所有队列中排队帧总数
+     */
+    int getQueuedCount() const;
+
+    /**
+     * @brief 获取指定优先级的统计信息
+     */
+    CANTxClassStats getStats(Priority priority) const;
+
+    /**
+     * @brief 回显超时次数
+     */
+    quint64 getEchoTimeoutCount() const { return m_echoTimeoutCount; }
+
+    /**
+     * @brief 清空所有排队帧
+     */
+    void clear();
+
+    /**
+     * @brief 清零统计信息
+     */
+    void resetStats();
+
+    /**
+     * @brief 生成各优先级排队时延报告
+     * @return 报告字符串
+     */
+    QString generateReport() const;
+
+    /**
+     * @brief 优先级转字符串
+     */
+    static QString priorityToString(Priority priority);
+
+signals:
+    /**
+     * @brief 帧已交给内核发送
+     * @param frame CAN帧
+     * @param priority 所属优先级
+     * @param queueDelayUs 排队时延（微秒）
+     */
+    void frameDispatched(const QCanBusFrame &frame, int priority, qint64 queueDelayUs);
+
+    /**
+     * @brief 队列满，帧被拒绝
+     * @param priority 所属优先级
+     */
+    void queueFull(int priority);
+
+public slots:
+    /**
+     * @brief 收到本地回显帧（帧已上总线）
+     */
+    void onLocalEcho();
+
+    /**
+     * @brief 尝试发送排队帧（在额度允许范围内）
+     */
+    void pump();
+
+private slots:
+    void onFramesWritten(qint64 framesCount);
+    void onEchoTimeout();
+
+private:
+    struct PendingFrame {
+        QCanBusFrame frame;
+        qint64 enqueueNs;   // 入队时间（单调时钟，纳秒）
+    };
+
+    struct IdRule {
+        quint32 idFrom;
+        quint32 idTo;
+        Priority priority;
+    };
+
+    /**
+     * @brief 释放在途额度并继续发送
+     * @param count 释放的帧数
+     */
+    void releaseCredit(int count);
+
+    QCanBusDevice *m_device;                        // 底层CAN设备
+    QQueue<PendingFrame> m_queues[PriorityCount];   // 各优先级队列
+    CANTxClassStats m_stats[PriorityCount];         // 各优先级统计
+    QVector<IdRule> m_idRules;                      // ID优先级规则
+    Priority m_defaultPriority;                     // 默认优先级
+
+    int m_maxInFlight;                              // 最大在途帧数
+    int m_inFlight;                                 // 当前在途帧数
+    int m_maxQueueDepth;                            // 单队列最大深度
+    bool m_echoTracking;                            // 是否按回显释放额度
+    quint64 m_echoTimeoutCount;                     // 回显超时次数
+    bool m_pumping;                                 // pump()重入保护
+
+    QElapsedTimer m_clock;                          // 时延测量时钟
+    QTimer *m_echoTimer;                            // 回显超时定时器
+    QTimer *m_retryTimer;                           // 写入失败重试定时器
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_TX_SCHEDULER_H
@@ -0,0 +1,293 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANVirtualBus.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 进程内虚拟CAN总线 - 无需socketcan/vcan的仿真后端
+ *
+ * 功能说明:
+ *   很多CI和开发容器无法加载vcan模块，DriverCAN因此无法运行。
+ *   本后端在进程内模拟一条CAN总线：
+ *   - 接口名以"sim:"开头时（如"sim:bus0"），DriverCAN自动使用本后端
+ *   - 连接到同名总线的多个驱动实例互相收到对方发送的帧
+ *   - 可按波特率模拟帧占用总线的时间（含位填充估算），0表示不限速
+ *   - 可注入错误帧、按概率产生传输错误（自动重发）和接收丢帧
+ *   - 随机数使用固定种子，同样的配置与发送序列得到同样的结果
+ *
+ * 与socketcan的对应关系:
+ *   - RawFilterKey          按ID/掩码/帧类型/格式过滤
+ *   - ErrorFilterKey        为0时不接收错误帧（与CAN_RAW_ERR_FILTER一致）
+ *   - ReceiveOwnKey         本机发送的帧以本地回显形式回送（hasLocalEcho）
+ *   - LoopbackKey           为false时其他实例收不到本实例发送的帧
+ *   - BitRateKey            总线未显式设置波特率时采用首个实例的配置
+ *   - 每个实例最多256帧待发送，超过时写入失败（对应ENOBUFS）
+ *
+ * 注意:
+ *   不支持rtnetlink，CANBusMonitor读取控制器状态会失败，
+ *   但错误帧事件照常送达
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_CAN_VIRTUAL_BUS_H
+#define IMX6ULL_DRIVERS_CAN_VIRTUAL_BUS_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QCanBusDevice>
+#include <QCanBusFrame>
+
+class CANVirtualBusDevice;
+class CANVirtualBusThread;
+
+/**
+ * @brief 虚拟总线统计
+ */
+struct CANVirtualBusStats
+{
+    quint64 framesTransmitted;  // 成功占用总线的帧数
+    quint64 framesDelivered;    // 送达各实例的帧数（按接收者计）
+    quint64 framesLost;         // 注入丢失的帧数（按接收者计）
+    quint64 errorsInjected;     // 注入的错误次数（含重发引起的）
+    quint64 txRejected;         // 发送队列满被拒绝的帧数
+    quint64 busTimeNs;          // 累计占用总线时间（纳秒）
+    int attachedDevices;        // 当前连接的实例数
+
+    CANVirtualBusStats()
+        : framesTransmitted(0), framesDelivered(0), framesLost(0)
+        , errorsInjected(0), txRejected(0), busTimeNs(0), attachedDevices(0)
+    {
+    }
+};
+
+/***************************************************************
+ * 类名: CANVirtualBus
+ * 功能: 进程内虚拟CAN总线（按名称共享）
+ *
+ * 使用示例:
+ *   CANVirtualBus *bus = CANVirtualBus::bus("bus0");
+ *   bus->setBitrate(500000);       // 按500K模拟总线时间
+ *   bus->setLossRate(0.001);       // 每个接收者0.1%丢帧
+ *   bus->setErrorRate(0.0001);     // 0.01%的帧发生位错误并重发
+ *
+ *   DriverCANHighPerf a("sim:bus0");
+ *   DriverCAN b("sim:bus0");
+ *   a.open();
+ *   b.open();                      // b收到a发送的帧，反之亦然
+ ***************************************************************/
+class CANVirtualBus
+{
+public:
+    /**
+     * @brief 接口名前缀
+     */
+    static const char *const InterfacePrefix;
+
+    /**
+     * @brief 判断接口名是否指向虚拟总线
+     * @param interfaceName 接口名称
+     */
+    static bool isVirtualInterface(const QString &interfaceName);
+
+    /**
+     * @brief 按名称获取虚拟总线，不存在则创建
+     * @param name 总线名称（不含"sim:"前缀）
+     * @return 总线指针（进程内常驻）
+     */
+    static CANVirtualBus* bus(const QString &name);
+
+    QString name() const { return m_name; }
+
+    // ========== 仿真参数 ==========
+
+    /**
+     * @brief 设置总线波特率（用于计算帧占用时间）
+     * @param bitrate 波特率，0表示不限速（帧在发送线程中同步送达）
+     * @note 显式设置后不再采用实例的BitRateKey
+     */
+    void setBitrate(quint32 bitrate);
+    quint32 getBitrate() const;
+
+    /**
+     * @brief 设置接收丢帧概率（对每个接收者独立判定）
+     * @param rate 0.0~1.0
+     */
+    void setLossRate(double rate);
+
+    /**
+     * @brief 设置传输错误概率（出错的帧广播错误帧后自动重发）
+     * @param rate 0.0~1.0
+     */
+    void setErrorRate(double rate);
+
+    /**
+     * @brief 设置随机数种子（相同种子得到相同的丢帧/错误序列）
+     */
+    void setSeed(quint32 seed);
+
+    /**
+     * @brief 向所有接收错误帧的实例注入一个错误帧
+     * @param errors 错误类别（对应CAN_ERR_*）
+     * @param payload 8字节错误数据（按linux/can/error.h）
+     */
+    void injectErrorFrame(QCanBusFrame::FrameErrors errors,
+                          const QByteArray &payload = QByteArray(8, 0));
+
+    // ========== 统计 ==========
+
+    CANVirtualBusStats getStats() const;
+    void resetStats();
+
+    /**
+     * @brief 生成总线统计报告
+     */
+    QString generateReport() const;
+
+private:
+    friend class CANVirtualBusDevice;
+    friend class CANVirtualBusThread;
+
+    /**
+     * @brief 待送达的帧（按总线完成时间排序）
+     */
+    struct PendingFrame
+    {
+        qint64 dueNs;                   // 帧在总线上传输完成的时刻
+        QCanBusFrame frame;             // 帧内容
+        CANVirtualBusDevice *sender;    // 发送者（已断开时为nullptr）
+    };
+
+    explicit CANVirtualBus(const QString &name);
+    ~CANVirtualBus();
+
+    void attach(CANVirtualBusDevice *device);
+    void detach(CANVirtualBusDevice *device);
+
+    /**
+     * @brief 发送一帧（由实例的writeFrame调用）
+     * @return true=已上总线或排队, false=发送队列满
+     */
+    bool transmit(CANVirtualBusDevice *sender, const QCanBusFrame &frame);
+
+    /**
+     * @brief 把一批帧送达各实例，每个实例只入队一次（调用者持有m_mutex）
+     */
+    void deliver(const QVector<PendingFrame> &batch);
+
+    /**
+     * @brief 构造错误帧
+     */
+    static QCanBusFrame makeErrorFrame(QCanBusFrame::FrameErrors errors,
+                                       const QByteArray &payload);
+
+    /**
+     * @brief 估算帧占用总线的位数（含位填充与帧间隔）
+     */
+    static int frameBits(const QCanBusFrame &frame);
+
+    /**
+     * @brief 确定性伪随机数（xorshift32），返回[0,1)
+     */
+    double nextRandom();
+
+    static qint64 monotonicNs();
+
+    QString m_name;                     // 总线名称
+    mutable QMutex m_mutex;             // 保护实例列表、参数与统计（可重入）
+    QMutex m_queueMutex;                // 保护待送达队列（加锁顺序: m_mutex → m_queueMutex）
+    QWaitCondition m_queueNotEmpty;     // 待送达队列非空
+    QList<CANVirtualBusDevice*> m_devices;  // 已连接实例
+    QQueue<PendingFrame> m_pending;     // 待送达队列（完成时间单调递增）
+    CANVirtualBusThread *m_thread;      // 定时送达线程（有实例连接时运行）
+
+    quint32 m_bitrate;                  // 波特率（0=不限速）
+    bool m_bitrateExplicit;             // 是否显式设置过波特率
+    double m_lossRate;                  // 接收丢帧概率
+    double m_errorRate;                 // 传输错误概率
+    quint32 m_randomState;              // 随机数状态
+    qint64 m_busFreeAtNs;               // 总线空闲时刻
+
+    CANVirtualBusStats m_stats;         // 统计
+};
+
+/***************************************************************
+ * 类名: CANVirtualBusDevice
+ * 功能: 连接到虚拟总线的QCanBusDevice实现
+ *
+ * 说明:
+ *   由DriverCAN::createDevice()按接口名自动创建，一般无需直接使用。
+ *   收到的帧经enqueueReceivedFrames()进入QCanBusDevice的接收队列，
+ *   framesReceived/readFrame/framesAvailable与socketcan插件行为一致，
+ *   因此独立接收线程、发送调度器等上层功能无需修改
+ ***************************************************************/
+class CANVirtualBusDevice : public QCanBusDevice
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param busName 总线名称（不含"sim:"前缀）
+     * @param parent 父对象指针
+     */
+    explicit CANVirtualBusDevice(const QString &busName, QObject *parent = nullptr);
+    ~CANVirtualBusDevice();
+
+    void setConfigurationParameter(int key, const QVariant &value) override;
+    bool writeFrame(const QCanBusFrame &frame) override;
+    QString interpretErrorFrame(const QCanBusFrame &errorFrame) override;
+
+    CANVirtualBus* virtualBus() const { return m_bus; }
+
+protected:
+    bool open() override;
+    void close() override;
+
+private:
+    friend class CANVirtualBus;
+    friend class CANVirtualBusThread;
+
+    /**
+     * @brief 判断本实例是否接收该帧（过滤器/错误过滤/本机回送）
+     * @param frame 帧
+     * @param ownFrame 是否为本实例发送的帧
+     */
+    bool accepts(const QCanBusFrame &frame, bool ownFrame) const;
+
+    /**
+     * @brief 总线送达一批帧（在发送者线程或送达线程中调用）
+     */
+    void pushReceived(const QVector<QCanBusFrame> &frames) { enqueueReceivedFrames(frames); }
+
+    /**
+     * @brief 其他实例是否能收到本实例发送的帧
+     */
+    bool isLoopback() const;
+
+    /**
+     * @brief 按当前配置刷新过滤参数缓存
+     */
+    void refreshFilters();
+
+    /**
+     * @brief 待发送帧计数（限速模式下由总线维护）
+     */
+    QAtomicInt m_txPending;
+
+    CANVirtualBus *m_bus;                       // 所属总线
+    mutable QMutex m_filterMutex;               // 保护过滤参数
+    QList<QCanBusDevice::Filter> m_filters;     // 接收过滤器（空=全部接收）
+    QCanBusFrame::FrameErrors m_errorFilter;    // 接收的错误帧类别
+    bool m_receiveOwn;                          // 接收本机发送的帧
+    bool m_loopback;                            // 其他实例可收到本实例的帧
+};
+
+#endif // IMX6ULL_DRIVERS_CAN_VIRTUAL_BUS_H
@@ -8,7 +8,7 @@
  *
  * 功能说明:
  *   封装Qt的QCanBus功能，提供统一的CAN总线通信接口
- *   支持SocketCAN（Linux标准CAN接口）
+ *   支持SocketCAN（Linux标准CAN接口），接口名"sim:bus0"时使用进程内虚拟总线
  *
  * CAN总线说明:
  *   - 波特率: 常用 125K, 250K, 500K, 1M
@@ -22,6 +22,12 @@
  *
  * History:
  *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 增加按优先级排队的发送调度器（CANTxScheduler）
+ *   3. 2026-10-18 增加按ID的周期与抖动分析器（CANTimingAnalyzer）
+ *   4. 2026-10-18 增加控制器错误状态监测与总线关闭自动重启（CANBusMonitor）
+ *   5. 2026-10-18 接口名"sim:<总线名>"使用进程内虚拟总线（CANVirtualBus）
+ *   6. 2026-10-18 增加BPF载荷过滤（CANPayloadFilter）
+ *   7. 2026-10-18 增加接收路径同步监听（CANFrameListener）
  ***************************************************************/
 
 #ifndef IMX6ULL_DRIVERS_CAN_H
@@ -34,6 +40,12 @@
 #include <QCanBusFrame>
 #include <QCanBusDeviceInfo>
 
+class CANTxScheduler;
+class CANTimingAnalyzer;
+class CANBusMonitor;
+class CANPayloadFilter;
+class CANFrameListener;
+
 /***************************************************************
  * 类名: DriverCAN
  * 功能: CAN总线驱动类
@@ -149,6 +161,33 @@ public:
      */
     void clearFilters();
     
+    /**
+     * @brief 设置载荷过滤规则（编译为BPF挂到接收套接字，内核中丢弃）
+     * @param rules 规则文本，语法见CANPayloadFilter.h，空字符串表示清除
+     * @param passErrorFrames 是否接收错误帧
+     * @return true=成功, false=规则语法错误
+     * @note 可在打开前或打开后调用；无法挂载时退化为接收路径中过滤
+     */
+    bool setPayloadFilter(const QString &rules, bool passErrorFrames = true);
+    
+    /**
+     * @brief 获取载荷过滤器
+     * @return 过滤器指针（由驱动持有，始终有效）
+     */
+    CANPayloadFilter* getPayloadFilter() const { return m_payloadFilter; }
+    
+    /**
+     * @brief 设置接收路径监听器（每个有效帧同步回调一次）
+     * @param listener 监听器指针（不转移所有权），nullptr表示取消
+     * @note 独立接收线程模式下在接收线程中回调，见CANFrameListener.h
+     */
+    virtual void setFrameListener(CANFrameListener *listener);
+    
+    /**
+     * @brief 获取接收路径监听器
+     */
+    CANFrameListener* getFrameListener() const { return m_frameListener; }
+    
     // ========== CAN帧发送 ==========
     
     /**
@@ -182,6 +221,65 @@ public:
      */
     bool writeFrame(const QCanBusFrame &frame);
     
+    // ========== 发送调度 ==========
+    
+    /**
+     * @brief 启用优先级发送调度器
+     * @param maxInFlight 最多允许在途（已交给内核未上总线）的帧数
+     * @note 启用后所有writeXxx()都经调度器排队，返回值表示是否入队成功
+     */
+    void enableTxScheduler(int maxInFlight = 4);
+    
+    /**
+     * @brief 禁用优先级发送调度器（丢弃未发送的排队帧）
+     */
+    void disableTxScheduler();
+    
+    /**
+     * @brief 获取发送调度器
+     * @return 调度器指针，未启用返回nullptr
+     */
+    CANTxScheduler* getTxScheduler() const { return m_txScheduler; }
+    
+    /**
+     * @brief 按指定优先级发送帧
+     * @param frame CAN帧对象
+     * @param priority 优先级（CANTxScheduler::Priority）
+     * @return true=已入队/已发送, false=失败
+     * @note 未启用调度器时直接发送，忽略priority
+     */
+    bool queueFrame(const QCanBusFrame &frame, int priority);
+    
+    // ========== 总线监测 ==========
+    
+    /**
+     * @brief 启用按ID的周期与抖动分析器
+     * @param maxIds 最多跟踪的ID数
+     * @return 分析器指针（由驱动持有）
+     * @note 接收路径每帧O(1)更新，可在满负载总线上长期开启
+     */
+    virtual CANTimingAnalyzer* enableTimingAnalyzer(int maxIds = 1024);
+    
+    /**
+     * @brief 获取时序分析器
+     * @return 分析器指针，未启用返回nullptr
+     */
+    CANTimingAnalyzer* getTimingAnalyzer() const { return m_timingAnalyzer; }
+    
+    /**
+     * @brief 启用控制器错误状态监测
+     * @return 监测器指针（由驱动持有）
+     * @note 订阅所有错误帧（CAN_ERR_MASK），错误帧交给监测器处理，
+     *       不再进入接收缓冲区；总线关闭时按退避策略自动重启控制器
+     */
+    virtual CANBusMonitor* enableBusMonitor();
+    
+    /**
+     * @brief 获取总线监测器
+     * @return 监测器指针，未启用返回nullptr
+     */
+    CANBusMonitor* getBusMonitor() const { return m_busMonitor; }
+    
     // ========== 状态查询 ==========
     
     /**
@@ -314,6 +412,20 @@ signals:
      */
     void stateChanged(QCanBusDevice::CanBusDeviceState state);
     
+protected slots:
+    /**
+     * @brief 本地回显帧处理（帧已发送到总线）
+     * @note 由接收路径调用，释放发送调度器的在途额度
+     */
+    void onLocalEchoReceived();
+    
+    /**
+     * @brief 错误帧处理
+     * @param frame 错误帧
+     * @note 由接收路径调用，转交总线监测器
+     */
+    void onErrorFrameReceived(const QCanBusFrame &frame);
+    
 private slots:
     /**
      * @brief 帧接收就绪槽函数
@@ -346,6 +458,19 @@ private:
     QVector<QCanBusFrame> m_receiveBuffer;  // 接收帧缓冲队列
     int m_receiveBufferMaxSize;             // 接收缓冲区最大帧数
     
+    CANTxScheduler *m_txScheduler;          // 发送调度器（可选）
+    CANTimingAnalyzer *m_timingAnalyzer;    // 时序分析器（可选）
+    CANBusMonitor *m_busMonitor;            // 总线监测器（可选）
+    CANPayloadFilter *m_payloadFilter;      // 载荷过滤器
+    CANFrameListener *m_frameListener;      // 接收路径监听器（可选，不持有）
+    
+    /**
+     * @brief 直接交给底层设备发送（不经调度器）
+     * @param frame CAN帧对象
+     * @return true=成功, false=失败
+     */
+    bool writeFrameDirect(const QCanBusFrame &frame);
+    
     /**
      * @brief 创建CAN设备对象
      * @return true=成功, false=失败
@@ -26,17 +26,31 @@
  *
  * History:
  *   1. 2025-10-15 创建文件，实现独立接收线程
+ *   2. 2026-10-18 本地回显帧转交发送调度器，不进入接收缓冲区
+ *   3. 2026-10-18 增加多消费者广播环形缓冲区（CANBroadcastRing）
+ *   4. 2026-10-18 接收线程接入按ID的周期与抖动分析器
+ *   5. 2026-10-18 错误帧转交总线监测器（CANBusMonitor）
+ *   6. 2026-10-18 载荷过滤无法挂载BPF时在接收线程中过滤
+ *   7. 2026-10-18 接收线程同步回调接收监听器（CANFrameListener）
+ *   8. 2026-10-18 增加带索引的抓包写入（CANTraceWriter）
+ *   9. 2026-10-18 取下接收监听器时等待正在执行的回调结束
  ***************************************************************/
 
 #ifndef DRIVERCANHIGHPERF_H
 #define DRIVERCANHIGHPERF_H
 
 #include "drivers/can/DriverCAN.h"
+#include "drivers/can/CANBroadcastRing.h"
+#include "drivers/can/CANTraceWriter.h"
+#include "drivers/can/CANTimingAnalyzer.h"
+#include "drivers/can/CANPayloadFilter.h"
+#include "drivers/can/CANFrameListener.h"
 #include <QThread>
 #include <QMutex>
 #include <QWaitCondition>
 #include <QQueue>
 #include <QAtomicInt>
+#include <QAtomicPointer>
 
 /***************************************************************
  * 类名: CANReceiveThread
@@ -99,6 +113,36 @@ public:
     quint64 getReceivedCount() const { return m_receivedCount; }
     quint64 getDroppedCount() const { return m_droppedCount; }
     
+    /**
+     * @brief 设置广播环（接收线程每帧写入一次）
+     * @param ring 广播环指针，nullptr表示不使用
+     */
+    void setBroadcastRing(CANBroadcastRing *ring) { m_ring.storeRelease(ring); }
+    
+    /**
+     * @brief 设置时序分析器（接收线程每帧更新）
+     * @param analyzer 分析器指针，nullptr表示不使用
+     */
+    void setTimingAnalyzer(CANTimingAnalyzer *analyzer) { m_analyzer.storeRelease(analyzer); }
+    
+    /**
+     * @brief 设置是否把错误帧转交总线监测器（不进入缓冲区）
+     */
+    void setErrorFrameForwarding(bool enable) { m_forwardErrors.store(enable ? 1 : 0); }
+    
+    /**
+     * @brief 设置载荷过滤器（BPF无法挂载时在接收线程中过滤）
+     * @param filter 过滤器指针，nullptr表示不使用
+     */
+    void setPayloadFilter(const CANPayloadFilter *filter) { m_payloadFilter.storeRelease(filter); }
+    
+    /**
+     * @brief 设置接收监听器（接收线程每帧同步回调）
+     * @param listener 监听器指针，nullptr表示不使用
+     * @note 返回时旧监听器的回调已全部结束，之后可以释放旧监听器
+     */
+    void setFrameListener(CANFrameListener *listener);
+    
 signals:
     /**
      * @brief 新帧到达信号（在接收线程中发出）
@@ -112,6 +156,19 @@ signals:
      */
     void bufferOverflow(int droppedCount);
     
+    /**
+     * @brief 收到本地回显帧信号（本机发送的帧已上总线）
+     * @note 在接收线程中发出，用于释放发送调度器的在途额度
+     */
+    void localEchoReceived();
+    
+    /**
+     * @brief 收到错误帧信号（启用错误帧转交时）
+     * @param frame 错误帧
+     * @note 在接收线程中发出，由总线监测器在主线程处理
+     */
+    void errorFrameReceived(const QCanBusFrame &frame);
+    
 protected:
     /**
      * @brief 线程运行函数（接收循环）
@@ -129,6 +186,13 @@ private:
     
     quint64 m_receivedCount;           // 接收计数
     quint64 m_droppedCount;            // 丢弃计数
+    
+    QAtomicPointer<CANBroadcastRing> m_ring;  // 广播环（可选）
+    QAtomicPointer<CANTimingAnalyzer> m_analyzer;  // 时序分析器（可选）
+    QAtomicInt m_forwardErrors;        // 错误帧转交标志
+    QAtomicPointer<const CANPayloadFilter> m_payloadFilter;  // 载荷过滤器（用户空间退化）
+    QAtomicPointer<CANFrameListener> m_listener;  // 接收监听器（可选）
+    QMutex m_listenerMutex;            // 回调期间持有，更换监听器时等待回调结束
 };
 
 /***************************************************************
@@ -210,6 +274,64 @@ public:
      */
     bool isThreadedReceiveRunning() const;
     
+    // ========== 多消费者广播 ==========
+    
+    /**
+     * @brief 启用多消费者广播环
+     * @param capacity 槽位数（向上取整为2的幂）
+     * @return 广播环指针（由驱动持有）
+     * @note 各消费者通过registerConsumer()注册后在自己的线程中poll()，
+     *       接收线程每帧只写入一次，与消费者数量无关
+     */
+    CANBroadcastRing* enableBroadcastRing(int capacity = 4096);
+    
+    /**
+     * @brief 获取广播环
+     * @return 广播环指针，未启用返回nullptr
+     */
+    CANBroadcastRing* getBroadcastRing() const { return m_broadcastRing; }
+    
+    // ========== 抓包 ==========
+    
+    /**
+     * @brief 开始写入带索引的抓包文件
+     * @param path 抓包文件路径（索引为path + ".idx"）
+     * @return true=成功, false=失败
+     * @note 未启用广播环时自动启用；写入在独立线程中进行，不影响接收线程
+     */
+    bool startTrace(const QString &path);
+    
+    /**
+     * @brief 停止抓包并关闭文件
+     */
+    void stopTrace();
+    
+    /**
+     * @brief 获取抓包写入器（可调整块大小、读取统计）
+     */
+    CANTraceWriter* getTraceWriter() { return &m_traceWriter; }
+    
+    // ========== 总线监测 ==========
+    
+    /**
+     * @brief 启用时序分析器（覆盖基类，同时接入独立接收线程）
+     * @param maxIds 最多跟踪的ID数
+     * @return 分析器指针
+     */
+    CANTimingAnalyzer* enableTimingAnalyzer(int maxIds = 1024) override;
+    
+    /**
+     * @brief 启用总线监测（覆盖基类，同时让接收线程转交错误帧）
+     * @return 监测器指针
+     */
+    CANBusMonitor* enableBusMonitor() override;
+    
+    /**
+     * @brief 设置接收监听器（覆盖基类，同时接入独立接收线程）
+     * @param listener 监听器指针，nullptr表示取消
+     */
+    void setFrameListener(CANFrameListener *listener) override;
+    
 signals:
     /**
      * @brief 高性能帧接收信号（从独立线程发出）
@@ -221,6 +343,8 @@ signals:
 private:
     CANReceiveThread *m_receiveThread;  // 独立接收线程
     bool m_threadedReceiveEnabled;      // 是否启用独立线程
+    CANBroadcastRing *m_broadcastRing;  // 多消费者广播环（可选）
+    CANTraceWriter m_traceWriter;       // 抓包写入器
 };
 
 #endif // DRIVERCANHIGHPERF_H
@@ -3,7 +3,10 @@
 
 #include <QObject>
 #include <QMap>
+#include <QList>
 #include <QString>
+#include <QVariant>
+#include "drivers/serial/SerialRs485.h"
 
 // 前置声明
 class DriverGPIO;
@@ -106,9 +109,10 @@ public:
     /**
      * @brief 创建或获取CAN驱动
      * @param interfaceName CAN接口名称（例如："can0"）
+     * @param highPerf 新建时是否使用独立接收线程（DriverCANHighPerf）
      * @return DriverCAN指针，失败返回nullptr
      */
-    DriverCAN* getCAN(const QString &interfaceName);
+    DriverCAN* getCAN(const QString &interfaceName, bool highPerf = false);
     
     /**
      * @brief 释放CAN驱动
@@ -161,6 +165,33 @@ public:
      */
     DriverSerial* getSerialByAlias(const QString &alias);
     
+    /**
+     * @brief 通过别名获取CAN驱动
+     * @param alias 设备别名（如 "CAN0"）
+     * @return DriverCAN指针，不存在返回nullptr
+     */
+    DriverCAN* getCANByAlias(const QString &alias);
+    
+    /**
+     * @brief 获取串口配置节中的RS-485参数
+     * @param portName 串口设备路径
+     * @return 该设备[Serial/...]配置节的rs485_*参数，未配置时模式为off
+     * @note 供自行打开串口的Modbus主站/从站在打开后设置内核方向控制
+     */
+    SerialRs485Config getSerialRs485(const QString &portName) const;
+    
+    /**
+     * @brief 获取CAN信号到Modbus寄存器的映射配置（[CANModbus/...]配置节）
+     * @return 每个已启用配置节的全部参数（含name），由Modbus从站服务编译使用
+     */
+    QList<QVariantMap> getCANModbusMappings() const { return m_canModbusMappings; }
+    
+    /**
+     * @brief 获取串口TCP桥配置（[SerialBridge/...]配置节）
+     * @return 每个已启用配置节的全部参数（含name），由串口桥服务创建桥使用
+     */
+    QList<QVariantMap> getSerialBridgeConfigs() const { return m_serialBridgeConfigs; }
+    
     /**
      * @brief 获取所有已配置的设备别名
      * @return 别名列表
@@ -229,6 +260,10 @@ private:
     QMap<QString, int> m_gpioAliases;                 // GPIO别名映射
     QMap<QString, QString> m_ledAliases;              // LED别名映射
     QMap<QString, QString> m_serialAliases;           // 串口别名映射
+    QMap<QString, QString> m_canAliases;              // CAN别名映射
+    
+    QList<QVariantMap> m_canModbusMappings;           // CAN→Modbus映射配置
+    QList<QVariantMap> m_serialBridgeConfigs;         // 串口TCP桥配置
     
     /**
      * @brief 生成PWM驱动的键名
@@ -25,6 +25,12 @@
  *
  * History:
  *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 读缓冲区改为环形缓冲区，增加peek/skip/indexOf
+ *   3. 2026-10-18 增加分帧器，直接在读缓冲区上提取完整帧
+ *   4. 2026-10-18 增加可选的独立I/O线程后端（epoll + termios）
+ *   5. 2026-10-18 写缓冲区改为分段队列（writev），增加背压和发送完成通知
+ *   6. 2026-10-18 增加RS-485方向控制（内核TIOCSRS485 / I/O线程GPIO）
+ *   7. 2026-10-18 增加收发抓包（固定大小环形文件）
  ***************************************************************/
 
 #ifndef IMX6ULL_DRIVERS_SERIAL_H
@@ -35,6 +41,14 @@
 #include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QByteArray>
+#include "drivers/serial/SerialRingBuffer.h"
+#include "drivers/serial/SerialFramer.h"
+#include "drivers/serial/SerialIoThread.h"
+#include "drivers/serial/SerialWriteQueue.h"
+#include "drivers/serial/SerialRs485.h"
+#include "drivers/serial/SerialTraceWriter.h"
+
+class QSocketNotifier;
 
 /***************************************************************
  * 类名: DriverSerial
@@ -151,8 +165,8 @@ public:
     
     /**
      * @brief 写入数据
-     * @param data 要写入的数据
-     * @return 实际写入的字节数，-1表示失败
+     * @param data 要写入的数据（作为一个分段入队，共享存储不拷贝）
+     * @return 入队的字节数，-1表示失败（未打开或发送队列已满）
      */
     qint64 write(const QByteArray &data);
     
@@ -182,6 +196,28 @@ public:
      */
     QByteArray readLine();
     
+    /**
+     * @brief 查看数据但不从读缓冲区移除
+     * @param maxSize 最大字节数
+     * @return 读缓冲区开头的数据
+     */
+    QByteArray peek(qint64 maxSize) const;
+    
+    /**
+     * @brief 丢弃读缓冲区开头的数据
+     * @param size 字节数
+     * @return 实际丢弃的字节数
+     */
+    qint64 skip(qint64 size);
+    
+    /**
+     * @brief 在读缓冲区中查找字节（不拷贝）
+     * @param c 目标字节
+     * @param from 起始偏移
+     * @return 偏移，-1表示未找到
+     */
+    int indexOf(char c, int from = 0) const;
+    
     /**
      * @brief 获取可读字节数
      * @return 可读字节数
@@ -201,7 +237,8 @@ public:
     void clear();
     
     /**
-     * @brief 刷新发送缓冲区（立即发送）
+     * @brief 刷新发送缓冲区（立即尝试写出，不阻塞）
+     * @note 全部写出后发出writeQueueDrained信号
      */
     void flush();
     
@@ -235,6 +272,124 @@ public:
      */
     void clearWriteBuffer();
     
+    /**
+     * @brief 设置发送队列上限
+     * @param maxBytes 最大排队字节数（高水位3/4、低水位1/4）
+     * @param maxSegments 最大分段数
+     */
+    void setWriteQueueLimits(qint64 maxBytes, int maxSegments = 4096);
+    
+    /**
+     * @brief 发送队列是否处于背压状态（高于高水位，尚未降到低水位）
+     */
+    bool isWriteBackpressured() const { return m_writeBackpressure; }
+    
+    /**
+     * @brief 获取读缓冲区（连续区间访问、原地解析用）
+     * @return 环形缓冲区指针
+     * @note 只能在串口所属线程中访问
+     */
+    SerialRingBuffer* getReadRing() { return &m_readBuffer; }
+    
+    /**
+     * @brief 获取读缓冲区溢出次数
+     * @return 溢出次数（每次溢出丢弃最旧的数据）
+     */
+    quint64 getReadOverflowCount() const { return m_readBuffer.getOverflowCount(); }
+    
+    // ========== 分帧 ==========
+    
+    /**
+     * @brief 设置分帧器（接管所有权，nullptr表示不分帧）
+     * @param framer 分帧器
+     * @note 设置后读缓冲区由分帧器消费，完整帧通过frameReceived信号发出；
+     *       dataReceived信号仍照常发出
+     */
+    void setFramer(SerialFramer *framer);
+    
+    /**
+     * @brief 获取当前分帧器
+     * @return 分帧器指针，未设置返回nullptr
+     */
+    SerialFramer* getFramer() const { return m_pFramer; }
+    
+    /**
+     * @brief 立即对读缓冲区中已有数据分帧
+     * @return 提取的帧数
+     */
+    int processFrames();
+    
+    // ========== 独立I/O线程 ==========
+    
+    /**
+     * @brief 启用/停用独立I/O线程后端（需在open()前调用）
+     * @param enable true=由SerialIoThread直接操作tty, false=使用QSerialPort
+     * @param options VMIN/VTIME、低延迟、唤醒提示等参数
+     * @return true=成功, false=串口已打开
+     * @note 串口参数仍通过setBaudRate()等接口设置，open()时写入termios；
+     *       读缓冲区、分帧器和各信号的用法不变
+     */
+    bool setIoThreadEnabled(bool enable, const SerialIoOptions &options = SerialIoOptions());
+    
+    /**
+     * @brief 是否使用独立I/O线程后端
+     */
+    bool isIoThreadEnabled() const { return m_useIoThread; }
+    
+    /**
+     * @brief 获取I/O线程（未启用时为nullptr）
+     */
+    SerialIoThread* getIoThread() const { return m_pIoThread; }
+    
+    /**
+     * @brief 设置接收监听器（nullptr表示不使用）
+     * @param listener 监听器
+     * @note I/O线程后端在I/O线程中回调；QSerialPort后端在所属线程中回调
+     */
+    void setDataListener(SerialDataListener *listener);
+    
+    // ========== RS-485 ==========
+    
+    /**
+     * @brief 设置RS-485方向控制（需在open()前调用）
+     * @param config 模式、RTS极性、前后延迟、发送期间是否接收、GPIO
+     * @return true=成功, false=串口已打开
+     * @note GPIO模式（含自动模式回退到GPIO）发送由I/O线程完成，
+     *       未启用I/O线程时open()自动启用
+     */
+    bool setRs485(const SerialRs485Config &config);
+    
+    /**
+     * @brief 获取RS-485配置
+     */
+    SerialRs485Config getRs485() const { return m_rs485; }
+    
+    /**
+     * @brief 获取实际生效的方向控制模式（open()后有效，自动模式已确定为Kernel/Gpio/Off）
+     */
+    SerialRs485Config::Mode getRs485ActiveMode() const { return m_rs485Active; }
+    
+    // ========== 抓包 ==========
+    
+    /**
+     * @brief 开始把收发数据记录到环形抓包文件
+     * @param path 抓包文件路径（已存在时接着写）
+     * @return true=成功, false=失败
+     * @note 接收数据按read()返回时刻、发送数据按write()入队时刻记录；
+     *       写文件在独立线程中批量进行，可长期开启
+     */
+    bool startTrace(const QString &path);
+    
+    /**
+     * @brief 停止抓包并关闭文件
+     */
+    void stopTrace();
+    
+    /**
+     * @brief 获取抓包写入器（可调整文件大小、读取统计）
+     */
+    SerialTraceWriter* getTraceWriter() { return &m_traceWriter; }
+    
     // ========== 状态查询 ==========
     
     /**
@@ -288,6 +443,30 @@ signals:
      */
     void dataReceived(const QByteArray &data);
     
+    /**
+     * @brief 完整帧信号（需设置分帧器）
+     * @param frame 帧视图，指向读缓冲区内部，只在槽函数内有效
+     * @note 只能用直接连接（同线程默认连接），需保留数据时调用frame.toByteArray()
+     */
+    void frameReceived(const SerialFrameView &frame);
+    
+    /**
+     * @brief 数据已写入内核信号
+     * @param bytes 本次写出的字节数
+     */
+    void bytesWritten(qint64 bytes);
+    
+    /**
+     * @brief 发送队列已全部写入内核信号（非阻塞的发送完成通知）
+     */
+    void writeQueueDrained();
+    
+    /**
+     * @brief 发送队列背压信号
+     * @param active true=超过高水位，应暂停写入; false=降到低水位，可以恢复
+     */
+    void writeBackpressure(bool active);
+    
     /**
      * @brief 串口打开成功信号
      */
@@ -316,12 +495,42 @@ private slots:
      * @param serialError 串口错误类型
      */
     void onError(QSerialPort::SerialPortError serialError);
+    
+    /**
+     * @brief I/O线程数据到达槽函数
+     * @note 由SerialIoThread::dataAvailable信号触发（排队连接）
+     */
+    void onIoDataAvailable();
+    
+    /**
+     * @brief I/O线程错误槽函数
+     * @param errorString 错误描述
+     */
+    void onIoError(const QString &errorString);
 
 private:
+    /**
+     * @brief 新数据进入读缓冲区并通知上层（两种后端共用）
+     * @param data 新接收的数据
+     */
+    void handleReceivedData(const QByteArray &data);
+    
+    /**
+     * @brief 写出进度处理（背压解除、发送完成通知）
+     * @param bytes 本次写出的字节数
+     */
+    void onWriteProgress(qint64 bytes);
+    
     /**
      * @brief 处理写缓冲区数据（异步发送）
      */
     void processWriteBuffer();
+    
+    /**
+     * @brief 在已打开的fd上启用内核RS-485（内核模式时）
+     * @return true=成功或无需设置
+     */
+    bool applyRs485(int fd);
 
 private:
     QSerialPort *m_pSerialPort;  // Qt串口对象
@@ -329,10 +538,24 @@ private:
     bool m_isConfigured;         // 配置状态标志
     
     // 缓冲区
-    QByteArray m_readBuffer;     // 读缓冲区（累积接收的数据）
-    QByteArray m_writeBuffer;    // 写缓冲区（待发送的数据）
-    qint64 m_readBufferMaxSize;  // 读缓冲区最大大小
-    bool m_isWriting;            // 是否正在发送数据
+    SerialRingBuffer m_readBuffer;  // 读缓冲区（累积接收的数据）
+    SerialFramer *m_pFramer;     // 分帧器（可选）
+    
+    // 独立I/O线程后端
+    bool m_useIoThread;          // 是否使用I/O线程
+    SerialIoOptions m_ioOptions; // I/O线程参数
+    SerialIoThread *m_pIoThread; // I/O线程（启用后创建）
+    SerialDataListener *m_pDataListener;  // 接收监听器
+    SerialWriteQueue m_writeQueue;  // 写缓冲区（分段队列）
+    QSocketNotifier *m_pWriteNotifier;  // 可写通知（QSerialPort后端）
+    bool m_writeBackpressure;    // 是否处于背压状态
+    
+    // RS-485
+    SerialRs485Config m_rs485;   // 方向控制配置
+    SerialRs485Config::Mode m_rs485Active;  // 实际生效的模式
+    
+    // 抓包
+    SerialTraceWriter m_traceWriter; // 抓包写入器（析构函数中先关闭I/O线程再停止）
 };
 
 #endif // DRIVER_SERIAL_H
@@ -0,0 +1,111 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialCrc16.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CRC16/MODBUS公共实现（查表、slicing-by-8、NEON）
+ *
+ * 功能说明:
+ *   Modbus RTU主站、从站、总线监视器和SerialFramer共用的CRC16
+ *   （多项式0x8005反射即0xA001，初值0xFFFF，低字节在前）:
+ *   - Bitwise: 逐位计算，仅作基准和校验参考
+ *   - Table: 256项查表，每字节一次查表，逐字节增量更新使用
+ *   - Slicing8: 8张表每次处理8字节，默认实现
+ *   - Neon: 每16字节用vmull.p8按位置常数做无进位乘法并横向异或，
+ *     再查3张归约表；仅在编译器开启NEON时可用，定义SERIAL_CRC16_NEON
+ *     （CMake选项SERIAL_CRC16_NEON）后作为默认实现
+ *   各实现结果完全相同，tools/crc_bench在目标板上比较速度。
+ *
+ *   支持增量计算: 字节到达时即可更新，帧收完时CRC也已算完。
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_CRC16_H
+#define IMX6ULL_DRIVERS_SERIAL_CRC16_H
+
+#include <QtGlobal>
+#include <QByteArray>
+
+/***************************************************************
+ * 类名: SerialCrc16
+ * 功能: CRC16/MODBUS计算（静态接口 + 增量对象）
+ *
+ * 使用示例:
+ *   quint16 crc = SerialCrc16::modbus(frame.constData(), frame.size() - 2);
+ *   bool ok = SerialCrc16::modbusCheck(frame.constData(), frame.size());
+ *
+ *   SerialCrc16 crc;                   // 增量计算
+ *   crc.update(chunk1, len1);
+ *   crc.update(chunk2, len2);
+ *   quint16 value = crc.value();
+ ***************************************************************/
+class SerialCrc16
+{
+public:
+    /**
+     * @brief 实现方式
+     */
+    enum Method
+    {
+        Bitwise,        // 逐位
+        Table,          // 256项查表
+        Slicing8,       // slicing-by-8
+        Neon            // NEON无进位乘法
+    };
+
+    static const quint16 ModbusInit = 0xFFFF;
+
+    SerialCrc16() : m_crc(ModbusInit) {}
+
+    // ========== 增量计算 ==========
+
+    void reset() { m_crc = ModbusInit; }
+    void update(quint8 byte);
+    void update(const char *data, int length) { m_crc = modbusUpdate(m_crc, data, length); }
+    quint16 value() const { return m_crc; }
+
+    // ========== 静态接口（使用默认实现） ==========
+
+    /**
+     * @brief 计算CRC16/MODBUS
+     */
+    static quint16 modbus(const char *data, int length) { return modbusUpdate(ModbusInit, data, length); }
+    static quint16 modbus(const QByteArray &data) { return modbus(data.constData(), data.size()); }
+
+    /**
+     * @brief 在已有CRC上继续计算
+     */
+    static quint16 modbusUpdate(quint16 crc, const char *data, int length);
+
+    /**
+     * @brief 用指定实现计算（基准测试和交叉校验使用）
+     * @note 不可用的实现退回查表
+     */
+    static quint16 modbusUpdate(quint16 crc, const char *data, int length, Method method);
+
+    /**
+     * @brief 校验帧尾的CRC（低字节在前）
+     * @param frame 含CRC的完整帧
+     * @param length 帧长度（<3返回false）
+     */
+    static bool modbusCheck(const char *frame, int length);
+
+    /**
+     * @brief 在帧尾追加CRC（低字节在前）
+     */
+    static void modbusAppend(QByteArray &frame);
+
+    // ========== 实现信息 ==========
+
+    static Method defaultMethod();
+    static bool isAvailable(Method method);
+    static const char *methodName(Method method);
+
+private:
+    quint16 m_crc;
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_CRC16_H
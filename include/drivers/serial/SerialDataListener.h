@@ -0,0 +1,46 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialDataListener.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口接收路径监听接口
+ *
+ * 功能说明:
+ *   dataReceived信号在DriverSerial所属线程中发出，延迟受主循环其他
+ *   工作影响。使用独立I/O线程（SerialIoThread）时，实现本接口并通过
+ *   DriverSerial::setDataListener()挂接，数据从tty读出后立即在I/O线程
+ *   中同步回调，不经过Qt事件循环
+ *
+ * 注意:
+ *   - 回调在I/O线程中执行，不要阻塞，也不要访问DriverSerial的读缓冲区
+ *   - 数据指针只在回调内有效
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_DATA_LISTENER_H
+#define IMX6ULL_DRIVERS_SERIAL_DATA_LISTENER_H
+
+#include <QtGlobal>
+
+/***************************************************************
+ * 类名: SerialDataListener
+ * 功能: 接收路径同步回调接口
+ ***************************************************************/
+class SerialDataListener
+{
+public:
+    virtual ~SerialDataListener() {}
+
+    /**
+     * @brief 收到数据（每次read()一次，未经唤醒提示合并）
+     * @param data 数据
+     * @param length 长度
+     * @param timestampUs 读出时刻（CLOCK_MONOTONIC，微秒）
+     */
+    virtual void serialDataReceived(const char *data, int length, qint64 timestampUs) = 0;
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_DATA_LISTENER_H
@@ -0,0 +1,331 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialFramer.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口分帧引擎（直接在读缓冲区上提取完整帧）
+ *
+ * 功能说明:
+ *   各业务模块原先在DriverSerial::peek()/read()之上各自手写帧头
+ *   查找、长度判断和校验，每一步都要拷贝。分帧器挂在串口读缓冲区
+ *   上，直接在环形缓冲区中扫描，输出完整帧的视图:
+ *   - SerialDelimiterFramer      分隔符（如"\r\n"）
+ *   - SerialFixedLengthFramer    定长帧（可选帧头同步）
+ *   - SerialLengthPrefixFramer   帧头+长度字段
+ *   - SerialSlipFramer           SLIP（RFC 1055）
+ *   - SerialCobsFramer           COBS（0x00分隔）
+ *   每种分帧器都可附加CRC校验（Modbus CRC16、CCITT CRC16、8位和）
+ *
+ * 增量扫描:
+ *   分帧器记录已检查过的偏移，数据到达后只扫描新增部分；遇到垃圾
+ *   数据只丢弃到下一个可能的帧头，不会重复扫描已检查的字节
+ *
+ * 帧视图:
+ *   帧未跨越环形缓冲区回绕点时直接指向缓冲区内部；跨越回绕点或需要
+ *   解码（SLIP/COBS）时指向分帧器内部的复用缓冲区。视图只在回调/
+ *   槽函数内有效，需要保留时自行拷贝
+ *
+ * 使用示例:
+ *   serial.setFramer(new SerialLengthPrefixFramer(QByteArray("\xAA\x55", 2),
+ *                                                 2, 1, true, 5));
+ *   connect(&serial, &DriverSerial::frameReceived,
+ *           [](const SerialFrameView &frame) { ... });
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_FRAMER_H
+#define IMX6ULL_DRIVERS_SERIAL_FRAMER_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include "drivers/serial/SerialRingBuffer.h"
+
+/**
+ * @brief 帧视图（只在回调内有效）
+ */
+struct SerialFrameView
+{
+    const char *data;   // 帧数据（含CRC）
+    int length;         // 帧长度
+
+    QByteArray toByteArray() const { return QByteArray(data, length); }
+};
+
+/***************************************************************
+ * 类名: SerialFramer
+ * 功能: 分帧器基类
+ *
+ * 描述:
+ *   子类实现scan()，在读缓冲区上识别下一帧的位置；基类负责
+ *   拼接跨回绕点的帧、CRC校验、消费缓冲区和统计
+ ***************************************************************/
+class SerialFramer
+{
+public:
+    /**
+     * @brief CRC类型（CRC位于帧末尾，覆盖其前的全部帧内容）
+     */
+    enum CrcType {
+        CrcNone = 0,
+        CrcModbus,      // CRC16/MODBUS，多项式0xA001反射，低字节在前
+        CrcCcitt,       // CRC16/CCITT-FALSE，多项式0x1021，初值0xFFFF，高字节在前
+        CrcSum8         // 8位累加和
+    };
+
+    /**
+     * @brief 帧回调
+     */
+    class Handler
+    {
+    public:
+        virtual ~Handler() {}
+        virtual void onFrame(const SerialFrameView &frame) = 0;
+    };
+
+    SerialFramer();
+    virtual ~SerialFramer();
+
+    /**
+     * @brief 设置CRC校验
+     */
+    void setCrc(CrcType type) { m_crcType = type; }
+    CrcType getCrc() const { return m_crcType; }
+
+    /**
+     * @brief 从读缓冲区提取所有完整帧
+     * @param ring 串口读缓冲区（完整帧和垃圾数据会被消费）
+     * @param handler 帧回调
+     * @return 本次提取的帧数
+     */
+    int process(SerialRingBuffer &ring, Handler *handler);
+
+    /**
+     * @brief 复位扫描状态（读缓冲区被外部读取或清空后调用）
+     */
+    void reset();
+
+    // ========== 统计 ==========
+
+    quint64 getFrameCount() const { return m_frameCount; }
+    quint64 getCrcErrorCount() const { return m_crcErrorCount; }
+    quint64 getDiscardedBytes() const { return m_discardedBytes; }
+
+    /**
+     * @brief 计算CRC
+     */
+    static quint16 crc16Modbus(const char *data, int length);
+    static quint16 crc16Ccitt(const char *data, int length);
+    static quint8 sum8(const char *data, int length);
+
+protected:
+    /**
+     * @brief 扫描结果
+     */
+    enum ScanStatus {
+        NeedMore = 0,   // 数据不足
+        FrameFound,     // 找到完整帧
+        Discard         // 丢弃开头的垃圾数据
+    };
+
+    struct ScanResult
+    {
+        int frameOffset;    // 帧在缓冲区中的偏移（FrameFound）
+        int frameLength;    // 帧长度（FrameFound）
+        int consume;        // 应消费的字节数（含帧前垃圾、分隔符）
+    };
+
+    /**
+     * @brief 识别下一帧
+     * @note 只应扫描上次调用之后新增的数据，状态保存在子类中；
+     *       返回FrameFound/Discard后基类消费数据并调用resetScan()
+     */
+    virtual ScanStatus scan(const SerialRingBuffer &ring, ScanResult *result) = 0;
+
+    /**
+     * @brief 复位子类的扫描状态
+     */
+    virtual void resetScan() = 0;
+
+    /**
+     * @brief 解码帧（SLIP/COBS重写），默认不解码
+     * @param raw 原始帧（连续）
+     * @param out 解码缓冲区
+     * @return 解码后的帧视图，length<0表示格式错误
+     */
+    virtual SerialFrameView decode(const SerialFrameView &raw, QByteArray *out);
+
+    /**
+     * @brief CRC校验失败时的处理
+     * @return 应丢弃的字节数（默认丢弃整帧；有帧头的分帧器只丢弃1字节以重新同步）
+     */
+    virtual int resyncAfterError(const ScanResult &result) const { return result.consume; }
+
+    /**
+     * @brief 帧视图（跨回绕点时拷贝到m_linear）
+     */
+    SerialFrameView frameView(const SerialRingBuffer &ring, int offset, int length);
+
+    /**
+     * @brief 在缓冲区中查找多字节模式
+     * @return 偏移，-1表示未找到
+     */
+    static int indexOfPattern(const SerialRingBuffer &ring, const QByteArray &pattern, int from);
+
+    bool checkCrc(const SerialFrameView &frame) const;
+    int crcSize() const;
+
+private:
+    Q_DISABLE_COPY(SerialFramer)
+
+    CrcType m_crcType;
+    QByteArray m_linear;            // 跨回绕点的帧拼接缓冲区
+    QByteArray m_decoded;           // 解码缓冲区
+    quint64 m_ringPosition;         // 上次处理后的缓冲区读位置（检测外部读取）
+    bool m_ringPositionValid;
+
+    quint64 m_frameCount;
+    quint64 m_crcErrorCount;
+    quint64 m_discardedBytes;
+};
+
+/***************************************************************
+ * 类名: SerialDelimiterFramer
+ * 功能: 分隔符分帧（帧内容不含分隔符）
+ ***************************************************************/
+class SerialDelimiterFramer : public SerialFramer
+{
+public:
+    /**
+     * @param delimiter 分隔符（1个或多个字节）
+     * @param maxLength 最大帧长，超过仍无分隔符时丢弃
+     */
+    explicit SerialDelimiterFramer(const QByteArray &delimiter = QByteArray("\r\n"),
+                                   int maxLength = 4096);
+
+protected:
+    ScanStatus scan(const SerialRingBuffer &ring, ScanResult *result) override;
+    void resetScan() override { m_scanned = 0; }
+
+private:
+    QByteArray m_delimiter;
+    int m_maxLength;
+    int m_scanned;                  // 已确认不含分隔符起点的字节数
+};
+
+/***************************************************************
+ * 类名: SerialFixedLengthFramer
+ * 功能: 定长分帧（可选帧头同步）
+ ***************************************************************/
+class SerialFixedLengthFramer : public SerialFramer
+{
+public:
+    /**
+     * @param length 帧长（含帧头和CRC）
+     * @param header 帧头，为空时不做同步
+     */
+    explicit SerialFixedLengthFramer(int length, const QByteArray &header = QByteArray());
+
+protected:
+    ScanStatus scan(const SerialRingBuffer &ring, ScanResult *result) override;
+    void resetScan() override { m_scanned = 0; m_synced = false; }
+    int resyncAfterError(const ScanResult &result) const override;
+
+private:
+    int m_length;
+    QByteArray m_header;
+    int m_scanned;                  // 帧头查找已检查的字节数
+    bool m_synced;                  // 缓冲区开头已是帧头
+};
+
+/***************************************************************
+ * 类名: SerialLengthPrefixFramer
+ * 功能: 帧头+长度字段分帧
+ *
+ * 帧长计算:
+ *   帧总长 = 长度字段值 + lengthAdjust
+ *   例: [AA 55][LEN][DATA...][CRC16]，LEN为DATA长度时
+ *       lengthOffset=2, lengthSize=1, lengthAdjust=2+1+2=5
+ ***************************************************************/
+class SerialLengthPrefixFramer : public SerialFramer
+{
+public:
+    /**
+     * @param header 帧头（同步字，可为空）
+     * @param lengthOffset 长度字段在帧内的偏移
+     * @param lengthSize 长度字段字节数（1/2/4）
+     * @param bigEndian 长度字段是否为大端
+     * @param lengthAdjust 帧总长 = 长度字段值 + lengthAdjust
+     * @param maxLength 最大帧长，超出视为失步
+     */
+    SerialLengthPrefixFramer(const QByteArray &header, int lengthOffset, int lengthSize,
+                             bool bigEndian, int lengthAdjust, int maxLength = 4096);
+
+protected:
+    ScanStatus scan(const SerialRingBuffer &ring, ScanResult *result) override;
+    void resetScan() override { m_scanned = 0; m_synced = false; m_frameLength = -1; }
+    int resyncAfterError(const ScanResult &result) const override;
+
+private:
+    QByteArray m_header;
+    int m_lengthOffset;
+    int m_lengthSize;
+    bool m_bigEndian;
+    int m_lengthAdjust;
+    int m_maxLength;
+    int m_scanned;                  // 帧头查找已检查的字节数
+    bool m_synced;                  // 缓冲区开头已是帧头
+    int m_frameLength;              // 已解析出的帧长（-1表示未解析）
+};
+
+/***************************************************************
+ * 类名: SerialSlipFramer
+ * 功能: SLIP分帧（0xC0结束，0xDB转义）
+ ***************************************************************/
+class SerialSlipFramer : public SerialFramer
+{
+public:
+    explicit SerialSlipFramer(int maxLength = 4096);
+
+    /**
+     * @brief SLIP编码（发送用）
+     */
+    static QByteArray encode(const QByteArray &payload);
+
+protected:
+    ScanStatus scan(const SerialRingBuffer &ring, ScanResult *result) override;
+    void resetScan() override { m_scanned = 0; }
+    SerialFrameView decode(const SerialFrameView &raw, QByteArray *out) override;
+
+private:
+    int m_maxLength;
+    int m_scanned;
+};
+
+/***************************************************************
+ * 类名: SerialCobsFramer
+ * 功能: COBS分帧（0x00结束）
+ ***************************************************************/
+class SerialCobsFramer : public SerialFramer
+{
+public:
+    explicit SerialCobsFramer(int maxLength = 4096);
+
+    /**
+     * @brief COBS编码（发送用，含结尾0x00）
+     */
+    static QByteArray encode(const QByteArray &payload);
+
+protected:
+    ScanStatus scan(const SerialRingBuffer &ring, ScanResult *result) override;
+    void resetScan() override { m_scanned = 0; }
+    SerialFrameView decode(const SerialFrameView &raw, QByteArray *out) override;
+
+private:
+    int m_maxLength;
+    int m_scanned;
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_FRAMER_H
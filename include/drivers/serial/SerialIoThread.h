@@ -0,0 +1,239 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialIoThread.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口独立I/O线程（直接操作tty，epoll驱动）
+ *
+ * 功能说明:
+ *   QSerialPort在所属线程（通常是主循环）中收发，读延迟取决于主循环
+ *   当前在做什么，而且不暴露VMIN/VTIME和ASYNC_LOW_LATENCY。本线程
+ *   自己打开tty并用termios配置，在epoll上等待:
+ *   - 低延迟模式: TIOCSSERIAL设置ASYNC_LOW_LATENCY（驱动不支持时忽略）
+ *   - VMIN/VTIME: 直接写入termios。VTIME=0时n_tty只在缓冲数据达到VMIN
+ *     字节时才报告可读，即内核侧的字节数唤醒
+ *   - 唤醒提示: 累计wakeupBytes字节或字节间隔超过interByteGapUs微秒
+ *     （timerfd计时）才通知上层，避免每个字节都唤醒一次
+ *
+ * 数据流向:
+ *   tty -> I/O线程 -> SerialDataListener（I/O线程同步回调）
+ *                  -> 暂存区（互斥锁保护）-> dataAvailable信号 /
+ *                     waitForData()唤醒 -> DriverSerial读缓冲区
+ *
+ * RS-485 GPIO方向控制:
+ *   发送全部在本线程进行: 先收走已到达的数据，打开DE，延迟后写出
+ *   队列，按字符时间睡到快发完，再轮询TIOCSERGETLSR直到移位寄存器
+ *   空，延迟后（不接收回波时先清空输入队列）关闭DE
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 发送改为共享分段队列（SerialWriteQueue），用writev写出
+ *   3. 2026-10-18 增加RS-485 GPIO方向控制（发送前后切换，微秒级换向）
+ *   4. 2026-10-18 接收数据在本线程记录到抓包写入器（时间戳取自read()返回时）
+ *   5. 2026-10-18 等待发送完成按已写字节数睡眠，不再忙等LSR
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_IO_THREAD_H
+#define IMX6ULL_DRIVERS_SERIAL_IO_THREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QByteArray>
+#include <QString>
+#include <QSerialPort>
+#include "drivers/serial/SerialRingBuffer.h"
+#include "drivers/serial/SerialDataListener.h"
+#include "drivers/serial/SerialWriteQueue.h"
+#include "drivers/serial/SerialRs485.h"
+#include "drivers/serial/SerialTraceWriter.h"
+
+/**
+ * @brief I/O线程参数
+ */
+struct SerialIoOptions
+{
+    bool lowLatency;        // 设置ASYNC_LOW_LATENCY
+    int vmin;               // termios VMIN（0-255）
+    int vtime;              // termios VTIME（0.1秒单位，0-255）
+    int wakeupBytes;        // 累计字节数达到该值时通知上层（1=每次读到数据都通知）
+    int interByteGapUs;     // 字节间隔超过该值时通知上层（0=不使用）
+    int stageSize;          // 暂存区大小（字节）
+    int priority;           // 线程优先级（QThread::Priority）
+
+    SerialIoOptions()
+        : lowLatency(true)
+        , vmin(1)
+        , vtime(0)
+        , wakeupBytes(1)
+        , interByteGapUs(0)
+        , stageSize(65536)
+        , priority(QThread::TimeCriticalPriority)
+    {
+    }
+};
+
+/***************************************************************
+ * 类名: SerialIoThread
+ * 功能: 串口收发专用线程
+ ***************************************************************/
+class SerialIoThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit SerialIoThread(QObject *parent = nullptr);
+    ~SerialIoThread();
+
+    /**
+     * @brief 打开tty、配置termios并启动线程
+     * @return true=成功, false=失败（见getLastError）
+     */
+    bool openPort(const QString &portName, qint32 baudRate,
+                  QSerialPort::DataBits dataBits, QSerialPort::Parity parity,
+                  QSerialPort::StopBits stopBits, QSerialPort::FlowControl flowControl,
+                  const SerialIoOptions &options);
+
+    /**
+     * @brief 停止线程并关闭tty
+     */
+    void closePort();
+
+    bool isPortOpen() const { return m_fd >= 0; }
+    int getFd() const { return m_fd; }
+
+    /**
+     * @brief 设置发送队列（由DriverSerial持有，open前设置）
+     */
+    void setWriteQueue(SerialWriteQueue *queue) { m_writeQueue = queue; }
+
+    /**
+     * @brief 设置RS-485 GPIO方向控制（open前设置，mode不是Gpio时不控制）
+     */
+    void setDirectionControl(const SerialRs485Config &config) { m_rs485 = config; }
+
+    /**
+     * @brief 开始发送队列中的数据（线程安全）
+     * @return 调用线程直接写出的字节数，-1表示失败
+     * @note 先在调用线程writev，剩余部分由I/O线程在可写时发送，
+     *       I/O线程写出的进度通过bytesWritten信号通知；
+     *       GPIO方向控制时全部由I/O线程发送，返回0
+     */
+    qint64 startWrite();
+
+    /**
+     * @brief 取出暂存区全部数据（线程安全）
+     * @return 数据，暂存区为空时返回空
+     */
+    QByteArray takeData();
+
+    /**
+     * @brief 等待数据（线程安全，不依赖事件循环）
+     * @return true=有数据, false=超时
+     */
+    bool waitForData(int msecs);
+
+    /**
+     * @brief 清空暂存区和内核输入队列
+     */
+    void clearInput();
+
+    /**
+     * @brief 设置接收监听器（I/O线程同步回调）
+     */
+    void setListener(SerialDataListener *listener) { m_listener.storeRelease(listener); }
+
+    /**
+     * @brief 设置抓包写入器（由DriverSerial持有，未开始抓包时记录为空操作）
+     */
+    void setTraceWriter(SerialTraceWriter *writer) { m_traceWriter = writer; }
+
+    QString getLastError() const;
+
+    /**
+     * @brief 单调时钟（CLOCK_MONOTONIC，微秒），监听器时间戳使用
+     */
+    static qint64 monotonicUs();
+
+    // ========== 统计 ==========
+
+    quint64 getReceivedBytes() const { return m_rxBytes; }
+    quint64 getWakeupCount() const { return m_wakeups; }
+    quint64 getStageDroppedBytes() const { return m_stageDropped; }
+    quint64 getTurnaroundCount() const { return m_turnarounds; }
+
+signals:
+    /**
+     * @brief 暂存区有新数据（在I/O线程中发出，未取走前不重复发出）
+     */
+    void dataAvailable();
+
+    /**
+     * @brief I/O线程写出了数据（在I/O线程中发出，不含startWrite()直接写出的部分）
+     */
+    void bytesWritten(qint64 bytes);
+
+    /**
+     * @brief 错误（在I/O线程中发出）
+     */
+    void errorOccurred(const QString &errorString);
+
+protected:
+    void run() override;
+
+private:
+    bool configureTermios(qint32 baudRate, QSerialPort::DataBits dataBits,
+                          QSerialPort::Parity parity, QSerialPort::StopBits stopBits,
+                          QSerialPort::FlowControl flowControl);
+    void setLowLatency(bool enable);
+    void readAvailable(bool fromTimer);
+    void notifyData();
+    void armGapTimer();
+    void flushTx();
+    void transmitHalfDuplex();
+    void waitTxComplete(qint64 startNs, qint64 bytes);
+    void kick();
+    void closeFds();
+    void setLastError(const QString &error);
+
+    int m_fd;                       // tty文件描述符
+    int m_epollFd;
+    int m_eventFd;                  // 停止/发送唤醒
+    int m_timerFd;                  // 字节间隔定时器
+    QString m_portName;
+    SerialIoOptions m_options;
+    QAtomicInt m_running;
+
+    // 接收暂存区（I/O线程写，所属线程取）
+    mutable QMutex m_stageMutex;
+    QWaitCondition m_stageReady;
+    SerialRingBuffer m_stage;
+    bool m_stageReleased;           // 已满足唤醒条件、尚未取走（waitForData用）
+    QAtomicInt m_notifyPending;     // 已发出dataAvailable、尚未取走
+    int m_pendingBytes;             // 上次通知后累计的字节数（仅I/O线程）
+
+    // 发送队列
+    SerialWriteQueue *m_writeQueue; // 由DriverSerial持有
+    bool m_txArmed;                 // 已注册EPOLLOUT（仅I/O线程）
+
+    // RS-485 GPIO方向控制
+    SerialRs485Config m_rs485;
+    SerialRs485Gpio m_dirGpio;
+    qint64 m_charTimeNs;            // 一个字符（起始+数据+校验+停止位）的发送时间
+
+    QAtomicPointer<SerialDataListener> m_listener;
+    SerialTraceWriter *m_traceWriter;   // 抓包写入器（由DriverSerial持有）
+
+    mutable QMutex m_errorMutex;
+    QString m_lastError;
+
+    quint64 m_rxBytes;
+    quint64 m_wakeups;
+    quint64 m_stageDropped;
+    quint64 m_turnarounds;          // 换向（发送突发）次数
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_IO_THREAD_H
@@ -0,0 +1,109 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialRfc2217.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: RFC 2217（Telnet COM-PORT-OPTION）服务端编解码
+ *
+ * 功能说明:
+ *   串口TCP桥开启RFC 2217时，网络上是Telnet数据流:
+ *   - 网络→串口: 去掉Telnet命令，IAC IAC还原为0xFF；COM-PORT-OPTION
+ *     子协商直接作用到串口（波特率、数据位、校验、停止位、流控、
+ *     DTR/RTS、BREAK、清空缓冲区），并按协议回复实际生效的值
+ *   - 串口→网络: 数据中的0xFF转义为IAC IAC
+ *   - 连接建立时发送 WILL BINARY / DO BINARY / WILL SGA / DO COM-PORT-OPTION
+ *   - 不支持的选项回复WONT/DONT；不主动上报线路/Modem状态
+ *
+ *   解码状态跨调用保持，命令可以被TCP分段拆开。回复写入内部固定
+ *   缓冲区，由桥在数据缓冲区为空时发出（不能插在转义序列中间）。
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_RFC2217_H
+#define IMX6ULL_DRIVERS_SERIAL_RFC2217_H
+
+#include "drivers/serial/SerialTermios.h"
+#include <QtGlobal>
+#include <QString>
+
+/***************************************************************
+ * 类名: SerialRfc2217
+ * 功能: 一个连接的RFC 2217编解码状态（只在桥线程中使用）
+ ***************************************************************/
+class SerialRfc2217
+{
+public:
+    SerialRfc2217();
+
+    /**
+     * @brief 新连接开始（重置解码状态，写入初始协商）
+     * @param fd 串口文件描述符
+     * @param settings 当前线路参数
+     */
+    void reset(int fd, const SerialLineSettings &settings);
+
+    /**
+     * @brief 解码网络数据
+     * @param in 网络数据
+     * @param length 长度
+     * @param out 串口数据输出（容量不小于length）
+     * @return 输出的串口数据字节数
+     */
+    int decode(const uchar *in, int length, uchar *out);
+
+    /**
+     * @brief 转义串口数据
+     * @param in 串口数据
+     * @param length 长度
+     * @param out 网络数据输出（容量不小于2*length）
+     * @return 输出字节数
+     */
+    static int escape(const uchar *in, int length, uchar *out);
+
+    // ========== 回复缓冲区 ==========
+
+    const uchar *replyData() const { return m_reply + m_replyHead; }
+    int replyPending() const { return m_replyTail - m_replyHead; }
+    void consumeReply(int bytes);
+
+    /**
+     * @brief 客户端修改过的线路参数
+     */
+    const SerialLineSettings &getSettings() const { return m_settings; }
+    quint32 getLineChanges() const { return m_lineChanges; }
+
+private:
+    enum State {
+        StateData,      // 普通数据
+        StateIac,       // 收到IAC
+        StateOption,    // 收到WILL/WONT/DO/DONT，等待选项
+        StateSub,       // 子协商数据
+        StateSubIac     // 子协商中收到IAC
+    };
+
+    void handleOption(uchar command, uchar option);
+    void handleSubnegotiation();
+    void handleComPort(uchar command, const uchar *value, int length);
+    void appendReply(const uchar *data, int length);
+    void sendCommand(uchar command, uchar option);
+    void sendComPort(uchar command, const uchar *value, int length);
+
+    int m_fd;                       // 串口文件描述符
+    SerialLineSettings m_settings;  // 当前线路参数
+    quint32 m_lineChanges;          // 客户端修改线路参数次数
+    bool m_break;                   // BREAK状态
+
+    State m_state;                  // 解码状态
+    uchar m_command;                // WILL/WONT/DO/DONT
+    uchar m_sub[64];                // 子协商内容
+    int m_subLength;                // 子协商长度（超长部分丢弃）
+
+    uchar m_reply[512];             // 待发送的回复
+    int m_replyHead;
+    int m_replyTail;
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_RFC2217_H
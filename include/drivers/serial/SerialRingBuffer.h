@@ -0,0 +1,169 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialRingBuffer.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口读缓冲区（字节环形缓冲区）
+ *
+ * 功能说明:
+ *   替代DriverSerial中QByteArray形式的读缓冲区。原实现每次读取
+ *   都remove(0, n)搬移全部剩余数据，从64KB积压中逐个取短帧时
+ *   代价为平方级。本缓冲区:
+ *   - 容量为2的幂，读写位置单调递增，取模定位，读取只移动读位置
+ *   - 提供peek/consume/按偏移取字节、连续区间访问、查找分隔符，
+ *     均不拷贝数据
+ *   - 提供写入区间（writeSpan/commit），可直接从设备读入缓冲区
+ *   - 写满时丢弃最旧的数据并计数
+ *
+ * 线程安全:
+ *   非线程安全，由所属DriverSerial在同一线程中访问
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 增加readPosition()，供分帧器检测外部读取
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_RING_BUFFER_H
+#define IMX6ULL_DRIVERS_SERIAL_RING_BUFFER_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <string.h>
+
+/***************************************************************
+ * 类名: SerialRingBuffer
+ * 功能: 字节环形缓冲区
+ *
+ * 使用示例:
+ *   SerialRingBuffer ring(65536);
+ *   ring.append(data.constData(), data.size());
+ *   int end = ring.indexOf('\n');
+ *   if (end >= 0) {
+ *       QByteArray line = ring.read(end + 1);
+ *   }
+ ***************************************************************/
+class SerialRingBuffer
+{
+public:
+    /**
+     * @brief 一段连续数据（指向缓冲区内部，下次写入前有效）
+     */
+    struct Span
+    {
+        const char *data;
+        int length;
+    };
+
+    /**
+     * @brief 构造函数
+     * @param capacity 容量（向上取整为2的幂，最小64字节）
+     */
+    explicit SerialRingBuffer(int capacity = 65536);
+
+    /**
+     * @brief 调整容量（保留最新的数据）
+     * @param capacity 新容量（向上取整为2的幂）
+     */
+    void setCapacity(int capacity);
+
+    int capacity() const { return static_cast<int>(m_mask + 1); }
+    int size() const { return static_cast<int>(m_tail - m_head); }
+    int freeSpace() const { return capacity() - size(); }
+    bool isEmpty() const { return m_tail == m_head; }
+
+    /**
+     * @brief 清空
+     */
+    void clear() { m_head = m_tail; }
+
+    // ========== 写入 ==========
+
+    /**
+     * @brief 追加数据，空间不足时丢弃最旧的数据
+     * @return 因溢出丢弃的字节数
+     */
+    int append(const char *data, int length);
+
+    /**
+     * @brief 获取可直接写入的连续空闲区间
+     * @param length 输出区间长度（0表示已满）
+     * @return 写入位置
+     * @note 写入后调用commit()提交；区间不会覆盖未读数据
+     */
+    char *writeSpan(int *length);
+
+    /**
+     * @brief 提交writeSpan()写入的字节
+     */
+    void commit(int length);
+
+    // ========== 读取 ==========
+
+    /**
+     * @brief 按偏移取一个字节（不消费）
+     */
+    char at(int offset) const { return m_data[(m_head + static_cast<quint64>(offset)) & m_mask]; }
+
+    /**
+     * @brief 拷贝数据到外部缓冲区（不消费）
+     * @param offset 起始偏移
+     * @return 实际拷贝的字节数
+     */
+    int peek(char *out, int length, int offset = 0) const;
+
+    /**
+     * @brief 复制数据为QByteArray（不消费）
+     */
+    QByteArray peek(int length, int offset = 0) const;
+
+    /**
+     * @brief 读取并消费
+     */
+    QByteArray read(int length);
+
+    /**
+     * @brief 消费（丢弃）数据
+     * @return 实际消费的字节数
+     */
+    int consume(int length);
+
+    /**
+     * @brief 从偏移开始的连续区间（最多到缓冲区末尾）
+     * @note 数据跨越回绕点时需要再取offset + span.length处的区间
+     */
+    Span span(int offset = 0) const;
+
+    /**
+     * @brief 查找字节
+     * @param c 目标字节
+     * @param from 起始偏移
+     * @return 相对读位置的偏移，-1表示未找到
+     */
+    int indexOf(char c, int from = 0) const;
+
+    /**
+     * @brief 读位置（单调递增，被读取、清空或溢出时改变）
+     */
+    quint64 readPosition() const { return m_head; }
+
+    // ========== 统计 ==========
+
+    quint64 getOverflowCount() const { return m_overflowCount; }
+    quint64 getDroppedBytes() const { return m_droppedBytes; }
+
+private:
+    Q_DISABLE_COPY(SerialRingBuffer)
+
+    static quint64 roundCapacity(int capacity);
+
+    QByteArray m_storage;       // 存储（容量为2的幂）
+    char *m_data;               // m_storage的数据指针
+    quint64 m_mask;             // 容量-1
+    quint64 m_head;             // 读位置（单调递增）
+    quint64 m_tail;             // 写位置（单调递增）
+    quint64 m_overflowCount;    // 溢出次数
+    quint64 m_droppedBytes;     // 溢出丢弃的字节数
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_RING_BUFFER_H
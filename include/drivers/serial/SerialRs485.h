@@ -0,0 +1,143 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialRs485.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: RS-485收发方向控制（内核TIOCSRS485 / GPIO）
+ *
+ * 功能说明:
+ *   RS-485半双工，发送前要打开收发器驱动使能（DE），发送最后一个
+ *   停止位移出后立即关闭，否则从站应答的开头会被自己的驱动器淹没。
+ *   - 内核模式: TIOCSRS485交给UART驱动切换RTS（imx等驱动在发送
+ *     完成中断里切换，最精确），延迟只能以毫秒为单位
+ *   - GPIO模式: 驱动不支持TIOCSRS485或DE接在普通GPIO上时，由
+ *     SerialIoThread在发送前后切换GPIO，等待发送移位寄存器空
+ *     （TIOCSERGETLSR）后按微秒延迟关闭
+ *   - 自动模式: 先尝试内核模式，驱动不支持且配置了GPIO时改用GPIO
+ *
+ * hardware.init配置（[Serial/...]节）:
+ *   rs485              = off / kernel / gpio / auto
+ *   rs485_rts_on_send  = high / low（发送时RTS/GPIO电平，默认high）
+ *   rs485_delay_before = 打开驱动到发送第一个字节的延迟（微秒）
+ *   rs485_delay_after  = 最后一个字节发完到关闭驱动的延迟（微秒）
+ *   rs485_rx_during_tx = 发送期间是否接收（默认false，丢弃回波）
+ *   rs485_gpio         = 方向控制GPIO编号（sysfs编号，GPIO/自动模式）
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_RS485_H
+#define IMX6ULL_DRIVERS_SERIAL_RS485_H
+
+#include <QtGlobal>
+#include <QString>
+
+/**
+ * @brief RS-485参数
+ */
+struct SerialRs485Config
+{
+    enum Mode {
+        Off,        // 不控制方向（RS-232或收发器自动换向）
+        Kernel,     // TIOCSRS485
+        Gpio,       // I/O线程切换GPIO
+        Auto        // 优先内核，不支持时用GPIO
+    };
+
+    Mode mode;
+    bool rtsOnSend;         // 发送时RTS/GPIO为高电平
+    int delayBeforeUs;      // 发送前延迟（微秒）
+    int delayAfterUs;       // 发送后延迟（微秒）
+    bool rxDuringTx;        // 发送期间接收
+    int gpio;               // 方向控制GPIO（-1=无）
+
+    SerialRs485Config()
+        : mode(Off)
+        , rtsOnSend(true)
+        , delayBeforeUs(0)
+        , delayAfterUs(0)
+        , rxDuringTx(false)
+        , gpio(-1)
+    {
+    }
+
+    bool isEnabled() const { return mode != Off; }
+
+    /**
+     * @brief 解析模式字符串（off/kernel/gpio/auto，不区分大小写）
+     * @return 模式，无法识别时返回Off
+     */
+    static Mode modeFromString(const QString &text);
+    static QString modeToString(Mode mode);
+};
+
+/***************************************************************
+ * 类名: SerialRs485
+ * 功能: 内核RS-485模式设置
+ ***************************************************************/
+class SerialRs485
+{
+public:
+    /**
+     * @brief 通过TIOCSRS485启用内核方向控制
+     * @param fd 已打开的tty
+     * @param config 参数（延迟向上取整到毫秒）
+     * @param errorString 输出错误描述
+     * @param notSupported 输出驱动是否不支持（ENOTTY/EINVAL等）
+     * @return true=成功
+     */
+    static bool applyKernel(int fd, const SerialRs485Config &config,
+                            QString *errorString, bool *notSupported = nullptr);
+
+    /**
+     * @brief 确定实际使用的模式（自动模式试探驱动是否支持TIOCSRS485）
+     * @param portName 串口设备路径
+     * @param config 参数
+     * @return Kernel/Gpio/Off，非自动模式原样返回
+     */
+    static SerialRs485Config::Mode resolveMode(const QString &portName, const SerialRs485Config &config);
+};
+
+/***************************************************************
+ * 类名: SerialRs485Gpio
+ * 功能: GPIO方向控制引脚（sysfs，value文件常开，切换只需一次pwrite）
+ ***************************************************************/
+class SerialRs485Gpio
+{
+public:
+    SerialRs485Gpio();
+    ~SerialRs485Gpio();
+
+    /**
+     * @brief 导出GPIO、设置为输出（接收电平）并打开value文件
+     * @param gpio GPIO编号
+     * @param activeHigh 发送时为高电平
+     * @param errorString 输出错误描述
+     * @return true=成功
+     */
+    bool open(int gpio, bool activeHigh, QString *errorString);
+
+    /**
+     * @brief 恢复接收电平并关闭
+     */
+    void close();
+
+    bool isOpen() const { return m_fd >= 0; }
+
+    /**
+     * @brief 切换方向
+     * @param transmit true=发送, false=接收
+     */
+    void setTransmit(bool transmit);
+
+private:
+    Q_DISABLE_COPY(SerialRs485Gpio)
+
+    int m_fd;
+    int m_gpio;
+    bool m_activeHigh;
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_RS485_H
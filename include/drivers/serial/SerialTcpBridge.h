@@ -0,0 +1,269 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialTcpBridge.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口TCP透明桥（ser2net风格）
+ *
+ * 功能说明:
+ *   调试人员远程连接现场的RS-232/485口。每个桥独占一个串口并
+ *   监听一个TCP端口，同一时刻接受一个客户端，双向透传字节:
+ *   - 独立线程epoll循环，串口、客户端套接字、监听套接字和唤醒
+ *     eventfd都在同一个epoll中，数据不经过Qt事件循环和QByteArray
+ *   - 优先用splice经管道在内核中搬运；内核不支持对该tty做splice
+ *     （EINVAL，老内核tty没有splice_read/write_iter）时该方向自动
+ *     改为固定缓冲区read/write
+ *   - 每个方向只有一个缓冲区（或管道），缓冲区非空时停止读取来源，
+ *     只等待目标可写，慢的一端自然反压快的一端
+ *   - 可选RFC 2217: 客户端通过Telnet COM-PORT-OPTION修改波特率等
+ *     线路参数（此时必须逐字节转义，固定用缓冲区方式），断开后恢复
+ *     配置的参数
+ *   - 每个连接统计四个方向的字节数和反压次数，最近的连接保留历史
+ *
+ *   splice写套接字不能带MSG_NOSIGNAL，依赖main()中忽略SIGPIPE。
+ *
+ *   串口打不开或读写出错（USB串口拔出、伪终端对端关闭）时断开当前
+ *   客户端，下一个客户端连接时重新打开。device可以是伪终端从端，
+ *   配合nc/socat即可在主机上测试。
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_TCP_BRIDGE_H
+#define IMX6ULL_DRIVERS_SERIAL_TCP_BRIDGE_H
+
+#include "drivers/serial/SerialTermios.h"
+#include "drivers/serial/SerialRfc2217.h"
+#include <QThread>
+#include <QString>
+#include <QHostAddress>
+#include <QMutex>
+#include <QVector>
+#include <QAtomicInteger>
+#include <QMetaType>
+
+/**
+ * @brief 单个连接的统计
+ */
+struct SerialTcpConnectionStats
+{
+    QString peer;               // 客户端地址:端口
+    qint64 connectedAtMs;       // 连接时间（UTC毫秒）
+    qint64 durationMs;          // 连接时长（进行中的连接为截至当前）
+    quint64 bytesFromNetwork;   // 从套接字读取的字节数
+    quint64 bytesToSerial;      // 写入串口的字节数
+    quint64 bytesFromSerial;    // 从串口读取的字节数
+    quint64 bytesToNetwork;     // 写入套接字的字节数（含RFC 2217转义和回复）
+    quint64 serialStalls;       // 串口不可写导致的等待次数
+    quint64 networkStalls;      // 套接字不可写导致的等待次数
+    quint32 lineChanges;        // RFC 2217修改线路参数次数
+    bool spliceToSerial;        // 网络→串口使用splice
+    bool spliceToNetwork;       // 串口→网络使用splice
+
+    SerialTcpConnectionStats()
+        : connectedAtMs(0), durationMs(0)
+        , bytesFromNetwork(0), bytesToSerial(0), bytesFromSerial(0), bytesToNetwork(0)
+        , serialStalls(0), networkStalls(0), lineChanges(0)
+        , spliceToSerial(false), spliceToNetwork(false)
+    {
+    }
+};
+
+Q_DECLARE_METATYPE(SerialTcpConnectionStats)
+
+/**
+ * @brief 桥统计
+ */
+struct SerialTcpBridgeStats
+{
+    quint64 connectionsAccepted;    // 接受的连接数
+    quint64 connectionsRejected;    // 已有客户端时拒绝的连接数
+    quint64 serialErrors;           // 串口打开/读写失败次数
+    bool clientConnected;           // 当前是否有客户端
+    SerialTcpConnectionStats current;               // 当前连接
+    QVector<SerialTcpConnectionStats> history;      // 最近结束的连接（新的在后）
+
+    SerialTcpBridgeStats()
+        : connectionsAccepted(0), connectionsRejected(0), serialErrors(0), clientConnected(false)
+    {
+    }
+};
+
+/***************************************************************
+ * 类名: SerialTcpBridge
+ * 功能: 一个串口到一个TCP端口的透明桥
+ *
+ * 使用示例:
+ *   SerialTcpBridge bridge("/dev/ttymxc1");
+ *   SerialLineSettings line;
+ *   line.baudRate = 9600;
+ *   bridge.setLineSettings(line);
+ *   bridge.setListenAddress(QHostAddress::Any, 7001);
+ *   bridge.setRfc2217Enabled(true);
+ *   bridge.startBridge();
+ *   ...
+ *   bridge.stopBridge();
+ *
+ * 线程安全:
+ *   配置接口在startBridge前调用；getStats可在任意线程调用
+ ***************************************************************/
+class SerialTcpBridge : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit SerialTcpBridge(const QString &portName, QObject *parent = nullptr);
+    ~SerialTcpBridge();
+
+    // ========== 参数（startBridge前设置） ==========
+
+    void setLineSettings(const SerialLineSettings &settings) { m_lineSettings = settings; }
+    const SerialLineSettings &getLineSettings() const { return m_lineSettings; }
+
+    /**
+     * @brief 设置监听地址
+     */
+    void setListenAddress(const QHostAddress &address, quint16 port);
+    quint16 getListenPort() const { return m_listenPort; }
+
+    /**
+     * @brief 启用RFC 2217（Telnet COM-PORT-OPTION）
+     */
+    void setRfc2217Enabled(bool enable) { m_rfc2217 = enable; }
+    bool isRfc2217Enabled() const { return m_rfc2217; }
+
+    /**
+     * @brief 是否尝试splice（默认true，不支持时自动改为缓冲区）
+     */
+    void setSpliceEnabled(bool enable) { m_spliceEnabled = enable; }
+
+    /**
+     * @brief 每个方向的缓冲区大小
+     * @param bytes 256~65536，默认4096
+     */
+    void setBufferSize(int bytes);
+
+    /**
+     * @brief 保留的历史连接数（默认16）
+     */
+    void setHistorySize(int count) { m_historySize = qMax(0, count); }
+
+    // ========== 运行控制 ==========
+
+    /**
+     * @brief 打开串口、开始监听并启动桥线程
+     * @return true=成功, false=失败（见getLastError）
+     */
+    bool startBridge();
+
+    /**
+     * @brief 断开客户端并停止
+     */
+    void stopBridge();
+
+    bool isBridgeRunning() const { return m_listenFd >= 0; }
+    QString getPortName() const { return m_portName; }
+    QString getLastError() const { return m_lastError; }
+
+    // ========== 统计 ==========
+
+    SerialTcpBridgeStats getStats() const;
+
+    /**
+     * @brief 生成统计报告
+     */
+    QString generateReport() const;
+
+signals:
+    /**
+     * @brief 客户端已连接（桥线程发出）
+     */
+    void clientConnected(const QString &peer);
+
+    /**
+     * @brief 客户端已断开（桥线程发出）
+     * @param stats 该连接的最终统计
+     */
+    void clientDisconnected(const SerialTcpConnectionStats &stats);
+
+protected:
+    void run() override;
+
+private:
+    /**
+     * @brief 单向搬运状态（管道或固定缓冲区）
+     */
+    struct Pump
+    {
+        bool splice;            // 使用splice
+        int pipeRd;             // 管道读端
+        int pipeWr;             // 管道写端
+        char *buffer;           // 固定缓冲区
+        int head;               // 待写出数据起点
+        int tail;               // 待写出数据终点（splice时为管道中字节数）
+
+        int pending() const { return splice ? tail : tail - head; }
+    };
+
+    enum PumpResult {
+        PumpIdle,               // 来源无数据且缓冲区已写空
+        PumpBlocked,            // 目标不可写，等待EPOLLOUT
+        PumpClosed,             // 来源关闭
+        PumpSerialError,        // 串口读写失败
+        PumpNetworkError        // 套接字读写失败
+    };
+
+    bool openSerial();
+    void closeSerial();
+    void acceptClient();
+    void closeClient();
+    void initPump(Pump &pump, bool trySplice);
+    void releasePump(Pump &pump);
+    PumpResult pumpToSerial();
+    PumpResult pumpToNetwork();
+    PumpResult flushReplies();
+    void updateInterest();
+    void modifyInterest(int fd, quint32 &current, quint32 wanted);
+    void setLastError(const QString &error);
+
+    QString m_portName;                 // 串口设备
+    QString m_lastError;                // 最后错误
+    SerialLineSettings m_lineSettings;  // 配置的线路参数
+    QHostAddress m_listenAddress;       // 监听地址
+    quint16 m_listenPort;               // 监听端口
+    bool m_rfc2217;                     // 启用RFC 2217
+    bool m_spliceEnabled;               // 尝试splice
+    int m_bufferSize;                   // 每个方向的缓冲区大小
+    int m_historySize;                  // 历史连接数
+
+    int m_serialFd;                     // 串口
+    int m_listenFd;                     // 监听套接字
+    int m_clientFd;                     // 当前客户端（-1=无）
+    int m_epollFd;                      // epoll
+    int m_wakeFd;                       // 停止唤醒eventfd
+    quint32 m_serialEvents;             // 串口当前注册的事件
+    quint32 m_clientEvents;             // 客户端当前注册的事件
+
+    Pump m_toSerial;                    // 网络→串口
+    Pump m_toNetwork;                   // 串口→网络
+    char *m_scratch;                    // RFC 2217解码/转义前的原始数据
+    SerialRfc2217 m_telnet;             // RFC 2217状态
+
+    // 统计（计数在桥线程中累加，字符串和历史加锁）
+    mutable QMutex m_statsMutex;
+    SerialTcpConnectionStats m_current;
+    QVector<SerialTcpConnectionStats> m_history;
+    quint64 m_connectionsAccepted;
+    quint64 m_connectionsRejected;
+    quint64 m_serialErrors;
+    QAtomicInteger<quint64> m_bytesFromNetwork;
+    QAtomicInteger<quint64> m_bytesToSerial;
+    QAtomicInteger<quint64> m_bytesFromSerial;
+    QAtomicInteger<quint64> m_bytesToNetwork;
+    QAtomicInteger<quint64> m_serialStalls;
+    QAtomicInteger<quint64> m_networkStalls;
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_TCP_BRIDGE_H
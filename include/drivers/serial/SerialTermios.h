@@ -0,0 +1,72 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialTermios.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口线路参数与termios设置
+ *
+ * 功能说明:
+ *   绕过QSerialPort直接操作文件描述符的模块（SerialIoThread、
+ *   SerialTcpBridge）共用的termios设置: 原始模式、波特率、数据位、
+ *   校验、停止位和流控。参数沿用QSerialPort的枚举，与DriverSerial
+ *   的配置接口一致。
+ *
+ * History:
+ *   1. 2026-10-18 创建文件（从SerialIoThread中提取）
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_TERMIOS_H
+#define IMX6ULL_DRIVERS_SERIAL_TERMIOS_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QSerialPort>
+
+/**
+ * @brief 串口线路参数
+ */
+struct SerialLineSettings
+{
+    qint32 baudRate;                        // 波特率
+    QSerialPort::DataBits dataBits;         // 数据位
+    QSerialPort::Parity parity;             // 校验
+    QSerialPort::StopBits stopBits;         // 停止位
+    QSerialPort::FlowControl flowControl;   // 流控
+
+    SerialLineSettings()
+        : baudRate(115200)
+        , dataBits(QSerialPort::Data8)
+        , parity(QSerialPort::NoParity)
+        , stopBits(QSerialPort::OneStop)
+        , flowControl(QSerialPort::NoFlowControl)
+    {
+    }
+};
+
+/***************************************************************
+ * 类名: SerialTermios
+ * 功能: termios设置（静态工具类）
+ ***************************************************************/
+class SerialTermios
+{
+public:
+    /**
+     * @brief 波特率是否有对应的termios速率常量
+     */
+    static bool isSupportedBaudRate(qint32 baudRate);
+
+    /**
+     * @brief 设置为原始模式并应用线路参数
+     * @param fd 串口文件描述符
+     * @param settings 线路参数
+     * @param vmin termios VMIN（0-255）
+     * @param vtime termios VTIME（0.1秒单位，0-255）
+     * @param errorString 失败原因（可为nullptr）
+     * @return true=成功, false=失败
+     */
+    static bool apply(int fd, const SerialLineSettings &settings, int vmin, int vtime,
+                      QString *errorString);
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_TERMIOS_H
@@ -0,0 +1,153 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialTraceFormat.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口抓包环形文件格式定义
+ *
+ * 功能说明:
+ *   抓包文件（*.sertrace）大小固定: 文件头之后是blockCount个等长的
+ *   块槽，第n个块写入槽n % blockCount，写满后覆盖最旧的块，文件
+ *   不会增长。每个块自带序号，读取方按序号排序即可恢复时间顺序；
+ *   重启后写入器从文件中最大序号之后继续，上次运行的记录保留。
+ *
+ * 文件头64字节（小端）:
+ *   magic(8)="SERTRACE" version(2)=1 headerSize(2)=64
+ *   blockSize(4) blockCount(4) baudRate(4) reserved(4)
+ *   portName(32，UTF-8，不足补0) reserved(4)
+ *
+ * 块头40字节（位于每个块槽开头）:
+ *   magic(4)="STBK" used(4)=记录区字节数 sequence(8)
+ *   firstUs(8)=首条记录单调时间 wallUs(8)=同一时刻的UTC时间（微秒）
+ *   recordCount(4) reserved(4)
+ *
+ * 记录12+N字节:
+ *   timestampUs(8，CLOCK_MONOTONIC) direction(1) flags(1) length(2) data(length)
+ *   direction: 0=接收 1=发送
+ *   flags: bit0=本条之前有记录因写入器积压被丢弃
+ *          bit1=本条是一次收发数据的后续分片（超过块容量时拆分）
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_TRACE_FORMAT_H
+#define IMX6ULL_DRIVERS_SERIAL_TRACE_FORMAT_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <limits>
+#include <QtEndian>
+#include <string.h>
+
+#define SERIAL_TRACE_MAGIC              "SERTRACE"
+#define SERIAL_TRACE_BLOCK_MAGIC        "STBK"
+#define SERIAL_TRACE_VERSION            1
+#define SERIAL_TRACE_HEADER_SIZE        64
+#define SERIAL_TRACE_PORT_NAME_SIZE     32
+#define SERIAL_TRACE_BLOCK_HEADER       40
+#define SERIAL_TRACE_RECORD_HEADER      12
+#define SERIAL_TRACE_MAX_PAYLOAD        65535
+
+#define SERIAL_TRACE_DIR_RX             0
+#define SERIAL_TRACE_DIR_TX             1
+
+#define SERIAL_TRACE_FLAG_DROPPED       0x01
+#define SERIAL_TRACE_FLAG_CONTINUATION  0x02
+
+/**
+ * @brief 解码后的一条记录（data指向读取缓冲区，仅在回调内有效）
+ */
+struct SerialTraceRecord
+{
+    qint64 timestampUs;     // 单调时间（微秒）
+    qint64 wallUs;          // UTC时间（微秒，由块头换算）
+    quint8 direction;       // SERIAL_TRACE_DIR_*
+    quint8 flags;           // SERIAL_TRACE_FLAG_*
+    quint16 length;         // 数据长度
+    const uchar *data;      // 数据
+};
+
+/**
+ * @brief 块头
+ */
+struct SerialTraceBlockHeader
+{
+    quint32 used;           // 记录区字节数
+    quint64 sequence;       // 块序号（从1开始，0表示空槽）
+    qint64 firstUs;         // 首条记录单调时间
+    qint64 wallUs;          // firstUs对应的UTC时间
+    quint32 recordCount;    // 记录数
+
+    SerialTraceBlockHeader()
+        : used(0), sequence(0), firstUs(0), wallUs(0), recordCount(0)
+    {
+    }
+
+    void serialize(uchar *out) const
+    {
+        memcpy(out, SERIAL_TRACE_BLOCK_MAGIC, 4);
+        qToLittleEndian<quint32>(used, out + 4);
+        qToLittleEndian<quint64>(sequence, out + 8);
+        qToLittleEndian<quint64>(static_cast<quint64>(firstUs), out + 16);
+        qToLittleEndian<quint64>(static_cast<quint64>(wallUs), out + 24);
+        qToLittleEndian<quint32>(recordCount, out + 32);
+        qToLittleEndian<quint32>(0, out + 36);
+    }
+
+    /**
+     * @return true=块头有效
+     */
+    bool deserialize(const uchar *in)
+    {
+        if (memcmp(in, SERIAL_TRACE_BLOCK_MAGIC, 4) != 0) {
+            return false;
+        }
+        used = qFromLittleEndian<quint32>(in + 4);
+        sequence = qFromLittleEndian<quint64>(in + 8);
+        firstUs = static_cast<qint64>(qFromLittleEndian<quint64>(in + 16));
+        wallUs = static_cast<qint64>(qFromLittleEndian<quint64>(in + 24));
+        recordCount = qFromLittleEndian<quint32>(in + 32);
+        return sequence != 0;
+    }
+};
+
+/**
+ * @brief 编码记录头（数据由调用者紧随其后写入）
+ */
+inline void serialTraceEncodeRecordHeader(uchar *out, qint64 timestampUs, quint8 direction,
+                                          quint8 flags, int length)
+{
+    qToLittleEndian<quint64>(static_cast<quint64>(timestampUs), out);
+    out[8] = direction;
+    out[9] = flags;
+    qToLittleEndian<quint16>(static_cast<quint16>(length), out + 10);
+}
+
+/**
+ * @brief 解码一条记录
+ * @param in 输入数据
+ * @param available 可用字节数
+ * @param record 输出记录（wallUs由调用者换算）
+ * @return 记录字节数，数据不完整或格式错误返回-1
+ */
+inline int serialTraceDecodeRecord(const uchar *in, qint64 available, SerialTraceRecord &record)
+{
+    if (available < SERIAL_TRACE_RECORD_HEADER) {
+        return -1;
+    }
+    const int length = qFromLittleEndian<quint16>(in + 10);
+    if (in[8] > SERIAL_TRACE_DIR_TX || available < SERIAL_TRACE_RECORD_HEADER + length) {
+        return -1;
+    }
+    record.timestampUs = static_cast<qint64>(qFromLittleEndian<quint64>(in));
+    record.wallUs = 0;
+    record.direction = in[8];
+    record.flags = in[9];
+    record.length = static_cast<quint16>(length);
+    record.data = in + SERIAL_TRACE_RECORD_HEADER;
+    return SERIAL_TRACE_RECORD_HEADER + length;
+}
+
+#endif // IMX6ULL_DRIVERS_SERIAL_TRACE_FORMAT_H
@@ -0,0 +1,107 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialTraceReader.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口抓包环形文件读取
+ *
+ * 功能说明:
+ *   读取SerialTraceWriter生成的抓包文件:
+ *   - 打开时读取所有块槽的块头，按序号排序（环形覆盖后仍是时间顺序）
+ *   - 块头描述的范围内记录解码失败时（断电时块未写完整）只丢弃该块
+ *     剩余部分，继续读后面的块
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_TRACE_READER_H
+#define IMX6ULL_DRIVERS_SERIAL_TRACE_READER_H
+
+#include "drivers/serial/SerialTraceFormat.h"
+#include <QString>
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+#include <functional>
+
+/***************************************************************
+ * 类名: SerialTraceReader
+ * 功能: 按时间顺序遍历抓包记录
+ *
+ * 使用示例:
+ *   SerialTraceReader reader;
+ *   if (reader.open("/data/trace/modbus.sertrace")) {
+ *       reader.forEach([](const SerialTraceRecord &r) {
+ *           ...
+ *           return true;        // false停止遍历
+ *       });
+ *   }
+ ***************************************************************/
+class SerialTraceReader
+{
+public:
+    /**
+     * @brief 记录回调，返回false停止遍历
+     */
+    typedef std::function<bool(const SerialTraceRecord &)> RecordHandler;
+
+    SerialTraceReader();
+    ~SerialTraceReader();
+
+    /**
+     * @brief 打开抓包文件并读取块头
+     * @return true=成功, false=失败（见getLastError）
+     */
+    bool open(const QString &path);
+
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    QString getLastError() const { return m_lastError; }
+
+    QString getPortName() const { return m_portName; }
+    qint32 getBaudRate() const { return m_baudRate; }
+    int getBlockSize() const { return m_blockSize; }
+    int getBlockCount() const { return m_blockCount; }
+
+    /**
+     * @brief 有效块数（按序号排序）
+     */
+    int getUsedBlocks() const { return m_blocks.size(); }
+
+    /**
+     * @brief 解码失败被丢弃的块尾数（遍历后有效）
+     */
+    int getCorruptBlocks() const { return m_corruptBlocks; }
+
+    /**
+     * @brief 按时间顺序遍历全部记录
+     * @param handler 记录回调
+     * @return 遍历的记录数，读取失败返回-1
+     */
+    qint64 forEach(const RecordHandler &handler);
+
+private:
+    struct BlockSlot
+    {
+        qint64 offset;                  // 块槽在文件中的偏移
+        SerialTraceBlockHeader header;  // 块头
+    };
+
+    QString m_path;                     // 抓包文件路径
+    QString m_lastError;                // 最后错误
+    QFile m_file;                       // 抓包文件
+
+    QString m_portName;                 // 串口名称
+    qint32 m_baudRate;                  // 波特率
+    int m_blockSize;                    // 块大小
+    int m_blockCount;                   // 块槽数
+    QVector<BlockSlot> m_blocks;        // 有效块（按序号排序）
+    int m_corruptBlocks;                // 解码失败的块
+
+    QByteArray m_buffer;                // 块读取缓冲区
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_TRACE_READER_H
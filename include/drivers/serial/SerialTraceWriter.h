@@ -0,0 +1,166 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialTraceWriter.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口收发抓包写入器（固定大小环形文件）
+ *
+ * 功能说明:
+ *   现场设备在串口上出问题时需要知道当时收发了哪些字节。写入器
+ *   记录每次收发的数据、方向和单调时间戳（格式见SerialTraceFormat.h）:
+ *   - record()只在暂存区追加一条记录（加锁 + memcpy），不做任何I/O，
+ *     可在I/O线程、串口所属线程等任意线程调用
+ *   - 写入线程按刷新间隔或暂存数据达到半个块时批量取走，整理成块后
+ *     pwrite到块槽；未写满的当前块只追加新增部分
+ *   - 暂存区有上限，写入线程跟不上（例如存储卡卡顿）时丢弃新记录并
+ *     计数，收发路径永远不会因为抓包而阻塞
+ *   - 文件大小固定，写满后覆盖最旧的块，可以长期开启
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_TRACE_WRITER_H
+#define IMX6ULL_DRIVERS_SERIAL_TRACE_WRITER_H
+
+#include "drivers/serial/SerialTraceFormat.h"
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInteger>
+#include <QAtomicInt>
+
+class SerialTraceWriterThread;
+
+/***************************************************************
+ * 类名: SerialTraceWriter
+ * 功能: 把串口收发数据写入环形抓包文件
+ *
+ * 使用示例:
+ *   DriverSerial serial("/dev/ttymxc2");
+ *   serial.startTrace("/data/trace/modbus.sertrace");
+ *   serial.open();
+ *   ...
+ *   serial.stopTrace();
+ *
+ * 线程安全:
+ *   start/stop在同一线程中调用；record()和统计接口可在任意线程调用
+ ***************************************************************/
+class SerialTraceWriter
+{
+public:
+    SerialTraceWriter();
+    ~SerialTraceWriter();
+
+    /**
+     * @brief 设置文件大小（start前设置）
+     * @param bytes 256KB~1GB，默认16MB
+     */
+    void setFileSize(qint64 bytes);
+
+    /**
+     * @brief 设置块大小（start前设置）
+     * @param bytes 4KB~1MB，默认64KB
+     */
+    void setBlockSize(int bytes);
+
+    /**
+     * @brief 设置刷新间隔（数据最多在内存中停留的时间）
+     * @param msecs 毫秒，默认1000
+     */
+    void setFlushInterval(int msecs);
+
+    /**
+     * @brief 打开抓包文件并启动写入线程
+     * @param path 文件路径；已存在且块参数相同时接着上次的序号写
+     * @param portName 串口名称（写入文件头）
+     * @param baudRate 波特率（写入文件头）
+     * @return true=成功, false=失败（见getLastError）
+     */
+    bool start(const QString &path, const QString &portName, qint32 baudRate);
+
+    /**
+     * @brief 写完暂存的记录并关闭文件
+     */
+    void stop();
+
+    bool isRunning() const { return m_thread != nullptr; }
+    QString getPath() const { return m_path; }
+    QString getLastError() const { return m_lastError; }
+
+    /**
+     * @brief 记录一次收发（任意线程，不阻塞）
+     * @param direction SERIAL_TRACE_DIR_RX / SERIAL_TRACE_DIR_TX
+     * @param data 数据
+     * @param length 长度
+     * @param timestampUs 单调时间（CLOCK_MONOTONIC，微秒）
+     */
+    void record(quint8 direction, const char *data, int length, qint64 timestampUs);
+
+    /**
+     * @brief 单调时钟（微秒），与记录时间戳同一时钟
+     */
+    static qint64 monotonicUs();
+
+    // ========== 统计 ==========
+
+    quint64 getRecordsCaptured() const { return m_recordsCaptured.load(); }
+    quint64 getBytesCaptured() const { return m_bytesCaptured.load(); }
+    quint64 getRecordsDropped() const { return m_recordsDropped.load(); }
+    quint64 getBlocksWritten() const { return m_blocksWritten.load(); }    // 已写满的块数
+    quint64 getWriteErrors() const { return m_writeErrors.load(); }
+
+private:
+    friend class SerialTraceWriterThread;
+
+    bool openFile(const QString &portName, qint32 baudRate);
+
+    /**
+     * @brief 把取走的暂存记录整理进块（写入线程）
+     */
+    void processBatch(const QByteArray &batch);
+
+    /**
+     * @brief 把当前块未写出的部分写入块槽（写入线程）
+     */
+    void writeBlock();
+
+    /**
+     * @brief 开始下一个块（写入线程）
+     */
+    void nextBlock();
+
+    QString m_path;                     // 抓包文件路径
+    QString m_lastError;                // 最后错误
+    int m_fd;                           // 文件描述符
+    SerialTraceWriterThread *m_thread;  // 写入线程
+
+    qint64 m_fileSize;                  // 文件大小
+    int m_blockSize;                    // 块大小
+    int m_blockCount;                   // 块槽数
+    int m_flushMs;                      // 刷新间隔
+
+    // 暂存区（record()写，写入线程取）
+    QMutex m_stageMutex;
+    QWaitCondition m_stageReady;
+    QByteArray m_stage;
+    int m_stageLimit;                   // 暂存区上限
+    QAtomicInt m_active;                // 是否接受记录（加锁修改，record()先无锁检查）
+    bool m_dropPending;                 // 下一条记录需带丢弃标志
+
+    // 当前块（只由写入线程访问）
+    QByteArray m_block;                 // 块头 + 记录
+    SerialTraceBlockHeader m_blockInfo; // 块头信息
+    int m_blockWritten;                 // 当前块已写入文件的字节数
+    quint64 m_nextSequence;             // 下一个块的序号
+
+    QAtomicInteger<quint64> m_recordsCaptured;
+    QAtomicInteger<quint64> m_bytesCaptured;
+    QAtomicInteger<quint64> m_recordsDropped;
+    QAtomicInteger<quint64> m_blocksWritten;
+    QAtomicInteger<quint64> m_writeErrors;
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_TRACE_WRITER_H
@@ -0,0 +1,114 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialWriteQueue.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口发送队列（分段链 + writev）
+ *
+ * 功能说明:
+ *   替代DriverSerial中单个QByteArray形式的写缓冲区。原实现每次write()
+ *   追加整块数据，部分写出后remove(0, n)搬移剩余积压，通过UART推送
+ *   大固件时代价为平方级。本队列:
+ *   - 每次write()的数据作为一个分段入队，分段是QByteArray的隐式共享
+ *     引用（引用计数），入队不拷贝；小于128字节的写入合并到队尾的
+ *     自有分段，避免iovec数量膨胀
+ *   - writeTo()用writev一次提交多个分段，部分写出只移动队首偏移
+ *   - 限制总字节数和分段数，超过高水位（3/4）时上层应暂停写入，
+ *     降到低水位（1/4）后恢复
+ *
+ * 线程安全:
+ *   内部加锁，可在所属线程入队、在I/O线程写出
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_DRIVERS_SERIAL_WRITE_QUEUE_H
+#define IMX6ULL_DRIVERS_SERIAL_WRITE_QUEUE_H
+
+#include <QByteArray>
+#include <QQueue>
+#include <QMutex>
+
+/***************************************************************
+ * 类名: SerialWriteQueue
+ * 功能: 分段发送队列
+ *
+ * 使用示例:
+ *   SerialWriteQueue queue;
+ *   queue.enqueue(firmwareChunk);
+ *   int err = 0;
+ *   qint64 n = queue.writeTo(fd, &err);
+ ***************************************************************/
+class SerialWriteQueue
+{
+public:
+    /**
+     * @param maxBytes 最大排队字节数
+     * @param maxSegments 最大分段数
+     */
+    explicit SerialWriteQueue(qint64 maxBytes = 1024 * 1024, int maxSegments = 4096);
+
+    /**
+     * @brief 设置队列上限
+     */
+    void setLimits(qint64 maxBytes, int maxSegments);
+    qint64 getMaxBytes() const { return m_maxBytes; }
+
+    /**
+     * @brief 入队（不拷贝，共享data的存储）
+     * @return true=成功, false=超过上限（队列为空时单块超限仍接受）
+     */
+    bool enqueue(const QByteArray &data);
+
+    /**
+     * @brief 用writev写出尽可能多的数据（非阻塞fd）
+     * @param fd 文件描述符
+     * @param errorCode 输出错误码（errno，0表示无错误）
+     * @return 本次写出的字节数
+     */
+    qint64 writeTo(int fd, int *errorCode);
+
+    /**
+     * @brief 清空
+     */
+    void clear();
+
+    qint64 size() const;
+    int segmentCount() const;
+    bool isEmpty() const { return size() == 0; }
+
+    /**
+     * @brief 是否高于高水位（上层应暂停写入）
+     */
+    bool isAboveHighWater() const { return size() >= m_maxBytes * 3 / 4; }
+
+    /**
+     * @brief 是否低于低水位（可以恢复写入）
+     */
+    bool isBelowLowWater() const { return size() <= m_maxBytes / 4; }
+
+    // ========== 统计 ==========
+
+    quint64 getTotalWritten() const { return m_totalWritten; }
+    quint64 getWritevCalls() const { return m_writevCalls; }
+
+private:
+    Q_DISABLE_COPY(SerialWriteQueue)
+
+    void consumeLocked(qint64 bytes);
+
+    mutable QMutex m_mutex;
+    QQueue<QByteArray> m_segments;  // 分段（隐式共享）
+    int m_headOffset;               // 队首分段已写出的字节数
+    bool m_tailOwned;               // 队尾分段为队列自有（可追加合并小写入）
+    qint64 m_size;                  // 排队字节数
+    qint64 m_maxBytes;
+    int m_maxSegments;
+
+    quint64 m_totalWritten;
+    quint64 m_writevCalls;
+};
+
+#endif // IMX6ULL_DRIVERS_SERIAL_WRITE_QUEUE_H
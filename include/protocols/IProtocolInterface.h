@@ -10,6 +10,7 @@
  *   定义所有通信协议的统一接口，包括但不限于：
  *   - Modbus RTU/TCP
  *   - CANopen
+ *   - XCP on CAN
  *   - MQTT
  *   - HTTP/REST
  *   - 自定义协议
@@ -20,6 +21,7 @@
  *
  * History:
  *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 增加XCP协议类型
  ***************************************************************/
 
 #ifndef IMX6ULL_PROTOCOLS_INTERFACE_H
@@ -43,6 +45,7 @@ enum class ProtocolType {
     MQTT,               // MQTT协议
     HTTP,               // HTTP协议
     WebSocket,          // WebSocket协议
+    XCP,                // XCP测量标定协议（CAN）
     Custom              // 自定义协议
 };
 
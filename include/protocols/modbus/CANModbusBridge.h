@@ -0,0 +1,229 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANModbusBridge.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN信号到Modbus寄存器的桥接
+ *
+ * 功能说明:
+ *   SCADA通过Modbus读取所有数据，但很多数值只在CAN总线上。
+ *   原来由主线程的槽函数逐个拷贝到从站寄存器，每个数值一次排队信号。
+ *   本桥接器:
+ *   - 按映射表（CAN ID + 位范围 + 缩放 → 保持/输入寄存器）工作
+ *   - 加载时编译为按ID索引的提取指令（窗口偏移、移位、掩码、增益）
+ *   - 作为CANFrameListener挂在CAN接收路径上，收到帧后直接写入
+ *     从站的寄存器存储，一帧内的所有寄存器一次加锁写入
+ *
+ * 信号定义（与DBC一致）:
+ *   - intel（小端）: start_bit为最低位的位号
+ *   - motorola（大端）: start_bit为最高位的位号（DBC锯齿编号）
+ *   - 物理值 = 原始值 * factor + offset
+ *   - 寄存器值 = 物理值 * scale（四舍五入并按格式饱和）
+ *
+ * 寄存器格式:
+ *   u16 / s16        占1个寄存器
+ *   u32 / s32 / f32  占2个寄存器，默认高字在前（word_swap=true时低字在前）
+ *
+ * hardware.init配置（每个映射一个配置节）:
+ *   [CANModbus/电池电压]
+ *   type = CANModbus
+ *   name = 电池电压
+ *   can = CAN0                  ; CAN设备别名
+ *   can_id = 0x18FF50E5         ; >0x7FF默认扩展帧，可用extended指定
+ *   start_bit = 0
+ *   length = 16
+ *   byte_order = intel          ; intel / motorola
+ *   signed = false
+ *   factor = 0.1
+ *   offset = 0
+ *   register_type = input       ; holding / input
+ *   register = 0x0010
+ *   scale = 10                  ; 寄存器单位0.01V
+ *   format = u16
+ *   enabled = true
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 位域提取改用CANSignalExtractor，与离线解码工具共用
+ *   3. 2026-10-18 信号全部因长度不足跳过的帧不计入命中帧数
+ ***************************************************************/
+
+#ifndef IMX6ULL_PROTOCOLS_CAN_MODBUS_BRIDGE_H
+#define IMX6ULL_PROTOCOLS_CAN_MODBUS_BRIDGE_H
+
+#include "drivers/can/CANFrameListener.h"
+#include "drivers/can/CANSignal.h"
+#include "protocols/modbus/ModbusSlave.h"
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QVariant>
+#include <QAtomicInteger>
+
+/***************************************************************
+ * 类名: CANModbusBridge
+ * 功能: 在CAN接收路径中把信号值写入Modbus从站寄存器
+ *
+ * 使用示例:
+ *   CANModbusBridge *bridge = new CANModbusBridge(slave);
+ *   CANModbusBridge::Mapping m;
+ *   m.canId = 0x100; m.startBit = 0; m.length = 16;
+ *   m.factor = 0.1; m.table = ProtocolModbusSlave::InputRegisters; m.address = 0x10;
+ *   bridge->addMapping(m);
+ *   bridge->compile();
+ *   can->setFrameListener(bridge);      // 之后每帧在接收线程中直接更新寄存器
+ *
+ * 线程安全:
+ *   addMapping()/compile()在挂接前调用；挂接后映射表只读，
+ *   canFrameReceived()可在任意接收线程中调用
+ ***************************************************************/
+class CANModbusBridge : public CANFrameListener
+{
+public:
+    /**
+     * @brief 寄存器格式
+     */
+    enum Format {
+        FormatU16 = 0,
+        FormatS16,
+        FormatU32,
+        FormatS32,
+        FormatFloat32
+    };
+
+    /**
+     * @brief 一条映射
+     */
+    struct Mapping
+    {
+        QString name;               // 映射名称（日志用）
+        quint32 canId;              // CAN ID
+        bool extended;              // 扩展帧
+        int startBit;               // 起始位（含义见文件头）
+        int length;                 // 位长度（1~32）
+        bool motorola;              // 大端（DBC motorola）
+        bool isSigned;              // 原始值为有符号数
+        double factor;              // 原始值→物理值增益
+        double offset;              // 原始值→物理值偏移
+        double scale;               // 物理值→寄存器值增益
+        ProtocolModbusSlave::RegisterTable table;  // 寄存器表
+        quint16 address;            // 起始寄存器地址
+        Format format;              // 寄存器格式
+        bool wordSwap;              // 32位值低字在前
+
+        Mapping()
+            : canId(0), extended(false), startBit(0), length(16)
+            , motorola(false), isSigned(false)
+            , factor(1.0), offset(0.0), scale(1.0)
+            , table(ProtocolModbusSlave::HoldingRegisters), address(0)
+            , format(FormatU16), wordSwap(false)
+        {
+        }
+
+        /**
+         * @brief 占用的寄存器数量
+         */
+        int registerCount() const { return (format == FormatU16 || format == FormatS16) ? 1 : 2; }
+    };
+
+    /**
+     * @brief 构造函数
+     * @param slave 目标从站（生命周期长于桥接器）
+     */
+    explicit CANModbusBridge(ProtocolModbusSlave *slave);
+
+    /**
+     * @brief 从hardware.init配置节参数解析映射
+     * @param name 映射名称
+     * @param params 配置参数（键名见文件头）
+     * @param mapping 输出映射
+     * @param errorMessage 失败时的错误描述（可为nullptr）
+     * @return true=成功, false=参数无效
+     */
+    static bool parseMapping(const QString &name, const QMap<QString, QVariant> &params,
+                             Mapping &mapping, QString *errorMessage = nullptr);
+
+    /**
+     * @brief 添加映射（需重新compile才生效）
+     * @return true=成功, false=参数无效
+     */
+    bool addMapping(const Mapping &mapping, QString *errorMessage = nullptr);
+
+    /**
+     * @brief 清除所有映射
+     */
+    void clear();
+
+    int mappingCount() const { return m_mappings.size(); }
+
+    /**
+     * @brief 编译映射表（检查寄存器重叠并生成按ID索引的提取指令）
+     * @return true=成功, false=寄存器重叠或越界（原编译结果保持不变）
+     */
+    bool compile(QString *errorMessage = nullptr);
+
+    /**
+     * @brief 接收路径回调：提取本帧的所有信号并一次写入寄存器
+     */
+    void canFrameReceived(const QCanBusFrame &frame) override;
+
+    // ========== 统计 ==========
+
+    quint64 getFramesMatched() const { return m_framesMatched.load(); }
+    quint64 getRegisterUpdates() const { return m_registerUpdates.load(); }
+    quint64 getShortFrames() const { return m_shortFrames.load(); }
+
+    /**
+     * @brief 生成映射与统计报告
+     */
+    QString generateReport() const;
+
+private:
+    /**
+     * @brief 编译后的信号提取指令
+     */
+    struct CompiledSignal
+    {
+        CANSignalExtractor extractor;   // 位域提取（与离线解码共用）
+        bool identity;          // 增益为1偏移为0，走整数路径
+        quint8 format;          // Format
+        quint8 table;           // RegisterTable
+        bool wordSwap;          // 32位值低字在前
+        quint16 address;        // 起始寄存器
+        double gain;            // factor * scale
+        double bias;            // offset * scale
+    };
+
+    /**
+     * @brief 同一ID的指令区间
+     */
+    struct IdRange
+    {
+        int first;
+        int count;
+    };
+
+    static quint32 makeKey(quint32 canId, bool extended)
+    {
+        return extended ? (canId | 0x80000000U) : canId;
+    }
+
+    static bool compileSignal(const Mapping &mapping, CompiledSignal &compiled,
+                              QString *errorMessage);
+
+    static int encode(const CompiledSignal &compiled, const uchar *payload,
+                      ProtocolModbusSlave::RegisterWrite *writes);
+
+    ProtocolModbusSlave *m_slave;               // 目标从站
+    QVector<Mapping> m_mappings;                // 映射定义
+    QVector<CompiledSignal> m_signals;          // 编译结果（按ID分组）
+    QHash<quint32, IdRange> m_index;            // ID → 指令区间
+
+    QAtomicInteger<quint64> m_framesMatched;    // 命中映射并写入了寄存器的帧数
+    QAtomicInteger<quint64> m_registerUpdates;  // 写入的寄存器数
+    QAtomicInteger<quint64> m_shortFrames;      // 长度不足跳过的信号数
+};
+
+#endif // IMX6ULL_PROTOCOLS_CAN_MODBUS_BRIDGE_H
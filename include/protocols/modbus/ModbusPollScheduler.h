@@ -0,0 +1,415 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: ModbusPollScheduler.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: Modbus主站轮询调度器 - 按点配置周期和优先级
+ *
+ * 功能说明:
+ *   RTU总线在9600~115200波特率下带宽很有限，各业务模块各自用定时器
+ *   调用readHoldingRegisters时请求互相挤占、没有先后。本调度器统一
+ *   管理所有轮询点（从站、地址、类型、周期、优先级）:
+ *   - 每个优先级一个按截止时间排序的最小堆，总线空闲时取最高优先级
+ *     中截止时间最早且已到期的点发出；都未到期时定时到最早的截止时间
+ *   - 同一时刻只有一个请求交给ProtocolModbusRTU的异步队列，其他模块
+ *     的请求可以插在两次轮询之间，高优先级点不会排在低优先级积压后面
+ *   - 下一次截止时间按配置周期递推（不随响应时间漂移）；完成时已错过
+ *     下一个截止时间视为调度超限，跳过错过的周期并计数，不补发
+ *   - 发出一个点时，同一从站、同一功能码中半个周期内也将到期的点一起
+ *     交给ModbusReadPlanner，与该点合并成一次块读取，提前读到的点从
+ *     本次读取起重新计算周期（逐渐与同组的点对齐，便于以后继续合并）
+ *   - 含多个点的块收到地址类异常（02非法地址、03非法数值，多为从站拒绝
+ *     空隙中未定义的地址）时不判定这些点失败，而是把该组退一级后立即
+ *     重读: 先退为只合并紧邻的地址，再退为逐点读取（每退一级记一次日志）；
+ *     退级10分钟后试着回到上一级，仍然异常会再退回。其他异常（04设备
+ *     故障、06忙、网关0A/0B等）与块的范围无关，按普通失败处理
+ *   - 寄存器值保存在预分配的连续数组中，块读取的响应按切片直接写入，
+ *     与上次不同（或首次读到）才通过pointsChanged发布
+ *   - 统计每个点的实际轮询周期、到期后的延迟、超限次数和错误次数，
+ *     以及总线占用率和按实测请求耗时估算的负载（>1表示配置的周期
+ *     在当前波特率下不可能满足）
+ *
+ * 注意:
+ *   所有接口必须在ProtocolModbusRTU所在线程调用
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 同时到期的相邻点合并为块读取（ModbusReadPlanner）
+ *   3. 2026-10-18 合并读取收到异常响应时按组退回紧邻合并/逐点读取
+ *   4. 2026-10-18 只有地址类异常才退级，退级一段时间后试着恢复
+ ***************************************************************/
+
+#ifndef IMX6ULL_PROTOCOLS_MODBUS_POLL_SCHEDULER_H
+#define IMX6ULL_PROTOCOLS_MODBUS_POLL_SCHEDULER_H
+
+#include "protocols/modbus/ModbusRTU.h"
+#include "protocols/modbus/ModbusReadPlanner.h"
+#include <QObject>
+#include <QVector>
+#include <QTimer>
+#include <QPointer>
+#include <QHash>
+#include <QElapsedTimer>
+
+/***************************************************************
+ * 结构体: ModbusPollPoint
+ * 功能: 轮询点配置
+ ***************************************************************/
+struct ModbusPollPoint
+{
+    /**
+     * @brief 优先级（数值越小优先级越高）
+     */
+    enum Priority {
+        Critical = 0,                   // 保护、联锁相关
+        High = 1,                       // 控制回路反馈
+        Normal = 2,                     // 一般监视量（默认）
+        Low = 3,                        // 统计、诊断
+        PriorityCount = 4
+    };
+
+    quint8 slave;                       // 从站地址（1~247）
+    ModbusPointType type;               // 数据类型
+    quint16 address;                    // 起始地址
+    quint16 count;                      // 寄存器/位数（32位值等占多个寄存器）
+    int periodMs;                       // 轮询周期（毫秒）
+    Priority priority;                  // 优先级
+    QString name;                       // 名称（报告中使用，可为空）
+
+    ModbusPollPoint()
+        : slave(1), type(ModbusPointType::HoldingRegister), address(0), count(1)
+        , periodMs(1000), priority(Normal)
+    {
+    }
+};
+
+/**
+ * @brief 单个点的统计
+ */
+struct ModbusPollPointStats
+{
+    quint64 polls;              // 完成的轮询次数（含失败，含合并读取）
+    quint64 errors;             // 失败次数
+    quint64 changes;            // 值变化次数
+    quint64 overruns;           // 错过的周期数
+    qint64 lastLatenessUs;      // 最近一次发出时刻晚于截止时间多少（提前合并读取为0）
+    qint64 maxLatenessUs;       // 最大延迟
+    qint64 totalLatenessUs;     // 累计延迟（平均值 = totalLatenessUs / polls）
+    qint64 lastElapsedUs;       // 最近一次请求在总线上的时间（合并读取时按点数均分）
+    qint64 totalElapsedUs;      // 累计总线时间
+    qint64 actualPeriodUs;      // 实际轮询周期（相邻两次发出间隔的滑动平均）
+
+    ModbusPollPointStats()
+        : polls(0), errors(0), changes(0), overruns(0)
+        , lastLatenessUs(0), maxLatenessUs(0), totalLatenessUs(0)
+        , lastElapsedUs(0), totalElapsedUs(0), actualPeriodUs(0)
+    {
+    }
+
+    /**
+     * @brief 实际轮询频率（Hz，尚未测得时为0）
+     */
+    double actualHz() const
+    {
+        return actualPeriodUs > 0 ? 1000000.0 / actualPeriodUs : 0.0;
+    }
+};
+
+/**
+ * @brief 调度器统计
+ */
+struct ModbusPollStats
+{
+    quint64 requests;           // 发出的请求数
+    quint64 pointReads;         // 这些请求读到的点数（/requests即平均每次合并的点数）
+    quint64 errors;             // 失败的请求数
+    quint64 overruns;           // 所有点错过的周期数
+    qint64 busyUs;              // 轮询请求在总线上的时间之和（发送到完成）
+    qint64 elapsedUs;           // 统计时长
+    double load;                // 估算负载: Σ(点的平均请求耗时 / 周期)
+
+    ModbusPollStats()
+        : requests(0), pointReads(0), errors(0), overruns(0), busyUs(0), elapsedUs(0), load(0.0)
+    {
+    }
+
+    /**
+     * @brief 轮询占用总线的时间比例
+     */
+    double utilisation() const
+    {
+        return elapsedUs > 0 ? static_cast<double>(busyUs) / elapsedUs : 0.0;
+    }
+};
+
+/***************************************************************
+ * 类名: ModbusPollScheduler
+ * 功能: Modbus RTU主站轮询调度
+ *
+ * 使用示例:
+ *   ProtocolModbusRTU modbus("/dev/ttymxc2");
+ *   modbus.configure({{"baudrate", 19200}});
+ *   modbus.connect();
+ *
+ *   ModbusPollScheduler poller(&modbus);
+ *   ModbusPollPoint point;
+ *   point.slave = 3;
+ *   point.address = 0x0100;
+ *   point.count = 2;
+ *   point.periodMs = 100;
+ *   point.priority = ModbusPollPoint::High;
+ *   const int pressure = poller.addPoint(point);
+ *
+ *   connect(&poller, &ModbusPollScheduler::pointsChanged, [&](const QVector<int> &ids) {
+ *       if (ids.contains(pressure)) {
+ *           quint32 raw = (poller.value(pressure, 0) << 16) | poller.value(pressure, 1);
+ *       }
+ *   });
+ *   poller.start();
+ ***************************************************************/
+class ModbusPollScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param master Modbus RTU主站（须比调度器存活更久或由其父对象管理）
+     * @param parent 父对象指针
+     */
+    explicit ModbusPollScheduler(ProtocolModbusRTU *master, QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数
+     */
+    ~ModbusPollScheduler() override;
+
+    // ========== 轮询点 ==========
+
+    /**
+     * @brief 添加轮询点
+     * @return 点ID（>=0）；参数无效时返回-1
+     * @note 寄存器最多125个、线圈/离散输入最多2000个，周期>0
+     */
+    int addPoint(const ModbusPollPoint &point);
+
+    /**
+     * @brief 删除所有轮询点（正在进行的请求结果被丢弃）
+     */
+    void clearPoints();
+
+    int pointCount() const { return m_points.size(); }
+    ModbusPollPoint point(int id) const;
+
+    /**
+     * @brief 启用/暂停单个点（暂停期间不轮询，值保留）
+     */
+    void setPointEnabled(int id, bool enabled);
+
+    /**
+     * @brief 修改轮询周期（下一次截止时间起生效）
+     */
+    void setPointPeriod(int id, int periodMs);
+
+    // ========== 运行 ==========
+
+    /**
+     * @brief 开始轮询（所有点立即到期，按优先级依次读取）
+     */
+    void start();
+
+    /**
+     * @brief 停止轮询（正在进行的请求结果被丢弃）
+     */
+    void stop();
+
+    bool isRunning() const { return m_running; }
+
+    /**
+     * @brief 启用/关闭块读取合并（默认启用）
+     */
+    void setCoalescing(bool enable) { m_coalescing = enable; }
+    bool isCoalescing() const { return m_coalescing; }
+
+    /**
+     * @brief 块读取规划器（设置空隙阈值、单块上限）
+     */
+    ModbusReadPlanner &readPlanner() { return m_planner; }
+
+    // ========== 值 ==========
+
+    /**
+     * @brief 点是否已成功读取过且最近一次读取成功
+     */
+    bool isValid(int id) const;
+
+    /**
+     * @brief 点的第index个寄存器（线圈/离散输入为0或1）
+     */
+    quint16 value(int id, int index = 0) const;
+
+    /**
+     * @brief 复制点的全部值
+     * @return false=ID无效或尚未读到
+     */
+    bool values(int id, QVector<quint16> &out) const;
+
+    /**
+     * @brief 最近一次读取成功的时刻（调度器时钟，微秒；0=从未成功）
+     */
+    qint64 lastUpdateUs(int id) const;
+
+    /**
+     * @brief 最近一次轮询的结果
+     */
+    ModbusRtuStatus lastStatus(int id) const;
+
+    // ========== 统计 ==========
+
+    ModbusPollPointStats getPointStats(int id) const;
+    ModbusPollStats getStats() const;
+    void resetStats();
+
+    /**
+     * @brief 生成统计报告（每个点的配置周期与实际周期对比）
+     */
+    QString generateReport() const;
+
+signals:
+    /**
+     * @brief 一次请求完成后值发生变化的点
+     */
+    void pointsChanged(const QVector<int> &ids);
+
+    /**
+     * @brief 点由正常变为失败（持续失败时不重复发出）
+     */
+    void pointFailed(int id, ModbusRtuStatus status);
+
+    /**
+     * @brief 点错过了周期（完成时已过下一个截止时间）
+     * @param missed 错过的周期数
+     */
+    void scheduleOverrun(int id, int missed);
+
+private slots:
+    /**
+     * @brief 最早的截止时间到达
+     */
+    void onDueTimer();
+
+private:
+    /**
+     * @brief 点的运行状态
+     */
+    struct PointState
+    {
+        ModbusPollPoint config;
+        int valueOffset;                // 在m_values中的起点
+        bool enabled;
+        bool inFlight;                  // 正在读取
+        bool valid;                     // 最近一次读取成功
+        bool failed;                    // 已发出pointFailed，恢复前不再发出
+        quint32 heapSeq;                // 堆中有效条目的序号（旧条目惰性丢弃）
+        qint64 dueUs;                   // 截止时间
+        qint64 lastStartUs;             // 最近一次发出时刻
+        qint64 lastUpdateUs;            // 最近一次成功时刻
+        ModbusRtuStatus lastStatus;
+        ModbusPollPointStats stats;
+    };
+
+    /**
+     * @brief 截止时间堆条目
+     */
+    struct HeapEntry
+    {
+        qint64 dueUs;
+        int id;
+        quint32 seq;
+    };
+
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    /**
+     * @brief 按当前截止时间把点放入其优先级的堆
+     */
+    void schedulePoint(int id);
+
+    /**
+     * @brief 取出最高优先级中已到期的点
+     * @return 点ID；没有到期的点返回-1，earliestUs为最早的截止时间（无则-1）
+     */
+    int takeDuePoint(qint64 now, qint64 &earliestUs);
+
+    /**
+     * @brief 总线空闲时发出下一个请求，或定时到最早的截止时间
+     */
+    void dispatch();
+
+    /**
+     * @brief 块读取完成
+     */
+    void onPollFinished(quint32 generation, const ModbusRtuResult &result);
+
+    /**
+     * @brief 把块读取数据中属于该点的一段写入点的值数组
+     * @return true=值有变化（或此前无效）
+     */
+    bool storeValues(PointState &state, const uchar *payload, int offset);
+
+    /**
+     * @brief 多点块读取收到地址类异常: 该组退一级，块中的点立即按新方式重读
+     */
+    void fallBackAfterException(quint8 exceptionCode, qint64 elapsedUs);
+
+    /**
+     * @brief 分组当前的合并方式（退级超过重试间隔时先回到上一级）
+     */
+    int groupFallback(int key, qint64 now);
+
+    /**
+     * @brief 同一从站、同一功能码的分组键
+     */
+    static int groupKey(const ModbusPollPoint &point)
+    {
+        return (point.slave << 8) | static_cast<int>(point.type);
+    }
+
+    QPointer<ProtocolModbusRTU> m_master;   // 主站
+
+    QVector<PointState> m_points;           // 轮询点（下标即ID）
+    QVector<quint16> m_values;              // 所有点的值（连续存放）
+    QVector<HeapEntry> m_heaps[ModbusPollPoint::PriorityCount];  // 各优先级的截止时间堆
+    QHash<int, QVector<int> > m_groups;     // 分组键 -> 点ID
+
+    // 块读取
+    enum GroupFallback {
+        FallbackNone = 0,                   // 按空隙阈值合并
+        FallbackAdjacent = 1,               // 只合并紧邻的地址
+        FallbackSingle = 2                  // 逐点读取
+    };
+    struct FallbackState {
+        int level;                          // GroupFallback
+        qint64 sinceUs;                     // 进入该级的时刻
+    };
+    ModbusReadPlanner m_planner;
+    bool m_coalescing;
+    QHash<int, FallbackState> m_groupFallback;  // 分组键 -> 退级状态（无记录即FallbackNone）
+    ModbusReadPlanner::Block m_activeBlock; // 正在进行的块读取
+    QVector<ModbusReadPlanner::Slice> m_activeSlices;  // 及其包含的点
+    qint64 m_activeStartUs;
+
+    QTimer *m_dueTimer;                     // 最早截止时间定时器
+    QElapsedTimer m_clock;                  // 调度时钟
+    bool m_running;
+    bool m_dispatching;                     // dispatch()执行中（失败回调可能同步发生）
+    bool m_busy;                            // 有请求交给了主站
+    quint32 m_activeRequest;                // 主站请求ID
+    quint32 m_generation;                   // stop/clear后递增，丢弃旧请求的结果
+
+    ModbusPollStats m_stats;
+    qint64 m_statsStartUs;
+};
+
+#endif // IMX6ULL_PROTOCOLS_MODBUS_POLL_SCHEDULER_H
@@ -18,16 +18,38 @@
  * Modbus RTU帧格式:
  *   [从站地址(1字节)][功能码(1字节)][数据(N字节)][CRC16(2字节)]
  *
+ * 异步请求:
+ *   请求进入队列，由readyRead和定时器驱动的状态机逐个发送，完成后
+ *   调用回调并发出requestFinished信号；同步接口是提交后在本线程上
+ *   用waitForReadyRead等待的薄封装，不再进入事件循环、不再轮询休眠
+ *
+ * 帧定时:
+ *   收到字节时按功能码、字节数和异常位推算响应长度，最后一个字节
+ *   到达即完成；帧未收完而总线静默T3.5视为截断帧。两帧之间至少
+ *   保持T3.5静默，广播后等待广播转换延时。T1.5/T3.5按波特率和
+ *   字符格式计算，波特率大于19200时固定为750us/1750us
+ *
  * History:
  *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 增加异步请求队列，同步接口改为异步请求的封装
+ *   3. 2026-10-18 按功能码/字节数推算响应长度，T3.5字符间隔和帧间隔定时
+ *   4. 2026-10-18 CRC改用SerialCrc16，响应CRC随接收增量计算
+ *   5. 2026-10-18 打开串口后按配置启用内核RS-485方向控制
  ***************************************************************/
 
 #ifndef IMX6ULL_PROTOCOLS_MODBUS_RTU_H
 #define IMX6ULL_PROTOCOLS_MODBUS_RTU_H
 
 #include "protocols/IProtocolInterface.h"
+#include "drivers/serial/SerialCrc16.h"
+#include "drivers/serial/SerialRs485.h"
 #include <QSerialPort>
 #include <QTimer>
+#include <QQueue>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <functional>
 
 /***************************************************************
  * 枚举: ModbusFunctionCode
@@ -44,6 +66,69 @@ enum class ModbusFunctionCode : quint8 {
     WriteMultipleRegisters = 0x10       // 写多个寄存器
 };
 
+/***************************************************************
+ * 枚举: ModbusRtuStatus
+ * 功能: 一次请求的结果
+ ***************************************************************/
+enum class ModbusRtuStatus {
+    Success = 0,                        // 正常响应（广播为发送完成）
+    Exception,                          // 异常响应
+    Timeout,                            // 超时未收到响应
+    CrcError,                           // 响应CRC错误
+    FrameError,                         // 响应截断、地址或功能码不符
+    NotConnected,                       // 串口未打开
+    QueueFull,                          // 请求队列已满
+    Cancelled,                          // 被取消或断开连接
+    SerialError                         // 串口读写错误
+};
+
+/***************************************************************
+ * 结构体: ModbusRtuResult
+ * 功能: 异步请求的完成结果
+ ***************************************************************/
+struct ModbusRtuResult
+{
+    quint32 id;                         // 请求ID
+    ModbusRtuStatus status;             // 结果
+    quint8 slave;                       // 从站地址
+    quint8 functionCode;                // 功能码
+    quint8 exceptionCode;               // 异常码（status为Exception时有效）
+    QByteArray request;                 // 请求帧（含CRC）
+    QByteArray response;                // 响应帧（含CRC，可能为空）
+    qint64 elapsedUs;                   // 开始发送到完成的时间
+
+    ModbusRtuResult()
+        : id(0), status(ModbusRtuStatus::Success), slave(0), functionCode(0)
+        , exceptionCode(0), elapsedUs(0)
+    {
+    }
+
+    bool isSuccess() const { return status == ModbusRtuStatus::Success; }
+
+    /**
+     * @brief 读寄存器响应（0x03/0x04）中的寄存器值
+     */
+    QVector<quint16> registers() const;
+
+    /**
+     * @brief 读线圈/离散输入响应（0x01/0x02）中的状态
+     * @param count 请求的数量
+     */
+    QVector<bool> bits(quint16 count) const;
+
+    /**
+     * @brief 结果名称
+     */
+    static QString statusToString(ModbusRtuStatus status);
+};
+
+Q_DECLARE_METATYPE(ModbusRtuResult)
+
+/**
+ * @brief 异步请求完成回调（在ProtocolModbusRTU所属线程中调用）
+ */
+typedef std::function<void(const ModbusRtuResult &)> ModbusRtuCallback;
+
 /***************************************************************
  * 类名: ProtocolModbusRTU
  * 功能: Modbus RTU协议驱动类
@@ -59,6 +144,14 @@ enum class ModbusFunctionCode : quint8 {
  *   
  *   // 写入单个寄存器
  *   modbus.writeSingleRegister(0x0000, 1234);
+ *
+ *   // 异步读取（多个从站共用一条总线，请求自动排队）
+ *   modbus.readAsync(3, ModbusFunctionCode::ReadHoldingRegisters, 0x0100, 4,
+ *                    [](const ModbusRtuResult &result) {
+ *       if (result.isSuccess()) {
+ *           QVector<quint16> regs = result.registers();
+ *       }
+ *   });
  ***************************************************************/
 class ProtocolModbusRTU : public IProtocolInterface
 {
@@ -91,6 +184,16 @@ public:
     void disconnect() override;
     bool isConnected() const override;
     bool configure(const QMap<QString, QVariant> &config) override;
+
+    /**
+     * @brief 设置RS-485方向控制（在connect()前调用，打开串口后生效）
+     * @param config 模式、RTS极性、前后延迟、发送期间是否接收
+     * @return true=成功, false=串口已打开
+     * @note 本类自行打开QSerialPort，只支持内核方向控制（TIOCSRS485）；
+     *       gpio模式需要DriverSerial的I/O线程，这里只记录警告
+     */
+    bool setRs485(const SerialRs485Config &config);
+    SerialRs485Config getRs485() const { return m_rs485; }
     
     // ========== Modbus特定方法 ==========
     
@@ -112,6 +215,18 @@ public:
      */
     void setTimeout(int timeout);
     
+    /**
+     * @brief 设置广播后的转换延时（下一帧前的等待）
+     * @param msecs 毫秒，默认100
+     */
+    void setBroadcastDelay(int msecs) { m_broadcastDelay = qMax(0, msecs); }
+    
+    /**
+     * @brief 按当前串口参数计算的T1.5/T3.5（微秒）
+     */
+    int getT15Us() const { return m_t15Us; }
+    int getT35Us() const { return m_t35Us; }
+    
     /**
      * @brief 读取线圈状态 (功能码0x01)
      * @param startAddress 起始地址
@@ -176,6 +291,56 @@ public:
      */
     bool writeMultipleRegisters(quint16 startAddress, const QVector<quint16> &values);
 
+    // ========== 异步请求 ==========
+
+    /**
+     * @brief 提交请求（进入队列，串口空闲时立即发送）
+     * @param slave 从站地址（0=广播，不等待响应）
+     * @param functionCode 功能码
+     * @param data 功能码之后的数据（不含CRC）
+     * @param callback 完成回调（可为空）
+     * @param timeout 超时时间（毫秒，<=0使用setTimeout的值）
+     * @return 请求ID；未连接或队列满时返回0，并立即以失败结果回调
+     */
+    quint32 submitRequest(quint8 slave, quint8 functionCode, const QByteArray &data,
+                          const ModbusRtuCallback &callback = ModbusRtuCallback(), int timeout = 0);
+
+    /**
+     * @brief 异步读取（0x01~0x04）
+     */
+    quint32 readAsync(quint8 slave, ModbusFunctionCode functionCode, quint16 startAddress, quint16 count,
+                      const ModbusRtuCallback &callback = ModbusRtuCallback());
+
+    quint32 writeSingleCoilAsync(quint8 slave, quint16 address, bool value,
+                                 const ModbusRtuCallback &callback = ModbusRtuCallback());
+    quint32 writeSingleRegisterAsync(quint8 slave, quint16 address, quint16 value,
+                                     const ModbusRtuCallback &callback = ModbusRtuCallback());
+    quint32 writeMultipleCoilsAsync(quint8 slave, quint16 startAddress, const QVector<bool> &values,
+                                    const ModbusRtuCallback &callback = ModbusRtuCallback());
+    quint32 writeMultipleRegistersAsync(quint8 slave, quint16 startAddress, const QVector<quint16> &values,
+                                        const ModbusRtuCallback &callback = ModbusRtuCallback());
+
+    /**
+     * @brief 取消排队中的请求（正在进行的请求不能取消）
+     * @return true=已取消
+     */
+    bool cancelRequest(quint32 id);
+
+    /**
+     * @brief 取消所有排队中的请求
+     */
+    void cancelAll();
+
+    /**
+     * @brief 等待中的请求数（含正在进行的请求）
+     */
+    int pendingRequests() const { return m_queue.size() + (m_waitingForResponse ? 1 : 0); }
+
+    /**
+     * @brief 设置队列上限（默认256）
+     */
+    void setMaxQueueSize(int size) { m_maxQueueSize = qMax(1, size); }
+
 signals:
     /**
      * @brief Modbus异常信号
@@ -183,6 +348,11 @@ signals:
      */
     void modbusException(quint8 exceptionCode);
 
+    /**
+     * @brief 请求完成信号（回调之后发出）
+     */
+    void requestFinished(const ModbusRtuResult &result);
+
 private slots:
     /**
      * @brief 串口数据接收槽函数
@@ -193,68 +363,139 @@ private slots:
      * @brief 响应超时槽函数
      */
     void onResponseTimeout();
+    
+    /**
+     * @brief 字符间隔（T3.5）超时槽函数
+     */
+    void onCharTimeout();
+    
+    /**
+     * @brief 帧间隔定时到，发送下一个请求
+     */
+    void onGapTimeout();
 
 private:
     /**
-     * @brief 发送Modbus请求并等待响应
-     * @param request 请求帧
-     * @return 响应帧（空表示失败）
+     * @brief 排队中的请求
      */
-    QByteArray sendRequest(const QByteArray &request);
-    
+    struct PendingRequest
+    {
+        quint32 id;
+        quint8 slave;
+        quint8 functionCode;
+        QByteArray frame;               // 完整请求帧
+        int timeout;                    // 超时时间（毫秒）
+        ModbusRtuCallback callback;
+    };
+
+    /**
+     * @brief 以默认从站提交请求并在本线程上等待完成（同步接口使用）
+     */
+    ModbusRtuResult execute(quint8 functionCode, const QByteArray &data);
+
+    /**
+     * @brief 等待指定请求完成（waitForReadyRead驱动，不进入事件循环）
+     */
+    ModbusRtuResult waitForRequest(quint32 id);
+
+    /**
+     * @brief 串口空闲时发送队首请求
+     */
+    void startNext();
+
+    /**
+     * @brief 结束当前请求: 回调、发信号并开始下一个
+     */
+    void finishActive(ModbusRtuStatus status);
+
+    /**
+     * @brief 以失败结果完成一个未发送的请求
+     */
+    void failRequest(const PendingRequest &request, ModbusRtuStatus status);
+
+    /**
+     * @brief 发布结果（同步等待者、回调、信号）
+     */
+    void deliver(const ModbusRtuResult &result, const ModbusRtuCallback &callback);
+
     /**
      * @brief 构建Modbus请求帧
+     * @param slave 从站地址
      * @param functionCode 功能码
      * @param data 数据部分
      * @return 完整请求帧（含CRC）
      */
-    QByteArray buildRequest(quint8 functionCode, const QByteArray &data);
-    
+    QByteArray buildRequest(quint8 slave, quint8 functionCode, const QByteArray &data);
+
     /**
-     * @brief 验证响应帧
-     * @param response 响应帧
-     * @return true=有效, false=无效
+     * @brief 按已收到的字节推算响应帧长度
+     * @return >0 帧长度, 0 需要更多字节, -1 无法推算
      */
-    bool validateResponse(const QByteArray &response);
-    
+    static int expectedResponseLength(quint8 functionCode, const QByteArray &buffer);
+
     /**
-     * @brief 计算CRC16校验码
-     * @param data 数据
-     * @return CRC16值
+     * @brief 响应帧收完（或静默结束）: 检查地址、功能码和CRC并完成请求
      */
-    quint16 calculateCRC16(const QByteArray &data);
-    
+    void completeFrame();
+
     /**
-     * @brief 解析布尔值列表（用于线圈/离散输入）
-     * @param data 数据字节
-     * @param count 数量
-     * @return 布尔值列表
+     * @brief 在已打开的串口上启用内核RS-485
+     * @return true=成功或无需设置, false=失败
      */
-    QVector<bool> parseBooleans(const QByteArray &data, quint16 count);
-    
+    bool applyRs485();
+
     /**
-     * @brief 解析寄存器值列表
-     * @param data 数据字节
-     * @return 寄存器值列表
+     * @brief 按波特率和字符格式计算字符时间和T1.5/T3.5
      */
-    QVector<quint16> parseRegisters(const QByteArray &data);
+    void updateTiming();
+
+    /**
+     * @brief 把已收到的数据（不含可能是CRC的最后2字节）计入接收CRC
+     */
+    void updateReceiveCrc();
+
+    static QByteArray buildAddressData(quint16 startAddress, quint16 count);
+    static QByteArray buildCoilsData(quint16 startAddress, const QVector<bool> &values);
+    static QByteArray buildRegistersData(quint16 startAddress, const QVector<quint16> &values);
 
 private:
     QSerialPort *m_serialPort;          // 串口对象
     QString m_portName;                 // 串口名称
-    quint8 m_slaveAddress;              // 从站地址
+    quint8 m_slaveAddress;              // 从站地址（同步接口使用）
     
     QTimer *m_responseTimer;            // 响应超时定时器
     int m_timeout;                      // 超时时间（毫秒）
     
     QByteArray m_receiveBuffer;         // 接收缓冲区
-    bool m_waitingForResponse;          // 等待响应标志
+    bool m_waitingForResponse;          // 有正在进行的请求
+
+    // 异步请求
+    QQueue<PendingRequest> m_queue;     // 排队中的请求
+    PendingRequest m_active;            // 正在进行的请求
+    QElapsedTimer m_activeTimer;        // 当前请求开始时刻
+    quint32 m_nextId;                   // 下一个请求ID
+    int m_maxQueueSize;                 // 队列上限
+    QHash<quint32, ModbusRtuResult *> m_syncWaiters;  // 同步等待中的请求
+
+    // 帧定时
+    QTimer *m_charTimer;                // 字符间隔（T3.5）定时器
+    QTimer *m_gapTimer;                 // 帧间隔定时器
+    int m_expectedLength;               // 推算的响应长度（0=未知, -1=无法推算）
+    SerialCrc16 m_rxCrc;                // 响应CRC（随接收增量计算）
+    int m_rxCrcBytes;                   // 已计入m_rxCrc的字节数
+    int m_charUs;                       // 一个字符的时间
+    int m_t15Us;                        // T1.5
+    int m_t35Us;                        // T3.5
+    QElapsedTimer m_busClock;           // 总线时间基准
+    qint64 m_quietUntilUs;              // 此时刻前不发送下一帧
+    int m_broadcastDelay;               // 广播转换延时（毫秒）
     
     // 串口配置参数
     int m_baudrate;                     // 波特率
     QSerialPort::DataBits m_dataBits;   // 数据位
     QSerialPort::Parity m_parity;       // 校验位
     QSerialPort::StopBits m_stopBits;   // 停止位
+    SerialRs485Config m_rs485;          // RS-485方向控制
 };
 
 #endif // PROTOCOL_MODBUS_RTU_H
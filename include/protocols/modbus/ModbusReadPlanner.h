@@ -0,0 +1,197 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: ModbusReadPlanner.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: Modbus块读取规划 - 合并相邻地址的读请求
+ *
+ * 功能说明:
+ *   RTU上一次请求的固定开销（请求8字节、响应头和CRC 5字节、两次T3.5
+ *   静默和从站处理时间）远大于多读一个寄存器的2字节，同一从站零散的
+ *   40个寄存器逐个读取要40个来回。本规划器把需要读取的地址按从站和
+ *   功能码分组、按地址排序后从左到右贪心合并:
+ *   - 下一段与当前块的空隙不超过空隙阈值，且合并后长度不超过单次上限
+ *     （寄存器125个、线圈/离散输入2000个，可按设备调小）时并入当前块，
+ *     否则另起一块；排序后的贪心在这两个约束下得到最少的块数
+ *   - 空隙中多读的地址直接丢弃；部分从站对未定义的地址返回异常02，
+ *     这类设备把空隙阈值设为0（只合并紧邻的地址）
+ *   - 每块对应一段连续的切片（请求标签、块内偏移、数量），响应按切片
+ *     直接写回调用方的存储，不为每个点分配内存
+ *
+ *   规划器复用内部数组（resize(0)保留容量），反复规划不分配内存。
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 规划时可不填充空隙（只合并紧邻或重叠的地址）
+ ***************************************************************/
+
+#ifndef IMX6ULL_PROTOCOLS_MODBUS_READ_PLANNER_H
+#define IMX6ULL_PROTOCOLS_MODBUS_READ_PLANNER_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <QByteArray>
+
+/***************************************************************
+ * 枚举: ModbusPointType
+ * 功能: 读取的数据类型（取值即读功能码）
+ ***************************************************************/
+enum class ModbusPointType : quint8 {
+    Coil = 0x01,                        // 线圈（0x01）
+    DiscreteInput = 0x02,               // 离散输入（0x02）
+    HoldingRegister = 0x03,             // 保持寄存器（0x03）
+    InputRegister = 0x04                // 输入寄存器（0x04）
+};
+
+/***************************************************************
+ * 类名: ModbusReadPlanner
+ * 功能: 把零散的读请求合并成尽量少的块读取
+ *
+ * 使用示例:
+ *   ModbusReadPlanner planner;
+ *   planner.setMaxGap(8, 64);
+ *   for (int i = 0; i < points.size(); ++i) {
+ *       planner.add(points[i].slave, points[i].type, points[i].address, points[i].count, i);
+ *   }
+ *   planner.plan();
+ *   for (const ModbusReadPlanner::Block &block : planner.blocks()) {
+ *       // 用block.slave/type/address/count发出读取，响应到达后:
+ *       const uchar *payload = ModbusReadPlanner::payload(block, response);
+ *       for (int s = block.firstSlice; s < block.firstSlice + block.sliceCount; ++s) {
+ *           const ModbusReadPlanner::Slice &slice = planner.slices()[s];
+ *           for (int i = 0; i < slice.count; ++i) {
+ *               store(slice.tag, i, ModbusReadPlanner::valueAt(block.type, payload, slice.offset + i));
+ *           }
+ *       }
+ *   }
+ ***************************************************************/
+class ModbusReadPlanner
+{
+public:
+    enum {
+        MaxReadRegisters = 125,         // 0x03/0x04单次最多寄存器数
+        MaxReadBits = 2000              // 0x01/0x02单次最多位数
+    };
+
+    /**
+     * @brief 一次块读取
+     */
+    struct Block
+    {
+        quint8 slave;
+        ModbusPointType type;
+        quint16 address;                // 起始地址
+        quint16 count;                  // 读取数量
+        int firstSlice;                 // 在slices()中的起点
+        int sliceCount;                 // 切片数
+    };
+
+    /**
+     * @brief 块中属于某个请求的一段
+     */
+    struct Slice
+    {
+        int tag;                        // add()时的标签
+        quint16 offset;                 // 在块中的偏移
+        quint16 count;                  // 数量
+    };
+
+    ModbusReadPlanner();
+
+    // ========== 参数 ==========
+
+    /**
+     * @brief 空隙阈值: 两段之间最多多读多少个地址仍合并
+     * @param registers 寄存器（默认10，约为一次请求固定开销的一半）
+     * @param bits 线圈/离散输入（默认160，即20字节）
+     */
+    void setMaxGap(int registers, int bits);
+
+    /**
+     * @brief 单块上限（设备支持的单次读取数量小于协议上限时调小）
+     * @param registers 1~125，默认125
+     * @param bits 1~2000，默认2000
+     * @note 超过上限的单个请求仍单独成块
+     */
+    void setMaxBlock(int registers, int bits);
+
+    int getMaxGap(ModbusPointType type) const;
+    int getMaxBlock(ModbusPointType type) const;
+
+    // ========== 规划 ==========
+
+    /**
+     * @brief 清空请求和上次的规划结果（保留容量）
+     */
+    void clear();
+
+    /**
+     * @brief 添加一段需要读取的地址
+     * @param tag 调用方的标签（点ID、下标等），原样出现在切片中
+     */
+    void add(quint8 slave, ModbusPointType type, quint16 address, quint16 count, int tag);
+
+    /**
+     * @brief 计算块读取
+     * @param fillGaps false=忽略空隙阈值，只合并紧邻或重叠的地址
+     * @return 块数
+     */
+    int plan(bool fillGaps = true);
+
+    int requestCount() const { return m_requests.size(); }
+    const QVector<Block> &blocks() const { return m_blocks; }
+    const QVector<Slice> &slices() const { return m_slices; }
+
+    /**
+     * @brief 查找包含某个标签的块
+     * @return 块下标；没有时返回-1
+     */
+    int findBlock(int tag) const;
+
+    // ========== 响应拆分 ==========
+
+    /**
+     * @brief 检查块读取的响应并返回数据部分
+     * @param response 完整响应帧 [地址][功能码][字节数][数据...][CRC]
+     * @return 数据起点；字节数与块不符时返回nullptr
+     */
+    static const uchar *payload(const Block &block, const QByteArray &response);
+
+    /**
+     * @brief 数据中第index个值（寄存器为大端16位，线圈/离散输入为0或1）
+     */
+    static quint16 valueAt(ModbusPointType type, const uchar *payload, int index)
+    {
+        if (type == ModbusPointType::Coil || type == ModbusPointType::DiscreteInput) {
+            return static_cast<quint16>((payload[index / 8] >> (index % 8)) & 0x01);
+        }
+        return static_cast<quint16>((payload[index * 2] << 8) | payload[index * 2 + 1]);
+    }
+
+    static bool isBitType(ModbusPointType type)
+    {
+        return type == ModbusPointType::Coil || type == ModbusPointType::DiscreteInput;
+    }
+
+private:
+    struct Request
+    {
+        quint8 slave;
+        ModbusPointType type;
+        quint16 address;
+        quint16 count;
+        int tag;
+    };
+
+    QVector<Request> m_requests;
+    QVector<Block> m_blocks;
+    QVector<Slice> m_slices;
+
+    int m_gapRegisters;
+    int m_gapBits;
+    int m_maxRegisters;
+    int m_maxBits;
+};
+
+#endif // IMX6ULL_PROTOCOLS_MODBUS_READ_PLANNER_H
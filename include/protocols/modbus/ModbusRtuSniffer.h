@@ -0,0 +1,315 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: ModbusRtuSniffer.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: Modbus RTU总线只听监视器
+ *
+ * 功能说明:
+ *   与第三方主站共用一段RS-485总线时，只监听不发送，把总线上的
+ *   请求/响应解码成带时间戳的事务流:
+ *   - 挂接在DriverSerial的I/O线程接收路径上（SerialDataListener），
+ *     按每次read()的时间戳和字符时间估算每个字节的到达时刻
+ *   - 字符间静默超过T3.5（波特率>19200时固定1750us）视为帧边界；
+ *     静默不足时（tty按FIFO批量交付、主站帧间隔过短）按功能码和
+ *     字节数推算帧长并校验CRC，从同一段数据中拆出连续的帧
+ *   - 同一从站、同一功能码的请求和响应配对，计算从站响应时间；
+ *     响应超时、广播、无法配对的响应都作为独立事务上报
+ *   - 解码功能码0x01~0x10中的公开功能码（01-08、0B、0C、0F、10）
+ *   - 按从站统计请求数、响应数、异常数、无响应数和响应时间
+ *
+ *   I/O线程中只做分帧、CRC和配对，帧数据复制到预分配的事务队列，
+ *   不分配内存；解码成ModbusSnifferTransaction在调用takeTransactions()
+ *   的线程中进行。队列满（上层长期不取）时丢弃新事务并计数，接收和
+ *   分帧本身不会丢数据。
+ *
+ * 注意:
+ *   挂接后DriverSerial的读缓冲区会被清空（数据只给监视器使用）；
+ *   监视器从不调用write()；RS-485收发器的DE须保持无效（不要对该
+ *   串口启用RS-485方向控制）
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_PROTOCOLS_MODBUS_RTU_SNIFFER_H
+#define IMX6ULL_PROTOCOLS_MODBUS_RTU_SNIFFER_H
+
+#include "drivers/serial/SerialDataListener.h"
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <QMap>
+#include <QMutex>
+#include <QTimer>
+#include <QAtomicInt>
+#include <QPointer>
+#include <QMetaType>
+
+class DriverSerial;
+
+/***************************************************************
+ * 枚举: ModbusSnifferStatus
+ * 功能: 监听到的事务结果
+ ***************************************************************/
+enum class ModbusSnifferStatus : quint8 {
+    Ok = 0,                 // 请求和正常响应
+    Exception,              // 请求和异常响应
+    NoResponse,             // 请求后超时或出现下一个请求前没有响应
+    Broadcast,              // 广播请求（从站地址0，无响应）
+    Unmatched               // 没有对应请求的响应（如监听开始于事务中途）
+};
+
+/***************************************************************
+ * 结构体: ModbusSnifferTransaction
+ * 功能: 解码后的一次事务
+ ***************************************************************/
+struct ModbusSnifferTransaction
+{
+    ModbusSnifferStatus status;
+    quint8 slave;               // 从站地址
+    quint8 function;            // 功能码（不含异常位）
+    quint8 exceptionCode;       // 异常码（status为Exception时有效）
+    quint16 address;            // 起始地址（08为子功能码）
+    quint16 quantity;           // 数量
+    QVector<quint16> values;    // 读: 响应数据; 写: 写入数据; 线圈每点一个0/1
+    qint64 requestUs;           // 请求首字节开始时刻（CLOCK_MONOTONIC微秒，0=无请求）
+    qint64 responseUs;          // 响应首字节开始时刻（0=无响应）
+    qint64 latencyUs;           // 请求末字节到响应首字节（-1=无）
+    QByteArray request;         // 原始请求帧（含CRC）
+    QByteArray response;        // 原始响应帧（含CRC）
+
+    ModbusSnifferTransaction()
+        : status(ModbusSnifferStatus::Ok), slave(0), function(0), exceptionCode(0)
+        , address(0), quantity(0), requestUs(0), responseUs(0), latencyUs(-1)
+    {
+    }
+};
+
+Q_DECLARE_METATYPE(ModbusSnifferTransaction)
+
+/**
+ * @brief 单个从站的统计
+ */
+struct ModbusSnifferSlaveStats
+{
+    quint64 requests;           // 请求数
+    quint64 responses;          // 响应数（含异常响应）
+    quint64 exceptions;         // 异常响应数
+    quint64 noResponses;        // 无响应数
+    qint64 latencyMinUs;        // 最短响应时间
+    qint64 latencyMaxUs;        // 最长响应时间
+    qint64 latencySumUs;        // 响应时间之和（平均值 = latencySumUs / responses）
+    qint64 lastSeenUs;          // 最后一帧时刻
+
+    ModbusSnifferSlaveStats()
+        : requests(0), responses(0), exceptions(0), noResponses(0)
+        , latencyMinUs(0), latencyMaxUs(0), latencySumUs(0), lastSeenUs(0)
+    {
+    }
+};
+
+/**
+ * @brief 总线统计
+ */
+struct ModbusSnifferStats
+{
+    quint64 bytes;              // 收到的字节数
+    quint64 frames;             // CRC正确的帧数
+    quint64 crcErrors;          // CRC错误或无法识别的段数
+    quint64 noiseBytes;         // 因此丢弃的字节数
+    quint64 unmatched;          // 无法配对的响应数
+    quint64 transactions;       // 进入队列的事务数
+    quint64 dropped;            // 队列满丢弃的事务数
+
+    ModbusSnifferStats()
+        : bytes(0), frames(0), crcErrors(0), noiseBytes(0), unmatched(0), transactions(0), dropped(0)
+    {
+    }
+};
+
+/***************************************************************
+ * 类名: ModbusRtuSniffer
+ * 功能: Modbus RTU总线只听监视器
+ *
+ * 使用示例:
+ *   DriverSerial serial("/dev/ttymxc2");
+ *   serial.setBaudRate(115200);
+ *   ModbusRtuSniffer sniffer;
+ *   sniffer.setBaudRate(115200);
+ *   sniffer.attach(&serial);            // open()前调用
+ *   serial.open();
+ *
+ *   connect(&sniffer, &ModbusRtuSniffer::transactionsAvailable, [&]() {
+ *       QVector<ModbusSnifferTransaction> list;
+ *       sniffer.takeTransactions(list);
+ *       ...
+ *   });
+ *
+ * 线程安全:
+ *   配置接口在attach前调用；takeTransactions和统计接口在所属线程调用
+ ***************************************************************/
+class ModbusRtuSniffer : public QObject, public SerialDataListener
+{
+    Q_OBJECT
+
+public:
+    explicit ModbusRtuSniffer(QObject *parent = nullptr);
+    ~ModbusRtuSniffer() override;
+
+    // ========== 参数 ==========
+
+    /**
+     * @brief 按波特率计算字符时间和T3.5（每字符按11位计）
+     * @param baudRate 波特率，默认9600
+     */
+    void setBaudRate(qint32 baudRate);
+
+    /**
+     * @brief 覆盖帧间静默阈值
+     * @param us 微秒（0=按波特率计算）
+     */
+    void setFrameGapUs(int us);
+    int getFrameGapUs() const { return m_gapUs; }
+
+    /**
+     * @brief 请求后等待响应的最长时间
+     * @param msecs 毫秒，默认1000
+     */
+    void setResponseTimeout(int msecs);
+
+    /**
+     * @brief 事务队列容量（attach前设置）
+     * @param count 16~65536，默认1024
+     */
+    void setQueueSize(int count);
+
+    // ========== 挂接 ==========
+
+    /**
+     * @brief 挂接到串口（需在open()前调用，自动启用I/O线程）
+     * @return true=成功, false=串口已打开或已挂接其他串口
+     */
+    bool attach(DriverSerial *serial);
+
+    /**
+     * @brief 从串口摘下
+     */
+    void detach();
+
+    // ========== 结果 ==========
+
+    /**
+     * @brief 取出并解码已完成的事务
+     * @param out 追加到该列表
+     * @param maxCount 最多取出的数量（<=0表示全部）
+     * @return 取出的数量
+     */
+    int takeTransactions(QVector<ModbusSnifferTransaction> &out, int maxCount = 0);
+
+    ModbusSnifferStats getStats() const;
+
+    /**
+     * @brief 各从站统计（只含出现过的从站，广播计入地址0）
+     */
+    QMap<int, ModbusSnifferSlaveStats> getSlaveStats() const;
+
+    void resetStats();
+
+    /**
+     * @brief 生成统计报告
+     */
+    QString generateReport() const;
+
+    /**
+     * @brief 事务状态名称
+     */
+    static QString statusToString(ModbusSnifferStatus status);
+
+    // ========== SerialDataListener ==========
+
+    void serialDataReceived(const char *data, int length, qint64 timestampUs) override;
+
+signals:
+    /**
+     * @brief 队列由空变为非空（I/O线程发出，取走前不再重复发出）
+     */
+    void transactionsAvailable();
+
+private slots:
+    /**
+     * @brief 总线空闲检查: 结束最后一段数据、使超时的请求失效
+     */
+    void onIdleCheck();
+
+private:
+    enum {
+        MaxFrame = 256,         // RTU帧最大长度
+        BufferSize = 1024       // 分帧缓冲区
+    };
+
+    /**
+     * @brief 一帧原始数据（预分配，I/O线程中只做memcpy）
+     */
+    struct RawFrame
+    {
+        qint64 firstUs;         // 首字节开始时刻
+        qint64 lastUs;          // 末字节结束时刻
+        int length;             // 0=无
+        uchar data[MaxFrame];
+    };
+
+    struct RawTransaction
+    {
+        ModbusSnifferStatus status;
+        RawFrame request;
+        RawFrame response;
+    };
+
+    /**
+     * @brief 推算帧长度
+     * @return >0 帧长度, 0 需要更多字节, -1 未知功能码
+     */
+    static int expectedLength(const uchar *frame, int available, bool response);
+
+    void appendBytes(const uchar *data, int length, qint64 timestampUs);
+    void extractFrames(bool segmentEnd);
+    void handleFrame(int offset, int length, bool response);
+    void finishPending(ModbusSnifferStatus status, const RawFrame *response);
+    void pushTransaction(ModbusSnifferStatus status, const RawFrame *request, const RawFrame *response);
+    void fillFrame(RawFrame &frame, int offset, int length) const;
+    void updateTiming();
+    static void decode(const RawTransaction &raw, ModbusSnifferTransaction &out);
+
+    QPointer<DriverSerial> m_serial;    // 挂接的串口
+
+    int m_charUs;                       // 一个字符的时间
+    int m_gapUs;                        // 帧间静默阈值
+    int m_gapOverrideUs;                // 手动设置的阈值（0=按波特率）
+    qint64 m_timeoutUs;                 // 响应超时
+
+    // 分帧和配对状态（I/O线程，空闲检查时在所属线程，均加锁）
+    mutable QMutex m_mutex;
+    uchar m_buffer[BufferSize];         // 当前段数据
+    qint64 m_times[BufferSize];         // 每个字节结束时刻
+    int m_head;                         // 未处理数据起点
+    int m_tail;                         // 未处理数据终点
+    qint64 m_lastByteUs;                // 最后一个字节结束时刻
+    bool m_pendingActive;               // 有等待响应的请求
+    RawFrame m_pending;                 // 等待响应的请求
+
+    // 事务队列
+    QVector<RawTransaction> m_queue;
+    int m_queueHead;
+    int m_queueCount;
+    QAtomicInt m_notifyPending;         // 已发出transactionsAvailable尚未取走
+
+    // 统计
+    ModbusSnifferStats m_stats;
+    ModbusSnifferSlaveStats m_slaveStats[256];
+
+    QTimer *m_idleTimer;                // 空闲检查
+};
+
+#endif // IMX6ULL_PROTOCOLS_MODBUS_RTU_SNIFFER_H
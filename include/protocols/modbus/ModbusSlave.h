@@ -24,15 +24,20 @@
  *
  * History:
  *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 寄存器访问加锁，增加批量写入接口（供CAN信号桥接在接收线程调用）
+ *   3. 2026-10-18 CRC改用SerialCrc16公共实现
+ *   4. 2026-10-18 打开串口后按配置启用内核RS-485方向控制
  ***************************************************************/
 
 #ifndef IMX6ULL_PROTOCOLS_MODBUS_SLAVE_H
 #define IMX6ULL_PROTOCOLS_MODBUS_SLAVE_H
 
 #include "protocols/IProtocolInterface.h"
+#include "drivers/serial/SerialRs485.h"
 #include <QSerialPort>
 #include <QTimer>
 #include <QVector>
+#include <QMutex>
 
 /***************************************************************
  * 类名: ProtocolModbusSlave
@@ -53,6 +58,24 @@ class ProtocolModbusSlave : public IProtocolInterface
     Q_OBJECT
     
 public:
+    /**
+     * @brief 寄存器表
+     */
+    enum RegisterTable {
+        HoldingRegisters = 0,   // 保持寄存器（功能码0x03/0x06/0x10）
+        InputRegisters          // 输入寄存器（功能码0x04）
+    };
+    
+    /**
+     * @brief 单个寄存器写入项（批量写入用）
+     */
+    struct RegisterWrite
+    {
+        quint8 table;           // RegisterTable
+        quint16 address;        // 寄存器地址
+        quint16 value;          // 寄存器值
+    };
+    
     /**
      * @brief 构造函数
      * @param portName 串口名称
@@ -81,6 +104,16 @@ public:
     void disconnect() override;
     bool isConnected() const override;
     bool configure(const QMap<QString, QVariant> &config) override;
+
+    /**
+     * @brief 设置RS-485方向控制（在connect()前调用，打开串口后生效）
+     * @param config 模式、RTS极性、前后延迟、发送期间是否接收
+     * @return true=成功, false=串口已打开
+     * @note 本类自行打开QSerialPort，只支持内核方向控制（TIOCSRS485）；
+     *       gpio模式需要DriverSerial的I/O线程，这里只记录警告
+     */
+    bool setRs485(const SerialRs485Config &config);
+    SerialRs485Config getRs485() const { return m_rs485; }
     
 public slots:
     // ========== Modbus从站特定方法 ==========
@@ -115,6 +148,26 @@ public:
      */
     quint16 getHoldingRegister(quint16 address) const;
     
+    /**
+     * @brief 获取输入寄存器值
+     * @param address 寄存器地址
+     * @return 寄存器值
+     */
+    quint16 getInputRegister(quint16 address) const;
+    
+    /**
+     * @brief 批量写入寄存器（一次加锁，同一批内的多寄存器值不会被读请求拆开）
+     * @param writes 写入项数组
+     * @param count 写入项数量
+     * @note 线程安全，可在CAN接收线程中直接调用；地址越界的项被忽略
+     */
+    void applyRegisterWrites(const RegisterWrite *writes, int count);
+    
+    /**
+     * @brief 每张寄存器表的寄存器数量
+     */
+    static int registerCount() { return MAX_REGISTERS; }
+    
     /**
      * @brief 设置从站地址
      * @param address 从站地址（1-247）
@@ -186,6 +239,12 @@ private:
      * @param response 响应数据（不含CRC）
      */
     void sendResponse(const QByteArray &response);
+
+    /**
+     * @brief 在已打开的串口上启用内核RS-485
+     * @return true=成功或无需设置, false=失败
+     */
+    bool applyRs485();
     
     /**
      * @brief 发送异常响应
@@ -194,13 +253,6 @@ private:
      */
     void sendException(quint8 functionCode, quint8 exceptionCode);
     
-    /**
-     * @brief 计算CRC16校验码
-     * @param data 数据
-     * @return CRC16值
-     */
-    quint16 calculateCRC16(const QByteArray &data);
-    
     /**
      * @brief 验证CRC
      * @param data 数据（含CRC）
@@ -221,10 +273,12 @@ private:
     QSerialPort::DataBits m_dataBits;   // 数据位
     QSerialPort::Parity m_parity;       // 校验位
     QSerialPort::StopBits m_stopBits;   // 停止位
+    SerialRs485Config m_rs485;          // RS-485方向控制
     
     // Modbus数据寄存器
     QVector<quint16> m_holdingRegisters; // 保持寄存器（可读写）
     QVector<quint16> m_inputRegisters;   // 输入寄存器（只读）
+    mutable QMutex m_registerMutex;      // 保护寄存器（从站线程、主线程、CAN接收线程并发访问）
     
     static const int MAX_REGISTERS = 256; // 最大寄存器数量
 };
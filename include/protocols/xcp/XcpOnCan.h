@@ -0,0 +1,356 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: XcpOnCan.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: XCP-on-CAN测量从站（ASAM MCD-1 XCP 1.x）
+ *
+ * 功能说明:
+ *   让标定/测量工具（CANape、INCA等）以高速率读取内部变量，
+ *   如温度、Modbus寄存器值、PWM占空比：
+ *   - CONNECT/DISCONNECT/GET_STATUS/SYNCH
+ *   - SET_MTA/UPLOAD/SHORT_UPLOAD/DOWNLOAD（按地址读写已注册变量）
+ *   - 静态DAQ列表（应用预定义）与动态DAQ列表（FREE/ALLOC_DAQ/ODT/ENTRY）
+ *   - 事件通道（周期事件由采样线程调度，或由应用触发）
+ *   - 采样线程内完成ODT打包（DTO），每个事件一次批量发送
+ *
+ * 地址空间:
+ *   XCP地址不是真实内存地址，而是registerVariable()登记的虚拟地址，
+ *   只有落在已登记变量范围内的访问才被允许，其余返回ERR_ACCESS_DENIED。
+ *   WRITE_DAQ时即把地址解析为变量指针，采样时只做memcpy。
+ *
+ * XCP on CAN帧格式:
+ *   CRO（主站->从站）: [PID/命令码][参数...]          CAN ID = cro_id
+ *   RES/ERR（从站->主站）: [0xFF/0xFE][数据...]       CAN ID = dto_id
+ *   DAQ（从站->主站）: [ODT绝对编号][时间戳(4)][数据]  CAN ID = dto_id
+ *   字节序: Intel（小端），地址粒度: 字节，MAX_CTO = MAX_DTO = 8
+ *
+ * 注意:
+ *   变量登记与静态DAQ列表需在connect()之前完成
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_PROTOCOLS_XCP_ON_CAN_H
+#define IMX6ULL_PROTOCOLS_XCP_ON_CAN_H
+
+#include "protocols/IProtocolInterface.h"
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QVector>
+#include <QCanBusFrame>
+
+class DriverCANHighPerf;
+class ProtocolXcpCan;
+
+/**
+ * @brief DAQ测量项（静态DAQ列表定义用）
+ */
+struct XcpMeasurement
+{
+    quint32 address;        // XCP地址
+    quint8 size;            // 字节数（1-7）
+};
+
+/***************************************************************
+ * 类名: XcpDaqThread
+ * 功能: XCP事件采样线程
+ *
+ * 说明:
+ *   按事件通道周期唤醒，对该事件上运行中的DAQ列表采样并打包DTO
+ ***************************************************************/
+class XcpDaqThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit XcpDaqThread(ProtocolXcpCan *slave, QObject *parent = nullptr);
+
+    /**
+     * @brief 停止采样线程
+     */
+    void stopSampling();
+
+protected:
+    void run() override;
+
+private:
+    ProtocolXcpCan *m_slave;
+};
+
+/***************************************************************
+ * 类名: ProtocolXcpCan
+ * 功能: XCP-on-CAN从站
+ *
+ * 使用示例:
+ *   DriverCANHighPerf can("can0");
+ *   can.open(500000);
+ *
+ *   ProtocolXcpCan xcp(&can);
+ *   xcp.configure({{"cro_id", 0x7F0}, {"dto_id", 0x7F1}});
+ *   xcp.registerVariable("cpu_temp", 0x1000, &g_cpuTemp, sizeof(g_cpuTemp));
+ *   xcp.registerVariable("pwm_duty", 0x1004, &g_pwmDuty, sizeof(g_pwmDuty), true);
+ *   int ev10ms = xcp.addEventChannel("10ms", 10);
+ *   xcp.addStaticDaqList(ev10ms, {{0x1000, 4}, {0x1004, 2}});
+ *   xcp.connect();
+ ***************************************************************/
+class ProtocolXcpCan : public IProtocolInterface
+{
+    Q_OBJECT
+
+    friend class XcpDaqThread;
+
+public:
+    /**
+     * @brief 构造函数
+     * @param can CAN驱动（需已打开或稍后打开）
+     * @param parent 父对象指针
+     */
+    explicit ProtocolXcpCan(DriverCANHighPerf *can, QObject *parent = nullptr);
+
+    ~ProtocolXcpCan() override;
+
+    // ========== 实现IProtocolInterface接口 ==========
+
+    ProtocolType getProtocolType() const override {
+        return ProtocolType::XCP;
+    }
+
+    QString getProtocolName() const override {
+        return "XCP on CAN";
+    }
+
+    bool connect() override;
+    void disconnect() override;
+    bool isConnected() const override;
+
+    /**
+     * @brief 配置协议参数
+     * @param config 支持: cro_id, dto_id, extended(bool), max_dynamic_daq
+     */
+    bool configure(const QMap<QString, QVariant> &config) override;
+
+    // ========== 变量与事件登记 ==========
+
+    /**
+     * @brief 登记可测量/标定的变量
+     * @param name 变量名称（用于报告）
+     * @param address XCP地址
+     * @param ptr 变量地址
+     * @param size 字节数
+     * @param writable 是否允许DOWNLOAD写入
+     * @return true=成功, false=地址重叠或参数无效
+     */
+    bool registerVariable(const QString &name, quint32 address, void *ptr,
+                          int size, bool writable = false);
+
+    /**
+     * @brief 添加事件通道
+     * @param name 事件名称
+     * @param cycleMs 周期（毫秒），0表示由triggerEvent()触发
+     * @return 事件通道号，-1表示失败
+     */
+    int addEventChannel(const QString &name, int cycleMs);
+
+    /**
+     * @brief 触发事件（线程安全，用于非周期事件）
+     * @param channel 事件通道号
+     */
+    void triggerEvent(int channel);
+
+    /**
+     * @brief 添加静态DAQ列表（按ODT容量自动分组）
+     * @param eventChannel 默认事件通道
+     * @param measurements 测量项列表
+     * @return DAQ列表号，-1表示失败
+     */
+    int addStaticDaqList(int eventChannel, const QVector<XcpMeasurement> &measurements);
+
+    // ========== 状态与统计 ==========
+
+    bool isSessionConnected() const { return m_sessionConnected; }
+    quint64 getCommandCount() const { return m_commandCount; }
+    quint64 getDtoCount() const { return m_dtoCount.load(); }
+    quint64 getOverloadCount() const { return m_overloadCount.load(); }
+
+    /**
+     * @brief 生成XCP从站状态报告
+     */
+    QString generateReport() const;
+
+signals:
+    /**
+     * @brief 主站建立/断开会话
+     * @param connected true=CONNECT, false=DISCONNECT
+     */
+    void sessionChanged(bool connected);
+
+    /**
+     * @brief 主站写入了变量
+     * @param address XCP地址
+     * @param size 写入字节数
+     */
+    void variableWritten(quint32 address, int size);
+
+private slots:
+    /**
+     * @brief CAN帧接收槽（过滤CRO）
+     */
+    void onFrameReceived(const QCanBusFrame &frame);
+
+private:
+    // ---------- 内部数据结构 ----------
+
+    struct Variable {
+        QString name;
+        quint32 address;
+        quint8 *ptr;
+        int size;
+        bool writable;
+    };
+
+    struct OdtEntry {
+        const quint8 *ptr;      // 解析后的变量指针（采样时直接memcpy）
+        quint32 address;
+        quint8 size;
+    };
+
+    struct Odt {
+        QVector<OdtEntry> entries;
+        int byteCount() const;
+    };
+
+    struct DaqList {
+        QVector<Odt> odts;
+        quint16 eventChannel;
+        quint8 prescaler;
+        quint8 prescalerCount;
+        quint8 mode;            // SET_DAQ_LIST_MODE的mode字节
+        quint8 firstPid;        // 第一个ODT的绝对编号
+        bool isStatic;
+        bool selected;
+        bool running;
+    };
+
+    struct EventChannel {
+        QString name;
+        int cycleMs;
+        qint64 nextDueNs;
+        bool pending;
+    };
+
+    // ---------- 命令处理 ----------
+
+    void processCommand(const QByteArray &cmd);
+    void sendResponse(const QByteArray &payload);
+    void sendPositive(const QByteArray &data = QByteArray());
+    void sendError(quint8 errorCode);
+
+    void handleConnect(const QByteArray &cmd);
+    void handleGetStatus();
+    void handleSetMta(const QByteArray &cmd);
+    void handleUpload(int size, quint32 address);
+    void handleDownload(const QByteArray &cmd);
+
+    void handleGetDaqProcessorInfo();
+    void handleGetDaqResolutionInfo();
+    void handleGetDaqEventInfo(const QByteArray &cmd);
+    void handleClearDaqList(const QByteArray &cmd);
+    void handleSetDaqPtr(const QByteArray &cmd);
+    void handleWriteDaq(const QByteArray &cmd);
+    void handleSetDaqListMode(const QByteArray &cmd);
+    void handleGetDaqListMode(const QByteArray &cmd);
+    void handleStartStopDaqList(const QByteArray &cmd);
+    void handleStartStopSynch(const QByteArray &cmd);
+    void handleGetDaqClock();
+    void handleFreeDaq();
+    void handleAllocDaq(const QByteArray &cmd);
+    void handleAllocOdt(const QByteArray &cmd);
+    void handleAllocOdtEntry(const QByteArray &cmd);
+
+    // ---------- 辅助 ----------
+
+    /**
+     * @brief 把XCP地址区间解析为变量指针
+     * @return 指针，不在已登记变量范围内返回nullptr
+     */
+    quint8* resolveAddress(quint32 address, int size, bool forWrite) const;
+
+    /**
+     * @brief 重新分配各DAQ列表的绝对ODT编号
+     */
+    void assignPids();
+
+    /**
+     * @brief 校验DAQ列表的ODT容量（含PID与时间戳）
+     */
+    bool validateDaqList(const DaqList &list) const;
+
+    void stopAllDaq();
+    bool anyDaqRunning() const;
+    quint32 timestampUs() const;
+
+    // ---------- 采样线程调用 ----------
+
+    /**
+     * @brief 处理到期事件并打包DTO
+     * @param nowNs 当前单调时间（纳秒）
+     * @return 距下一个周期事件的等待时间（毫秒）
+     */
+    unsigned long sampleDueEvents(qint64 nowNs);
+
+    /**
+     * @brief 对一个DAQ列表采样并追加DTO帧
+     */
+    void sampleDaqList(const DaqList &list, quint32 timestamp, QVector<QCanBusFrame> &out);
+
+    /**
+     * @brief 在驱动所在线程发送一批DTO
+     */
+    void transmitBatch(const QVector<QCanBusFrame> &frames);
+
+    static quint16 readWord(const QByteArray &cmd, int offset);
+    static quint32 readDword(const QByteArray &cmd, int offset);
+    static void appendWord(QByteArray &data, quint16 value);
+    static void appendDword(QByteArray &data, quint32 value);
+
+    // ---------- 成员 ----------
+
+    DriverCANHighPerf *m_can;           // CAN驱动
+    quint32 m_croId;                    // 命令帧ID
+    quint32 m_dtoId;                    // 响应/DAQ帧ID
+    bool m_extendedId;                  // 是否扩展帧ID
+    bool m_active;                      // 协议已启动
+    bool m_sessionConnected;            // 主站会话已建立
+
+    QVector<Variable> m_variables;      // 已登记变量（按地址排序）
+    quint32 m_mta;                      // 内存传输地址
+
+    QVector<EventChannel> m_events;     // 事件通道
+    QVector<DaqList> m_daqLists;        // DAQ列表（静态在前，动态在后）
+    int m_staticDaqCount;               // 静态DAQ列表数（MIN_DAQ）
+    int m_maxDynamicDaq;                // 动态DAQ列表上限
+    bool m_dynamicAllocated;            // 已执行ALLOC_DAQ
+    int m_daqPtrList;                   // SET_DAQ_PTR: DAQ列表
+    int m_daqPtrOdt;                    // SET_DAQ_PTR: ODT
+    int m_daqPtrEntry;                  // SET_DAQ_PTR: 条目
+    mutable QMutex m_daqMutex;          // DAQ配置互斥（命令线程与采样线程）
+    QWaitCondition m_eventWake;         // 采样线程唤醒
+    QAtomicInt m_samplingRunning;       // 采样线程运行标志
+
+    XcpDaqThread *m_daqThread;          // 采样线程
+    QElapsedTimer m_clock;              // DAQ时钟
+
+    quint64 m_commandCount;             // 已处理命令数
+    QAtomicInteger<quint64> m_dtoCount;         // 已发送DTO帧数
+    QAtomicInteger<quint64> m_overloadCount;    // 错过周期或发送积压丢弃的事件数
+    QAtomicInt m_pendingBatches;        // 待发送的DTO批次数
+};
+
+#endif // IMX6ULL_PROTOCOLS_XCP_ON_CAN_H
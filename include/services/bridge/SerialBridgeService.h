@@ -0,0 +1,90 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialBridgeService.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口TCP桥服务
+ *
+ * 功能说明:
+ *   按hardware.init中的[SerialBridge/...]配置节为每个串口创建一个
+ *   SerialTcpBridge，调试人员用nc/telnet或支持RFC 2217的工具远程
+ *   访问现场串口。转发在各桥自己的线程中完成，不经过主线程。
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_SERVICES_SERIAL_BRIDGE_H
+#define IMX6ULL_SERVICES_SERIAL_BRIDGE_H
+
+#include "core/ISysSvrInterface.h"
+#include "drivers/serial/SerialTcpBridge.h"
+#include <QList>
+#include <QVariantMap>
+
+/***************************************************************
+ * 类名: SerialBridgeService
+ * 功能: 串口TCP桥服务
+ *
+ * 使用示例:
+ *   SerialBridgeService *bridgeSvr = new SerialBridgeService(
+ *       SYS_SVR_ID_SERIAL_BRIDGE_SVR,
+ *       SYS_SVR_TYPE_SERIAL_BRIDGE_SVR
+ *   );
+ *
+ *   bridgeSvr->SvrInit();   // 按配置创建桥
+ *   bridgeSvr->SvrStart();  // 打开串口并开始监听
+ ***************************************************************/
+class SerialBridgeService : public ISysSvrInterface
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param svr_id 服务ID
+     * @param svr_type 服务类型
+     * @param parent 父对象指针
+     */
+    explicit SerialBridgeService(int32_t svr_id, int32_t svr_type, QObject *parent = nullptr);
+
+    virtual ~SerialBridgeService();
+
+    // ========== 实现ISysSvrInterface接口 ==========
+
+    virtual bool SvrInit() override;
+    virtual bool SvrStart() override;
+    virtual bool SvrStop() override;
+
+    virtual QString GetSvrName() const override {
+        return "SerialBridgeService";
+    }
+
+    // ========== 串口桥服务特有接口 ==========
+
+    /**
+     * @brief 获取所有桥
+     */
+    QList<SerialTcpBridge*> GetBridges() const { return m_bridges; }
+
+    /**
+     * @brief 所有桥的统计报告
+     */
+    QString GenerateReport() const;
+
+private:
+    /**
+     * @brief 按一个配置节创建桥
+     * @return 桥指针，参数错误返回nullptr
+     */
+    SerialTcpBridge* createBridge(const QVariantMap &config);
+
+private:
+    QList<SerialTcpBridge*> m_bridges;     // 桥（由服务释放）
+
+    bool m_IsInitialized;                  // 初始化标志
+    bool m_IsStarted;                      // 启动标志
+};
+
+#endif // IMX6ULL_SERVICES_SERIAL_BRIDGE_H
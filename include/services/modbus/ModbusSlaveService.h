@@ -16,6 +16,9 @@
  *
  * History:
  *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 启动时按hardware.init挂接CAN→Modbus寄存器桥接（CANModbusBridge）
+ *   3. 2026-10-18 停止时等待接收线程回调结束后再释放桥接
+ *   4. 2026-10-18 按hardware.init设置Modbus串口的RS-485方向控制
  ***************************************************************/
 
 #ifndef IMX6ULL_SERVICES_MODBUS_H
@@ -24,7 +27,11 @@
 #include "core/ISysSvrInterface.h"
 #include "protocols/modbus/ModbusSlave.h"
 #include "drivers/beep/DriverBeep.h"
+#include "protocols/modbus/CANModbusBridge.h"
 #include <QThread>
+#include <QList>
+
+class DriverCAN;
 
 /***************************************************************
  * 类名: ModbusSlaveService
@@ -158,12 +165,26 @@ private:
      * @brief 连接Modbus信号
      */
     void connectModbusSignals();
+    
+    /**
+     * @brief 按hardware.init中的[CANModbus/...]配置编译桥接并挂到CAN接收路径
+     */
+    void attachCanBridges();
+    
+    /**
+     * @brief 从CAN接收路径取下桥接并释放
+     * @note 返回时接收线程已不在桥接回调中，之后才能结束从站线程
+     */
+    void detachCanBridges();
 
 private:
     ProtocolModbusSlave *m_pModbusSlave;  // Modbus从站对象
     DriverBeep *m_pBeep;                  // Beep驱动对象
     QThread *m_pThread;                    // 独立线程对象
     
+    QList<CANModbusBridge*> m_canBridges;  // CAN→Modbus桥接（每条CAN总线一个）
+    QList<DriverCAN*> m_bridgeCans;        // 桥接挂接的CAN驱动（与m_canBridges一一对应）
+    
     QString m_portName;                    // 串口名称
     quint8 m_slaveAddress;                 // 从站地址
     
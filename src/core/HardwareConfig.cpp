@@ -179,6 +179,9 @@ HardwareDeviceConfig HardwareConfig::parseDeviceConfig(const QString &section, Q
         case HardwareType::CAN:
             config.params["device"] = settings->value("device", "").toString();
             config.params["bitrate"] = settings->value("bitrate", 500000).toInt();
+            config.params["receive_thread"] = settings->value("receive_thread", false).toBool();
+            config.params["payload_filter"] = settings->value("payload_filter", "").toString();
+            config.params["pass_error_frames"] = settings->value("pass_error_frames", true).toBool();
             break;
             
         case HardwareType::I2C:
@@ -202,6 +205,14 @@ HardwareDeviceConfig HardwareConfig::parseDeviceConfig(const QString &section, Q
             config.params["high_threshold"] = settings->value("high_threshold", 85.0).toDouble();
             break;
             
+        case HardwareType::CANModbus:
+            // 映射参数较多且大多可选，全部原样保留（键名见CANModbusBridge.h）
+            for (const QString &key : settings->childKeys())
+            {
+                config.params[key] = settings->value(key);
+            }
+            break;
+            
         default:
             break;
     }
@@ -223,7 +234,8 @@ HardwareType HardwareConfig::stringToHardwareType(const QString &typeStr) const
         {"I2C", HardwareType::I2C},
         {"SPI", HardwareType::SPI},
         {"Beep", HardwareType::Beep},
-        {"Temperature", HardwareType::Temperature}
+        {"Temperature", HardwareType::Temperature},
+        {"CANModbus", HardwareType::CANModbus}
     };
     
     return typeMap.value(typeStr, HardwareType::Unknown);
@@ -243,7 +255,8 @@ QString HardwareConfig::hardwareTypeToString(HardwareType type) const
         {HardwareType::I2C, "I2C"},
         {HardwareType::SPI, "SPI"},
         {HardwareType::Beep, "Beep"},
-        {HardwareType::Temperature, "Temperature"}
+        {HardwareType::Temperature, "Temperature"},
+        {HardwareType::CANModbus, "CANModbus"}
     };
     
     return typeMap.value(type, "Unknown");
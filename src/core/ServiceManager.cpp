@@ -8,6 +8,7 @@
  *
  * History:
  *   1. 2025-10-15 创建文件，实现服务管理功能
+ *   2. 2026-10-18 增加串口TCP桥服务
  ***************************************************************/
 
 #include "core/ServiceManager.h"
@@ -24,6 +25,7 @@
 #include "services/time/TimeService.h"
 #include "services/weather/WeatherService.h"
 #include "services/alarm/AlarmService.h"
+#include "services/bridge/SerialBridgeService.h"
 #include "drivers/serial/DriverSerial.h"
 #include <QDebug>
 
@@ -377,6 +379,20 @@ bool ServiceManager::SvrCreateInit()
     pAlarmSvr->setSleepReminderEnabled(true);  // 启用睡眠提示
     qInfo() << "  ✓ 闹钟服务创建成功（起床闹钟6:00 + 睡眠提示22:00）";
     
+    // ========== 创建串口TCP桥服务 ==========
+    qInfo() << "  创建串口TCP桥服务...";
+    SerialBridgeService *pBridgeSvr = new SerialBridgeService(
+        SYS_SVR_ID_SERIAL_BRIDGE_SVR,
+        SYS_SVR_TYPE_SERIAL_BRIDGE_SVR
+    );
+    if (!RegisterSvrObj(pBridgeSvr))
+    {
+        qCritical() << "  ✗ 串口TCP桥服务注册失败";
+        delete pBridgeSvr;
+        return false;
+    }
+    qInfo() << "  ✓ 串口TCP桥服务创建成功（按[SerialBridge/...]配置）";
+    
     // ========== 后续可以添加更多服务 ==========
     // 其他服务（GPIO、LED、PWM等）可以根据需要创建适配器类
     // 目前这些驱动可以在应用层直接使用
@@ -724,6 +740,20 @@ AlarmService* ServiceManager::GetAlarmSvrObj()
     return nullptr;
 }
 
+SerialBridgeService* ServiceManager::GetSerialBridgeSvrObj()
+{
+    ISysSvrInterface* svr = GetSvrObj(SYS_SVR_ID_SERIAL_BRIDGE_SVR);
+    if (svr)
+    {
+        SerialBridgeService* bridgeSvr = dynamic_cast<SerialBridgeService*>(svr);
+        if (bridgeSvr)
+        {
+            return bridgeSvr;
+        }
+    }
+    return nullptr;
+}
+
 int ServiceManager::GetServiceCount() const
 {
     return m_SysSvrList.size();
@@ -0,0 +1,322 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANBroadcastRing.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN接收帧多消费者广播环形缓冲区实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/can/CANBroadcastRing.h"
+#include <QTextStream>
+#include <QDebug>
+#include <cstring>
+
+// ========================================
+// CANRingEntry 实现
+// ========================================
+
+/**
+ * @brief 从QCanBusFrame填充槽位
+ */
+void CANRingEntry::assign(const QCanBusFrame &frame)
+{
+    const QByteArray data = frame.payload();
+    const QCanBusFrame::TimeStamp stamp = frame.timeStamp();
+
+    timestampUs = stamp.seconds() * 1000000LL + stamp.microSeconds();
+    frameId = frame.frameId();
+    frameType = static_cast<quint8>(frame.frameType());
+    flags = 0;
+    if (frame.hasExtendedFrameFormat()) {
+        flags |= ExtendedFormat;
+    }
+    if (frame.hasFlexibleDataRateFormat()) {
+        flags |= FlexibleDataRate;
+    }
+    if (frame.hasBitrateSwitch()) {
+        flags |= BitrateSwitch;
+    }
+
+    length = static_cast<quint8>(qMin(data.size(), static_cast<int>(sizeof(payload))));
+    memcpy(payload, data.constData(), length);
+}
+
+/**
+ * @brief 转换回QCanBusFrame
+ */
+QCanBusFrame CANRingEntry::toFrame() const
+{
+    QCanBusFrame frame(static_cast<QCanBusFrame::FrameType>(frameType));
+    frame.setFrameId(frameId);
+    frame.setExtendedFrameFormat(isExtended());
+    frame.setFlexibleDataRateFormat((flags & FlexibleDataRate) != 0);
+    frame.setBitrateSwitch((flags & BitrateSwitch) != 0);
+    frame.setPayload(QByteArray(reinterpret_cast<const char *>(payload), length));
+    frame.setTimeStamp(QCanBusFrame::TimeStamp(timestampUs / 1000000, timestampUs % 1000000));
+    return frame;
+}
+
+// ========================================
+// CANBroadcastRing 实现
+// ========================================
+
+/**
+ * @brief 构造函数
+ */
+CANBroadcastRing::CANBroadcastRing(int capacity)
+    : m_slots(nullptr)
+    , m_mask(0)
+    , m_cachedGate(0)
+    , m_cachedEpoch(0)
+{
+    // 容量向上取整为2的幂，序号取模用位与
+    int size = 16;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    m_entries.resize(size);
+    m_slots = m_entries.data();
+    m_mask = static_cast<quint64>(size - 1);
+
+    m_published.store(0);
+    m_overruns.store(0);
+    m_slowestConsumer.store(-1);
+    m_consumerEpoch.store(0);
+    m_waiters.store(0);
+
+    for (int i = 0; i < MaxConsumers; ++i) {
+        m_consumers[i].cursor.store(0);
+        m_consumers[i].active.store(0);
+    }
+
+    qInfo() << "[CANBroadcastRing] 创建广播环，槽位数:" << size;
+}
+
+/**
+ * @brief 析构函数
+ */
+CANBroadcastRing::~CANBroadcastRing()
+{
+    wakeAll();
+}
+
+// ========== 消费者管理 ==========
+
+/**
+ * @brief 注册消费者
+ */
+int CANBroadcastRing::registerConsumer(const QString &name)
+{
+    QMutexLocker locker(&m_registerMutex);
+
+    for (int i = 0; i < MaxConsumers; ++i) {
+        if (m_consumers[i].active.loadAcquire() == 0) {
+            m_consumers[i].cursor.storeRelease(m_published.loadAcquire());
+            m_consumers[i].active.storeRelease(1);
+            m_consumerNames[i] = name;
+
+            // 通知生产者重新计算门限
+            m_consumerEpoch.ref();
+
+            qInfo() << "[CANBroadcastRing] 注册消费者:" << name << "ID:" << i;
+            return i;
+        }
+    }
+
+    qWarning() << "[CANBroadcastRing] 消费者数量已达上限:" << MaxConsumers;
+    return -1;
+}
+
+/**
+ * @brief 注销消费者
+ */
+void CANBroadcastRing::unregisterConsumer(int consumerId)
+{
+    if (consumerId < 0 || consumerId >= MaxConsumers) {
+        return;
+    }
+
+    QMutexLocker locker(&m_registerMutex);
+
+    if (m_consumers[consumerId].active.loadAcquire() != 0) {
+        m_consumers[consumerId].active.storeRelease(0);
+        m_consumerEpoch.ref();
+        qInfo() << "[CANBroadcastRing] 注销消费者:" << m_consumerNames[consumerId];
+        m_consumerNames[consumerId].clear();
+    }
+}
+
+// ========== 生产者 ==========
+
+/**
+ * @brief 重新计算最慢消费者游标
+ */
+quint64 CANBroadcastRing::computeGatingSequence(quint64 sequence)
+{
+    quint64 gate = sequence;
+    int slowest = -1;
+
+    for (int i = 0; i < MaxConsumers; ++i) {
+        if (m_consumers[i].active.loadAcquire() == 0) {
+            continue;
+        }
+        quint64 cursor = m_consumers[i].cursor.loadAcquire();
+        if (cursor < gate) {
+            gate = cursor;
+            slowest = i;
+        }
+    }
+
+    if (slowest >= 0 && sequence - gate >= static_cast<quint64>(capacity())) {
+        m_slowestConsumer.storeRelease(slowest);
+    }
+
+    return gate;
+}
+
+/**
+ * @brief 发布一帧
+ */
+bool CANBroadcastRing::publish(const QCanBusFrame &frame)
+{
+    const quint64 sequence = m_published.load();
+    const quint64 size = m_mask + 1;
+
+    // 消费者集合变化或接近套圈时才扫描游标，其余情况O(1)
+    int epoch = m_consumerEpoch.loadAcquire();
+    if (epoch != m_cachedEpoch || sequence - m_cachedGate >= size) {
+        m_cachedEpoch = epoch;
+        m_cachedGate = computeGatingSequence(sequence);
+
+        if (sequence - m_cachedGate >= size) {
+            quint64 overruns = m_overruns.fetchAndAddRelaxed(1) + 1;
+            if (overruns % 100 == 1) {
+                int slowest = m_slowestConsumer.loadAcquire();
+                qWarning() << "[CANBroadcastRing] 环已满，丢弃新帧，累计:" << overruns
+                           << "最慢消费者:" << getConsumerName(slowest);
+            }
+            return false;
+        }
+    }
+
+    CANRingEntry &entry = m_slots[sequence & m_mask];
+    entry.assign(frame);
+    entry.sequence = sequence;
+
+    // 全屏障发布，与waitForData中的等待者计数配合避免丢失唤醒
+    m_published.fetchAndAddOrdered(1);
+
+    if (m_waiters.loadAcquire() > 0) {
+        QMutexLocker locker(&m_waitMutex);
+        m_dataReady.wakeAll();
+    }
+
+    return true;
+}
+
+// ========== 消费者 ==========
+
+/**
+ * @brief 等待新数据
+ */
+bool CANBroadcastRing::waitForData(int consumerId, unsigned long msecs)
+{
+    if (consumerId < 0 || consumerId >= MaxConsumers) {
+        return false;
+    }
+
+    const quint64 cursor = m_consumers[consumerId].cursor.loadAcquire();
+    if (m_published.loadAcquire() > cursor) {
+        return true;
+    }
+
+    QMutexLocker locker(&m_waitMutex);
+    m_waiters.ref();
+
+    if (m_published.loadAcquire() <= cursor) {
+        m_dataReady.wait(&m_waitMutex, msecs);
+    }
+
+    m_waiters.deref();
+    return m_published.loadAcquire() > cursor;
+}
+
+/**
+ * @brief 唤醒所有等待中的消费者
+ */
+void CANBroadcastRing::wakeAll()
+{
+    QMutexLocker locker(&m_waitMutex);
+    m_dataReady.wakeAll();
+}
+
+// ========== 统计 ==========
+
+/**
+ * @brief 消费者落后的帧数
+ */
+quint64 CANBroadcastRing::getLag(int consumerId) const
+{
+    if (consumerId < 0 || consumerId >= MaxConsumers ||
+        m_consumers[consumerId].active.loadAcquire() == 0) {
+        return 0;
+    }
+
+    quint64 published = m_published.loadAcquire();
+    quint64 cursor = m_consumers[consumerId].cursor.loadAcquire();
+    return published > cursor ? published - cursor : 0;
+}
+
+/**
+ * @brief 获取消费者名称
+ */
+QString CANBroadcastRing::getConsumerName(int consumerId) const
+{
+    if (consumerId < 0 || consumerId >= MaxConsumers) {
+        return QString("-");
+    }
+
+    QMutexLocker locker(&m_registerMutex);
+    return m_consumerNames[consumerId];
+}
+
+/**
+ * @brief 生成广播环状态报告
+ */
+QString CANBroadcastRing::generateReport() const
+{
+    QString report;
+    QTextStream out(&report);
+
+    out << "========================================\n";
+    out << "  CAN Broadcast Ring Report\n";
+    out << "========================================\n";
+    out << "Capacity: " << capacity()
+        << "  Published: " << getPublishedCount()
+        << "  Overruns: " << getOverrunCount() << "\n";
+
+    int slowest = getSlowestConsumer();
+    if (slowest >= 0) {
+        out << "Slowest consumer at last overrun: " << getConsumerName(slowest) << "\n";
+    }
+    out << "----------------------------------------\n";
+
+    for (int i = 0; i < MaxConsumers; ++i) {
+        if (m_consumers[i].active.loadAcquire() == 0) {
+            continue;
+        }
+        quint64 lag = getLag(i);
+        out << "  • [" << i << "] " << getConsumerName(i) << "\n";
+        out << "    lag: " << lag << " frames ("
+            << QString::number(100.0 * lag / capacity(), 'f', 1) << "% of ring)\n";
+    }
+
+    out << "========================================\n";
+
+    return report;
+}
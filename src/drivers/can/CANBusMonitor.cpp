@@ -0,0 +1,716 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANBusMonitor.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN控制器错误状态与错误计数器监测实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/can/CANBusMonitor.h"
+#include <QTextStream>
+#include <QDateTime>
+#include <QDebug>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <net/if.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#include <linux/can/error.h>
+#include <linux/can/netlink.h>
+
+// ========================================
+// rtnetlink辅助函数
+// ========================================
+
+namespace {
+
+const int NETLINK_BUFFER_SIZE = 16384;
+
+struct LinkRequest {
+    struct nlmsghdr header;
+    struct ifinfomsg info;
+    char attrs[256];
+};
+
+/**
+ * @brief 在消息尾部追加属性
+ * @return 属性指针，空间不足返回nullptr
+ */
+struct rtattr* addAttribute(struct nlmsghdr *msg, int maxLen, int type,
+                            const void *data, int len)
+{
+    int attrLen = RTA_LENGTH(len);
+    if (static_cast<int>(NLMSG_ALIGN(msg->nlmsg_len) + RTA_ALIGN(attrLen)) > maxLen) {
+        return nullptr;
+    }
+
+    struct rtattr *rta = reinterpret_cast<struct rtattr*>(
+        reinterpret_cast<char*>(msg) + NLMSG_ALIGN(msg->nlmsg_len));
+    rta->rta_type = type;
+    rta->rta_len = attrLen;
+    if (len > 0) {
+        memcpy(RTA_DATA(rta), data, len);
+    }
+    msg->nlmsg_len = NLMSG_ALIGN(msg->nlmsg_len) + RTA_ALIGN(attrLen);
+    return rta;
+}
+
+/**
+ * @brief 结束嵌套属性（回填长度）
+ */
+void endNested(struct nlmsghdr *msg, struct rtattr *nest)
+{
+    nest->rta_len = static_cast<unsigned short>(
+        reinterpret_cast<char*>(msg) + NLMSG_ALIGN(msg->nlmsg_len) -
+        reinterpret_cast<char*>(nest));
+}
+
+/**
+ * @brief 发送一条rtnetlink请求并接收一个应答数据报
+ * @return 应答长度，失败返回-errno
+ */
+int netlinkTransact(struct nlmsghdr *request, char *reply, int replySize)
+{
+    int fd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    struct timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_nl local;
+    memset(&local, 0, sizeof(local));
+    local.nl_family = AF_NETLINK;
+    if (::bind(fd, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) < 0) {
+        int err = errno;
+        ::close(fd);
+        return -err;
+    }
+
+    struct sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+
+    if (::sendto(fd, request, request->nlmsg_len, 0,
+                 reinterpret_cast<struct sockaddr*>(&kernel), sizeof(kernel)) < 0) {
+        int err = errno;
+        ::close(fd);
+        return -err;
+    }
+
+    int len = static_cast<int>(::recv(fd, reply, replySize, 0));
+    int err = errno;
+    ::close(fd);
+
+    return len < 0 ? -err : len;
+}
+
+/**
+ * @brief 解析IFLA_INFO_DATA中的CAN属性
+ */
+void parseCanInfoData(struct rtattr *data, int len, CANControllerStatus &status)
+{
+    for (struct rtattr *rta = data; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        switch (rta->rta_type) {
+            case IFLA_CAN_STATE:
+                status.state = static_cast<int>(*reinterpret_cast<quint32*>(RTA_DATA(rta)));
+                break;
+            case IFLA_CAN_BERR_COUNTER: {
+                struct can_berr_counter counter;
+                memcpy(&counter, RTA_DATA(rta), sizeof(counter));
+                status.txErrorCount = counter.txerr;
+                status.rxErrorCount = counter.rxerr;
+                break;
+            }
+            case IFLA_CAN_BITTIMING: {
+                struct can_bittiming timing;
+                memcpy(&timing, RTA_DATA(rta), sizeof(timing));
+                status.bitrate = timing.bitrate;
+                break;
+            }
+            case IFLA_CAN_RESTART_MS:
+                status.restartMs = *reinterpret_cast<quint32*>(RTA_DATA(rta));
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief 解析IFLA_LINKINFO嵌套属性
+ */
+void parseLinkInfo(struct rtattr *info, int len, CANControllerStatus &status)
+{
+    for (struct rtattr *rta = info; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFLA_INFO_DATA) {
+            parseCanInfoData(reinterpret_cast<struct rtattr*>(RTA_DATA(rta)),
+                             RTA_PAYLOAD(rta), status);
+        } else if (rta->rta_type == IFLA_INFO_XSTATS &&
+                   RTA_PAYLOAD(rta) >= sizeof(struct can_device_stats)) {
+            struct can_device_stats stats;
+            memcpy(&stats, RTA_DATA(rta), sizeof(stats));
+            status.busErrors = stats.bus_error;
+            status.errorWarning = stats.error_warning;
+            status.errorPassive = stats.error_passive;
+            status.busOff = stats.bus_off;
+            status.arbitrationLost = stats.arbitration_lost;
+            status.restarts = stats.restarts;
+        }
+    }
+}
+
+qint64 currentTimeUs()
+{
+    return QDateTime::currentMSecsSinceEpoch() * 1000;
+}
+
+} // namespace
+
+// ========================================
+// CANBusMonitor 实现
+// ========================================
+
+/**
+ * @brief 构造函数
+ */
+CANBusMonitor::CANBusMonitor(const QString &interfaceName, QObject *parent)
+    : QObject(parent)
+    , m_interfaceName(interfaceName)
+    , m_state(ErrorActive)
+    , m_txErrorCount(0)
+    , m_rxErrorCount(0)
+    , m_autoRestart(true)
+    , m_initialBackoffMs(100)   // 首次100ms后重启
+    , m_maxBackoffMs(5000)      // 最长5秒
+    , m_currentBackoffMs(100)
+    , m_stableWindowMs(10000)   // 重启后10秒无总线关闭视为恢复
+    , m_busOffCount(0)
+    , m_protocolErrors(0)
+    , m_ackErrors(0)
+    , m_arbitrationLost(0)
+    , m_overflows(0)
+    , m_txTimeouts(0)
+    , m_restartCount(0)
+{
+    qRegisterMetaType<CANBusHealthEvent>("CANBusHealthEvent");
+
+    m_restartTimer = new QTimer(this);
+    m_restartTimer->setSingleShot(true);
+    connect(m_restartTimer, &QTimer::timeout, this, &CANBusMonitor::onRestartTimer);
+
+    qInfo() << "[CANBusMonitor] 创建总线健康监测:" << m_interfaceName;
+}
+
+/**
+ * @brief 析构函数
+ */
+CANBusMonitor::~CANBusMonitor()
+{
+    m_restartTimer->stop();
+}
+
+// ========== 控制器状态 ==========
+
+/**
+ * @brief 通过rtnetlink读取控制器状态与计数
+ */
+bool CANBusMonitor::readControllerStatus(CANControllerStatus &status)
+{
+    unsigned int ifindex = if_nametoindex(m_interfaceName.toLocal8Bit().constData());
+    if (ifindex == 0) {
+        qWarning() << "[CANBusMonitor] 接口不存在:" << m_interfaceName;
+        return false;
+    }
+
+    LinkRequest request;
+    memset(&request, 0, sizeof(request));
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    request.header.nlmsg_type = RTM_GETLINK;
+    request.header.nlmsg_flags = NLM_F_REQUEST;
+    request.header.nlmsg_seq = 1;
+    request.info.ifi_family = AF_UNSPEC;
+    request.info.ifi_index = static_cast<int>(ifindex);
+
+    QByteArray buffer(NETLINK_BUFFER_SIZE, 0);
+    int len = netlinkTransact(&request.header, buffer.data(), buffer.size());
+    if (len < 0) {
+        qWarning() << "[CANBusMonitor] rtnetlink查询失败:" << strerror(-len);
+        return false;
+    }
+
+    status = CANControllerStatus();
+    bool found = false;
+
+    for (struct nlmsghdr *msg = reinterpret_cast<struct nlmsghdr*>(buffer.data());
+         NLMSG_OK(msg, static_cast<unsigned int>(len)); msg = NLMSG_NEXT(msg, len)) {
+        if (msg->nlmsg_type == NLMSG_ERROR) {
+            struct nlmsgerr *err = reinterpret_cast<struct nlmsgerr*>(NLMSG_DATA(msg));
+            qWarning() << "[CANBusMonitor] rtnetlink返回错误:" << strerror(-err->error);
+            return false;
+        }
+        if (msg->nlmsg_type != RTM_NEWLINK) {
+            continue;
+        }
+
+        struct ifinfomsg *info = reinterpret_cast<struct ifinfomsg*>(NLMSG_DATA(msg));
+        int attrLen = IFLA_PAYLOAD(msg);
+        for (struct rtattr *rta = IFLA_RTA(info); RTA_OK(rta, attrLen);
+             rta = RTA_NEXT(rta, attrLen)) {
+            if (rta->rta_type == IFLA_LINKINFO) {
+                parseLinkInfo(reinterpret_cast<struct rtattr*>(RTA_DATA(rta)),
+                              RTA_PAYLOAD(rta), status);
+                found = true;
+            }
+        }
+    }
+
+    if (!found) {
+        qWarning() << "[CANBusMonitor] 未读取到CAN链路信息:" << m_interfaceName;
+        return false;
+    }
+
+    m_txErrorCount = status.txErrorCount;
+    m_rxErrorCount = status.rxErrorCount;
+    return true;
+}
+
+/**
+ * @brief 通过rtnetlink重启控制器
+ *
+ * 等价于 ip link set canX type can restart，
+ * 控制器不在总线关闭状态时内核返回EBUSY
+ */
+bool CANBusMonitor::restartController()
+{
+    unsigned int ifindex = if_nametoindex(m_interfaceName.toLocal8Bit().constData());
+    if (ifindex == 0) {
+        qWarning() << "[CANBusMonitor] 接口不存在:" << m_interfaceName;
+        return false;
+    }
+
+    LinkRequest request;
+    memset(&request, 0, sizeof(request));
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    request.header.nlmsg_type = RTM_NEWLINK;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    request.header.nlmsg_seq = 2;
+    request.info.ifi_family = AF_UNSPEC;
+    request.info.ifi_index = static_cast<int>(ifindex);
+
+    const int maxLen = sizeof(request);
+    const char kind[] = "can";
+    quint32 restart = 1;
+
+    struct rtattr *linkInfo = addAttribute(&request.header, maxLen, IFLA_LINKINFO, nullptr, 0);
+    addAttribute(&request.header, maxLen, IFLA_INFO_KIND, kind, sizeof(kind) - 1);
+    struct rtattr *infoData = addAttribute(&request.header, maxLen, IFLA_INFO_DATA, nullptr, 0);
+    addAttribute(&request.header, maxLen, IFLA_CAN_RESTART, &restart, sizeof(restart));
+    endNested(&request.header, infoData);
+    endNested(&request.header, linkInfo);
+
+    char reply[1024];
+    int len = netlinkTransact(&request.header, reply, sizeof(reply));
+    if (len < 0) {
+        qWarning() << "[CANBusMonitor] 重启请求发送失败:" << strerror(-len);
+        return false;
+    }
+
+    struct nlmsghdr *msg = reinterpret_cast<struct nlmsghdr*>(reply);
+    if (NLMSG_OK(msg, static_cast<unsigned int>(len)) && msg->nlmsg_type == NLMSG_ERROR) {
+        struct nlmsgerr *err = reinterpret_cast<struct nlmsgerr*>(NLMSG_DATA(msg));
+        if (err->error != 0) {
+            qWarning() << "[CANBusMonitor] 控制器重启失败:" << strerror(-err->error);
+            return false;
+        }
+    }
+
+    qInfo() << "[CANBusMonitor] 控制器已重启:" << m_interfaceName;
+    return true;
+}
+
+// ========== 错误帧处理 ==========
+
+/**
+ * @brief 处理CAN错误帧
+ *
+ * 错误帧ID携带错误类别（CAN_ERR_*），数据区按linux/can/error.h定义：
+ *   data[1] 控制器状态  data[2] 协议错误类型  data[3] 协议错误位置
+ *   data[4] 收发器状态  data[6] TEC          data[7] REC
+ */
+void CANBusMonitor::processErrorFrame(const QCanBusFrame &frame)
+{
+    if (frame.frameType() != QCanBusFrame::ErrorFrame) {
+        return;
+    }
+
+    const quint32 errorClass = static_cast<quint32>(frame.error());
+    const QByteArray payload = frame.payload();
+    quint8 data[CAN_ERR_DLC];
+    memset(data, 0, sizeof(data));
+    memcpy(data, payload.constData(), qMin(payload.size(), static_cast<int>(CAN_ERR_DLC)));
+
+    if (errorClass & CAN_ERR_CNT) {
+        m_txErrorCount = data[6];
+        m_rxErrorCount = data[7];
+    }
+
+    CANBusHealthEvent base;
+    base.state = m_state;
+    base.previousState = m_state;
+    base.txErrorCount = m_txErrorCount;
+    base.rxErrorCount = m_rxErrorCount;
+    base.errorClass = errorClass;
+    const QCanBusFrame::TimeStamp stamp = frame.timeStamp();
+    base.timestampUs = stamp.seconds() * 1000000LL + stamp.microSeconds();
+    if (base.timestampUs <= 0) {
+        base.timestampUs = currentTimeUs();
+    }
+
+    // ---------- 非状态类错误（计数，限频发布） ----------
+
+    if (errorClass & CAN_ERR_PROT) {
+        m_protocolErrors++;
+        if (m_protocolErrors % 100 == 1) {
+            publish(CANBusHealthEvent::ProtocolError, base,
+                    QString("协议错误 type=0x%1 location=0x%2 (累计%3次)")
+                    .arg(data[2], 2, 16, QChar('0')).arg(data[3], 2, 16, QChar('0'))
+                    .arg(m_protocolErrors));
+        }
+    }
+
+    if (errorClass & CAN_ERR_ACK) {
+        m_ackErrors++;
+        if (m_ackErrors % 100 == 1) {
+            publish(CANBusHealthEvent::AckMissing, base,
+                    QString("发送无应答，总线上可能没有其他节点 (累计%1次)").arg(m_ackErrors));
+        }
+    }
+
+    if (errorClass & CAN_ERR_LOSTARB) {
+        m_arbitrationLost++;
+        if (m_arbitrationLost % 100 == 1) {
+            publish(CANBusHealthEvent::ArbitrationLost, base,
+                    QString("仲裁丢失 bit=%1 (累计%2次)").arg(data[0]).arg(m_arbitrationLost));
+        }
+    }
+
+    if (errorClass & CAN_ERR_TX_TIMEOUT) {
+        m_txTimeouts++;
+        publish(CANBusHealthEvent::TxTimeout, base, "发送超时");
+    }
+
+    if (errorClass & CAN_ERR_TRX) {
+        publish(CANBusHealthEvent::TransceiverError, base,
+                QString("收发器错误 status=0x%1").arg(data[4], 2, 16, QChar('0')));
+    }
+
+    if ((errorClass & CAN_ERR_CRTL) &&
+        (data[1] & (CAN_ERR_CRTL_RX_OVERFLOW | CAN_ERR_CRTL_TX_OVERFLOW))) {
+        m_overflows++;
+        publish(CANBusHealthEvent::ControllerOverflow, base,
+                (data[1] & CAN_ERR_CRTL_RX_OVERFLOW) ? "控制器接收缓冲溢出" : "控制器发送缓冲溢出");
+    }
+
+    // ---------- 状态类错误 ----------
+
+    if (errorClass & CAN_ERR_BUSOFF) {
+        updateState(BusOffState, base);
+        return;
+    }
+
+    if (errorClass & CAN_ERR_RESTARTED) {
+        m_restartTimer->stop();
+        publish(CANBusHealthEvent::Restarted, base, "控制器已从总线关闭恢复");
+        updateState(ErrorActive, base);
+        return;
+    }
+
+    if ((errorClass & CAN_ERR_CRTL) && data[1] != CAN_ERR_CRTL_UNSPEC) {
+        if (data[1] & (CAN_ERR_CRTL_RX_PASSIVE | CAN_ERR_CRTL_TX_PASSIVE)) {
+            updateState(ErrorPassive, base);
+            return;
+        }
+        if (data[1] & (CAN_ERR_CRTL_RX_WARNING | CAN_ERR_CRTL_TX_WARNING)) {
+            updateState(ErrorWarning, base);
+            return;
+        }
+        if (data[1] & CAN_ERR_CRTL_ACTIVE) {
+            updateState(ErrorActive, base);
+            return;
+        }
+    }
+
+    // 仅携带计数时由TEC/REC推导状态（总线关闭只能由重启退出）
+    if ((errorClass & CAN_ERR_CNT) && m_state != BusOffState) {
+        updateState(stateFromCounters(m_txErrorCount, m_rxErrorCount), base);
+    }
+}
+
+/**
+ * @brief 由TEC/REC推导错误状态
+ */
+CANBusMonitor::BusState CANBusMonitor::stateFromCounters(quint16 tec, quint16 rec)
+{
+    quint16 worst = qMax(tec, rec);
+    if (tec >= 256) {
+        return BusOffState;
+    }
+    if (worst >= 128) {
+        return ErrorPassive;
+    }
+    if (worst >= 96) {
+        return ErrorWarning;
+    }
+    return ErrorActive;
+}
+
+/**
+ * @brief 切换状态并发布事件
+ */
+void CANBusMonitor::updateState(BusState newState, const CANBusHealthEvent &base)
+{
+    if (newState == m_state) {
+        return;
+    }
+
+    BusState previous = m_state;
+    m_state = newState;
+
+    CANBusHealthEvent event = base;
+    event.previousState = previous;
+    event.state = newState;
+
+    QString detail = QString("%1 -> %2 (TEC=%3 REC=%4)")
+                     .arg(stateToString(previous)).arg(stateToString(newState))
+                     .arg(m_txErrorCount).arg(m_rxErrorCount);
+
+    if (newState > previous) {
+        qWarning() << "[CANBusMonitor]" << m_interfaceName << "状态变化:" << detail;
+    } else {
+        qInfo() << "[CANBusMonitor]" << m_interfaceName << "状态变化:" << detail;
+    }
+
+    publish(CANBusHealthEvent::StateChanged, event, detail);
+    emit busStateChanged(newState, previous);
+
+    if (newState == BusOffState) {
+        m_busOffCount++;
+        publish(CANBusHealthEvent::BusOff, event,
+                QString("总线关闭 (累计%1次)").arg(m_busOffCount));
+        scheduleRestart();
+    } else if (previous == BusOffState) {
+        m_restartTimer->stop();
+    }
+}
+
+/**
+ * @brief 发布事件
+ */
+void CANBusMonitor::publish(CANBusHealthEvent::Type type, const CANBusHealthEvent &base,
+                            const QString &detail)
+{
+    CANBusHealthEvent event = base;
+    event.type = type;
+    event.state = m_state;
+    event.detail = detail;
+    if (event.timestampUs <= 0) {
+        event.timestampUs = currentTimeUs();
+    }
+
+    qDebug() << "[CANBusMonitor]" << eventTypeToString(type) << detail;
+    emit busHealthEvent(event);
+}
+
+// ========== 自动重启 ==========
+
+/**
+ * @brief 启用/禁用总线关闭后自动重启
+ */
+void CANBusMonitor::setAutoRestart(bool enable)
+{
+    m_autoRestart = enable;
+    if (!enable) {
+        m_restartTimer->stop();
+    }
+}
+
+/**
+ * @brief 设置自动重启退避参数
+ */
+void CANBusMonitor::setRestartBackoff(int initialMs, int maxMs)
+{
+    m_initialBackoffMs = qMax(1, initialMs);
+    m_maxBackoffMs = qMax(m_initialBackoffMs, maxMs);
+    m_currentBackoffMs = m_initialBackoffMs;
+}
+
+/**
+ * @brief 安排下一次自动重启
+ */
+void CANBusMonitor::scheduleRestart()
+{
+    if (!m_autoRestart || m_restartTimer->isActive()) {
+        return;
+    }
+
+    // 内核已配置restart-ms时由内核负责重启
+    CANControllerStatus status;
+    if (readControllerStatus(status) && status.restartMs > 0) {
+        qInfo() << "[CANBusMonitor] 内核已配置restart-ms =" << status.restartMs
+                << "，由内核自动重启";
+        return;
+    }
+
+    // 上次重启后稳定运行足够久，退避复位
+    if (m_sinceRestart.isValid() && m_sinceRestart.elapsed() >= m_stableWindowMs) {
+        m_currentBackoffMs = m_initialBackoffMs;
+    }
+
+    m_restartTimer->start(m_currentBackoffMs);
+
+    CANBusHealthEvent event;
+    event.previousState = m_state;
+    event.txErrorCount = m_txErrorCount;
+    event.rxErrorCount = m_rxErrorCount;
+    publish(CANBusHealthEvent::RestartScheduled, event,
+            QString("%1ms后自动重启控制器").arg(m_currentBackoffMs));
+}
+
+/**
+ * @brief 重启定时器到期
+ */
+void CANBusMonitor::onRestartTimer()
+{
+    if (m_state != BusOffState) {
+        return;
+    }
+
+    bool ok = restartController();
+
+    // 无论成功与否，短时间内再次总线关闭都要等待更久
+    int usedBackoff = m_currentBackoffMs;
+    m_currentBackoffMs = qMin(m_currentBackoffMs * 2, m_maxBackoffMs);
+
+    CANBusHealthEvent event;
+    event.previousState = m_state;
+    event.txErrorCount = m_txErrorCount;
+    event.rxErrorCount = m_rxErrorCount;
+
+    if (!ok) {
+        publish(CANBusHealthEvent::RestartFailed, event,
+                QString("控制器重启失败（退避%1ms）").arg(usedBackoff));
+        scheduleRestart();
+        return;
+    }
+
+    m_restartCount++;
+    m_sinceRestart.start();
+
+    // 未订阅CAN_ERR_RESTARTED时，以控制器实际状态为准
+    CANControllerStatus status;
+    if (readControllerStatus(status) && status.state != BusOffState) {
+        event.txErrorCount = status.txErrorCount;
+        event.rxErrorCount = status.rxErrorCount;
+        publish(CANBusHealthEvent::Restarted, event, "控制器已自动重启");
+        updateState(static_cast<BusState>(status.state), event);
+    }
+}
+
+// ========== 统计 ==========
+
+/**
+ * @brief 生成总线健康报告
+ */
+QString CANBusMonitor::generateReport()
+{
+    CANControllerStatus status;
+    bool hasStatus = readControllerStatus(status);
+
+    QString report;
+    QTextStream out(&report);
+
+    out << "========================================\n";
+    out << "  CAN Bus Health Report: " << m_interfaceName << "\n";
+    out << "========================================\n";
+    out << "State: " << stateToString(m_state)
+        << "  TEC: " << m_txErrorCount
+        << "  REC: " << m_rxErrorCount << "\n";
+    out << "----------------------------------------\n";
+    out << "  • Error frames\n";
+    out << "    bus-off: " << m_busOffCount
+        << "  protocol: " << m_protocolErrors
+        << "  no-ack: " << m_ackErrors << "\n";
+    out << "    arbitration lost: " << m_arbitrationLost
+        << "  overflow: " << m_overflows
+        << "  tx timeout: " << m_txTimeouts << "\n";
+    out << "  • Auto restart: " << (m_autoRestart ? "on" : "off")
+        << "  restarts: " << m_restartCount
+        << "  next backoff: " << m_currentBackoffMs << " ms\n";
+
+    if (hasStatus) {
+        out << "  • Controller (rtnetlink)\n";
+        out << "    state: " << stateToString(status.state)
+            << "  bitrate: " << status.bitrate
+            << "  restart-ms: " << status.restartMs << "\n";
+        out << "    bus errors: " << status.busErrors
+            << "  warning: " << status.errorWarning
+            << "  passive: " << status.errorPassive
+            << "  bus-off: " << status.busOff << "\n";
+        out << "    arbitration lost: " << status.arbitrationLost
+            << "  restarts: " << status.restarts << "\n";
+    }
+
+    out << "========================================\n";
+
+    return report;
+}
+
+/**
+ * @brief 状态转字符串
+ */
+QString CANBusMonitor::stateToString(int state)
+{
+    switch (state) {
+        case ErrorActive:  return "ErrorActive";
+        case ErrorWarning: return "ErrorWarning";
+        case ErrorPassive: return "ErrorPassive";
+        case BusOffState:  return "BusOff";
+        case Stopped:      return "Stopped";
+        case Sleeping:     return "Sleeping";
+        default:           return "Unknown";
+    }
+}
+
+/**
+ * @brief 事件类型转字符串
+ */
+QString CANBusMonitor::eventTypeToString(int type)
+{
+    switch (type) {
+        case CANBusHealthEvent::StateChanged:       return "StateChanged";
+        case CANBusHealthEvent::BusOff:             return "BusOff";
+        case CANBusHealthEvent::Restarted:          return "Restarted";
+        case CANBusHealthEvent::RestartScheduled:   return "RestartScheduled";
+        case CANBusHealthEvent::RestartFailed:      return "RestartFailed";
+        case CANBusHealthEvent::ProtocolError:      return "ProtocolError";
+        case CANBusHealthEvent::AckMissing:         return "AckMissing";
+        case CANBusHealthEvent::ArbitrationLost:    return "ArbitrationLost";
+        case CANBusHealthEvent::ControllerOverflow: return "ControllerOverflow";
+        case CANBusHealthEvent::TxTimeout:          return "TxTimeout";
+        case CANBusHealthEvent::TransceiverError:   return "TransceiverError";
+        default:                                    return "Unknown";
+    }
+}
@@ -0,0 +1,233 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANDbc.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: DBC解码规则实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/can/CANDbc.h"
+#include <QFile>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QDebug>
+
+#define DBC_EXTENDED_FLAG       0x80000000U     // DBC中扩展帧ID的标志位
+#define DBC_INDEPENDENT_MSG     0xC0000000U     // VECTOR__INDEPENDENT_SIG_MSG
+
+/**
+ * @brief 构造函数
+ */
+CANDbcDatabase::CANDbcDatabase()
+    : m_forceJ1939(false)
+{
+}
+
+/**
+ * @brief 从文件加载
+ */
+bool CANDbcDatabase::loadFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_lastError = QString("无法打开DBC文件%1: %2").arg(path, file.errorString());
+        qWarning() << "[CANDbcDatabase]" << m_lastError;
+        return false;
+    }
+
+    // DBC常见编码为Latin-1/GBK，名称只用ASCII，单位中的非ASCII字符按Latin-1读取
+    QByteArray content = file.readAll();
+    if (!parse(QString::fromLatin1(content))) {
+        qWarning() << "[CANDbcDatabase]" << path << m_lastError;
+        return false;
+    }
+
+    qInfo() << "[CANDbcDatabase] 加载DBC:" << path << "报文:" << m_messages.size()
+            << "信号:" << m_signals.size();
+    return true;
+}
+
+/**
+ * @brief 解析DBC文本
+ */
+bool CANDbcDatabase::parse(const QString &text)
+{
+    static const QRegularExpression messagePattern(
+        "^BO_\\s+(\\d+)\\s+(\\w+)\\s*:\\s*(\\d+)");
+    static const QRegularExpression signalPattern(
+        "^SG_\\s+(\\w+)\\s*(M|m\\d+)?\\s*:\\s*(\\d+)\\|(\\d+)@([01])([+-])\\s*"
+        "\\(([^,]+),([^)]+)\\)\\s*\\[[^\\]]*\\]\\s*\"([^\"]*)\"");
+    static const QRegularExpression frameFormatDef(
+        "^BA_DEF_\\s+BO_\\s+\"VFrameFormat\"\\s+ENUM\\s+(.*);");
+    static const QRegularExpression frameFormatValue(
+        "^BA_\\s+\"VFrameFormat\"\\s+BO_\\s+(\\d+)\\s+(\\d+)\\s*;");
+
+    m_messages.clear();
+    m_signals.clear();
+    m_idIndex.clear();
+    m_pgnIndex.clear();
+    m_j1939Ids.clear();
+
+    int j1939Enum = -1;
+    int current = -1;
+    int lineNumber = 0;
+    QHash<quint32, int> frameFormats;
+
+    const QStringList lines = text.split('\n');
+    for (const QString &rawLine : lines) {
+        lineNumber++;
+        const QString line = rawLine.trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        if (line.startsWith("BO_ ")) {
+            QRegularExpressionMatch match = messagePattern.match(line);
+            if (!match.hasMatch()) {
+                m_lastError = QString("第%1行: BO_格式错误").arg(lineNumber);
+                return false;
+            }
+            quint32 rawId = match.captured(1).toUInt();
+            if (rawId == DBC_INDEPENDENT_MSG) {
+                current = -1;
+                continue;
+            }
+            Message message;
+            message.name = match.captured(2);
+            message.extended = (rawId & DBC_EXTENDED_FLAG) != 0;
+            message.canId = rawId & 0x1FFFFFFFU;
+            message.dlc = match.captured(3).toInt();
+            message.j1939 = false;
+            message.muxSignal = -1;
+            current = m_messages.size();
+            m_messages.append(message);
+            continue;
+        }
+
+        if (line.startsWith("SG_ ")) {
+            if (current < 0) {
+                continue;
+            }
+            QRegularExpressionMatch match = signalPattern.match(line);
+            if (!match.hasMatch()) {
+                m_lastError = QString("第%1行: SG_格式错误").arg(lineNumber);
+                return false;
+            }
+            Signal sig;
+            sig.name = match.captured(1);
+            sig.message = current;
+            sig.startBit = match.captured(3).toInt();
+            sig.length = match.captured(4).toInt();
+            sig.motorola = match.captured(5) == "0";
+            sig.isSigned = match.captured(6) == "-";
+            sig.factor = match.captured(7).trimmed().toDouble();
+            sig.offset = match.captured(8).trimmed().toDouble();
+            sig.unit = match.captured(9);
+            const QString mux = match.captured(2);
+            sig.multiplexor = (mux == "M");
+            sig.muxValue = mux.startsWith('m') ? mux.mid(1).toInt() : -1;
+
+            Message &message = m_messages[current];
+            if (sig.multiplexor) {
+                message.muxSignal = m_signals.size();
+            }
+            message.signalIndexes.append(m_signals.size());
+            m_signals.append(sig);
+            continue;
+        }
+
+        if (line.startsWith("BA_DEF_ ")) {
+            QRegularExpressionMatch match = frameFormatDef.match(line);
+            if (match.hasMatch()) {
+                QStringList values = match.captured(1).split(',');
+                for (int i = 0; i < values.size(); i++) {
+                    if (values[i].trimmed().remove('"') == "J1939PG") {
+                        j1939Enum = i;
+                    }
+                }
+            }
+            continue;
+        }
+
+        if (line.startsWith("BA_ ")) {
+            QRegularExpressionMatch match = frameFormatValue.match(line);
+            if (match.hasMatch()) {
+                frameFormats.insert(match.captured(1).toUInt(), match.captured(2).toInt());
+            }
+            continue;
+        }
+
+        // 其他行（NS_、BU_、CM_、VAL_等）与解码无关，SG_只跟在BO_之后
+        current = -1;
+    }
+
+    // BA_行在BO_之后出现，解析完再标记J1939报文
+    if (j1939Enum >= 0) {
+        for (QHash<quint32, int>::const_iterator it = frameFormats.constBegin();
+             it != frameFormats.constEnd(); ++it) {
+            if (it.value() == j1939Enum) {
+                m_j1939Ids.insert(it.key() & 0x1FFFFFFFU, true);
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 编译解码表
+ */
+bool CANDbcDatabase::compile()
+{
+    m_idIndex.clear();
+    m_pgnIndex.clear();
+
+    // 超出提取指令能力的信号（如64位信号）跳过，不影响同一报文的其他信号
+    int skipped = 0;
+    for (int i = 0; i < m_signals.size(); i++) {
+        Signal &sig = m_signals[i];
+        QString reason;
+        if (sig.extractor.compile(sig.startBit, sig.length, sig.motorola, sig.isSigned, &reason)) {
+            continue;
+        }
+        Message &message = m_messages[sig.message];
+        qWarning() << "[CANDbcDatabase] 跳过信号" << message.name + "." + sig.name << reason;
+        message.signalIndexes.removeAll(i);
+        if (message.muxSignal == i) {
+            message.muxSignal = -1;
+        }
+        skipped++;
+    }
+    if (!m_signals.isEmpty() && skipped == m_signals.size()) {
+        m_lastError = "没有可解码的信号";
+        return false;
+    }
+
+    int pgnCount = 0;
+    for (int i = 0; i < m_messages.size(); i++) {
+        Message &message = m_messages[i];
+        message.j1939 = message.extended &&
+                        (m_forceJ1939 || m_j1939Ids.contains(message.canId));
+
+        if (message.j1939) {
+            quint32 pgn = j1939Pgn(message.canId);
+            if (m_pgnIndex.contains(pgn)) {
+                qWarning() << "[CANDbcDatabase] PGN重复:" << QString::number(pgn, 16)
+                           << message.name << "忽略";
+                continue;
+            }
+            m_pgnIndex.insert(pgn, i);
+            pgnCount++;
+        } else {
+            m_idIndex.insert(makeKey(message.canId, message.extended), i);
+        }
+    }
+
+    qInfo() << "[CANDbcDatabase] 解码表已编译: 报文" << m_messages.size()
+            << "信号" << m_signals.size() - skipped << "J1939 PGN" << pgnCount;
+    return true;
+}
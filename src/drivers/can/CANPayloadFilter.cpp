@@ -0,0 +1,529 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANPayloadFilter.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN载荷过滤器实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 内核过滤时回环帧在接收路径按规则再判断，与用户空间过滤一致
+ ***************************************************************/
+
+#include "drivers/can/CANPayloadFilter.h"
+#include <QSocketNotifier>
+#include <QStringList>
+#include <QRegExp>
+#include <QTextStream>
+#include <QtEndian>
+#include <QDebug>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/filter.h>
+#include <linux/if_packet.h>
+
+#define PAYLOAD_FILTER_ACCEPT   0xFFFF      // 保留整帧（大于CANFD_MTU）
+#define PAYLOAD_FILTER_DROP     0
+#define PAYLOAD_FILTER_MAX_BYTE 7           // 经典帧数据区固定8字节，越界读取会使整个程序返回0
+
+static_assert(sizeof(struct sock_filter) == 8, "sock_filter layout");
+
+namespace {
+
+/**
+ * @brief BPF按网络字节序读取32位字，can_id在内存中为主机字节序，
+ *        比较常量需做同样的转换
+ */
+quint32 wireWord(quint32 hostValue)
+{
+    uchar bytes[4];
+    memcpy(bytes, &hostValue, sizeof(bytes));
+    return qFromBigEndian<quint32>(bytes);
+}
+
+struct JumpFixup
+{
+    int position;       // 指令位置（规则块内）
+    bool onTrue;        // 修正jt还是jf
+};
+
+} // namespace
+
+/**
+ * @brief 构造函数
+ */
+CANPayloadFilter::CANPayloadFilter()
+    : m_passErrorFrames(true)
+    , m_attachedFd(-1)
+{
+    m_mode.store(Disabled);
+    m_filteredCount.store(0);
+}
+
+// ========== 规则 ==========
+
+/**
+ * @brief 解析并编译规则
+ */
+bool CANPayloadFilter::setRules(const QString &rules, bool passErrorFrames, QString *errorMessage)
+{
+    QString text = rules.trimmed();
+    text.replace(QLatin1Char(','), QLatin1Char(' '));
+
+    QVector<Rule> parsed;
+    QVector<Instruction> program;
+
+    if (!text.isEmpty()) {
+        const QStringList parts = text.split(QLatin1Char('|'));
+        for (const QString &part : parts) {
+            Rule rule;
+            if (!parseRule(part, rule, errorMessage)) {
+                return false;
+            }
+            parsed.append(rule);
+        }
+
+        if (!compile(parsed, passErrorFrames, program, errorMessage)) {
+            return false;
+        }
+    }
+
+    QWriteLocker locker(&m_lock);
+    m_text = text;
+    m_rules = parsed;
+    m_program = program;
+    m_passErrorFrames = passErrorFrames;
+
+    qInfo() << "[CANPayloadFilter] 规则已更新:" << parsed.size() << "条,"
+            << program.size() << "条BPF指令";
+    return true;
+}
+
+void CANPayloadFilter::clear()
+{
+    setRules(QString());
+}
+
+QString CANPayloadFilter::rules() const
+{
+    QReadLocker locker(&m_lock);
+    return m_text;
+}
+
+bool CANPayloadFilter::isEmpty() const
+{
+    QReadLocker locker(&m_lock);
+    return m_rules.isEmpty();
+}
+
+int CANPayloadFilter::instructionCount() const
+{
+    QReadLocker locker(&m_lock);
+    return m_program.size();
+}
+
+/**
+ * @brief 解析数值（十进制或0x十六进制）
+ */
+bool CANPayloadFilter::parseNumber(const QString &text, quint32 &value)
+{
+    bool ok = false;
+    value = text.trimmed().toUInt(&ok, 0);
+    return ok;
+}
+
+/**
+ * @brief 解析一条规则
+ */
+bool CANPayloadFilter::parseRule(const QString &text, Rule &rule, QString *errorMessage)
+{
+    const QStringList tokens = text.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+
+    if (tokens.isEmpty()) {
+        if (errorMessage) *errorMessage = QString("空规则");
+        return false;
+    }
+
+    bool hasId = false;
+    quint32 idValue = 0;
+    quint32 idMask = 0;
+    bool hasIdMask = false;
+    int format = -1;    // -1=未指定 0=标准帧 1=扩展帧
+    int remote = -1;    // -1=未指定 0=数据帧 1=远程帧
+
+    rule.idValue = 0;
+    rule.idMask = 0;
+    rule.conditions.clear();
+
+    QRegExp byteExpr("^byte(\\d+)(!=|=)([^/]+)(?:/(.+))?$");
+    QRegExp dlcExpr("^dlc(>=|<=|=)(.+)$");
+    QRegExp idExpr("^id=([^/]+)(?:/(.+))?$");
+
+    for (const QString &rawToken : tokens) {
+        QString token = rawToken.toLower();
+        QString error;
+
+        if (token == "ext" || token == "std") {
+            format = (token == "ext") ? 1 : 0;
+        } else if (token == "rtr" || token == "data") {
+            remote = (token == "rtr") ? 1 : 0;
+        } else if (idExpr.exactMatch(token)) {
+            if (!parseNumber(idExpr.cap(1), idValue) ||
+                (!idExpr.cap(2).isEmpty() && !parseNumber(idExpr.cap(2), idMask))) {
+                error = "ID数值无效";
+            }
+            hasId = true;
+            hasIdMask = !idExpr.cap(2).isEmpty();
+        } else if (dlcExpr.exactMatch(token)) {
+            quint32 dlc = 0;
+            if (!parseNumber(dlcExpr.cap(2), dlc) || dlc > 64) {
+                error = "DLC数值无效";
+            } else {
+                Condition cond;
+                cond.field = Condition::Dlc;
+                cond.op = (dlcExpr.cap(1) == ">=") ? Condition::Ge
+                        : (dlcExpr.cap(1) == "<=") ? Condition::Le : Condition::Eq;
+                cond.index = 0;
+                cond.value = static_cast<quint8>(dlc);
+                cond.mask = 0xFF;
+                rule.conditions.append(cond);
+            }
+        } else if (byteExpr.exactMatch(token)) {
+            quint32 index = 0;
+            quint32 value = 0;
+            quint32 mask = 0xFF;
+            if (!parseNumber(byteExpr.cap(1), index) || index > PAYLOAD_FILTER_MAX_BYTE) {
+                error = QString("字节序号超出范围（0~%1）").arg(PAYLOAD_FILTER_MAX_BYTE);
+            } else if (!parseNumber(byteExpr.cap(3), value) || value > 0xFF ||
+                       (!byteExpr.cap(4).isEmpty() && (!parseNumber(byteExpr.cap(4), mask) || mask > 0xFF))) {
+                error = "字节数值无效";
+            } else {
+                Condition cond;
+                cond.field = Condition::Byte;
+                cond.op = (byteExpr.cap(2) == "!=") ? Condition::Ne : Condition::Eq;
+                cond.index = static_cast<int>(index);
+                cond.value = static_cast<quint8>(value & mask);
+                cond.mask = static_cast<quint8>(mask);
+                rule.conditions.append(cond);
+            }
+        } else {
+            error = "无法识别的条件";
+        }
+
+        if (!error.isEmpty()) {
+            if (errorMessage) *errorMessage = QString("%1: \"%2\"").arg(error, rawToken);
+            return false;
+        }
+    }
+
+    if (hasId) {
+        if (format < 0) {
+            format = (idValue > CAN_SFF_MASK) ? 1 : 0;
+        }
+        quint32 fullMask = format ? CAN_EFF_MASK : CAN_SFF_MASK;
+        if (idValue > fullMask) {
+            if (errorMessage) *errorMessage = QString("ID超出范围: 0x%1").arg(idValue, 0, 16);
+            return false;
+        }
+        quint32 mask = hasIdMask ? (idMask & fullMask) : fullMask;
+        rule.idMask |= mask;
+        rule.idValue |= idValue & mask;
+    }
+
+    if (format >= 0) {
+        rule.idMask |= CAN_EFF_FLAG;
+        rule.idValue |= format ? CAN_EFF_FLAG : 0;
+    }
+
+    if (remote >= 0) {
+        rule.idMask |= CAN_RTR_FLAG;
+        rule.idValue |= remote ? CAN_RTR_FLAG : 0;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 编译为BPF程序
+ *
+ * 程序结构:
+ *   - 本地回环帧直接接收（内核中无法区分本套接字的回显，其他套接字的
+ *     回环帧由accept()在接收路径中按规则判断）
+ *   - 错误帧按passErrorFrames处理
+ *   - 依次检查每条规则，任一条件不满足跳到下一条规则
+ *   - 全部规则不满足则丢弃
+ */
+bool CANPayloadFilter::compile(const QVector<Rule> &rules, bool passErrorFrames,
+                               QVector<Instruction> &program, QString *errorMessage)
+{
+    auto emitInsn = [](QVector<Instruction> &out, quint16 code, quint32 k,
+                       quint8 jt = 0, quint8 jf = 0) {
+        Instruction insn;
+        insn.code = code;
+        insn.jt = jt;
+        insn.jf = jf;
+        insn.k = k;
+        out.append(insn);
+    };
+
+    program.clear();
+
+    // 本地回环帧（含回显）放行，非回显的由accept()再判断
+    emitInsn(program, BPF_LD | BPF_W | BPF_ABS, static_cast<quint32>(SKF_AD_OFF + SKF_AD_PKTTYPE));
+    emitInsn(program, BPF_JMP | BPF_JEQ | BPF_K, PACKET_LOOPBACK, 0, 1);
+    emitInsn(program, BPF_RET | BPF_K, PAYLOAD_FILTER_ACCEPT);
+
+    // 错误帧
+    emitInsn(program, BPF_LD | BPF_W | BPF_ABS, offsetof(struct can_frame, can_id));
+    emitInsn(program, BPF_JMP | BPF_JSET | BPF_K, wireWord(CAN_ERR_FLAG), 0, 1);
+    emitInsn(program, BPF_RET | BPF_K, passErrorFrames ? PAYLOAD_FILTER_ACCEPT : PAYLOAD_FILTER_DROP);
+
+    for (int r = 0; r < rules.size(); ++r) {
+        const Rule &rule = rules.at(r);
+        QVector<Instruction> block;
+        QVector<JumpFixup> fixups;
+
+        if (rule.idMask) {
+            emitInsn(block, BPF_LD | BPF_W | BPF_ABS, offsetof(struct can_frame, can_id));
+            emitInsn(block, BPF_ALU | BPF_AND | BPF_K, wireWord(rule.idMask));
+            emitInsn(block, BPF_JMP | BPF_JEQ | BPF_K, wireWord(rule.idValue));
+            fixups.append({block.size() - 1, false});
+        }
+
+        for (const Condition &cond : rule.conditions) {
+            if (cond.field == Condition::Dlc) {
+                emitInsn(block, BPF_LD | BPF_B | BPF_ABS, offsetof(struct can_frame, can_dlc));
+                if (cond.op == Condition::Ge) {
+                    emitInsn(block, BPF_JMP | BPF_JGE | BPF_K, cond.value);
+                    fixups.append({block.size() - 1, false});
+                } else if (cond.op == Condition::Le) {
+                    emitInsn(block, BPF_JMP | BPF_JGT | BPF_K, cond.value);
+                    fixups.append({block.size() - 1, true});
+                } else {
+                    emitInsn(block, BPF_JMP | BPF_JEQ | BPF_K, cond.value);
+                    fixups.append({block.size() - 1, false});
+                }
+            } else {
+                emitInsn(block, BPF_LD | BPF_B | BPF_ABS,
+                         static_cast<quint32>(offsetof(struct can_frame, data) + cond.index));
+                if (cond.mask != 0xFF) {
+                    emitInsn(block, BPF_ALU | BPF_AND | BPF_K, cond.mask);
+                }
+                emitInsn(block, BPF_JMP | BPF_JEQ | BPF_K, cond.value);
+                fixups.append({block.size() - 1, cond.op == Condition::Ne});
+            }
+        }
+
+        emitInsn(block, BPF_RET | BPF_K, PAYLOAD_FILTER_ACCEPT);
+
+        // 失败跳转目标为规则块之后（下一条规则或最终丢弃）
+        for (const JumpFixup &fixup : fixups) {
+            int offset = block.size() - (fixup.position + 1);
+            if (offset > 255) {
+                if (errorMessage) *errorMessage = QString("第%1条规则过长").arg(r + 1);
+                return false;
+            }
+            if (fixup.onTrue) {
+                block[fixup.position].jt = static_cast<quint8>(offset);
+            } else {
+                block[fixup.position].jf = static_cast<quint8>(offset);
+            }
+        }
+
+        program += block;
+    }
+
+    emitInsn(program, BPF_RET | BPF_K, PAYLOAD_FILTER_DROP);
+
+    if (program.size() > BPF_MAXINSNS) {
+        if (errorMessage) *errorMessage = QString("BPF程序超过%1条指令").arg(BPF_MAXINSNS);
+        return false;
+    }
+
+    return true;
+}
+
+// ========== 挂载 ==========
+
+/**
+ * @brief 挂载到套接字
+ */
+bool CANPayloadFilter::attach(int fd)
+{
+    QReadLocker locker(&m_lock);
+
+    if (m_program.isEmpty()) {
+        if (fd >= 0 && m_attachedFd == fd && m_mode.load() == Kernel) {
+            int dummy = 0;
+            setsockopt(fd, SOL_SOCKET, SO_DETACH_FILTER, &dummy, sizeof(dummy));
+        }
+        m_attachedFd = -1;
+        m_mode.store(Disabled);
+        return true;
+    }
+
+    if (fd >= 0) {
+        struct sock_fprog prog;
+        prog.len = static_cast<unsigned short>(m_program.size());
+        prog.filter = reinterpret_cast<struct sock_filter*>(
+            const_cast<Instruction*>(m_program.constData()));
+
+        if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == 0) {
+            m_attachedFd = fd;
+            m_mode.store(Kernel);
+            qInfo() << "[CANPayloadFilter] BPF程序已挂载到套接字" << fd
+                    << "(" << m_program.size() << "条指令)";
+            return true;
+        }
+
+        qWarning() << "[CANPayloadFilter] SO_ATTACH_FILTER失败:" << strerror(errno)
+                   << "，改为用户空间过滤";
+    } else {
+        qWarning() << "[CANPayloadFilter] 无法获取套接字描述符，改为用户空间过滤";
+    }
+
+    m_attachedFd = -1;
+    m_mode.store(UserSpace);
+    return false;
+}
+
+void CANPayloadFilter::detached()
+{
+    QReadLocker locker(&m_lock);
+    m_attachedFd = -1;
+    m_mode.store(m_program.isEmpty() ? Disabled : UserSpace);
+}
+
+/**
+ * @brief 接收路径过滤判断
+ *
+ * 用户空间过滤时判断全部帧；内核过滤时BPF放行了全部回环帧，而用户空间
+ * 只能识别本套接字的回显（hasLocalEcho），其他套接字的回环帧与总线帧
+ * 无法区分，所以非回显帧都再判断一次
+ */
+bool CANPayloadFilter::accept(const QCanBusFrame &frame) const
+{
+    if (m_mode.load() == Disabled) {
+        return true;
+    }
+
+    if (frame.hasLocalEcho()) {
+        return true;
+    }
+
+    QReadLocker locker(&m_lock);
+
+    if (frame.frameType() == QCanBusFrame::ErrorFrame) {
+        if (!m_passErrorFrames) {
+            m_filteredCount.fetchAndAddRelaxed(1);
+        }
+        return m_passErrorFrames;
+    }
+
+    quint32 canId = frame.frameId();
+    if (frame.hasExtendedFrameFormat()) {
+        canId |= CAN_EFF_FLAG;
+    }
+    if (frame.frameType() == QCanBusFrame::RemoteRequestFrame) {
+        canId |= CAN_RTR_FLAG;
+    }
+
+    const QByteArray payload = frame.payload();
+    for (const Rule &rule : m_rules) {
+        if (matchRule(rule, canId, payload)) {
+            return true;
+        }
+    }
+
+    m_filteredCount.fetchAndAddRelaxed(1);
+    return false;
+}
+
+/**
+ * @brief 用户空间规则匹配（与BPF程序语义一致）
+ */
+bool CANPayloadFilter::matchRule(const Rule &rule, quint32 canId, const QByteArray &payload)
+{
+    if ((canId & rule.idMask) != rule.idValue) {
+        return false;
+    }
+
+    for (const Condition &cond : rule.conditions) {
+        if (cond.field == Condition::Dlc) {
+            int dlc = payload.size();
+            bool ok = (cond.op == Condition::Ge) ? dlc >= cond.value
+                    : (cond.op == Condition::Le) ? dlc <= cond.value
+                    : dlc == cond.value;
+            if (!ok) {
+                return false;
+            }
+        } else {
+            quint8 byte = (cond.index < payload.size())
+                        ? static_cast<quint8>(payload.at(cond.index)) : 0;
+            bool equal = ((byte & cond.mask) == cond.value);
+            if (equal == (cond.op == Condition::Ne)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 反汇编BPF程序
+ */
+QString CANPayloadFilter::dumpProgram() const
+{
+    QReadLocker locker(&m_lock);
+
+    QString text;
+    QTextStream out(&text);
+
+    for (int i = 0; i < m_program.size(); ++i) {
+        const Instruction &insn = m_program.at(i);
+        QString op;
+        switch (insn.code) {
+            case BPF_LD | BPF_W | BPF_ABS:      op = "ld  [%1]"; break;
+            case BPF_LD | BPF_B | BPF_ABS:      op = "ldb [%1]"; break;
+            case BPF_ALU | BPF_AND | BPF_K:     op = "and #0x%2"; break;
+            case BPF_JMP | BPF_JEQ | BPF_K:     op = "jeq #0x%2"; break;
+            case BPF_JMP | BPF_JGE | BPF_K:     op = "jge #0x%2"; break;
+            case BPF_JMP | BPF_JGT | BPF_K:     op = "jgt #0x%2"; break;
+            case BPF_JMP | BPF_JSET | BPF_K:    op = "jset #0x%2"; break;
+            case BPF_RET | BPF_K:               op = "ret #%1"; break;
+            default:                            op = "??? %1"; break;
+        }
+        QString line = op.contains("%2") ? op.arg(insn.k, 0, 16) : op.arg(static_cast<int>(insn.k));
+        if (BPF_CLASS(insn.code) == BPF_JMP) {
+            line += QString("  jt %1 jf %2").arg(i + 1 + insn.jt).arg(i + 1 + insn.jf);
+        }
+        out << QString("%1: ").arg(i, 3, 10, QChar('0')) << line << "\n";
+    }
+
+    return text;
+}
+
+/**
+ * @brief 获取socketcan设备的套接字描述符
+ *
+ * socketcan插件用QSocketNotifier监听原始套接字，通知器是设备的子对象
+ */
+int CANPayloadFilter::socketDescriptor(QCanBusDevice *device)
+{
+    if (!device) {
+        return -1;
+    }
+
+    const QList<QSocketNotifier*> notifiers = device->findChildren<QSocketNotifier*>();
+    for (QSocketNotifier *notifier : notifiers) {
+        if (notifier->type() == QSocketNotifier::Read) {
+            return static_cast<int>(notifier->socket());
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,62 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANSignal.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN信号位域提取实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件（从CANModbusBridge中提取）
+ ***************************************************************/
+
+#include "drivers/can/CANSignal.h"
+
+/**
+ * @brief 编译信号定义
+ */
+bool CANSignalExtractor::compile(int startBit, int bitLength, bool bigEndian, bool signedValue,
+                                 QString *errorMessage)
+{
+    if (bitLength < 1 || bitLength > 32) {
+        if (errorMessage) *errorMessage = "位长度必须为1~32";
+        return false;
+    }
+    if (startBit < 0 || startBit >= CAN_SIGNAL_MAX_PAYLOAD * 8) {
+        if (errorMessage) *errorMessage = "起始位超出范围";
+        return false;
+    }
+
+    int firstByte;
+    int lastByte;
+    int bitShift;
+
+    if (bigEndian) {
+        // 起始位为最高位；窗口从最高位所在字节开始按大端装载，
+        // 该位在64位窗口中的位置为56+位内序号，向下数length-1位为最低位
+        int bitInByte = startBit % 8;
+        firstByte = startBit / 8;
+        int below = bitLength - 1 - bitInByte;      // 首字节以下还需要的位数
+        lastByte = firstByte + (below > 0 ? (below + 7) / 8 : 0);
+        bitShift = 56 + bitInByte - (bitLength - 1);
+    } else {
+        // 起始位为最低位；窗口从最低位所在字节开始按小端装载
+        firstByte = startBit / 8;
+        lastByte = (startBit + bitLength - 1) / 8;
+        bitShift = startBit % 8;
+    }
+
+    if (lastByte >= CAN_SIGNAL_MAX_PAYLOAD) {
+        if (errorMessage) *errorMessage = "信号超出64字节";
+        return false;
+    }
+
+    byteOffset = static_cast<quint8>(firstByte);
+    minLength = static_cast<quint8>(lastByte + 1);
+    shift = static_cast<quint8>(bitShift);
+    length = static_cast<quint8>(bitLength);
+    motorola = bigEndian;
+    isSigned = signedValue;
+    mask = (bitLength == 32) ? 0xFFFFFFFFU : ((1U << bitLength) - 1);
+    return true;
+}
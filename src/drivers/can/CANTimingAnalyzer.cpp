@@ -0,0 +1,348 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTimingAnalyzer.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN总线按ID的周期与抖动分析器实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/can/CANTimingAnalyzer.h"
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <time.h>
+
+static const quint32 EMPTY_KEY = 0xFFFFFFFFu;
+static const quint32 EXTENDED_BIT = 0x80000000u;
+
+/**
+ * @brief 构造函数
+ */
+CANTimingAnalyzer::CANTimingAnalyzer(int maxIds)
+    : m_mask(0)
+    , m_maxIds(qMax(16, maxIds))
+    , m_trackedIds(0)
+    , m_untrackedFrames(0)
+{
+    // 表大小取不小于2倍maxIds的2的幂，装载率不超过50%，探测链很短
+    int size = 32;
+    while (size < m_maxIds * 2) {
+        size <<= 1;
+    }
+
+    m_slots.resize(size);
+    m_mask = static_cast<quint32>(size - 1);
+    reset();
+
+    qInfo() << "[CANTimingAnalyzer] 创建时序分析器，最多跟踪ID数:" << m_maxIds;
+}
+
+/**
+ * @brief 生成哈希键（扩展帧用bit31区分）
+ */
+quint32 CANTimingAnalyzer::makeKey(quint32 frameId, bool extended)
+{
+    return (frameId & 0x1FFFFFFFu) | (extended ? EXTENDED_BIT : 0);
+}
+
+/**
+ * @brief 当前时间（微秒，CLOCK_REALTIME，与内核帧时间戳同一时钟）
+ */
+qint64 CANTimingAnalyzer::nowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000LL + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 查找或插入槽位（线性探测）
+ */
+CANTimingAnalyzer::Slot* CANTimingAnalyzer::findSlot(quint32 key, bool insert)
+{
+    // 乘法哈希打散连续ID
+    quint32 index = (key * 2654435761u) & m_mask;
+
+    for (quint32 probe = 0; probe <= m_mask; ++probe) {
+        Slot &slot = m_slots[(index + probe) & m_mask];
+        if (slot.key == key) {
+            return &slot;
+        }
+        if (slot.key == EMPTY_KEY) {
+            if (!insert || m_trackedIds >= m_maxIds) {
+                return nullptr;
+            }
+            slot.key = key;
+            m_trackedIds++;
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+const CANTimingAnalyzer::Slot* CANTimingAnalyzer::findSlot(quint32 key) const
+{
+    quint32 index = (key * 2654435761u) & m_mask;
+
+    for (quint32 probe = 0; probe <= m_mask; ++probe) {
+        const Slot &slot = m_slots.at((index + probe) & m_mask);
+        if (slot.key == key) {
+            return &slot;
+        }
+        if (slot.key == EMPTY_KEY) {
+            return nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+// ========== 接收路径 ==========
+
+/**
+ * @brief 更新一帧
+ */
+void CANTimingAnalyzer::update(const QCanBusFrame &frame)
+{
+    if (frame.frameType() != QCanBusFrame::DataFrame &&
+        frame.frameType() != QCanBusFrame::RemoteRequestFrame) {
+        return;
+    }
+
+    const QCanBusFrame::TimeStamp stamp = frame.timeStamp();
+    qint64 timestampUs = stamp.seconds() * 1000000LL + stamp.microSeconds();
+
+    update(frame.frameId(), frame.hasExtendedFrameFormat(),
+           static_cast<quint8>(frame.payload().size()), timestampUs);
+}
+
+/**
+ * @brief 更新一帧（原始参数）
+ *
+ * 周期和抖动都用 x += (sample - x) >> 4 的移位EWMA；
+ * 间隔超过1.5倍周期时认为中间丢了帧，按周期折算丢失数，
+ * 并用折算后的单帧间隔更新EWMA，避免一次丢帧把周期拉偏。
+ */
+void CANTimingAnalyzer::update(quint32 frameId, bool extended, quint8 dlc, qint64 timestampUs)
+{
+    if (timestampUs <= 0) {
+        timestampUs = nowUs();
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    Slot *slot = findSlot(makeKey(frameId, extended), true);
+    if (!slot) {
+        m_untrackedFrames++;
+        return;
+    }
+
+    if (slot->frameCount == 0) {
+        slot->lastDlc = dlc;
+        slot->lastTimestampUs = timestampUs;
+        slot->frameCount = 1;
+        return;
+    }
+
+    if (dlc != slot->lastDlc) {
+        slot->dlcChanges++;
+        slot->lastDlc = dlc;
+    }
+
+    qint64 interval = timestampUs - slot->lastTimestampUs;
+    slot->lastTimestampUs = timestampUs;
+    slot->frameCount++;
+
+    if (interval < 0) {
+        // 时钟回跳，丢弃本次间隔
+        return;
+    }
+
+    if (slot->frameCount == 2) {
+        slot->periodScaled = interval << EwmaShift;
+        slot->jitterScaled = 0;
+        slot->minIntervalUs = interval;
+        slot->maxIntervalUs = interval;
+        return;
+    }
+
+    if (interval < slot->minIntervalUs) {
+        slot->minIntervalUs = interval;
+    }
+    if (interval > slot->maxIntervalUs) {
+        slot->maxIntervalUs = interval;
+    }
+
+    qint64 period = slot->periodScaled >> EwmaShift;
+    qint64 sample = interval;
+
+    if (slot->frameCount > WarmupFrames && period > 0 && interval * 2 > period * 3) {
+        qint64 missed = (interval + period / 2) / period - 1;
+        if (missed > 0) {
+            slot->missingCount += static_cast<quint64>(missed);
+            sample = interval / (missed + 1);
+        }
+    }
+
+    qint64 deviation = sample > period ? sample - period : period - sample;
+    slot->periodScaled += sample - period;
+    slot->jitterScaled += deviation - (slot->jitterScaled >> EwmaShift);
+}
+
+// ========== 查询 ==========
+
+/**
+ * @brief 槽位转统计快照
+ */
+CANIdTimingStats CANTimingAnalyzer::toStats(const Slot &slot, qint64 now) const
+{
+    CANIdTimingStats stats;
+    stats.frameId = slot.key & ~EXTENDED_BIT;
+    stats.extended = (slot.key & EXTENDED_BIT) != 0;
+    stats.frameCount = slot.frameCount;
+    stats.periodUs = slot.periodScaled >> EwmaShift;
+    stats.jitterUs = slot.jitterScaled >> EwmaShift;
+    stats.minIntervalUs = slot.minIntervalUs;
+    stats.maxIntervalUs = slot.maxIntervalUs;
+    stats.missingCount = slot.missingCount;
+    stats.lastDlc = slot.lastDlc;
+    stats.dlcChanges = slot.dlcChanges;
+    stats.lastSeenAgeUs = qMax<qint64>(0, now - slot.lastTimestampUs);
+    return stats;
+}
+
+/**
+ * @brief 获取所有ID的统计快照
+ */
+QVector<CANIdTimingStats> CANTimingAnalyzer::snapshot() const
+{
+    QVector<CANIdTimingStats> result;
+    qint64 now = nowUs();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        result.reserve(m_trackedIds);
+        for (const Slot &slot : m_slots) {
+            if (slot.key != EMPTY_KEY && slot.frameCount > 0) {
+                result.append(toStats(slot, now));
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end(),
+              [](const CANIdTimingStats &a, const CANIdTimingStats &b) {
+        if (a.extended != b.extended) {
+            return !a.extended;
+        }
+        return a.frameId < b.frameId;
+    });
+
+    return result;
+}
+
+/**
+ * @brief 获取单个ID的统计快照
+ */
+CANIdTimingStats CANTimingAnalyzer::getStats(quint32 frameId, bool extended) const
+{
+    qint64 now = nowUs();
+    QMutexLocker locker(&m_mutex);
+
+    const Slot *slot = findSlot(makeKey(frameId, extended));
+    if (!slot) {
+        CANIdTimingStats stats;
+        stats.frameId = frameId;
+        stats.extended = extended;
+        return stats;
+    }
+
+    return toStats(*slot, now);
+}
+
+/**
+ * @brief 已跟踪的ID数
+ */
+int CANTimingAnalyzer::getTrackedIdCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_trackedIds;
+}
+
+/**
+ * @brief 表满未能跟踪的帧数
+ */
+quint64 CANTimingAnalyzer::getUntrackedFrameCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_untrackedFrames;
+}
+
+/**
+ * @brief 清空所有统计
+ */
+void CANTimingAnalyzer::reset()
+{
+    QMutexLocker locker(&m_mutex);
+
+    Slot empty;
+    memset(&empty, 0, sizeof(empty));
+    empty.key = EMPTY_KEY;
+    m_slots.fill(empty);
+
+    m_trackedIds = 0;
+    m_untrackedFrames = 0;
+}
+
+/**
+ * @brief 生成按ID的时序报告
+ */
+QString CANTimingAnalyzer::generateReport() const
+{
+    QVector<CANIdTimingStats> all = snapshot();
+
+    QString report;
+    QTextStream out(&report);
+
+    out << "========================================\n";
+    out << "  CAN Bus Timing Report\n";
+    out << "========================================\n";
+    out << "Tracked IDs: " << all.size()
+        << "  Untracked frames: " << getUntrackedFrameCount() << "\n";
+    out << "----------------------------------------\n";
+
+    for (const CANIdTimingStats &s : all) {
+        QString id = s.extended
+                   ? QString("0x%1 [EXT]").arg(QString::number(s.frameId, 16).toUpper().rightJustified(8, QChar('0')))
+                   : QString("0x%1 [STD]").arg(QString::number(s.frameId, 16).toUpper().rightJustified(3, QChar('0')));
+        out << "  • " << id << "\n";
+        out << "    frames: " << s.frameCount
+            << "  missing: " << s.missingCount
+            << "  DLC: " << static_cast<int>(s.lastDlc)
+            << " (changes: " << s.dlcChanges << ")\n";
+        out << "    period: " << QString::number(s.periodUs / 1000.0, 'f', 3) << " ms"
+            << "  jitter: " << QString::number(s.jitterUs / 1000.0, 'f', 3) << " ms\n";
+        out << "    interval min/max: "
+            << QString::number(s.minIntervalUs / 1000.0, 'f', 3) << " / "
+            << QString::number(s.maxIntervalUs / 1000.0, 'f', 3) << " ms"
+            << "  last seen: " << QString::number(s.lastSeenAgeUs / 1000.0, 'f', 1) << " ms ago\n";
+    }
+
+    out << "========================================\n";
+
+    return report;
+}
+
+/**
+ * @brief 打印报告到控制台
+ */
+void CANTimingAnalyzer::printReport() const
+{
+    QString report = generateReport();
+    qInfo().noquote() << report;
+}
@@ -0,0 +1,424 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTraceReader.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 带索引的CAN抓包文件读取与查询实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 增加按文件句柄读取块的静态接口（并行离线解码）
+ *   3. 2026-10-18 查询ID先去掉标志位，块筛选和逐帧比较使用同一组ID
+ ***************************************************************/
+
+#include "drivers/can/CANTraceReader.h"
+#include "drivers/can/CANTraceWriter.h"
+#include <QFileInfo>
+#include <QDebug>
+
+// 重建索引时每个块的大小
+static const int SCAN_BLOCK_BYTES = 64 * 1024;
+// 扫描时每次读取的字节数
+static const int SCAN_CHUNK_BYTES = 1024 * 1024;
+
+/**
+ * @brief 构造函数
+ */
+CANTraceReader::CANTraceReader()
+    : m_fileSize(0)
+    , m_frameCount(0)
+    , m_indexRebuilt(false)
+    , m_recoveredFrames(0)
+{
+}
+
+/**
+ * @brief 析构函数
+ */
+CANTraceReader::~CANTraceReader()
+{
+    close();
+}
+
+/**
+ * @brief 打开抓包文件
+ */
+bool CANTraceReader::open(const QString &path)
+{
+    close();
+
+    m_path = path;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_lastError = QString("无法打开抓包文件%1: %2").arg(path, m_file.errorString());
+        qWarning() << "[CANTraceReader]" << m_lastError;
+        return false;
+    }
+
+    m_fileSize = m_file.size();
+    QByteArray header = m_file.read(CAN_TRACE_HEADER_SIZE);
+    if (header.size() != CAN_TRACE_HEADER_SIZE ||
+        memcmp(header.constData(), CAN_TRACE_MAGIC, 8) != 0) {
+        m_lastError = "不是CAN抓包文件";
+        qWarning() << "[CANTraceReader]" << m_lastError << path;
+        m_file.close();
+        return false;
+    }
+    const uchar *h = reinterpret_cast<const uchar *>(header.constData());
+    if (qFromLittleEndian<quint16>(h + 8) != CAN_TRACE_VERSION) {
+        m_lastError = QString("不支持的抓包文件版本: %1").arg(qFromLittleEndian<quint16>(h + 8));
+        qWarning() << "[CANTraceReader]" << m_lastError;
+        m_file.close();
+        return false;
+    }
+
+    if (!loadIndex(CANTraceWriter::indexPath(path))) {
+        m_blocks.clear();
+        m_indexRebuilt = true;
+        qWarning() << "[CANTraceReader] 索引不可用，扫描重建:" << path;
+    }
+
+    // 索引之后的尾部数据（写入器未正常关闭或最后一块未封块）
+    qint64 indexedEnd = CAN_TRACE_HEADER_SIZE;
+    if (!m_blocks.isEmpty()) {
+        indexedEnd = m_blocks.last().offset + m_blocks.last().byteLength;
+    }
+    const int indexedBlocks = m_blocks.size();
+    if (indexedEnd < m_fileSize && !scanRange(indexedEnd, m_fileSize)) {
+        m_file.close();
+        return false;
+    }
+    for (int i = indexedBlocks; i < m_blocks.size(); ++i) {
+        m_recoveredFrames += m_blocks.at(i).frameCount;
+    }
+
+    m_frameCount = 0;
+    for (const CANTraceBlock &block : m_blocks) {
+        m_frameCount += block.frameCount;
+    }
+    buildSearchTables();
+
+    qInfo() << "[CANTraceReader] 打开抓包文件:" << path << "块数:" << m_blocks.size()
+            << "帧数:" << m_frameCount
+            << (m_indexRebuilt ? "（索引已重建）" : "")
+            << (m_recoveredFrames > 0 ? QString("尾部补扫%1帧").arg(m_recoveredFrames) : QString());
+    return true;
+}
+
+/**
+ * @brief 关闭文件
+ */
+void CANTraceReader::close()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_blocks.clear();
+    m_maxPrefix.clear();
+    m_minSuffix.clear();
+    m_fileSize = 0;
+    m_frameCount = 0;
+    m_indexRebuilt = false;
+    m_recoveredFrames = 0;
+    m_lastStats = QueryStats();
+}
+
+qint64 CANTraceReader::firstTimestamp() const
+{
+    return m_minSuffix.isEmpty() ? 0 : m_minSuffix.first();
+}
+
+qint64 CANTraceReader::lastTimestamp() const
+{
+    return m_maxPrefix.isEmpty() ? 0 : m_maxPrefix.last();
+}
+
+/**
+ * @brief 按时间窗口和ID集合查询
+ */
+qint64 CANTraceReader::query(qint64 fromUs, qint64 toUs, const QVector<quint32> &ids,
+                             const RecordHandler &handler)
+{
+    m_lastStats = QueryStats();
+    m_lastStats.blocksTotal = m_blocks.size();
+
+    if (!m_file.isOpen()) {
+        m_lastError = "抓包文件未打开";
+        return -1;
+    }
+    if (fromUs > toUs) {
+        return 0;
+    }
+
+    // 记录中的frameId已去掉扩展帧/远程帧标志位，查询ID也先去掉，
+    // 块筛选和逐帧比较使用同一组ID
+    QVector<quint32> maskedIds(ids.size());
+    for (int i = 0; i < ids.size(); ++i) {
+        maskedIds[i] = ids[i] & CAN_TRACE_ID_MASK;
+    }
+
+    const int start = firstCandidate(fromUs);
+    m_lastStats.blocksSkippedTime = start;
+
+    bool stopped = false;
+    for (int i = start; i < m_blocks.size() && !stopped; ++i) {
+        // 之后所有块都晚于窗口，提前结束
+        if (m_minSuffix.at(i) > toUs) {
+            m_lastStats.blocksSkippedTime += m_blocks.size() - i;
+            break;
+        }
+
+        const CANTraceBlock &block = m_blocks.at(i);
+        if (block.maxUs < fromUs || block.minUs > toUs) {
+            m_lastStats.blocksSkippedTime++;
+            continue;
+        }
+
+        if (!maskedIds.isEmpty()) {
+            bool candidate = false;
+            for (quint32 id : maskedIds) {
+                if (block.mayContain(id)) {
+                    candidate = true;
+                    break;
+                }
+            }
+            if (!candidate) {
+                m_lastStats.blocksSkippedId++;
+                continue;
+            }
+        }
+
+        if (!readBlock(i, m_buffer)) {
+            return -1;
+        }
+        m_lastStats.blocksRead++;
+        m_lastStats.bytesRead += m_buffer.size();
+
+        const uchar *data = reinterpret_cast<const uchar *>(m_buffer.constData());
+        const qint64 size = m_buffer.size();
+        qint64 pos = 0;
+        CANTraceRecord record;
+        while (pos < size) {
+            int bytes = canTraceDecodeRecord(data + pos, size - pos, record);
+            if (bytes < 0) {
+                break;
+            }
+            pos += bytes;
+            m_lastStats.framesDecoded++;
+
+            if (record.timestampUs < fromUs || record.timestampUs > toUs) {
+                continue;
+            }
+            if (!maskedIds.isEmpty() && !maskedIds.contains(record.frameId)) {
+                continue;
+            }
+            m_lastStats.framesMatched++;
+            if (!handler(record)) {
+                stopped = true;
+                break;
+            }
+        }
+    }
+
+    return m_lastStats.framesMatched;
+}
+
+/**
+ * @brief 读取一个块
+ */
+bool CANTraceReader::readBlock(int index, QByteArray &buffer)
+{
+    if (index < 0 || index >= m_blocks.size()) {
+        m_lastError = QString("块序号越界: %1").arg(index);
+        return false;
+    }
+
+    if (!readBlock(m_file, m_blocks.at(index), buffer)) {
+        m_lastError = QString("读取块%1失败: %2").arg(index).arg(m_file.errorString());
+        qWarning() << "[CANTraceReader]" << m_lastError;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 用指定文件句柄读取块
+ */
+bool CANTraceReader::readBlock(QFile &file, const CANTraceBlock &block, QByteArray &buffer)
+{
+    buffer.resize(static_cast<int>(block.byteLength));
+    return file.seek(block.offset) &&
+           file.read(buffer.data(), buffer.size()) == buffer.size();
+}
+
+/**
+ * @brief 解码一个块的全部记录
+ */
+int CANTraceReader::decodeBlock(const QByteArray &buffer, const RecordHandler &handler)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(buffer.constData());
+    const qint64 size = buffer.size();
+    qint64 pos = 0;
+    int count = 0;
+    CANTraceRecord record;
+
+    while (pos < size) {
+        int bytes = canTraceDecodeRecord(data + pos, size - pos, record);
+        if (bytes < 0) {
+            break;
+        }
+        pos += bytes;
+        count++;
+        if (!handler(record)) {
+            break;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 加载旁路索引
+ * @return false表示索引不可用（需扫描重建）
+ */
+bool CANTraceReader::loadIndex(const QString &indexFile)
+{
+    QFile file(indexFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QByteArray header = file.read(CAN_TRACE_HEADER_SIZE);
+    if (header.size() != CAN_TRACE_HEADER_SIZE ||
+        memcmp(header.constData(), CAN_TRACE_INDEX_MAGIC, 8) != 0) {
+        return false;
+    }
+    const uchar *h = reinterpret_cast<const uchar *>(header.constData());
+    if (qFromLittleEndian<quint16>(h + 8) != CAN_TRACE_VERSION ||
+        qFromLittleEndian<quint16>(h + 12) != CAN_TRACE_BITMAP_BYTES) {
+        return false;
+    }
+
+    // blockCount为0表示写入器未正常关闭，按文件大小计算
+    qint64 count = qFromLittleEndian<quint32>(h + 16);
+    const qint64 available = (file.size() - CAN_TRACE_HEADER_SIZE) / CAN_TRACE_INDEX_ENTRY_SIZE;
+    if (count == 0 || count > available) {
+        count = available;
+    }
+
+    QByteArray entries = file.read(count * CAN_TRACE_INDEX_ENTRY_SIZE);
+    count = entries.size() / CAN_TRACE_INDEX_ENTRY_SIZE;
+    m_blocks.reserve(static_cast<int>(count));
+
+    // 条目必须首尾相接且不超出抓包文件，遇到不一致的条目即截断
+    qint64 expectedOffset = CAN_TRACE_HEADER_SIZE;
+    const uchar *p = reinterpret_cast<const uchar *>(entries.constData());
+    for (qint64 i = 0; i < count; ++i) {
+        CANTraceBlock block;
+        block.deserialize(p + i * CAN_TRACE_INDEX_ENTRY_SIZE);
+        if (block.offset != expectedOffset ||
+            block.offset + block.byteLength > m_fileSize ||
+            block.frameCount == 0) {
+            qWarning() << "[CANTraceReader] 索引条目" << i << "与抓包文件不一致，之后的数据扫描补全";
+            break;
+        }
+        expectedOffset += block.byteLength;
+        m_blocks.append(block);
+    }
+    return true;
+}
+
+/**
+ * @brief 扫描抓包文件区间，生成内存中的块索引
+ */
+bool CANTraceReader::scanRange(qint64 from, qint64 to)
+{
+    CANTraceBlock block;
+    block.offset = from;
+    qint64 pos = from;
+
+    while (pos < to) {
+        if (!m_file.seek(pos)) {
+            m_lastError = QString("定位失败: %1").arg(m_file.errorString());
+            return false;
+        }
+        QByteArray chunk = m_file.read(qMin<qint64>(SCAN_CHUNK_BYTES, to - pos));
+        if (chunk.isEmpty()) {
+            break;
+        }
+
+        const uchar *data = reinterpret_cast<const uchar *>(chunk.constData());
+        const qint64 size = chunk.size();
+        qint64 consumed = 0;
+        CANTraceRecord record;
+        while (consumed < size) {
+            int bytes = canTraceDecodeRecord(data + consumed, size - consumed, record);
+            if (bytes < 0) {
+                break;
+            }
+            block.account(record.timestampUs, record.frameId, bytes);
+            consumed += bytes;
+
+            if (block.byteLength >= static_cast<quint32>(SCAN_BLOCK_BYTES)) {
+                m_blocks.append(block);
+                block = CANTraceBlock();
+                block.offset = pos + consumed;
+            }
+        }
+
+        if (consumed == 0) {
+            // 剩余数据不足一条记录（写入中断）或格式错误
+            if (to - pos >= CAN_TRACE_MAX_RECORD) {
+                qWarning() << "[CANTraceReader] 偏移" << pos << "处记录格式错误，之后的数据忽略";
+            }
+            break;
+        }
+        pos += consumed;
+    }
+
+    if (block.frameCount > 0) {
+        m_blocks.append(block);
+    }
+    return true;
+}
+
+/**
+ * @brief 生成时间查找表
+ */
+void CANTraceReader::buildSearchTables()
+{
+    const int count = m_blocks.size();
+    m_maxPrefix.resize(count);
+    m_minSuffix.resize(count);
+
+    qint64 maxUs = 0;
+    for (int i = 0; i < count; ++i) {
+        maxUs = (i == 0) ? m_blocks.at(i).maxUs : qMax(maxUs, m_blocks.at(i).maxUs);
+        m_maxPrefix[i] = maxUs;
+    }
+
+    qint64 minUs = 0;
+    for (int i = count - 1; i >= 0; --i) {
+        minUs = (i == count - 1) ? m_blocks.at(i).minUs : qMin(minUs, m_blocks.at(i).minUs);
+        m_minSuffix[i] = minUs;
+    }
+}
+
+/**
+ * @brief 二分查找第一个可能含有fromUs之后数据的块
+ * @note 时间戳不保证严格单调，用maxUs前缀最大值保证结果正确
+ */
+int CANTraceReader::firstCandidate(qint64 fromUs) const
+{
+    int low = 0;
+    int high = m_maxPrefix.size();
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (m_maxPrefix.at(mid) < fromUs) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
@@ -0,0 +1,330 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTraceWriter.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 带旁路索引的CAN抓包写入器实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/can/CANTraceWriter.h"
+#include "drivers/can/CANBroadcastRing.h"
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <time.h>
+
+/***************************************************************
+ * 类名: CANTraceWriterThread
+ * 功能: 从广播环取帧写入抓包文件
+ ***************************************************************/
+class CANTraceWriterThread : public QThread
+{
+public:
+    explicit CANTraceWriterThread(CANTraceWriter *writer)
+        : m_writer(writer)
+    {
+        m_running.store(1);
+    }
+
+    void stop()
+    {
+        m_running.store(0);
+        m_writer->m_ring->wakeAll();
+        wait();
+    }
+
+protected:
+    void run() override
+    {
+        CANTraceWriter *writer = m_writer;
+        CANBroadcastRing *ring = writer->m_ring;
+        const int consumerId = writer->m_consumerId;
+        const qint64 checkpointMs = writer->m_checkpointUs / 1000;
+
+        QElapsedTimer blockAge;
+        blockAge.start();
+
+        auto handler = [writer](const CANRingEntry &entry) {
+            if (entry.frameType == QCanBusFrame::ErrorFrame ||
+                entry.frameType == QCanBusFrame::InvalidFrame) {
+                return;
+            }
+            quint32 canId = entry.frameId;
+            if (entry.flags & CANRingEntry::ExtendedFormat) {
+                canId |= CAN_TRACE_ID_EFF;
+            }
+            if (entry.frameType == QCanBusFrame::RemoteRequestFrame) {
+                canId |= CAN_TRACE_ID_RTR;
+            }
+            quint8 flags = 0;
+            if (entry.flags & CANRingEntry::FlexibleDataRate) {
+                flags |= CAN_TRACE_FLAG_FD;
+            }
+            if (entry.flags & CANRingEntry::BitrateSwitch) {
+                flags |= CAN_TRACE_FLAG_BRS;
+            }
+            writer->append(entry.timestampUs, canId, flags, entry.payload, entry.length);
+        };
+
+        while (m_running.load() != 0) {
+            ring->waitForData(consumerId, 100);
+
+            bool wasEmpty = writer->m_blockInfo.frameCount == 0;
+            while (ring->poll(consumerId, handler, 1024) > 0) {
+            }
+            if (wasEmpty && writer->m_blockInfo.frameCount > 0) {
+                blockAge.restart();
+            }
+
+            // 总线空闲时也按检查点间隔落盘，查询能及时看到最新数据
+            if (writer->m_blockInfo.frameCount > 0 && blockAge.elapsed() >= checkpointMs) {
+                writer->sealBlock();
+            }
+        }
+
+        // 停止前取完环中剩余的帧
+        while (ring->poll(consumerId, handler, 1024) > 0) {
+        }
+        writer->sealBlock();
+    }
+
+private:
+    CANTraceWriter *m_writer;
+    QAtomicInt m_running;
+};
+
+/**
+ * @brief 构造函数
+ */
+CANTraceWriter::CANTraceWriter()
+    : m_ring(nullptr)
+    , m_consumerId(-1)
+    , m_thread(nullptr)
+    , m_blockSize(64 * 1024)
+    , m_checkpointUs(1000000)
+    , m_fileOffset(0)
+{
+    m_framesWritten.store(0);
+    m_blocksWritten.store(0);
+    m_bytesWritten.store(0);
+    m_writeErrors.store(0);
+}
+
+/**
+ * @brief 析构函数
+ */
+CANTraceWriter::~CANTraceWriter()
+{
+    stop();
+}
+
+void CANTraceWriter::setBlockSize(int bytes)
+{
+    m_blockSize = qBound(4 * 1024, bytes, 4 * 1024 * 1024);
+}
+
+void CANTraceWriter::setCheckpointInterval(int msecs)
+{
+    m_checkpointUs = qMax(10, msecs) * 1000LL;
+}
+
+/**
+ * @brief 创建文件并开始写入
+ */
+bool CANTraceWriter::start(const QString &path, CANBroadcastRing *ring)
+{
+    stop();
+
+    if (!ring) {
+        m_lastError = "广播环未启用";
+        qWarning() << "[CANTraceWriter]" << m_lastError;
+        return false;
+    }
+
+    m_path = path;
+    m_traceFile.setFileName(path);
+    m_indexFile.setFileName(indexPath(path));
+
+    if (!m_traceFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_lastError = QString("无法创建抓包文件%1: %2").arg(path, m_traceFile.errorString());
+        qWarning() << "[CANTraceWriter]" << m_lastError;
+        return false;
+    }
+    if (!m_indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_lastError = QString("无法创建索引文件: %1").arg(m_indexFile.errorString());
+        qWarning() << "[CANTraceWriter]" << m_lastError;
+        m_traceFile.close();
+        return false;
+    }
+    if (!writeHeaders()) {
+        m_lastError = "写入文件头失败";
+        qWarning() << "[CANTraceWriter]" << m_lastError;
+        m_traceFile.close();
+        m_indexFile.close();
+        return false;
+    }
+
+    m_fileOffset = CAN_TRACE_HEADER_SIZE;
+    m_block.reserve(m_blockSize + CAN_TRACE_MAX_RECORD);
+    m_block.resize(0);
+    m_blockInfo = CANTraceBlock();
+    m_blockInfo.offset = m_fileOffset;
+
+    m_framesWritten.store(0);
+    m_blocksWritten.store(0);
+    m_bytesWritten.store(CAN_TRACE_HEADER_SIZE);
+    m_writeErrors.store(0);
+
+    m_ring = ring;
+    m_consumerId = ring->registerConsumer("CANTraceWriter");
+    if (m_consumerId < 0) {
+        m_lastError = "广播环消费者已满";
+        qWarning() << "[CANTraceWriter]" << m_lastError;
+        m_traceFile.close();
+        m_indexFile.close();
+        m_ring = nullptr;
+        return false;
+    }
+
+    m_thread = new CANTraceWriterThread(this);
+    m_thread->start();
+
+    qInfo() << "[CANTraceWriter] 开始抓包:" << path << "块大小:" << m_blockSize
+            << "检查点间隔:" << m_checkpointUs / 1000 << "ms";
+    return true;
+}
+
+/**
+ * @brief 停止写入并关闭文件
+ */
+void CANTraceWriter::stop()
+{
+    if (!m_thread) {
+        return;
+    }
+
+    m_thread->stop();
+    delete m_thread;
+    m_thread = nullptr;
+
+    m_ring->unregisterConsumer(m_consumerId);
+    m_ring = nullptr;
+    m_consumerId = -1;
+
+    // 写入块数，标记正常关闭
+    uchar count[4];
+    qToLittleEndian<quint32>(static_cast<quint32>(m_blocksWritten.load()), count);
+    if (m_indexFile.seek(16)) {
+        m_indexFile.write(reinterpret_cast<const char *>(count), 4);
+    }
+
+    m_traceFile.close();
+    m_indexFile.close();
+
+    qInfo() << "[CANTraceWriter] 抓包结束:" << m_path << "帧数:" << m_framesWritten.load()
+            << "块数:" << m_blocksWritten.load() << "字节:" << m_bytesWritten.load();
+}
+
+quint64 CANTraceWriter::getLag() const
+{
+    return m_ring ? m_ring->getLag(m_consumerId) : 0;
+}
+
+/**
+ * @brief 追加一条记录
+ */
+void CANTraceWriter::append(qint64 timestampUs, quint32 canId, quint8 flags,
+                            const uchar *data, int length)
+{
+    length = qBound(0, length, 64);
+
+    // 时间跨度达到检查点间隔时先封块，保证每个块的时间范围有界
+    if (m_blockInfo.frameCount > 0 && timestampUs - m_blockInfo.minUs >= m_checkpointUs) {
+        sealBlock();
+    }
+
+    const int offset = m_block.size();
+    m_block.resize(offset + CAN_TRACE_RECORD_HEADER + length);
+    int bytes = canTraceEncodeRecord(reinterpret_cast<uchar *>(m_block.data()) + offset,
+                                     timestampUs, canId, flags, data, length);
+    m_blockInfo.account(timestampUs, canId & CAN_TRACE_ID_MASK, bytes);
+
+    if (m_block.size() >= m_blockSize) {
+        sealBlock();
+    }
+}
+
+/**
+ * @brief 封块
+ */
+void CANTraceWriter::sealBlock()
+{
+    if (m_blockInfo.frameCount == 0) {
+        return;
+    }
+
+    uchar entry[CAN_TRACE_INDEX_ENTRY_SIZE];
+    m_blockInfo.serialize(entry);
+
+    // 先写块数据再写索引条目，索引中的块一定完整
+    qint64 written = m_traceFile.write(m_block.constData(), m_block.size());
+    if (written == m_block.size() && m_traceFile.flush()) {
+        m_indexFile.write(reinterpret_cast<const char *>(entry), CAN_TRACE_INDEX_ENTRY_SIZE);
+        m_indexFile.flush();
+
+        m_fileOffset += m_block.size();
+        m_framesWritten.fetchAndAddRelaxed(m_blockInfo.frameCount);
+        m_blocksWritten.ref();
+        m_bytesWritten.fetchAndAddRelaxed(static_cast<quint64>(m_block.size()));
+    } else {
+        // 磁盘满等错误：丢弃本块，文件偏移按实际写入量推进
+        quint64 errors = m_writeErrors.fetchAndAddRelaxed(1) + 1;
+        if (written > 0) {
+            m_fileOffset += written;
+        }
+        if (errors == 1 || errors % 100 == 0) {
+            qWarning() << "[CANTraceWriter] 写入失败:" << m_traceFile.errorString()
+                       << "累计" << errors << "次";
+        }
+    }
+
+    m_block.resize(0);
+    m_blockInfo = CANTraceBlock();
+    m_blockInfo.offset = m_fileOffset;
+}
+
+/**
+ * @brief 写入抓包与索引文件头
+ */
+bool CANTraceWriter::writeHeaders()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    const qint64 createdUs = static_cast<qint64>(ts.tv_sec) * 1000000LL + ts.tv_nsec / 1000;
+
+    uchar header[CAN_TRACE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, CAN_TRACE_MAGIC, 8);
+    qToLittleEndian<quint16>(CAN_TRACE_VERSION, header + 8);
+    qToLittleEndian<quint16>(CAN_TRACE_HEADER_SIZE, header + 10);
+    qToLittleEndian<quint64>(static_cast<quint64>(createdUs), header + 16);
+    if (m_traceFile.write(reinterpret_cast<const char *>(header), sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, CAN_TRACE_INDEX_MAGIC, 8);
+    qToLittleEndian<quint16>(CAN_TRACE_VERSION, header + 8);
+    qToLittleEndian<quint16>(CAN_TRACE_HEADER_SIZE, header + 10);
+    qToLittleEndian<quint16>(CAN_TRACE_BITMAP_BYTES, header + 12);
+    // blockCount（偏移16）在stop()中写入
+    if (m_indexFile.write(reinterpret_cast<const char *>(header), sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+
+    return m_traceFile.flush() && m_indexFile.flush();
+}
@@ -0,0 +1,697 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTunnel.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN-over-UDP隧道实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/can/CANTunnel.h"
+#include "drivers/can/DriverCAN.h"
+#include "drivers/can/DriverCANHighPerf.h"
+#include "drivers/can/CANBroadcastRing.h"
+#include <QThread>
+#include <QtEndian>
+#include <QTextStream>
+#include <QDebug>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#define TUNNEL_MAGIC            0x4354      // "CT"
+#define TUNNEL_VERSION          1
+#define TUNNEL_HEADER_SIZE      20
+#define TUNNEL_RECORD_SIZE      10          // 不含数据的帧记录长度
+#define TUNNEL_MAX_DATAGRAM     65000
+#define TUNNEL_MIN_DATAGRAM     128         // 至少容纳头部+一帧CAN FD
+#define TUNNEL_SOCKET_BUFFER    (256 * 1024)
+#define TUNNEL_RESYNC_WINDOW    1024        // 序号倒退超过该值视为对端重启
+#define TUNNEL_MAX_RX_PER_EVENT 64          // 每次通知最多读取的数据报数
+
+// 帧记录中的can_id标志位（与socketcan一致）
+#define TUNNEL_ID_EFF           0x80000000U
+#define TUNNEL_ID_RTR           0x40000000U
+#define TUNNEL_ID_MASK          0x1FFFFFFFU
+
+// 帧记录中的flags
+#define TUNNEL_FLAG_FD          0x01
+#define TUNNEL_FLAG_BRS         0x02
+#define TUNNEL_FLAG_ESI         0x04
+
+/***************************************************************
+ * 类名: CANTunnelThread
+ * 功能: 从广播环批量取帧并按大小/期限发送
+ ***************************************************************/
+class CANTunnelThread : public QThread
+{
+public:
+    explicit CANTunnelThread(CANTunnel *tunnel)
+        : m_tunnel(tunnel)
+    {
+        m_running.store(1);
+    }
+
+    void stop()
+    {
+        m_running.store(0);
+        m_tunnel->m_ring->wakeAll();
+        wait();
+    }
+
+protected:
+    void run() override
+    {
+        CANBroadcastRing *ring = m_tunnel->m_ring;
+        const int consumerId = m_tunnel->m_consumerId;
+        const qint64 deadlineUs = m_tunnel->m_flushDeadlineUs;
+        CANTunnel *tunnel = m_tunnel;
+
+        while (m_running.load() != 0) {
+            // 按缓冲中最早一帧的剩余期限决定等待时间
+            unsigned long waitMs = 100;
+            qint64 ageUs = tunnel->pendingAgeUs();
+            if (ageUs >= 0) {
+                qint64 remainUs = deadlineUs - ageUs;
+                if (remainUs <= 0) {
+                    tunnel->flush(CANTunnel::FlushDeadline);
+                    continue;
+                }
+                if (remainUs < 1000) {
+                    // 不足1ms时条件变量精度不够，直接睡到期限再取帧
+                    struct timespec ts;
+                    ts.tv_sec = 0;
+                    ts.tv_nsec = static_cast<long>(remainUs * 1000);
+                    clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, nullptr);
+                    waitMs = 0;
+                } else {
+                    waitMs = static_cast<unsigned long>(remainUs / 1000);
+                }
+            }
+
+            if (waitMs > 0 && !ring->waitForData(consumerId, waitMs)) {
+                continue;
+            }
+
+            int count = ring->poll(consumerId, [tunnel](const CANRingEntry &entry) {
+                if (entry.frameType == QCanBusFrame::ErrorFrame ||
+                    entry.frameType == QCanBusFrame::InvalidFrame) {
+                    return;
+                }
+                quint32 canId = entry.frameId;
+                if (entry.flags & CANRingEntry::ExtendedFormat) {
+                    canId |= TUNNEL_ID_EFF;
+                }
+                if (entry.frameType == QCanBusFrame::RemoteRequestFrame) {
+                    canId |= TUNNEL_ID_RTR;
+                }
+                quint8 flags = 0;
+                if (entry.flags & CANRingEntry::FlexibleDataRate) {
+                    flags |= TUNNEL_FLAG_FD;
+                }
+                if (entry.flags & CANRingEntry::BitrateSwitch) {
+                    flags |= TUNNEL_FLAG_BRS;
+                }
+                tunnel->appendFrame(canId, flags,
+                                    reinterpret_cast<const char *>(entry.payload),
+                                    entry.length, entry.timestampUs);
+            }, 256);
+
+            // 期限为0时每批立即发送
+            if (count > 0 && deadlineUs == 0) {
+                tunnel->flush(CANTunnel::FlushDeadline);
+            }
+        }
+    }
+
+private:
+    CANTunnel *m_tunnel;
+    QAtomicInt m_running;
+};
+
+/**
+ * @brief 构造函数
+ */
+CANTunnel::CANTunnel(DriverCAN *can, QObject *parent)
+    : QObject(parent)
+    , m_can(can)
+    , m_ring(nullptr)
+    , m_consumerId(-1)
+    , m_thread(nullptr)
+    , m_flushTimer(new QTimer(this))
+    , m_socketFd(-1)
+    , m_readNotifier(nullptr)
+    , m_maxDatagramSize(1400)
+    , m_flushDeadlineUs(2000)
+    , m_forwardLocal(true)
+    , m_injectRemote(true)
+    , m_txFrames(0)
+    , m_txBaseUs(0)
+    , m_txFirstNs(0)
+    , m_txSequence(0)
+    , m_rxExpected(0)
+    , m_rxSynced(false)
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_flushTimer, &QTimer::timeout, this, &CANTunnel::onFlushTimeout);
+
+    m_clock.start();
+    resetStats();
+}
+
+/**
+ * @brief 析构函数
+ */
+CANTunnel::~CANTunnel()
+{
+    stop();
+}
+
+void CANTunnel::setMaxDatagramSize(int bytes)
+{
+    m_maxDatagramSize = qBound(TUNNEL_MIN_DATAGRAM, bytes, TUNNEL_MAX_DATAGRAM);
+}
+
+void CANTunnel::setFlushDeadline(int usecs)
+{
+    m_flushDeadlineUs = qMax(0, usecs);
+}
+
+void CANTunnel::setDirection(bool forwardLocal, bool injectRemote)
+{
+    m_forwardLocal = forwardLocal;
+    m_injectRemote = injectRemote;
+}
+
+/**
+ * @brief 启动隧道
+ */
+bool CANTunnel::start(quint16 localPort, const QHostAddress &peerAddress, quint16 peerPort)
+{
+    stop();
+
+    if (!m_can || !m_can->isOpen()) {
+        setError("本地CAN接口未打开");
+        return false;
+    }
+
+    // 按对端地址族创建套接字并绑定本地端口
+    const bool ipv6 = peerAddress.protocol() == QAbstractSocket::IPv6Protocol;
+    int fd = ::socket(ipv6 ? AF_INET6 : AF_INET,
+                      SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        setError(QString("创建UDP套接字失败: %1").arg(strerror(errno)));
+        return false;
+    }
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    int bufferSize = TUNNEL_SOCKET_BUFFER;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+    struct sockaddr_storage local;
+    struct sockaddr_storage peer;
+    socklen_t addrLen;
+    memset(&local, 0, sizeof(local));
+    memset(&peer, 0, sizeof(peer));
+
+    if (ipv6) {
+        struct sockaddr_in6 *l = reinterpret_cast<struct sockaddr_in6 *>(&local);
+        struct sockaddr_in6 *p = reinterpret_cast<struct sockaddr_in6 *>(&peer);
+        l->sin6_family = AF_INET6;
+        l->sin6_addr = in6addr_any;
+        l->sin6_port = htons(localPort);
+        p->sin6_family = AF_INET6;
+        Q_IPV6ADDR addr = peerAddress.toIPv6Address();
+        memcpy(&p->sin6_addr, &addr, sizeof(p->sin6_addr));
+        p->sin6_port = htons(peerPort);
+        addrLen = sizeof(struct sockaddr_in6);
+    } else {
+        struct sockaddr_in *l = reinterpret_cast<struct sockaddr_in *>(&local);
+        struct sockaddr_in *p = reinterpret_cast<struct sockaddr_in *>(&peer);
+        l->sin_family = AF_INET;
+        l->sin_addr.s_addr = htonl(INADDR_ANY);
+        l->sin_port = htons(localPort);
+        p->sin_family = AF_INET;
+        p->sin_addr.s_addr = htonl(peerAddress.toIPv4Address());
+        p->sin_port = htons(peerPort);
+        addrLen = sizeof(struct sockaddr_in);
+    }
+
+    if (::bind(fd, reinterpret_cast<struct sockaddr *>(&local), addrLen) < 0) {
+        setError(QString("绑定端口%1失败: %2").arg(localPort).arg(strerror(errno)));
+        ::close(fd);
+        return false;
+    }
+
+    // connect后只接收对端的数据报，发送可直接用send()
+    if (::connect(fd, reinterpret_cast<struct sockaddr *>(&peer), addrLen) < 0) {
+        setError(QString("连接对端%1:%2失败: %3")
+                 .arg(peerAddress.toString()).arg(peerPort).arg(strerror(errno)));
+        ::close(fd);
+        return false;
+    }
+
+    m_socketFd = fd;
+
+    // 发送缓冲预留容量，之后不再分配内存
+    m_txBuffer.reserve(m_maxDatagramSize);
+    m_txBuffer.resize(0);
+    m_txFrames = 0;
+    m_rxBuffer.resize(TUNNEL_MAX_DATAGRAM + 1);
+    m_rxSynced = false;
+
+    if (m_injectRemote) {
+        m_readNotifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(m_readNotifier, &QSocketNotifier::activated, this, &CANTunnel::onSocketReadable);
+    }
+
+    if (m_forwardLocal) {
+        DriverCANHighPerf *highPerf = qobject_cast<DriverCANHighPerf *>(m_can);
+        if (highPerf) {
+            // 高性能驱动：广播环消费者+隧道线程，不经过Qt信号
+            m_ring = highPerf->getBroadcastRing();
+            if (!m_ring) {
+                m_ring = highPerf->enableBroadcastRing();
+            }
+            m_consumerId = m_ring->registerConsumer("CANTunnel");
+        }
+
+        if (m_consumerId >= 0) {
+            m_thread = new CANTunnelThread(this);
+            m_thread->start(QThread::HighPriority);
+        } else {
+            m_ring = nullptr;
+            connect(m_can, &DriverCAN::frameReceived, this, &CANTunnel::onFrameReceived);
+        }
+    }
+
+    qInfo() << "[CANTunnel]" << m_can->getInterfaceName() << "隧道已启动，本地端口:" << localPort
+            << "对端:" << peerAddress.toString() << ":" << peerPort
+            << "数据报上限:" << m_maxDatagramSize << "刷新期限:" << m_flushDeadlineUs << "us"
+            << (m_thread ? "(广播环)" : "(信号)");
+    return true;
+}
+
+/**
+ * @brief 停止隧道
+ */
+void CANTunnel::stop()
+{
+    if (m_socketFd < 0) {
+        return;
+    }
+
+    if (m_thread) {
+        m_thread->stop();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+
+    if (m_ring) {
+        m_ring->unregisterConsumer(m_consumerId);
+        m_ring = nullptr;
+        m_consumerId = -1;
+    }
+
+    disconnect(m_can, &DriverCAN::frameReceived, this, &CANTunnel::onFrameReceived);
+    m_flushTimer->stop();
+
+    // 线程已停止，剩余的帧由当前线程发出
+    flush(FlushStop);
+
+    if (m_readNotifier) {
+        m_readNotifier->setEnabled(false);
+        delete m_readNotifier;
+        m_readNotifier = nullptr;
+    }
+
+    ::close(m_socketFd);
+    m_socketFd = -1;
+
+    qInfo() << "[CANTunnel] 隧道已停止，已发送" << m_framesSent.load() << "帧，已接收"
+            << m_rxStats.framesReceived << "帧";
+}
+
+/**
+ * @brief 本地帧（普通模式，主线程）
+ */
+void CANTunnel::onFrameReceived(const QCanBusFrame &frame)
+{
+    if (frame.frameType() == QCanBusFrame::ErrorFrame || frame.hasLocalEcho()) {
+        return;
+    }
+
+    quint32 canId = frame.frameId();
+    if (frame.hasExtendedFrameFormat()) {
+        canId |= TUNNEL_ID_EFF;
+    }
+    if (frame.frameType() == QCanBusFrame::RemoteRequestFrame) {
+        canId |= TUNNEL_ID_RTR;
+    }
+    quint8 flags = 0;
+    if (frame.hasFlexibleDataRateFormat()) {
+        flags |= TUNNEL_FLAG_FD;
+    }
+    if (frame.hasBitrateSwitch()) {
+        flags |= TUNNEL_FLAG_BRS;
+    }
+    if (frame.hasErrorStateIndicator()) {
+        flags |= TUNNEL_FLAG_ESI;
+    }
+
+    const QCanBusFrame::TimeStamp stamp = frame.timeStamp();
+    qint64 timestampUs = stamp.seconds() * 1000000LL + stamp.microSeconds();
+    if (timestampUs == 0) {
+        timestampUs = realtimeUs();
+    }
+
+    const QByteArray payload = frame.payload();
+    bool started = appendFrame(canId, flags, payload.constData(), payload.size(), timestampUs);
+
+    if (m_flushDeadlineUs == 0) {
+        flush(FlushDeadline);
+    } else if (started && m_txFrames > 0) {
+        m_flushTimer->start(qMax(1, (m_flushDeadlineUs + 999) / 1000));
+    }
+}
+
+/**
+ * @brief 刷新期限到（普通模式）
+ */
+void CANTunnel::onFlushTimeout()
+{
+    flush(FlushDeadline);
+}
+
+/**
+ * @brief 追加一帧到发送缓冲
+ */
+bool CANTunnel::appendFrame(quint32 canId, quint8 flags, const char *data, int length,
+                            qint64 timestampUs)
+{
+    length = qBound(0, length, 64);
+    const int recordSize = TUNNEL_RECORD_SIZE + length;
+
+    // 放不下时先发送当前缓冲
+    if (m_txFrames > 0 && m_txBuffer.size() + recordSize > m_maxDatagramSize) {
+        flush(FlushSize);
+    }
+
+    bool started = false;
+    if (m_txFrames == 0) {
+        // 头部占位，序号和帧数在发送时填写
+        m_txBuffer.resize(TUNNEL_HEADER_SIZE);
+        uchar *header = reinterpret_cast<uchar *>(m_txBuffer.data());
+        qToBigEndian<quint16>(TUNNEL_MAGIC, header);
+        header[2] = TUNNEL_VERSION;
+        header[3] = 0;
+        qToBigEndian<quint64>(static_cast<quint64>(timestampUs), header + 8);
+        header[18] = 0;
+        header[19] = 0;
+        m_txBaseUs = timestampUs;
+        m_txFirstNs = m_clock.nsecsElapsed();
+        started = true;
+    }
+
+    // 时间戳偏移（内核时间戳偶有倒退时取0）
+    qint64 delta = qBound(Q_INT64_C(0), timestampUs - m_txBaseUs, Q_INT64_C(0xFFFFFFFF));
+
+    const int offset = m_txBuffer.size();
+    m_txBuffer.resize(offset + recordSize);
+    uchar *record = reinterpret_cast<uchar *>(m_txBuffer.data()) + offset;
+    qToBigEndian<quint32>(static_cast<quint32>(delta), record);
+    qToBigEndian<quint32>(canId, record + 4);
+    record[8] = flags;
+    record[9] = static_cast<uchar>(length);
+    if (length > 0) {
+        memcpy(record + TUNNEL_RECORD_SIZE, data, static_cast<size_t>(length));
+    }
+    m_txFrames++;
+
+    // 连一个空帧记录都放不下时立即发送
+    if (m_txBuffer.size() + TUNNEL_RECORD_SIZE > m_maxDatagramSize) {
+        flush(FlushSize);
+    }
+
+    return started;
+}
+
+/**
+ * @brief 发送缓冲中的帧
+ */
+void CANTunnel::flush(Flush reason)
+{
+    if (m_txFrames == 0) {
+        return;
+    }
+
+    // 普通模式下定时器只能在主线程操作
+    if (!m_thread && reason != FlushDeadline) {
+        m_flushTimer->stop();
+    }
+
+    uchar *header = reinterpret_cast<uchar *>(m_txBuffer.data());
+    qToBigEndian<quint32>(m_txSequence, header + 4);
+    qToBigEndian<quint16>(static_cast<quint16>(m_txFrames), header + 16);
+
+    ssize_t sent = ::send(m_socketFd, m_txBuffer.constData(),
+                          static_cast<size_t>(m_txBuffer.size()), MSG_DONTWAIT);
+    if (sent == m_txBuffer.size()) {
+        m_datagramsSent.ref();
+        m_framesSent.fetchAndAddRelaxed(static_cast<quint64>(m_txFrames));
+        m_bytesSent.fetchAndAddRelaxed(static_cast<quint64>(sent));
+        if (reason == FlushSize) {
+            m_sizeFlushes.ref();
+        } else if (reason == FlushDeadline) {
+            m_deadlineFlushes.ref();
+        }
+    } else {
+        // 对端未启动时会收到ECONNREFUSED，按间隔告警避免刷屏
+        quint64 errors = m_sendErrors.fetchAndAddRelaxed(1) + 1;
+        m_framesDropped.fetchAndAddRelaxed(static_cast<quint64>(m_txFrames));
+        if (errors == 1 || errors % 1000 == 0) {
+            qWarning() << "[CANTunnel] 数据报发送失败:" << strerror(errno)
+                       << "累计" << errors << "次";
+        }
+    }
+
+    // 序号按数据报递增，发送失败也占用序号，对端据此统计丢失
+    m_txSequence++;
+    m_txBuffer.resize(0);
+    m_txFrames = 0;
+}
+
+/**
+ * @brief 缓冲中最早一帧已等待的微秒数
+ */
+qint64 CANTunnel::pendingAgeUs() const
+{
+    if (m_txFrames == 0) {
+        return -1;
+    }
+    return (m_clock.nsecsElapsed() - m_txFirstNs) / 1000;
+}
+
+/**
+ * @brief 套接字可读
+ */
+void CANTunnel::onSocketReadable()
+{
+    for (int i = 0; i < TUNNEL_MAX_RX_PER_EVENT; ++i) {
+        ssize_t size = ::recv(m_socketFd, m_rxBuffer.data(),
+                              static_cast<size_t>(m_rxBuffer.size()), MSG_DONTWAIT);
+        if (size < 0) {
+            // ECONNREFUSED是本端发送时对端不可达的ICMP回报，忽略
+            break;
+        }
+        unpackDatagram(m_rxBuffer.constData(), static_cast<int>(size));
+    }
+}
+
+/**
+ * @brief 解析数据报并写入本地接口
+ */
+void CANTunnel::unpackDatagram(const char *data, int size)
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+
+    if (size < TUNNEL_HEADER_SIZE || size > TUNNEL_MAX_DATAGRAM ||
+        qFromBigEndian<quint16>(bytes) != TUNNEL_MAGIC || bytes[2] != TUNNEL_VERSION) {
+        m_rxStats.decodeErrors++;
+        return;
+    }
+
+    const quint32 sequence = qFromBigEndian<quint32>(bytes + 4);
+    const qint64 baseUs = static_cast<qint64>(qFromBigEndian<quint64>(bytes + 8));
+    const int frameCount = qFromBigEndian<quint16>(bytes + 16);
+
+    // 序号检查：跳变记为丢失，小幅倒退为重复/乱序，大幅倒退视为对端重启
+    if (m_rxSynced && sequence != m_rxExpected) {
+        qint32 diff = static_cast<qint32>(sequence - m_rxExpected);
+        if (diff < 0 && diff > -TUNNEL_RESYNC_WINDOW) {
+            m_rxStats.lateDatagrams++;
+            return;
+        }
+        if (diff > 0) {
+            m_rxStats.sequenceGaps += static_cast<quint64>(diff);
+            emit sequenceGap(m_rxExpected, sequence);
+        } else {
+            qInfo() << "[CANTunnel] 对端序号重置:" << m_rxExpected << "->" << sequence;
+        }
+    }
+
+    // 先完整解析，格式错误时整个数据报丢弃
+    QVector<QCanBusFrame> frames;
+    frames.reserve(frameCount);
+    int offset = TUNNEL_HEADER_SIZE;
+    for (int i = 0; i < frameCount; ++i) {
+        if (offset + TUNNEL_RECORD_SIZE > size) {
+            m_rxStats.decodeErrors++;
+            return;
+        }
+        const uchar *record = bytes + offset;
+        const quint32 delta = qFromBigEndian<quint32>(record);
+        const quint32 canId = qFromBigEndian<quint32>(record + 4);
+        const quint8 flags = record[8];
+        const int length = record[9];
+        const bool fd = (flags & TUNNEL_FLAG_FD) != 0;
+        if (length > (fd ? 64 : 8) || offset + TUNNEL_RECORD_SIZE + length > size) {
+            m_rxStats.decodeErrors++;
+            return;
+        }
+
+        QCanBusFrame frame(canId & TUNNEL_ID_MASK,
+                           QByteArray(data + offset + TUNNEL_RECORD_SIZE, length));
+        frame.setExtendedFrameFormat((canId & TUNNEL_ID_EFF) != 0);
+        if (canId & TUNNEL_ID_RTR) {
+            frame.setFrameType(QCanBusFrame::RemoteRequestFrame);
+        }
+        if (fd) {
+            frame.setFlexibleDataRateFormat(true);
+            frame.setBitrateSwitch((flags & TUNNEL_FLAG_BRS) != 0);
+            frame.setErrorStateIndicator((flags & TUNNEL_FLAG_ESI) != 0);
+        }
+        frame.setTimeStamp(QCanBusFrame::TimeStamp::fromMicroSeconds(baseUs + delta));
+        frames.append(frame);
+
+        offset += TUNNEL_RECORD_SIZE + length;
+    }
+
+    m_rxSynced = true;
+    m_rxExpected = sequence + 1;
+    m_rxStats.datagramsReceived++;
+    m_rxStats.framesReceived += static_cast<quint64>(frames.size());
+
+    if (!frames.isEmpty()) {
+        qint64 latency = realtimeUs() - frames.last().timeStamp().seconds() * 1000000LL
+                         - frames.last().timeStamp().microSeconds();
+        m_rxStats.lastLatencyUs = latency;
+        m_rxStats.maxLatencyUs = qMax(m_rxStats.maxLatencyUs, latency);
+    }
+
+    if (m_injectRemote && m_can->isOpen()) {
+        for (const QCanBusFrame &frame : frames) {
+            if (m_can->writeFrame(frame)) {
+                m_rxStats.framesInjected++;
+            } else {
+                m_rxStats.injectErrors++;
+            }
+        }
+    }
+
+    emit framesReceived(frames);
+}
+
+/**
+ * @brief 获取统计
+ */
+CANTunnelStats CANTunnel::getStats() const
+{
+    CANTunnelStats stats = m_rxStats;
+    stats.datagramsSent = m_datagramsSent.load();
+    stats.framesSent = m_framesSent.load();
+    stats.bytesSent = m_bytesSent.load();
+    stats.sizeFlushes = m_sizeFlushes.load();
+    stats.deadlineFlushes = m_deadlineFlushes.load();
+    stats.sendErrors = m_sendErrors.load();
+    stats.framesDropped = m_framesDropped.load();
+    return stats;
+}
+
+/**
+ * @brief 重置统计
+ */
+void CANTunnel::resetStats()
+{
+    m_datagramsSent.store(0);
+    m_framesSent.store(0);
+    m_bytesSent.store(0);
+    m_sizeFlushes.store(0);
+    m_deadlineFlushes.store(0);
+    m_sendErrors.store(0);
+    m_framesDropped.store(0);
+    m_rxStats = CANTunnelStats();
+}
+
+/**
+ * @brief 生成隧道统计报告
+ */
+QString CANTunnel::generateReport() const
+{
+    CANTunnelStats stats = getStats();
+
+    QString report;
+    QTextStream out(&report);
+
+    out << "========================================\n";
+    out << "  CAN Tunnel: " << (m_can ? m_can->getInterfaceName() : QString("-")) << "\n";
+    out << "========================================\n";
+    out << "Running:         " << (isRunning() ? "yes" : "no") << "\n";
+    out << "Max datagram:    " << m_maxDatagramSize << " bytes\n";
+    out << "Flush deadline:  " << m_flushDeadlineUs << " us\n";
+    out << "Source:          " << (m_thread ? "broadcast ring" : "signal") << "\n";
+    out << "---------------- TX --------------------\n";
+    out << "Datagrams:       " << stats.datagramsSent << "\n";
+    out << "Frames:          " << stats.framesSent << "\n";
+    out << "Bytes:           " << stats.bytesSent << "\n";
+    out << "Frames/datagram: " << QString::number(stats.framesPerDatagram(), 'f', 1) << "\n";
+    out << "Size flushes:    " << stats.sizeFlushes << "\n";
+    out << "Deadline flushes:" << stats.deadlineFlushes << "\n";
+    out << "Send errors:     " << stats.sendErrors << " (" << stats.framesDropped << " frames)\n";
+    out << "---------------- RX --------------------\n";
+    out << "Datagrams:       " << stats.datagramsReceived << "\n";
+    out << "Frames:          " << stats.framesReceived << "\n";
+    out << "Injected:        " << stats.framesInjected << "\n";
+    out << "Inject errors:   " << stats.injectErrors << "\n";
+    out << "Sequence gaps:   " << stats.sequenceGaps << "\n";
+    out << "Late/duplicate:  " << stats.lateDatagrams << "\n";
+    out << "Decode errors:   " << stats.decodeErrors << "\n";
+    out << "Latency:         " << stats.lastLatencyUs << " us (max " << stats.maxLatencyUs << " us)\n";
+    out << "========================================\n";
+
+    return report;
+}
+
+void CANTunnel::setError(const QString &error)
+{
+    m_lastError = error;
+    qWarning() << "[CANTunnel]" << error;
+    emit errorOccurred(error);
+}
+
+qint64 CANTunnel::realtimeUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000LL + ts.tv_nsec / 1000;
+}
@@ -0,0 +1,419 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANTxScheduler.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN发送调度器实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/can/CANTxScheduler.h"
+#include <QTextStream>
+#include <QDebug>
+
+/**
+ * @brief 构造函数
+ */
+CANTxScheduler::CANTxScheduler(int maxInFlight, QObject *parent)
+    : QObject(parent)
+    , m_device(nullptr)
+    , m_defaultPriority(Normal)
+    , m_maxInFlight(qMax(1, maxInFlight))
+    , m_inFlight(0)
+    , m_maxQueueDepth(1000)  // 默认每级最多排队1000帧
+    , m_echoTracking(true)
+    , m_echoTimeoutCount(0)
+    , m_pumping(false)
+{
+    m_clock.start();
+
+    m_echoTimer = new QTimer(this);
+    m_echoTimer->setSingleShot(true);
+    m_echoTimer->setInterval(200);  // 默认200ms未收到回显视为丢失
+    connect(m_echoTimer, &QTimer::timeout, this, &CANTxScheduler::onEchoTimeout);
+
+    m_retryTimer = new QTimer(this);
+    m_retryTimer->setSingleShot(true);
+    m_retryTimer->setInterval(1);   // 内核队列满（ENOBUFS）时1ms后重试
+    connect(m_retryTimer, &QTimer::timeout, this, &CANTxScheduler::pump);
+
+    qInfo() << "[CANTxScheduler] 创建发送调度器，最大在途帧数:" << m_maxInFlight;
+}
+
+/**
+ * @brief 析构函数
+ */
+CANTxScheduler::~CANTxScheduler()
+{
+    setDevice(nullptr);
+}
+
+/**
+ * @brief 绑定底层CAN设备
+ */
+void CANTxScheduler::setDevice(QCanBusDevice *device)
+{
+    if (m_device == device) {
+        return;
+    }
+
+    if (m_device) {
+        disconnect(m_device, nullptr, this, nullptr);
+    }
+
+    m_device = device;
+    m_inFlight = 0;
+    m_echoTimer->stop();
+    m_retryTimer->stop();
+
+    if (m_device) {
+        connect(m_device, &QCanBusDevice::framesWritten,
+                this, &CANTxScheduler::onFramesWritten);
+    }
+}
+
+// ========== 入队 ==========
+
+/**
+ * @brief 按指定优先级入队
+ */
+bool CANTxScheduler::enqueue(const QCanBusFrame &frame, Priority priority)
+{
+    if (priority < Emergency || priority >= PriorityCount) {
+        priority = m_defaultPriority;
+    }
+
+    QQueue<PendingFrame> &queue = m_queues[priority];
+    CANTxClassStats &stats = m_stats[priority];
+
+    if (queue.size() >= m_maxQueueDepth) {
+        stats.dropped++;
+        if (stats.dropped % 100 == 1) {
+            qWarning() << "[CANTxScheduler]" << priorityToString(priority)
+                       << "队列已满，已拒绝" << stats.dropped << "帧";
+        }
+        emit queueFull(priority);
+        return false;
+    }
+
+    PendingFrame pending;
+    pending.frame = frame;
+    pending.enqueueNs = m_clock.nsecsElapsed();
+    queue.enqueue(pending);
+
+    stats.queued++;
+    stats.depth = queue.size();
+    if (stats.depth > stats.maxDepth) {
+        stats.maxDepth = stats.depth;
+    }
+
+    pump();
+    return true;
+}
+
+/**
+ * @brief 按ID优先级规则自动归类后入队
+ */
+bool CANTxScheduler::enqueue(const QCanBusFrame &frame)
+{
+    return enqueue(frame, classify(frame.frameId()));
+}
+
+/**
+ * @brief 根据ID规则计算帧的优先级
+ */
+CANTxScheduler::Priority CANTxScheduler::classify(quint32 frameId) const
+{
+    for (const IdRule &rule : m_idRules) {
+        if (frameId >= rule.idFrom && frameId <= rule.idTo) {
+            return rule.priority;
+        }
+    }
+    return m_defaultPriority;
+}
+
+// ========== 调度 ==========
+
+/**
+ * @brief 尝试发送排队帧
+ *
+ * 每次从最高优先级的非空队列取队首帧交给内核，直到在途额度用完。
+ * 在途帧数限制了内核发送队列的深度，新到的高优先级帧最多只需等待
+ * maxInFlight个帧的总线时间，而不是整个低优先级积压。
+ */
+void CANTxScheduler::pump()
+{
+    if (!m_device || m_device->state() != QCanBusDevice::ConnectedState) {
+        return;
+    }
+
+    // writeFrame可能同步发出framesWritten，防止重入
+    if (m_pumping) {
+        return;
+    }
+    m_pumping = true;
+
+    while (m_inFlight < m_maxInFlight) {
+        int priority = Emergency;
+        while (priority < PriorityCount && m_queues[priority].isEmpty()) {
+            priority++;
+        }
+        if (priority >= PriorityCount) {
+            break;
+        }
+
+        QQueue<PendingFrame> &queue = m_queues[priority];
+        PendingFrame pending = queue.dequeue();
+
+        // 回显跟踪时由onLocalEcho释放额度；否则由framesWritten释放
+        m_inFlight++;
+
+        if (!m_device->writeFrame(pending.frame)) {
+            // 内核队列满或控制器异常：放回队首，稍后重试
+            m_inFlight--;
+            queue.prepend(pending);
+            if (!m_retryTimer->isActive()) {
+                m_retryTimer->start();
+            }
+            break;
+        }
+
+        if (m_echoTracking) {
+            m_echoTimer->start();
+        }
+
+        qint64 delayUs = (m_clock.nsecsElapsed() - pending.enqueueNs) / 1000;
+        CANTxClassStats &stats = m_stats[priority];
+        stats.sent++;
+        stats.depth = queue.size();
+        stats.lastDelayUs = delayUs;
+        stats.totalDelayUs += delayUs;
+        if (delayUs > stats.maxDelayUs) {
+            stats.maxDelayUs = delayUs;
+        }
+
+        emit frameDispatched(pending.frame, priority, delayUs);
+    }
+
+    m_pumping = false;
+}
+
+/**
+ * @brief 收到本地回显帧
+ */
+void CANTxScheduler::onLocalEcho()
+{
+    if (!m_echoTracking) {
+        return;
+    }
+
+    releaseCredit(1);
+}
+
+/**
+ * @brief 底层写入完成（未启用回显跟踪时释放额度）
+ */
+void CANTxScheduler::onFramesWritten(qint64 framesCount)
+{
+    if (m_echoTracking) {
+        return;
+    }
+
+    releaseCredit(static_cast<int>(framesCount));
+}
+
+/**
+ * @brief 回显超时：总线离线或回显丢失，清零在途计数
+ */
+void CANTxScheduler::onEchoTimeout()
+{
+    if (m_inFlight == 0) {
+        return;
+    }
+
+    m_echoTimeoutCount++;
+    qWarning() << "[CANTxScheduler] 回显超时，在途" << m_inFlight
+               << "帧视为已完成（总线可能离线）";
+
+    m_inFlight = 0;
+    pump();
+}
+
+/**
+ * @brief 释放在途额度并继续发送
+ */
+void CANTxScheduler::releaseCredit(int count)
+{
+    m_inFlight = qMax(0, m_inFlight - count);
+
+    if (m_inFlight == 0) {
+        m_echoTimer->stop();
+    } else if (m_echoTracking) {
+        m_echoTimer->start();
+    }
+
+    pump();
+}
+
+// ========== 配置 ==========
+
+/**
+ * @brief 添加ID区间到优先级的映射规则
+ */
+void CANTxScheduler::setIdPriority(quint32 idFrom, quint32 idTo, Priority priority)
+{
+    IdRule rule;
+    rule.idFrom = qMin(idFrom, idTo);
+    rule.idTo = qMax(idFrom, idTo);
+    rule.priority = priority;
+    m_idRules.append(rule);
+
+    qInfo() << QString("[CANTxScheduler] ID优先级规则: 0x%1-0x%2 -> %3")
+               .arg(rule.idFrom, 0, 16).arg(rule.idTo, 0, 16)
+               .arg(priorityToString(priority));
+}
+
+/**
+ * @brief 清除所有ID优先级规则
+ */
+void CANTxScheduler::clearIdPriorities()
+{
+    m_idRules.clear();
+}
+
+/**
+ * @brief 设置最大在途帧数
+ */
+void CANTxScheduler::setMaxInFlight(int maxInFlight)
+{
+    m_maxInFlight = qMax(1, maxInFlight);
+    pump();
+}
+
+/**
+ * @brief 设置每个优先级队列的最大深度
+ */
+void CANTxScheduler::setMaxQueueDepth(int depth)
+{
+    m_maxQueueDepth = qMax(1, depth);
+}
+
+/**
+ * @brief 启用/禁用本地回显跟踪
+ */
+void CANTxScheduler::setLocalEchoTracking(bool enable)
+{
+    m_echoTracking = enable;
+    m_inFlight = 0;
+    m_echoTimer->stop();
+}
+
+/**
+ * @brief 设置回显超时时间
+ */
+void CANTxScheduler::setEchoTimeout(int msecs)
+{
+    m_echoTimer->setInterval(qMax(1, msecs));
+}
+
+// ========== 状态与统计 ==========
+
+/**
+ * @brief 所有队列中排队帧总数
+ */
+int CANTxScheduler::getQueuedCount() const
+{
+    int total = 0;
+    for (int i = 0; i < PriorityCount; ++i) {
+        total += m_queues[i].size();
+    }
+    return total;
+}
+
+/**
+ * @brief 获取指定优先级的统计信息
+ */
+CANTxClassStats CANTxScheduler::getStats(Priority priority) const
+{
+    if (priority < Emergency || priority >= PriorityCount) {
+        return CANTxClassStats();
+    }
+    return m_stats[priority];
+}
+
+/**
+ * @brief 清空所有排队帧
+ */
+void CANTxScheduler::clear()
+{
+    int count = getQueuedCount();
+    for (int i = 0; i < PriorityCount; ++i) {
+        m_queues[i].clear();
+        m_stats[i].depth = 0;
+    }
+    qDebug() << "[CANTxScheduler] 清空发送队列，丢弃:" << count << "帧";
+}
+
+/**
+ * @brief 清零统计信息
+ */
+void CANTxScheduler::resetStats()
+{
+    for (int i = 0; i < PriorityCount; ++i) {
+        int depth = m_queues[i].size();
+        m_stats[i] = CANTxClassStats();
+        m_stats[i].depth = depth;
+    }
+    m_echoTimeoutCount = 0;
+}
+
+/**
+ * @brief 生成各优先级排队时延报告
+ */
+QString CANTxScheduler::generateReport() const
+{
+    QString report;
+    QTextStream out(&report);
+
+    out << "========================================\n";
+    out << "  CAN TX Scheduler Report\n";
+    out << "========================================\n";
+    out << "In flight: " << m_inFlight << "/" << m_maxInFlight
+        << "  Queued: " << getQueuedCount()
+        << "  Echo timeouts: " << m_echoTimeoutCount << "\n";
+    out << "----------------------------------------\n";
+
+    for (int i = 0; i < PriorityCount; ++i) {
+        const CANTxClassStats &stats = m_stats[i];
+        out << "  • " << priorityToString(static_cast<Priority>(i)) << "\n";
+        out << "    queued: " << stats.queued
+            << "  sent: " << stats.sent
+            << "  dropped: " << stats.dropped << "\n";
+        out << "    depth: " << stats.depth
+            << "  max depth: " << stats.maxDepth << "\n";
+        out << "    delay(us) avg: " << QString::number(stats.avgDelayUs(), 'f', 1)
+            << "  max: " << stats.maxDelayUs
+            << "  last: " << stats.lastDelayUs << "\n";
+    }
+
+    out << "========================================\n";
+
+    return report;
+}
+
+/**
+ * @brief 优先级转字符串
+ */
+QString CANTxScheduler::priorityToString(Priority priority)
+{
+    switch (priority) {
+        case Emergency: return "Emergency";
+        case High:      return "High";
+        case Normal:    return "Normal";
+        case Low:       return "Low";
+        default:        return "Unknown";
+    }
+}
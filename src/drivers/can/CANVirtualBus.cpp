@@ -0,0 +1,658 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANVirtualBus.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 进程内虚拟CAN总线实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/can/CANVirtualBus.h"
+#include <QThread>
+#include <QHash>
+#include <QTextStream>
+#include <QDebug>
+#include <time.h>
+
+#define VIRTUAL_BUS_MAX_TX_PENDING  256     // 每个实例待发送帧上限（对应txqueuelen）
+#define VIRTUAL_BUS_MAX_RETRIES     16      // 注入错误后的最大重发次数
+#define VIRTUAL_BUS_ERROR_BITS      20      // 错误标志+错误界定符+帧间隔
+
+const char *const CANVirtualBus::InterfacePrefix = "sim:";
+
+/***************************************************************
+ * 类名: CANVirtualBusThread
+ * 功能: 按总线完成时间定时送达帧
+ ***************************************************************/
+class CANVirtualBusThread : public QThread
+{
+public:
+    explicit CANVirtualBusThread(CANVirtualBus *bus)
+        : m_bus(bus)
+    {
+        m_running.store(1);
+    }
+
+    void stop()
+    {
+        m_running.store(0);
+        m_bus->m_queueMutex.lock();
+        m_bus->m_queueNotEmpty.wakeAll();
+        m_bus->m_queueMutex.unlock();
+        wait();
+    }
+
+protected:
+    void run() override
+    {
+        const qint64 maxSleepNs = 10 * 1000000LL;  // 单次最多睡10ms，及时响应停止
+
+        while (m_running.load() != 0) {
+            // 等待队首帧到期
+            m_bus->m_queueMutex.lock();
+            if (m_bus->m_pending.isEmpty()) {
+                m_bus->m_queueNotEmpty.wait(&m_bus->m_queueMutex, 100);
+                m_bus->m_queueMutex.unlock();
+                continue;
+            }
+            qint64 dueNs = m_bus->m_pending.head().dueNs;
+            m_bus->m_queueMutex.unlock();
+
+            // 新入队帧的完成时间不早于队首，可以放心睡到队首到期
+            qint64 nowNs = CANVirtualBus::monotonicNs();
+            if (dueNs > nowNs) {
+                qint64 wakeNs = qMin(dueNs, nowNs + maxSleepNs);
+                struct timespec ts;
+                ts.tv_sec = wakeNs / 1000000000LL;
+                ts.tv_nsec = wakeNs % 1000000000LL;
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+                continue;
+            }
+
+            // 取出所有到期帧并送达（先锁m_mutex，保证发送者指针有效）
+            QMutexLocker locker(&m_bus->m_mutex);
+            QVector<CANVirtualBus::PendingFrame> batch;
+            m_bus->m_queueMutex.lock();
+            nowNs = CANVirtualBus::monotonicNs();
+            while (!m_bus->m_pending.isEmpty() && m_bus->m_pending.head().dueNs <= nowNs) {
+                CANVirtualBus::PendingFrame pending = m_bus->m_pending.dequeue();
+                if (pending.sender && pending.frame.frameType() != QCanBusFrame::ErrorFrame) {
+                    pending.sender->m_txPending.deref();
+                }
+                batch.append(pending);
+            }
+            m_bus->m_queueMutex.unlock();
+
+            m_bus->deliver(batch);
+        }
+    }
+
+private:
+    CANVirtualBus *m_bus;
+    QAtomicInt m_running;
+};
+
+// ========== 总线注册表 ==========
+
+/**
+ * @brief 判断接口名是否指向虚拟总线
+ */
+bool CANVirtualBus::isVirtualInterface(const QString &interfaceName)
+{
+    return interfaceName.startsWith(QLatin1String(InterfacePrefix));
+}
+
+/**
+ * @brief 按名称获取虚拟总线
+ */
+CANVirtualBus* CANVirtualBus::bus(const QString &name)
+{
+    static QMutex registryMutex;
+    static QHash<QString, CANVirtualBus*> registry;
+
+    QMutexLocker locker(&registryMutex);
+
+    CANVirtualBus *bus = registry.value(name, nullptr);
+    if (!bus) {
+        bus = new CANVirtualBus(name);
+        registry.insert(name, bus);
+        qInfo() << "[CANVirtualBus] 创建虚拟总线:" << name;
+    }
+    return bus;
+}
+
+/**
+ * @brief 构造函数
+ */
+CANVirtualBus::CANVirtualBus(const QString &name)
+    : m_name(name)
+    , m_mutex(QMutex::Recursive)
+    , m_thread(nullptr)
+    , m_bitrate(0)
+    , m_bitrateExplicit(false)
+    , m_lossRate(0.0)
+    , m_errorRate(0.0)
+    , m_randomState(0x12345678)
+    , m_busFreeAtNs(0)
+{
+}
+
+/**
+ * @brief 析构函数（总线进程内常驻，正常不会调用）
+ */
+CANVirtualBus::~CANVirtualBus()
+{
+    if (m_thread) {
+        m_thread->stop();
+        delete m_thread;
+    }
+}
+
+// ========== 仿真参数 ==========
+
+void CANVirtualBus::setBitrate(quint32 bitrate)
+{
+    QMutexLocker locker(&m_mutex);
+    m_bitrate = bitrate;
+    m_bitrateExplicit = true;
+    qInfo() << "[CANVirtualBus]" << m_name << "波特率:" << bitrate
+            << (bitrate == 0 ? "(不限速)" : "");
+}
+
+quint32 CANVirtualBus::getBitrate() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_bitrate;
+}
+
+void CANVirtualBus::setLossRate(double rate)
+{
+    QMutexLocker locker(&m_mutex);
+    m_lossRate = qBound(0.0, rate, 1.0);
+}
+
+void CANVirtualBus::setErrorRate(double rate)
+{
+    QMutexLocker locker(&m_mutex);
+    m_errorRate = qBound(0.0, rate, 1.0);
+}
+
+void CANVirtualBus::setSeed(quint32 seed)
+{
+    QMutexLocker locker(&m_mutex);
+    m_randomState = seed ? seed : 0x12345678;  // xorshift状态不能为0
+}
+
+/**
+ * @brief 注入错误帧
+ */
+void CANVirtualBus::injectErrorFrame(QCanBusFrame::FrameErrors errors, const QByteArray &payload)
+{
+    QMutexLocker locker(&m_mutex);
+
+    PendingFrame pending;
+    pending.dueNs = monotonicNs();
+    pending.frame = makeErrorFrame(errors, payload);
+    pending.sender = nullptr;
+
+    m_stats.errorsInjected++;
+    deliver(QVector<PendingFrame>() << pending);
+}
+
+// ========== 实例连接 ==========
+
+void CANVirtualBus::attach(CANVirtualBusDevice *device)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_devices.contains(device)) {
+        return;
+    }
+    m_devices.append(device);
+
+    // 未显式设置波特率时采用首个实例的配置
+    if (!m_bitrateExplicit && m_bitrate == 0) {
+        QVariant bitrate = device->configurationParameter(QCanBusDevice::BitRateKey);
+        if (bitrate.isValid()) {
+            m_bitrate = bitrate.toUInt();
+        }
+    }
+
+    if (!m_thread) {
+        m_thread = new CANVirtualBusThread(this);
+        m_thread->start(QThread::HighPriority);
+    }
+
+    qInfo() << "[CANVirtualBus]" << m_name << "实例已连接，当前" << m_devices.size() << "个";
+}
+
+void CANVirtualBus::detach(CANVirtualBusDevice *device)
+{
+    CANVirtualBusThread *thread = nullptr;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (!m_devices.removeOne(device)) {
+            return;
+        }
+
+        // 已上总线的帧照常送达其他实例，只是不再关联发送者
+        m_queueMutex.lock();
+        for (PendingFrame &pending : m_pending) {
+            if (pending.sender == device) {
+                pending.sender = nullptr;
+            }
+        }
+        if (m_devices.isEmpty()) {
+            m_pending.clear();
+        }
+        m_queueMutex.unlock();
+        device->m_txPending.store(0);
+
+        if (m_devices.isEmpty()) {
+            thread = m_thread;
+            m_thread = nullptr;
+            m_busFreeAtNs = 0;
+            if (!m_bitrateExplicit) {
+                m_bitrate = 0;
+            }
+        }
+
+        qInfo() << "[CANVirtualBus]" << m_name << "实例已断开，当前" << m_devices.size() << "个";
+    }
+
+    // 送达线程会获取m_mutex，必须在锁外停止
+    if (thread) {
+        thread->stop();
+        delete thread;
+    }
+}
+
+// ========== 发送与送达 ==========
+
+/**
+ * @brief 发送一帧
+ */
+bool CANVirtualBus::transmit(CANVirtualBusDevice *sender, const QCanBusFrame &frame)
+{
+    QMutexLocker locker(&m_mutex);
+
+    bool paced = (m_bitrate > 0);
+
+    if (paced && sender->m_txPending.load() >= VIRTUAL_BUS_MAX_TX_PENDING) {
+        m_stats.txRejected++;
+        return false;
+    }
+
+    QVector<PendingFrame> batch;
+    qint64 nowNs = monotonicNs();
+    qint64 startNs = qMax(nowNs, m_busFreeAtNs);
+    int bits = frameBits(frame);
+    qint64 bitNs = paced ? 1000000000LL / m_bitrate : 0;
+
+    // 注入传输错误：广播错误帧，占用部分帧时间后自动重发
+    for (int retry = 0; retry < VIRTUAL_BUS_MAX_RETRIES; ++retry) {
+        if (m_errorRate <= 0.0 || nextRandom() >= m_errorRate) {
+            break;
+        }
+        startNs += static_cast<qint64>(bits / 2 + VIRTUAL_BUS_ERROR_BITS) * bitNs;
+
+        QByteArray payload(8, 0);
+        payload[2] = 0x01;      // CAN_ERR_PROT_BIT
+        payload[3] = 0x0A;      // CAN_ERR_PROT_LOC_DATA
+        PendingFrame error;
+        error.dueNs = startNs;
+        error.frame = makeErrorFrame(QCanBusFrame::BusError |
+                                     QCanBusFrame::ProtocolViolationError, payload);
+        error.sender = nullptr;
+        batch.append(error);
+        m_stats.errorsInjected++;
+    }
+
+    PendingFrame pending;
+    pending.dueNs = startNs + static_cast<qint64>(bits) * bitNs;
+    pending.frame = frame;
+    pending.sender = sender;
+    batch.append(pending);
+
+    m_stats.framesTransmitted++;
+    m_stats.busTimeNs += static_cast<quint64>(pending.dueNs - qMax(nowNs, m_busFreeAtNs));
+
+    if (!paced) {
+        // 不限速：在发送者线程中同步送达，顺序与调用顺序一致
+        deliver(batch);
+        return true;
+    }
+
+    m_busFreeAtNs = pending.dueNs;
+    sender->m_txPending.ref();
+
+    m_queueMutex.lock();
+    for (const PendingFrame &item : batch) {
+        m_pending.enqueue(item);
+    }
+    m_queueNotEmpty.wakeOne();
+    m_queueMutex.unlock();
+
+    return true;
+}
+
+/**
+ * @brief 把一批帧送达各实例
+ */
+void CANVirtualBus::deliver(const QVector<PendingFrame> &batch)
+{
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    // 接收时间戳统一取送达时刻（CLOCK_REALTIME，与socketcan一致）
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    QCanBusFrame::TimeStamp stamp(ts.tv_sec, ts.tv_nsec / 1000);
+
+    QVector<QCanBusFrame> frames;
+    frames.reserve(batch.size());
+
+    // 遍历副本：送达回调里可能再发送（重入m_mutex）
+    const QList<CANVirtualBusDevice*> devices = m_devices;
+
+    for (CANVirtualBusDevice *device : devices) {
+        frames.clear();
+
+        for (const PendingFrame &pending : batch) {
+            bool own = (pending.sender == device);
+            bool isError = (pending.frame.frameType() == QCanBusFrame::ErrorFrame);
+
+            if (!own && !isError && pending.sender && !pending.sender->isLoopback()) {
+                continue;
+            }
+            if (!device->accepts(pending.frame, own)) {
+                continue;
+            }
+            if (!own && !isError && m_lossRate > 0.0 && nextRandom() < m_lossRate) {
+                m_stats.framesLost++;
+                continue;
+            }
+
+            QCanBusFrame frame = pending.frame;
+            frame.setTimeStamp(stamp);
+            if (own) {
+                frame.setLocalEcho(true);
+            }
+            frames.append(frame);
+        }
+
+        if (!frames.isEmpty()) {
+            m_stats.framesDelivered += static_cast<quint64>(frames.size());
+            device->pushReceived(frames);
+        }
+    }
+}
+
+/**
+ * @brief 构造错误帧
+ */
+QCanBusFrame CANVirtualBus::makeErrorFrame(QCanBusFrame::FrameErrors errors, const QByteArray &payload)
+{
+    QCanBusFrame frame(QCanBusFrame::ErrorFrame);
+    frame.setError(errors);
+    frame.setPayload(payload.left(8));
+    return frame;
+}
+
+/**
+ * @brief 估算帧占用总线的位数
+ *
+ * 采用最坏情况位填充（Tindell公式），CAN FD帧按经典帧估算：
+ *   标准帧: 8n + 47 + floor((34 + 8n - 1) / 4)
+ *   扩展帧: 8n + 67 + floor((54 + 8n - 1) / 4)
+ */
+int CANVirtualBus::frameBits(const QCanBusFrame &frame)
+{
+    int n = (frame.frameType() == QCanBusFrame::RemoteRequestFrame) ? 0 : frame.payload().size();
+
+    if (frame.hasExtendedFrameFormat()) {
+        return 8 * n + 67 + (54 + 8 * n - 1) / 4;
+    }
+    return 8 * n + 47 + (34 + 8 * n - 1) / 4;
+}
+
+/**
+ * @brief 确定性伪随机数（调用者持有m_mutex）
+ */
+double CANVirtualBus::nextRandom()
+{
+    quint32 x = m_randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    m_randomState = x;
+    return static_cast<double>(x) / 4294967296.0;
+}
+
+qint64 CANVirtualBus::monotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// ========== 统计 ==========
+
+CANVirtualBusStats CANVirtualBus::getStats() const
+{
+    QMutexLocker locker(&m_mutex);
+    CANVirtualBusStats stats = m_stats;
+    stats.attachedDevices = m_devices.size();
+    return stats;
+}
+
+void CANVirtualBus::resetStats()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats = CANVirtualBusStats();
+}
+
+/**
+ * @brief 生成总线统计报告
+ */
+QString CANVirtualBus::generateReport() const
+{
+    CANVirtualBusStats stats = getStats();
+
+    QMutexLocker locker(&m_mutex);
+
+    QString report;
+    QTextStream out(&report);
+
+    out << "========================================\n";
+    out << "  Virtual CAN Bus: " << InterfacePrefix << m_name << "\n";
+    out << "========================================\n";
+    out << "Bitrate:      " << (m_bitrate ? QString::number(m_bitrate) : QString("unpaced")) << "\n";
+    out << "Loss rate:    " << m_lossRate << "\n";
+    out << "Error rate:   " << m_errorRate << "\n";
+    out << "Devices:      " << stats.attachedDevices << "\n";
+    out << "----------------------------------------\n";
+    out << "Transmitted:  " << stats.framesTransmitted << "\n";
+    out << "Delivered:    " << stats.framesDelivered << "\n";
+    out << "Lost:         " << stats.framesLost << "\n";
+    out << "Errors:       " << stats.errorsInjected << "\n";
+    out << "TX rejected:  " << stats.txRejected << "\n";
+    out << "Bus time:     " << stats.busTimeNs / 1000 << " us\n";
+    out << "========================================\n";
+
+    return report;
+}
+
+// ========== CANVirtualBusDevice ==========
+
+/**
+ * @brief 构造函数
+ */
+CANVirtualBusDevice::CANVirtualBusDevice(const QString &busName, QObject *parent)
+    : QCanBusDevice(parent)
+    , m_bus(CANVirtualBus::bus(busName))
+    , m_errorFilter(QCanBusFrame::NoError)
+    , m_receiveOwn(false)
+    , m_loopback(true)
+{
+    m_txPending.store(0);
+}
+
+/**
+ * @brief 析构函数
+ */
+CANVirtualBusDevice::~CANVirtualBusDevice()
+{
+    m_bus->detach(this);
+}
+
+/**
+ * @brief 打开设备：连接到虚拟总线
+ */
+bool CANVirtualBusDevice::open()
+{
+    refreshFilters();
+    m_bus->attach(this);
+    setState(QCanBusDevice::ConnectedState);
+    return true;
+}
+
+/**
+ * @brief 关闭设备：从虚拟总线断开
+ */
+void CANVirtualBusDevice::close()
+{
+    m_bus->detach(this);
+    setState(QCanBusDevice::UnconnectedState);
+}
+
+/**
+ * @brief 设置配置参数（同时刷新过滤缓存）
+ */
+void CANVirtualBusDevice::setConfigurationParameter(int key, const QVariant &value)
+{
+    QCanBusDevice::setConfigurationParameter(key, value);
+    refreshFilters();
+}
+
+/**
+ * @brief 发送一帧
+ */
+bool CANVirtualBusDevice::writeFrame(const QCanBusFrame &frame)
+{
+    if (state() != QCanBusDevice::ConnectedState) {
+        setError(QStringLiteral("虚拟CAN设备未连接"), QCanBusDevice::WriteError);
+        return false;
+    }
+
+    if (!frame.isValid() || frame.frameType() == QCanBusFrame::ErrorFrame) {
+        setError(QStringLiteral("无效的CAN帧"), QCanBusDevice::WriteError);
+        return false;
+    }
+
+    if (!m_bus->transmit(this, frame)) {
+        setError(QStringLiteral("No buffer space available"), QCanBusDevice::WriteError);
+        return false;
+    }
+
+    emit framesWritten(1);
+    return true;
+}
+
+/**
+ * @brief 解析错误帧
+ */
+QString CANVirtualBusDevice::interpretErrorFrame(const QCanBusFrame &errorFrame)
+{
+    if (errorFrame.frameType() != QCanBusFrame::ErrorFrame) {
+        return QString();
+    }
+
+    QStringList parts;
+    QCanBusFrame::FrameErrors errors = errorFrame.error();
+
+    if (errors & QCanBusFrame::TransmissionTimeoutError) parts << "发送超时";
+    if (errors & QCanBusFrame::LostArbitrationError) parts << "仲裁丢失";
+    if (errors & QCanBusFrame::ControllerError) parts << "控制器错误";
+    if (errors & QCanBusFrame::ProtocolViolationError) parts << "协议错误";
+    if (errors & QCanBusFrame::TransceiverError) parts << "收发器错误";
+    if (errors & QCanBusFrame::MissingAcknowledgmentError) parts << "无应答";
+    if (errors & QCanBusFrame::BusOffError) parts << "总线关闭";
+    if (errors & QCanBusFrame::BusError) parts << "总线错误";
+    if (errors & QCanBusFrame::ControllerRestartError) parts << "控制器已重启";
+
+    return parts.isEmpty() ? QStringLiteral("未知错误") : parts.join(", ");
+}
+
+/**
+ * @brief 按当前配置刷新过滤参数缓存
+ */
+void CANVirtualBusDevice::refreshFilters()
+{
+    QMutexLocker locker(&m_filterMutex);
+
+    QVariant filters = configurationParameter(QCanBusDevice::RawFilterKey);
+    m_filters = filters.isValid() ? filters.value<QList<QCanBusDevice::Filter> >()
+                                  : QList<QCanBusDevice::Filter>();
+
+    QVariant errorFilter = configurationParameter(QCanBusDevice::ErrorFilterKey);
+    m_errorFilter = errorFilter.isValid() ? errorFilter.value<QCanBusFrame::FrameErrors>()
+                                          : QCanBusFrame::FrameErrors(QCanBusFrame::NoError);
+
+    QVariant receiveOwn = configurationParameter(QCanBusDevice::ReceiveOwnKey);
+    m_receiveOwn = receiveOwn.isValid() && receiveOwn.toBool();
+
+    QVariant loopback = configurationParameter(QCanBusDevice::LoopbackKey);
+    m_loopback = !loopback.isValid() || loopback.toBool();
+}
+
+bool CANVirtualBusDevice::isLoopback() const
+{
+    QMutexLocker locker(&m_filterMutex);
+    return m_loopback;
+}
+
+/**
+ * @brief 判断本实例是否接收该帧
+ */
+bool CANVirtualBusDevice::accepts(const QCanBusFrame &frame, bool ownFrame) const
+{
+    QMutexLocker locker(&m_filterMutex);
+
+    if (frame.frameType() == QCanBusFrame::ErrorFrame) {
+        return (m_errorFilter & frame.error()) != 0;
+    }
+
+    if (ownFrame && !m_receiveOwn) {
+        return false;
+    }
+
+    if (m_filters.isEmpty()) {
+        return true;
+    }
+
+    for (const QCanBusDevice::Filter &filter : m_filters) {
+        if ((frame.frameId() & filter.frameIdMask) != (filter.frameId & filter.frameIdMask)) {
+            continue;
+        }
+        if (filter.type != QCanBusFrame::InvalidFrame && filter.type != frame.frameType()) {
+            continue;
+        }
+        if (frame.hasExtendedFrameFormat()) {
+            if (!(filter.format & QCanBusDevice::Filter::MatchExtendedFormat)) {
+                continue;
+            }
+        } else if (!(filter.format & QCanBusDevice::Filter::MatchBaseFormat)) {
+            continue;
+        }
+        return true;
+    }
+
+    return false;
+}
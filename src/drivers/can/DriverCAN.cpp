@@ -1,4 +1,10 @@
 #include "drivers/can/DriverCAN.h"
+#include "drivers/can/CANTxScheduler.h"
+#include "drivers/can/CANTimingAnalyzer.h"
+#include "drivers/can/CANBusMonitor.h"
+#include "drivers/can/CANVirtualBus.h"
+#include "drivers/can/CANPayloadFilter.h"
+#include "drivers/can/CANFrameListener.h"
 #include <QCanBus>
 #include <QDebug>
 #include <QFile>
@@ -22,6 +28,11 @@ DriverCAN::DriverCAN(const QString &interfaceName, QObject *parent)
     , m_receivedFrameCount(0)
     , m_sentFrameCount(0)
     , m_receiveBufferMaxSize(1000)  // 默认最多缓存1000帧
+    , m_txScheduler(nullptr)
+    , m_timingAnalyzer(nullptr)
+    , m_busMonitor(nullptr)
+    , m_payloadFilter(new CANPayloadFilter())
+    , m_frameListener(nullptr)
 {
     qInfo() << "[DriverCAN] 初始化CAN接口:" << m_interfaceName;
 }
@@ -33,6 +44,12 @@ DriverCAN::~DriverCAN()
 {
     qInfo() << "[DriverCAN] 清理CAN接口:" << m_interfaceName;
     close();
+    
+    delete m_timingAnalyzer;
+    m_timingAnalyzer = nullptr;
+    
+    delete m_payloadFilter;
+    m_payloadFilter = nullptr;
 }
 
 // ========== CAN设备打开和关闭 ==========
@@ -49,12 +66,18 @@ bool DriverCAN::createDevice()
     
     QString errorString;
     
-    // 使用socketcan插件创建CAN设备
-    m_canDevice = QCanBus::instance()->createDevice(
-        QStringLiteral("socketcan"),
-        m_interfaceName,
-        &errorString
-    );
+    if (CANVirtualBus::isVirtualInterface(m_interfaceName)) {
+        // "sim:<总线名>"：进程内虚拟总线，无需socketcan/vcan
+        m_canDevice = new CANVirtualBusDevice(
+            m_interfaceName.mid(int(qstrlen(CANVirtualBus::InterfacePrefix))));
+    } else {
+        // 使用socketcan插件创建CAN设备
+        m_canDevice = QCanBus::instance()->createDevice(
+            QStringLiteral("socketcan"),
+            m_interfaceName,
+            &errorString
+        );
+    }
     
     if (!m_canDevice) {
         m_lastError = QString("无法创建CAN设备: %1").arg(errorString);
@@ -66,6 +89,18 @@ bool DriverCAN::createDevice()
     // 连接设备信号
     connectDeviceSignals();
     
+    // 发送调度器依赖本地回显判断帧是否已上总线
+    if (m_txScheduler && m_txScheduler->isLocalEchoTracking()) {
+        m_canDevice->setConfigurationParameter(QCanBusDevice::ReceiveOwnKey, true);
+    }
+    
+    // 总线监测依赖错误帧（CAN_RAW_ERR_FILTER = CAN_ERR_MASK）
+    if (m_busMonitor) {
+        m_canDevice->setConfigurationParameter(
+            QCanBusDevice::ErrorFilterKey,
+            QVariant::fromValue(QCanBusFrame::FrameErrors(QCanBusFrame::AnyError)));
+    }
+    
     return true;
 }
 
@@ -120,6 +155,9 @@ bool DriverCAN::open(quint32 bitrate)
     
     m_isOpen = true;
     
+    // 载荷过滤挂到新建的原始套接字上
+    m_payloadFilter->attach(CANPayloadFilter::socketDescriptor(m_canDevice));
+    
     // 读取实际波特率
     QVariant bitrateVar = m_canDevice->configurationParameter(QCanBusDevice::BitRateKey);
     if (bitrateVar.isValid()) {
@@ -129,6 +167,11 @@ bool DriverCAN::open(quint32 bitrate)
     qInfo() << "[DriverCAN] 设备已打开:" << m_interfaceName 
             << "波特率:" << m_bitrate;
     
+    if (m_txScheduler) {
+        m_txScheduler->setDevice(m_canDevice);
+        m_txScheduler->pump();
+    }
+    
     emit opened();
     return true;
 }
@@ -142,12 +185,17 @@ void DriverCAN::close()
         return;
     }
     
+    if (m_txScheduler) {
+        m_txScheduler->setDevice(nullptr);
+    }
+    
     if (m_canDevice) {
         m_canDevice->disconnectDevice();
         m_canDevice->deleteLater();
         m_canDevice = nullptr;
     }
     
+    m_payloadFilter->detached();
     m_isOpen = false;
     qInfo() << "[DriverCAN] 设备已关闭:" << m_interfaceName;
     emit closed();
@@ -240,6 +288,38 @@ void DriverCAN::clearFilters()
     qInfo() << "[DriverCAN] 过滤器已清除";
 }
 
+/**
+ * @brief 设置载荷过滤规则
+ */
+bool DriverCAN::setPayloadFilter(const QString &rules, bool passErrorFrames)
+{
+    QString errorMessage;
+    if (!m_payloadFilter->setRules(rules, passErrorFrames, &errorMessage)) {
+        m_lastError = QString("载荷过滤规则无效: %1").arg(errorMessage);
+        qWarning() << "[DriverCAN]" << m_lastError;
+        emit error(ConfigurationError, m_lastError);
+        return false;
+    }
+    
+    // 已打开时立即挂载（替换原程序）
+    if (m_isOpen && m_canDevice) {
+        m_payloadFilter->attach(CANPayloadFilter::socketDescriptor(m_canDevice));
+    }
+    
+    qInfo() << "[DriverCAN] 载荷过滤已设置:" << m_interfaceName
+            << (rules.isEmpty() ? QString("(清除)") : rules);
+    return true;
+}
+
+/**
+ * @brief 设置接收路径监听器
+ */
+void DriverCAN::setFrameListener(CANFrameListener *listener)
+{
+    m_frameListener = listener;
+    qInfo() << "[DriverCAN] 接收监听器" << (listener ? "已挂接:" : "已取消:") << m_interfaceName;
+}
+
 // ========== CAN帧发送 ==========
 
 /**
@@ -285,6 +365,23 @@ bool DriverCAN::writeFrame(const QCanBusFrame &frame)
         return false;
     }
     
+    if (m_txScheduler) {
+        if (!m_txScheduler->enqueue(frame)) {
+            m_lastError = "发送队列已满";
+            emit error(WriteError, m_lastError);
+            return false;
+        }
+        return true;
+    }
+    
+    return writeFrameDirect(frame);
+}
+
+/**
+ * @brief 直接交给底层设备发送
+ */
+bool DriverCAN::writeFrameDirect(const QCanBusFrame &frame)
+{
     if (!m_canDevice->writeFrame(frame)) {
         m_lastError = QString("发送失败: %1").arg(m_canDevice->errorString());
         qWarning() << "[DriverCAN]" << m_lastError;
@@ -298,6 +395,119 @@ bool DriverCAN::writeFrame(const QCanBusFrame &frame)
     return true;
 }
 
+// ========== 发送调度 ==========
+
+/**
+ * @brief 启用优先级发送调度器
+ */
+void DriverCAN::enableTxScheduler(int maxInFlight)
+{
+    if (m_txScheduler) {
+        m_txScheduler->setMaxInFlight(maxInFlight);
+        return;
+    }
+    
+    m_txScheduler = new CANTxScheduler(maxInFlight, this);
+    
+    connect(m_txScheduler, &CANTxScheduler::frameDispatched,
+            this, [this](const QCanBusFrame &frame, int, qint64) {
+        m_sentFrameCount++;
+        qDebug() << "[DriverCAN] 发送帧:" << frameToString(frame);
+    });
+    
+    if (m_canDevice) {
+        m_canDevice->setConfigurationParameter(QCanBusDevice::ReceiveOwnKey, true);
+        if (m_isOpen) {
+            m_txScheduler->setDevice(m_canDevice);
+        }
+    }
+    
+    qInfo() << "[DriverCAN] 发送调度器已启用:" << m_interfaceName
+            << "最大在途帧数:" << maxInFlight;
+}
+
+/**
+ * @brief 禁用优先级发送调度器
+ */
+void DriverCAN::disableTxScheduler()
+{
+    if (!m_txScheduler) {
+        return;
+    }
+    
+    int pending = m_txScheduler->getQueuedCount();
+    delete m_txScheduler;
+    m_txScheduler = nullptr;
+    
+    if (m_canDevice) {
+        m_canDevice->setConfigurationParameter(QCanBusDevice::ReceiveOwnKey, false);
+    }
+    
+    qInfo() << "[DriverCAN] 发送调度器已禁用，丢弃未发送帧:" << pending;
+}
+
+/**
+ * @brief 按指定优先级发送帧
+ */
+bool DriverCAN::queueFrame(const QCanBusFrame &frame, int priority)
+{
+    if (!m_txScheduler) {
+        return writeFrame(frame);
+    }
+    
+    if (!isOpen()) {
+        m_lastError = "CAN设备未打开";
+        qWarning() << "[DriverCAN]" << m_lastError;
+        emit error(WriteError, m_lastError);
+        return false;
+    }
+    
+    if (!m_txScheduler->enqueue(frame, static_cast<CANTxScheduler::Priority>(priority))) {
+        m_lastError = "发送队列已满";
+        emit error(WriteError, m_lastError);
+        return false;
+    }
+    
+    return true;
+}
+
+// ========== 总线监测 ==========
+
+/**
+ * @brief 启用按ID的周期与抖动分析器
+ */
+CANTimingAnalyzer* DriverCAN::enableTimingAnalyzer(int maxIds)
+{
+    if (m_timingAnalyzer) {
+        return m_timingAnalyzer;
+    }
+    
+    m_timingAnalyzer = new CANTimingAnalyzer(maxIds);
+    qInfo() << "[DriverCAN] 时序分析器已启用:" << m_interfaceName;
+    return m_timingAnalyzer;
+}
+
+/**
+ * @brief 启用控制器错误状态监测
+ */
+CANBusMonitor* DriverCAN::enableBusMonitor()
+{
+    if (m_busMonitor) {
+        return m_busMonitor;
+    }
+    
+    m_busMonitor = new CANBusMonitor(m_interfaceName, this);
+    
+    if (m_canDevice) {
+        m_canDevice->setConfigurationParameter(
+            QCanBusDevice::ErrorFilterKey,
+            QVariant::fromValue(QCanBusFrame::FrameErrors(QCanBusFrame::AnyError)));
+    }
+    
+    qInfo() << "[DriverCAN] 总线监测已启用:" << m_interfaceName;
+    return m_busMonitor;
+}
+
 // ========== 状态查询 ==========
 
 /**
@@ -348,6 +558,12 @@ QString DriverCAN::getStateString() const
 bool DriverCAN::hasBusError() const
 {
     if (!m_canDevice) return false;
+    
+    // 启用监测时，被动错误及以上也视为总线错误
+    if (m_busMonitor && m_busMonitor->getState() >= CANBusMonitor::ErrorPassive) {
+        return true;
+    }
+    
     return m_canDevice->state() != QCanBusDevice::ConnectedState;
 }
 
@@ -500,9 +716,34 @@ void DriverCAN::onFramesReceived()
     while (m_canDevice->framesAvailable()) {
         QCanBusFrame frame = m_canDevice->readFrame();
         
+        // 本地回显帧只用于发送调度，不进入接收缓冲区
+        if (frame.hasLocalEcho()) {
+            onLocalEchoReceived();
+            continue;
+        }
+        
+        // 无法挂载BPF时在此按同样的规则过滤；挂载时过滤BPF放行的回环帧
+        if (!m_payloadFilter->accept(frame)) {
+            continue;
+        }
+        
+        // 错误帧交给总线监测器，不进入接收缓冲区
+        if (m_busMonitor && frame.frameType() == QCanBusFrame::ErrorFrame) {
+            onErrorFrameReceived(frame);
+            continue;
+        }
+        
         if (frame.isValid()) {
             m_receivedFrameCount++;
             
+            if (m_timingAnalyzer) {
+                m_timingAnalyzer->update(frame);
+            }
+            
+            if (m_frameListener) {
+                m_frameListener->canFrameReceived(frame);
+            }
+            
             // 添加到接收缓冲区
             m_receiveBuffer.append(frame);
             
@@ -557,6 +798,26 @@ void DriverCAN::onError(QCanBusDevice::CanBusError error)
     emit this->error(canError, m_lastError);
 }
 
+/**
+ * @brief 本地回显帧处理
+ */
+void DriverCAN::onLocalEchoReceived()
+{
+    if (m_txScheduler) {
+        m_txScheduler->onLocalEcho();
+    }
+}
+
+/**
+ * @brief 错误帧处理
+ */
+void DriverCAN::onErrorFrameReceived(const QCanBusFrame &frame)
+{
+    if (m_busMonitor) {
+        m_busMonitor->processErrorFrame(frame);
+    }
+}
+
 /**
  * @brief 状态变化槽函数
  */
@@ -8,6 +8,7 @@
  *
  * History:
  *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 取下接收监听器时等待正在执行的回调结束
  ***************************************************************/
 
 #include "drivers/can/DriverCANHighPerf.h"
@@ -28,6 +29,10 @@ CANReceiveThread::CANReceiveThread(QCanBusDevice *device, QObject *parent)
     , m_droppedCount(0)
 {
     m_running.store(0);
+    m_ring.store(nullptr);
+    m_analyzer.store(nullptr);
+    m_listener.store(nullptr);
+    m_forwardErrors.store(0);
     qInfo() << "[CANReceiveThread] 创建独立接收线程";
 }
 
@@ -114,11 +119,52 @@ void CANReceiveThread::run()
             {
                 QCanBusFrame frame = m_device->readFrame();
                 
+                // 本地回显帧只用于发送调度，不进入接收缓冲区
+                if (frame.hasLocalEcho())
+                {
+                    emit localEchoReceived();
+                    continue;
+                }
+                
+                // BPF未挂载时在用户空间按同样的规则过滤；挂载时过滤BPF放行的回环帧
+                const CANPayloadFilter *filter = m_payloadFilter.loadAcquire();
+                if (filter && !filter->accept(frame))
+                {
+                    continue;
+                }
+                
+                // 错误帧转交总线监测器
+                if (frame.frameType() == QCanBusFrame::ErrorFrame &&
+                    m_forwardErrors.load() != 0)
+                {
+                    emit errorFrameReceived(frame);
+                    continue;
+                }
+                
                 if (frame.isValid())
                 {
                     consecutiveErrors = 0;  // 重置错误计数
                     m_receivedCount++;
                     
+                    // 按ID时序统计（O(1)，使用内核接收时间戳）
+                    CANTimingAnalyzer *analyzer = m_analyzer.loadAcquire();
+                    if (analyzer)
+                    {
+                        analyzer->update(frame);
+                    }
+                    
+                    // 接收监听器（如CAN→Modbus桥接）在本线程同步处理；
+                    // 回调期间持锁，setFrameListener据此等待回调结束
+                    if (m_listener.loadAcquire())
+                    {
+                        QMutexLocker listenerLocker(&m_listenerMutex);
+                        CANFrameListener *listener = m_listener.loadAcquire();
+                        if (listener)
+                        {
+                            listener->canFrameReceived(frame);
+                        }
+                    }
+                    
                     // 加锁添加到缓冲队列
                     m_bufferMutex.lock();
                     
@@ -143,6 +189,13 @@ void CANReceiveThread::run()
                     
                     m_bufferMutex.unlock();
                     
+                    // 写入广播环（所有消费者共享同一槽位）
+                    CANBroadcastRing *ring = m_ring.loadAcquire();
+                    if (ring)
+                    {
+                        ring->publish(frame);
+                    }
+                    
                     // 发出信号通知（注意：这是在接收线程中发出）
                     emit frameReceived(frame);
                 }
@@ -233,6 +286,23 @@ void CANReceiveThread::setMaxBufferSize(int maxFrames)
     qInfo() << "[CANReceiveThread] 设置最大缓冲帧数:" << maxFrames;
 }
 
+/**
+ * @brief 设置接收监听器
+ *   在锁内替换，返回时接收线程已不在旧监听器的回调中；在接收线程内
+ *   （回调中）调用时不加锁，避免自锁
+ */
+void CANReceiveThread::setFrameListener(CANFrameListener *listener)
+{
+    if (QThread::currentThread() == this)
+    {
+        m_listener.storeRelease(listener);
+        return;
+    }
+    
+    QMutexLocker locker(&m_listenerMutex);
+    m_listener.storeRelease(listener);
+}
+
 // ========================================
 // DriverCANHighPerf 实现
 // ========================================
@@ -244,6 +314,7 @@ DriverCANHighPerf::DriverCANHighPerf(const QString &interfaceName, QObject *pare
     : DriverCAN(interfaceName, parent)
     , m_receiveThread(nullptr)
     , m_threadedReceiveEnabled(true)  // 默认启用独立线程
+    , m_broadcastRing(nullptr)
 {
     qInfo() << "[DriverCANHighPerf] 创建高性能CAN驱动:" << interfaceName;
 }
@@ -253,6 +324,8 @@ DriverCANHighPerf::DriverCANHighPerf(const QString &interfaceName, QObject *pare
  */
 DriverCANHighPerf::~DriverCANHighPerf()
 {
+    // 写入器是广播环的消费者，先于广播环停止
+    m_traceWriter.stop();
     close();
     
     if (m_receiveThread)
@@ -262,6 +335,10 @@ DriverCANHighPerf::~DriverCANHighPerf()
         m_receiveThread = nullptr;
     }
     
+    // 接收线程已停止后再释放广播环
+    delete m_broadcastRing;
+    m_broadcastRing = nullptr;
+    
     qInfo() << "[DriverCANHighPerf] 销毁高性能CAN驱动";
 }
 
@@ -291,11 +368,24 @@ bool DriverCANHighPerf::open(quint32 bitrate)
         
         // 创建接收线程
         m_receiveThread = new CANReceiveThread(device, this);
+        m_receiveThread->setBroadcastRing(m_broadcastRing);
+        m_receiveThread->setTimingAnalyzer(getTimingAnalyzer());
+        m_receiveThread->setErrorFrameForwarding(getBusMonitor() != nullptr);
+        m_receiveThread->setPayloadFilter(getPayloadFilter());
+        m_receiveThread->setFrameListener(getFrameListener());
         
         // 连接线程信号到本对象（信号中转）
         connect(m_receiveThread, &CANReceiveThread::frameReceived,
                 this, &DriverCANHighPerf::highPerfFrameReceived);
         
+        // 回显帧跨线程转交发送调度器（队列连接）
+        connect(m_receiveThread, &CANReceiveThread::localEchoReceived,
+                this, &DriverCANHighPerf::onLocalEchoReceived);
+        
+        // 错误帧跨线程转交总线监测器（队列连接）
+        connect(m_receiveThread, &CANReceiveThread::errorFrameReceived,
+                this, &DriverCANHighPerf::onErrorFrameReceived);
+        
         connect(m_receiveThread, &CANReceiveThread::bufferOverflow,
                 this, [](int dropped) {
             qWarning() << "[DriverCANHighPerf] 缓冲区溢出，丢弃" << dropped << "帧";
@@ -416,3 +506,93 @@ bool DriverCANHighPerf::isThreadedReceiveRunning() const
     return m_receiveThread && m_receiveThread->isRunning();
 }
 
+
+/**
+ * @brief 启用多消费者广播环
+ */
+CANBroadcastRing* DriverCANHighPerf::enableBroadcastRing(int capacity)
+{
+    if (m_broadcastRing)
+    {
+        return m_broadcastRing;
+    }
+    
+    m_broadcastRing = new CANBroadcastRing(capacity);
+    
+    if (m_receiveThread)
+    {
+        m_receiveThread->setBroadcastRing(m_broadcastRing);
+    }
+    
+    qInfo() << "[DriverCANHighPerf] 多消费者广播环已启用，槽位数:" << m_broadcastRing->capacity();
+    return m_broadcastRing;
+}
+
+/**
+ * @brief 开始抓包
+ */
+bool DriverCANHighPerf::startTrace(const QString &path)
+{
+    CANBroadcastRing *ring = enableBroadcastRing();
+    
+    if (!m_traceWriter.start(path, ring))
+    {
+        emit error(WriteError, QString("抓包启动失败: %1").arg(m_traceWriter.getLastError()));
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief 停止抓包
+ */
+void DriverCANHighPerf::stopTrace()
+{
+    m_traceWriter.stop();
+}
+
+
+/**
+ * @brief 启用时序分析器
+ */
+CANTimingAnalyzer* DriverCANHighPerf::enableTimingAnalyzer(int maxIds)
+{
+    CANTimingAnalyzer *analyzer = DriverCAN::enableTimingAnalyzer(maxIds);
+    
+    if (m_receiveThread)
+    {
+        m_receiveThread->setTimingAnalyzer(analyzer);
+    }
+    
+    return analyzer;
+}
+
+/**
+ * @brief 设置接收监听器
+ */
+void DriverCANHighPerf::setFrameListener(CANFrameListener *listener)
+{
+    DriverCAN::setFrameListener(listener);
+    
+    if (m_receiveThread)
+    {
+        m_receiveThread->setFrameListener(listener);
+    }
+}
+
+
+/**
+ * @brief 启用总线监测
+ */
+CANBusMonitor* DriverCANHighPerf::enableBusMonitor()
+{
+    CANBusMonitor *monitor = DriverCAN::enableBusMonitor();
+    
+    if (m_receiveThread)
+    {
+        m_receiveThread->setErrorFrameForwarding(true);
+    }
+    
+    return monitor;
+}
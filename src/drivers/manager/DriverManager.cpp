@@ -4,6 +4,7 @@
 #include "drivers/pwm/DriverPWM.h"
 #include "drivers/serial/DriverSerial.h"
 #include "drivers/can/DriverCAN.h"
+#include "drivers/can/DriverCANHighPerf.h"
 #include "drivers/scanner/SystemScanner.h"
 #include <QDebug>
 #include <QSettings>
@@ -212,7 +213,7 @@ void DriverManager::releaseSerial(const QString &portName)
 /**
  * @brief 创建或获取CAN驱动
  */
-DriverCAN* DriverManager::getCAN(const QString &interfaceName)
+DriverCAN* DriverManager::getCAN(const QString &interfaceName, bool highPerf)
 {
     // 检查是否已存在
     if (m_canDrivers.contains(interfaceName)) {
@@ -221,8 +222,10 @@ DriverCAN* DriverManager::getCAN(const QString &interfaceName)
     }
     
     // 创建新的CAN驱动
-    qInfo() << "DriverManager: Creating new CAN driver:" << interfaceName;
-    DriverCAN *can = new DriverCAN(interfaceName, this);
+    qInfo() << "DriverManager: Creating new CAN driver:" << interfaceName
+            << (highPerf ? "(threaded receive)" : "");
+    DriverCAN *can = highPerf ? new DriverCANHighPerf(interfaceName, this)
+                              : new DriverCAN(interfaceName, this);
     m_canDrivers[interfaceName] = can;
     
     emit driverLoaded("CAN", interfaceName);
@@ -403,6 +406,9 @@ bool DriverManager::loadFromConfig(const QString &configFile)
     int successCount = 0;
     int failedCount = 0;
     
+    m_canModbusMappings.clear();
+    m_serialBridgeConfigs.clear();
+    
     // 解析每个配置节
     for (const QString &group : groups)
     {
@@ -559,12 +565,126 @@ bool DriverManager::loadFromConfig(const QString &configFile)
                     serial->setStopBits(QSerialPort::OneStop);
                 }
                 
+                // RS-485方向控制
+                SerialRs485Config rs485;
+                rs485.mode = SerialRs485Config::modeFromString(settings.value("rs485", "off").toString());
+                if (rs485.isEnabled())
+                {
+                    rs485.rtsOnSend = settings.value("rs485_rts_on_send", "high").toString().toLower() != "low";
+                    rs485.delayBeforeUs = settings.value("rs485_delay_before", 0).toInt();
+                    rs485.delayAfterUs = settings.value("rs485_delay_after", 0).toInt();
+                    rs485.rxDuringTx = settings.value("rs485_rx_during_tx", false).toBool();
+                    rs485.gpio = settings.value("rs485_gpio", -1).toInt();
+                    serial->setRs485(rs485);
+                }
+                
+                // 收发抓包（环形文件，写满覆盖最旧数据）
+                QString traceFile = settings.value("trace_file", "").toString();
+                if (!traceFile.isEmpty())
+                {
+                    int traceSizeKb = settings.value("trace_size_kb", 16384).toInt();
+                    serial->getTraceWriter()->setFileSize(static_cast<qint64>(traceSizeKb) * 1024);
+                    serial->startTrace(traceFile);
+                }
+                
                 // 注册别名
                 m_serialAliases[name] = device;
                 
                 success = true;
             }
         }
+        else if (type == "CAN")
+        {
+            QString device = settings.value("device", "").toString();
+            quint32 bitrate = settings.value("bitrate", 500000).toUInt();
+            bool receiveThread = settings.value("receive_thread", false).toBool();
+            bool passErrorFrames = settings.value("pass_error_frames", true).toBool();
+            
+            // 规则中误写逗号时QSettings会解析为列表，拼回原文
+            QVariant filterValue = settings.value("payload_filter", "");
+            QString payloadFilter = (filterValue.type() == QVariant::StringList)
+                                    ? filterValue.toStringList().join(",")
+                                    : filterValue.toString();
+            
+            qInfo() << QString("  ✓ [CAN] %1 (device=%2, bitrate=%3%4)")
+                       .arg(name, -12)
+                       .arg(device)
+                       .arg(bitrate)
+                       .arg(payloadFilter.isEmpty() ? "" : ", payload filter");
+            
+            // 创建CAN驱动
+            DriverCAN *can = getCAN(device, receiveThread);
+            if (can)
+            {
+                can->setBitrate(bitrate);
+                
+                // 载荷过滤规则（打开后编译为BPF挂到接收套接字）
+                if (payloadFilter.isEmpty() || can->setPayloadFilter(payloadFilter, passErrorFrames))
+                {
+                    // 注册别名
+                    m_canAliases[name] = device;
+                    
+                    // 启用即打开: 载荷过滤和[CANModbus/...]映射都挂在接收套接字上，
+                    // 打开失败（接口不存在、未up等）只记录，驱动保留供应用重试
+                    if (!can->open(bitrate))
+                    {
+                        qWarning() << "  ✗ [CAN]" << name << "打开失败:" << device;
+                    }
+                    
+                    success = true;
+                }
+            }
+        }
+        else if (type == "CANModbus")
+        {
+            // 映射只在此收集，由Modbus从站服务在启动时编译并挂到CAN接收路径
+            QVariantMap mapping;
+            for (const QString &key : settings.childKeys())
+            {
+                mapping[key] = settings.value(key);
+            }
+            
+            QString canAlias = mapping.value("can").toString();
+            qInfo() << QString("  ✓ [CANModbus] %1 (can=%2, id=%3 -> %4 %5)")
+                       .arg(name, -12)
+                       .arg(canAlias)
+                       .arg(mapping.value("can_id").toString())
+                       .arg(mapping.value("register_type", "holding").toString())
+                       .arg(mapping.value("register").toString());
+            
+            if (!canAlias.isEmpty() && mapping.contains("can_id") && mapping.contains("register"))
+            {
+                m_canModbusMappings.append(mapping);
+                success = true;
+            }
+        }
+        else if (type == "SerialBridge")
+        {
+            // 桥独占串口，只在此收集，由串口桥服务在启动时打开
+            QVariantMap bridge;
+            for (const QString &key : settings.childKeys())
+            {
+                bridge[key] = settings.value(key);
+            }
+            
+            QString device = bridge.value("device").toString();
+            int tcpPort = bridge.value("tcp_port", 0).toInt();
+            qInfo() << QString("  ✓ [SerialBridge] %1 (device=%2, tcp=%3%4)")
+                       .arg(name, -12)
+                       .arg(device)
+                       .arg(tcpPort)
+                       .arg(bridge.value("rfc2217", false).toBool() ? ", rfc2217" : "");
+            
+            if (m_serialAliases.values().contains(device))
+            {
+                qWarning() << "  ✗ [SerialBridge]" << name << "的设备已被[Serial/...]使用:" << device;
+            }
+            else if (!device.isEmpty() && tcpPort > 0 && tcpPort <= 65535)
+            {
+                m_serialBridgeConfigs.append(bridge);
+                success = true;
+            }
+        }
         else
         {
             qWarning() << "  ✗ 不支持的设备类型:" << type << "-" << name;
@@ -643,6 +763,28 @@ DriverSerial* DriverManager::getSerialByAlias(const QString &alias)
     return nullptr;
 }
 
+/**
+ * @brief 通过别名获取CAN驱动
+ */
+DriverCAN* DriverManager::getCANByAlias(const QString &alias)
+{
+    if (m_canAliases.contains(alias))
+    {
+        QString device = m_canAliases[alias];
+        return m_canDrivers.value(device, nullptr);
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 获取串口配置节中的RS-485参数
+ */
+SerialRs485Config DriverManager::getSerialRs485(const QString &portName) const
+{
+    DriverSerial *serial = m_serialDrivers.value(portName, nullptr);
+    return serial ? serial->getRs485() : SerialRs485Config();
+}
+
 /**
  * @brief 获取所有已配置的设备别名
  */
@@ -653,6 +795,7 @@ QStringList DriverManager::getAllAliases() const
     aliases << m_gpioAliases.keys();
     aliases << m_ledAliases.keys();
     aliases << m_serialAliases.keys();
+    aliases << m_canAliases.keys();
     return aliases;
 }
 
@@ -706,6 +849,16 @@ void DriverManager::printConfigReport() const
         }
     }
     
+    if (!m_canAliases.isEmpty())
+    {
+        qInfo() << "";
+        qInfo() << "CAN设备别名 (" << m_canAliases.size() << "):";
+        for (auto it = m_canAliases.begin(); it != m_canAliases.end(); ++it)
+        {
+            qInfo() << "  •" << it.key() << "->" << it.value();
+        }
+    }
+    
     qInfo() << "";
     qInfo() << "💡 使用示例:";
     if (!m_pwmAliases.isEmpty())
@@ -8,10 +8,39 @@
  *
  * History:
  *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 读缓冲区改为环形缓冲区，读取不再搬移剩余数据
+ *   3. 2026-10-18 增加分帧器，接收数据后直接在读缓冲区上提取完整帧
+ *   4. 2026-10-18 增加独立I/O线程后端，收发不再依赖所属线程的事件循环
+ *   5. 2026-10-18 写缓冲区改为分段队列，writev直接写fd，部分写出不再搬移积压
+ *   6. 2026-10-18 增加RS-485方向控制，打开时设置TIOCSRS485或交给I/O线程切换GPIO
+ *   7. 2026-10-18 增加收发抓包，接收在读到数据处、发送在入队处记录
  ***************************************************************/
 
 #include "drivers/serial/DriverSerial.h"
+#include <QSocketNotifier>
 #include <QDebug>
+#include <string.h>
+
+namespace {
+
+/**
+ * @brief 分帧回调，转发为DriverSerial::frameReceived信号
+ */
+class FrameSignalHandler : public SerialFramer::Handler
+{
+public:
+    explicit FrameSignalHandler(DriverSerial *owner) : m_owner(owner) {}
+
+    void onFrame(const SerialFrameView &frame) override
+    {
+        emit m_owner->frameReceived(frame);
+    }
+
+private:
+    DriverSerial *m_owner;
+};
+
+} // namespace
 
 /**
  * @brief 构造函数 - 初始化串口驱动
@@ -23,8 +52,14 @@ DriverSerial::DriverSerial(const QString &portName, QObject *parent)
     , m_pSerialPort(nullptr)
     , m_portName(portName)
     , m_isConfigured(false)
-    , m_readBufferMaxSize(65536)  // 默认64KB读缓冲
-    , m_isWriting(false)
+    , m_readBuffer(65536)  // 默认64KB读缓冲
+    , m_pFramer(nullptr)
+    , m_useIoThread(false)
+    , m_pIoThread(nullptr)
+    , m_pDataListener(nullptr)
+    , m_pWriteNotifier(nullptr)
+    , m_writeBackpressure(false)
+    , m_rs485Active(SerialRs485Config::Off)
 {
     // 创建QSerialPort对象
     m_pSerialPort = new QSerialPort(portName, this);
@@ -37,10 +72,6 @@ DriverSerial::DriverSerial(const QString &portName, QObject *parent)
             static_cast<void (QSerialPort::*)(QSerialPort::SerialPortError)>(&QSerialPort::error),
             this, &DriverSerial::onError);
     
-    // 连接bytesWritten信号，用于处理写缓冲
-    connect(m_pSerialPort, &QSerialPort::bytesWritten,
-            this, &DriverSerial::processWriteBuffer);
-    
     qDebug() << "[DriverSerial] 串口驱动创建:" << portName;
 }
 
@@ -49,10 +80,20 @@ DriverSerial::DriverSerial(const QString &portName, QObject *parent)
  */
 DriverSerial::~DriverSerial()
 {
+    // 先注销可写通知再关闭fd
+    delete m_pWriteNotifier;
+    m_pWriteNotifier = nullptr;
+    
     if (m_pSerialPort && m_pSerialPort->isOpen())
     {
         m_pSerialPort->close();
     }
+    if (m_pIoThread)
+    {
+        m_pIoThread->closePort();
+    }
+    m_traceWriter.stop();
+    delete m_pFramer;
     qDebug() << "[DriverSerial] 串口驱动销毁:" << m_portName;
 }
 
@@ -71,19 +112,74 @@ bool DriverSerial::open(QIODevice::OpenMode mode)
         return false;
     }
     
-    if (m_pSerialPort->isOpen())
+    if (isOpen())
     {
         qWarning() << "[DriverSerial] 串口已打开:" << m_portName;
         return true;
     }
     
+    // RS-485方向控制: 自动模式先确定内核是否支持；GPIO切换只能在I/O线程中精确完成
+    m_rs485Active = SerialRs485::resolveMode(m_portName, m_rs485);
+    if (m_rs485Active == SerialRs485Config::Gpio && !m_useIoThread)
+    {
+        qInfo() << "[DriverSerial] RS-485 GPIO方向控制需要I/O线程，自动启用:" << m_portName;
+        setIoThreadEnabled(true, m_ioOptions);
+    }
+    if (m_pIoThread)
+    {
+        m_pIoThread->setDirectionControl(m_rs485Active == SerialRs485Config::Gpio
+                                         ? m_rs485 : SerialRs485Config());
+    }
+    
+    // 独立I/O线程后端：参数取自QSerialPort（未打开时仍保存设置值）
+    if (m_useIoThread)
+    {
+        Q_UNUSED(mode);
+        if (m_pIoThread->openPort(m_portName, m_pSerialPort->baudRate(),
+                                  m_pSerialPort->dataBits(), m_pSerialPort->parity(),
+                                  m_pSerialPort->stopBits(), m_pSerialPort->flowControl(),
+                                  m_ioOptions))
+        {
+            if (!applyRs485(m_pIoThread->getFd()))
+            {
+                m_pIoThread->closePort();
+                return false;
+            }
+            qInfo() << "[DriverSerial] ✓ 串口打开成功（I/O线程）:" << m_portName;
+            emit opened();
+            return true;
+        }
+        
+        QString errMsg = QString("打开串口失败: %1 - %2")
+                        .arg(m_portName, m_pIoThread->getLastError());
+        qCritical() << "[DriverSerial]" << errMsg;
+        emit error(errMsg);
+        return false;
+    }
+    
     // 设置串口名称
     m_pSerialPort->setPortName(m_portName);
     
     // 打开串口
     if (m_pSerialPort->open(mode))
     {
+        if (!applyRs485(m_pSerialPort->handle()))
+        {
+            m_pSerialPort->close();
+            return false;
+        }
+        
+        // 发送不经过QSerialPort的写缓冲，直接对fd writev，内核缓冲满时等可写通知
+        delete m_pWriteNotifier;
+        m_pWriteNotifier = new QSocketNotifier(m_pSerialPort->handle(), QSocketNotifier::Write, this);
+        m_pWriteNotifier->setEnabled(false);
+        connect(m_pWriteNotifier, &QSocketNotifier::activated,
+                this, &DriverSerial::processWriteBuffer);
+        
         qInfo() << "[DriverSerial] ✓ 串口打开成功:" << m_portName;
+        
+        // 打开前已入队的数据
+        processWriteBuffer();
         emit opened();
         return true;
     }
@@ -102,8 +198,18 @@ bool DriverSerial::open(QIODevice::OpenMode mode)
  */
 void DriverSerial::close()
 {
+    if (m_pIoThread && m_pIoThread->isPortOpen())
+    {
+        m_pIoThread->closePort();
+        qInfo() << "[DriverSerial] 串口已关闭（I/O线程）:" << m_portName;
+        emit closed();
+        return;
+    }
+    
     if (m_pSerialPort && m_pSerialPort->isOpen())
     {
+        delete m_pWriteNotifier;
+        m_pWriteNotifier = nullptr;
         m_pSerialPort->close();
         qInfo() << "[DriverSerial] 串口已关闭:" << m_portName;
         emit closed();
@@ -116,6 +222,10 @@ void DriverSerial::close()
  */
 bool DriverSerial::isOpen() const
 {
+    if (m_pIoThread && m_pIoThread->isPortOpen())
+    {
+        return true;
+    }
     return m_pSerialPort && m_pSerialPort->isOpen();
 }
 
@@ -259,7 +369,7 @@ bool DriverSerial::configure(qint32 baudRate,
  */
 qint64 DriverSerial::write(const QByteArray &data)
 {
-    if (!m_pSerialPort || !m_pSerialPort->isOpen())
+    if (!isOpen())
     {
         qWarning() << "[DriverSerial] 串口未打开，无法写入";
         return -1;
@@ -270,13 +380,27 @@ qint64 DriverSerial::write(const QByteArray &data)
         return 0;
     }
     
-    // 将数据添加到写缓冲区
-    m_writeBuffer.append(data);
+    // 作为一个分段入队（共享data的存储，不拷贝）
+    if (!m_writeQueue.enqueue(data))
+    {
+        qWarning() << "[DriverSerial] 发送队列已满，拒绝写入:" << data.size() << "字节"
+                   << "排队:" << m_writeQueue.size() << "字节";
+        return -1;
+    }
+    
+    m_traceWriter.record(SERIAL_TRACE_DIR_TX, data.constData(), data.size(),
+                         SerialTraceWriter::monotonicUs());
     
-    qDebug() << "[DriverSerial] 数据加入写缓冲:" << data.size() << "字节，缓冲区总计:" << m_writeBuffer.size() << "字节";
+    if (!m_writeBackpressure && m_writeQueue.isAboveHighWater())
+    {
+        m_writeBackpressure = true;
+        qWarning() << "[DriverSerial] 发送队列超过高水位:" << m_writeQueue.size() << "字节";
+        emit writeBackpressure(true);
+    }
     
-    // 如果当前没有在发送，立即开始发送
-    if (!m_isWriting)
+    // 立即尝试写出；QSerialPort后端正在等可写通知时由通知继续
+    const bool ioThread = m_pIoThread && m_pIoThread->isPortOpen();
+    if (ioThread || !m_pWriteNotifier || !m_pWriteNotifier->isEnabled())
     {
         processWriteBuffer();
     }
@@ -300,8 +424,7 @@ qint64 DriverSerial::write(const QString &data)
  */
 QByteArray DriverSerial::readAll()
 {
-    QByteArray data = m_readBuffer;
-    m_readBuffer.clear();
+    QByteArray data = m_readBuffer.read(m_readBuffer.size());
     
     qDebug() << "[DriverSerial] 从读缓冲读取:" << data.size() << "字节";
     
@@ -322,8 +445,7 @@ QByteArray DriverSerial::read(qint64 maxSize)
         return QByteArray();
     }
     
-    QByteArray data = m_readBuffer.left(readSize);
-    m_readBuffer.remove(0, readSize);
+    QByteArray data = m_readBuffer.read(static_cast<int>(readSize));
     
     qDebug() << "[DriverSerial] 从读缓冲读取:" << data.size() << "字节，剩余:" << m_readBuffer.size() << "字节";
     
@@ -346,14 +468,44 @@ QByteArray DriverSerial::readLine()
     }
     
     // 读取一行（包含换行符）
-    QByteArray line = m_readBuffer.left(newlineIndex + 1);
-    m_readBuffer.remove(0, newlineIndex + 1);
+    QByteArray line = m_readBuffer.read(newlineIndex + 1);
     
     qDebug() << "[DriverSerial] 从读缓冲读取一行:" << line.size() << "字节，剩余:" << m_readBuffer.size() << "字节";
     
     return line;
 }
 
+/**
+ * @brief 查看数据但不从读缓冲区移除
+ * @param maxSize 最大字节数
+ * @return 读缓冲区开头的数据
+ */
+QByteArray DriverSerial::peek(qint64 maxSize) const
+{
+    return m_readBuffer.peek(static_cast<int>(qMin(maxSize, (qint64)m_readBuffer.size())));
+}
+
+/**
+ * @brief 丢弃读缓冲区开头的数据
+ * @param size 字节数
+ * @return 实际丢弃的字节数
+ */
+qint64 DriverSerial::skip(qint64 size)
+{
+    return m_readBuffer.consume(static_cast<int>(qMin(size, (qint64)m_readBuffer.size())));
+}
+
+/**
+ * @brief 在读缓冲区中查找字节
+ * @param c 目标字节
+ * @param from 起始偏移
+ * @return 偏移，-1表示未找到
+ */
+int DriverSerial::indexOf(char c, int from) const
+{
+    return m_readBuffer.indexOf(c, from);
+}
+
 /**
  * @brief 获取可读字节数（读缓冲区中的数据）
  * @return 可读字节数
@@ -370,11 +522,22 @@ qint64 DriverSerial::bytesAvailable() const
  */
 bool DriverSerial::waitForReadyRead(int msecs)
 {
-    if (!m_pSerialPort || !m_pSerialPort->isOpen())
+    if (!isOpen())
     {
         return false;
     }
     
+    // I/O线程后端直接等待条件变量，不经过事件循环
+    if (m_pIoThread && m_pIoThread->isPortOpen())
+    {
+        if (!m_pIoThread->waitForData(msecs))
+        {
+            return false;
+        }
+        onIoDataAvailable();
+        return true;
+    }
+    
     return m_pSerialPort->waitForReadyRead(msecs);
 }
 
@@ -384,8 +547,16 @@ bool DriverSerial::waitForReadyRead(int msecs)
 void DriverSerial::clear()
 {
     m_readBuffer.clear();
+    if (m_pFramer)
+    {
+        m_pFramer->reset();
+    }
     
-    if (m_pSerialPort)
+    if (m_pIoThread && m_pIoThread->isPortOpen())
+    {
+        m_pIoThread->clearInput();
+    }
+    else if (m_pSerialPort)
     {
         m_pSerialPort->clear();
     }
@@ -398,22 +569,8 @@ void DriverSerial::clear()
  */
 void DriverSerial::flush()
 {
-    // 处理所有待发送数据
-    while (!m_writeBuffer.isEmpty() && m_pSerialPort && m_pSerialPort->isOpen())
-    {
-        qint64 bytesWritten = m_pSerialPort->write(m_writeBuffer);
-        if (bytesWritten > 0)
-        {
-            m_writeBuffer.remove(0, bytesWritten);
-            m_pSerialPort->flush();
-        }
-        else
-        {
-            break;
-        }
-    }
-    
-    qDebug() << "[DriverSerial] 刷新发送缓冲区，剩余:" << m_writeBuffer.size() << "字节";
+    processWriteBuffer();
+    qDebug() << "[DriverSerial] 刷新发送缓冲区，剩余:" << m_writeQueue.size() << "字节";
 }
 
 // ========== 缓冲区管理 ==========
@@ -424,7 +581,12 @@ void DriverSerial::flush()
  */
 void DriverSerial::setReadBufferSize(qint64 size)
 {
-    m_readBufferMaxSize = size;
+    // 容量向上取整为2的幂
+    m_readBuffer.setCapacity(static_cast<int>(qBound((qint64)64, size, (qint64)(1 << 30))));
+    if (m_pFramer)
+    {
+        m_pFramer->reset();
+    }
     qDebug() << "[DriverSerial] 设置读缓冲区大小:" << size << "字节";
 }
 
@@ -443,7 +605,7 @@ qint64 DriverSerial::getReadBufferSize() const
  */
 qint64 DriverSerial::getWriteBufferSize() const
 {
-    return m_writeBuffer.size();
+    return m_writeQueue.size();
 }
 
 /**
@@ -452,6 +614,10 @@ qint64 DriverSerial::getWriteBufferSize() const
 void DriverSerial::clearReadBuffer()
 {
     m_readBuffer.clear();
+    if (m_pFramer)
+    {
+        m_pFramer->reset();
+    }
     qDebug() << "[DriverSerial] 清空读缓冲区";
 }
 
@@ -460,11 +626,199 @@ void DriverSerial::clearReadBuffer()
  */
 void DriverSerial::clearWriteBuffer()
 {
-    m_writeBuffer.clear();
-    m_isWriting = false;
+    m_writeQueue.clear();
+    if (m_pWriteNotifier)
+    {
+        m_pWriteNotifier->setEnabled(false);
+    }
+    onWriteProgress(0);
     qDebug() << "[DriverSerial] 清空写缓冲区";
 }
 
+/**
+ * @brief 设置发送队列上限
+ * @param maxBytes 最大排队字节数
+ * @param maxSegments 最大分段数
+ */
+void DriverSerial::setWriteQueueLimits(qint64 maxBytes, int maxSegments)
+{
+    m_writeQueue.setLimits(maxBytes, maxSegments);
+    qDebug() << "[DriverSerial] 设置发送队列上限:" << m_writeQueue.getMaxBytes() << "字节"
+             << maxSegments << "段";
+}
+
+// ========== 分帧 ==========
+
+/**
+ * @brief 设置分帧器
+ * @param framer 分帧器（接管所有权，nullptr表示不分帧）
+ */
+void DriverSerial::setFramer(SerialFramer *framer)
+{
+    if (framer == m_pFramer)
+    {
+        return;
+    }
+    
+    delete m_pFramer;
+    m_pFramer = framer;
+    
+    if (m_pFramer)
+    {
+        m_pFramer->reset();
+        qDebug() << "[DriverSerial] 设置分帧器:" << m_portName;
+        
+        // 缓冲区中已有的数据立即分帧
+        processFrames();
+    }
+}
+
+/**
+ * @brief 对读缓冲区中已有数据分帧
+ * @return 提取的帧数
+ */
+int DriverSerial::processFrames()
+{
+    if (!m_pFramer)
+    {
+        return 0;
+    }
+    
+    FrameSignalHandler handler(this);
+    return m_pFramer->process(m_readBuffer, &handler);
+}
+
+// ========== 独立I/O线程 ==========
+
+/**
+ * @brief 启用/停用独立I/O线程后端
+ * @param enable true=使用I/O线程, false=使用QSerialPort
+ * @param options I/O线程参数
+ * @return true=成功, false=串口已打开
+ */
+bool DriverSerial::setIoThreadEnabled(bool enable, const SerialIoOptions &options)
+{
+    if (isOpen())
+    {
+        qWarning() << "[DriverSerial] 串口已打开，请先关闭再切换后端:" << m_portName;
+        return false;
+    }
+    
+    m_useIoThread = enable;
+    m_ioOptions = options;
+    
+    if (enable && !m_pIoThread)
+    {
+        m_pIoThread = new SerialIoThread(this);
+        m_pIoThread->setListener(m_pDataListener);
+        m_pIoThread->setWriteQueue(&m_writeQueue);
+        m_pIoThread->setTraceWriter(&m_traceWriter);
+        
+        // I/O线程中发出，排队到本对象所属线程处理
+        connect(m_pIoThread, &SerialIoThread::dataAvailable,
+                this, &DriverSerial::onIoDataAvailable, Qt::QueuedConnection);
+        connect(m_pIoThread, &SerialIoThread::bytesWritten,
+                this, &DriverSerial::onWriteProgress, Qt::QueuedConnection);
+        connect(m_pIoThread, &SerialIoThread::errorOccurred,
+                this, &DriverSerial::onIoError, Qt::QueuedConnection);
+    }
+    
+    qInfo() << "[DriverSerial]" << m_portName << (enable ? "使用独立I/O线程" : "使用QSerialPort")
+            << "VMIN:" << options.vmin << "VTIME:" << options.vtime
+            << "低延迟:" << options.lowLatency;
+    return true;
+}
+
+/**
+ * @brief 设置接收监听器
+ * @param listener 监听器（nullptr表示不使用）
+ */
+void DriverSerial::setDataListener(SerialDataListener *listener)
+{
+    m_pDataListener = listener;
+    if (m_pIoThread)
+    {
+        m_pIoThread->setListener(listener);
+    }
+}
+
+// ========== RS-485 ==========
+
+/**
+ * @brief 设置RS-485方向控制
+ * @param config 方向控制参数
+ * @return true=成功, false=串口已打开
+ */
+bool DriverSerial::setRs485(const SerialRs485Config &config)
+{
+    if (isOpen())
+    {
+        qWarning() << "[DriverSerial] 串口已打开，请先关闭再设置RS-485:" << m_portName;
+        return false;
+    }
+    
+    m_rs485 = config;
+    qInfo() << "[DriverSerial]" << m_portName << "RS-485:" << SerialRs485Config::modeToString(config.mode)
+            << "RTS发送电平:" << (config.rtsOnSend ? "高" : "低")
+            << "前延迟:" << config.delayBeforeUs << "us"
+            << "后延迟:" << config.delayAfterUs << "us"
+            << "发送期间接收:" << config.rxDuringTx
+            << "GPIO:" << config.gpio;
+    return true;
+}
+
+/**
+ * @brief 在已打开的fd上启用内核RS-485
+ * @param fd 串口文件描述符
+ * @return true=成功或无需设置, false=失败（已发出error信号）
+ */
+bool DriverSerial::applyRs485(int fd)
+{
+    if (m_rs485Active != SerialRs485Config::Kernel)
+    {
+        return true;
+    }
+    
+    QString errorString;
+    if (!SerialRs485::applyKernel(fd, m_rs485, &errorString))
+    {
+        QString errMsg = QString("设置RS-485失败: %1 - %2").arg(m_portName, errorString);
+        qCritical() << "[DriverSerial]" << errMsg;
+        emit error(errMsg);
+        return false;
+    }
+    
+    qInfo() << "[DriverSerial] RS-485内核方向控制已启用:" << m_portName;
+    return true;
+}
+
+// ========== 抓包 ==========
+
+/**
+ * @brief 开始抓包
+ * @param path 抓包文件路径
+ * @return true=成功, false=失败
+ */
+bool DriverSerial::startTrace(const QString &path)
+{
+    if (!m_traceWriter.start(path, m_portName, getBaudRate()))
+    {
+        QString errMsg = QString("[%1] 抓包启动失败: %2").arg(m_portName, m_traceWriter.getLastError());
+        qWarning() << "[DriverSerial]" << errMsg;
+        emit error(errMsg);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 停止抓包
+ */
+void DriverSerial::stopTrace()
+{
+    m_traceWriter.stop();
+}
+
 // ========== 状态查询 ==========
 
 /**
@@ -495,6 +849,10 @@ qint32 DriverSerial::getBaudRate() const
  */
 QString DriverSerial::getErrorString() const
 {
+    if (m_useIoThread && m_pIoThread)
+    {
+        return m_pIoThread->getLastError();
+    }
     if (m_pSerialPort)
     {
         return m_pSerialPort->errorString();
@@ -605,25 +963,71 @@ void DriverSerial::onReadyRead()
     
     if (!data.isEmpty())
     {
-        // 添加到读缓冲区
-        m_readBuffer.append(data);
-        
-        // 检查缓冲区是否超出最大限制
-        if (m_readBuffer.size() > m_readBufferMaxSize)
+        const qint64 timestampUs = SerialIoThread::monotonicUs();
+        m_traceWriter.record(SERIAL_TRACE_DIR_RX, data.constData(), data.size(), timestampUs);
+        if (m_pDataListener)
         {
-            qWarning() << "[DriverSerial] 读缓冲区溢出，清空旧数据";
-            qWarning() << "  当前大小:" << m_readBuffer.size() << "最大:" << m_readBufferMaxSize;
-            
-            // 只保留最新的数据
-            m_readBuffer = m_readBuffer.right(m_readBufferMaxSize / 2);
+            m_pDataListener->serialDataReceived(data.constData(), data.size(), timestampUs);
         }
-        
-        qDebug() << "[DriverSerial] 接收数据:" << data.size() << "字节"
-                 << "读缓冲区总计:" << m_readBuffer.size() << "字节";
-        
-        // 发送数据接收信号（通知上层有新数据）
-        emit dataReceived(data);
+        handleReceivedData(data);
+    }
+}
+
+/**
+ * @brief I/O线程数据到达槽函数
+ */
+void DriverSerial::onIoDataAvailable()
+{
+    if (!m_pIoThread)
+    {
+        return;
+    }
+    
+    QByteArray data = m_pIoThread->takeData();
+    if (!data.isEmpty())
+    {
+        handleReceivedData(data);
+    }
+}
+
+/**
+ * @brief I/O线程错误槽函数
+ * @param errorString 错误描述
+ */
+void DriverSerial::onIoError(const QString &errorString)
+{
+    QString fullMsg = QString("[%1] %2").arg(m_portName, errorString);
+    qCritical() << "[DriverSerial]" << fullMsg;
+    emit error(fullMsg);
+}
+
+/**
+ * @brief 新数据进入读缓冲区并通知上层
+ * @param data 新接收的数据
+ */
+void DriverSerial::handleReceivedData(const QByteArray &data)
+{
+    // 添加到读缓冲区，满时丢弃最旧的数据（只移动读位置）
+    int dropped = m_readBuffer.append(data.constData(), data.size());
+    
+    if (dropped > 0)
+    {
+        qWarning() << "[DriverSerial] 读缓冲区溢出，丢弃旧数据:" << dropped << "字节"
+                   << "容量:" << m_readBuffer.capacity()
+                   << "累计溢出:" << m_readBuffer.getOverflowCount() << "次";
+    }
+    
+    qDebug() << "[DriverSerial] 接收数据:" << data.size() << "字节"
+             << "读缓冲区总计:" << m_readBuffer.size() << "字节";
+    
+    // 设置了分帧器时直接在读缓冲区上提取完整帧
+    if (m_pFramer)
+    {
+        processFrames();
     }
+    
+    // 发送数据接收信号（通知上层有新数据）
+    emit dataReceived(data);
 }
 
 /**
@@ -682,49 +1086,79 @@ void DriverSerial::onError(QSerialPort::SerialPortError serialError)
 /**
  * @brief 处理写缓冲区数据（异步发送）
  * 
- * 当底层串口完成一次写操作时，会触发bytesWritten信号，
- * 此函数被调用，继续发送写缓冲区中的剩余数据
+ * 用writev一次提交多个分段，部分写出只移动队首偏移。
+ * QSerialPort后端在内核缓冲区满时启用可写通知，可写后再次调用本函数；
+ * I/O线程后端先在本线程写，剩余部分由I/O线程发送
  */
 void DriverSerial::processWriteBuffer()
 {
-    if (!m_pSerialPort || !m_pSerialPort->isOpen())
+    if (!isOpen())
     {
-        m_isWriting = false;
         return;
     }
     
-    // 如果写缓冲区为空，标记发送完成
-    if (m_writeBuffer.isEmpty())
+    if (m_writeQueue.isEmpty())
     {
-        m_isWriting = false;
-        qDebug() << "[DriverSerial] 写缓冲区已发送完成";
+        if (m_pWriteNotifier)
+        {
+            m_pWriteNotifier->setEnabled(false);
+        }
+        return;
+    }
+    
+    if (m_pIoThread && m_pIoThread->isPortOpen())
+    {
+        qint64 written = m_pIoThread->startWrite();
+        if (written < 0)
+        {
+            onIoError(m_pIoThread->getLastError());
+            return;
+        }
+        onWriteProgress(written);
         return;
     }
     
-    // 标记正在发送
-    m_isWriting = true;
+    int errorCode = 0;
+    qint64 written = m_writeQueue.writeTo(m_pSerialPort->handle(), &errorCode);
     
-    // 一次最多发送4KB数据（避免阻塞）
-    const qint64 chunkSize = 4096;
-    qint64 sendSize = qMin((qint64)m_writeBuffer.size(), chunkSize);
+    if (errorCode != 0)
+    {
+        QString fullMsg = QString("[%1] 写入错误: %2").arg(m_portName, QString::fromLocal8Bit(strerror(errorCode)));
+        qCritical() << "[DriverSerial]" << fullMsg;
+        m_pWriteNotifier->setEnabled(false);
+        emit error(fullMsg);
+        return;
+    }
     
-    QByteArray chunk = m_writeBuffer.left(sendSize);
+    // 还有剩余时等待可写通知
+    m_pWriteNotifier->setEnabled(!m_writeQueue.isEmpty());
     
-    // 发送数据
-    qint64 bytesWritten = m_pSerialPort->write(chunk);
+    qDebug() << "[DriverSerial] 发送数据:" << written << "字节"
+             << "写缓冲区剩余:" << m_writeQueue.size() << "字节";
     
-    if (bytesWritten > 0)
+    onWriteProgress(written);
+}
+
+/**
+ * @brief 写出进度处理
+ * @param bytes 本次写出的字节数
+ */
+void DriverSerial::onWriteProgress(qint64 bytes)
+{
+    if (bytes > 0)
     {
-        // 从缓冲区移除已发送的数据
-        m_writeBuffer.remove(0, bytesWritten);
-        
-        qDebug() << "[DriverSerial] 发送数据:" << bytesWritten << "字节"
-                 << "写缓冲区剩余:" << m_writeBuffer.size() << "字节";
+        emit bytesWritten(bytes);
     }
-    else
+    
+    if (m_writeBackpressure && m_writeQueue.isBelowLowWater())
     {
-        qWarning() << "[DriverSerial] 发送失败";
-        m_isWriting = false;
+        m_writeBackpressure = false;
+        qDebug() << "[DriverSerial] 发送队列降到低水位，解除背压";
+        emit writeBackpressure(false);
+    }
+    
+    if (bytes > 0 && m_writeQueue.isEmpty())
+    {
+        emit writeQueueDrained();
     }
 }
-
@@ -0,0 +1,309 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialCrc16.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CRC16/MODBUS公共实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/serial/SerialCrc16.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SERIAL_CRC16_HAVE_NEON 1
+#endif
+
+namespace {
+
+const quint16 POLY_REFLECTED = 0xA001;     // 0x8005按位反射
+const quint32 POLY_NORMAL = 0x18005;        // x^16 + x^15 + x^2 + 1
+
+quint32 reverseBits(quint32 value, int width)
+{
+    quint32 result = 0;
+    for (int i = 0; i < width; ++i)
+    {
+        result = (result << 1) | ((value >> i) & 1);
+    }
+    return result;
+}
+
+/**
+ * @brief 查表数据（局部静态变量，首次使用时线程安全地初始化）
+ */
+struct Crc16ModbusTables
+{
+    quint16 slice[8][256];      // slice[0]为普通查表，slice[k]为其后还有k个字节时的贡献
+
+#ifdef SERIAL_CRC16_HAVE_NEON
+    // NEON: 16字节块中第p个字节b的贡献 = 归约(b ⊗ rev16(x^(16+8*(15-p)) mod P))
+    quint8 kLo[16];             // 位置常数低字节
+    quint8 kHi[16];             // 位置常数高字节
+    quint16 fold0[256];         // 23位乘积归约表（位0-7）
+    quint16 fold1[256];         // 位8-15
+    quint16 fold2[128];         // 位16-22
+#endif
+
+    Crc16ModbusTables()
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            quint16 crc = static_cast<quint16>(i);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 1) ? static_cast<quint16>((crc >> 1) ^ POLY_REFLECTED) : static_cast<quint16>(crc >> 1);
+            }
+            slice[0][i] = crc;
+        }
+        for (int k = 1; k < 8; ++k)
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                const quint16 prev = slice[k - 1][i];
+                slice[k][i] = static_cast<quint16>((prev >> 8) ^ slice[0][prev & 0xFF]);
+            }
+        }
+
+#ifdef SERIAL_CRC16_HAVE_NEON
+        // 反射域的无进位乘法: rev8(a) ⊗ rev16(k) = rev23(a ⊗ k)，
+        // 所以原始字节直接乘反射后的常数，归约前再整体反转
+        for (int p = 0; p < 16; ++p)
+        {
+            quint32 k = 1;
+            const int shift = 16 + 8 * (15 - p);
+            for (int i = 0; i < shift; ++i)
+            {
+                k <<= 1;
+                if (k & 0x10000)
+                {
+                    k ^= POLY_NORMAL;
+                }
+            }
+            const quint32 kr = reverseBits(k, 16);
+            kLo[p] = static_cast<quint8>(kr & 0xFF);
+            kHi[p] = static_cast<quint8>(kr >> 8);
+        }
+        for (int i = 0; i < 256; ++i)
+        {
+            fold0[i] = reduceReversed(static_cast<quint32>(i));
+            fold1[i] = reduceReversed(static_cast<quint32>(i) << 8);
+            if (i < 128)
+            {
+                fold2[i] = reduceReversed(static_cast<quint32>(i) << 16);
+            }
+        }
+#endif
+    }
+
+#ifdef SERIAL_CRC16_HAVE_NEON
+    /**
+     * @brief 23位反转乘积 → 16位反射余数
+     */
+    static quint16 reduceReversed(quint32 product)
+    {
+        quint32 value = reverseBits(product, 23);
+        for (int bit = 22; bit >= 16; --bit)
+        {
+            if (value & (1u << bit))
+            {
+                value ^= POLY_NORMAL << (bit - 16);
+            }
+        }
+        return static_cast<quint16>(reverseBits(value, 16));
+    }
+#endif
+};
+
+const Crc16ModbusTables &tables()
+{
+    static const Crc16ModbusTables instance;
+    return instance;
+}
+
+quint16 updateBitwise(quint16 crc, const quint8 *p, int length)
+{
+    for (int i = 0; i < length; ++i)
+    {
+        crc ^= p[i];
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 1) ? static_cast<quint16>((crc >> 1) ^ POLY_REFLECTED) : static_cast<quint16>(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+quint16 updateTable(quint16 crc, const quint8 *p, int length)
+{
+    const quint16 *table = tables().slice[0];
+    for (int i = 0; i < length; ++i)
+    {
+        crc = static_cast<quint16>((crc >> 8) ^ table[(crc ^ p[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+quint16 updateSlicing8(quint16 crc, const quint8 *p, int length)
+{
+    const Crc16ModbusTables &t = tables();
+    while (length >= 8)
+    {
+        crc = static_cast<quint16>(t.slice[7][(crc ^ p[0]) & 0xFF] ^ t.slice[6][((crc >> 8) ^ p[1]) & 0xFF] ^
+                                   t.slice[5][p[2]] ^ t.slice[4][p[3]] ^
+                                   t.slice[3][p[4]] ^ t.slice[2][p[5]] ^
+                                   t.slice[1][p[6]] ^ t.slice[0][p[7]]);
+        p += 8;
+        length -= 8;
+    }
+    return updateTable(crc, p, length);
+}
+
+#ifdef SERIAL_CRC16_HAVE_NEON
+quint16 updateNeon(quint16 crc, const quint8 *p, int length)
+{
+    const Crc16ModbusTables &t = tables();
+    const poly8x8_t kLo0 = vreinterpret_p8_u8(vld1_u8(t.kLo));
+    const poly8x8_t kLo1 = vreinterpret_p8_u8(vld1_u8(t.kLo + 8));
+    const poly8x8_t kHi0 = vreinterpret_p8_u8(vld1_u8(t.kHi));
+    const poly8x8_t kHi1 = vreinterpret_p8_u8(vld1_u8(t.kHi + 8));
+
+    while (length >= 16)
+    {
+        // 当前CRC异或进块的前两个字节（低字节在前）
+        uint8x16_t block = vld1q_u8(p);
+        block = veorq_u8(block, vreinterpretq_u8_u16(vsetq_lane_u16(crc, vdupq_n_u16(0), 0)));
+
+        const poly8x8_t b0 = vreinterpret_p8_u8(vget_low_u8(block));
+        const poly8x8_t b1 = vreinterpret_p8_u8(vget_high_u8(block));
+
+        // 每个字节与其位置常数的低/高字节相乘，16位乘积
+        const uint16x8_t lo = veorq_u16(vreinterpretq_u16_p16(vmull_p8(b0, kLo0)),
+                                        vreinterpretq_u16_p16(vmull_p8(b1, kLo1)));
+        const uint16x8_t hi = veorq_u16(vreinterpretq_u16_p16(vmull_p8(b0, kHi0)),
+                                        vreinterpretq_u16_p16(vmull_p8(b1, kHi1)));
+
+        // 横向异或8个通道
+        const uint16x4_t lo4 = veor_u16(vget_low_u16(lo), vget_high_u16(lo));
+        const uint16x4_t hi4 = veor_u16(vget_low_u16(hi), vget_high_u16(hi));
+        quint64 lw = vget_lane_u64(vreinterpret_u64_u16(lo4), 0);
+        quint64 hw = vget_lane_u64(vreinterpret_u64_u16(hi4), 0);
+        lw ^= lw >> 32;
+        lw ^= lw >> 16;
+        hw ^= hw >> 32;
+        hw ^= hw >> 16;
+
+        const quint32 product = static_cast<quint32>(lw & 0xFFFF) ^ (static_cast<quint32>(hw & 0xFFFF) << 8);
+        crc = static_cast<quint16>(t.fold0[product & 0xFF] ^ t.fold1[(product >> 8) & 0xFF] ^
+                                   t.fold2[(product >> 16) & 0x7F]);
+        p += 16;
+        length -= 16;
+    }
+    return updateSlicing8(crc, p, length);
+}
+#endif
+
+} // namespace
+
+/**
+ * @brief 增量更新一个字节
+ */
+void SerialCrc16::update(quint8 byte)
+{
+    m_crc = static_cast<quint16>((m_crc >> 8) ^ tables().slice[0][(m_crc ^ byte) & 0xFF]);
+}
+
+/**
+ * @brief 在已有CRC上继续计算（默认实现）
+ */
+quint16 SerialCrc16::modbusUpdate(quint16 crc, const char *data, int length)
+{
+    const quint8 *p = reinterpret_cast<const quint8 *>(data);
+#if defined(SERIAL_CRC16_HAVE_NEON) && defined(SERIAL_CRC16_NEON)
+    return updateNeon(crc, p, length);
+#else
+    return updateSlicing8(crc, p, length);
+#endif
+}
+
+/**
+ * @brief 用指定实现计算
+ */
+quint16 SerialCrc16::modbusUpdate(quint16 crc, const char *data, int length, Method method)
+{
+    const quint8 *p = reinterpret_cast<const quint8 *>(data);
+    switch (method)
+    {
+    case Bitwise:
+        return updateBitwise(crc, p, length);
+    case Slicing8:
+        return updateSlicing8(crc, p, length);
+    case Neon:
+#ifdef SERIAL_CRC16_HAVE_NEON
+        return updateNeon(crc, p, length);
+#else
+        return updateTable(crc, p, length);
+#endif
+    case Table:
+    default:
+        return updateTable(crc, p, length);
+    }
+}
+
+/**
+ * @brief 校验帧尾CRC
+ */
+bool SerialCrc16::modbusCheck(const char *frame, int length)
+{
+    if (length < 3)
+    {
+        return false;
+    }
+    const quint16 crc = modbus(frame, length - 2);
+    return static_cast<quint8>(frame[length - 2]) == (crc & 0xFF) &&
+           static_cast<quint8>(frame[length - 1]) == (crc >> 8);
+}
+
+/**
+ * @brief 帧尾追加CRC
+ */
+void SerialCrc16::modbusAppend(QByteArray &frame)
+{
+    const quint16 crc = modbus(frame.constData(), frame.size());
+    frame.append(static_cast<char>(crc & 0xFF));
+    frame.append(static_cast<char>(crc >> 8));
+}
+
+SerialCrc16::Method SerialCrc16::defaultMethod()
+{
+#if defined(SERIAL_CRC16_HAVE_NEON) && defined(SERIAL_CRC16_NEON)
+    return Neon;
+#else
+    return Slicing8;
+#endif
+}
+
+bool SerialCrc16::isAvailable(Method method)
+{
+#ifdef SERIAL_CRC16_HAVE_NEON
+    Q_UNUSED(method);
+    return true;
+#else
+    return method != Neon;
+#endif
+}
+
+const char *SerialCrc16::methodName(Method method)
+{
+    switch (method)
+    {
+    case Bitwise:  return "bitwise";
+    case Table:    return "table";
+    case Slicing8: return "slicing8";
+    case Neon:     return "neon";
+    }
+    return "unknown";
+}
@@ -0,0 +1,719 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialFramer.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口分帧引擎实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 CRC16/MODBUS改用SerialCrc16公共实现
+ ***************************************************************/
+
+#include "drivers/serial/SerialFramer.h"
+#include "drivers/serial/SerialCrc16.h"
+
+namespace {
+
+const unsigned char SLIP_END = 0xC0;
+const unsigned char SLIP_ESC = 0xDB;
+const unsigned char SLIP_ESC_END = 0xDC;
+const unsigned char SLIP_ESC_ESC = 0xDD;
+
+/**
+ * @brief CRC16查表（局部静态变量，首次使用时线程安全地初始化）
+ */
+struct Crc16Tables
+{
+    quint16 ccitt[256];     // 多项式0x1021
+
+    Crc16Tables()
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            quint16 crc = static_cast<quint16>(i << 8);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 0x8000) ? static_cast<quint16>((crc << 1) ^ 0x1021) : static_cast<quint16>(crc << 1);
+            }
+            ccitt[i] = crc;
+        }
+    }
+};
+
+const Crc16Tables &crc16Tables()
+{
+    static const Crc16Tables tables;
+    return tables;
+}
+
+} // namespace
+
+// ========== SerialFramer ==========
+
+/**
+ * @brief 构造函数
+ */
+SerialFramer::SerialFramer()
+    : m_crcType(CrcNone)
+    , m_ringPosition(0)
+    , m_ringPositionValid(false)
+    , m_frameCount(0)
+    , m_crcErrorCount(0)
+    , m_discardedBytes(0)
+{
+}
+
+/**
+ * @brief 析构函数
+ */
+SerialFramer::~SerialFramer()
+{
+}
+
+/**
+ * @brief 复位扫描状态
+ */
+void SerialFramer::reset()
+{
+    m_ringPositionValid = false;
+    resetScan();
+}
+
+/**
+ * @brief 从读缓冲区提取所有完整帧
+ * @note 先消费再回调：视图指向的数据在下次写入缓冲区前不会被覆盖，
+ *       回调中对串口的read()/skip()不会与分帧状态冲突
+ */
+int SerialFramer::process(SerialRingBuffer &ring, Handler *handler)
+{
+    int frames = 0;
+
+    for (;;)
+    {
+        // 缓冲区被外部读取、清空或溢出丢弃后，已扫描的偏移失效
+        if (!m_ringPositionValid || ring.readPosition() != m_ringPosition)
+        {
+            resetScan();
+            m_ringPosition = ring.readPosition();
+            m_ringPositionValid = true;
+        }
+
+        ScanResult result = { 0, 0, 0 };
+        const ScanStatus status = scan(ring, &result);
+        if (status == NeedMore)
+        {
+            break;
+        }
+
+        if (status == Discard)
+        {
+            m_discardedBytes += static_cast<quint64>(ring.consume(result.consume));
+            m_ringPosition = ring.readPosition();
+            resetScan();
+            continue;
+        }
+
+        const SerialFrameView raw = frameView(ring, result.frameOffset, result.frameLength);
+        const SerialFrameView frame = decode(raw, &m_decoded);
+        if (frame.length < 0 || !checkCrc(frame))
+        {
+            // 校验失败：按分帧器规则丢弃后重新同步
+            m_crcErrorCount++;
+            m_discardedBytes += static_cast<quint64>(ring.consume(resyncAfterError(result)));
+            m_ringPosition = ring.readPosition();
+            resetScan();
+            continue;
+        }
+
+        m_discardedBytes += static_cast<quint64>(result.frameOffset);
+        ring.consume(result.consume);
+        m_ringPosition = ring.readPosition();
+        resetScan();
+
+        m_frameCount++;
+        frames++;
+        if (handler)
+        {
+            handler->onFrame(frame);
+        }
+    }
+
+    return frames;
+}
+
+/**
+ * @brief 默认不解码
+ */
+SerialFrameView SerialFramer::decode(const SerialFrameView &raw, QByteArray *out)
+{
+    Q_UNUSED(out);
+    return raw;
+}
+
+/**
+ * @brief 帧视图（未跨回绕点时直接指向缓冲区）
+ */
+SerialFrameView SerialFramer::frameView(const SerialRingBuffer &ring, int offset, int length)
+{
+    SerialFrameView view = { "", 0 };
+    if (length <= 0)
+    {
+        return view;
+    }
+
+    SerialRingBuffer::Span span = ring.span(offset);
+    if (span.length >= length)
+    {
+        view.data = span.data;
+        view.length = length;
+        return view;
+    }
+
+    if (m_linear.size() < length)
+    {
+        m_linear.resize(length);
+    }
+    view.data = m_linear.constData();
+    view.length = ring.peek(m_linear.data(), length, offset);
+    return view;
+}
+
+/**
+ * @brief 查找多字节模式
+ */
+int SerialFramer::indexOfPattern(const SerialRingBuffer &ring, const QByteArray &pattern, int from)
+{
+    const int patternSize = pattern.size();
+    const int size = ring.size();
+    int pos = qMax(0, from);
+
+    while (pos + patternSize <= size)
+    {
+        const int idx = ring.indexOf(pattern.at(0), pos);
+        if (idx < 0 || idx + patternSize > size)
+        {
+            return -1;
+        }
+
+        int i = 1;
+        while (i < patternSize && ring.at(idx + i) == pattern.at(i))
+        {
+            ++i;
+        }
+        if (i == patternSize)
+        {
+            return idx;
+        }
+        pos = idx + 1;
+    }
+    return -1;
+}
+
+/**
+ * @brief CRC字节数
+ */
+int SerialFramer::crcSize() const
+{
+    switch (m_crcType)
+    {
+    case CrcModbus:
+    case CrcCcitt:
+        return 2;
+    case CrcSum8:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief 校验帧末尾的CRC
+ */
+bool SerialFramer::checkCrc(const SerialFrameView &frame) const
+{
+    const int n = crcSize();
+    if (n == 0)
+    {
+        return true;
+    }
+    if (frame.length < n)
+    {
+        return false;
+    }
+
+    const int bodyLength = frame.length - n;
+    const unsigned char *tail = reinterpret_cast<const unsigned char *>(frame.data + bodyLength);
+
+    switch (m_crcType)
+    {
+    case CrcModbus:
+        return crc16Modbus(frame.data, bodyLength) == static_cast<quint16>(tail[0] | (tail[1] << 8));
+    case CrcCcitt:
+        return crc16Ccitt(frame.data, bodyLength) == static_cast<quint16>((tail[0] << 8) | tail[1]);
+    case CrcSum8:
+        return sum8(frame.data, bodyLength) == tail[0];
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief CRC16/MODBUS
+ */
+quint16 SerialFramer::crc16Modbus(const char *data, int length)
+{
+    return SerialCrc16::modbus(data, length);
+}
+
+/**
+ * @brief CRC16/CCITT-FALSE
+ */
+quint16 SerialFramer::crc16Ccitt(const char *data, int length)
+{
+    const quint16 *table = crc16Tables().ccitt;
+    quint16 crc = 0xFFFF;
+    for (int i = 0; i < length; ++i)
+    {
+        crc = static_cast<quint16>((crc << 8) ^ table[((crc >> 8) ^ static_cast<quint8>(data[i])) & 0xFF]);
+    }
+    return crc;
+}
+
+/**
+ * @brief 8位累加和
+ */
+quint8 SerialFramer::sum8(const char *data, int length)
+{
+    quint8 sum = 0;
+    for (int i = 0; i < length; ++i)
+    {
+        sum = static_cast<quint8>(sum + static_cast<quint8>(data[i]));
+    }
+    return sum;
+}
+
+// ========== SerialDelimiterFramer ==========
+
+/**
+ * @brief 构造函数
+ */
+SerialDelimiterFramer::SerialDelimiterFramer(const QByteArray &delimiter, int maxLength)
+    : m_delimiter(delimiter.isEmpty() ? QByteArray("\n") : delimiter)
+    , m_maxLength(qMax(1, maxLength))
+    , m_scanned(0)
+{
+}
+
+/**
+ * @brief 查找分隔符（从上次检查到的位置继续）
+ */
+SerialFramer::ScanStatus SerialDelimiterFramer::scan(const SerialRingBuffer &ring, ScanResult *result)
+{
+    const int delimiterSize = m_delimiter.size();
+    const int idx = indexOfPattern(ring, m_delimiter, m_scanned);
+
+    if (idx < 0)
+    {
+        // 末尾可能是不完整的分隔符，保留delimiterSize-1字节下次再查
+        m_scanned = qMax(m_scanned, ring.size() - delimiterSize + 1);
+        if (m_scanned > m_maxLength)
+        {
+            result->consume = m_scanned;
+            return Discard;
+        }
+        return NeedMore;
+    }
+
+    // 空帧和超长帧直接丢弃
+    if (idx == 0 || idx > m_maxLength)
+    {
+        result->consume = idx + delimiterSize;
+        return Discard;
+    }
+
+    result->frameOffset = 0;
+    result->frameLength = idx;
+    result->consume = idx + delimiterSize;
+    return FrameFound;
+}
+
+// ========== SerialFixedLengthFramer ==========
+
+/**
+ * @brief 构造函数
+ */
+SerialFixedLengthFramer::SerialFixedLengthFramer(int length, const QByteArray &header)
+    : m_length(qMax(qMax(1, length), header.size()))
+    , m_header(header)
+    , m_scanned(0)
+    , m_synced(false)
+{
+}
+
+/**
+ * @brief 同步帧头后按定长取帧
+ */
+SerialFramer::ScanStatus SerialFixedLengthFramer::scan(const SerialRingBuffer &ring, ScanResult *result)
+{
+    if (!m_header.isEmpty() && !m_synced)
+    {
+        const int idx = indexOfPattern(ring, m_header, m_scanned);
+        if (idx < 0)
+        {
+            m_scanned = qMax(m_scanned, ring.size() - m_header.size() + 1);
+            if (m_scanned > 0)
+            {
+                result->consume = m_scanned;
+                return Discard;
+            }
+            return NeedMore;
+        }
+        if (idx > 0)
+        {
+            result->consume = idx;
+            return Discard;
+        }
+        m_synced = true;
+    }
+
+    if (ring.size() < m_length)
+    {
+        return NeedMore;
+    }
+
+    result->frameOffset = 0;
+    result->frameLength = m_length;
+    result->consume = m_length;
+    return FrameFound;
+}
+
+/**
+ * @brief 校验失败时滑动1字节重新同步
+ */
+int SerialFixedLengthFramer::resyncAfterError(const ScanResult &result) const
+{
+    Q_UNUSED(result);
+    return 1;
+}
+
+// ========== SerialLengthPrefixFramer ==========
+
+/**
+ * @brief 构造函数
+ */
+SerialLengthPrefixFramer::SerialLengthPrefixFramer(const QByteArray &header, int lengthOffset,
+                                                   int lengthSize, bool bigEndian,
+                                                   int lengthAdjust, int maxLength)
+    : m_header(header)
+    , m_lengthOffset(qMax(0, lengthOffset))
+    , m_lengthSize((lengthSize == 2 || lengthSize == 4) ? lengthSize : 1)
+    , m_bigEndian(bigEndian)
+    , m_lengthAdjust(lengthAdjust)
+    , m_maxLength(qMax(1, maxLength))
+    , m_scanned(0)
+    , m_synced(false)
+    , m_frameLength(-1)
+{
+}
+
+/**
+ * @brief 同步帧头、解析长度字段、等待完整帧
+ */
+SerialFramer::ScanStatus SerialLengthPrefixFramer::scan(const SerialRingBuffer &ring, ScanResult *result)
+{
+    if (!m_header.isEmpty() && !m_synced)
+    {
+        const int idx = indexOfPattern(ring, m_header, m_scanned);
+        if (idx < 0)
+        {
+            m_scanned = qMax(m_scanned, ring.size() - m_header.size() + 1);
+            if (m_scanned > 0)
+            {
+                result->consume = m_scanned;
+                return Discard;
+            }
+            return NeedMore;
+        }
+        if (idx > 0)
+        {
+            result->consume = idx;
+            return Discard;
+        }
+        m_synced = true;
+    }
+
+    if (m_frameLength < 0)
+    {
+        const int fieldEnd = m_lengthOffset + m_lengthSize;
+        if (ring.size() < fieldEnd)
+        {
+            return NeedMore;
+        }
+
+        quint32 value = 0;
+        for (int i = 0; i < m_lengthSize; ++i)
+        {
+            const int pos = m_bigEndian ? (m_lengthOffset + i) : (fieldEnd - 1 - i);
+            value = (value << 8) | static_cast<quint8>(ring.at(pos));
+        }
+
+        // 长度不合理说明帧头是误匹配，丢弃1字节重新同步
+        const qint64 total = static_cast<qint64>(value) + m_lengthAdjust;
+        if (total < qMax(fieldEnd, m_header.size()) || total > m_maxLength)
+        {
+            result->consume = 1;
+            return Discard;
+        }
+        m_frameLength = static_cast<int>(total);
+    }
+
+    if (ring.size() < m_frameLength)
+    {
+        return NeedMore;
+    }
+
+    result->frameOffset = 0;
+    result->frameLength = m_frameLength;
+    result->consume = m_frameLength;
+    return FrameFound;
+}
+
+/**
+ * @brief 校验失败时丢弃1字节重新同步
+ */
+int SerialLengthPrefixFramer::resyncAfterError(const ScanResult &result) const
+{
+    Q_UNUSED(result);
+    return 1;
+}
+
+// ========== SerialSlipFramer ==========
+
+/**
+ * @brief 构造函数
+ */
+SerialSlipFramer::SerialSlipFramer(int maxLength)
+    : m_maxLength(qMax(1, maxLength))
+    , m_scanned(0)
+{
+}
+
+/**
+ * @brief 查找END
+ */
+SerialFramer::ScanStatus SerialSlipFramer::scan(const SerialRingBuffer &ring, ScanResult *result)
+{
+    const int idx = ring.indexOf(static_cast<char>(SLIP_END), m_scanned);
+    if (idx < 0)
+    {
+        // 编码后最长为原长2倍
+        m_scanned = ring.size();
+        if (m_scanned > m_maxLength * 2)
+        {
+            result->consume = m_scanned;
+            return Discard;
+        }
+        return NeedMore;
+    }
+
+    if (idx == 0 || idx > m_maxLength * 2)
+    {
+        result->consume = idx + 1;
+        return Discard;
+    }
+
+    result->frameOffset = 0;
+    result->frameLength = idx;
+    result->consume = idx + 1;
+    return FrameFound;
+}
+
+/**
+ * @brief 去转义
+ */
+SerialFrameView SerialSlipFramer::decode(const SerialFrameView &raw, QByteArray *out)
+{
+    SerialFrameView view = { "", -1 };
+    if (out->size() < raw.length)
+    {
+        out->resize(raw.length);
+    }
+
+    char *dst = out->data();
+    int length = 0;
+    for (int i = 0; i < raw.length; ++i)
+    {
+        unsigned char c = static_cast<unsigned char>(raw.data[i]);
+        if (c == SLIP_ESC)
+        {
+            if (++i >= raw.length)
+            {
+                return view;
+            }
+            c = static_cast<unsigned char>(raw.data[i]);
+            if (c == SLIP_ESC_END)
+            {
+                c = SLIP_END;
+            }
+            else if (c == SLIP_ESC_ESC)
+            {
+                c = SLIP_ESC;
+            }
+            else
+            {
+                return view;
+            }
+        }
+        dst[length++] = static_cast<char>(c);
+    }
+
+    view.data = dst;
+    view.length = length;
+    return view;
+}
+
+/**
+ * @brief SLIP编码
+ */
+QByteArray SerialSlipFramer::encode(const QByteArray &payload)
+{
+    QByteArray out;
+    out.reserve(payload.size() * 2 + 2);
+    out.append(static_cast<char>(SLIP_END));
+    for (int i = 0; i < payload.size(); ++i)
+    {
+        const unsigned char c = static_cast<unsigned char>(payload.at(i));
+        if (c == SLIP_END)
+        {
+            out.append(static_cast<char>(SLIP_ESC));
+            out.append(static_cast<char>(SLIP_ESC_END));
+        }
+        else if (c == SLIP_ESC)
+        {
+            out.append(static_cast<char>(SLIP_ESC));
+            out.append(static_cast<char>(SLIP_ESC_ESC));
+        }
+        else
+        {
+            out.append(static_cast<char>(c));
+        }
+    }
+    out.append(static_cast<char>(SLIP_END));
+    return out;
+}
+
+// ========== SerialCobsFramer ==========
+
+/**
+ * @brief 构造函数
+ */
+SerialCobsFramer::SerialCobsFramer(int maxLength)
+    : m_maxLength(qMax(1, maxLength))
+    , m_scanned(0)
+{
+}
+
+/**
+ * @brief 查找0x00
+ */
+SerialFramer::ScanStatus SerialCobsFramer::scan(const SerialRingBuffer &ring, ScanResult *result)
+{
+    // 编码开销为每254字节1字节
+    const int maxEncoded = m_maxLength + m_maxLength / 254 + 1;
+    const int idx = ring.indexOf('\0', m_scanned);
+    if (idx < 0)
+    {
+        m_scanned = ring.size();
+        if (m_scanned > maxEncoded)
+        {
+            result->consume = m_scanned;
+            return Discard;
+        }
+        return NeedMore;
+    }
+
+    if (idx == 0 || idx > maxEncoded)
+    {
+        result->consume = idx + 1;
+        return Discard;
+    }
+
+    result->frameOffset = 0;
+    result->frameLength = idx;
+    result->consume = idx + 1;
+    return FrameFound;
+}
+
+/**
+ * @brief COBS解码
+ */
+SerialFrameView SerialCobsFramer::decode(const SerialFrameView &raw, QByteArray *out)
+{
+    SerialFrameView view = { "", -1 };
+    if (out->size() < raw.length)
+    {
+        out->resize(raw.length);
+    }
+
+    char *dst = out->data();
+    int length = 0;
+    int i = 0;
+    while (i < raw.length)
+    {
+        const int code = static_cast<unsigned char>(raw.data[i++]);
+        if (code == 0 || i + code - 1 > raw.length)
+        {
+            return view;
+        }
+        for (int j = 1; j < code; ++j)
+        {
+            dst[length++] = raw.data[i++];
+        }
+        if (code != 0xFF && i < raw.length)
+        {
+            dst[length++] = '\0';
+        }
+    }
+
+    view.data = dst;
+    view.length = length;
+    return view;
+}
+
+/**
+ * @brief COBS编码（含结尾0x00）
+ */
+QByteArray SerialCobsFramer::encode(const QByteArray &payload)
+{
+    QByteArray out;
+    out.reserve(payload.size() + payload.size() / 254 + 2);
+
+    int codeIndex = 0;
+    int code = 1;
+    out.append('\0');   // 占位，稍后写入code
+    for (int i = 0; i < payload.size(); ++i)
+    {
+        if (payload.at(i) == '\0')
+        {
+            out[codeIndex] = static_cast<char>(code);
+            codeIndex = out.size();
+            out.append('\0');
+            code = 1;
+            continue;
+        }
+
+        out.append(payload.at(i));
+        if (++code == 0xFF)
+        {
+            out[codeIndex] = static_cast<char>(code);
+            codeIndex = out.size();
+            out.append('\0');
+            code = 1;
+        }
+    }
+    out[codeIndex] = static_cast<char>(code);
+    out.append('\0');
+    return out;
+}
@@ -0,0 +1,747 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialIoThread.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口独立I/O线程实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 发送改为共享分段队列（SerialWriteQueue），用writev写出
+ *   3. 2026-10-18 增加RS-485 GPIO方向控制
+ *   4. 2026-10-18 接收数据记录到抓包写入器
+ *   5. 2026-10-18 termios设置移到SerialTermios，与串口TCP桥共用
+ *   6. 2026-10-18 等待发送完成按已写字节数睡眠，不再忙等LSR
+ ***************************************************************/
+
+#include "drivers/serial/SerialIoThread.h"
+#include "drivers/serial/SerialTermios.h"
+#include <QMutexLocker>
+#include <QDebug>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <limits.h>
+#include <termios.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <linux/serial.h>
+
+namespace {
+
+const qint64 SPIN_THRESHOLD_NS = 200000;   // 剩余时间小于该值时忙等（调度唤醒误差量级）
+
+qint64 monotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief 精确等待到指定时刻：先睡眠，最后一小段忙等
+ */
+void waitUntilNs(qint64 deadline)
+{
+    for (;;)
+    {
+        const qint64 remain = deadline - monotonicNs();
+        if (remain <= 0)
+        {
+            return;
+        }
+        if (remain > SPIN_THRESHOLD_NS)
+        {
+            const qint64 wake = deadline - SPIN_THRESHOLD_NS;
+            struct timespec ts;
+            ts.tv_sec = wake / 1000000000LL;
+            ts.tv_nsec = wake % 1000000000LL;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief 单调时钟（微秒）
+ */
+qint64 SerialIoThread::monotonicUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 构造函数
+ */
+SerialIoThread::SerialIoThread(QObject *parent)
+    : QThread(parent)
+    , m_fd(-1)
+    , m_epollFd(-1)
+    , m_eventFd(-1)
+    , m_timerFd(-1)
+    , m_running(0)
+    , m_stage(65536)
+    , m_stageReleased(false)
+    , m_notifyPending(0)
+    , m_pendingBytes(0)
+    , m_writeQueue(nullptr)
+    , m_txArmed(false)
+    , m_charTimeNs(0)
+    , m_listener(nullptr)
+    , m_traceWriter(nullptr)
+    , m_rxBytes(0)
+    , m_wakeups(0)
+    , m_stageDropped(0)
+    , m_turnarounds(0)
+{
+}
+
+/**
+ * @brief 析构函数
+ */
+SerialIoThread::~SerialIoThread()
+{
+    closePort();
+}
+
+/**
+ * @brief 打开tty、配置termios并启动线程
+ */
+bool SerialIoThread::openPort(const QString &portName, qint32 baudRate,
+                              QSerialPort::DataBits dataBits, QSerialPort::Parity parity,
+                              QSerialPort::StopBits stopBits, QSerialPort::FlowControl flowControl,
+                              const SerialIoOptions &options)
+{
+    closePort();
+
+    m_portName = portName;
+    m_options = options;
+    m_options.vmin = qBound(0, m_options.vmin, 255);
+    m_options.vtime = qBound(0, m_options.vtime, 255);
+    m_options.wakeupBytes = qMax(1, m_options.wakeupBytes);
+
+    // 按字节数合并或VMIN>1时必须有间隔定时器收尾，否则帧尾会一直滞留；
+    // 未指定时取3.5个字符时间（每字符按11位计）
+    const bool kernelMinWake = m_options.vmin > 1 && m_options.vtime == 0;
+    if (m_options.interByteGapUs <= 0 && (m_options.wakeupBytes > 1 || kernelMinWake) && baudRate > 0)
+    {
+        m_options.interByteGapUs = static_cast<int>(qMax<qint64>(1, 38500000LL / baudRate));
+        qInfo() << "[SerialIoThread] 未指定字节间隔，按3.5字符取" << m_options.interByteGapUs << "us";
+    }
+
+    m_fd = ::open(portName.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        setLastError(QString("打开串口失败: %1 - %2").arg(portName, strerror(errno)));
+        return false;
+    }
+
+    if (!configureTermios(baudRate, dataBits, parity, stopBits, flowControl))
+    {
+        closeFds();
+        return false;
+    }
+    setLowLatency(m_options.lowLatency);
+
+    // 字符时间: 起始位 + 数据位 + 校验位 + 停止位
+    const int frameBits = 1 + static_cast<int>(dataBits)
+                        + (parity == QSerialPort::NoParity ? 0 : 1)
+                        + (stopBits == QSerialPort::TwoStop ? 2 : 1);
+    m_charTimeNs = baudRate > 0 ? frameBits * 1000000000LL / baudRate : 0;
+
+    if (m_rs485.mode == SerialRs485Config::Gpio)
+    {
+        QString gpioError;
+        if (!m_dirGpio.open(m_rs485.gpio, m_rs485.rtsOnSend, &gpioError))
+        {
+            setLastError(gpioError);
+            closeFds();
+            return false;
+        }
+    }
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_epollFd < 0 || m_eventFd < 0 || m_timerFd < 0)
+    {
+        setLastError(QString("创建epoll/eventfd/timerfd失败: %1").arg(strerror(errno)));
+        closeFds();
+        return false;
+    }
+
+    const int fds[3] = { m_fd, m_eventFd, m_timerFd };
+    for (int i = 0; i < 3; ++i)
+    {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fds[i];
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fds[i], &ev) < 0)
+        {
+            setLastError(QString("epoll_ctl失败: %1").arg(strerror(errno)));
+            m_dirGpio.close();
+            closeFds();
+            return false;
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_stageMutex);
+        m_stage.setCapacity(m_options.stageSize);
+        m_stage.clear();
+        m_stageReleased = false;
+    }
+    m_txArmed = false;
+    m_turnarounds = 0;
+    m_notifyPending.store(0);
+    m_pendingBytes = 0;
+
+    m_running.store(1);
+    start(static_cast<QThread::Priority>(m_options.priority));
+
+    qInfo() << "[SerialIoThread] I/O线程已启动:" << portName
+            << "VMIN:" << m_options.vmin << "VTIME:" << m_options.vtime
+            << "唤醒字节数:" << m_options.wakeupBytes
+            << "字节间隔:" << m_options.interByteGapUs << "us"
+            << (m_dirGpio.isOpen() ? "RS-485 GPIO方向控制" : "");
+    return true;
+}
+
+/**
+ * @brief 停止线程并关闭tty
+ */
+void SerialIoThread::closePort()
+{
+    if (isRunning())
+    {
+        m_running.store(0);
+        kick();
+        wait();
+    }
+
+    if (m_fd >= 0)
+    {
+        qInfo() << "[SerialIoThread] I/O线程已停止:" << m_portName
+                << "接收:" << m_rxBytes << "字节，唤醒:" << m_wakeups << "次";
+    }
+    m_dirGpio.close();
+    closeFds();
+
+    // 唤醒仍在waitForData()中的调用者
+    QMutexLocker locker(&m_stageMutex);
+    m_stageReady.wakeAll();
+}
+
+/**
+ * @brief 关闭所有文件描述符
+ */
+void SerialIoThread::closeFds()
+{
+    int *fds[4] = { &m_timerFd, &m_eventFd, &m_epollFd, &m_fd };
+    for (int i = 0; i < 4; ++i)
+    {
+        if (*fds[i] >= 0)
+        {
+            ::close(*fds[i]);
+            *fds[i] = -1;
+        }
+    }
+}
+
+/**
+ * @brief 配置termios（原始模式）
+ */
+bool SerialIoThread::configureTermios(qint32 baudRate, QSerialPort::DataBits dataBits,
+                                      QSerialPort::Parity parity, QSerialPort::StopBits stopBits,
+                                      QSerialPort::FlowControl flowControl)
+{
+    SerialLineSettings settings;
+    settings.baudRate = baudRate;
+    settings.dataBits = dataBits;
+    settings.parity = parity;
+    settings.stopBits = stopBits;
+    settings.flowControl = flowControl;
+
+    QString errorString;
+    if (!SerialTermios::apply(m_fd, settings, m_options.vmin, m_options.vtime, &errorString))
+    {
+        setLastError(errorString);
+        return false;
+    }
+    tcflush(m_fd, TCIOFLUSH);
+    return true;
+}
+
+/**
+ * @brief 设置ASYNC_LOW_LATENCY（驱动不支持时只警告）
+ */
+void SerialIoThread::setLowLatency(bool enable)
+{
+    struct serial_struct ss;
+    if (ioctl(m_fd, TIOCGSERIAL, &ss) < 0)
+    {
+        qWarning() << "[SerialIoThread] 驱动不支持TIOCGSERIAL，忽略低延迟设置:" << m_portName;
+        return;
+    }
+
+    if (enable)
+    {
+        ss.flags |= ASYNC_LOW_LATENCY;
+    }
+    else
+    {
+        ss.flags &= ~ASYNC_LOW_LATENCY;
+    }
+
+    if (ioctl(m_fd, TIOCSSERIAL, &ss) < 0)
+    {
+        qWarning() << "[SerialIoThread] 设置ASYNC_LOW_LATENCY失败:" << strerror(errno);
+    }
+}
+
+/**
+ * @brief 线程主循环
+ */
+void SerialIoThread::run()
+{
+    struct epoll_event events[4];
+
+    while (m_running.load() != 0)
+    {
+        const int n = epoll_wait(m_epollFd, events, 4, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            setLastError(QString("epoll_wait失败: %1").arg(strerror(errno)));
+            emit errorOccurred(getLastError());
+            break;
+        }
+
+        for (int i = 0; i < n && m_running.load() != 0; ++i)
+        {
+            const int fd = events[i].data.fd;
+            const quint32 mask = events[i].events;
+
+            if (fd == m_fd)
+            {
+                if (mask & EPOLLIN)
+                {
+                    readAvailable(false);
+                }
+                if (mask & EPOLLOUT)
+                {
+                    flushTx();
+                }
+                if ((mask & (EPOLLERR | EPOLLHUP)) && !(mask & EPOLLIN))
+                {
+                    setLastError(QString("串口断开: %1").arg(m_portName));
+                    emit errorOccurred(getLastError());
+                    m_running.store(0);
+                }
+            }
+            else if (fd == m_eventFd)
+            {
+                quint64 value;
+                while (::read(m_eventFd, &value, sizeof(value)) > 0)
+                {
+                }
+
+                // 调用线程未写完的剩余部分
+                flushTx();
+            }
+            else if (fd == m_timerFd)
+            {
+                quint64 expirations;
+                while (::read(m_timerFd, &expirations, sizeof(expirations)) > 0)
+                {
+                }
+
+                // 字节间隔到期：收取不足VMIN的尾部字节，并通知累计的数据
+                readAvailable(true);
+            }
+        }
+    }
+
+    // 退出前把已暂存的数据交给上层
+    notifyData();
+}
+
+/**
+ * @brief 读出tty中所有数据并按唤醒提示通知上层
+ */
+void SerialIoThread::readAvailable(bool fromTimer)
+{
+    char buffer[4096];
+    bool received = false;
+
+    for (;;)
+    {
+        const ssize_t n = ::read(m_fd, buffer, sizeof(buffer));
+        if (n > 0)
+        {
+            received = true;
+            m_rxBytes += static_cast<quint64>(n);
+            m_pendingBytes += static_cast<int>(n);
+
+            const qint64 timestampUs = monotonicUs();
+            if (m_traceWriter)
+            {
+                m_traceWriter->record(SERIAL_TRACE_DIR_RX, buffer, static_cast<int>(n), timestampUs);
+            }
+
+            // 监听器在本线程同步处理（最低延迟路径）
+            SerialDataListener *listener = m_listener.loadAcquire();
+            if (listener)
+            {
+                listener->serialDataReceived(buffer, static_cast<int>(n), timestampUs);
+            }
+
+            QMutexLocker locker(&m_stageMutex);
+            const int dropped = m_stage.append(buffer, static_cast<int>(n));
+            if (dropped > 0)
+            {
+                m_stageDropped += static_cast<quint64>(dropped);
+            }
+            continue;
+        }
+
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            setLastError(QString("读取失败: %1").arg(strerror(errno)));
+            emit errorOccurred(getLastError());
+            m_running.store(0);
+        }
+        break;
+    }
+
+    const bool useGap = m_options.interByteGapUs > 0;
+    if (received)
+    {
+        // 字节数达到提示或不使用间隔时立即通知，否则等间隔到期
+        if (!useGap || m_pendingBytes >= m_options.wakeupBytes)
+        {
+            notifyData();
+        }
+        if (useGap)
+        {
+            armGapTimer();
+        }
+    }
+    else if (fromTimer)
+    {
+        notifyData();
+    }
+}
+
+/**
+ * @brief 启动（重置）字节间隔定时器
+ */
+void SerialIoThread::armGapTimer()
+{
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = m_options.interByteGapUs / 1000000;
+    spec.it_value.tv_nsec = static_cast<long>(m_options.interByteGapUs % 1000000) * 1000;
+    timerfd_settime(m_timerFd, 0, &spec, nullptr);
+}
+
+/**
+ * @brief 通知上层取数据
+ */
+void SerialIoThread::notifyData()
+{
+    if (m_pendingBytes == 0)
+    {
+        return;
+    }
+    m_pendingBytes = 0;
+    m_wakeups++;
+
+    {
+        QMutexLocker locker(&m_stageMutex);
+        m_stageReleased = true;
+        m_stageReady.wakeAll();
+    }
+
+    // 上层未取走前不重复发信号，避免事件队列堆积
+    if (m_notifyPending.testAndSetOrdered(0, 1))
+    {
+        emit dataAvailable();
+    }
+}
+
+/**
+ * @brief 取出暂存区全部数据
+ */
+QByteArray SerialIoThread::takeData()
+{
+    QMutexLocker locker(&m_stageMutex);
+    m_notifyPending.store(0);
+    m_stageReleased = false;
+    return m_stage.read(m_stage.size());
+}
+
+/**
+ * @brief 等待数据
+ */
+bool SerialIoThread::waitForData(int msecs)
+{
+    QMutexLocker locker(&m_stageMutex);
+    if (!m_stageReleased && isPortOpen())
+    {
+        m_stageReady.wait(&m_stageMutex, msecs < 0 ? ULONG_MAX : static_cast<unsigned long>(msecs));
+    }
+    return !m_stage.isEmpty();
+}
+
+/**
+ * @brief 清空暂存区和内核输入队列
+ */
+void SerialIoThread::clearInput()
+{
+    QMutexLocker locker(&m_stageMutex);
+    m_stage.clear();
+    m_stageReleased = false;
+    if (m_fd >= 0)
+    {
+        tcflush(m_fd, TCIFLUSH);
+    }
+}
+
+/**
+ * @brief 开始发送队列中的数据（调用线程）
+ */
+qint64 SerialIoThread::startWrite()
+{
+    if (m_fd < 0 || !m_writeQueue)
+    {
+        return -1;
+    }
+
+    // 半双工发送要在I/O线程中连同方向切换一起完成
+    if (m_dirGpio.isOpen())
+    {
+        kick();
+        return 0;
+    }
+
+    // 在调用线程直接writev，省去一次线程切换
+    int errorCode = 0;
+    const qint64 written = m_writeQueue->writeTo(m_fd, &errorCode);
+    if (errorCode != 0)
+    {
+        setLastError(QString("写入失败: %1").arg(strerror(errorCode)));
+        return -1;
+    }
+
+    // 剩余部分由I/O线程在可写时发送
+    if (!m_writeQueue->isEmpty())
+    {
+        kick();
+    }
+    return written;
+}
+
+/**
+ * @brief 发送队列中的数据（I/O线程）
+ */
+void SerialIoThread::flushTx()
+{
+    if (!m_writeQueue)
+    {
+        return;
+    }
+
+    if (m_dirGpio.isOpen())
+    {
+        transmitHalfDuplex();
+        return;
+    }
+
+    int errorCode = 0;
+    const qint64 written = m_writeQueue->writeTo(m_fd, &errorCode);
+    if (errorCode != 0)
+    {
+        setLastError(QString("写入失败: %1").arg(strerror(errorCode)));
+        emit errorOccurred(getLastError());
+    }
+
+    // 还有剩余时等待EPOLLOUT
+    const bool needArm = errorCode == 0 && !m_writeQueue->isEmpty();
+    if (needArm != m_txArmed)
+    {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = needArm ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        ev.data.fd = m_fd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_MOD, m_fd, &ev);
+        m_txArmed = needArm;
+    }
+
+    if (written > 0)
+    {
+        emit bytesWritten(written);
+    }
+}
+
+/**
+ * @brief RS-485半双工发送（I/O线程，GPIO方向控制）
+ *
+ * 整个突发期间占用本线程，不再等EPOLLOUT：总线归本机所有，
+ * 尽快发完并换回接收比响应其他事件更重要
+ */
+void SerialIoThread::transmitHalfDuplex()
+{
+    if (m_writeQueue->isEmpty())
+    {
+        return;
+    }
+
+    // 先收走已到达的数据，下面清空输入队列时不会误删
+    readAvailable(false);
+
+    m_dirGpio.setTransmit(true);
+    if (m_rs485.delayBeforeUs > 0)
+    {
+        waitUntilNs(monotonicNs() + static_cast<qint64>(m_rs485.delayBeforeUs) * 1000);
+    }
+
+    const qint64 startNs = monotonicNs();
+    qint64 total = 0;
+    int errorCode = 0;
+    while (!m_writeQueue->isEmpty() && m_running.load() != 0)
+    {
+        total += m_writeQueue->writeTo(m_fd, &errorCode);
+        if (errorCode != 0)
+        {
+            break;
+        }
+        if (!m_writeQueue->isEmpty())
+        {
+            struct pollfd pfd;
+            pfd.fd = m_fd;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            poll(&pfd, 1, 100);
+        }
+    }
+
+    waitTxComplete(startNs, total);
+    if (m_rs485.delayAfterUs > 0)
+    {
+        waitUntilNs(monotonicNs() + static_cast<qint64>(m_rs485.delayAfterUs) * 1000);
+    }
+
+    // 收发器回波（RE未随DE关闭时）不交给上层
+    if (!m_rs485.rxDuringTx)
+    {
+        tcflush(m_fd, TCIFLUSH);
+    }
+    m_dirGpio.setTransmit(false);
+    m_turnarounds++;
+
+    if (errorCode != 0)
+    {
+        setLastError(QString("写入失败: %1").arg(strerror(errorCode)));
+        emit errorOccurred(getLastError());
+    }
+    if (total > 0)
+    {
+        emit bytesWritten(total);
+    }
+}
+
+/**
+ * @brief 等待最后一个字符的停止位移出
+ *
+ * TIOCOUTQ不含已进入UART FIFO的字节（imx上8字节的请求write()后即为0），
+ * 不能用来估算剩余时间。按开始写出的时刻和写出的字节数睡到预计发完，
+ * 再以约一个字符时间为步长轮询LSR的TEMT位；驱动不支持TIOCSERGETLSR
+ * 时退回tcdrain（精度取决于驱动）
+ * @param startNs 开始写出的时刻（monotonicNs）
+ * @param bytes 本次突发写出的字节数
+ */
+void SerialIoThread::waitTxComplete(qint64 startNs, qint64 bytes)
+{
+    if (m_charTimeNs > 0)
+    {
+        waitUntilNs(startNs + bytes * m_charTimeNs);
+    }
+
+    // 超时保护: 硬件FIFO（按64字符计）的发送时间 + 10毫秒
+    const qint64 stepNs = qBound(10000LL, m_charTimeNs, 1000000LL);
+    const qint64 deadline = monotonicNs() + 64 * m_charTimeNs + 10000000LL;
+    for (;;)
+    {
+        unsigned int lsr = 0;
+        if (ioctl(m_fd, TIOCSERGETLSR, &lsr) < 0)
+        {
+            tcdrain(m_fd);
+            return;
+        }
+        if (lsr & TIOCSER_TEMT)
+        {
+            return;
+        }
+        if (monotonicNs() > deadline)
+        {
+            qWarning() << "[SerialIoThread] 等待发送完成超时:" << m_portName;
+            return;
+        }
+
+        struct timespec ts;
+        ts.tv_sec = stepNs / 1000000000LL;
+        ts.tv_nsec = stepNs % 1000000000LL;
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, nullptr);
+    }
+}
+
+/**
+ * @brief 唤醒I/O线程
+ */
+void SerialIoThread::kick()
+{
+    if (m_eventFd >= 0)
+    {
+        const quint64 one = 1;
+        ssize_t ret = ::write(m_eventFd, &one, sizeof(one));
+        Q_UNUSED(ret);
+    }
+}
+
+/**
+ * @brief 记录错误
+ */
+void SerialIoThread::setLastError(const QString &error)
+{
+    qCritical() << "[SerialIoThread]" << error;
+    QMutexLocker locker(&m_errorMutex);
+    m_lastError = error;
+}
+
+/**
+ * @brief 获取最后的错误
+ */
+QString SerialIoThread::getLastError() const
+{
+    QMutexLocker locker(&m_errorMutex);
+    return m_lastError;
+}
@@ -0,0 +1,432 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialRfc2217.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: RFC 2217服务端编解码实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/serial/SerialRfc2217.h"
+#include <QDebug>
+
+#include <string.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+
+namespace {
+
+// Telnet命令
+const uchar TELNET_SE = 240;
+const uchar TELNET_SB = 250;
+const uchar TELNET_WILL = 251;
+const uchar TELNET_WONT = 252;
+const uchar TELNET_DO = 253;
+const uchar TELNET_DONT = 254;
+const uchar TELNET_IAC = 255;
+
+// Telnet选项
+const uchar OPTION_BINARY = 0;
+const uchar OPTION_SGA = 3;
+const uchar OPTION_COM_PORT = 44;
+
+// COM-PORT-OPTION命令（客户端→服务端，服务端回复加100）
+const uchar CPO_SIGNATURE = 0;
+const uchar CPO_SET_BAUDRATE = 1;
+const uchar CPO_SET_DATASIZE = 2;
+const uchar CPO_SET_PARITY = 3;
+const uchar CPO_SET_STOPSIZE = 4;
+const uchar CPO_SET_CONTROL = 5;
+const uchar CPO_SET_LINESTATE_MASK = 10;
+const uchar CPO_SET_MODEMSTATE_MASK = 11;
+const uchar CPO_PURGE_DATA = 12;
+const uchar CPO_SERVER_OFFSET = 100;
+
+const char SIGNATURE[] = "IMX6ULL serial bridge";
+
+bool sameSettings(const SerialLineSettings &a, const SerialLineSettings &b)
+{
+    return a.baudRate == b.baudRate && a.dataBits == b.dataBits && a.parity == b.parity &&
+           a.stopBits == b.stopBits && a.flowControl == b.flowControl;
+}
+
+} // namespace
+
+/**
+ * @brief 构造函数
+ */
+SerialRfc2217::SerialRfc2217()
+    : m_fd(-1)
+    , m_lineChanges(0)
+    , m_break(false)
+    , m_state(StateData)
+    , m_command(0)
+    , m_subLength(0)
+    , m_replyHead(0)
+    , m_replyTail(0)
+{
+}
+
+/**
+ * @brief 新连接开始（重置解码状态，写入初始协商）
+ */
+void SerialRfc2217::reset(int fd, const SerialLineSettings &settings)
+{
+    m_fd = fd;
+    m_settings = settings;
+    m_lineChanges = 0;
+    m_break = false;
+    m_state = StateData;
+    m_subLength = 0;
+    m_replyHead = 0;
+    m_replyTail = 0;
+
+    sendCommand(TELNET_WILL, OPTION_BINARY);
+    sendCommand(TELNET_DO, OPTION_BINARY);
+    sendCommand(TELNET_WILL, OPTION_SGA);
+    sendCommand(TELNET_DO, OPTION_COM_PORT);
+}
+
+/**
+ * @brief 解码网络数据
+ */
+int SerialRfc2217::decode(const uchar *in, int length, uchar *out)
+{
+    int count = 0;
+    for (int i = 0; i < length; ++i)
+    {
+        const uchar b = in[i];
+        switch (m_state)
+        {
+        case StateData:
+            if (b == TELNET_IAC)
+            {
+                m_state = StateIac;
+            }
+            else
+            {
+                out[count++] = b;
+            }
+            break;
+
+        case StateIac:
+            if (b == TELNET_IAC)
+            {
+                out[count++] = b;
+                m_state = StateData;
+            }
+            else if (b >= TELNET_WILL)
+            {
+                m_command = b;
+                m_state = StateOption;
+            }
+            else if (b == TELNET_SB)
+            {
+                m_subLength = 0;
+                m_state = StateSub;
+            }
+            else
+            {
+                m_state = StateData;    // NOP、AYT等不处理
+            }
+            break;
+
+        case StateOption:
+            handleOption(m_command, b);
+            m_state = StateData;
+            break;
+
+        case StateSub:
+            if (b == TELNET_IAC)
+            {
+                m_state = StateSubIac;
+            }
+            else if (m_subLength < static_cast<int>(sizeof(m_sub)))
+            {
+                m_sub[m_subLength++] = b;
+            }
+            break;
+
+        case StateSubIac:
+            if (b == TELNET_IAC)
+            {
+                if (m_subLength < static_cast<int>(sizeof(m_sub)))
+                {
+                    m_sub[m_subLength++] = b;
+                }
+                m_state = StateSub;
+            }
+            else
+            {
+                if (b == TELNET_SE)
+                {
+                    handleSubnegotiation();
+                }
+                m_state = StateData;
+            }
+            break;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 转义串口数据（0xFF → IAC IAC）
+ */
+int SerialRfc2217::escape(const uchar *in, int length, uchar *out)
+{
+    int count = 0;
+    for (int i = 0; i < length; ++i)
+    {
+        out[count++] = in[i];
+        if (in[i] == TELNET_IAC)
+        {
+            out[count++] = TELNET_IAC;
+        }
+    }
+    return count;
+}
+
+void SerialRfc2217::consumeReply(int bytes)
+{
+    m_replyHead += bytes;
+    if (m_replyHead >= m_replyTail)
+    {
+        m_replyHead = 0;
+        m_replyTail = 0;
+    }
+}
+
+/**
+ * @brief 处理WILL/WONT/DO/DONT
+ */
+void SerialRfc2217::handleOption(uchar command, uchar option)
+{
+    if (command == TELNET_DO)
+    {
+        if (option != OPTION_BINARY && option != OPTION_SGA)
+        {
+            sendCommand(TELNET_WONT, option);
+        }
+    }
+    else if (command == TELNET_WILL)
+    {
+        if (option != OPTION_BINARY && option != OPTION_COM_PORT)
+        {
+            sendCommand(TELNET_DONT, option);
+        }
+    }
+}
+
+void SerialRfc2217::handleSubnegotiation()
+{
+    if (m_subLength >= 2 && m_sub[0] == OPTION_COM_PORT)
+    {
+        handleComPort(m_sub[1], m_sub + 2, m_subLength - 2);
+    }
+}
+
+/**
+ * @brief 处理COM-PORT-OPTION命令并回复实际值
+ */
+void SerialRfc2217::handleComPort(uchar command, const uchar *value, int length)
+{
+    const SerialLineSettings previous = m_settings;
+    const uchar request = (length > 0) ? value[0] : 0;
+    uchar reply[4];
+
+    switch (command)
+    {
+    case CPO_SIGNATURE:
+        if (length == 0)
+        {
+            sendComPort(command, reinterpret_cast<const uchar *>(SIGNATURE), sizeof(SIGNATURE) - 1);
+        }
+        return;
+
+    case CPO_SET_BAUDRATE:
+        if (length >= 4)
+        {
+            const qint32 baud = static_cast<qint32>((quint32(value[0]) << 24) | (quint32(value[1]) << 16) |
+                                                    (quint32(value[2]) << 8) | value[3]);
+            if (baud > 0 && SerialTermios::isSupportedBaudRate(baud))
+            {
+                m_settings.baudRate = baud;
+            }
+        }
+        reply[0] = static_cast<uchar>(m_settings.baudRate >> 24);
+        reply[1] = static_cast<uchar>(m_settings.baudRate >> 16);
+        reply[2] = static_cast<uchar>(m_settings.baudRate >> 8);
+        reply[3] = static_cast<uchar>(m_settings.baudRate);
+        break;
+
+    case CPO_SET_DATASIZE:
+        if (request >= 5 && request <= 8)
+        {
+            m_settings.dataBits = static_cast<QSerialPort::DataBits>(request);
+        }
+        reply[0] = static_cast<uchar>(m_settings.dataBits);
+        break;
+
+    case CPO_SET_PARITY:
+        switch (request)
+        {
+        case 1: m_settings.parity = QSerialPort::NoParity; break;
+        case 2: m_settings.parity = QSerialPort::OddParity; break;
+        case 3: m_settings.parity = QSerialPort::EvenParity; break;
+        case 4: m_settings.parity = QSerialPort::MarkParity; break;
+        case 5: m_settings.parity = QSerialPort::SpaceParity; break;
+        default: break;
+        }
+        switch (m_settings.parity)
+        {
+        case QSerialPort::OddParity: reply[0] = 2; break;
+        case QSerialPort::EvenParity: reply[0] = 3; break;
+        case QSerialPort::MarkParity: reply[0] = 4; break;
+        case QSerialPort::SpaceParity: reply[0] = 5; break;
+        default: reply[0] = 1; break;
+        }
+        break;
+
+    case CPO_SET_STOPSIZE:
+        if (request == 1)
+        {
+            m_settings.stopBits = QSerialPort::OneStop;
+        }
+        else if (request == 2)
+        {
+            m_settings.stopBits = QSerialPort::TwoStop;
+        }
+        reply[0] = (m_settings.stopBits == QSerialPort::TwoStop) ? 2 : 1;
+        break;
+
+    case CPO_SET_CONTROL:
+        reply[0] = request;
+        switch (request)
+        {
+        case 1: m_settings.flowControl = QSerialPort::NoFlowControl; break;
+        case 2: m_settings.flowControl = QSerialPort::SoftwareControl; break;
+        case 3: m_settings.flowControl = QSerialPort::HardwareControl; break;
+        case 5:
+            m_break = ioctl(m_fd, TIOCSBRK) == 0;
+            reply[0] = m_break ? 5 : 6;
+            break;
+        case 6:
+            ioctl(m_fd, TIOCCBRK);
+            m_break = false;
+            break;
+        case 8:
+        case 9:
+        case 11:
+        case 12:
+        {
+            int bits = (request <= 9) ? TIOCM_DTR : TIOCM_RTS;
+            ioctl(m_fd, (request == 8 || request == 11) ? TIOCMBIS : TIOCMBIC, &bits);
+            break;
+        }
+        default:
+            break;
+        }
+        if (request == 0 || request <= 3)
+        {
+            reply[0] = (m_settings.flowControl == QSerialPort::SoftwareControl) ? 2
+                     : (m_settings.flowControl == QSerialPort::HardwareControl) ? 3 : 1;
+        }
+        else if (request == 4)
+        {
+            reply[0] = m_break ? 5 : 6;
+        }
+        else if (request == 7 || request == 10)
+        {
+            int bits = 0;
+            ioctl(m_fd, TIOCMGET, &bits);
+            if (request == 7)
+            {
+                reply[0] = (bits & TIOCM_DTR) ? 8 : 9;
+            }
+            else
+            {
+                reply[0] = (bits & TIOCM_RTS) ? 11 : 12;
+            }
+        }
+        break;
+
+    case CPO_SET_LINESTATE_MASK:
+    case CPO_SET_MODEMSTATE_MASK:
+        reply[0] = request;     // 不主动上报状态，掩码只确认
+        break;
+
+    case CPO_PURGE_DATA:
+        if (request == 1)
+        {
+            tcflush(m_fd, TCIFLUSH);
+        }
+        else if (request == 2)
+        {
+            tcflush(m_fd, TCOFLUSH);
+        }
+        else if (request == 3)
+        {
+            tcflush(m_fd, TCIOFLUSH);
+        }
+        reply[0] = request;
+        break;
+
+    default:
+        return;     // 流控暂停/恢复等通知不回复
+    }
+
+    if (!sameSettings(previous, m_settings))
+    {
+        QString errorString;
+        if (SerialTermios::apply(m_fd, m_settings, 1, 0, &errorString))
+        {
+            m_lineChanges++;
+        }
+        else
+        {
+            qWarning() << "[SerialRfc2217] 修改线路参数失败:" << errorString;
+            m_settings = previous;
+            handleComPort(command, nullptr, 0);     // 按原参数回复
+            return;
+        }
+    }
+
+    sendComPort(command, reply, (command == CPO_SET_BAUDRATE) ? 4 : 1);
+}
+
+void SerialRfc2217::appendReply(const uchar *data, int length)
+{
+    if (m_replyTail + length > static_cast<int>(sizeof(m_reply)))
+    {
+        return;     // 客户端不读取回复时丢弃
+    }
+    memcpy(m_reply + m_replyTail, data, length);
+    m_replyTail += length;
+}
+
+void SerialRfc2217::sendCommand(uchar command, uchar option)
+{
+    const uchar data[3] = { TELNET_IAC, command, option };
+    appendReply(data, sizeof(data));
+}
+
+/**
+ * @brief 回复COM-PORT-OPTION子协商（值中的0xFF转义）
+ */
+void SerialRfc2217::sendComPort(uchar command, const uchar *value, int length)
+{
+    uchar data[sizeof(SIGNATURE) * 2 + 8];
+    int count = 0;
+    data[count++] = TELNET_IAC;
+    data[count++] = TELNET_SB;
+    data[count++] = OPTION_COM_PORT;
+    data[count++] = static_cast<uchar>(command + CPO_SERVER_OFFSET);
+    count += escape(value, length, data + count);
+    data[count++] = TELNET_IAC;
+    data[count++] = TELNET_SE;
+    appendReply(data, count);
+}
@@ -0,0 +1,234 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialRingBuffer.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口读缓冲区（字节环形缓冲区）实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/serial/SerialRingBuffer.h"
+
+/**
+ * @brief 构造函数
+ */
+SerialRingBuffer::SerialRingBuffer(int capacity)
+    : m_data(nullptr)
+    , m_mask(0)
+    , m_head(0)
+    , m_tail(0)
+    , m_overflowCount(0)
+    , m_droppedBytes(0)
+{
+    quint64 size = roundCapacity(capacity);
+    m_storage.resize(static_cast<int>(size));
+    m_data = m_storage.data();
+    m_mask = size - 1;
+}
+
+/**
+ * @brief 容量向上取整为2的幂
+ */
+quint64 SerialRingBuffer::roundCapacity(int capacity)
+{
+    quint64 size = 64;
+    const quint64 wanted = static_cast<quint64>(qBound(64, capacity, 1 << 30));
+    while (size < wanted)
+    {
+        size <<= 1;
+    }
+    return size;
+}
+
+/**
+ * @brief 调整容量
+ */
+void SerialRingBuffer::setCapacity(int capacity)
+{
+    const quint64 size = roundCapacity(capacity);
+    if (size == m_mask + 1)
+    {
+        return;
+    }
+
+    // 缩小时只保留最新的数据
+    int keep = qMin(this->size(), static_cast<int>(size));
+    if (keep < this->size())
+    {
+        m_droppedBytes += static_cast<quint64>(this->size() - keep);
+        m_overflowCount++;
+        consume(this->size() - keep);
+    }
+
+    QByteArray storage(static_cast<int>(size), '\0');
+    peek(storage.data(), keep);
+
+    m_storage = storage;
+    m_data = m_storage.data();
+    m_mask = size - 1;
+    m_head = 0;
+    m_tail = static_cast<quint64>(keep);
+}
+
+/**
+ * @brief 追加数据
+ */
+int SerialRingBuffer::append(const char *data, int length)
+{
+    if (length <= 0)
+    {
+        return 0;
+    }
+
+    int dropped = 0;
+    const int cap = capacity();
+
+    // 单次写入超过容量时只保留最后cap字节
+    if (length > cap)
+    {
+        dropped += length - cap;
+        data += length - cap;
+        length = cap;
+    }
+
+    // 空间不足时移动读位置丢弃最旧的数据，不搬移内存
+    const int overflow = length - freeSpace();
+    if (overflow > 0)
+    {
+        m_head += static_cast<quint64>(overflow);
+        dropped += overflow;
+    }
+
+    const quint64 pos = m_tail & m_mask;
+    const int first = qMin(length, static_cast<int>(m_mask + 1 - pos));
+    memcpy(m_data + pos, data, static_cast<size_t>(first));
+    if (first < length)
+    {
+        memcpy(m_data, data + first, static_cast<size_t>(length - first));
+    }
+    m_tail += static_cast<quint64>(length);
+
+    if (dropped > 0)
+    {
+        m_overflowCount++;
+        m_droppedBytes += static_cast<quint64>(dropped);
+    }
+    return dropped;
+}
+
+/**
+ * @brief 获取连续空闲区间
+ */
+char *SerialRingBuffer::writeSpan(int *length)
+{
+    const quint64 pos = m_tail & m_mask;
+    const int toEnd = static_cast<int>(m_mask + 1 - pos);
+    *length = qMin(toEnd, freeSpace());
+    return m_data + pos;
+}
+
+/**
+ * @brief 提交直接写入的字节
+ */
+void SerialRingBuffer::commit(int length)
+{
+    if (length > 0)
+    {
+        m_tail += static_cast<quint64>(qMin(length, freeSpace()));
+    }
+}
+
+/**
+ * @brief 拷贝数据（不消费）
+ */
+int SerialRingBuffer::peek(char *out, int length, int offset) const
+{
+    if (offset < 0 || offset >= size() || length <= 0)
+    {
+        return 0;
+    }
+
+    length = qMin(length, size() - offset);
+    const quint64 pos = (m_head + static_cast<quint64>(offset)) & m_mask;
+    const int first = qMin(length, static_cast<int>(m_mask + 1 - pos));
+    memcpy(out, m_data + pos, static_cast<size_t>(first));
+    if (first < length)
+    {
+        memcpy(out + first, m_data, static_cast<size_t>(length - first));
+    }
+    return length;
+}
+
+/**
+ * @brief 复制数据为QByteArray（不消费）
+ */
+QByteArray SerialRingBuffer::peek(int length, int offset) const
+{
+    if (offset < 0 || offset >= size() || length <= 0)
+    {
+        return QByteArray();
+    }
+
+    QByteArray result(qMin(length, size() - offset), Qt::Uninitialized);
+    peek(result.data(), result.size(), offset);
+    return result;
+}
+
+/**
+ * @brief 读取并消费
+ */
+QByteArray SerialRingBuffer::read(int length)
+{
+    QByteArray result = peek(length);
+    m_head += static_cast<quint64>(result.size());
+    return result;
+}
+
+/**
+ * @brief 消费数据
+ */
+int SerialRingBuffer::consume(int length)
+{
+    length = qBound(0, length, size());
+    m_head += static_cast<quint64>(length);
+    return length;
+}
+
+/**
+ * @brief 从偏移开始的连续区间
+ */
+SerialRingBuffer::Span SerialRingBuffer::span(int offset) const
+{
+    Span result = { nullptr, 0 };
+    if (offset < 0 || offset >= size())
+    {
+        return result;
+    }
+
+    const quint64 pos = (m_head + static_cast<quint64>(offset)) & m_mask;
+    result.data = m_data + pos;
+    result.length = qMin(size() - offset, static_cast<int>(m_mask + 1 - pos));
+    return result;
+}
+
+/**
+ * @brief 查找字节（在至多两段连续区间上memchr）
+ */
+int SerialRingBuffer::indexOf(char c, int from) const
+{
+    int offset = qMax(0, from);
+    while (offset < size())
+    {
+        Span s = span(offset);
+        const void *hit = memchr(s.data, c, static_cast<size_t>(s.length));
+        if (hit)
+        {
+            return offset + static_cast<int>(static_cast<const char *>(hit) - s.data);
+        }
+        offset += s.length;
+    }
+    return -1;
+}
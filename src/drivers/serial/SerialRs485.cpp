@@ -0,0 +1,269 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialRs485.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: RS-485收发方向控制实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/serial/SerialRs485.h"
+#include <QDebug>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/serial.h>
+
+namespace {
+
+/**
+ * @brief 写sysfs属性文件
+ */
+bool writeSysfs(const QString &path, const QByteArray &value)
+{
+    const int fd = ::open(path.toLocal8Bit().constData(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    const ssize_t n = ::write(fd, value.constData(), static_cast<size_t>(value.size()));
+    ::close(fd);
+    return n == value.size();
+}
+
+/**
+ * @brief 微秒向上取整到毫秒
+ */
+quint32 usToMsCeil(int us)
+{
+    return us > 0 ? static_cast<quint32>((us + 999) / 1000) : 0;
+}
+
+} // namespace
+
+// ========== SerialRs485Config ==========
+
+SerialRs485Config::Mode SerialRs485Config::modeFromString(const QString &text)
+{
+    const QString mode = text.trimmed().toLower();
+    if (mode == "kernel" || mode == "true" || mode == "on")
+    {
+        return Kernel;
+    }
+    if (mode == "gpio")
+    {
+        return Gpio;
+    }
+    if (mode == "auto")
+    {
+        return Auto;
+    }
+    return Off;
+}
+
+QString SerialRs485Config::modeToString(Mode mode)
+{
+    switch (mode)
+    {
+    case Kernel: return "kernel";
+    case Gpio: return "gpio";
+    case Auto: return "auto";
+    default: return "off";
+    }
+}
+
+// ========== SerialRs485 ==========
+
+/**
+ * @brief 通过TIOCSRS485启用内核方向控制
+ */
+bool SerialRs485::applyKernel(int fd, const SerialRs485Config &config,
+                              QString *errorString, bool *notSupported)
+{
+    if (notSupported)
+    {
+        *notSupported = false;
+    }
+
+    struct serial_rs485 rs485;
+    memset(&rs485, 0, sizeof(rs485));
+    rs485.flags = SER_RS485_ENABLED;
+    rs485.flags |= config.rtsOnSend ? SER_RS485_RTS_ON_SEND : SER_RS485_RTS_AFTER_SEND;
+    if (config.rxDuringTx)
+    {
+        rs485.flags |= SER_RS485_RX_DURING_TX;
+    }
+    rs485.delay_rts_before_send = usToMsCeil(config.delayBeforeUs);
+    rs485.delay_rts_after_send = usToMsCeil(config.delayAfterUs);
+
+    if (ioctl(fd, TIOCSRS485, &rs485) < 0)
+    {
+        const int err = errno;
+        if (notSupported)
+        {
+            *notSupported = (err == ENOTTY || err == EINVAL || err == EOPNOTSUPP);
+        }
+        if (errorString)
+        {
+            *errorString = QString("TIOCSRS485失败: %1").arg(strerror(err));
+        }
+        return false;
+    }
+
+    // 驱动可能调整了参数（例如不支持的延迟被截断），读回确认
+    struct serial_rs485 actual;
+    memset(&actual, 0, sizeof(actual));
+    if (ioctl(fd, TIOCGRS485, &actual) == 0 && !(actual.flags & SER_RS485_ENABLED))
+    {
+        if (notSupported)
+        {
+            *notSupported = true;
+        }
+        if (errorString)
+        {
+            *errorString = "驱动未启用RS-485模式";
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 自动模式：用临时打开的fd试探内核支持
+ * @note 内核RS-485参数保存在UART端口上，试探成功后关闭fd不会丢失
+ */
+SerialRs485Config::Mode SerialRs485::resolveMode(const QString &portName, const SerialRs485Config &config)
+{
+    if (config.mode != SerialRs485Config::Auto)
+    {
+        return config.mode;
+    }
+
+    const int fd = ::open(portName.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        // 打开失败交给后续open()报告
+        return SerialRs485Config::Kernel;
+    }
+
+    QString errorString;
+    bool notSupported = false;
+    const bool ok = applyKernel(fd, config, &errorString, &notSupported);
+    ::close(fd);
+
+    if (ok || !notSupported)
+    {
+        return SerialRs485Config::Kernel;
+    }
+    if (config.gpio >= 0)
+    {
+        qInfo() << "[SerialRs485] 驱动不支持TIOCSRS485，改用GPIO方向控制:" << portName;
+        return SerialRs485Config::Gpio;
+    }
+    qWarning() << "[SerialRs485] 驱动不支持TIOCSRS485且未配置rs485_gpio，不做方向控制:" << portName;
+    return SerialRs485Config::Off;
+}
+
+// ========== SerialRs485Gpio ==========
+
+SerialRs485Gpio::SerialRs485Gpio()
+    : m_fd(-1)
+    , m_gpio(-1)
+    , m_activeHigh(true)
+{
+}
+
+SerialRs485Gpio::~SerialRs485Gpio()
+{
+    close();
+}
+
+/**
+ * @brief 导出GPIO、设置为输出并打开value文件
+ */
+bool SerialRs485Gpio::open(int gpio, bool activeHigh, QString *errorString)
+{
+    close();
+
+    if (gpio < 0)
+    {
+        if (errorString)
+        {
+            *errorString = "未配置方向控制GPIO";
+        }
+        return false;
+    }
+
+    const QString base = QString("/sys/class/gpio/gpio%1").arg(gpio);
+    struct stat st;
+    if (stat(base.toLocal8Bit().constData(), &st) != 0)
+    {
+        writeSysfs("/sys/class/gpio/export", QByteArray::number(gpio));
+        // 内核创建节点后udev可能还在修改权限，稍等
+        for (int i = 0; i < 20 && stat(base.toLocal8Bit().constData(), &st) != 0; ++i)
+        {
+            usleep(5000);
+        }
+    }
+
+    // "low"/"high"同时设置方向和初始电平，切到输出时不产生毛刺
+    if (!writeSysfs(base + "/direction", activeHigh ? "low" : "high"))
+    {
+        if (errorString)
+        {
+            *errorString = QString("设置GPIO%1方向失败: %2").arg(gpio).arg(strerror(errno));
+        }
+        return false;
+    }
+
+    m_fd = ::open((base + "/value").toLocal8Bit().constData(), O_WRONLY | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        if (errorString)
+        {
+            *errorString = QString("打开GPIO%1失败: %2").arg(gpio).arg(strerror(errno));
+        }
+        return false;
+    }
+
+    m_gpio = gpio;
+    m_activeHigh = activeHigh;
+    qInfo() << "[SerialRs485Gpio] 方向控制GPIO:" << gpio << (activeHigh ? "高电平发送" : "低电平发送");
+    return true;
+}
+
+/**
+ * @brief 恢复接收电平并关闭
+ */
+void SerialRs485Gpio::close()
+{
+    if (m_fd >= 0)
+    {
+        setTransmit(false);
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+/**
+ * @brief 切换方向
+ */
+void SerialRs485Gpio::setTransmit(bool transmit)
+{
+    if (m_fd < 0)
+    {
+        return;
+    }
+    const char level = (transmit == m_activeHigh) ? '1' : '0';
+    if (pwrite(m_fd, &level, 1, 0) != 1)
+    {
+        qWarning() << "[SerialRs485Gpio] 写GPIO失败:" << m_gpio << strerror(errno);
+    }
+}
@@ -0,0 +1,939 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialTcpBridge.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口TCP透明桥实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/serial/SerialTcpBridge.h"
+#include <QMutexLocker>
+#include <QDateTime>
+#include <QTextStream>
+#include <QDebug>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <termios.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+namespace {
+
+const int PUMP_BUDGET = 16;     // 每次唤醒每个方向最多搬运的轮数（防止一个方向占满线程）
+
+} // namespace
+
+/**
+ * @brief 构造函数
+ * @param portName 串口设备（如/dev/ttymxc1）
+ * @param parent 父对象指针
+ */
+SerialTcpBridge::SerialTcpBridge(const QString &portName, QObject *parent)
+    : QThread(parent)
+    , m_portName(portName)
+    , m_listenAddress(QHostAddress::AnyIPv4)
+    , m_listenPort(0)
+    , m_rfc2217(false)
+    , m_spliceEnabled(true)
+    , m_bufferSize(4096)
+    , m_historySize(16)
+    , m_serialFd(-1)
+    , m_listenFd(-1)
+    , m_clientFd(-1)
+    , m_epollFd(-1)
+    , m_wakeFd(-1)
+    , m_serialEvents(0)
+    , m_clientEvents(0)
+    , m_scratch(nullptr)
+    , m_connectionsAccepted(0)
+    , m_connectionsRejected(0)
+    , m_serialErrors(0)
+{
+    qRegisterMetaType<SerialTcpConnectionStats>("SerialTcpConnectionStats");
+
+    memset(&m_toSerial, 0, sizeof(m_toSerial));
+    memset(&m_toNetwork, 0, sizeof(m_toNetwork));
+    m_toSerial.pipeRd = m_toSerial.pipeWr = -1;
+    m_toNetwork.pipeRd = m_toNetwork.pipeWr = -1;
+}
+
+SerialTcpBridge::~SerialTcpBridge()
+{
+    stopBridge();
+}
+
+void SerialTcpBridge::setListenAddress(const QHostAddress &address, quint16 port)
+{
+    m_listenAddress = address;
+    m_listenPort = port;
+}
+
+void SerialTcpBridge::setBufferSize(int bytes)
+{
+    m_bufferSize = qBound(256, bytes, 65536);
+}
+
+// ========== 运行控制 ==========
+
+/**
+ * @brief 打开串口、开始监听并启动桥线程
+ */
+bool SerialTcpBridge::startBridge()
+{
+    if (m_listenFd >= 0)
+    {
+        return true;
+    }
+
+    if (m_listenPort == 0)
+    {
+        setLastError("未设置监听端口");
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(m_listenPort);
+    if (m_listenAddress == QHostAddress::Any || m_listenAddress == QHostAddress::AnyIPv4)
+    {
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    }
+    else if (m_listenAddress.protocol() == QAbstractSocket::IPv4Protocol)
+    {
+        addr.sin_addr.s_addr = htonl(m_listenAddress.toIPv4Address());
+    }
+    else
+    {
+        setLastError(QString("只支持IPv4监听地址: %1").arg(m_listenAddress.toString()));
+        return false;
+    }
+
+    // 先打开串口，配置错误在启动时就能发现
+    if (!openSerial())
+    {
+        return false;
+    }
+
+    m_listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listenFd < 0)
+    {
+        setLastError(QString("创建套接字失败: %1").arg(strerror(errno)));
+        closeSerial();
+        return false;
+    }
+    int one = 1;
+    setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::bind(m_listenFd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        ::listen(m_listenFd, 4) < 0)
+    {
+        setLastError(QString("监听端口%1失败: %2").arg(m_listenPort).arg(strerror(errno)));
+        ::close(m_listenFd);
+        m_listenFd = -1;
+        closeSerial();
+        return false;
+    }
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollFd < 0 || m_wakeFd < 0)
+    {
+        setLastError(QString("创建epoll/eventfd失败: %1").arg(strerror(errno)));
+        stopBridge();
+        return false;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = m_listenFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &ev);
+    ev.data.fd = m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+    ev.events = 0;
+    ev.data.fd = m_serialFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_serialFd, &ev);
+    m_serialEvents = 0;
+
+    m_toSerial.buffer = new char[m_bufferSize];
+    m_toNetwork.buffer = new char[m_bufferSize];
+    m_scratch = new char[m_bufferSize];
+
+    start();
+
+    qInfo() << "[SerialTcpBridge]" << m_portName << "监听端口" << m_listenPort
+            << "波特率:" << m_lineSettings.baudRate
+            << "RFC2217:" << (m_rfc2217 ? "开" : "关")
+            << "缓冲区:" << m_bufferSize;
+    return true;
+}
+
+/**
+ * @brief 断开客户端并停止
+ */
+void SerialTcpBridge::stopBridge()
+{
+    if (isRunning())
+    {
+        const quint64 one = 1;
+        ssize_t ret = ::write(m_wakeFd, &one, sizeof(one));
+        Q_UNUSED(ret);
+        wait();
+    }
+
+    closeClient();
+    closeSerial();
+
+    if (m_listenFd >= 0)
+    {
+        ::close(m_listenFd);
+        m_listenFd = -1;
+    }
+    if (m_wakeFd >= 0)
+    {
+        ::close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+    if (m_epollFd >= 0)
+    {
+        ::close(m_epollFd);
+        m_epollFd = -1;
+    }
+
+    delete[] m_toSerial.buffer;
+    delete[] m_toNetwork.buffer;
+    delete[] m_scratch;
+    m_toSerial.buffer = nullptr;
+    m_toNetwork.buffer = nullptr;
+    m_scratch = nullptr;
+}
+
+// ========== 桥线程 ==========
+
+void SerialTcpBridge::run()
+{
+    struct epoll_event events[8];
+    bool running = true;
+
+    while (running)
+    {
+        const int n = epoll_wait(m_epollFd, events, 8, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            qWarning() << "[SerialTcpBridge]" << m_portName << "epoll_wait失败:" << strerror(errno);
+            break;
+        }
+
+        bool accept = false;
+        bool serialHangup = false;
+        bool clientHangup = false;
+        for (int i = 0; i < n; ++i)
+        {
+            const int fd = events[i].data.fd;
+            const bool hangup = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+            if (fd == m_wakeFd)
+            {
+                running = false;
+            }
+            else if (fd == m_listenFd)
+            {
+                accept = true;
+            }
+            else if (fd == m_serialFd)
+            {
+                serialHangup = hangup;
+            }
+            else if (fd == m_clientFd)
+            {
+                clientHangup = hangup;
+            }
+        }
+        if (!running)
+        {
+            break;
+        }
+
+        // HUP/ERR不受注册事件控制，必须先处理，否则没有客户端时也会反复唤醒
+        if (serialHangup)
+        {
+            qWarning() << "[SerialTcpBridge]" << m_portName << "串口挂断，断开客户端";
+            {
+                QMutexLocker locker(&m_statsMutex);
+                m_serialErrors++;
+            }
+            closeClient();
+            closeSerial();
+        }
+        else if (clientHangup)
+        {
+            closeClient();
+        }
+        if (accept)
+        {
+            acceptClient();
+        }
+        if (m_clientFd < 0)
+        {
+            continue;
+        }
+
+        // 不区分是哪个描述符就绪，两个方向都尝试一遍（非阻塞，没数据时EAGAIN）
+        PumpResult result = pumpToSerial();
+        if (result < PumpClosed)
+        {
+            result = pumpToNetwork();
+        }
+
+        if (result == PumpSerialError)
+        {
+            qWarning() << "[SerialTcpBridge]" << m_portName << "串口读写失败，断开客户端:" << strerror(errno);
+            {
+                QMutexLocker locker(&m_statsMutex);
+                m_serialErrors++;
+            }
+            closeClient();
+            closeSerial();
+        }
+        else if (result == PumpClosed || result == PumpNetworkError)
+        {
+            closeClient();
+        }
+        else
+        {
+            if (m_rfc2217)
+            {
+                QMutexLocker locker(&m_statsMutex);
+                m_current.lineChanges = m_telnet.getLineChanges();
+            }
+            updateInterest();
+        }
+    }
+
+    closeClient();
+}
+
+/**
+ * @brief 网络→串口
+ */
+SerialTcpBridge::PumpResult SerialTcpBridge::pumpToSerial()
+{
+    Pump &pump = m_toSerial;
+
+    for (int round = 0; round < PUMP_BUDGET; ++round)
+    {
+        if (pump.pending() == 0)
+        {
+            ssize_t n;
+            if (pump.splice)
+            {
+                n = splice(m_clientFd, nullptr, pump.pipeWr, nullptr, m_bufferSize,
+                           SPLICE_F_NONBLOCK | SPLICE_F_MOVE);
+                if (n < 0 && errno == EINVAL)
+                {
+                    releasePump(pump);
+                    QMutexLocker locker(&m_statsMutex);
+                    m_current.spliceToSerial = false;
+                    continue;
+                }
+            }
+            else
+            {
+                n = ::read(m_clientFd, m_rfc2217 ? m_scratch : pump.buffer, m_bufferSize);
+            }
+
+            if (n < 0)
+            {
+                return (errno == EAGAIN || errno == EINTR) ? PumpIdle : PumpNetworkError;
+            }
+            if (n == 0)
+            {
+                return PumpClosed;
+            }
+            m_bytesFromNetwork.fetchAndAddRelaxed(static_cast<quint64>(n));
+
+            pump.head = 0;
+            if (m_rfc2217)
+            {
+                pump.tail = m_telnet.decode(reinterpret_cast<const uchar *>(m_scratch), static_cast<int>(n),
+                                            reinterpret_cast<uchar *>(pump.buffer));
+                if (pump.tail == 0)
+                {
+                    continue;       // 只有Telnet命令
+                }
+            }
+            else
+            {
+                pump.tail = static_cast<int>(n);
+            }
+        }
+
+        ssize_t written;
+        if (pump.splice)
+        {
+            written = splice(pump.pipeRd, nullptr, m_serialFd, nullptr, pump.tail,
+                             SPLICE_F_NONBLOCK | SPLICE_F_MOVE);
+            if (written < 0 && errno == EINVAL)
+            {
+                // tty不支持splice写入: 管道中的数据取回缓冲区，改用write
+                const ssize_t moved = ::read(pump.pipeRd, pump.buffer, pump.tail);
+                releasePump(pump);
+                pump.head = 0;
+                pump.tail = moved > 0 ? static_cast<int>(moved) : 0;
+                QMutexLocker locker(&m_statsMutex);
+                m_current.spliceToSerial = false;
+                continue;
+            }
+        }
+        else
+        {
+            written = ::write(m_serialFd, pump.buffer + pump.head, pump.tail - pump.head);
+        }
+
+        if (written < 0)
+        {
+            if (errno == EAGAIN || errno == EINTR)
+            {
+                m_serialStalls.fetchAndAddRelaxed(1);
+                return PumpBlocked;
+            }
+            return PumpSerialError;
+        }
+        m_bytesToSerial.fetchAndAddRelaxed(static_cast<quint64>(written));
+        if (pump.splice)
+        {
+            pump.tail -= static_cast<int>(written);
+        }
+        else
+        {
+            pump.head += static_cast<int>(written);
+        }
+        if (pump.pending() > 0)
+        {
+            m_serialStalls.fetchAndAddRelaxed(1);
+            return PumpBlocked;
+        }
+    }
+    return PumpIdle;
+}
+
+/**
+ * @brief 串口→网络
+ */
+SerialTcpBridge::PumpResult SerialTcpBridge::pumpToNetwork()
+{
+    Pump &pump = m_toNetwork;
+
+    for (int round = 0; round < PUMP_BUDGET; ++round)
+    {
+        if (pump.pending() == 0)
+        {
+            // RFC 2217回复只在数据缓冲区为空时发出，不会插进转义序列中间
+            if (m_rfc2217 && m_telnet.replyPending() > 0)
+            {
+                const PumpResult result = flushReplies();
+                if (result != PumpIdle)
+                {
+                    return result;
+                }
+            }
+
+            ssize_t n;
+            if (pump.splice)
+            {
+                n = splice(m_serialFd, nullptr, pump.pipeWr, nullptr, m_bufferSize,
+                           SPLICE_F_NONBLOCK | SPLICE_F_MOVE);
+                if (n < 0 && errno == EINVAL)
+                {
+                    // tty不支持splice读取（老内核），改用read
+                    releasePump(pump);
+                    QMutexLocker locker(&m_statsMutex);
+                    m_current.spliceToNetwork = false;
+                    continue;
+                }
+            }
+            else
+            {
+                // RFC 2217转义后最多翻倍，只读半个缓冲区
+                n = m_rfc2217 ? ::read(m_serialFd, m_scratch, m_bufferSize / 2)
+                              : ::read(m_serialFd, pump.buffer, m_bufferSize);
+            }
+
+            if (n < 0)
+            {
+                return (errno == EAGAIN || errno == EINTR) ? PumpIdle : PumpSerialError;
+            }
+            if (n == 0)
+            {
+                errno = EIO;
+                return PumpSerialError;     // 非阻塞tty读到0表示挂断
+            }
+            m_bytesFromSerial.fetchAndAddRelaxed(static_cast<quint64>(n));
+
+            pump.head = 0;
+            if (m_rfc2217)
+            {
+                pump.tail = SerialRfc2217::escape(reinterpret_cast<const uchar *>(m_scratch), static_cast<int>(n),
+                                                  reinterpret_cast<uchar *>(pump.buffer));
+            }
+            else
+            {
+                pump.tail = static_cast<int>(n);
+            }
+        }
+
+        ssize_t written;
+        if (pump.splice)
+        {
+            written = splice(pump.pipeRd, nullptr, m_clientFd, nullptr, pump.tail,
+                             SPLICE_F_NONBLOCK | SPLICE_F_MOVE);
+        }
+        else
+        {
+            written = ::send(m_clientFd, pump.buffer + pump.head, pump.tail - pump.head, MSG_NOSIGNAL);
+        }
+
+        if (written < 0)
+        {
+            if (errno == EAGAIN || errno == EINTR)
+            {
+                m_networkStalls.fetchAndAddRelaxed(1);
+                return PumpBlocked;
+            }
+            return PumpNetworkError;
+        }
+        m_bytesToNetwork.fetchAndAddRelaxed(static_cast<quint64>(written));
+        if (pump.splice)
+        {
+            pump.tail -= static_cast<int>(written);
+        }
+        else
+        {
+            pump.head += static_cast<int>(written);
+        }
+        if (pump.pending() > 0)
+        {
+            m_networkStalls.fetchAndAddRelaxed(1);
+            return PumpBlocked;
+        }
+    }
+    return PumpIdle;
+}
+
+/**
+ * @brief 发送RFC 2217回复
+ */
+SerialTcpBridge::PumpResult SerialTcpBridge::flushReplies()
+{
+    while (m_telnet.replyPending() > 0)
+    {
+        const ssize_t written = ::send(m_clientFd, m_telnet.replyData(), m_telnet.replyPending(), MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (errno == EAGAIN || errno == EINTR)
+            {
+                m_networkStalls.fetchAndAddRelaxed(1);
+                return PumpBlocked;
+            }
+            return PumpNetworkError;
+        }
+        m_bytesToNetwork.fetchAndAddRelaxed(static_cast<quint64>(written));
+        m_telnet.consumeReply(static_cast<int>(written));
+    }
+    return PumpIdle;
+}
+
+/**
+ * @brief 按两个方向的缓冲区状态更新epoll事件
+ *
+ * 缓冲区为空时读来源，非空时只等目标可写
+ */
+void SerialTcpBridge::updateInterest()
+{
+    quint32 serialWanted = 0;
+    quint32 clientWanted = 0;
+
+    if (m_clientFd >= 0)
+    {
+        if (m_toNetwork.pending() == 0 && (!m_rfc2217 || m_telnet.replyPending() == 0))
+        {
+            serialWanted |= EPOLLIN;
+        }
+        else
+        {
+            clientWanted |= EPOLLOUT;
+        }
+
+        if (m_toSerial.pending() == 0)
+        {
+            clientWanted |= EPOLLIN | EPOLLRDHUP;
+        }
+        else
+        {
+            serialWanted |= EPOLLOUT;
+        }
+        modifyInterest(m_clientFd, m_clientEvents, clientWanted);
+    }
+
+    if (m_serialFd >= 0)
+    {
+        modifyInterest(m_serialFd, m_serialEvents, serialWanted);
+    }
+}
+
+void SerialTcpBridge::modifyInterest(int fd, quint32 &current, quint32 wanted)
+{
+    if (current == wanted)
+    {
+        return;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = wanted;
+    ev.data.fd = fd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &ev);
+    current = wanted;
+}
+
+// ========== 连接管理 ==========
+
+/**
+ * @brief 接受新连接（已有客户端时拒绝）
+ */
+void SerialTcpBridge::acceptClient()
+{
+    for (;;)
+    {
+        struct sockaddr_in peer;
+        socklen_t peerLength = sizeof(peer);
+        const int fd = accept4(m_listenFd, reinterpret_cast<struct sockaddr *>(&peer), &peerLength,
+                               SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        char host[INET_ADDRSTRLEN] = { 0 };
+        inet_ntop(AF_INET, &peer.sin_addr, host, sizeof(host));
+        const QString peerName = QString("%1:%2").arg(host).arg(ntohs(peer.sin_port));
+
+        if (m_clientFd >= 0)
+        {
+            qWarning() << "[SerialTcpBridge]" << m_portName << "已有客户端，拒绝" << peerName;
+            ::close(fd);
+            QMutexLocker locker(&m_statsMutex);
+            m_connectionsRejected++;
+            continue;
+        }
+
+        if (m_serialFd < 0)
+        {
+            if (!openSerial())
+            {
+                qWarning() << "[SerialTcpBridge]" << m_portName << "串口打开失败，拒绝" << peerName
+                           << ":" << m_lastError;
+                ::close(fd);
+                continue;
+            }
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.data.fd = m_serialFd;
+            epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_serialFd, &ev);
+            m_serialEvents = 0;
+        }
+
+        // 串口逐字节交互，关闭Nagle
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+
+        // 丢弃无人连接期间积压的串口数据
+        tcflush(m_serialFd, TCIOFLUSH);
+
+        m_clientFd = fd;
+        initPump(m_toSerial, m_spliceEnabled && !m_rfc2217);
+        initPump(m_toNetwork, m_spliceEnabled && !m_rfc2217);
+        if (m_rfc2217)
+        {
+            m_telnet.reset(m_serialFd, m_lineSettings);
+        }
+
+        m_bytesFromNetwork.store(0);
+        m_bytesToSerial.store(0);
+        m_bytesFromSerial.store(0);
+        m_bytesToNetwork.store(0);
+        m_serialStalls.store(0);
+        m_networkStalls.store(0);
+        {
+            QMutexLocker locker(&m_statsMutex);
+            m_current = SerialTcpConnectionStats();
+            m_current.peer = peerName;
+            m_current.connectedAtMs = QDateTime::currentMSecsSinceEpoch();
+            m_current.spliceToSerial = m_toSerial.splice;
+            m_current.spliceToNetwork = m_toNetwork.splice;
+            m_connectionsAccepted++;
+        }
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.data.fd = m_clientFd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_clientFd, &ev);
+        m_clientEvents = 0;
+
+        // 先把初始协商发出去，再按缓冲区状态注册事件
+        if (m_rfc2217 && flushReplies() == PumpNetworkError)
+        {
+            closeClient();
+            continue;
+        }
+        updateInterest();
+
+        qInfo() << "[SerialTcpBridge]" << m_portName << "客户端已连接:" << peerName;
+        emit clientConnected(peerName);
+    }
+}
+
+/**
+ * @brief 断开当前客户端，统计移入历史
+ */
+void SerialTcpBridge::closeClient()
+{
+    if (m_clientFd < 0)
+    {
+        return;
+    }
+
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, m_clientFd, nullptr);
+    ::close(m_clientFd);
+    m_clientFd = -1;
+    m_clientEvents = 0;
+
+    releasePump(m_toSerial);
+    releasePump(m_toNetwork);
+
+    // 客户端改过的线路参数恢复为配置值
+    if (m_rfc2217 && m_serialFd >= 0 && m_telnet.getLineChanges() > 0)
+    {
+        QString errorString;
+        if (!SerialTermios::apply(m_serialFd, m_lineSettings, 1, 0, &errorString))
+        {
+            qWarning() << "[SerialTcpBridge]" << m_portName << "恢复线路参数失败:" << errorString;
+        }
+    }
+    if (m_serialFd >= 0)
+    {
+        modifyInterest(m_serialFd, m_serialEvents, 0);
+    }
+
+    SerialTcpConnectionStats finished;
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_current.durationMs = QDateTime::currentMSecsSinceEpoch() - m_current.connectedAtMs;
+        m_current.bytesFromNetwork = m_bytesFromNetwork.load();
+        m_current.bytesToSerial = m_bytesToSerial.load();
+        m_current.bytesFromSerial = m_bytesFromSerial.load();
+        m_current.bytesToNetwork = m_bytesToNetwork.load();
+        m_current.serialStalls = m_serialStalls.load();
+        m_current.networkStalls = m_networkStalls.load();
+        if (m_rfc2217)
+        {
+            m_current.lineChanges = m_telnet.getLineChanges();
+        }
+        finished = m_current;
+
+        if (m_historySize > 0)
+        {
+            m_history.append(finished);
+            if (m_history.size() > m_historySize)
+            {
+                m_history.remove(0, m_history.size() - m_historySize);
+            }
+        }
+    }
+
+    qInfo() << "[SerialTcpBridge]" << m_portName << "客户端已断开:" << finished.peer
+            << "网络→串口" << finished.bytesToSerial << "字节,"
+            << "串口→网络" << finished.bytesFromSerial << "字节,"
+            << "时长" << finished.durationMs << "ms";
+    emit clientDisconnected(finished);
+}
+
+/**
+ * @brief 打开串口（非阻塞，原始模式）
+ */
+bool SerialTcpBridge::openSerial()
+{
+    const int fd = ::open(m_portName.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        setLastError(QString("无法打开%1: %2").arg(m_portName, strerror(errno)));
+        QMutexLocker locker(&m_statsMutex);
+        m_serialErrors++;
+        return false;
+    }
+
+    QString errorString;
+    if (!SerialTermios::apply(fd, m_lineSettings, 1, 0, &errorString))
+    {
+        setLastError(QString("%1: %2").arg(m_portName, errorString));
+        ::close(fd);
+        QMutexLocker locker(&m_statsMutex);
+        m_serialErrors++;
+        return false;
+    }
+
+    m_serialFd = fd;
+    return true;
+}
+
+void SerialTcpBridge::closeSerial()
+{
+    if (m_serialFd < 0)
+    {
+        return;
+    }
+    if (m_epollFd >= 0)
+    {
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, m_serialFd, nullptr);
+    }
+    ::close(m_serialFd);
+    m_serialFd = -1;
+    m_serialEvents = 0;
+}
+
+/**
+ * @brief 初始化单向搬运（splice时创建管道，失败则用缓冲区）
+ */
+void SerialTcpBridge::initPump(Pump &pump, bool trySplice)
+{
+    pump.splice = false;
+    pump.head = 0;
+    pump.tail = 0;
+
+    if (!trySplice)
+    {
+        return;
+    }
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0)
+    {
+        return;
+    }
+    // 管道容量与缓冲区一致（内核按页取整），失败不影响使用
+    fcntl(fds[1], F_SETPIPE_SZ, m_bufferSize);
+    pump.pipeRd = fds[0];
+    pump.pipeWr = fds[1];
+    pump.splice = true;
+}
+
+void SerialTcpBridge::releasePump(Pump &pump)
+{
+    if (pump.pipeRd >= 0)
+    {
+        ::close(pump.pipeRd);
+        ::close(pump.pipeWr);
+    }
+    pump.pipeRd = -1;
+    pump.pipeWr = -1;
+    pump.splice = false;
+    pump.head = 0;
+    pump.tail = 0;
+}
+
+void SerialTcpBridge::setLastError(const QString &error)
+{
+    m_lastError = error;
+    qWarning() << "[SerialTcpBridge]" << error;
+}
+
+// ========== 统计 ==========
+
+SerialTcpBridgeStats SerialTcpBridge::getStats() const
+{
+    SerialTcpBridgeStats stats;
+    QMutexLocker locker(&m_statsMutex);
+    stats.connectionsAccepted = m_connectionsAccepted;
+    stats.connectionsRejected = m_connectionsRejected;
+    stats.serialErrors = m_serialErrors;
+    stats.history = m_history;
+    stats.clientConnected = (m_clientFd >= 0);
+    if (stats.clientConnected)
+    {
+        stats.current = m_current;
+        stats.current.durationMs = QDateTime::currentMSecsSinceEpoch() - m_current.connectedAtMs;
+        stats.current.bytesFromNetwork = m_bytesFromNetwork.load();
+        stats.current.bytesToSerial = m_bytesToSerial.load();
+        stats.current.bytesFromSerial = m_bytesFromSerial.load();
+        stats.current.bytesToNetwork = m_bytesToNetwork.load();
+        stats.current.serialStalls = m_serialStalls.load();
+        stats.current.networkStalls = m_networkStalls.load();
+    }
+    return stats;
+}
+
+/**
+ * @brief 生成统计报告
+ */
+QString SerialTcpBridge::generateReport() const
+{
+    const SerialTcpBridgeStats stats = getStats();
+
+    QString report;
+    QTextStream out(&report);
+
+    auto printConnection = [&out](const SerialTcpConnectionStats &c) {
+        out << "  " << c.peer << "  "
+            << QDateTime::fromMSecsSinceEpoch(c.connectedAtMs).toString("yyyy-MM-dd HH:mm:ss")
+            << "  " << c.durationMs / 1000 << " s\n";
+        out << "    net->serial: " << c.bytesFromNetwork << " / " << c.bytesToSerial << " bytes"
+            << (c.spliceToSerial ? " (splice)" : "") << ", stalls " << c.serialStalls << "\n";
+        out << "    serial->net: " << c.bytesFromSerial << " / " << c.bytesToNetwork << " bytes"
+            << (c.spliceToNetwork ? " (splice)" : "") << ", stalls " << c.networkStalls << "\n";
+        if (c.lineChanges > 0)
+        {
+            out << "    line changes: " << c.lineChanges << "\n";
+        }
+    };
+
+    out << "========================================\n";
+    out << "  Serial TCP Bridge: " << m_portName << "\n";
+    out << "========================================\n";
+    out << "Running:         " << (isRunning() ? "yes" : "no") << "\n";
+    out << "Listen port:     " << m_listenPort << "\n";
+    out << "Baud rate:       " << m_lineSettings.baudRate << "\n";
+    out << "RFC 2217:        " << (m_rfc2217 ? "yes" : "no") << "\n";
+    out << "Accepted:        " << stats.connectionsAccepted << "\n";
+    out << "Rejected:        " << stats.connectionsRejected << "\n";
+    out << "Serial errors:   " << stats.serialErrors << "\n";
+    out << "---------------- Current ---------------\n";
+    if (stats.clientConnected)
+    {
+        printConnection(stats.current);
+    }
+    else
+    {
+        out << "  (none)\n";
+    }
+    out << "---------------- History ---------------\n";
+    for (int i = stats.history.size() - 1; i >= 0; --i)
+    {
+        printConnection(stats.history.at(i));
+    }
+    out << "========================================\n";
+
+    return report;
+}
@@ -0,0 +1,150 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialTermios.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口线路参数与termios设置实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件（从SerialIoThread中提取）
+ ***************************************************************/
+
+#include "drivers/serial/SerialTermios.h"
+
+#include <errno.h>
+#include <string.h>
+#include <termios.h>
+
+namespace {
+
+/**
+ * @brief 波特率转termios速率常量
+ * @return 速率常量，不支持时返回B0
+ */
+speed_t toSpeed(qint32 baudRate)
+{
+    switch (baudRate)
+    {
+    case 1200: return B1200;
+    case 2400: return B2400;
+    case 4800: return B4800;
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 500000: return B500000;
+    case 576000: return B576000;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    case 1152000: return B1152000;
+    case 1500000: return B1500000;
+    case 2000000: return B2000000;
+    case 2500000: return B2500000;
+    case 3000000: return B3000000;
+    case 3500000: return B3500000;
+    case 4000000: return B4000000;
+    default: return B0;
+    }
+}
+
+void setError(QString *errorString, const QString &message)
+{
+    if (errorString)
+    {
+        *errorString = message;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief 波特率是否有对应的termios速率常量
+ */
+bool SerialTermios::isSupportedBaudRate(qint32 baudRate)
+{
+    return toSpeed(baudRate) != B0;
+}
+
+/**
+ * @brief 设置为原始模式并应用线路参数
+ */
+bool SerialTermios::apply(int fd, const SerialLineSettings &settings, int vmin, int vtime,
+                          QString *errorString)
+{
+    struct termios tio;
+    if (tcgetattr(fd, &tio) < 0)
+    {
+        setError(errorString, QString("tcgetattr失败: %1").arg(strerror(errno)));
+        return false;
+    }
+
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+
+    const speed_t speed = toSpeed(settings.baudRate);
+    if (speed == B0)
+    {
+        setError(errorString, QString("不支持的波特率: %1").arg(settings.baudRate));
+        return false;
+    }
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+
+    tio.c_cflag &= ~CSIZE;
+    switch (settings.dataBits)
+    {
+    case QSerialPort::Data5: tio.c_cflag |= CS5; break;
+    case QSerialPort::Data6: tio.c_cflag |= CS6; break;
+    case QSerialPort::Data7: tio.c_cflag |= CS7; break;
+    default: tio.c_cflag |= CS8; break;
+    }
+
+    tio.c_cflag &= ~(PARENB | PARODD | CMSPAR);
+    switch (settings.parity)
+    {
+    case QSerialPort::EvenParity: tio.c_cflag |= PARENB; break;
+    case QSerialPort::OddParity: tio.c_cflag |= PARENB | PARODD; break;
+    case QSerialPort::SpaceParity: tio.c_cflag |= PARENB | CMSPAR; break;
+    case QSerialPort::MarkParity: tio.c_cflag |= PARENB | CMSPAR | PARODD; break;
+    default: break;
+    }
+
+    if (settings.stopBits == QSerialPort::OneAndHalfStop)
+    {
+        setError(errorString, "termios不支持1.5停止位");
+        return false;
+    }
+    if (settings.stopBits == QSerialPort::TwoStop)
+    {
+        tio.c_cflag |= CSTOPB;
+    }
+    else
+    {
+        tio.c_cflag &= ~CSTOPB;
+    }
+
+    tio.c_cflag &= ~CRTSCTS;
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    if (settings.flowControl == QSerialPort::HardwareControl)
+    {
+        tio.c_cflag |= CRTSCTS;
+    }
+    else if (settings.flowControl == QSerialPort::SoftwareControl)
+    {
+        tio.c_iflag |= IXON | IXOFF;
+    }
+
+    tio.c_cc[VMIN] = static_cast<cc_t>(qBound(0, vmin, 255));
+    tio.c_cc[VTIME] = static_cast<cc_t>(qBound(0, vtime, 255));
+
+    if (tcsetattr(fd, TCSANOW, &tio) < 0)
+    {
+        setError(errorString, QString("tcsetattr失败: %1").arg(strerror(errno)));
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,156 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialTraceReader.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口抓包环形文件读取实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/serial/SerialTraceReader.h"
+#include <algorithm>
+
+/**
+ * @brief 构造函数
+ */
+SerialTraceReader::SerialTraceReader()
+    : m_baudRate(0)
+    , m_blockSize(0)
+    , m_blockCount(0)
+    , m_corruptBlocks(0)
+{
+}
+
+SerialTraceReader::~SerialTraceReader()
+{
+    close();
+}
+
+/**
+ * @brief 打开抓包文件并读取块头
+ */
+bool SerialTraceReader::open(const QString &path)
+{
+    close();
+
+    m_path = path;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        m_lastError = QString("无法打开抓包文件%1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+
+    uchar header[SERIAL_TRACE_HEADER_SIZE];
+    if (m_file.read(reinterpret_cast<char *>(header), sizeof(header)) != sizeof(header) ||
+        memcmp(header, SERIAL_TRACE_MAGIC, 8) != 0)
+    {
+        m_lastError = "不是串口抓包文件";
+        close();
+        return false;
+    }
+    if (qFromLittleEndian<quint16>(header + 8) != SERIAL_TRACE_VERSION)
+    {
+        m_lastError = QString("不支持的抓包文件版本: %1").arg(qFromLittleEndian<quint16>(header + 8));
+        close();
+        return false;
+    }
+
+    const int headerSize = qFromLittleEndian<quint16>(header + 10);
+    m_blockSize = static_cast<int>(qFromLittleEndian<quint32>(header + 12));
+    m_blockCount = static_cast<int>(qFromLittleEndian<quint32>(header + 16));
+    m_baudRate = static_cast<qint32>(qFromLittleEndian<quint32>(header + 20));
+    const char *name = reinterpret_cast<const char *>(header + 28);
+    m_portName = QString::fromUtf8(name, static_cast<int>(strnlen(name, SERIAL_TRACE_PORT_NAME_SIZE)));
+
+    if (m_blockSize < SERIAL_TRACE_BLOCK_HEADER || m_blockCount <= 0)
+    {
+        m_lastError = "抓包文件头损坏";
+        close();
+        return false;
+    }
+
+    uchar blockHeader[SERIAL_TRACE_BLOCK_HEADER];
+    for (int i = 0; i < m_blockCount; ++i)
+    {
+        BlockSlot slot;
+        slot.offset = headerSize + static_cast<qint64>(i) * m_blockSize;
+        if (!m_file.seek(slot.offset) ||
+            m_file.read(reinterpret_cast<char *>(blockHeader), sizeof(blockHeader)) != sizeof(blockHeader))
+        {
+            break;
+        }
+        if (slot.header.deserialize(blockHeader) &&
+            slot.header.used <= static_cast<quint32>(m_blockSize - SERIAL_TRACE_BLOCK_HEADER))
+        {
+            m_blocks.append(slot);
+        }
+    }
+
+    std::sort(m_blocks.begin(), m_blocks.end(), [](const BlockSlot &a, const BlockSlot &b) {
+        return a.header.sequence < b.header.sequence;
+    });
+    return true;
+}
+
+void SerialTraceReader::close()
+{
+    if (m_file.isOpen())
+    {
+        m_file.close();
+    }
+    m_blocks.clear();
+    m_corruptBlocks = 0;
+}
+
+/**
+ * @brief 按时间顺序遍历全部记录
+ */
+qint64 SerialTraceReader::forEach(const RecordHandler &handler)
+{
+    if (!m_file.isOpen())
+    {
+        m_lastError = "抓包文件未打开";
+        return -1;
+    }
+
+    qint64 count = 0;
+    m_corruptBlocks = 0;
+
+    for (const BlockSlot &slot : m_blocks)
+    {
+        const int used = static_cast<int>(slot.header.used);
+        m_buffer.resize(used);
+        if (!m_file.seek(slot.offset + SERIAL_TRACE_BLOCK_HEADER) ||
+            m_file.read(m_buffer.data(), used) != used)
+        {
+            m_lastError = QString("读取块失败: %1").arg(m_file.errorString());
+            return -1;
+        }
+
+        const uchar *p = reinterpret_cast<const uchar *>(m_buffer.constData());
+        qint64 remain = used;
+        while (remain > 0)
+        {
+            SerialTraceRecord record;
+            const int size = serialTraceDecodeRecord(p, remain, record);
+            if (size < 0)
+            {
+                m_corruptBlocks++;
+                break;
+            }
+            record.wallUs = slot.header.wallUs + (record.timestampUs - slot.header.firstUs);
+            count++;
+            if (!handler(record))
+            {
+                return count;
+            }
+            p += size;
+            remain -= size;
+        }
+    }
+    return count;
+}
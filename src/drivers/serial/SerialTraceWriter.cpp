@@ -0,0 +1,478 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialTraceWriter.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口收发抓包写入器实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/serial/SerialTraceWriter.h"
+#include <QThread>
+#include <QMutexLocker>
+#include <QDebug>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+namespace {
+
+qint64 realtimeUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 写满指定字节（pwrite可能部分写出）
+ */
+bool pwriteAll(int fd, const char *data, qint64 length, qint64 offset)
+{
+    while (length > 0)
+    {
+        const ssize_t n = ::pwrite(fd, data, static_cast<size_t>(length), offset);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= n;
+        offset += n;
+    }
+    return true;
+}
+
+} // namespace
+
+/***************************************************************
+ * 类名: SerialTraceWriterThread
+ * 功能: 批量取走暂存记录并写入文件
+ ***************************************************************/
+class SerialTraceWriterThread : public QThread
+{
+public:
+    explicit SerialTraceWriterThread(SerialTraceWriter *writer)
+        : m_writer(writer)
+        , m_running(true)
+    {
+    }
+
+    void stop()
+    {
+        {
+            QMutexLocker locker(&m_writer->m_stageMutex);
+            m_running = false;
+            m_writer->m_stageReady.wakeAll();
+        }
+        wait();
+    }
+
+protected:
+    void run() override
+    {
+        SerialTraceWriter *writer = m_writer;
+        const int wakeBytes = writer->m_blockSize / 2;
+
+        QByteArray batch;
+        batch.reserve(writer->m_stageLimit);
+
+        bool running = true;
+        while (running)
+        {
+            {
+                QMutexLocker locker(&writer->m_stageMutex);
+                if (m_running && writer->m_stage.size() < wakeBytes)
+                {
+                    writer->m_stageReady.wait(&writer->m_stageMutex,
+                                              static_cast<unsigned long>(writer->m_flushMs));
+                }
+                running = m_running;
+                batch.swap(writer->m_stage);
+            }
+
+            // 加锁期间只交换缓冲区，整理和写文件都在锁外
+            writer->processBatch(batch);
+            batch.resize(0);
+            writer->writeBlock();
+        }
+    }
+
+private:
+    SerialTraceWriter *m_writer;
+    bool m_running;                 // 由暂存区锁保护
+};
+
+/**
+ * @brief 单调时钟（微秒）
+ */
+qint64 SerialTraceWriter::monotonicUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 构造函数
+ */
+SerialTraceWriter::SerialTraceWriter()
+    : m_fd(-1)
+    , m_thread(nullptr)
+    , m_fileSize(16 * 1024 * 1024)
+    , m_blockSize(64 * 1024)
+    , m_blockCount(0)
+    , m_flushMs(1000)
+    , m_stageLimit(0)
+    , m_active(0)
+    , m_dropPending(false)
+    , m_blockWritten(0)
+    , m_nextSequence(1)
+{
+    m_recordsCaptured.store(0);
+    m_bytesCaptured.store(0);
+    m_recordsDropped.store(0);
+    m_blocksWritten.store(0);
+    m_writeErrors.store(0);
+}
+
+/**
+ * @brief 析构函数
+ */
+SerialTraceWriter::~SerialTraceWriter()
+{
+    stop();
+}
+
+void SerialTraceWriter::setFileSize(qint64 bytes)
+{
+    m_fileSize = qBound<qint64>(256 * 1024, bytes, 1024LL * 1024 * 1024);
+}
+
+void SerialTraceWriter::setBlockSize(int bytes)
+{
+    m_blockSize = qBound(4 * 1024, bytes, 1024 * 1024);
+}
+
+void SerialTraceWriter::setFlushInterval(int msecs)
+{
+    m_flushMs = qMax(10, msecs);
+}
+
+/**
+ * @brief 打开抓包文件并启动写入线程
+ */
+bool SerialTraceWriter::start(const QString &path, const QString &portName, qint32 baudRate)
+{
+    stop();
+
+    m_path = path;
+    m_blockCount = static_cast<int>(qMax<qint64>(2, (m_fileSize - SERIAL_TRACE_HEADER_SIZE) / m_blockSize));
+    if (!openFile(portName, baudRate))
+    {
+        qWarning() << "[SerialTraceWriter]" << m_lastError;
+        return false;
+    }
+
+    m_block.reserve(m_blockSize);
+    m_blockInfo = SerialTraceBlockHeader();
+    m_block.resize(0);
+    nextBlock();
+
+    m_recordsCaptured.store(0);
+    m_bytesCaptured.store(0);
+    m_recordsDropped.store(0);
+    m_blocksWritten.store(0);
+    m_writeErrors.store(0);
+
+    {
+        QMutexLocker locker(&m_stageMutex);
+        // 暂存区容纳4个块，写入线程停顿数秒也不丢
+        m_stageLimit = m_blockSize * 4;
+        m_stage.reserve(m_stageLimit);
+        m_stage.resize(0);
+        m_dropPending = false;
+        m_active.store(1);
+    }
+
+    m_thread = new SerialTraceWriterThread(this);
+    m_thread->start(QThread::LowPriority);
+
+    qInfo() << "[SerialTraceWriter] 开始抓包:" << path
+            << "文件大小:" << (SERIAL_TRACE_HEADER_SIZE + static_cast<qint64>(m_blockCount) * m_blockSize)
+            << "块大小:" << m_blockSize << "起始序号:" << m_blockInfo.sequence;
+    return true;
+}
+
+/**
+ * @brief 写完暂存的记录并关闭文件
+ */
+void SerialTraceWriter::stop()
+{
+    if (!m_thread)
+    {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_stageMutex);
+        m_active.store(0);
+    }
+
+    m_thread->stop();
+    delete m_thread;
+    m_thread = nullptr;
+
+    ::close(m_fd);
+    m_fd = -1;
+
+    qInfo() << "[SerialTraceWriter] 抓包结束:" << m_path
+            << "记录:" << m_recordsCaptured.load() << "字节:" << m_bytesCaptured.load()
+            << "丢弃:" << m_recordsDropped.load() << "写入错误:" << m_writeErrors.load();
+}
+
+/**
+ * @brief 记录一次收发
+ */
+void SerialTraceWriter::record(quint8 direction, const char *data, int length, qint64 timestampUs)
+{
+    // 未开启抓包时只有这一次原子读
+    if (length <= 0 || m_active.load() == 0)
+    {
+        return;
+    }
+
+    // 超过块容量的数据拆成多条记录
+    const int maxPiece = qMin(SERIAL_TRACE_MAX_PAYLOAD,
+                              m_blockSize - SERIAL_TRACE_BLOCK_HEADER - SERIAL_TRACE_RECORD_HEADER);
+    const int pieces = (length + maxPiece - 1) / maxPiece;
+    const int total = length + pieces * SERIAL_TRACE_RECORD_HEADER;
+
+    QMutexLocker locker(&m_stageMutex);
+    if (m_active.load() == 0)
+    {
+        return;
+    }
+    if (m_stage.size() + total > m_stageLimit)
+    {
+        m_recordsDropped.ref();
+        m_dropPending = true;
+        return;
+    }
+
+    quint8 flags = m_dropPending ? SERIAL_TRACE_FLAG_DROPPED : 0;
+    m_dropPending = false;
+
+    int offset = 0;
+    while (offset < length)
+    {
+        const int piece = qMin(maxPiece, length - offset);
+        const int pos = m_stage.size();
+        m_stage.resize(pos + SERIAL_TRACE_RECORD_HEADER + piece);
+        uchar *out = reinterpret_cast<uchar *>(m_stage.data()) + pos;
+        serialTraceEncodeRecordHeader(out, timestampUs, direction, flags, piece);
+        memcpy(out + SERIAL_TRACE_RECORD_HEADER, data + offset, static_cast<size_t>(piece));
+        offset += piece;
+        flags = SERIAL_TRACE_FLAG_CONTINUATION;
+    }
+
+    m_recordsCaptured.ref();
+    m_bytesCaptured.fetchAndAddRelaxed(static_cast<quint64>(length));
+
+    if (m_stage.size() >= m_blockSize / 2)
+    {
+        m_stageReady.wakeOne();
+    }
+}
+
+/**
+ * @brief 打开或创建抓包文件
+ *
+ * 已存在且块参数相同时保留原有块，从最大序号之后继续；否则重建
+ */
+bool SerialTraceWriter::openFile(const QString &portName, qint32 baudRate)
+{
+    m_fd = ::open(m_path.toLocal8Bit().constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+    {
+        m_lastError = QString("无法打开抓包文件%1: %2").arg(m_path, strerror(errno));
+        return false;
+    }
+
+    uchar header[SERIAL_TRACE_HEADER_SIZE];
+    bool resume = false;
+    if (::pread(m_fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+        memcmp(header, SERIAL_TRACE_MAGIC, 8) == 0 &&
+        qFromLittleEndian<quint16>(header + 8) == SERIAL_TRACE_VERSION &&
+        qFromLittleEndian<quint32>(header + 12) == static_cast<quint32>(m_blockSize) &&
+        qFromLittleEndian<quint32>(header + 16) == static_cast<quint32>(m_blockCount))
+    {
+        resume = true;
+    }
+
+    quint64 maxSequence = 0;
+    if (resume)
+    {
+        uchar blockHeader[SERIAL_TRACE_BLOCK_HEADER];
+        for (int i = 0; i < m_blockCount; ++i)
+        {
+            const qint64 offset = SERIAL_TRACE_HEADER_SIZE + static_cast<qint64>(i) * m_blockSize;
+            SerialTraceBlockHeader info;
+            if (::pread(m_fd, blockHeader, sizeof(blockHeader), offset) == static_cast<ssize_t>(sizeof(blockHeader)) &&
+                info.deserialize(blockHeader))
+            {
+                maxSequence = qMax(maxSequence, info.sequence);
+            }
+        }
+    }
+    else
+    {
+        // 稀疏文件，未写过的块槽不占空间
+        const qint64 size = SERIAL_TRACE_HEADER_SIZE + static_cast<qint64>(m_blockCount) * m_blockSize;
+        if (::ftruncate(m_fd, 0) < 0 || ::ftruncate(m_fd, size) < 0)
+        {
+            m_lastError = QString("设置抓包文件大小失败: %1").arg(strerror(errno));
+            ::close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+    }
+    m_nextSequence = maxSequence + 1;
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, SERIAL_TRACE_MAGIC, 8);
+    qToLittleEndian<quint16>(SERIAL_TRACE_VERSION, header + 8);
+    qToLittleEndian<quint16>(SERIAL_TRACE_HEADER_SIZE, header + 10);
+    qToLittleEndian<quint32>(static_cast<quint32>(m_blockSize), header + 12);
+    qToLittleEndian<quint32>(static_cast<quint32>(m_blockCount), header + 16);
+    qToLittleEndian<quint32>(static_cast<quint32>(baudRate), header + 20);
+    const QByteArray name = portName.toUtf8().left(SERIAL_TRACE_PORT_NAME_SIZE);
+    memcpy(header + 28, name.constData(), static_cast<size_t>(name.size()));
+    if (!pwriteAll(m_fd, reinterpret_cast<const char *>(header), sizeof(header), 0))
+    {
+        m_lastError = QString("写入抓包文件头失败: %1").arg(strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    if (resume)
+    {
+        qInfo() << "[SerialTraceWriter] 接续已有抓包文件，上次最大块序号:" << maxSequence;
+    }
+    return true;
+}
+
+/**
+ * @brief 把取走的暂存记录整理进块
+ */
+void SerialTraceWriter::processBatch(const QByteArray &batch)
+{
+    if (batch.isEmpty())
+    {
+        return;
+    }
+
+    // 单调时间到UTC的换算量，块头记录首条记录对应的UTC时间
+    const qint64 wallOffset = realtimeUs() - monotonicUs();
+
+    const uchar *p = reinterpret_cast<const uchar *>(batch.constData());
+    qint64 remain = batch.size();
+    while (remain > 0)
+    {
+        SerialTraceRecord record;
+        const int size = serialTraceDecodeRecord(p, remain, record);
+        if (size < 0)
+        {
+            break;
+        }
+
+        if (m_block.size() + size > m_blockSize)
+        {
+            writeBlock();
+            nextBlock();
+        }
+        if (m_blockInfo.recordCount == 0)
+        {
+            m_blockInfo.firstUs = record.timestampUs;
+            m_blockInfo.wallUs = record.timestampUs + wallOffset;
+        }
+
+        m_block.append(reinterpret_cast<const char *>(p), size);
+        m_blockInfo.recordCount++;
+        m_blockInfo.used += static_cast<quint32>(size);
+
+        p += size;
+        remain -= size;
+    }
+}
+
+/**
+ * @brief 把当前块未写出的部分写入块槽
+ *
+ * 新块整块一次写入；已写过的块先追加记录再更新块头，
+ * 中途断电时块头描述的范围一定已经写入
+ */
+void SerialTraceWriter::writeBlock()
+{
+    if (m_blockInfo.recordCount == 0 || m_block.size() == m_blockWritten)
+    {
+        return;
+    }
+
+    m_blockInfo.serialize(reinterpret_cast<uchar *>(m_block.data()));
+    const qint64 slot = SERIAL_TRACE_HEADER_SIZE
+                      + static_cast<qint64>((m_blockInfo.sequence - 1) % static_cast<quint64>(m_blockCount)) * m_blockSize;
+
+    bool ok;
+    if (m_blockWritten == 0)
+    {
+        ok = pwriteAll(m_fd, m_block.constData(), m_block.size(), slot);
+    }
+    else
+    {
+        ok = pwriteAll(m_fd, m_block.constData() + m_blockWritten, m_block.size() - m_blockWritten,
+                       slot + m_blockWritten) &&
+             pwriteAll(m_fd, m_block.constData(), SERIAL_TRACE_BLOCK_HEADER, slot);
+    }
+
+    if (ok)
+    {
+        m_blockWritten = m_block.size();
+    }
+    else
+    {
+        // 存储卡满等错误：保留内存中的块，下次整块重写
+        const quint64 errors = m_writeErrors.fetchAndAddRelaxed(1) + 1;
+        m_blockWritten = 0;
+        if (errors == 1 || errors % 100 == 0)
+        {
+            qWarning() << "[SerialTraceWriter] 写入失败:" << strerror(errno) << "累计" << errors << "次";
+        }
+    }
+}
+
+/**
+ * @brief 开始下一个块
+ */
+void SerialTraceWriter::nextBlock()
+{
+    if (m_blockInfo.recordCount > 0)
+    {
+        m_blocksWritten.ref();
+    }
+    m_blockInfo = SerialTraceBlockHeader();
+    m_blockInfo.sequence = m_nextSequence++;
+    m_block.resize(SERIAL_TRACE_BLOCK_HEADER);
+    m_blockWritten = 0;
+}
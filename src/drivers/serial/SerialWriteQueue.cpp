@@ -0,0 +1,205 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialWriteQueue.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口发送队列实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/serial/SerialWriteQueue.h"
+#include <QMutexLocker>
+
+#include <errno.h>
+#include <sys/uio.h>
+
+namespace {
+
+const int COALESCE_LIMIT = 128;         // 小于该长度的写入合并到自有分段
+const int OWNED_SEGMENT_SIZE = 1024;    // 自有分段容量
+const int MAX_IOV = 64;                 // 单次writev的分段数
+
+} // namespace
+
+/**
+ * @brief 构造函数
+ */
+SerialWriteQueue::SerialWriteQueue(qint64 maxBytes, int maxSegments)
+    : m_headOffset(0)
+    , m_tailOwned(false)
+    , m_size(0)
+    , m_maxBytes(qMax<qint64>(1024, maxBytes))
+    , m_maxSegments(qMax(1, maxSegments))
+    , m_totalWritten(0)
+    , m_writevCalls(0)
+{
+}
+
+/**
+ * @brief 设置队列上限
+ */
+void SerialWriteQueue::setLimits(qint64 maxBytes, int maxSegments)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxBytes = qMax<qint64>(1024, maxBytes);
+    m_maxSegments = qMax(1, maxSegments);
+}
+
+/**
+ * @brief 入队
+ */
+bool SerialWriteQueue::enqueue(const QByteArray &data)
+{
+    if (data.isEmpty())
+    {
+        return true;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    // 小块写入合并到队尾自有分段（该分段不与外部共享，追加不会分离拷贝）
+    if (data.size() < COALESCE_LIMIT && m_tailOwned &&
+        m_segments.last().size() + data.size() <= OWNED_SEGMENT_SIZE)
+    {
+        if (m_size + data.size() > m_maxBytes)
+        {
+            return false;
+        }
+        m_segments.last().append(data);
+        m_size += data.size();
+        return true;
+    }
+
+    if (m_size > 0 && (m_size + data.size() > m_maxBytes || m_segments.size() >= m_maxSegments))
+    {
+        return false;
+    }
+
+    if (data.size() < COALESCE_LIMIT)
+    {
+        QByteArray owned;
+        owned.reserve(OWNED_SEGMENT_SIZE);
+        owned.append(data);
+        m_segments.enqueue(owned);
+        m_tailOwned = true;
+    }
+    else
+    {
+        m_segments.enqueue(data);
+        m_tailOwned = false;
+    }
+    m_size += data.size();
+    return true;
+}
+
+/**
+ * @brief 用writev写出
+ */
+qint64 SerialWriteQueue::writeTo(int fd, int *errorCode)
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 total = 0;
+    *errorCode = 0;
+
+    while (!m_segments.isEmpty())
+    {
+        struct iovec iov[MAX_IOV];
+        int count = 0;
+        qint64 requested = 0;
+
+        for (int i = 0; i < m_segments.size() && count < MAX_IOV; ++i)
+        {
+            const QByteArray &segment = m_segments.at(i);
+            const int offset = (i == 0) ? m_headOffset : 0;
+            iov[count].iov_base = const_cast<char *>(segment.constData() + offset);
+            iov[count].iov_len = static_cast<size_t>(segment.size() - offset);
+            requested += segment.size() - offset;
+            count++;
+        }
+
+        const ssize_t n = ::writev(fd, iov, count);
+        m_writevCalls++;
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                *errorCode = errno;
+            }
+            break;
+        }
+
+        consumeLocked(n);
+        total += n;
+
+        // 内核缓冲区已满，等下次可写
+        if (n < requested)
+        {
+            break;
+        }
+    }
+
+    m_totalWritten += static_cast<quint64>(total);
+    return total;
+}
+
+/**
+ * @brief 移除已写出的数据（只弹出整段或移动队首偏移）
+ */
+void SerialWriteQueue::consumeLocked(qint64 bytes)
+{
+    m_size -= bytes;
+    while (bytes > 0 && !m_segments.isEmpty())
+    {
+        const int remaining = m_segments.head().size() - m_headOffset;
+        if (bytes < remaining)
+        {
+            m_headOffset += static_cast<int>(bytes);
+            return;
+        }
+
+        bytes -= remaining;
+        m_segments.dequeue();
+        m_headOffset = 0;
+        if (m_segments.isEmpty())
+        {
+            m_tailOwned = false;
+        }
+    }
+}
+
+/**
+ * @brief 清空
+ */
+void SerialWriteQueue::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_segments.clear();
+    m_headOffset = 0;
+    m_tailOwned = false;
+    m_size = 0;
+}
+
+/**
+ * @brief 排队字节数
+ */
+qint64 SerialWriteQueue::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_size;
+}
+
+/**
+ * @brief 分段数
+ */
+int SerialWriteQueue::segmentCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_segments.size();
+}
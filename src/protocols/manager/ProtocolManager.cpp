@@ -11,6 +11,7 @@
 #include "protocols/modbus/ModbusRTU.h"
 #include "protocols/modbus/ModbusTCP.h"
 #include "protocols/modbus/ModbusSlave.h"
+#include "drivers/manager/DriverManager.h"
 #include <QDebug>
 
 // 静态成员初始化
@@ -56,6 +57,7 @@ bool ProtocolManager::createModbusRTU(const QString &name, const QString &portNa
     }
     
     ProtocolModbusRTU *protocol = new ProtocolModbusRTU(portName, this);
+    protocol->setRs485(DriverManager::getInstance().getSerialRs485(portName));
     
     if (registerProtocol(name, protocol)) {
         qInfo() << "Created Modbus RTU protocol:" << name << "Port:" << portName;
@@ -101,6 +103,7 @@ bool ProtocolManager::createModbusSlave(const QString &name, const QString &port
     }
     
     ProtocolModbusSlave *protocol = new ProtocolModbusSlave(portName, slaveAddress, this);
+    protocol->setRs485(DriverManager::getInstance().getSerialRs485(portName));
     
     if (registerProtocol(name, protocol)) {
         qInfo() << "Created Modbus RTU Slave:" << name 
@@ -0,0 +1,376 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: CANModbusBridge.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN信号到Modbus寄存器的桥接实现
+ ***************************************************************/
+
+#include "protocols/modbus/CANModbusBridge.h"
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+#define BRIDGE_MAX_PAYLOAD      CAN_SIGNAL_MAX_PAYLOAD
+#define BRIDGE_WRITE_BATCH      32      // 单次加锁写入的寄存器数上限
+
+/***************************************************************
+ * 构造函数
+ ***************************************************************/
+CANModbusBridge::CANModbusBridge(ProtocolModbusSlave *slave)
+    : m_slave(slave)
+{
+    m_framesMatched.store(0);
+    m_registerUpdates.store(0);
+    m_shortFrames.store(0);
+}
+
+/***************************************************************
+ * 从配置参数解析映射
+ ***************************************************************/
+bool CANModbusBridge::parseMapping(const QString &name, const QMap<QString, QVariant> &params,
+                                   Mapping &mapping, QString *errorMessage)
+{
+    mapping = Mapping();
+    mapping.name = name;
+
+    bool ok = false;
+    mapping.canId = params.value("can_id").toString().toUInt(&ok, 0);
+    if (!ok) {
+        if (errorMessage) *errorMessage = QString("%1: can_id无效").arg(name);
+        return false;
+    }
+    mapping.extended = params.contains("extended")
+                       ? params.value("extended").toBool()
+                       : (mapping.canId > 0x7FF);
+
+    mapping.startBit = params.value("start_bit", 0).toString().toInt(&ok, 0);
+    if (!ok) {
+        if (errorMessage) *errorMessage = QString("%1: start_bit无效").arg(name);
+        return false;
+    }
+    mapping.length = params.value("length", 16).toString().toInt(&ok, 0);
+    if (!ok) {
+        if (errorMessage) *errorMessage = QString("%1: length无效").arg(name);
+        return false;
+    }
+
+    QString byteOrder = params.value("byte_order", "intel").toString().toLower();
+    if (byteOrder == "intel" || byteOrder == "little") {
+        mapping.motorola = false;
+    } else if (byteOrder == "motorola" || byteOrder == "big") {
+        mapping.motorola = true;
+    } else {
+        if (errorMessage) *errorMessage = QString("%1: byte_order无效: %2").arg(name, byteOrder);
+        return false;
+    }
+
+    mapping.isSigned = params.value("signed", false).toBool();
+    mapping.factor = params.value("factor", 1.0).toDouble();
+    mapping.offset = params.value("offset", 0.0).toDouble();
+    mapping.scale = params.value("scale", 1.0).toDouble();
+
+    QString table = params.value("register_type", "holding").toString().toLower();
+    if (table == "holding") {
+        mapping.table = ProtocolModbusSlave::HoldingRegisters;
+    } else if (table == "input") {
+        mapping.table = ProtocolModbusSlave::InputRegisters;
+    } else {
+        if (errorMessage) *errorMessage = QString("%1: register_type无效: %2").arg(name, table);
+        return false;
+    }
+
+    uint address = params.value("register").toString().toUInt(&ok, 0);
+    if (!ok || address > 0xFFFF) {
+        if (errorMessage) *errorMessage = QString("%1: register无效").arg(name);
+        return false;
+    }
+    mapping.address = static_cast<quint16>(address);
+
+    static const QMap<QString, Format> formats = {
+        {"u16", FormatU16}, {"s16", FormatS16},
+        {"u32", FormatU32}, {"s32", FormatS32},
+        {"f32", FormatFloat32}, {"float", FormatFloat32}
+    };
+    QString format = params.value("format", "u16").toString().toLower();
+    if (!formats.contains(format)) {
+        if (errorMessage) *errorMessage = QString("%1: format无效: %2").arg(name, format);
+        return false;
+    }
+    mapping.format = formats.value(format);
+    mapping.wordSwap = params.value("word_swap", false).toBool();
+
+    return true;
+}
+
+/***************************************************************
+ * 添加映射
+ ***************************************************************/
+bool CANModbusBridge::addMapping(const Mapping &mapping, QString *errorMessage)
+{
+    CompiledSignal compiled;
+    if (!compileSignal(mapping, compiled, errorMessage)) {
+        return false;
+    }
+
+    m_mappings.append(mapping);
+    return true;
+}
+
+/***************************************************************
+ * 清除映射
+ ***************************************************************/
+void CANModbusBridge::clear()
+{
+    m_mappings.clear();
+    m_signals.clear();
+    m_index.clear();
+}
+
+/***************************************************************
+ * 编译映射表
+ ***************************************************************/
+bool CANModbusBridge::compile(QString *errorMessage)
+{
+    const int registerCount = ProtocolModbusSlave::registerCount();
+
+    // 检查寄存器越界与重叠（两张表分开占用）
+    QVector<int> owner(2 * registerCount, -1);
+    for (int i = 0; i < m_mappings.size(); i++) {
+        const Mapping &m = m_mappings[i];
+        for (int r = 0; r < m.registerCount(); r++) {
+            int address = m.address + r;
+            if (address >= registerCount) {
+                if (errorMessage) {
+                    *errorMessage = QString("%1: 寄存器0x%2超出范围（共%3个）")
+                                    .arg(m.name).arg(address, 4, 16, QChar('0')).arg(registerCount);
+                }
+                return false;
+            }
+            int slot = m.table * registerCount + address;
+            if (owner[slot] >= 0) {
+                if (errorMessage) {
+                    *errorMessage = QString("%1: 寄存器0x%2与%3重叠")
+                                    .arg(m.name).arg(address, 4, 16, QChar('0'))
+                                    .arg(m_mappings[owner[slot]].name);
+                }
+                return false;
+            }
+            owner[slot] = i;
+        }
+    }
+
+    // 按ID分组，同一ID的信号连续存放，接收路径一次查找处理整帧
+    QVector<int> order(m_mappings.size());
+    for (int i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return makeKey(m_mappings[a].canId, m_mappings[a].extended) <
+               makeKey(m_mappings[b].canId, m_mappings[b].extended);
+    });
+
+    QVector<CompiledSignal> compiledSignals;
+    QHash<quint32, IdRange> index;
+    compiledSignals.reserve(order.size());
+
+    for (int i : order) {
+        const Mapping &m = m_mappings[i];
+        CompiledSignal compiled;
+        if (!compileSignal(m, compiled, errorMessage)) {
+            return false;
+        }
+
+        quint32 key = makeKey(m.canId, m.extended);
+        QHash<quint32, IdRange>::iterator it = index.find(key);
+        if (it == index.end()) {
+            IdRange range;
+            range.first = compiledSignals.size();
+            range.count = 0;
+            it = index.insert(key, range);
+        }
+        it->count++;
+        compiledSignals.append(compiled);
+    }
+
+    m_signals = compiledSignals;
+    m_index = index;
+
+    qInfo() << "[CANModbusBridge] 映射表已编译:" << m_signals.size() << "个信号,"
+            << m_index.size() << "个CAN ID";
+    return true;
+}
+
+/***************************************************************
+ * 编译单个信号
+ ***************************************************************/
+bool CANModbusBridge::compileSignal(const Mapping &mapping, CompiledSignal &compiled,
+                                    QString *errorMessage)
+{
+    if (mapping.canId > (mapping.extended ? 0x1FFFFFFFU : 0x7FFU)) {
+        if (errorMessage) *errorMessage = QString("%1: CAN ID超出范围").arg(mapping.name);
+        return false;
+    }
+
+    QString reason;
+    if (!compiled.extractor.compile(mapping.startBit, mapping.length, mapping.motorola,
+                                    mapping.isSigned, &reason)) {
+        if (errorMessage) *errorMessage = QString("%1: %2").arg(mapping.name, reason);
+        return false;
+    }
+
+    compiled.gain = mapping.factor * mapping.scale;
+    compiled.bias = mapping.offset * mapping.scale;
+    compiled.identity = (compiled.gain == 1.0 && compiled.bias == 0.0);
+    compiled.format = static_cast<quint8>(mapping.format);
+    compiled.table = static_cast<quint8>(mapping.table);
+    compiled.wordSwap = mapping.wordSwap;
+    compiled.address = mapping.address;
+    return true;
+}
+
+/***************************************************************
+ * 提取信号并编码为寄存器写入项
+ ***************************************************************/
+int CANModbusBridge::encode(const CompiledSignal &compiled, const uchar *payload,
+                            ProtocolModbusSlave::RegisterWrite *writes)
+{
+    // 8字节窗口（调用者保证缓冲区在窗口范围内可读）
+    qint64 value = compiled.extractor.extractRaw(payload);
+
+    // 按格式换算并饱和
+    double physical = compiled.identity ? double(value)
+                                        : double(value) * compiled.gain + compiled.bias;
+    quint32 encoded;
+    switch (compiled.format) {
+        case FormatU16:
+            encoded = compiled.identity ? quint32(qBound(Q_INT64_C(0), value, Q_INT64_C(0xFFFF)))
+                                        : quint32(qBound(0.0, std::round(physical), 65535.0));
+            break;
+        case FormatS16:
+            encoded = quint16(qint16(compiled.identity
+                              ? qBound(Q_INT64_C(-32768), value, Q_INT64_C(32767))
+                              : qint64(qBound(-32768.0, std::round(physical), 32767.0))));
+            break;
+        case FormatU32:
+            encoded = compiled.identity ? quint32(qBound(Q_INT64_C(0), value, Q_INT64_C(0xFFFFFFFF)))
+                                        : quint32(qBound(0.0, std::round(physical), 4294967295.0));
+            break;
+        case FormatS32:
+            encoded = quint32(qint32(compiled.identity
+                              ? qBound(Q_INT64_C(-2147483648), value, Q_INT64_C(2147483647))
+                              : qint64(qBound(-2147483648.0, std::round(physical), 2147483647.0))));
+            break;
+        default: {
+            float f = static_cast<float>(physical);
+            memcpy(&encoded, &f, sizeof(encoded));
+            break;
+        }
+    }
+
+    if (compiled.format == FormatU16 || compiled.format == FormatS16) {
+        writes[0].table = compiled.table;
+        writes[0].address = compiled.address;
+        writes[0].value = static_cast<quint16>(encoded);
+        return 1;
+    }
+
+    quint16 high = static_cast<quint16>(encoded >> 16);
+    quint16 low = static_cast<quint16>(encoded & 0xFFFF);
+    writes[0].table = compiled.table;
+    writes[0].address = compiled.address;
+    writes[0].value = compiled.wordSwap ? low : high;
+    writes[1].table = compiled.table;
+    writes[1].address = static_cast<quint16>(compiled.address + 1);
+    writes[1].value = compiled.wordSwap ? high : low;
+    return 2;
+}
+
+/***************************************************************
+ * 接收路径回调
+ ***************************************************************/
+void CANModbusBridge::canFrameReceived(const QCanBusFrame &frame)
+{
+    if (m_index.isEmpty() || frame.frameType() != QCanBusFrame::DataFrame) {
+        return;
+    }
+
+    QHash<quint32, IdRange>::const_iterator it =
+        m_index.constFind(makeKey(frame.frameId(), frame.hasExtendedFrameFormat()));
+    if (it == m_index.constEnd()) {
+        return;
+    }
+
+    // 拷贝到带余量的缓冲区，8字节窗口不会越界
+    const QByteArray payload = frame.payload();
+    const int length = qMin(payload.size(), BRIDGE_MAX_PAYLOAD);
+    uchar buffer[BRIDGE_MAX_PAYLOAD + CAN_SIGNAL_PAD_BYTES] = {0};
+    memcpy(buffer, payload.constData(), static_cast<size_t>(length));
+
+    ProtocolModbusSlave::RegisterWrite writes[BRIDGE_WRITE_BATCH];
+    int count = 0;
+    int updates = 0;
+
+    const CompiledSignal *compiled = m_signals.constData() + it->first;
+    for (int i = 0; i < it->count; i++, compiled++) {
+        if (length < compiled->extractor.minLength) {
+            m_shortFrames.ref();
+            continue;
+        }
+        if (count + 2 > BRIDGE_WRITE_BATCH) {
+            m_slave->applyRegisterWrites(writes, count);
+            updates += count;
+            count = 0;
+        }
+        count += encode(*compiled, buffer, writes + count);
+    }
+
+    if (count > 0) {
+        m_slave->applyRegisterWrites(writes, count);
+        updates += count;
+    }
+
+    // 全部信号都因长度不足跳过的帧只计入m_shortFrames
+    if (updates > 0) {
+        m_framesMatched.ref();
+        m_registerUpdates.fetchAndAddRelaxed(static_cast<quint64>(updates));
+    }
+}
+
+/***************************************************************
+ * 生成映射与统计报告
+ ***************************************************************/
+QString CANModbusBridge::generateReport() const
+{
+    static const char *const formatNames[] = { "u16", "s16", "u32", "s32", "f32" };
+
+    QString report;
+    QTextStream out(&report);
+
+    out << "========================================\n";
+    out << "  CAN -> Modbus Bridge\n";
+    out << "========================================\n";
+    out << "Mappings:        " << m_mappings.size() << " (" << m_index.size() << " CAN IDs)\n";
+    out << "Frames matched:  " << getFramesMatched() << "\n";
+    out << "Register writes: " << getRegisterUpdates() << "\n";
+    out << "Short frames:    " << getShortFrames() << "\n";
+    out << "----------------------------------------\n";
+    for (const Mapping &m : m_mappings) {
+        out << QString("%1 0x%2 bit%3+%4 %5 -> %6[0x%7] %8 x%9\n")
+               .arg(m.name, -12)
+               .arg(m.canId, m.extended ? 8 : 3, 16, QChar('0'))
+               .arg(m.startBit)
+               .arg(m.length)
+               .arg(m.motorola ? "BE" : "LE")
+               .arg(m.table == ProtocolModbusSlave::InputRegisters ? "IR" : "HR")
+               .arg(m.address, 4, 16, QChar('0'))
+               .arg(formatNames[m.format])
+               .arg(m.factor * m.scale);
+    }
+    out << "========================================\n";
+
+    return report;
+}
@@ -0,0 +1,676 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: ModbusPollScheduler.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: Modbus主站轮询调度器实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 同时到期的相邻点合并为块读取（ModbusReadPlanner）
+ *   3. 2026-10-18 合并读取收到异常响应时按组退回紧邻合并/逐点读取
+ *   4. 2026-10-18 只有地址类异常才退级，退级一段时间后试着恢复
+ ***************************************************************/
+
+#include "protocols/modbus/ModbusPollScheduler.h"
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+const quint8 EXCEPTION_ILLEGAL_DATA_ADDRESS = 0x02;
+const quint8 EXCEPTION_ILLEGAL_DATA_VALUE = 0x03;
+const qint64 FALLBACK_RETRY_US = 600000000LL;      // 退级后10分钟试着回到上一级
+
+/**
+ * @brief 截止时间堆的比较（std::*_heap为最大堆，反过来比较得到最小堆）
+ */
+template <typename Entry>
+bool laterDue(const Entry &a, const Entry &b)
+{
+    return a.dueUs > b.dueUs;
+}
+
+const char *typeName(ModbusPointType type)
+{
+    switch (type) {
+        case ModbusPointType::Coil:            return "coil";
+        case ModbusPointType::DiscreteInput:   return "input";
+        case ModbusPointType::HoldingRegister: return "holding";
+        case ModbusPointType::InputRegister:   return "inreg";
+    }
+    return "?";
+}
+
+} // namespace
+
+/***************************************************************
+ * 构造函数
+ ***************************************************************/
+ModbusPollScheduler::ModbusPollScheduler(ProtocolModbusRTU *master, QObject *parent)
+    : QObject(parent)
+    , m_master(master)
+    , m_coalescing(true)
+    , m_activeStartUs(0)
+    , m_running(false)
+    , m_dispatching(false)
+    , m_busy(false)
+    , m_activeRequest(0)
+    , m_generation(0)
+    , m_statsStartUs(0)
+{
+    m_dueTimer = new QTimer(this);
+    m_dueTimer->setSingleShot(true);
+    m_dueTimer->setTimerType(Qt::PreciseTimer);
+    QObject::connect(m_dueTimer, &QTimer::timeout, this, &ModbusPollScheduler::onDueTimer);
+
+    m_clock.start();
+}
+
+/***************************************************************
+ * 析构函数
+ ***************************************************************/
+ModbusPollScheduler::~ModbusPollScheduler()
+{
+    stop();
+}
+
+/***************************************************************
+ * 添加轮询点
+ ***************************************************************/
+int ModbusPollScheduler::addPoint(const ModbusPollPoint &point)
+{
+    const int limit = ModbusReadPlanner::isBitType(point.type) ? ModbusReadPlanner::MaxReadBits
+                                                                : ModbusReadPlanner::MaxReadRegisters;
+    if (point.slave < 1 || point.slave > 247 || point.count < 1 || point.count > limit ||
+        static_cast<int>(point.address) + point.count > 0x10000 || point.periodMs <= 0 ||
+        point.priority < ModbusPollPoint::Critical || point.priority >= ModbusPollPoint::PriorityCount) {
+        qWarning() << "Modbus poll point rejected: slave" << point.slave << "address" << point.address
+                   << "count" << point.count << "period" << point.periodMs;
+        return -1;
+    }
+
+    PointState state;
+    state.config = point;
+    state.valueOffset = m_values.size();
+    state.enabled = true;
+    state.inFlight = false;
+    state.valid = false;
+    state.failed = false;
+    state.heapSeq = 0;
+    state.dueUs = nowUs();
+    state.lastStartUs = 0;
+    state.lastUpdateUs = 0;
+    state.lastStatus = ModbusRtuStatus::Success;
+
+    const int id = m_points.size();
+    m_points.append(state);
+    m_values.resize(m_values.size() + point.count);
+    m_groups[groupKey(point)].append(id);
+
+    if (m_running) {
+        schedulePoint(id);
+        dispatch();
+    }
+    return id;
+}
+
+/***************************************************************
+ * 删除所有轮询点
+ ***************************************************************/
+void ModbusPollScheduler::clearPoints()
+{
+    const bool running = m_running;
+    stop();
+    m_points.clear();
+    m_values.clear();
+    m_groups.clear();
+    m_groupFallback.clear();
+    m_running = running;
+}
+
+ModbusPollPoint ModbusPollScheduler::point(int id) const
+{
+    return (id >= 0 && id < m_points.size()) ? m_points[id].config : ModbusPollPoint();
+}
+
+/***************************************************************
+ * 启用/暂停单个点
+ ***************************************************************/
+void ModbusPollScheduler::setPointEnabled(int id, bool enabled)
+{
+    if (id < 0 || id >= m_points.size() || m_points[id].enabled == enabled) {
+        return;
+    }
+
+    PointState &state = m_points[id];
+    state.enabled = enabled;
+    if (!enabled) {
+        return;                             // 堆中的条目在取出时丢弃
+    }
+
+    if (m_running && !state.inFlight) {
+        state.dueUs = nowUs();
+        schedulePoint(id);
+        dispatch();
+    }
+}
+
+/***************************************************************
+ * 修改轮询周期
+ ***************************************************************/
+void ModbusPollScheduler::setPointPeriod(int id, int periodMs)
+{
+    if (id >= 0 && id < m_points.size() && periodMs > 0) {
+        m_points[id].config.periodMs = periodMs;
+    }
+}
+
+/***************************************************************
+ * 开始轮询
+ ***************************************************************/
+void ModbusPollScheduler::start()
+{
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    const qint64 now = nowUs();
+    for (int id = 0; id < m_points.size(); ++id) {
+        if (m_points[id].enabled) {
+            m_points[id].dueUs = now;
+            schedulePoint(id);
+        }
+    }
+    dispatch();
+}
+
+/***************************************************************
+ * 停止轮询
+ ***************************************************************/
+void ModbusPollScheduler::stop()
+{
+    m_running = false;
+    m_dueTimer->stop();
+
+    for (int p = 0; p < ModbusPollPoint::PriorityCount; ++p) {
+        m_heaps[p].clear();
+    }
+    for (int id = 0; id < m_points.size(); ++id) {
+        m_points[id].inFlight = false;
+    }
+    m_activeSlices.resize(0);
+
+    // 已发出的请求无法撤回，结果按代号丢弃；还在主站队列中的直接取消
+    // （取消时同步回调，先递增代号）
+    ++m_generation;
+    const quint32 request = m_activeRequest;
+    m_busy = false;
+    m_activeRequest = 0;
+    if (request != 0 && m_master) {
+        m_master->cancelRequest(request);
+    }
+}
+
+/***************************************************************
+ * 值
+ ***************************************************************/
+bool ModbusPollScheduler::isValid(int id) const
+{
+    return id >= 0 && id < m_points.size() && m_points[id].valid;
+}
+
+quint16 ModbusPollScheduler::value(int id, int index) const
+{
+    if (id < 0 || id >= m_points.size() || index < 0 || index >= m_points[id].config.count) {
+        return 0;
+    }
+    return m_values[m_points[id].valueOffset + index];
+}
+
+bool ModbusPollScheduler::values(int id, QVector<quint16> &out) const
+{
+    if (id < 0 || id >= m_points.size() || m_points[id].lastUpdateUs == 0) {
+        return false;
+    }
+    const PointState &state = m_points[id];
+    out.resize(state.config.count);
+    std::copy(m_values.constBegin() + state.valueOffset,
+              m_values.constBegin() + state.valueOffset + state.config.count, out.begin());
+    return true;
+}
+
+qint64 ModbusPollScheduler::lastUpdateUs(int id) const
+{
+    return (id >= 0 && id < m_points.size()) ? m_points[id].lastUpdateUs : 0;
+}
+
+ModbusRtuStatus ModbusPollScheduler::lastStatus(int id) const
+{
+    return (id >= 0 && id < m_points.size()) ? m_points[id].lastStatus : ModbusRtuStatus::NotConnected;
+}
+
+/***************************************************************
+ * 统计
+ ***************************************************************/
+ModbusPollPointStats ModbusPollScheduler::getPointStats(int id) const
+{
+    return (id >= 0 && id < m_points.size()) ? m_points[id].stats : ModbusPollPointStats();
+}
+
+ModbusPollStats ModbusPollScheduler::getStats() const
+{
+    ModbusPollStats stats = m_stats;
+    stats.elapsedUs = nowUs() - m_statsStartUs;
+
+    // 每个点平均每次请求占用的总线时间 / 周期，求和即为按配置周期轮询所需的总线比例
+    stats.load = 0.0;
+    for (const PointState &state : m_points) {
+        if (state.enabled && state.stats.polls > 0) {
+            const double averageUs = static_cast<double>(state.stats.totalElapsedUs) / state.stats.polls;
+            stats.load += averageUs / (state.config.periodMs * 1000.0);
+        }
+    }
+    return stats;
+}
+
+void ModbusPollScheduler::resetStats()
+{
+    m_stats = ModbusPollStats();
+    for (PointState &state : m_points) {
+        state.stats = ModbusPollPointStats();
+        state.lastStartUs = 0;
+    }
+    m_statsStartUs = nowUs();
+}
+
+/***************************************************************
+ * 生成统计报告
+ ***************************************************************/
+QString ModbusPollScheduler::generateReport() const
+{
+    const ModbusPollStats stats = getStats();
+
+    QString report;
+    QTextStream out(&report);
+
+    out << "========================================\n";
+    out << "  Modbus Poll Scheduler\n";
+    out << "========================================\n";
+    out << "Running:         " << (m_running ? "yes" : "no") << "\n";
+    out << "Points:          " << m_points.size() << "\n";
+    out << "Coalescing:      " << (m_coalescing ? "on" : "off")
+        << " (gap " << m_planner.getMaxGap(ModbusPointType::HoldingRegister) << " regs / "
+        << m_planner.getMaxGap(ModbusPointType::Coil) << " bits)\n";
+    for (auto it = m_groupFallback.constBegin(); it != m_groupFallback.constEnd(); ++it) {
+        out << "  fallback slave " << (it.key() >> 8) << " fc " << (it.key() & 0xFF) << ": "
+            << (it.value().level == FallbackAdjacent ? "adjacent only" : "single point") << "\n";
+    }
+    out << "Requests:        " << stats.requests << "\n";
+    out << "Points/request:  "
+        << QString::number(stats.requests > 0 ? static_cast<double>(stats.pointReads) / stats.requests : 0.0, 'f', 2)
+        << "\n";
+    out << "Errors:          " << stats.errors << "\n";
+    out << "Overruns:        " << stats.overruns << "\n";
+    out << "Bus utilisation: " << QString::number(stats.utilisation() * 100.0, 'f', 1) << " %\n";
+    out << "Estimated load:  " << QString::number(stats.load * 100.0, 'f', 1) << " %"
+        << (stats.load > 1.0 ? "  (schedule infeasible)" : "") << "\n";
+    out << "---------------- Points ----------------\n";
+    out << "  id  slave type    addr  cnt pri  period/actual(ms)  polls   err   ovr  late avg/max(us)  name\n";
+    for (int id = 0; id < m_points.size(); ++id) {
+        const PointState &state = m_points[id];
+        const ModbusPollPointStats &s = state.stats;
+        const qint64 lateAverage = (s.polls > 0) ? s.totalLatenessUs / static_cast<qint64>(s.polls) : 0;
+        out << "  " << qSetFieldWidth(3) << id << qSetFieldWidth(0) << " "
+            << qSetFieldWidth(5) << state.config.slave << qSetFieldWidth(0) << " "
+            << QString(typeName(state.config.type)).leftJustified(7) << " "
+            << qSetFieldWidth(5) << state.config.address << qSetFieldWidth(0) << " "
+            << qSetFieldWidth(4) << state.config.count << qSetFieldWidth(0) << " "
+            << qSetFieldWidth(3) << static_cast<int>(state.config.priority) << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(7) << state.config.periodMs << qSetFieldWidth(0) << "/"
+            << qSetFieldWidth(9) << QString::number(s.actualPeriodUs / 1000.0, 'f', 1) << qSetFieldWidth(0) << " "
+            << qSetFieldWidth(6) << s.polls << qSetFieldWidth(0) << " "
+            << qSetFieldWidth(5) << s.errors << qSetFieldWidth(0) << " "
+            << qSetFieldWidth(5) << s.overruns << qSetFieldWidth(0) << "  "
+            << lateAverage << "/" << s.maxLatenessUs
+            << (state.enabled ? "" : "  [disabled]") << "  " << state.config.name << "\n";
+    }
+    out << "========================================\n";
+
+    return report;
+}
+
+/***************************************************************
+ * 最早的截止时间到达
+ ***************************************************************/
+void ModbusPollScheduler::onDueTimer()
+{
+    dispatch();
+}
+
+/***************************************************************
+ * 把点放入其优先级的截止时间堆
+ *   序号递增使该点以前留在堆中的条目失效
+ ***************************************************************/
+void ModbusPollScheduler::schedulePoint(int id)
+{
+    PointState &state = m_points[id];
+    HeapEntry entry;
+    entry.dueUs = state.dueUs;
+    entry.id = id;
+    entry.seq = ++state.heapSeq;
+
+    QVector<HeapEntry> &heap = m_heaps[state.config.priority];
+    heap.append(entry);
+    std::push_heap(heap.begin(), heap.end(), laterDue<HeapEntry>);
+}
+
+/***************************************************************
+ * 取出最高优先级中已到期的点
+ ***************************************************************/
+int ModbusPollScheduler::takeDuePoint(qint64 now, qint64 &earliestUs)
+{
+    earliestUs = -1;
+
+    for (int p = 0; p < ModbusPollPoint::PriorityCount; ++p) {
+        QVector<HeapEntry> &heap = m_heaps[p];
+        while (!heap.isEmpty()) {
+            const HeapEntry &top = heap.first();
+            const PointState &state = m_points[top.id];
+            if (top.seq == state.heapSeq && state.enabled && !state.inFlight) {
+                break;
+            }
+            std::pop_heap(heap.begin(), heap.end(), laterDue<HeapEntry>);
+            heap.removeLast();              // 失效条目
+        }
+        if (heap.isEmpty()) {
+            continue;
+        }
+
+        const HeapEntry top = heap.first();
+        if (top.dueUs <= now) {
+            std::pop_heap(heap.begin(), heap.end(), laterDue<HeapEntry>);
+            heap.removeLast();
+            return top.id;
+        }
+        if (earliestUs < 0 || top.dueUs < earliestUs) {
+            earliestUs = top.dueUs;
+        }
+    }
+    return -1;
+}
+
+/***************************************************************
+ * 发出下一个请求
+ *   取出最高优先级的到期点，把同组中半个周期内也将到期的点一起交给
+ *   规划器，只发出包含该点的那一块。主站未连接等情况下请求会同步
+ *   失败，回调中不递归调用，由这里的循环继续取下一个到期点
+ ***************************************************************/
+void ModbusPollScheduler::dispatch()
+{
+    if (!m_running || m_busy || m_dispatching || !m_master) {
+        return;
+    }
+
+    m_dispatching = true;
+    while (m_running && !m_busy) {
+        const qint64 now = nowUs();
+        qint64 earliestUs = -1;
+        const int id = takeDuePoint(now, earliestUs);
+        if (id < 0) {
+            if (earliestUs >= 0) {
+                m_dueTimer->start(static_cast<int>((earliestUs - now + 999) / 1000));
+            }
+            break;
+        }
+
+        const ModbusPollPoint &config = m_points[id].config;
+        m_planner.clear();
+        m_planner.add(config.slave, config.type, config.address, config.count, id);
+        const int fallback = groupFallback(groupKey(config), now);
+        if (m_coalescing && fallback != FallbackSingle) {
+            const auto group = m_groups.constFind(groupKey(config));
+            if (group != m_groups.constEnd()) {
+                for (int other : group.value()) {
+                    const PointState &state = m_points[other];
+                    if (other == id || !state.enabled || state.inFlight ||
+                        state.dueUs - now > static_cast<qint64>(state.config.periodMs) * 500) {
+                        continue;
+                    }
+                    m_planner.add(state.config.slave, state.config.type, state.config.address,
+                                  state.config.count, other);
+                }
+            }
+        }
+        m_planner.plan(fallback == FallbackNone);
+        m_activeBlock = m_planner.blocks()[m_planner.findBlock(id)];
+
+        m_activeSlices.resize(0);
+        for (int s = 0; s < m_activeBlock.sliceCount; ++s) {
+            const ModbusReadPlanner::Slice &slice = m_planner.slices()[m_activeBlock.firstSlice + s];
+            m_activeSlices.append(slice);
+
+            PointState &state = m_points[slice.tag];
+            state.inFlight = true;
+
+            // 实际周期: 相邻两次发出间隔的滑动平均（1/8）
+            if (state.lastStartUs > 0) {
+                const qint64 interval = now - state.lastStartUs;
+                state.stats.actualPeriodUs = (state.stats.actualPeriodUs == 0)
+                    ? interval : state.stats.actualPeriodUs + (interval - state.stats.actualPeriodUs) / 8;
+            }
+            state.lastStartUs = now;
+            state.stats.lastLatenessUs = qMax(Q_INT64_C(0), now - state.dueUs);
+            state.stats.maxLatenessUs = qMax(state.stats.maxLatenessUs, state.stats.lastLatenessUs);
+            state.stats.totalLatenessUs += state.stats.lastLatenessUs;
+        }
+        m_activeStartUs = now;
+
+        m_busy = true;
+        const quint32 generation = m_generation;
+        QPointer<ModbusPollScheduler> self(this);
+        const quint32 request = m_master->readAsync(m_activeBlock.slave,
+                                                    static_cast<ModbusFunctionCode>(m_activeBlock.type),
+                                                    m_activeBlock.address, m_activeBlock.count,
+                                                    [self, generation](const ModbusRtuResult &result) {
+            if (self) {
+                self->onPollFinished(generation, result);
+            }
+        });
+        if (m_busy && generation == m_generation) {
+            m_activeRequest = request;
+        }
+    }
+    m_dispatching = false;
+}
+
+/***************************************************************
+ * 块读取完成: 按切片保存值、安排下一次截止时间、发布变化
+ ***************************************************************/
+void ModbusPollScheduler::onPollFinished(quint32 generation, const ModbusRtuResult &result)
+{
+    if (generation != m_generation) {
+        return;                             // stop/clearPoints之前发出的请求
+    }
+
+    m_busy = false;
+    m_activeRequest = 0;
+
+    const qint64 now = nowUs();
+    ModbusRtuStatus status = result.status;
+    const uchar *payload = nullptr;
+    if (status == ModbusRtuStatus::Success) {
+        payload = ModbusReadPlanner::payload(m_activeBlock, result.response);
+        if (!payload) {
+            status = ModbusRtuStatus::FrameError;
+        }
+    }
+
+    // 合并读取的地址类异常可能只是空隙或相邻的某个地址未定义，不能让整块的点都失败；
+    // 设备故障、忙等其他异常与块的范围无关，按普通失败处理
+    if (status == ModbusRtuStatus::Exception && m_activeSlices.size() > 1 &&
+        (result.exceptionCode == EXCEPTION_ILLEGAL_DATA_ADDRESS ||
+         result.exceptionCode == EXCEPTION_ILLEGAL_DATA_VALUE)) {
+        fallBackAfterException(result.exceptionCode, result.elapsedUs);
+        dispatch();
+        return;
+    }
+
+    m_stats.requests++;
+    m_stats.pointReads += m_activeSlices.size();
+    m_stats.busyUs += result.elapsedUs;
+    if (status != ModbusRtuStatus::Success) {
+        m_stats.errors++;
+    }
+
+    // 总线时间按点数均分，负载估算不重复计算合并读取
+    const qint64 elapsedShare = result.elapsedUs / qMax(1, m_activeSlices.size());
+
+    QVector<int> changedIds;
+    QVector<int> failedIds;
+    QVector<QPair<int, int> > overruns;
+    for (const ModbusReadPlanner::Slice &slice : m_activeSlices) {
+        const int id = slice.tag;
+        PointState &state = m_points[id];
+        state.inFlight = false;
+        state.lastStatus = status;
+        state.stats.polls++;
+        state.stats.lastElapsedUs = elapsedShare;
+        state.stats.totalElapsedUs += elapsedShare;
+
+        if (status == ModbusRtuStatus::Success) {
+            if (storeValues(state, payload, slice.offset)) {
+                state.stats.changes++;
+                changedIds.append(id);
+            }
+            state.valid = true;
+            state.failed = false;
+            state.lastUpdateUs = now;
+        } else {
+            state.valid = false;
+            state.stats.errors++;
+            if (!state.failed) {
+                failedIds.append(id);
+            }
+            state.failed = true;
+        }
+
+        if (!m_running || !state.enabled) {
+            continue;
+        }
+
+        // 下一次截止时间按周期递推；提前合并读取的点从本次发出时刻起算；
+        // 完成时已错过则跳过错过的周期
+        const qint64 periodUs = static_cast<qint64>(state.config.periodMs) * 1000;
+        qint64 next = qMin(state.dueUs, m_activeStartUs) + periodUs;
+        if (next <= now) {
+            const int missed = static_cast<int>((now - next) / periodUs) + 1;
+            next += missed * periodUs;
+            state.stats.overruns += missed;
+            m_stats.overruns += missed;
+            overruns.append(qMakePair(id, missed));
+        }
+        state.dueUs = next;
+        schedulePoint(id);
+    }
+    m_activeSlices.resize(0);
+
+    // 信号的槽可能调用stop/clearPoints，之后不再访问点的状态
+    for (int id : failedIds) {
+        qWarning() << "Modbus poll point" << id << "failed:" << ModbusRtuResult::statusToString(status);
+        emit pointFailed(id, status);
+    }
+    for (const QPair<int, int> &overrun : overruns) {
+        emit scheduleOverrun(overrun.first, overrun.second);
+    }
+    if (!changedIds.isEmpty()) {
+        emit pointsChanged(changedIds);
+    }
+
+    dispatch();
+}
+
+/***************************************************************
+ * 多点块读取收到地址类异常
+ *   该组退一级（按空隙合并 → 只合并紧邻 → 逐点），块中的点不计失败、
+ *   不更新值，按原截止时间重新入堆，已到期的随即按新方式重读。
+ *   每组最多退两级，重读次数有限
+ ***************************************************************/
+void ModbusPollScheduler::fallBackAfterException(quint8 exceptionCode, qint64 elapsedUs)
+{
+    const int key = (m_activeBlock.slave << 8) | static_cast<int>(m_activeBlock.type);
+    const auto found = m_groupFallback.constFind(key);
+    FallbackState state;
+    state.level = qMin((found != m_groupFallback.constEnd() ? found.value().level : FallbackNone) + 1,
+                       static_cast<int>(FallbackSingle));
+    state.sinceUs = nowUs();
+    m_groupFallback.insert(key, state);
+    const int level = state.level;
+
+    qWarning() << "Modbus poll block slave" << m_activeBlock.slave
+               << "fc" << static_cast<int>(m_activeBlock.type)
+               << "address" << m_activeBlock.address << "count" << m_activeBlock.count
+               << "exception" << exceptionCode << "- group falls back to"
+               << (level == FallbackAdjacent ? "adjacent-only blocks" : "single-point reads");
+
+    m_stats.requests++;
+    m_stats.errors++;
+    m_stats.busyUs += elapsedUs;
+
+    for (const ModbusReadPlanner::Slice &slice : m_activeSlices) {
+        PointState &state = m_points[slice.tag];
+        state.inFlight = false;
+        state.lastStartUs = 0;              // 重读不计入实际周期
+        if (m_running && state.enabled) {
+            schedulePoint(slice.tag);
+        }
+    }
+    m_activeSlices.resize(0);
+}
+
+/***************************************************************
+ * 分组当前的合并方式
+ *   从站的地址表可能随固件或配置改变，退级不是永久的: 超过重试间隔后
+ *   回到上一级，仍然异常时由fallBackAfterException再退回
+ ***************************************************************/
+int ModbusPollScheduler::groupFallback(int key, qint64 now)
+{
+    auto it = m_groupFallback.find(key);
+    if (it == m_groupFallback.end()) {
+        return FallbackNone;
+    }
+    if (now - it.value().sinceUs < FALLBACK_RETRY_US) {
+        return it.value().level;
+    }
+
+    const int level = it.value().level - 1;
+    qInfo() << "Modbus poll slave" << (key >> 8) << "fc" << (key & 0xFF) << "retries"
+            << (level == FallbackNone ? "gap-filling blocks" : "adjacent-only blocks");
+    if (level == FallbackNone) {
+        m_groupFallback.erase(it);
+    } else {
+        it.value().level = level;
+        it.value().sinceUs = now;
+    }
+    return level;
+}
+
+/***************************************************************
+ * 把块读取数据中属于该点的一段写入点的值数组
+ ***************************************************************/
+bool ModbusPollScheduler::storeValues(PointState &state, const uchar *payload, int offset)
+{
+    quint16 *dest = m_values.data() + state.valueOffset;
+    bool changed = !state.valid;
+    for (int i = 0; i < state.config.count; ++i) {
+        const quint16 value = ModbusReadPlanner::valueAt(state.config.type, payload, offset + i);
+        if (dest[i] != value) {
+            dest[i] = value;
+            changed = true;
+        }
+    }
+    return changed;
+}
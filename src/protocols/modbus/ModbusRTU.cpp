@@ -5,13 +5,17 @@
  * Version: 1.0
  * Date: 2025-10-15
  * Description: Modbus RTU协议驱动实现
+ *
+ * History:
+ *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 请求改为队列+状态机，去掉processEvents/msleep轮询
+ *   3. 2026-10-18 按功能码/字节数推算响应长度，T3.5字符间隔和帧间隔定时
+ *   4. 2026-10-18 CRC改用SerialCrc16，响应CRC随接收增量计算
+ *   5. 2026-10-18 打开串口后按配置启用内核RS-485方向控制
  ***************************************************************/
 
 #include "protocols/modbus/ModbusRTU.h"
 #include <QDebug>
-#include <QThread>
-#include <QEventLoop>
-#include <QCoreApplication>
 
 /***************************************************************
  * 构造函数
@@ -22,11 +26,22 @@ ProtocolModbusRTU::ProtocolModbusRTU(const QString &portName, QObject *parent)
     , m_slaveAddress(1)
     , m_timeout(1000)
     , m_waitingForResponse(false)
+    , m_nextId(1)
+    , m_maxQueueSize(256)
+    , m_expectedLength(0)
+    , m_rxCrcBytes(0)
+    , m_charUs(0)
+    , m_t15Us(0)
+    , m_t35Us(0)
+    , m_quietUntilUs(0)
+    , m_broadcastDelay(100)
     , m_baudrate(9600)
     , m_dataBits(QSerialPort::Data8)
     , m_parity(QSerialPort::NoParity)
     , m_stopBits(QSerialPort::OneStop)
 {
+    qRegisterMetaType<ModbusRtuResult>("ModbusRtuResult");
+
     // 创建串口对象
     m_serialPort = new QSerialPort(this);
     m_serialPort->setPortName(m_portName);
@@ -35,11 +50,25 @@ ProtocolModbusRTU::ProtocolModbusRTU(const QString &portName, QObject *parent)
     m_responseTimer = new QTimer(this);
     m_responseTimer->setSingleShot(true);
     
+    // 字符间隔（T3.5）定时器和帧间隔定时器
+    m_charTimer = new QTimer(this);
+    m_charTimer->setSingleShot(true);
+    m_charTimer->setTimerType(Qt::PreciseTimer);
+    m_gapTimer = new QTimer(this);
+    m_gapTimer->setSingleShot(true);
+    m_gapTimer->setTimerType(Qt::PreciseTimer);
+    m_busClock.start();
+    updateTiming();
+    
     // 连接信号槽
     QObject::connect(m_serialPort, &QSerialPort::readyRead, 
             this, &ProtocolModbusRTU::onSerialDataReceived);
     QObject::connect(m_responseTimer, &QTimer::timeout, 
             this, &ProtocolModbusRTU::onResponseTimeout);
+    QObject::connect(m_charTimer, &QTimer::timeout,
+            this, &ProtocolModbusRTU::onCharTimeout);
+    QObject::connect(m_gapTimer, &QTimer::timeout,
+            this, &ProtocolModbusRTU::onGapTimeout);
 }
 
 /***************************************************************
@@ -66,6 +95,7 @@ bool ProtocolModbusRTU::connect()
     m_serialPort->setParity(m_parity);
     m_serialPort->setStopBits(m_stopBits);
     m_serialPort->setFlowControl(QSerialPort::NoFlowControl);
+    updateTiming();
     
     // 打开串口
     if (!m_serialPort->open(QIODevice::ReadWrite)) {
@@ -74,6 +104,12 @@ bool ProtocolModbusRTU::connect()
         return false;
     }
     
+    // 请求→响应换向依赖收发器及时释放总线
+    if (!applyRs485()) {
+        m_serialPort->close();
+        return false;
+    }
+    
     setState(ProtocolState::Connected);
     emit connected();
     
@@ -84,13 +120,66 @@ bool ProtocolModbusRTU::connect()
     return true;
 }
 
+/***************************************************************
+ * 设置RS-485方向控制
+ ***************************************************************/
+bool ProtocolModbusRTU::setRs485(const SerialRs485Config &config)
+{
+    if (m_serialPort->isOpen()) {
+        qWarning() << "Modbus RTU already open, close it before setting RS-485:" << m_portName;
+        return false;
+    }
+    m_rs485 = config;
+    return true;
+}
+
+/***************************************************************
+ * 在已打开的串口上启用内核RS-485
+ *   串口由QSerialPort打开，没有DriverSerial的I/O线程，gpio模式不可用；
+ *   auto模式下驱动不支持TIOCSRS485时不做方向控制（自动换向收发器）
+ ***************************************************************/
+bool ProtocolModbusRTU::applyRs485()
+{
+    if (!m_rs485.isEnabled()) {
+        return true;
+    }
+    if (m_rs485.mode == SerialRs485Config::Gpio) {
+        qWarning() << "Modbus RTU RS-485 gpio mode needs DriverSerial, direction not controlled:" << m_portName;
+        return true;
+    }
+
+    QString errorString;
+    bool notSupported = false;
+    if (!SerialRs485::applyKernel(m_serialPort->handle(), m_rs485, &errorString, &notSupported)) {
+        if (m_rs485.mode == SerialRs485Config::Auto && notSupported) {
+            qWarning() << "Modbus RTU driver has no TIOCSRS485, direction not controlled:" << m_portName;
+            return true;
+        }
+        setError(QString("Failed to enable RS-485 on %1: %2").arg(m_portName, errorString));
+        return false;
+    }
+
+    qInfo() << "Modbus RTU RS-485 kernel direction control enabled:" << m_portName;
+    return true;
+}
+
 /***************************************************************
  * 断开连接
  ***************************************************************/
 void ProtocolModbusRTU::disconnect()
 {
-    if (m_serialPort->isOpen()) {
+    const bool wasOpen = m_serialPort->isOpen();
+    if (wasOpen) {
         m_serialPort->close();
+    }
+
+    // 先关闭串口，回调中再提交的请求会直接以NotConnected失败
+    cancelAll();
+    if (m_waitingForResponse) {
+        finishActive(ModbusRtuStatus::Cancelled);
+    }
+
+    if (wasOpen) {
         setState(ProtocolState::Disconnected);
         emit disconnected();
         qInfo() << "Modbus RTU disconnected";
@@ -192,6 +281,7 @@ void ProtocolModbusRTU::setTimeout(int timeout)
     m_timeout = timeout;
 }
 
+
 /***************************************************************
  * 读取线圈状态 (功能码0x01)
  ***************************************************************/
@@ -200,26 +290,9 @@ QVector<bool> ProtocolModbusRTU::readCoils(quint16 startAddress, quint16 count)
     if (!isConnected() || count == 0 || count > 2000) {
         return QVector<bool>();
     }
-    
-    // 构建请求数据：[起始地址高][起始地址低][数量高][数量低]
-    QByteArray data;
-    data.append((startAddress >> 8) & 0xFF);
-    data.append(startAddress & 0xFF);
-    data.append((count >> 8) & 0xFF);
-    data.append(count & 0xFF);
-    
-    // 发送请求
-    QByteArray response = sendRequest(buildRequest(0x01, data));
-    
-    if (response.isEmpty() || response.size() < 3) {
-        return QVector<bool>();
-    }
-    
-    // 解析响应：[从站地址][功能码][字节数][数据...][CRC]
-    quint8 byteCount = static_cast<quint8>(response[2]);
-    QByteArray coilData = response.mid(3, byteCount);
-    
-    return parseBooleans(coilData, count);
+
+    ModbusRtuResult result = execute(0x01, buildAddressData(startAddress, count));
+    return result.isSuccess() ? result.bits(count) : QVector<bool>();
 }
 
 /***************************************************************
@@ -230,23 +303,9 @@ QVector<bool> ProtocolModbusRTU::readDiscreteInputs(quint16 startAddress, quint1
     if (!isConnected() || count == 0 || count > 2000) {
         return QVector<bool>();
     }
-    
-    QByteArray data;
-    data.append((startAddress >> 8) & 0xFF);
-    data.append(startAddress & 0xFF);
-    data.append((count >> 8) & 0xFF);
-    data.append(count & 0xFF);
-    
-    QByteArray response = sendRequest(buildRequest(0x02, data));
-    
-    if (response.isEmpty() || response.size() < 3) {
-        return QVector<bool>();
-    }
-    
-    quint8 byteCount = static_cast<quint8>(response[2]);
-    QByteArray inputData = response.mid(3, byteCount);
-    
-    return parseBooleans(inputData, count);
+
+    ModbusRtuResult result = execute(0x02, buildAddressData(startAddress, count));
+    return result.isSuccess() ? result.bits(count) : QVector<bool>();
 }
 
 /***************************************************************
@@ -257,23 +316,9 @@ QVector<quint16> ProtocolModbusRTU::readHoldingRegisters(quint16 startAddress, q
     if (!isConnected() || count == 0 || count > 125) {
         return QVector<quint16>();
     }
-    
-    QByteArray data;
-    data.append((startAddress >> 8) & 0xFF);
-    data.append(startAddress & 0xFF);
-    data.append((count >> 8) & 0xFF);
-    data.append(count & 0xFF);
-    
-    QByteArray response = sendRequest(buildRequest(0x03, data));
-    
-    if (response.isEmpty() || response.size() < 3) {
-        return QVector<quint16>();
-    }
-    
-    quint8 byteCount = static_cast<quint8>(response[2]);
-    QByteArray registerData = response.mid(3, byteCount);
-    
-    return parseRegisters(registerData);
+
+    ModbusRtuResult result = execute(0x03, buildAddressData(startAddress, count));
+    return result.isSuccess() ? result.registers() : QVector<quint16>();
 }
 
 /***************************************************************
@@ -284,23 +329,9 @@ QVector<quint16> ProtocolModbusRTU::readInputRegisters(quint16 startAddress, qui
     if (!isConnected() || count == 0 || count > 125) {
         return QVector<quint16>();
     }
-    
-    QByteArray data;
-    data.append((startAddress >> 8) & 0xFF);
-    data.append(startAddress & 0xFF);
-    data.append((count >> 8) & 0xFF);
-    data.append(count & 0xFF);
-    
-    QByteArray response = sendRequest(buildRequest(0x04, data));
-    
-    if (response.isEmpty() || response.size() < 3) {
-        return QVector<quint16>();
-    }
-    
-    quint8 byteCount = static_cast<quint8>(response[2]);
-    QByteArray registerData = response.mid(3, byteCount);
-    
-    return parseRegisters(registerData);
+
+    ModbusRtuResult result = execute(0x04, buildAddressData(startAddress, count));
+    return result.isSuccess() ? result.registers() : QVector<quint16>();
 }
 
 /***************************************************************
@@ -311,16 +342,8 @@ bool ProtocolModbusRTU::writeSingleCoil(quint16 address, bool value)
     if (!isConnected()) {
         return false;
     }
-    
-    QByteArray data;
-    data.append((address >> 8) & 0xFF);
-    data.append(address & 0xFF);
-    data.append(value ? 0xFF : 0x00);
-    data.append(static_cast<char>(0x00));
-    
-    QByteArray response = sendRequest(buildRequest(0x05, data));
-    
-    return !response.isEmpty();
+
+    return execute(0x05, buildAddressData(address, value ? 0xFF00 : 0x0000)).isSuccess();
 }
 
 /***************************************************************
@@ -331,16 +354,8 @@ bool ProtocolModbusRTU::writeSingleRegister(quint16 address, quint16 value)
     if (!isConnected()) {
         return false;
     }
-    
-    QByteArray data;
-    data.append((address >> 8) & 0xFF);
-    data.append(address & 0xFF);
-    data.append((value >> 8) & 0xFF);
-    data.append(value & 0xFF);
-    
-    QByteArray response = sendRequest(buildRequest(0x06, data));
-    
-    return !response.isEmpty();
+
+    return execute(0x06, buildAddressData(address, value)).isSuccess();
 }
 
 /***************************************************************
@@ -351,31 +366,8 @@ bool ProtocolModbusRTU::writeMultipleCoils(quint16 startAddress, const QVector<b
     if (!isConnected() || values.isEmpty() || values.size() > 1968) {
         return false;
     }
-    
-    quint16 count = values.size();
-    quint8 byteCount = (count + 7) / 8;
-    
-    QByteArray data;
-    data.append((startAddress >> 8) & 0xFF);
-    data.append(startAddress & 0xFF);
-    data.append((count >> 8) & 0xFF);
-    data.append(count & 0xFF);
-    data.append(byteCount);
-    
-    // 转换布尔值到字节
-    for (int i = 0; i < byteCount; i++) {
-        quint8 byte = 0;
-        for (int j = 0; j < 8 && (i * 8 + j) < count; j++) {
-            if (values[i * 8 + j]) {
-                byte |= (1 << j);
-            }
-        }
-        data.append(byte);
-    }
-    
-    QByteArray response = sendRequest(buildRequest(0x0F, data));
-    
-    return !response.isEmpty();
+
+    return execute(0x0F, buildCoilsData(startAddress, values)).isSuccess();
 }
 
 /***************************************************************
@@ -386,39 +378,139 @@ bool ProtocolModbusRTU::writeMultipleRegisters(quint16 startAddress, const QVect
     if (!isConnected() || values.isEmpty() || values.size() > 123) {
         return false;
     }
-    
-    quint16 count = values.size();
-    quint8 byteCount = count * 2;
-    
-    QByteArray data;
-    data.append((startAddress >> 8) & 0xFF);
-    data.append(startAddress & 0xFF);
-    data.append((count >> 8) & 0xFF);
-    data.append(count & 0xFF);
-    data.append(byteCount);
-    
-    // 添加寄存器值
-    for (quint16 value : values) {
-        data.append((value >> 8) & 0xFF);
-        data.append(value & 0xFF);
+
+    return execute(0x10, buildRegistersData(startAddress, values)).isSuccess();
+}
+
+/***************************************************************
+ * 提交异步请求
+ ***************************************************************/
+quint32 ProtocolModbusRTU::submitRequest(quint8 slave, quint8 functionCode, const QByteArray &data,
+                                         const ModbusRtuCallback &callback, int timeout)
+{
+    PendingRequest request;
+    request.id = m_nextId++;
+    if (m_nextId == 0) {
+        m_nextId = 1;
+    }
+    request.slave = slave;
+    request.functionCode = functionCode;
+    request.frame = buildRequest(slave, functionCode, data);
+    request.timeout = (timeout > 0) ? timeout : m_timeout;
+    request.callback = callback;
+
+    if (!isConnected()) {
+        failRequest(request, ModbusRtuStatus::NotConnected);
+        return 0;
+    }
+
+    if (m_queue.size() >= m_maxQueueSize) {
+        failRequest(request, ModbusRtuStatus::QueueFull);
+        return 0;
+    }
+
+    m_queue.enqueue(request);
+    startNext();
+
+    return request.id;
+}
+
+/***************************************************************
+ * 异步读取（0x01~0x04）
+ ***************************************************************/
+quint32 ProtocolModbusRTU::readAsync(quint8 slave, ModbusFunctionCode functionCode,
+                                     quint16 startAddress, quint16 count,
+                                     const ModbusRtuCallback &callback)
+{
+    return submitRequest(slave, static_cast<quint8>(functionCode),
+                         buildAddressData(startAddress, count), callback);
+}
+
+quint32 ProtocolModbusRTU::writeSingleCoilAsync(quint8 slave, quint16 address, bool value,
+                                                const ModbusRtuCallback &callback)
+{
+    return submitRequest(slave, 0x05, buildAddressData(address, value ? 0xFF00 : 0x0000), callback);
+}
+
+quint32 ProtocolModbusRTU::writeSingleRegisterAsync(quint8 slave, quint16 address, quint16 value,
+                                                    const ModbusRtuCallback &callback)
+{
+    return submitRequest(slave, 0x06, buildAddressData(address, value), callback);
+}
+
+quint32 ProtocolModbusRTU::writeMultipleCoilsAsync(quint8 slave, quint16 startAddress,
+                                                   const QVector<bool> &values,
+                                                   const ModbusRtuCallback &callback)
+{
+    return submitRequest(slave, 0x0F, buildCoilsData(startAddress, values), callback);
+}
+
+quint32 ProtocolModbusRTU::writeMultipleRegistersAsync(quint8 slave, quint16 startAddress,
+                                                       const QVector<quint16> &values,
+                                                       const ModbusRtuCallback &callback)
+{
+    return submitRequest(slave, 0x10, buildRegistersData(startAddress, values), callback);
+}
+
+/***************************************************************
+ * 取消排队中的请求
+ ***************************************************************/
+bool ProtocolModbusRTU::cancelRequest(quint32 id)
+{
+    for (int i = 0; i < m_queue.size(); i++) {
+        if (m_queue.at(i).id == id) {
+            const PendingRequest request = m_queue.takeAt(i);
+            failRequest(request, ModbusRtuStatus::Cancelled);
+            return true;
+        }
+    }
+    return false;
+}
+
+/***************************************************************
+ * 取消所有排队中的请求
+ ***************************************************************/
+void ProtocolModbusRTU::cancelAll()
+{
+    // 先整体取出，回调中新提交的请求不受影响
+    QQueue<PendingRequest> cancelled;
+    cancelled.swap(m_queue);
+
+    while (!cancelled.isEmpty()) {
+        failRequest(cancelled.dequeue(), ModbusRtuStatus::Cancelled);
     }
-    
-    QByteArray response = sendRequest(buildRequest(0x10, data));
-    
-    return !response.isEmpty();
 }
 
 /***************************************************************
  * 串口数据接收槽函数
+ *   每收到一批字节就推算响应应有的长度，最后一个字节到达时立即
+ *   完成；未收完时重新开始T3.5字符间隔定时
  ***************************************************************/
 void ProtocolModbusRTU::onSerialDataReceived()
 {
+    // 没有请求时收到的数据（迟到的响应、干扰）直接丢弃，不能留到下一个请求
     if (!m_waitingForResponse) {
+        m_serialPort->readAll();
+        m_quietUntilUs = qMax(m_quietUntilUs, m_busClock.nsecsElapsed() / 1000 + m_t35Us);
         return;
     }
-    
-    // 读取所有可用数据
+
     m_receiveBuffer.append(m_serialPort->readAll());
+    if (m_receiveBuffer.isEmpty()) {
+        return;
+    }
+
+    if (m_expectedLength <= 0) {
+        m_expectedLength = expectedResponseLength(m_active.functionCode, m_receiveBuffer);
+    }
+    updateReceiveCrc();
+
+    if (m_expectedLength > 0 && m_receiveBuffer.size() >= m_expectedLength) {
+        completeFrame();
+        return;
+    }
+
+    m_charTimer->start();
 }
 
 /***************************************************************
@@ -426,168 +518,497 @@ void ProtocolModbusRTU::onSerialDataReceived()
  ***************************************************************/
 void ProtocolModbusRTU::onResponseTimeout()
 {
-    if (m_waitingForResponse) {
-        setError("Response timeout");
-        m_waitingForResponse = false;
+    if (!m_waitingForResponse) {
+        return;
     }
+
+    // 收到过数据但始终没有组成有效帧时按CRC错误上报
+    finishActive(m_receiveBuffer.isEmpty() ? ModbusRtuStatus::Timeout : ModbusRtuStatus::CrcError);
 }
 
 /***************************************************************
- * 发送Modbus请求并等待响应
+ * 字符间隔超时槽函数: 帧未收完但总线已静默T3.5
  ***************************************************************/
-QByteArray ProtocolModbusRTU::sendRequest(const QByteArray &request)
+void ProtocolModbusRTU::onCharTimeout()
 {
-    if (!isConnected()) {
-        return QByteArray();
+    if (!m_waitingForResponse) {
+        return;
     }
-    
-    // 清空接收缓冲区
-    m_receiveBuffer.clear();
-    m_waitingForResponse = true;
-    
-    // 发送请求
-    m_serialPort->write(request);
-    m_serialPort->flush();
-    
-    // 启动超时定时器
-    m_responseTimer->start(m_timeout);
-    
-    // 等待响应（使用事件循环）
-    QEventLoop loop;
-    QTimer::singleShot(m_timeout + 100, &loop, &QEventLoop::quit);
-    
-    while (m_waitingForResponse && m_responseTimer->isActive()) {
-        QCoreApplication::processEvents();
-        QThread::msleep(10);
-        
-        // 检查是否收到完整响应
-        if (m_receiveBuffer.size() >= 5) {  // 最小响应长度
-            if (validateResponse(m_receiveBuffer)) {
-                m_waitingForResponse = false;
-                m_responseTimer->stop();
-                break;
+
+    // 事件循环繁忙时定时器可能先于readyRead处理，先把内核中已到的数据读出
+    const int before = m_receiveBuffer.size();
+    if (!m_serialPort->waitForReadyRead(0) && m_serialPort->error() == QSerialPort::TimeoutError) {
+        m_serialPort->clearError();
+    }
+    if (!m_waitingForResponse || m_receiveBuffer.size() != before) {
+        return;
+    }
+
+    // 未知功能码无法推算长度，静默即帧结束，按CRC判断
+    if (m_expectedLength < 0) {
+        completeFrame();
+        return;
+    }
+
+    qWarning() << "Modbus RTU truncated frame:" << m_receiveBuffer.size() << "of"
+               << m_expectedLength << "bytes, slave" << m_active.slave;
+    finishActive(ModbusRtuStatus::FrameError);
+}
+
+/***************************************************************
+ * 帧间隔定时器: 总线已静默足够时间，发送下一个请求
+ ***************************************************************/
+void ProtocolModbusRTU::onGapTimeout()
+{
+    startNext();
+}
+
+/***************************************************************
+ * 以默认从站执行请求并等待完成
+ ***************************************************************/
+ModbusRtuResult ProtocolModbusRTU::execute(quint8 functionCode, const QByteArray &data)
+{
+    ModbusRtuResult result;
+    const quint32 id = submitRequest(m_slaveAddress, functionCode, data,
+                                     [&result](const ModbusRtuResult &r) { result = r; });
+    if (id == 0) {
+        return result;      // 失败结果已由回调写入
+    }
+
+    return waitForRequest(id);
+}
+
+/***************************************************************
+ * 在本线程上等待请求完成
+ *   串口的读写和各定时器都在这里直接驱动，不进入事件循环；
+ *   排在前面的异步请求也会在等待期间完成并回调
+ ***************************************************************/
+ModbusRtuResult ProtocolModbusRTU::waitForRequest(quint32 id)
+{
+    ModbusRtuResult result;
+    result.id = id;
+    result.status = ModbusRtuStatus::Cancelled;
+    m_syncWaiters.insert(id, &result);
+
+    QTimer *timers[3] = { m_charTimer, m_responseTimer, m_gapTimer };
+
+    while (m_syncWaiters.contains(id)) {
+        // 最近一个到期的定时器
+        QTimer *next = nullptr;
+        int remaining = -1;
+        for (QTimer *timer : timers) {
+            const int left = timer->isActive() ? timer->remainingTime() : -1;
+            if (left >= 0 && (remaining < 0 || left < remaining)) {
+                remaining = left;
+                next = timer;
+            }
+        }
+
+        if (!next) {
+            // 没有进行中的请求也没有等待发送的请求（被取消或断开）
+            m_syncWaiters.remove(id);
+            break;
+        }
+
+        if (remaining == 0) {
+            next->stop();
+            if (next == m_charTimer) {
+                onCharTimeout();
+            } else if (next == m_responseTimer) {
+                onResponseTimeout();
+            } else {
+                onGapTimeout();
+            }
+            continue;
+        }
+
+        // readyRead在waitForReadyRead内部同步发出，onSerialDataReceived随之执行
+        if (!m_serialPort->waitForReadyRead(remaining) &&
+            m_serialPort->error() != QSerialPort::TimeoutError &&
+            m_serialPort->error() != QSerialPort::NoError) {
+            setError(QString("Serial error: %1").arg(m_serialPort->errorString()));
+            m_serialPort->clearError();
+            if (m_waitingForResponse) {
+                finishActive(ModbusRtuStatus::SerialError);
+            } else {
+                cancelAll();
             }
         }
     }
-    
-    m_waitingForResponse = false;
+
+    if (!result.isSuccess()) {
+        setError(QString("Modbus request failed: %1").arg(ModbusRtuResult::statusToString(result.status)));
+    }
+
+    return result;
+}
+
+/***************************************************************
+ * 串口空闲时发送队首请求
+ *   两帧之间至少保持T3.5静默（广播后为广播转换延时）
+ ***************************************************************/
+void ProtocolModbusRTU::startNext()
+{
+    while (!m_waitingForResponse && !m_queue.isEmpty()) {
+        const qint64 nowUs = m_busClock.nsecsElapsed() / 1000;
+        if (nowUs < m_quietUntilUs) {
+            if (!m_gapTimer->isActive()) {
+                m_gapTimer->start(static_cast<int>((m_quietUntilUs - nowUs + 999) / 1000));
+            }
+            return;
+        }
+
+        m_active = m_queue.dequeue();
+        m_receiveBuffer.clear();
+        m_expectedLength = 0;
+        m_rxCrc.reset();
+        m_rxCrcBytes = 0;
+        m_serialPort->readAll();            // 丢弃发送前残留的数据
+
+        m_waitingForResponse = true;
+        m_activeTimer.start();
+
+        if (m_serialPort->write(m_active.frame) != m_active.frame.size()) {
+            setError(QString("Serial write failed: %1").arg(m_serialPort->errorString()));
+            finishActive(ModbusRtuStatus::SerialError);
+            continue;
+        }
+        m_serialPort->flush();
+
+        // 请求帧在线上的时间，超时和帧间隔都从发送完成算起
+        const qint64 wireUs = static_cast<qint64>(m_active.frame.size()) * m_charUs;
+
+        // 广播没有响应，发出即完成，等待转换延时后才能发下一帧
+        if (m_active.slave == 0) {
+            m_quietUntilUs = nowUs + wireUs + static_cast<qint64>(m_broadcastDelay) * 1000;
+            finishActive(ModbusRtuStatus::Success);
+            continue;
+        }
+
+        m_responseTimer->start(m_active.timeout + static_cast<int>((wireUs + 999) / 1000));
+    }
+}
+
+/***************************************************************
+ * 按已收到的字节推算响应帧长度
+ * @return >0 帧长度, 0 需要更多字节, -1 无法推算（未知功能码或功能码不符）
+ ***************************************************************/
+int ProtocolModbusRTU::expectedResponseLength(quint8 functionCode, const QByteArray &buffer)
+{
+    if (buffer.size() < 2) {
+        return 0;
+    }
+
+    const quint8 responseCode = static_cast<quint8>(buffer[1]);
+    if (responseCode == (functionCode | 0x80)) {
+        return 5;                           // [地址][功能码|0x80][异常码][CRC]
+    }
+    if (responseCode != functionCode) {
+        return -1;
+    }
+
+    switch (functionCode) {
+        case 0x01:
+        case 0x02:
+        case 0x03:
+        case 0x04:
+        case 0x0C:
+        case 0x11:
+        case 0x17:
+            // [地址][功能码][字节数][数据...][CRC]
+            return (buffer.size() >= 3) ? 5 + static_cast<quint8>(buffer[2]) : 0;
+        case 0x05:
+        case 0x06:
+        case 0x08:
+        case 0x0B:
+        case 0x0F:
+        case 0x10:
+            return 8;
+        case 0x07:
+            return 5;
+        case 0x16:
+            return 10;
+        default:
+            return -1;
+    }
+}
+
+/***************************************************************
+ * 完成当前响应帧: 检查地址和CRC
+ ***************************************************************/
+void ProtocolModbusRTU::completeFrame()
+{
+    if (m_expectedLength > 0 && m_receiveBuffer.size() > m_expectedLength) {
+        m_receiveBuffer.truncate(m_expectedLength);     // 帧后多余的字节不属于本次响应
+    }
+
+    const QByteArray &response = m_receiveBuffer;
+    if (response.size() < 4 || static_cast<quint8>(response[0]) != m_active.slave ||
+        (static_cast<quint8>(response[1]) & 0x7F) != m_active.functionCode) {
+        finishActive(ModbusRtuStatus::FrameError);
+        return;
+    }
+
+    // 帧体的CRC在接收过程中已基本算完，这里只补上最后一批
+    updateReceiveCrc();
+    const quint16 receivedCRC = (static_cast<quint8>(response[response.size() - 2])) |
+                                (static_cast<quint8>(response[response.size() - 1]) << 8);
+    if (m_rxCrcBytes != response.size() - 2 || receivedCRC != m_rxCrc.value()) {
+        finishActive(ModbusRtuStatus::CrcError);
+        return;
+    }
+
+    const quint8 functionCode = static_cast<quint8>(response[1]);
+    finishActive((functionCode & 0x80) ? ModbusRtuStatus::Exception : ModbusRtuStatus::Success);
+}
+
+/***************************************************************
+ * 增量计算接收CRC
+ *   帧长已知时计到帧长-2；未知时最后2字节可能是CRC，先不计入。
+ *   已计入的字节数不会超过最终帧体长度，完成时只需补算剩余部分
+ ***************************************************************/
+void ProtocolModbusRTU::updateReceiveCrc()
+{
+    int limit = m_receiveBuffer.size();
+    if (m_expectedLength > 0) {
+        limit = qMin(limit, m_expectedLength);
+    }
+    limit -= 2;
+
+    if (limit > m_rxCrcBytes) {
+        m_rxCrc.update(m_receiveBuffer.constData() + m_rxCrcBytes, limit - m_rxCrcBytes);
+        m_rxCrcBytes = limit;
+    }
+}
+
+/***************************************************************
+ * 按波特率和字符格式计算T1.5/T3.5
+ *   波特率大于19200时按规范固定为750us/1750us
+ ***************************************************************/
+void ProtocolModbusRTU::updateTiming()
+{
+    const int bits = 1 + static_cast<int>(m_dataBits) +
+                     ((m_parity == QSerialPort::NoParity) ? 0 : 1) +
+                     ((m_stopBits == QSerialPort::TwoStop) ? 2 : 1);
+    m_charUs = qMax(1, static_cast<int>(bits * 1000000LL / qMax(1, m_baudrate)));
+
+    if (m_baudrate > 19200) {
+        m_t15Us = 750;
+        m_t35Us = 1750;
+    } else {
+        m_t15Us = m_charUs * 3 / 2;
+        m_t35Us = m_charUs * 7 / 2;
+    }
+
+    // QTimer精度为毫秒，向上取整
+    m_charTimer->setInterval((m_t35Us + 999) / 1000);
+}
+
+/***************************************************************
+ * 结束当前请求
+ ***************************************************************/
+void ProtocolModbusRTU::finishActive(ModbusRtuStatus status)
+{
     m_responseTimer->stop();
-    
-    return m_receiveBuffer;
+    m_charTimer->stop();
+
+    ModbusRtuResult result;
+    result.id = m_active.id;
+    result.status = status;
+    result.slave = m_active.slave;
+    result.functionCode = m_active.functionCode;
+    result.request = m_active.frame;
+    result.elapsedUs = m_activeTimer.nsecsElapsed() / 1000;
+    if (status == ModbusRtuStatus::Success || status == ModbusRtuStatus::Exception ||
+        status == ModbusRtuStatus::CrcError || status == ModbusRtuStatus::FrameError) {
+        result.response = m_receiveBuffer;
+    }
+    if (status == ModbusRtuStatus::Exception) {
+        result.exceptionCode = static_cast<quint8>(m_receiveBuffer[2]);
+        emit modbusException(result.exceptionCode);
+    }
+
+    const ModbusRtuCallback callback = m_active.callback;
+    m_active = PendingRequest();
+    m_receiveBuffer.clear();
+    m_expectedLength = 0;
+    m_rxCrc.reset();
+    m_rxCrcBytes = 0;
+    m_waitingForResponse = false;
+    m_quietUntilUs = qMax(m_quietUntilUs, m_busClock.nsecsElapsed() / 1000 + m_t35Us);
+
+    // 先安排下一个请求再回调，回调耗时不占用总线空闲时间
+    startNext();
+    deliver(result, callback);
+}
+
+/***************************************************************
+ * 以失败结果完成一个未发送的请求
+ ***************************************************************/
+void ProtocolModbusRTU::failRequest(const PendingRequest &request, ModbusRtuStatus status)
+{
+    ModbusRtuResult result;
+    result.id = request.id;
+    result.status = status;
+    result.slave = request.slave;
+    result.functionCode = request.functionCode;
+    result.request = request.frame;
+    deliver(result, request.callback);
+}
+
+/***************************************************************
+ * 发布结果
+ ***************************************************************/
+void ProtocolModbusRTU::deliver(const ModbusRtuResult &result, const ModbusRtuCallback &callback)
+{
+    ModbusRtuResult *waiter = m_syncWaiters.take(result.id);
+    if (waiter) {
+        *waiter = result;
+    }
+
+    if (callback) {
+        callback(result);
+    }
+
+    emit requestFinished(result);
 }
 
 /***************************************************************
  * 构建Modbus请求帧
  ***************************************************************/
-QByteArray ProtocolModbusRTU::buildRequest(quint8 functionCode, const QByteArray &data)
+QByteArray ProtocolModbusRTU::buildRequest(quint8 slave, quint8 functionCode, const QByteArray &data)
 {
     QByteArray request;
-    request.append(m_slaveAddress);
+    request.reserve(data.size() + 4);
+    request.append(slave);
     request.append(functionCode);
     request.append(data);
-    
-    // 计算并添加CRC16
-    quint16 crc = calculateCRC16(request);
-    request.append(crc & 0xFF);         // CRC低字节
-    request.append((crc >> 8) & 0xFF);  // CRC高字节
-    
+
+    // 添加CRC16（低字节在前）
+    SerialCrc16::modbusAppend(request);
+
     return request;
 }
 
 /***************************************************************
- * 验证响应帧
+ * 构建[地址][数量]数据（0x05/0x06为[地址][值]）
  ***************************************************************/
-bool ProtocolModbusRTU::validateResponse(const QByteArray &response)
+QByteArray ProtocolModbusRTU::buildAddressData(quint16 startAddress, quint16 count)
 {
-    if (response.size() < 5) {
-        return false;
-    }
-    
-    // 检查从站地址
-    if (static_cast<quint8>(response[0]) != m_slaveAddress) {
-        return false;
-    }
-    
-    // 检查CRC
-    QByteArray dataWithoutCRC = response.left(response.size() - 2);
-    quint16 receivedCRC = (static_cast<quint8>(response[response.size() - 2])) |
-                          (static_cast<quint8>(response[response.size() - 1]) << 8);
-    quint16 calculatedCRC = calculateCRC16(dataWithoutCRC);
-    
-    if (receivedCRC != calculatedCRC) {
-        setError("CRC check failed");
-        return false;
-    }
-    
-    // 检查异常响应
-    quint8 functionCode = static_cast<quint8>(response[1]);
-    if (functionCode & 0x80) {
-        quint8 exceptionCode = static_cast<quint8>(response[2]);
-        emit modbusException(exceptionCode);
-        setError(QString("Modbus exception: 0x%1").arg(exceptionCode, 2, 16, QChar('0')));
-        return false;
-    }
-    
-    return true;
+    QByteArray data;
+    data.append((startAddress >> 8) & 0xFF);
+    data.append(startAddress & 0xFF);
+    data.append((count >> 8) & 0xFF);
+    data.append(count & 0xFF);
+    return data;
 }
 
 /***************************************************************
- * 计算CRC16校验码
+ * 构建写多个线圈数据
  ***************************************************************/
-quint16 ProtocolModbusRTU::calculateCRC16(const QByteArray &data)
+QByteArray ProtocolModbusRTU::buildCoilsData(quint16 startAddress, const QVector<bool> &values)
 {
-    quint16 crc = 0xFFFF;
-    
-    for (int i = 0; i < data.size(); i++) {
-        crc ^= static_cast<quint8>(data[i]);
-        
-        for (int j = 0; j < 8; j++) {
-            if (crc & 0x0001) {
-                crc = (crc >> 1) ^ 0xA001;
-            } else {
-                crc >>= 1;
+    quint16 count = values.size();
+    quint8 byteCount = (count + 7) / 8;
+
+    QByteArray data = buildAddressData(startAddress, count);
+    data.append(byteCount);
+
+    // 转换布尔值到字节
+    for (int i = 0; i < byteCount; i++) {
+        quint8 byte = 0;
+        for (int j = 0; j < 8 && (i * 8 + j) < count; j++) {
+            if (values[i * 8 + j]) {
+                byte |= (1 << j);
             }
         }
+        data.append(byte);
     }
-    
-    return crc;
+
+    return data;
+}
+
+/***************************************************************
+ * 构建写多个寄存器数据
+ ***************************************************************/
+QByteArray ProtocolModbusRTU::buildRegistersData(quint16 startAddress, const QVector<quint16> &values)
+{
+    quint16 count = values.size();
+
+    QByteArray data = buildAddressData(startAddress, count);
+    data.append(static_cast<char>(count * 2));
+
+    // 添加寄存器值
+    for (quint16 value : values) {
+        data.append((value >> 8) & 0xFF);
+        data.append(value & 0xFF);
+    }
+
+    return data;
+}
+
+/***************************************************************
+ * 解析寄存器值列表
+ ***************************************************************/
+QVector<quint16> ModbusRtuResult::registers() const
+{
+    QVector<quint16> result;
+    if (response.size() < 5) {
+        return result;
+    }
+
+    // [从站地址][功能码][字节数][数据...][CRC]
+    const int byteCount = qMin(static_cast<int>(static_cast<quint8>(response[2])), response.size() - 5);
+    result.reserve(byteCount / 2);
+    for (int i = 3; i + 1 < 3 + byteCount; i += 2) {
+        quint16 value = (static_cast<quint8>(response[i]) << 8) |
+                        static_cast<quint8>(response[i + 1]);
+        result.append(value);
+    }
+
+    return result;
 }
 
 /***************************************************************
  * 解析布尔值列表
  ***************************************************************/
-QVector<bool> ProtocolModbusRTU::parseBooleans(const QByteArray &data, quint16 count)
+QVector<bool> ModbusRtuResult::bits(quint16 count) const
 {
     QVector<bool> result;
-    
+    if (response.size() < 5) {
+        return result;
+    }
+
+    const int byteCount = qMin(static_cast<int>(static_cast<quint8>(response[2])), response.size() - 5);
+    result.reserve(count);
     for (int i = 0; i < count; i++) {
         int byteIndex = i / 8;
         int bitIndex = i % 8;
-        
-        if (byteIndex < data.size()) {
-            quint8 byte = static_cast<quint8>(data[byteIndex]);
+
+        if (byteIndex < byteCount) {
+            quint8 byte = static_cast<quint8>(response[3 + byteIndex]);
             result.append((byte & (1 << bitIndex)) != 0);
         }
     }
-    
+
     return result;
 }
 
 /***************************************************************
- * 解析寄存器值列表
+ * 结果名称
  ***************************************************************/
-QVector<quint16> ProtocolModbusRTU::parseRegisters(const QByteArray &data)
+QString ModbusRtuResult::statusToString(ModbusRtuStatus status)
 {
-    QVector<quint16> result;
-    
-    for (int i = 0; i < data.size(); i += 2) {
-        if (i + 1 < data.size()) {
-            quint16 value = (static_cast<quint8>(data[i]) << 8) | 
-                           static_cast<quint8>(data[i + 1]);
-            result.append(value);
-        }
-    }
-    
-    return result;
+    switch (status) {
+        case ModbusRtuStatus::Success:      return "Success";
+        case ModbusRtuStatus::Exception:    return "Exception";
+        case ModbusRtuStatus::Timeout:      return "Timeout";
+        case ModbusRtuStatus::CrcError:     return "CRC error";
+        case ModbusRtuStatus::FrameError:   return "Frame error";
+        case ModbusRtuStatus::NotConnected: return "Not connected";
+        case ModbusRtuStatus::QueueFull:    return "Queue full";
+        case ModbusRtuStatus::Cancelled:    return "Cancelled";
+        case ModbusRtuStatus::SerialError:  return "Serial error";
+    }
+    return "Unknown";
 }
-
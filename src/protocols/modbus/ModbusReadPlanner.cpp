@@ -0,0 +1,168 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: ModbusReadPlanner.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: Modbus块读取规划实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 规划时可不填充空隙（只合并紧邻或重叠的地址）
+ ***************************************************************/
+
+#include "protocols/modbus/ModbusReadPlanner.h"
+#include <algorithm>
+
+/***************************************************************
+ * 构造函数
+ ***************************************************************/
+ModbusReadPlanner::ModbusReadPlanner()
+    : m_gapRegisters(10)
+    , m_gapBits(160)
+    , m_maxRegisters(MaxReadRegisters)
+    , m_maxBits(MaxReadBits)
+{
+}
+
+/***************************************************************
+ * 参数
+ ***************************************************************/
+void ModbusReadPlanner::setMaxGap(int registers, int bits)
+{
+    m_gapRegisters = qBound(0, registers, static_cast<int>(MaxReadRegisters));
+    m_gapBits = qBound(0, bits, static_cast<int>(MaxReadBits));
+}
+
+void ModbusReadPlanner::setMaxBlock(int registers, int bits)
+{
+    m_maxRegisters = qBound(1, registers, static_cast<int>(MaxReadRegisters));
+    m_maxBits = qBound(1, bits, static_cast<int>(MaxReadBits));
+}
+
+int ModbusReadPlanner::getMaxGap(ModbusPointType type) const
+{
+    return isBitType(type) ? m_gapBits : m_gapRegisters;
+}
+
+int ModbusReadPlanner::getMaxBlock(ModbusPointType type) const
+{
+    return isBitType(type) ? m_maxBits : m_maxRegisters;
+}
+
+/***************************************************************
+ * 清空（Qt5的QVector::resize(0)保留容量，clear()会释放）
+ ***************************************************************/
+void ModbusReadPlanner::clear()
+{
+    m_requests.resize(0);
+    m_blocks.resize(0);
+    m_slices.resize(0);
+}
+
+void ModbusReadPlanner::add(quint8 slave, ModbusPointType type, quint16 address, quint16 count, int tag)
+{
+    if (count == 0) {
+        return;
+    }
+
+    Request request;
+    request.slave = slave;
+    request.type = type;
+    request.address = address;
+    request.count = count;
+    request.tag = tag;
+    m_requests.append(request);
+}
+
+/***************************************************************
+ * 计算块读取
+ *   按(从站, 功能码, 地址)排序后从左到右扫描: 下一段的起点距当前块
+ *   末尾不超过空隙阈值、并入后总长不超过上限就扩展当前块。每一块都
+ *   尽可能向右扩展，所以块数最少（在空隙阈值约束下）
+ ***************************************************************/
+int ModbusReadPlanner::plan(bool fillGaps)
+{
+    m_blocks.resize(0);
+    m_slices.resize(0);
+
+    std::sort(m_requests.begin(), m_requests.end(), [](const Request &a, const Request &b) {
+        if (a.slave != b.slave) {
+            return a.slave < b.slave;
+        }
+        if (a.type != b.type) {
+            return a.type < b.type;
+        }
+        return a.address < b.address;
+    });
+
+    int blockEnd = 0;                       // 当前块末尾（不含），用int避免0xFFFF+1溢出
+    for (int i = 0; i < m_requests.size(); ++i) {
+        const Request &request = m_requests[i];
+        const int start = request.address;
+        const int end = start + request.count;
+
+        bool extend = false;
+        if (!m_blocks.isEmpty()) {
+            const Block &block = m_blocks.last();
+            extend = block.slave == request.slave && block.type == request.type &&
+                     start <= blockEnd + (fillGaps ? getMaxGap(request.type) : 0) &&
+                     qMax(end, blockEnd) - block.address <= getMaxBlock(request.type);
+        }
+
+        if (extend) {
+            Block &block = m_blocks.last();
+            blockEnd = qMax(end, blockEnd);
+            block.count = static_cast<quint16>(blockEnd - block.address);
+            block.sliceCount++;
+        } else {
+            Block block;
+            block.slave = request.slave;
+            block.type = request.type;
+            block.address = request.address;
+            block.count = request.count;
+            block.firstSlice = m_slices.size();
+            block.sliceCount = 1;
+            m_blocks.append(block);
+            blockEnd = end;
+        }
+
+        Slice slice;
+        slice.tag = request.tag;
+        slice.offset = static_cast<quint16>(start - m_blocks.last().address);
+        slice.count = request.count;
+        m_slices.append(slice);
+    }
+
+    return m_blocks.size();
+}
+
+/***************************************************************
+ * 查找包含某个标签的块
+ ***************************************************************/
+int ModbusReadPlanner::findBlock(int tag) const
+{
+    for (int b = 0; b < m_blocks.size(); ++b) {
+        const Block &block = m_blocks[b];
+        for (int s = block.firstSlice; s < block.firstSlice + block.sliceCount; ++s) {
+            if (m_slices[s].tag == tag) {
+                return b;
+            }
+        }
+    }
+    return -1;
+}
+
+/***************************************************************
+ * 检查响应并返回数据部分
+ ***************************************************************/
+const uchar *ModbusReadPlanner::payload(const Block &block, const QByteArray &response)
+{
+    const int bytes = isBitType(block.type) ? (block.count + 7) / 8 : block.count * 2;
+
+    // [地址][功能码][字节数][数据...][CRC]
+    if (response.size() != 5 + bytes || static_cast<quint8>(response[2]) != bytes) {
+        return nullptr;
+    }
+    return reinterpret_cast<const uchar *>(response.constData()) + 3;
+}
@@ -0,0 +1,768 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: ModbusRtuSniffer.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: Modbus RTU总线只听监视器实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ *   2. 2026-10-18 CRC校验改用SerialCrc16
+ ***************************************************************/
+
+#include "protocols/modbus/ModbusRtuSniffer.h"
+#include "drivers/serial/DriverSerial.h"
+#include "drivers/serial/SerialCrc16.h"
+#include "drivers/serial/SerialIoThread.h"
+#include <QTextStream>
+#include <QDebug>
+
+#include <string.h>
+
+namespace {
+
+const int IDLE_CHECK_MS = 20;           // 空闲检查周期
+const int MIN_FRAME = 4;                // 最短帧: 地址 + 功能码 + CRC
+
+bool crcValid(const uchar *frame, int length)
+{
+    return length >= MIN_FRAME && SerialCrc16::modbusCheck(reinterpret_cast<const char *>(frame), length);
+}
+
+quint16 word(const uchar *p)
+{
+    return static_cast<quint16>((p[0] << 8) | p[1]);
+}
+
+void unpackBits(const uchar *data, int bytes, int count, QVector<quint16> &values)
+{
+    count = qMin(count, bytes * 8);
+    values.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        values.append((data[i / 8] >> (i % 8)) & 0x01);
+    }
+}
+
+void unpackRegisters(const uchar *data, int bytes, QVector<quint16> &values)
+{
+    values.reserve(bytes / 2);
+    for (int i = 0; i + 1 < bytes; i += 2) {
+        values.append(word(data + i));
+    }
+}
+
+} // namespace
+
+/***************************************************************
+ * 构造函数
+ ***************************************************************/
+ModbusRtuSniffer::ModbusRtuSniffer(QObject *parent)
+    : QObject(parent)
+    , m_charUs(0)
+    , m_gapUs(0)
+    , m_gapOverrideUs(0)
+    , m_timeoutUs(1000000)
+    , m_head(0)
+    , m_tail(0)
+    , m_lastByteUs(0)
+    , m_pendingActive(false)
+    , m_queueHead(0)
+    , m_queueCount(0)
+    , m_notifyPending(0)
+{
+    qRegisterMetaType<ModbusSnifferTransaction>("ModbusSnifferTransaction");
+
+    m_pending.length = 0;
+    m_queue.resize(1024);
+    setBaudRate(9600);
+
+    m_idleTimer = new QTimer(this);
+    m_idleTimer->setInterval(IDLE_CHECK_MS);
+    connect(m_idleTimer, &QTimer::timeout, this, &ModbusRtuSniffer::onIdleCheck);
+}
+
+/***************************************************************
+ * 析构函数
+ ***************************************************************/
+ModbusRtuSniffer::~ModbusRtuSniffer()
+{
+    detach();
+}
+
+/***************************************************************
+ * 设置波特率: RTU每字符11位，波特率>19200时T3.5固定为1750us
+ ***************************************************************/
+void ModbusRtuSniffer::setBaudRate(qint32 baudRate)
+{
+    if (baudRate <= 0) {
+        qWarning() << "[ModbusRtuSniffer] 无效波特率:" << baudRate;
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_charUs = qMax(1, static_cast<int>(11000000LL / baudRate));
+    updateTiming();
+}
+
+void ModbusRtuSniffer::setFrameGapUs(int us)
+{
+    QMutexLocker locker(&m_mutex);
+    m_gapOverrideUs = qMax(0, us);
+    updateTiming();
+}
+
+void ModbusRtuSniffer::setResponseTimeout(int msecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_timeoutUs = static_cast<qint64>(qMax(1, msecs)) * 1000;
+}
+
+void ModbusRtuSniffer::setQueueSize(int count)
+{
+    if (m_serial) {
+        qWarning() << "[ModbusRtuSniffer] 已挂接，不能修改队列容量";
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_queue.resize(qBound(16, count, 65536));
+    m_queue.squeeze();
+    m_queueHead = 0;
+    m_queueCount = 0;
+}
+
+/***************************************************************
+ * 挂接到串口
+ ***************************************************************/
+bool ModbusRtuSniffer::attach(DriverSerial *serial)
+{
+    if (!serial) {
+        return false;
+    }
+
+    if (m_serial) {
+        qWarning() << "[ModbusRtuSniffer] 已挂接串口:" << m_serial->getPortName();
+        return false;
+    }
+
+    if (serial->isOpen()) {
+        qWarning() << "[ModbusRtuSniffer] 串口已打开，需在open()前挂接:" << serial->getPortName();
+        return false;
+    }
+
+    // 每次read()都要回调并带上准确时间戳，只有I/O线程后端能保证
+    if (!serial->isIoThreadEnabled() && !serial->setIoThreadEnabled(true)) {
+        return false;
+    }
+
+    m_serial = serial;
+    serial->setDataListener(this);
+
+    // 读缓冲区没有其他消费者，收到即清空，避免溢出告警
+    connect(serial, &DriverSerial::dataReceived, this, [this]() {
+        if (m_serial) {
+            m_serial->clearReadBuffer();
+        }
+    });
+
+    m_idleTimer->start();
+
+    qInfo() << "[ModbusRtuSniffer] 挂接串口:" << serial->getPortName()
+            << "帧间隔:" << m_gapUs << "us";
+    return true;
+}
+
+/***************************************************************
+ * 从串口摘下
+ ***************************************************************/
+void ModbusRtuSniffer::detach()
+{
+    m_idleTimer->stop();
+
+    if (!m_serial) {
+        return;
+    }
+
+    m_serial->setDataListener(nullptr);
+    disconnect(m_serial, nullptr, this, nullptr);
+    m_serial.clear();
+
+    QMutexLocker locker(&m_mutex);
+    m_head = 0;
+    m_tail = 0;
+    m_pendingActive = false;
+}
+
+/***************************************************************
+ * 接收回调（I/O线程）
+ ***************************************************************/
+void ModbusRtuSniffer::serialDataReceived(const char *data, int length, qint64 timestampUs)
+{
+    bool notify = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stats.bytes += static_cast<quint64>(length);
+
+        // 一次read()可能远大于一帧，分块放入分帧缓冲区
+        const uchar *p = reinterpret_cast<const uchar *>(data);
+        int offset = 0;
+        while (offset < length) {
+            const int chunk = qMin(length - offset, static_cast<int>(MaxFrame));
+            const qint64 chunkEndUs = timestampUs - static_cast<qint64>(length - offset - chunk) * m_charUs;
+            appendBytes(p + offset, chunk, chunkEndUs);
+            offset += chunk;
+        }
+
+        notify = m_queueCount > 0 && m_notifyPending.testAndSetOrdered(0, 1);
+    }
+
+    if (notify) {
+        emit transactionsAvailable();
+    }
+}
+
+/***************************************************************
+ * 追加一块数据: 先按静默判断帧边界，再尝试按长度拆帧
+ ***************************************************************/
+void ModbusRtuSniffer::appendBytes(const uchar *data, int length, qint64 timestampUs)
+{
+    // 该块首字节开始时刻与上一字节结束时刻之差即为静默时间
+    const qint64 startUs = timestampUs - static_cast<qint64>(length) * m_charUs;
+    if (m_tail > m_head && startUs - m_lastByteUs >= m_gapUs) {
+        extractFrames(true);
+    }
+
+    if (m_tail + length > BufferSize) {
+        const int remain = m_tail - m_head;
+        memmove(m_buffer, m_buffer + m_head, remain);
+        memmove(m_times, m_times + m_head, remain * sizeof(qint64));
+        m_head = 0;
+        m_tail = remain;
+    }
+
+    for (int i = 0; i < length; ++i) {
+        // 估算的时刻不早于上一个字节（tty批量交付时上一块可能被推迟）
+        const qint64 t = qMax(timestampUs - static_cast<qint64>(length - 1 - i) * m_charUs, m_lastByteUs);
+        m_buffer[m_tail] = data[i];
+        m_times[m_tail] = t;
+        m_tail++;
+        m_lastByteUs = t;
+    }
+
+    extractFrames(false);
+}
+
+/***************************************************************
+ * 推算帧长度
+ ***************************************************************/
+int ModbusRtuSniffer::expectedLength(const uchar *frame, int available, bool response)
+{
+    const uchar function = frame[1];
+
+    if (response) {
+        if (function & 0x80) {
+            return 5;
+        }
+        switch (function) {
+        case 0x01:
+        case 0x02:
+        case 0x03:
+        case 0x04:
+        case 0x0C:
+            return (available >= 3) ? 5 + frame[2] : 0;
+        case 0x05:
+        case 0x06:
+        case 0x08:
+        case 0x0B:
+        case 0x0F:
+        case 0x10:
+            return 8;
+        case 0x07:
+            return 5;
+        default:
+            return -1;
+        }
+    }
+
+    switch (function) {
+    case 0x01:
+    case 0x02:
+    case 0x03:
+    case 0x04:
+    case 0x05:
+    case 0x06:
+    case 0x08:
+        return 8;
+    case 0x07:
+    case 0x0B:
+    case 0x0C:
+        return 4;
+    case 0x0F:
+    case 0x10:
+        return (available >= 7) ? 9 + frame[6] : 0;
+    default:
+        return -1;
+    }
+}
+
+/***************************************************************
+ * 从分帧缓冲区提取帧
+ *   segmentEnd=false: 只提取长度和CRC都能确认的帧，其余等待
+ *   segmentEnd=true : 静默已超过T3.5，剩余数据作为一帧处理
+ ***************************************************************/
+void ModbusRtuSniffer::extractFrames(bool segmentEnd)
+{
+    while (m_tail - m_head >= MIN_FRAME) {
+        const uchar *p = m_buffer + m_head;
+        const int available = m_tail - m_head;
+
+        // 与等待中的请求同一从站同一功能码时优先按响应解析
+        const bool expectResponse = m_pendingActive && p[0] == m_pending.data[0] &&
+                                    (p[1] & 0x7F) == m_pending.data[1];
+        const bool order[2] = { expectResponse, !expectResponse };
+
+        int matched = 0;
+        bool matchedResponse = false;
+        for (int i = 0; i < 2 && matched == 0; ++i) {
+            const int length = expectedLength(p, available, order[i]);
+            if (length < 0 || length > MaxFrame) {
+                continue;
+            }
+            if (length == 0 || length > available) {
+                continue;       // 该解释下帧还没收完
+            }
+            if (crcValid(p, length)) {
+                matched = length;
+                matchedResponse = order[i];
+            }
+        }
+
+        if (matched > 0) {
+            handleFrame(m_head, matched, matchedResponse);
+            m_head += matched;
+            continue;
+        }
+
+        if (segmentEnd) {
+            // 未知功能码或长度推算不符，整段作为一帧
+            if (available <= MaxFrame && crcValid(p, available)) {
+                handleFrame(m_head, available, expectResponse);
+            } else {
+                m_stats.crcErrors++;
+                m_stats.noiseBytes += static_cast<quint64>(available);
+            }
+            m_head = m_tail;
+            break;
+        }
+
+        if (available > MaxFrame) {
+            // 超过最大帧长仍无法对齐，逐字节丢弃直到重新同步
+            m_stats.noiseBytes++;
+            m_head++;
+            continue;
+        }
+
+        break;      // 等待更多数据或静默
+    }
+
+    if (segmentEnd && m_head < m_tail) {
+        m_stats.crcErrors++;
+        m_stats.noiseBytes += static_cast<quint64>(m_tail - m_head);
+        m_head = m_tail;
+    }
+
+    if (m_head == m_tail) {
+        m_head = 0;
+        m_tail = 0;
+    }
+}
+
+/***************************************************************
+ * 处理一帧: 配对请求和响应
+ ***************************************************************/
+void ModbusRtuSniffer::handleFrame(int offset, int length, bool response)
+{
+    m_stats.frames++;
+
+    const uchar slave = m_buffer[offset];
+    m_slaveStats[slave].lastSeenUs = m_times[offset + length - 1];
+
+    RawFrame frame;
+    fillFrame(frame, offset, length);
+
+    if (response) {
+        if (m_pendingActive) {
+            finishPending((frame.data[1] & 0x80) ? ModbusSnifferStatus::Exception : ModbusSnifferStatus::Ok,
+                          &frame);
+        } else {
+            m_stats.unmatched++;
+            pushTransaction(ModbusSnifferStatus::Unmatched, nullptr, &frame);
+        }
+        return;
+    }
+
+    // 新请求到来时上一个请求仍未响应，视为无响应
+    if (m_pendingActive) {
+        finishPending(ModbusSnifferStatus::NoResponse, nullptr);
+    }
+
+    m_slaveStats[slave].requests++;
+    if (slave == 0) {
+        pushTransaction(ModbusSnifferStatus::Broadcast, &frame, nullptr);
+        return;
+    }
+
+    m_pending = frame;
+    m_pendingActive = true;
+}
+
+/***************************************************************
+ * 结束等待中的请求并更新从站统计
+ ***************************************************************/
+void ModbusRtuSniffer::finishPending(ModbusSnifferStatus status, const RawFrame *response)
+{
+    ModbusSnifferSlaveStats &slave = m_slaveStats[m_pending.data[0]];
+
+    if (response) {
+        const qint64 latency = qMax<qint64>(0, response->firstUs - m_pending.lastUs);
+        if (slave.responses == 0 || latency < slave.latencyMinUs) {
+            slave.latencyMinUs = latency;
+        }
+        if (latency > slave.latencyMaxUs) {
+            slave.latencyMaxUs = latency;
+        }
+        slave.latencySumUs += latency;
+        slave.responses++;
+        if (status == ModbusSnifferStatus::Exception) {
+            slave.exceptions++;
+        }
+    } else {
+        slave.noResponses++;
+    }
+
+    pushTransaction(status, &m_pending, response);
+    m_pendingActive = false;
+}
+
+/***************************************************************
+ * 事务入队（队列满时丢弃新事务）
+ ***************************************************************/
+void ModbusRtuSniffer::pushTransaction(ModbusSnifferStatus status, const RawFrame *request,
+                                       const RawFrame *response)
+{
+    if (m_queueCount >= m_queue.size()) {
+        m_stats.dropped++;
+        return;
+    }
+
+    RawTransaction &slot = m_queue[(m_queueHead + m_queueCount) % m_queue.size()];
+    slot.status = status;
+    slot.request.length = 0;
+    slot.response.length = 0;
+    if (request) {
+        slot.request.firstUs = request->firstUs;
+        slot.request.lastUs = request->lastUs;
+        slot.request.length = request->length;
+        memcpy(slot.request.data, request->data, request->length);
+    }
+    if (response) {
+        slot.response.firstUs = response->firstUs;
+        slot.response.lastUs = response->lastUs;
+        slot.response.length = response->length;
+        memcpy(slot.response.data, response->data, response->length);
+    }
+
+    m_queueCount++;
+    m_stats.transactions++;
+}
+
+void ModbusRtuSniffer::fillFrame(RawFrame &frame, int offset, int length) const
+{
+    frame.firstUs = m_times[offset] - m_charUs;
+    frame.lastUs = m_times[offset + length - 1];
+    frame.length = length;
+    memcpy(frame.data, m_buffer + offset, length);
+}
+
+void ModbusRtuSniffer::updateTiming()
+{
+    if (m_gapOverrideUs > 0) {
+        m_gapUs = m_gapOverrideUs;
+    } else {
+        m_gapUs = (m_charUs * 35 / 10 < 1750) ? 1750 : m_charUs * 35 / 10;
+    }
+}
+
+/***************************************************************
+ * 空闲检查: 总线静默后结束最后一段，超时的请求记为无响应
+ ***************************************************************/
+void ModbusRtuSniffer::onIdleCheck()
+{
+    const qint64 nowUs = SerialIoThread::monotonicUs();
+    bool notify = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_tail > m_head && nowUs - m_lastByteUs >= m_gapUs) {
+            extractFrames(true);
+        }
+        if (m_pendingActive && nowUs - m_pending.lastUs >= m_timeoutUs) {
+            finishPending(ModbusSnifferStatus::NoResponse, nullptr);
+        }
+        notify = m_queueCount > 0 && m_notifyPending.testAndSetOrdered(0, 1);
+    }
+
+    if (notify) {
+        emit transactionsAvailable();
+    }
+}
+
+/***************************************************************
+ * 取出并解码事务
+ ***************************************************************/
+int ModbusRtuSniffer::takeTransactions(QVector<ModbusSnifferTransaction> &out, int maxCount)
+{
+    QVector<RawTransaction> batch;
+    {
+        QMutexLocker locker(&m_mutex);
+        const int count = (maxCount > 0) ? qMin(maxCount, m_queueCount) : m_queueCount;
+        batch.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            batch.append(m_queue.at(m_queueHead));
+            m_queueHead = (m_queueHead + 1) % m_queue.size();
+        }
+        m_queueCount -= count;
+        if (m_queueCount == 0) {
+            m_notifyPending.storeRelease(0);
+        }
+    }
+
+    // 解码在调用线程中进行，不占用I/O线程
+    out.reserve(out.size() + batch.size());
+    for (const RawTransaction &raw : batch) {
+        ModbusSnifferTransaction transaction;
+        decode(raw, transaction);
+        out.append(transaction);
+    }
+
+    // 取了一部分时提醒调用者继续取
+    if (maxCount > 0) {
+        QMutexLocker locker(&m_mutex);
+        if (m_queueCount > 0 && m_notifyPending.testAndSetOrdered(0, 1)) {
+            locker.unlock();
+            emit transactionsAvailable();
+        }
+    }
+
+    return batch.size();
+}
+
+/***************************************************************
+ * 解码一次事务
+ ***************************************************************/
+void ModbusRtuSniffer::decode(const RawTransaction &raw, ModbusSnifferTransaction &out)
+{
+    const RawFrame &req = raw.request;
+    const RawFrame &rsp = raw.response;
+    const RawFrame &any = (req.length > 0) ? req : rsp;
+
+    out.status = raw.status;
+    out.slave = any.data[0];
+    out.function = any.data[1] & 0x7F;
+
+    if (req.length > 0) {
+        out.requestUs = req.firstUs;
+        out.request = QByteArray(reinterpret_cast<const char *>(req.data), req.length);
+    }
+    if (rsp.length > 0) {
+        out.responseUs = rsp.firstUs;
+        out.response = QByteArray(reinterpret_cast<const char *>(rsp.data), rsp.length);
+        if (req.length > 0) {
+            out.latencyUs = qMax<qint64>(0, rsp.firstUs - req.lastUs);
+        }
+    }
+
+    if (raw.status == ModbusSnifferStatus::Exception) {
+        out.exceptionCode = rsp.data[2];
+    }
+
+    // 请求中的地址和数量（01-06、0F、10的请求格式相同）
+    if (req.length >= 8 && (out.function <= 0x06 || out.function == 0x08 ||
+                            out.function == 0x0F || out.function == 0x10)) {
+        out.address = word(req.data + 2);
+        out.quantity = word(req.data + 4);
+    }
+
+    const bool hasData = rsp.length > 0 && raw.status != ModbusSnifferStatus::Exception;
+
+    switch (out.function) {
+    case 0x01:
+    case 0x02:
+        if (hasData) {
+            const int bytes = qMin<int>(rsp.data[2], rsp.length - 5);
+            const int count = (req.length > 0) ? out.quantity : bytes * 8;
+            unpackBits(rsp.data + 3, bytes, count, out.values);
+            if (req.length == 0) {
+                out.quantity = static_cast<quint16>(out.values.size());
+            }
+        }
+        break;
+
+    case 0x03:
+    case 0x04:
+        if (hasData) {
+            unpackRegisters(rsp.data + 3, qMin<int>(rsp.data[2], rsp.length - 5), out.values);
+            if (req.length == 0) {
+                out.quantity = static_cast<quint16>(out.values.size());
+            }
+        }
+        break;
+
+    case 0x05:
+    case 0x06:
+    {
+        // 请求和正常响应相同，只有响应时也能解出
+        const RawFrame &frame = (req.length >= 8) ? req : rsp;
+        if (frame.length >= 8 && !(frame.data[1] & 0x80)) {
+            out.address = word(frame.data + 2);
+            out.quantity = 1;
+            const quint16 value = word(frame.data + 4);
+            out.values.append((out.function == 0x05) ? (value == 0xFF00 ? 1 : 0) : value);
+        }
+        break;
+    }
+
+    case 0x07:
+        if (hasData && rsp.length >= 5) {
+            out.values.append(rsp.data[2]);
+        }
+        break;
+
+    case 0x08:
+    {
+        const RawFrame &frame = hasData ? rsp : req;
+        if (frame.length >= 8) {
+            out.address = word(frame.data + 2);     // 子功能码
+            out.quantity = 1;
+            out.values.append(word(frame.data + 4));
+        }
+        break;
+    }
+
+    case 0x0B:
+        if (hasData && rsp.length >= 8) {
+            out.values.append(word(rsp.data + 2));  // 状态字
+            out.values.append(word(rsp.data + 4));  // 事件计数
+        }
+        break;
+
+    case 0x0C:
+        if (hasData) {
+            const int bytes = qMin<int>(rsp.data[2], rsp.length - 5);
+            for (int i = 0; i < bytes; ++i) {
+                out.values.append(rsp.data[3 + i]);
+            }
+        }
+        break;
+
+    case 0x0F:
+        if (req.length >= 9) {
+            unpackBits(req.data + 7, qMin<int>(req.data[6], req.length - 9), out.quantity, out.values);
+        } else if (hasData && rsp.length >= 8) {
+            out.address = word(rsp.data + 2);
+            out.quantity = word(rsp.data + 4);
+        }
+        break;
+
+    case 0x10:
+        if (req.length >= 9) {
+            unpackRegisters(req.data + 7, qMin<int>(req.data[6], req.length - 9), out.values);
+        } else if (hasData && rsp.length >= 8) {
+            out.address = word(rsp.data + 2);
+            out.quantity = word(rsp.data + 4);
+        }
+        break;
+
+    default:
+        break;      // 其他功能码只保留原始帧
+    }
+}
+
+// ========== 统计 ==========
+
+ModbusSnifferStats ModbusRtuSniffer::getStats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+QMap<int, ModbusSnifferSlaveStats> ModbusRtuSniffer::getSlaveStats() const
+{
+    QMap<int, ModbusSnifferSlaveStats> result;
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < 256; ++i) {
+        if (m_slaveStats[i].lastSeenUs != 0) {
+            result.insert(i, m_slaveStats[i]);
+        }
+    }
+    return result;
+}
+
+void ModbusRtuSniffer::resetStats()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats = ModbusSnifferStats();
+    for (int i = 0; i < 256; ++i) {
+        m_slaveStats[i] = ModbusSnifferSlaveStats();
+    }
+}
+
+QString ModbusRtuSniffer::statusToString(ModbusSnifferStatus status)
+{
+    switch (status) {
+    case ModbusSnifferStatus::Ok:         return "OK";
+    case ModbusSnifferStatus::Exception:  return "Exception";
+    case ModbusSnifferStatus::NoResponse: return "NoResponse";
+    case ModbusSnifferStatus::Broadcast:  return "Broadcast";
+    case ModbusSnifferStatus::Unmatched:  return "Unmatched";
+    }
+    return "Unknown";
+}
+
+/***************************************************************
+ * 生成统计报告
+ ***************************************************************/
+QString ModbusRtuSniffer::generateReport() const
+{
+    const ModbusSnifferStats stats = getStats();
+    const QMap<int, ModbusSnifferSlaveStats> slaves = getSlaveStats();
+
+    QString report;
+    QTextStream out(&report);
+
+    out << "========================================\n";
+    out << "  Modbus RTU Sniffer: " << (m_serial ? m_serial->getPortName() : QString("(detached)")) << "\n";
+    out << "========================================\n";
+    out << "Frame gap:       " << m_gapUs << " us\n";
+    out << "Bytes:           " << stats.bytes << "\n";
+    out << "Frames:          " << stats.frames << "\n";
+    out << "CRC errors:      " << stats.crcErrors << " (" << stats.noiseBytes << " bytes)\n";
+    out << "Unmatched:       " << stats.unmatched << "\n";
+    out << "Transactions:    " << stats.transactions << "\n";
+    out << "Dropped:         " << stats.dropped << "\n";
+    out << "---------------- Slaves ----------------\n";
+    out << "  addr   req    rsp    exc    norsp  latency min/avg/max (us)\n";
+    for (auto it = slaves.constBegin(); it != slaves.constEnd(); ++it) {
+        const ModbusSnifferSlaveStats &s = it.value();
+        const qint64 average = (s.responses > 0) ? s.latencySumUs / static_cast<qint64>(s.responses) : 0;
+        out << "  " << qSetFieldWidth(5) << it.key() << qSetFieldWidth(0) << "  "
+            << qSetFieldWidth(6) << s.requests << qSetFieldWidth(0) << " "
+            << qSetFieldWidth(6) << s.responses << qSetFieldWidth(0) << " "
+            << qSetFieldWidth(6) << s.exceptions << qSetFieldWidth(0) << " "
+            << qSetFieldWidth(6) << s.noResponses << qSetFieldWidth(0) << " "
+            << s.latencyMinUs << "/" << average << "/" << s.latencyMaxUs << "\n";
+    }
+    out << "========================================\n";
+
+    return report;
+}
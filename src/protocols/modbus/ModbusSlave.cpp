@@ -5,9 +5,15 @@
  * Version: 1.0
  * Date: 2025-10-15
  * Description: Modbus RTU从站协议驱动实现
+ *
+ * History:
+ *   1. 2025-10-15 创建文件
+ *   2. 2026-10-18 CRC改用SerialCrc16公共实现
+ *   3. 2026-10-18 打开串口后按配置启用内核RS-485方向控制
  ***************************************************************/
 
 #include "protocols/modbus/ModbusSlave.h"
+#include "drivers/serial/SerialCrc16.h"
 #include <QDebug>
 
 // Modbus异常码
@@ -89,6 +95,12 @@ bool ProtocolModbusSlave::connect()
         return false;
     }
     
+    // 响应发完后收发器须及时释放总线，否则收不到主站的下一帧
+    if (!applyRs485()) {
+        m_serialPort->close();
+        return false;
+    }
+    
     setState(ProtocolState::Connected);
     emit connected();
     
@@ -100,6 +112,49 @@ bool ProtocolModbusSlave::connect()
     return true;
 }
 
+/***************************************************************
+ * 设置RS-485方向控制
+ ***************************************************************/
+bool ProtocolModbusSlave::setRs485(const SerialRs485Config &config)
+{
+    if (m_serialPort->isOpen()) {
+        qWarning() << "Modbus Slave already open, close it before setting RS-485:" << m_portName;
+        return false;
+    }
+    m_rs485 = config;
+    return true;
+}
+
+/***************************************************************
+ * 在已打开的串口上启用内核RS-485
+ *   串口由QSerialPort打开，没有DriverSerial的I/O线程，gpio模式不可用；
+ *   auto模式下驱动不支持TIOCSRS485时不做方向控制（自动换向收发器）
+ ***************************************************************/
+bool ProtocolModbusSlave::applyRs485()
+{
+    if (!m_rs485.isEnabled()) {
+        return true;
+    }
+    if (m_rs485.mode == SerialRs485Config::Gpio) {
+        qWarning() << "Modbus Slave RS-485 gpio mode needs DriverSerial, direction not controlled:" << m_portName;
+        return true;
+    }
+
+    QString errorString;
+    bool notSupported = false;
+    if (!SerialRs485::applyKernel(m_serialPort->handle(), m_rs485, &errorString, &notSupported)) {
+        if (m_rs485.mode == SerialRs485Config::Auto && notSupported) {
+            qWarning() << "Modbus Slave driver has no TIOCSRS485, direction not controlled:" << m_portName;
+            return true;
+        }
+        setError(QString("Failed to enable RS-485 on %1: %2").arg(m_portName, errorString));
+        return false;
+    }
+
+    qInfo() << "Modbus Slave RS-485 kernel direction control enabled:" << m_portName;
+    return true;
+}
+
 /***************************************************************
  * 断开连接
  ***************************************************************/
@@ -195,12 +250,14 @@ void ProtocolModbusSlave::setTemperature(float temperature)
     quint16 intPart = static_cast<quint16>(temperature);
     quint16 fracPart = static_cast<quint16>((temperature - intPart) * 100);
     
-    setHoldingRegister(0x0000, intPart);
-    setHoldingRegister(0x0001, fracPart);
-    
-    // 同时更新输入寄存器（只读）
-    m_inputRegisters[0x0000] = intPart;
-    m_inputRegisters[0x0001] = fracPart;
+    // 同时更新输入寄存器（只读），四个寄存器一次写入
+    const RegisterWrite writes[] = {
+        { HoldingRegisters, 0x0000, intPart },
+        { HoldingRegisters, 0x0001, fracPart },
+        { InputRegisters, 0x0000, intPart },
+        { InputRegisters, 0x0001, fracPart }
+    };
+    applyRegisterWrites(writes, 4);
 }
 
 /***************************************************************
@@ -208,8 +265,11 @@ void ProtocolModbusSlave::setTemperature(float temperature)
  ***************************************************************/
 void ProtocolModbusSlave::setSystemStatus(quint16 status)
 {
-    setHoldingRegister(0x0002, status);
-    m_inputRegisters[0x0002] = status;
+    const RegisterWrite writes[] = {
+        { HoldingRegisters, 0x0002, status },
+        { InputRegisters, 0x0002, status }
+    };
+    applyRegisterWrites(writes, 2);
 }
 
 /***************************************************************
@@ -221,6 +281,7 @@ bool ProtocolModbusSlave::setHoldingRegister(quint16 address, quint16 value)
         return false;
     }
     
+    QMutexLocker locker(&m_registerMutex);
     m_holdingRegisters[address] = value;
     return true;
 }
@@ -234,9 +295,47 @@ quint16 ProtocolModbusSlave::getHoldingRegister(quint16 address) const
         return 0;
     }
     
+    QMutexLocker locker(&m_registerMutex);
     return m_holdingRegisters[address];
 }
 
+/***************************************************************
+ * 获取输入寄存器值
+ ***************************************************************/
+quint16 ProtocolModbusSlave::getInputRegister(quint16 address) const
+{
+    if (address >= MAX_REGISTERS) {
+        return 0;
+    }
+    
+    QMutexLocker locker(&m_registerMutex);
+    return m_inputRegisters[address];
+}
+
+/***************************************************************
+ * 批量写入寄存器
+ ***************************************************************/
+void ProtocolModbusSlave::applyRegisterWrites(const RegisterWrite *writes, int count)
+{
+    QMutexLocker locker(&m_registerMutex);
+    
+    // 直接操作数据指针，避免QVector::operator[]的分离检查
+    quint16 *holding = m_holdingRegisters.data();
+    quint16 *input = m_inputRegisters.data();
+    
+    for (int i = 0; i < count; i++) {
+        const RegisterWrite &w = writes[i];
+        if (w.address >= MAX_REGISTERS) {
+            continue;
+        }
+        if (w.table == InputRegisters) {
+            input[w.address] = w.value;
+        } else {
+            holding[w.address] = w.value;
+        }
+    }
+}
+
 /***************************************************************
  * 设置从站地址
  ***************************************************************/
@@ -332,12 +431,14 @@ void ProtocolModbusSlave::handleReadHoldingRegisters(const QByteArray &request)
     response.append(static_cast<char>(0x03));
     response.append(static_cast<char>(count * 2));  // 字节数
     
-    // 添加寄存器数据
+    // 添加寄存器数据（加锁读取，多寄存器值不会被拆开）
+    m_registerMutex.lock();
     for (int i = 0; i < count; i++) {
         quint16 value = m_holdingRegisters[startAddr + i];
         response.append((value >> 8) & 0xFF);
         response.append(value & 0xFF);
     }
+    m_registerMutex.unlock();
     
     sendResponse(response);
     
@@ -362,11 +463,13 @@ void ProtocolModbusSlave::handleReadInputRegisters(const QByteArray &request)
     response.append(static_cast<char>(0x04));
     response.append(static_cast<char>(count * 2));
     
+    m_registerMutex.lock();
     for (int i = 0; i < count; i++) {
         quint16 value = m_inputRegisters[startAddr + i];
         response.append((value >> 8) & 0xFF);
         response.append(value & 0xFF);
     }
+    m_registerMutex.unlock();
     
     sendResponse(response);
     
@@ -387,7 +490,9 @@ void ProtocolModbusSlave::handleWriteSingleRegister(const QByteArray &request)
     }
     
     // 写入寄存器
+    m_registerMutex.lock();
     m_holdingRegisters[address] = value;
+    m_registerMutex.unlock();
     
     // 回显请求（标准Modbus响应）
     QByteArray response = request.left(6);  // 去掉CRC
@@ -411,11 +516,13 @@ void ProtocolModbusSlave::handleWriteMultipleRegisters(const QByteArray &request
     }
     
     // 写入寄存器
+    m_registerMutex.lock();
     for (int i = 0; i < count; i++) {
         quint16 value = (static_cast<quint8>(request[7 + i * 2]) << 8) | 
                        static_cast<quint8>(request[7 + i * 2 + 1]);
         m_holdingRegisters[startAddr + i] = value;
     }
+    m_registerMutex.unlock();
     
     // 响应：[地址][功能码][起始地址H][起始地址L][数量H][数量L][CRC]
     QByteArray response;
@@ -436,12 +543,9 @@ void ProtocolModbusSlave::handleWriteMultipleRegisters(const QByteArray &request
  ***************************************************************/
 void ProtocolModbusSlave::sendResponse(const QByteArray &response)
 {
-    // 计算CRC并添加
-    quint16 crc = calculateCRC16(response);
-    
+    // 计算CRC并添加（低字节在前）
     QByteArray frame = response;
-    frame.append(crc & 0xFF);         // CRC低字节
-    frame.append((crc >> 8) & 0xFF);  // CRC高字节
+    SerialCrc16::modbusAppend(frame);
     
     // 发送响应
     m_serialPort->write(frame);
@@ -466,28 +570,6 @@ void ProtocolModbusSlave::sendException(quint8 functionCode, quint8 exceptionCod
                << QString("0x%1").arg(exceptionCode, 2, 16, QChar('0'));
 }
 
-/***************************************************************
- * 计算CRC16校验码
- ***************************************************************/
-quint16 ProtocolModbusSlave::calculateCRC16(const QByteArray &data)
-{
-    quint16 crc = 0xFFFF;
-    
-    for (int i = 0; i < data.size(); i++) {
-        crc ^= static_cast<quint8>(data[i]);
-        
-        for (int j = 0; j < 8; j++) {
-            if (crc & 0x0001) {
-                crc = (crc >> 1) ^ 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-    
-    return crc;
-}
-
 /***************************************************************
  * 验证CRC
  ***************************************************************/
@@ -497,14 +579,6 @@ bool ProtocolModbusSlave::verifyCRC(const QByteArray &data)
         return false;
     }
     
-    // 提取接收到的CRC
-    quint16 receivedCRC = (static_cast<quint8>(data[data.size() - 2])) |
-                          (static_cast<quint8>(data[data.size() - 1]) << 8);
-    
-    // 计算CRC（不含最后2字节）
-    QByteArray dataWithoutCRC = data.left(data.size() - 2);
-    quint16 calculatedCRC = calculateCRC16(dataWithoutCRC);
-    
-    return (receivedCRC == calculatedCRC);
+    return SerialCrc16::modbusCheck(data.constData(), data.size());
 }
 
@@ -0,0 +1,1528 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: XcpOnCan.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: XCP-on-CAN测量从站实现
+ ***************************************************************/
+
+#include "protocols/xcp/XcpOnCan.h"
+#include "drivers/can/DriverCANHighPerf.h"
+#include <QTextStream>
+#include <QtEndian>
+#include <QDebug>
+#include <string.h>
+
+// XCP命令码
+#define XCP_CMD_CONNECT                 0xFF
+#define XCP_CMD_DISCONNECT              0xFE
+#define XCP_CMD_GET_STATUS              0xFD
+#define XCP_CMD_SYNCH                   0xFC
+#define XCP_CMD_GET_COMM_MODE_INFO      0xFB
+#define XCP_CMD_SET_MTA                 0xF6
+#define XCP_CMD_UPLOAD                  0xF5
+#define XCP_CMD_SHORT_UPLOAD            0xF4
+#define XCP_CMD_DOWNLOAD                0xF0
+#define XCP_CMD_CLEAR_DAQ_LIST          0xE3
+#define XCP_CMD_SET_DAQ_PTR             0xE2
+#define XCP_CMD_WRITE_DAQ               0xE1
+#define XCP_CMD_SET_DAQ_LIST_MODE       0xE0
+#define XCP_CMD_GET_DAQ_LIST_MODE       0xDF
+#define XCP_CMD_START_STOP_DAQ_LIST     0xDE
+#define XCP_CMD_START_STOP_SYNCH        0xDD
+#define XCP_CMD_GET_DAQ_CLOCK           0xDC
+#define XCP_CMD_GET_DAQ_PROCESSOR_INFO  0xDA
+#define XCP_CMD_GET_DAQ_RESOLUTION_INFO 0xD9
+#define XCP_CMD_GET_DAQ_EVENT_INFO      0xD7
+#define XCP_CMD_FREE_DAQ                0xD6
+#define XCP_CMD_ALLOC_DAQ               0xD5
+#define XCP_CMD_ALLOC_ODT               0xD4
+#define XCP_CMD_ALLOC_ODT_ENTRY         0xD3
+
+// XCP错误码
+#define XCP_ERR_CMD_SYNCH               0x00
+#define XCP_ERR_DAQ_ACTIVE              0x11
+#define XCP_ERR_CMD_UNKNOWN             0x20
+#define XCP_ERR_CMD_SYNTAX              0x21
+#define XCP_ERR_OUT_OF_RANGE            0x22
+#define XCP_ERR_WRITE_PROTECTED         0x23
+#define XCP_ERR_ACCESS_DENIED           0x24
+#define XCP_ERR_MODE_NOT_VALID          0x27
+#define XCP_ERR_SEQUENCE                0x29
+#define XCP_ERR_DAQ_CONFIG              0x2A
+#define XCP_ERR_MEMORY_OVERFLOW         0x30
+
+// 响应包标识
+#define XCP_PID_RES                     0xFF
+#define XCP_PID_ERR                     0xFE
+
+// DAQ列表模式位
+#define XCP_DAQ_MODE_SELECTED           0x01
+#define XCP_DAQ_MODE_DIRECTION_STIM     0x02
+#define XCP_DAQ_MODE_TIMESTAMP          0x10
+#define XCP_DAQ_MODE_PID_OFF            0x20
+#define XCP_DAQ_MODE_RUNNING            0x40
+
+// 传输层参数
+#define XCP_MAX_CTO                     8
+#define XCP_MAX_DTO                     8
+#define XCP_ODT_PAYLOAD                 (XCP_MAX_DTO - 1)   // 去掉PID后的ODT容量
+#define XCP_TIMESTAMP_SIZE              4
+#define XCP_MAX_PID                     0xFB                // 0xFC-0xFF保留给响应/事件
+#define XCP_MAX_PENDING_BATCHES         64                  // 发送积压上限
+
+/***************************************************************
+ * XcpDaqThread 实现
+ ***************************************************************/
+XcpDaqThread::XcpDaqThread(ProtocolXcpCan *slave, QObject *parent)
+    : QThread(parent)
+    , m_slave(slave)
+{
+}
+
+/**
+ * @brief 停止采样线程
+ */
+void XcpDaqThread::stopSampling()
+{
+    m_slave->m_samplingRunning.store(0);
+
+    m_slave->m_daqMutex.lock();
+    m_slave->m_eventWake.wakeAll();
+    m_slave->m_daqMutex.unlock();
+
+    wait();
+}
+
+/**
+ * @brief 采样循环：处理到期事件，然后等待下一个周期或触发
+ */
+void XcpDaqThread::run()
+{
+    qInfo() << "[XcpDaqThread] 采样线程开始运行";
+
+    while (m_slave->m_samplingRunning.load() != 0) {
+        unsigned long waitMs = m_slave->sampleDueEvents(m_slave->m_clock.nsecsElapsed());
+
+        m_slave->m_daqMutex.lock();
+        bool pending = false;
+        for (const ProtocolXcpCan::EventChannel &event : m_slave->m_events) {
+            pending = pending || event.pending;
+        }
+        if (!pending && waitMs > 0 && m_slave->m_samplingRunning.load() != 0) {
+            m_slave->m_eventWake.wait(&m_slave->m_daqMutex, waitMs);
+        }
+        m_slave->m_daqMutex.unlock();
+    }
+
+    qInfo() << "[XcpDaqThread] 采样线程退出";
+}
+
+/***************************************************************
+ * 构造函数
+ ***************************************************************/
+ProtocolXcpCan::ProtocolXcpCan(DriverCANHighPerf *can, QObject *parent)
+    : IProtocolInterface(parent)
+    , m_can(can)
+    , m_croId(0x7F0)
+    , m_dtoId(0x7F1)
+    , m_extendedId(false)
+    , m_active(false)
+    , m_sessionConnected(false)
+    , m_mta(0)
+    , m_staticDaqCount(0)
+    , m_maxDynamicDaq(16)
+    , m_dynamicAllocated(false)
+    , m_daqPtrList(-1)
+    , m_daqPtrOdt(0)
+    , m_daqPtrEntry(0)
+    , m_commandCount(0)
+{
+    m_samplingRunning.store(0);
+    m_dtoCount.store(0);
+    m_overloadCount.store(0);
+    m_pendingBatches.store(0);
+
+    m_daqThread = new XcpDaqThread(this, this);
+    m_clock.start();
+}
+
+/***************************************************************
+ * 析构函数
+ ***************************************************************/
+ProtocolXcpCan::~ProtocolXcpCan()
+{
+    disconnect();
+}
+
+/***************************************************************
+ * 启动XCP从站
+ ***************************************************************/
+bool ProtocolXcpCan::connect()
+{
+    if (m_active) {
+        qWarning() << "[ProtocolXcpCan] 已启动";
+        return true;
+    }
+
+    if (!m_can) {
+        setError("XCP: CAN驱动为空");
+        return false;
+    }
+
+    // 两条接收路径都接入：独立线程（队列连接）与事件循环
+    QObject::connect(m_can, &DriverCANHighPerf::highPerfFrameReceived,
+                     this, &ProtocolXcpCan::onFrameReceived);
+    QObject::connect(m_can, &DriverCAN::frameReceived,
+                     this, &ProtocolXcpCan::onFrameReceived);
+
+    m_active = true;
+    m_samplingRunning.store(1);
+    m_daqThread->start(QThread::HighPriority);
+
+    setState(ProtocolState::Connected);
+    emit connected();
+
+    qInfo() << QString("[ProtocolXcpCan] XCP从站已启动: CRO=0x%1 DTO=0x%2 变量:%3 事件:%4 静态DAQ:%5")
+               .arg(m_croId, 0, 16).arg(m_dtoId, 0, 16)
+               .arg(m_variables.size()).arg(m_events.size()).arg(m_staticDaqCount);
+    return true;
+}
+
+/***************************************************************
+ * 停止XCP从站
+ ***************************************************************/
+void ProtocolXcpCan::disconnect()
+{
+    if (!m_active) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_daqMutex);
+        stopAllDaq();
+    }
+
+    m_daqThread->stopSampling();
+
+    if (m_can) {
+        QObject::disconnect(m_can, nullptr, this, nullptr);
+    }
+
+    m_active = false;
+    m_sessionConnected = false;
+
+    setState(ProtocolState::Disconnected);
+    emit disconnected();
+    qInfo() << "[ProtocolXcpCan] XCP从站已停止";
+}
+
+/***************************************************************
+ * 检查是否已启动
+ ***************************************************************/
+bool ProtocolXcpCan::isConnected() const
+{
+    return m_active && m_can && m_can->isOpen();
+}
+
+/***************************************************************
+ * 配置协议参数
+ ***************************************************************/
+bool ProtocolXcpCan::configure(const QMap<QString, QVariant> &config)
+{
+    bool ok = true;
+
+    if (config.contains("cro_id")) {
+        m_croId = config["cro_id"].toString().toUInt(&ok, 0);
+        if (!ok) {
+            setError("XCP: cro_id无效");
+            return false;
+        }
+    }
+
+    if (config.contains("dto_id")) {
+        m_dtoId = config["dto_id"].toString().toUInt(&ok, 0);
+        if (!ok) {
+            setError("XCP: dto_id无效");
+            return false;
+        }
+    }
+
+    if (config.contains("extended")) {
+        m_extendedId = config["extended"].toBool();
+    }
+
+    if (config.contains("max_dynamic_daq")) {
+        m_maxDynamicDaq = qBound(0, config["max_dynamic_daq"].toInt(), 64);
+    }
+
+    return true;
+}
+
+// ========== 变量与事件登记 ==========
+
+/***************************************************************
+ * 登记变量
+ ***************************************************************/
+bool ProtocolXcpCan::registerVariable(const QString &name, quint32 address, void *ptr,
+                                      int size, bool writable)
+{
+    if (!ptr || size <= 0) {
+        qWarning() << "[ProtocolXcpCan] 变量参数无效:" << name;
+        return false;
+    }
+
+    QMutexLocker locker(&m_daqMutex);
+
+    int insertAt = 0;
+    for (int i = 0; i < m_variables.size(); ++i) {
+        const Variable &v = m_variables.at(i);
+        quint64 vEnd = static_cast<quint64>(v.address) + v.size;
+        quint64 end = static_cast<quint64>(address) + size;
+        if (address < vEnd && v.address < end) {
+            qWarning() << "[ProtocolXcpCan] 变量地址重叠:" << name << "与" << v.name;
+            return false;
+        }
+        if (v.address < address) {
+            insertAt = i + 1;
+        }
+    }
+
+    Variable var;
+    var.name = name;
+    var.address = address;
+    var.ptr = static_cast<quint8*>(ptr);
+    var.size = size;
+    var.writable = writable;
+    m_variables.insert(insertAt, var);
+
+    qDebug() << QString("[ProtocolXcpCan] 登记变量 %1 @0x%2 (%3字节%4)")
+                .arg(name).arg(address, 0, 16).arg(size).arg(writable ? ", 可写" : "");
+    return true;
+}
+
+/***************************************************************
+ * 添加事件通道
+ ***************************************************************/
+int ProtocolXcpCan::addEventChannel(const QString &name, int cycleMs)
+{
+    QMutexLocker locker(&m_daqMutex);
+
+    if (m_events.size() >= 0xFFFF) {
+        return -1;
+    }
+
+    EventChannel event;
+    event.name = name;
+    event.cycleMs = qMax(0, cycleMs);
+    event.nextDueNs = 0;
+    event.pending = false;
+    m_events.append(event);
+
+    qInfo() << "[ProtocolXcpCan] 事件通道" << (m_events.size() - 1) << name
+            << (cycleMs > 0 ? QString("周期%1ms").arg(cycleMs) : QString("触发式"));
+    return m_events.size() - 1;
+}
+
+/***************************************************************
+ * 触发事件
+ ***************************************************************/
+void ProtocolXcpCan::triggerEvent(int channel)
+{
+    QMutexLocker locker(&m_daqMutex);
+
+    if (channel < 0 || channel >= m_events.size()) {
+        return;
+    }
+
+    m_events[channel].pending = true;
+    m_eventWake.wakeOne();
+}
+
+/***************************************************************
+ * 添加静态DAQ列表
+ ***************************************************************/
+int ProtocolXcpCan::addStaticDaqList(int eventChannel, const QVector<XcpMeasurement> &measurements)
+{
+    QMutexLocker locker(&m_daqMutex);
+
+    if (m_active || m_daqLists.size() != m_staticDaqCount) {
+        qWarning() << "[ProtocolXcpCan] 静态DAQ列表需在启动前、动态列表分配前定义";
+        return -1;
+    }
+
+    if (eventChannel < 0 || eventChannel >= m_events.size() || measurements.isEmpty()) {
+        qWarning() << "[ProtocolXcpCan] 静态DAQ列表参数无效";
+        return -1;
+    }
+
+    DaqList list;
+    list.eventChannel = static_cast<quint16>(eventChannel);
+    list.prescaler = 1;
+    list.prescalerCount = 0;
+    list.mode = 0;
+    list.firstPid = 0;
+    list.isStatic = true;
+    list.selected = false;
+    list.running = false;
+
+    // 按ODT容量贪心分组
+    Odt odt;
+    int used = 0;
+    for (const XcpMeasurement &m : measurements) {
+        const quint8 *ptr = resolveAddress(m.address, m.size, false);
+        if (!ptr || m.size == 0 || m.size > XCP_ODT_PAYLOAD) {
+            qWarning() << QString("[ProtocolXcpCan] 静态DAQ测量项无效: 0x%1 (%2字节)")
+                          .arg(m.address, 0, 16).arg(m.size);
+            return -1;
+        }
+        if (used + m.size > XCP_ODT_PAYLOAD) {
+            list.odts.append(odt);
+            odt.entries.clear();
+            used = 0;
+        }
+        OdtEntry entry;
+        entry.ptr = ptr;
+        entry.address = m.address;
+        entry.size = m.size;
+        odt.entries.append(entry);
+        used += m.size;
+    }
+    list.odts.append(odt);
+
+    m_daqLists.append(list);
+    m_staticDaqCount = m_daqLists.size();
+    assignPids();
+
+    qInfo() << "[ProtocolXcpCan] 静态DAQ列表" << (m_staticDaqCount - 1)
+            << "事件:" << eventChannel << "ODT数:" << list.odts.size();
+    return m_staticDaqCount - 1;
+}
+
+// ========== 命令处理 ==========
+
+/***************************************************************
+ * CAN帧接收（过滤CRO）
+ ***************************************************************/
+void ProtocolXcpCan::onFrameReceived(const QCanBusFrame &frame)
+{
+    if (!m_active ||
+        frame.frameType() != QCanBusFrame::DataFrame ||
+        frame.frameId() != m_croId ||
+        frame.hasExtendedFrameFormat() != m_extendedId) {
+        return;
+    }
+
+    processCommand(frame.payload());
+}
+
+/***************************************************************
+ * 命令分发
+ ***************************************************************/
+void ProtocolXcpCan::processCommand(const QByteArray &cmd)
+{
+    if (cmd.isEmpty()) {
+        return;
+    }
+
+    quint8 pid = static_cast<quint8>(cmd.at(0));
+
+    // 未建立会话时只响应CONNECT
+    if (!m_sessionConnected && pid != XCP_CMD_CONNECT) {
+        return;
+    }
+
+    m_commandCount++;
+
+    switch (pid) {
+        case XCP_CMD_CONNECT:
+            handleConnect(cmd);
+            break;
+        case XCP_CMD_DISCONNECT: {
+            QMutexLocker locker(&m_daqMutex);
+            stopAllDaq();
+            locker.unlock();
+            m_sessionConnected = false;
+            sendPositive();
+            emit sessionChanged(false);
+            qInfo() << "[ProtocolXcpCan] 主站断开会话";
+            break;
+        }
+        case XCP_CMD_GET_STATUS:
+            handleGetStatus();
+            break;
+        case XCP_CMD_SYNCH:
+            sendError(XCP_ERR_CMD_SYNCH);
+            break;
+        case XCP_CMD_GET_COMM_MODE_INFO: {
+            QByteArray data;
+            data.append(char(0));      // 保留
+            data.append(char(0));      // COMM_MODE_OPTIONAL
+            data.append(char(0));      // 保留
+            data.append(char(0));      // MAX_BS
+            data.append(char(0));      // MIN_ST
+            data.append(char(0));      // QUEUE_SIZE
+            data.append(char(0x10));   // 驱动版本1.0
+            sendPositive(data);
+            break;
+        }
+        case XCP_CMD_SET_MTA:
+            handleSetMta(cmd);
+            break;
+        case XCP_CMD_UPLOAD:
+            if (cmd.size() < 2) {
+                sendError(XCP_ERR_CMD_SYNTAX);
+                break;
+            }
+            handleUpload(static_cast<quint8>(cmd.at(1)), m_mta);
+            break;
+        case XCP_CMD_SHORT_UPLOAD:
+            if (cmd.size() < 8) {
+                sendError(XCP_ERR_CMD_SYNTAX);
+                break;
+            }
+            handleUpload(static_cast<quint8>(cmd.at(1)), readDword(cmd, 4));
+            break;
+        case XCP_CMD_DOWNLOAD:
+            handleDownload(cmd);
+            break;
+        case XCP_CMD_GET_DAQ_PROCESSOR_INFO:
+            handleGetDaqProcessorInfo();
+            break;
+        case XCP_CMD_GET_DAQ_RESOLUTION_INFO:
+            handleGetDaqResolutionInfo();
+            break;
+        case XCP_CMD_GET_DAQ_EVENT_INFO:
+            handleGetDaqEventInfo(cmd);
+            break;
+        case XCP_CMD_CLEAR_DAQ_LIST:
+            handleClearDaqList(cmd);
+            break;
+        case XCP_CMD_SET_DAQ_PTR:
+            handleSetDaqPtr(cmd);
+            break;
+        case XCP_CMD_WRITE_DAQ:
+            handleWriteDaq(cmd);
+            break;
+        case XCP_CMD_SET_DAQ_LIST_MODE:
+            handleSetDaqListMode(cmd);
+            break;
+        case XCP_CMD_GET_DAQ_LIST_MODE:
+            handleGetDaqListMode(cmd);
+            break;
+        case XCP_CMD_START_STOP_DAQ_LIST:
+            handleStartStopDaqList(cmd);
+            break;
+        case XCP_CMD_START_STOP_SYNCH:
+            handleStartStopSynch(cmd);
+            break;
+        case XCP_CMD_GET_DAQ_CLOCK:
+            handleGetDaqClock();
+            break;
+        case XCP_CMD_FREE_DAQ:
+            handleFreeDaq();
+            break;
+        case XCP_CMD_ALLOC_DAQ:
+            handleAllocDaq(cmd);
+            break;
+        case XCP_CMD_ALLOC_ODT:
+            handleAllocOdt(cmd);
+            break;
+        case XCP_CMD_ALLOC_ODT_ENTRY:
+            handleAllocOdtEntry(cmd);
+            break;
+        default:
+            sendError(XCP_ERR_CMD_UNKNOWN);
+            break;
+    }
+}
+
+/***************************************************************
+ * 发送响应帧
+ ***************************************************************/
+void ProtocolXcpCan::sendResponse(const QByteArray &payload)
+{
+    if (!m_can) {
+        return;
+    }
+
+    QCanBusFrame frame(m_dtoId, payload);
+    frame.setExtendedFrameFormat(m_extendedId);
+    m_can->writeFrame(frame);
+}
+
+void ProtocolXcpCan::sendPositive(const QByteArray &data)
+{
+    QByteArray payload;
+    payload.reserve(XCP_MAX_CTO);
+    payload.append(char(XCP_PID_RES));
+    payload.append(data);
+    sendResponse(payload);
+}
+
+void ProtocolXcpCan::sendError(quint8 errorCode)
+{
+    QByteArray payload;
+    payload.append(char(XCP_PID_ERR));
+    payload.append(char(errorCode));
+    sendResponse(payload);
+}
+
+/***************************************************************
+ * CONNECT
+ ***************************************************************/
+void ProtocolXcpCan::handleConnect(const QByteArray &cmd)
+{
+    Q_UNUSED(cmd);
+
+    bool wasConnected = m_sessionConnected;
+    m_sessionConnected = true;
+
+    QByteArray data;
+    data.append(char(0x05));            // RESOURCE: CAL/PAG + DAQ
+    data.append(char(0x00));            // COMM_MODE_BASIC: Intel字节序，字节粒度
+    data.append(char(XCP_MAX_CTO));     // MAX_CTO
+    appendWord(data, XCP_MAX_DTO);      // MAX_DTO
+    data.append(char(0x01));            // 协议层版本
+    data.append(char(0x01));            // 传输层版本
+    sendPositive(data);
+
+    if (!wasConnected) {
+        qInfo() << "[ProtocolXcpCan] 主站建立会话";
+        emit sessionChanged(true);
+    }
+}
+
+/***************************************************************
+ * GET_STATUS
+ ***************************************************************/
+void ProtocolXcpCan::handleGetStatus()
+{
+    QMutexLocker locker(&m_daqMutex);
+
+    QByteArray data;
+    data.append(char(anyDaqRunning() ? 0x40 : 0x00));  // SESSION_STATUS: DAQ_RUNNING
+    data.append(char(0x00));                            // 资源保护（无种子/密钥）
+    data.append(char(0x00));                            // 保留
+    appendWord(data, 0);                                // SESSION_CONFIGURATION_ID
+    locker.unlock();
+
+    sendPositive(data);
+}
+
+/***************************************************************
+ * SET_MTA
+ ***************************************************************/
+void ProtocolXcpCan::handleSetMta(const QByteArray &cmd)
+{
+    if (cmd.size() < 8) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    m_mta = readDword(cmd, 4);
+    sendPositive();
+}
+
+/***************************************************************
+ * UPLOAD / SHORT_UPLOAD
+ ***************************************************************/
+void ProtocolXcpCan::handleUpload(int size, quint32 address)
+{
+    if (size <= 0 || size > XCP_MAX_CTO - 1) {
+        sendError(XCP_ERR_OUT_OF_RANGE);
+        return;
+    }
+
+    const quint8 *ptr = resolveAddress(address, size, false);
+    if (!ptr) {
+        sendError(XCP_ERR_ACCESS_DENIED);
+        return;
+    }
+
+    QByteArray data(reinterpret_cast<const char*>(ptr), size);
+    m_mta = address + static_cast<quint32>(size);
+    sendPositive(data);
+}
+
+/***************************************************************
+ * DOWNLOAD
+ ***************************************************************/
+void ProtocolXcpCan::handleDownload(const QByteArray &cmd)
+{
+    if (cmd.size() < 2) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    int size = static_cast<quint8>(cmd.at(1));
+    if (size <= 0 || size > XCP_MAX_CTO - 2 || cmd.size() < 2 + size) {
+        sendError(XCP_ERR_OUT_OF_RANGE);
+        return;
+    }
+
+    if (!resolveAddress(m_mta, size, false)) {
+        sendError(XCP_ERR_ACCESS_DENIED);
+        return;
+    }
+
+    quint8 *ptr = resolveAddress(m_mta, size, true);
+    if (!ptr) {
+        sendError(XCP_ERR_WRITE_PROTECTED);
+        return;
+    }
+
+    memcpy(ptr, cmd.constData() + 2, size);
+
+    quint32 address = m_mta;
+    m_mta += static_cast<quint32>(size);
+    sendPositive();
+
+    emit variableWritten(address, size);
+}
+
+// ========== DAQ命令 ==========
+
+/***************************************************************
+ * GET_DAQ_PROCESSOR_INFO
+ ***************************************************************/
+void ProtocolXcpCan::handleGetDaqProcessorInfo()
+{
+    QMutexLocker locker(&m_daqMutex);
+
+    QByteArray data;
+    data.append(char(0x13));                                    // 动态配置 + 分频 + 时间戳
+    appendWord(data, static_cast<quint16>(m_staticDaqCount + m_maxDynamicDaq));  // MAX_DAQ
+    appendWord(data, static_cast<quint16>(m_events.size()));   // MAX_EVENT_CHANNEL
+    data.append(char(m_staticDaqCount));                        // MIN_DAQ（静态列表数）
+    data.append(char(0x00));                                    // DAQ_KEY_BYTE: 绝对ODT编号
+    locker.unlock();
+
+    sendPositive(data);
+}
+
+/***************************************************************
+ * GET_DAQ_RESOLUTION_INFO
+ ***************************************************************/
+void ProtocolXcpCan::handleGetDaqResolutionInfo()
+{
+    QByteArray data;
+    data.append(char(1));                   // ODT条目粒度（DAQ）
+    data.append(char(XCP_ODT_PAYLOAD));     // ODT条目最大字节（DAQ）
+    data.append(char(1));                   // ODT条目粒度（STIM）
+    data.append(char(XCP_ODT_PAYLOAD));     // ODT条目最大字节（STIM）
+    data.append(char(0x34));                // 时间戳: 4字节，单位1us
+    appendWord(data, 1);                    // TIMESTAMP_TICKS
+    sendPositive(data);
+}
+
+/***************************************************************
+ * GET_DAQ_EVENT_INFO
+ ***************************************************************/
+void ProtocolXcpCan::handleGetDaqEventInfo(const QByteArray &cmd)
+{
+    if (cmd.size() < 4) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    QMutexLocker locker(&m_daqMutex);
+
+    quint16 channel = readWord(cmd, 2);
+    if (channel >= m_events.size()) {
+        locker.unlock();
+        sendError(XCP_ERR_OUT_OF_RANGE);
+        return;
+    }
+
+    // 周期用 (cycle, unit) 表示，unit 6=1ms 7=10ms 8=100ms
+    int cycle = m_events.at(channel).cycleMs;
+    quint8 unit = 6;
+    while (cycle > 255 && unit < 9) {
+        cycle /= 10;
+        unit++;
+    }
+
+    QByteArray data;
+    data.append(char(0x04));                // DAQ方向
+    data.append(char(0xFF));                // MAX_DAQ_LIST
+    data.append(char(0x00));                // 名称长度（不提供）
+    data.append(char(qMin(cycle, 255)));    // 周期
+    data.append(char(unit));                // 周期单位
+    data.append(char(0x00));                // 优先级
+    locker.unlock();
+
+    sendPositive(data);
+}
+
+/***************************************************************
+ * CLEAR_DAQ_LIST
+ ***************************************************************/
+void ProtocolXcpCan::handleClearDaqList(const QByteArray &cmd)
+{
+    if (cmd.size() < 4) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    QMutexLocker locker(&m_daqMutex);
+
+    int daq = readWord(cmd, 2);
+    if (daq >= m_daqLists.size()) {
+        locker.unlock();
+        sendError(XCP_ERR_OUT_OF_RANGE);
+        return;
+    }
+
+    DaqList &list = m_daqLists[daq];
+    list.running = false;
+    list.selected = false;
+
+    // 静态列表的条目由应用定义，不清除
+    if (!list.isStatic) {
+        for (Odt &odt : list.odts) {
+            for (OdtEntry &entry : odt.entries) {
+                entry.ptr = nullptr;
+                entry.address = 0;
+                entry.size = 0;
+            }
+        }
+    }
+    locker.unlock();
+
+    sendPositive();
+}
+
+/***************************************************************
+ * SET_DAQ_PTR
+ ***************************************************************/
+void ProtocolXcpCan::handleSetDaqPtr(const QByteArray &cmd)
+{
+    if (cmd.size() < 6) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    QMutexLocker locker(&m_daqMutex);
+
+    int daq = readWord(cmd, 2);
+    int odt = static_cast<quint8>(cmd.at(4));
+    int entry = static_cast<quint8>(cmd.at(5));
+
+    quint8 error = 0;
+    if (daq >= m_daqLists.size() ||
+        odt >= m_daqLists.at(daq).odts.size() ||
+        entry >= m_daqLists.at(daq).odts.at(odt).entries.size()) {
+        error = XCP_ERR_OUT_OF_RANGE;
+    } else if (m_daqLists.at(daq).running) {
+        error = XCP_ERR_DAQ_ACTIVE;
+    } else {
+        m_daqPtrList = daq;
+        m_daqPtrOdt = odt;
+        m_daqPtrEntry = entry;
+    }
+    locker.unlock();
+
+    if (error) {
+        sendError(error);
+    } else {
+        sendPositive();
+    }
+}
+
+/***************************************************************
+ * WRITE_DAQ
+ ***************************************************************/
+void ProtocolXcpCan::handleWriteDaq(const QByteArray &cmd)
+{
+    if (cmd.size() < 8) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    quint8 bitOffset = static_cast<quint8>(cmd.at(1));
+    int size = static_cast<quint8>(cmd.at(2));
+    quint32 address = readDword(cmd, 4);
+
+    QMutexLocker locker(&m_daqMutex);
+
+    quint8 error = 0;
+    if (m_daqPtrList < 0 || m_daqPtrList >= m_daqLists.size()) {
+        error = XCP_ERR_SEQUENCE;
+    } else if (m_daqLists.at(m_daqPtrList).isStatic) {
+        error = XCP_ERR_WRITE_PROTECTED;
+    } else if (m_daqPtrOdt >= m_daqLists.at(m_daqPtrList).odts.size() ||
+               m_daqPtrEntry >= m_daqLists.at(m_daqPtrList).odts.at(m_daqPtrOdt).entries.size()) {
+        error = XCP_ERR_OUT_OF_RANGE;
+    } else if (bitOffset != 0xFF || size <= 0 || size > XCP_ODT_PAYLOAD) {
+        error = XCP_ERR_OUT_OF_RANGE;
+    } else {
+        const quint8 *ptr = resolveAddress(address, size, false);
+        if (!ptr) {
+            error = XCP_ERR_ACCESS_DENIED;
+        } else {
+            OdtEntry &entry = m_daqLists[m_daqPtrList].odts[m_daqPtrOdt].entries[m_daqPtrEntry];
+            entry.ptr = ptr;
+            entry.address = address;
+            entry.size = static_cast<quint8>(size);
+            m_daqPtrEntry++;    // 指针自动后移
+        }
+    }
+    locker.unlock();
+
+    if (error) {
+        sendError(error);
+    } else {
+        sendPositive();
+    }
+}
+
+/***************************************************************
+ * SET_DAQ_LIST_MODE
+ ***************************************************************/
+void ProtocolXcpCan::handleSetDaqListMode(const QByteArray &cmd)
+{
+    if (cmd.size() < 8) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    quint8 mode = static_cast<quint8>(cmd.at(1));
+    int daq = readWord(cmd, 2);
+    int event = readWord(cmd, 4);
+    quint8 prescaler = static_cast<quint8>(cmd.at(6));
+
+    QMutexLocker locker(&m_daqMutex);
+
+    quint8 error = 0;
+    if (daq >= m_daqLists.size() || event >= m_events.size() || prescaler == 0) {
+        error = XCP_ERR_OUT_OF_RANGE;
+    } else if (mode & (XCP_DAQ_MODE_DIRECTION_STIM | XCP_DAQ_MODE_PID_OFF)) {
+        error = XCP_ERR_MODE_NOT_VALID;
+    } else if (m_daqLists.at(daq).running) {
+        error = XCP_ERR_DAQ_ACTIVE;
+    } else {
+        DaqList &list = m_daqLists[daq];
+        list.mode = mode & XCP_DAQ_MODE_TIMESTAMP;
+        list.eventChannel = static_cast<quint16>(event);
+        list.prescaler = prescaler;
+        list.prescalerCount = 0;
+    }
+    locker.unlock();
+
+    if (error) {
+        sendError(error);
+    } else {
+        sendPositive();
+    }
+}
+
+/***************************************************************
+ * GET_DAQ_LIST_MODE
+ ***************************************************************/
+void ProtocolXcpCan::handleGetDaqListMode(const QByteArray &cmd)
+{
+    if (cmd.size() < 4) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    QMutexLocker locker(&m_daqMutex);
+
+    int daq = readWord(cmd, 2);
+    if (daq >= m_daqLists.size()) {
+        locker.unlock();
+        sendError(XCP_ERR_OUT_OF_RANGE);
+        return;
+    }
+
+    const DaqList &list = m_daqLists.at(daq);
+    quint8 current = list.mode;
+    if (list.selected) {
+        current |= XCP_DAQ_MODE_SELECTED;
+    }
+    if (list.running) {
+        current |= XCP_DAQ_MODE_RUNNING;
+    }
+
+    QByteArray data;
+    data.append(char(current));
+    data.append(char(0));
+    data.append(char(0));
+    appendWord(data, list.eventChannel);
+    data.append(char(list.prescaler));
+    data.append(char(0));   // 优先级
+    locker.unlock();
+
+    sendPositive(data);
+}
+
+/***************************************************************
+ * START_STOP_DAQ_LIST
+ ***************************************************************/
+void ProtocolXcpCan::handleStartStopDaqList(const QByteArray &cmd)
+{
+    if (cmd.size() < 4) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    quint8 mode = static_cast<quint8>(cmd.at(1));
+    int daq = readWord(cmd, 2);
+
+    QMutexLocker locker(&m_daqMutex);
+
+    if (daq >= m_daqLists.size() || mode > 2) {
+        locker.unlock();
+        sendError(XCP_ERR_OUT_OF_RANGE);
+        return;
+    }
+
+    DaqList &list = m_daqLists[daq];
+
+    if (mode != 0 && !validateDaqList(list)) {
+        locker.unlock();
+        sendError(XCP_ERR_DAQ_CONFIG);
+        return;
+    }
+
+    if (mode == 0) {
+        list.running = false;
+    } else if (mode == 1) {
+        list.running = true;
+        list.prescalerCount = 0;
+        EventChannel &event = m_events[list.eventChannel];
+        event.nextDueNs = m_clock.nsecsElapsed() + static_cast<qint64>(event.cycleMs) * 1000000LL;
+        m_eventWake.wakeOne();
+    } else {
+        list.selected = true;
+    }
+
+    quint8 firstPid = list.firstPid;
+    locker.unlock();
+
+    QByteArray data;
+    data.append(char(firstPid));
+    sendPositive(data);
+}
+
+/***************************************************************
+ * START_STOP_SYNCH
+ ***************************************************************/
+void ProtocolXcpCan::handleStartStopSynch(const QByteArray &cmd)
+{
+    if (cmd.size() < 2) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    quint8 mode = static_cast<quint8>(cmd.at(1));
+
+    QMutexLocker locker(&m_daqMutex);
+
+    if (mode > 2) {
+        locker.unlock();
+        sendError(XCP_ERR_OUT_OF_RANGE);
+        return;
+    }
+
+    if (mode == 0) {
+        stopAllDaq();
+        locker.unlock();
+        sendPositive();
+        return;
+    }
+
+    if (mode == 1) {
+        for (const DaqList &list : m_daqLists) {
+            if (list.selected && !validateDaqList(list)) {
+                locker.unlock();
+                sendError(XCP_ERR_DAQ_CONFIG);
+                return;
+            }
+        }
+    }
+
+    // 所有选中的列表在同一时刻启动，保证同步采样
+    qint64 now = m_clock.nsecsElapsed();
+    for (DaqList &list : m_daqLists) {
+        if (!list.selected) {
+            continue;
+        }
+        list.running = (mode == 1);
+        list.prescalerCount = 0;
+        list.selected = false;
+        if (list.running) {
+            EventChannel &event = m_events[list.eventChannel];
+            event.nextDueNs = now + static_cast<qint64>(event.cycleMs) * 1000000LL;
+        }
+    }
+    m_eventWake.wakeOne();
+    locker.unlock();
+
+    sendPositive();
+}
+
+/***************************************************************
+ * GET_DAQ_CLOCK
+ ***************************************************************/
+void ProtocolXcpCan::handleGetDaqClock()
+{
+    QByteArray data;
+    data.append(char(0));
+    data.append(char(0));
+    data.append(char(0));
+    appendDword(data, timestampUs());
+    sendPositive(data);
+}
+
+/***************************************************************
+ * FREE_DAQ
+ ***************************************************************/
+void ProtocolXcpCan::handleFreeDaq()
+{
+    QMutexLocker locker(&m_daqMutex);
+
+    // 只释放动态列表，静态列表保留
+    m_daqLists.resize(m_staticDaqCount);
+    for (DaqList &list : m_daqLists) {
+        list.running = false;
+        list.selected = false;
+    }
+    m_dynamicAllocated = false;
+    m_daqPtrList = -1;
+    assignPids();
+    locker.unlock();
+
+    sendPositive();
+}
+
+/***************************************************************
+ * ALLOC_DAQ
+ ***************************************************************/
+void ProtocolXcpCan::handleAllocDaq(const QByteArray &cmd)
+{
+    if (cmd.size() < 4) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    int count = readWord(cmd, 2);
+
+    QMutexLocker locker(&m_daqMutex);
+
+    quint8 error = 0;
+    if (m_dynamicAllocated) {
+        error = XCP_ERR_SEQUENCE;
+    } else if (count > m_maxDynamicDaq) {
+        error = XCP_ERR_MEMORY_OVERFLOW;
+    } else {
+        DaqList list;
+        list.eventChannel = 0;
+        list.prescaler = 1;
+        list.prescalerCount = 0;
+        list.mode = 0;
+        list.firstPid = 0;
+        list.isStatic = false;
+        list.selected = false;
+        list.running = false;
+        for (int i = 0; i < count; ++i) {
+            m_daqLists.append(list);
+        }
+        m_dynamicAllocated = true;
+        assignPids();
+    }
+    locker.unlock();
+
+    if (error) {
+        sendError(error);
+    } else {
+        sendPositive();
+    }
+}
+
+/***************************************************************
+ * ALLOC_ODT
+ ***************************************************************/
+void ProtocolXcpCan::handleAllocOdt(const QByteArray &cmd)
+{
+    if (cmd.size() < 5) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    int daq = readWord(cmd, 2);
+    int count = static_cast<quint8>(cmd.at(4));
+
+    QMutexLocker locker(&m_daqMutex);
+
+    int totalOdts = 0;
+    for (const DaqList &list : m_daqLists) {
+        totalOdts += list.odts.size();
+    }
+
+    quint8 error = 0;
+    if (!m_dynamicAllocated) {
+        error = XCP_ERR_SEQUENCE;
+    } else if (daq < m_staticDaqCount || daq >= m_daqLists.size()) {
+        error = XCP_ERR_OUT_OF_RANGE;
+    } else if (totalOdts + count > XCP_MAX_PID + 1) {
+        error = XCP_ERR_MEMORY_OVERFLOW;
+    } else {
+        m_daqLists[daq].odts.resize(m_daqLists.at(daq).odts.size() + count);
+        assignPids();
+    }
+    locker.unlock();
+
+    if (error) {
+        sendError(error);
+    } else {
+        sendPositive();
+    }
+}
+
+/***************************************************************
+ * ALLOC_ODT_ENTRY
+ ***************************************************************/
+void ProtocolXcpCan::handleAllocOdtEntry(const QByteArray &cmd)
+{
+    if (cmd.size() < 6) {
+        sendError(XCP_ERR_CMD_SYNTAX);
+        return;
+    }
+
+    int daq = readWord(cmd, 2);
+    int odt = static_cast<quint8>(cmd.at(4));
+    int count = static_cast<quint8>(cmd.at(5));
+
+    QMutexLocker locker(&m_daqMutex);
+
+    quint8 error = 0;
+    if (!m_dynamicAllocated) {
+        error = XCP_ERR_SEQUENCE;
+    } else if (daq < m_staticDaqCount || daq >= m_daqLists.size() ||
+               odt >= m_daqLists.at(daq).odts.size()) {
+        error = XCP_ERR_OUT_OF_RANGE;
+    } else if (count > XCP_ODT_PAYLOAD) {
+        // 每个条目至少1字节，超过ODT容量无意义
+        error = XCP_ERR_MEMORY_OVERFLOW;
+    } else {
+        OdtEntry empty;
+        empty.ptr = nullptr;
+        empty.address = 0;
+        empty.size = 0;
+        m_daqLists[daq].odts[odt].entries.fill(empty, count);
+    }
+    locker.unlock();
+
+    if (error) {
+        sendError(error);
+    } else {
+        sendPositive();
+    }
+}
+
+// ========== 辅助 ==========
+
+/***************************************************************
+ * ODT已用字节数
+ ***************************************************************/
+int ProtocolXcpCan::Odt::byteCount() const
+{
+    int total = 0;
+    for (const OdtEntry &entry : entries) {
+        total += entry.size;
+    }
+    return total;
+}
+
+/***************************************************************
+ * 地址解析（只允许访问已登记变量）
+ ***************************************************************/
+quint8* ProtocolXcpCan::resolveAddress(quint32 address, int size, bool forWrite) const
+{
+    for (const Variable &v : m_variables) {
+        if (address >= v.address &&
+            static_cast<quint64>(address) + size <= static_cast<quint64>(v.address) + v.size) {
+            if (forWrite && !v.writable) {
+                return nullptr;
+            }
+            return v.ptr + (address - v.address);
+        }
+    }
+    return nullptr;
+}
+
+/***************************************************************
+ * 分配绝对ODT编号（调用者持有m_daqMutex）
+ ***************************************************************/
+void ProtocolXcpCan::assignPids()
+{
+    int pid = 0;
+    for (DaqList &list : m_daqLists) {
+        list.firstPid = static_cast<quint8>(qMin(pid, XCP_MAX_PID));
+        pid += list.odts.size();
+    }
+}
+
+/***************************************************************
+ * 校验DAQ列表容量（调用者持有m_daqMutex）
+ ***************************************************************/
+bool ProtocolXcpCan::validateDaqList(const DaqList &list) const
+{
+    if (list.odts.isEmpty() || list.eventChannel >= m_events.size()) {
+        return false;
+    }
+
+    int totalBytes = 0;
+    for (int i = 0; i < list.odts.size(); ++i) {
+        int bytes = list.odts.at(i).byteCount();
+        if (i == 0 && (list.mode & XCP_DAQ_MODE_TIMESTAMP)) {
+            bytes += XCP_TIMESTAMP_SIZE;
+        }
+        if (bytes > XCP_ODT_PAYLOAD) {
+            return false;
+        }
+        totalBytes += list.odts.at(i).byteCount();
+    }
+
+    return totalBytes > 0 && list.firstPid + list.odts.size() - 1 <= XCP_MAX_PID;
+}
+
+/***************************************************************
+ * 停止所有DAQ列表（调用者持有m_daqMutex）
+ ***************************************************************/
+void ProtocolXcpCan::stopAllDaq()
+{
+    for (DaqList &list : m_daqLists) {
+        list.running = false;
+        list.selected = false;
+    }
+    for (EventChannel &event : m_events) {
+        event.pending = false;
+    }
+}
+
+bool ProtocolXcpCan::anyDaqRunning() const
+{
+    for (const DaqList &list : m_daqLists) {
+        if (list.running) {
+            return true;
+        }
+    }
+    return false;
+}
+
+quint32 ProtocolXcpCan::timestampUs() const
+{
+    return static_cast<quint32>(m_clock.nsecsElapsed() / 1000);
+}
+
+// ========== 采样 ==========
+
+/***************************************************************
+ * 处理到期事件（采样线程调用）
+ *
+ * 持锁期间只做memcpy打包，发送交给驱动线程，每个周期一次排队调用
+ ***************************************************************/
+unsigned long ProtocolXcpCan::sampleDueEvents(qint64 nowNs)
+{
+    QVector<QCanBusFrame> frames;
+    qint64 nextDueNs = nowNs + 100 * 1000000LL;     // 无周期事件时100ms检查一次
+
+    {
+        QMutexLocker locker(&m_daqMutex);
+
+        if (!anyDaqRunning()) {
+            for (EventChannel &event : m_events) {
+                event.pending = false;
+            }
+            return 100;
+        }
+
+        quint32 timestamp = timestampUs();
+
+        for (int ch = 0; ch < m_events.size(); ++ch) {
+            EventChannel &event = m_events[ch];
+
+            bool due = event.pending;
+            event.pending = false;
+
+            if (event.cycleMs > 0 && nowNs >= event.nextDueNs) {
+                due = true;
+                qint64 cycleNs = static_cast<qint64>(event.cycleMs) * 1000000LL;
+                event.nextDueNs += cycleNs;
+                if (event.nextDueNs <= nowNs) {
+                    // 落后超过一个周期：跳过错过的周期并计入过载
+                    m_overloadCount.fetchAndAddRelaxed(1);
+                    event.nextDueNs = nowNs + cycleNs;
+                }
+            }
+
+            if (event.cycleMs > 0 && event.nextDueNs < nextDueNs) {
+                nextDueNs = event.nextDueNs;
+            }
+
+            if (!due) {
+                continue;
+            }
+
+            for (DaqList &list : m_daqLists) {
+                if (!list.running || list.eventChannel != ch) {
+                    continue;
+                }
+                if (++list.prescalerCount < list.prescaler) {
+                    continue;
+                }
+                list.prescalerCount = 0;
+                sampleDaqList(list, timestamp, frames);
+            }
+        }
+    }
+
+    if (!frames.isEmpty()) {
+        if (m_pendingBatches.load() >= XCP_MAX_PENDING_BATCHES) {
+            // 驱动线程跟不上，丢弃本批并计入过载
+            m_overloadCount.fetchAndAddRelaxed(1);
+        } else {
+            m_pendingBatches.ref();
+            QMetaObject::invokeMethod(this, [this, frames]() {
+                transmitBatch(frames);
+            }, Qt::QueuedConnection);
+        }
+    }
+
+    qint64 waitNs = nextDueNs - m_clock.nsecsElapsed();
+    return waitNs > 0 ? static_cast<unsigned long>((waitNs + 999999) / 1000000) : 0;
+}
+
+/***************************************************************
+ * 对一个DAQ列表采样（调用者持有m_daqMutex）
+ ***************************************************************/
+void ProtocolXcpCan::sampleDaqList(const DaqList &list, quint32 timestamp,
+                                   QVector<QCanBusFrame> &out)
+{
+    for (int i = 0; i < list.odts.size(); ++i) {
+        const Odt &odt = list.odts.at(i);
+
+        char buffer[XCP_MAX_DTO];
+        int pos = 0;
+        buffer[pos++] = static_cast<char>(list.firstPid + i);
+
+        if (i == 0 && (list.mode & XCP_DAQ_MODE_TIMESTAMP)) {
+            qToLittleEndian<quint32>(timestamp, reinterpret_cast<uchar*>(buffer + pos));
+            pos += XCP_TIMESTAMP_SIZE;
+        }
+
+        for (const OdtEntry &entry : odt.entries) {
+            if (entry.size == 0 || !entry.ptr) {
+                continue;
+            }
+            memcpy(buffer + pos, entry.ptr, entry.size);
+            pos += entry.size;
+        }
+
+        if (pos <= 1) {
+            continue;
+        }
+
+        QCanBusFrame frame(m_dtoId, QByteArray(buffer, pos));
+        frame.setExtendedFrameFormat(m_extendedId);
+        out.append(frame);
+    }
+}
+
+/***************************************************************
+ * 发送一批DTO（驱动线程）
+ ***************************************************************/
+void ProtocolXcpCan::transmitBatch(const QVector<QCanBusFrame> &frames)
+{
+    m_pendingBatches.deref();
+
+    if (!m_active || !m_can || !m_can->isOpen()) {
+        return;
+    }
+
+    for (const QCanBusFrame &frame : frames) {
+        if (m_can->writeFrame(frame)) {
+            m_dtoCount.fetchAndAddRelaxed(1);
+        }
+    }
+}
+
+// ========== 字节序辅助（Intel） ==========
+
+quint16 ProtocolXcpCan::readWord(const QByteArray &cmd, int offset)
+{
+    return qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(cmd.constData() + offset));
+}
+
+quint32 ProtocolXcpCan::readDword(const QByteArray &cmd, int offset)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(cmd.constData() + offset));
+}
+
+void ProtocolXcpCan::appendWord(QByteArray &data, quint16 value)
+{
+    data.append(static_cast<char>(value & 0xFF));
+    data.append(static_cast<char>((value >> 8) & 0xFF));
+}
+
+void ProtocolXcpCan::appendDword(QByteArray &data, quint32 value)
+{
+    appendWord(data, static_cast<quint16>(value & 0xFFFF));
+    appendWord(data, static_cast<quint16>(value >> 16));
+}
+
+// ========== 报告 ==========
+
+/***************************************************************
+ * 生成XCP从站状态报告
+ ***************************************************************/
+QString ProtocolXcpCan::generateReport() const
+{
+    QMutexLocker locker(&m_daqMutex);
+
+    QString report;
+    QTextStream out(&report);
+
+    out << "========================================\n";
+    out << "  XCP on CAN Slave Report\n";
+    out << "========================================\n";
+    out << "CRO: 0x" << QString::number(m_croId, 16).toUpper()
+        << "  DTO: 0x" << QString::number(m_dtoId, 16).toUpper()
+        << "  Session: " << (m_sessionConnected ? "connected" : "idle") << "\n";
+    out << "Commands: " << m_commandCount
+        << "  DTO frames: " << m_dtoCount.load()
+        << "  Overload: " << m_overloadCount.load() << "\n";
+    out << "----------------------------------------\n";
+
+    out << "  • Variables (" << m_variables.size() << ")\n";
+    for (const Variable &v : m_variables) {
+        out << "    0x" << QString::number(v.address, 16).toUpper()
+            << "  " << v.size << "B  " << v.name
+            << (v.writable ? "  [RW]" : "") << "\n";
+    }
+
+    out << "  • Events (" << m_events.size() << ")\n";
+    for (int i = 0; i < m_events.size(); ++i) {
+        out << "    " << i << "  " << m_events.at(i).name << "  "
+            << (m_events.at(i).cycleMs > 0 ? QString("%1 ms").arg(m_events.at(i).cycleMs)
+                                           : QString("triggered")) << "\n";
+    }
+
+    out << "  • DAQ lists (" << m_daqLists.size() << ", static " << m_staticDaqCount << ")\n";
+    for (int i = 0; i < m_daqLists.size(); ++i) {
+        const DaqList &list = m_daqLists.at(i);
+        out << "    " << i << "  event " << list.eventChannel
+            << "  ODTs " << list.odts.size()
+            << "  PID " << list.firstPid
+            << "  prescaler " << list.prescaler
+            << (list.running ? "  [RUNNING]" : "") << "\n";
+    }
+
+    out << "========================================\n";
+
+    return report;
+}
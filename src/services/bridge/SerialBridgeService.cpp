@@ -0,0 +1,175 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialBridgeService.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口TCP桥服务实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "services/bridge/SerialBridgeService.h"
+#include "drivers/manager/DriverManager.h"
+#include <QHostAddress>
+#include <QDebug>
+
+/***************************************************************
+ * 构造函数
+ ***************************************************************/
+SerialBridgeService::SerialBridgeService(int32_t svr_id, int32_t svr_type, QObject *parent)
+    : ISysSvrInterface(svr_id, svr_type, parent)
+    , m_IsInitialized(false)
+    , m_IsStarted(false)
+{
+    qInfo() << "[SerialBridgeService] 串口桥服务创建";
+}
+
+/***************************************************************
+ * 析构函数
+ ***************************************************************/
+SerialBridgeService::~SerialBridgeService()
+{
+    SvrStop();
+    qDeleteAll(m_bridges);
+    m_bridges.clear();
+}
+
+/***************************************************************
+ * 服务初始化: 按[SerialBridge/...]配置创建桥
+ ***************************************************************/
+bool SerialBridgeService::SvrInit()
+{
+    if (m_IsInitialized) {
+        qWarning() << "[SerialBridgeService] 服务已初始化";
+        return false;
+    }
+
+    const QList<QVariantMap> configs = DriverManager::getInstance().getSerialBridgeConfigs();
+    for (const QVariantMap &config : configs) {
+        SerialTcpBridge *bridge = createBridge(config);
+        if (bridge) {
+            m_bridges.append(bridge);
+        }
+    }
+
+    m_IsInitialized = true;
+    qInfo() << "[SerialBridgeService] ✓ 服务初始化成功，共" << m_bridges.size() << "个串口桥";
+
+    return true;
+}
+
+/***************************************************************
+ * 服务启动: 打开串口并开始监听（单个桥失败不影响其他桥）
+ ***************************************************************/
+bool SerialBridgeService::SvrStart()
+{
+    if (!m_IsInitialized) {
+        qWarning() << "[SerialBridgeService] 服务未初始化，无法启动";
+        return false;
+    }
+
+    if (m_IsStarted) {
+        qWarning() << "[SerialBridgeService] 服务已启动";
+        return false;
+    }
+
+    int started = 0;
+    for (SerialTcpBridge *bridge : m_bridges) {
+        if (bridge->startBridge()) {
+            started++;
+        } else {
+            qWarning() << "[SerialBridgeService] 串口桥启动失败:" << bridge->getPortName()
+                       << bridge->getLastError();
+        }
+    }
+
+    m_IsStarted = true;
+    qInfo() << "[SerialBridgeService] ✓ 服务启动成功:" << started << "/" << m_bridges.size() << "个串口桥";
+
+    return true;
+}
+
+/***************************************************************
+ * 服务停止
+ ***************************************************************/
+bool SerialBridgeService::SvrStop()
+{
+    if (!m_IsStarted) {
+        return true;
+    }
+
+    for (SerialTcpBridge *bridge : m_bridges) {
+        bridge->stopBridge();
+    }
+
+    m_IsStarted = false;
+    qInfo() << "[SerialBridgeService] ✓ 服务已停止";
+
+    return true;
+}
+
+/***************************************************************
+ * 所有桥的统计报告
+ ***************************************************************/
+QString SerialBridgeService::GenerateReport() const
+{
+    QString report;
+    for (SerialTcpBridge *bridge : m_bridges) {
+        report += bridge->generateReport();
+    }
+    return report;
+}
+
+/***************************************************************
+ * 按一个配置节创建桥
+ ***************************************************************/
+SerialTcpBridge* SerialBridgeService::createBridge(const QVariantMap &config)
+{
+    const QString name = config.value("name").toString();
+    const QString device = config.value("device").toString();
+
+    SerialLineSettings line;
+    line.baudRate = config.value("baudrate", 115200).toInt();
+    if (!SerialTermios::isSupportedBaudRate(line.baudRate)) {
+        qWarning() << "[SerialBridgeService]" << name << "不支持的波特率:" << line.baudRate;
+        return nullptr;
+    }
+
+    line.dataBits = (config.value("databits", 8).toInt() == 7) ? QSerialPort::Data7 : QSerialPort::Data8;
+
+    const QString parity = config.value("parity", "N").toString().toUpper();
+    if (parity == "E") {
+        line.parity = QSerialPort::EvenParity;
+    } else if (parity == "O") {
+        line.parity = QSerialPort::OddParity;
+    } else {
+        line.parity = QSerialPort::NoParity;
+    }
+
+    line.stopBits = (config.value("stopbits", 1).toInt() == 2) ? QSerialPort::TwoStop : QSerialPort::OneStop;
+
+    const QString flow = config.value("flow", "none").toString().toLower();
+    if (flow == "hw" || flow == "rtscts") {
+        line.flowControl = QSerialPort::HardwareControl;
+    } else if (flow == "sw" || flow == "xonxoff") {
+        line.flowControl = QSerialPort::SoftwareControl;
+    } else {
+        line.flowControl = QSerialPort::NoFlowControl;
+    }
+
+    QHostAddress bind(config.value("bind", "0.0.0.0").toString());
+    if (bind.isNull()) {
+        qWarning() << "[SerialBridgeService]" << name << "监听地址无效:" << config.value("bind").toString();
+        return nullptr;
+    }
+
+    SerialTcpBridge *bridge = new SerialTcpBridge(device);
+    bridge->setLineSettings(line);
+    bridge->setListenAddress(bind, static_cast<quint16>(config.value("tcp_port").toInt()));
+    bridge->setRfc2217Enabled(config.value("rfc2217", false).toBool());
+    bridge->setSpliceEnabled(config.value("splice", true).toBool());
+    bridge->setBufferSize(config.value("buffer_size", 4096).toInt());
+    return bridge;
+}
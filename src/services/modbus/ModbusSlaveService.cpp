@@ -8,6 +8,8 @@
  ***************************************************************/
 
 #include "services/modbus/ModbusSlaveService.h"
+#include "drivers/manager/DriverManager.h"
+#include "drivers/can/DriverCAN.h"
 #include <QDebug>
 
 /***************************************************************
@@ -37,6 +39,9 @@ ModbusSlaveService::~ModbusSlaveService()
 {
     qInfo() << "[ModbusSlaveService] Modbus从站服务销毁";
     SvrStop();
+    
+    // 未启动或已停止时桥接已释放，这里只是兜底
+    detachCanBridges();
 }
 
 /***************************************************************
@@ -68,6 +73,13 @@ bool ModbusSlaveService::SvrInit()
     
     qInfo() << "  Modbus配置: 9600,8,N,1 从站地址=" << m_slaveAddress;
     
+    // RS-485方向控制取自hardware.init中该串口的[Serial/...]配置节
+    SerialRs485Config rs485 = DriverManager::getInstance().getSerialRs485(m_portName);
+    m_pModbusSlave->setRs485(rs485);
+    if (rs485.isEnabled()) {
+        qInfo() << "  RS-485:" << SerialRs485Config::modeToString(rs485.mode);
+    }
+    
     // 3. 创建独立线程（保证实时通信）
     m_pThread = new QThread();
     if (!m_pThread) {
@@ -124,6 +136,9 @@ bool ModbusSlaveService::SvrStart()
     // 启动线程（会触发QThread::started信号，自动调用Modbus::connect）
     m_pThread->start();
     
+    // CAN信号直接在接收路径写入寄存器
+    attachCanBridges();
+    
     m_IsStarted = true;
     qInfo() << "[ModbusSlaveService] ✓ 服务启动成功（独立线程实时监听）";
     qInfo() << "  Modbus RTU从站运行在独立线程，保证通信实时性";
@@ -143,6 +158,9 @@ bool ModbusSlaveService::SvrStop()
     
     qInfo() << "[ModbusSlaveService] 停止Modbus从站服务...";
     
+    // 先取下并释放桥接（等待接收线程中的回调结束），从站对象随线程结束释放
+    detachCanBridges();
+    
     // 断开Modbus连接
     if (m_pModbusSlave && m_pModbusSlave->isConnected()) {
         m_pModbusSlave->disconnect();
@@ -246,6 +264,80 @@ void ModbusSlaveService::connectModbusSignals()
     });
 }
 
+/***************************************************************
+ * 挂接CAN→Modbus桥接
+ ***************************************************************/
+void ModbusSlaveService::attachCanBridges()
+{
+    if (!m_pModbusSlave || !m_canBridges.isEmpty()) {
+        return;
+    }
+    
+    const QList<QVariantMap> mappings = DriverManager::getInstance().getCANModbusMappings();
+    if (mappings.isEmpty()) {
+        return;
+    }
+    
+    // 按CAN别名分组，每条总线一个桥接器
+    DriverManager &driverMgr = DriverManager::getInstance();
+    for (const QVariantMap &params : mappings) {
+        QString name = params.value("name").toString();
+        QString canAlias = params.value("can").toString();
+        
+        DriverCAN *can = driverMgr.getCANByAlias(canAlias);
+        if (!can) {
+            qWarning() << "[ModbusSlaveService] CAN映射" << name << "的总线不存在:" << canAlias;
+            continue;
+        }
+        
+        int index = m_bridgeCans.indexOf(can);
+        if (index < 0) {
+            m_canBridges.append(new CANModbusBridge(m_pModbusSlave));
+            m_bridgeCans.append(can);
+            index = m_canBridges.size() - 1;
+        }
+        
+        CANModbusBridge::Mapping mapping;
+        QString errorMessage;
+        if (!CANModbusBridge::parseMapping(name, params, mapping, &errorMessage) ||
+            !m_canBridges[index]->addMapping(mapping, &errorMessage)) {
+            qWarning() << "[ModbusSlaveService] CAN映射无效:" << errorMessage;
+        }
+    }
+    
+    // 编译后挂接，之后映射表只读
+    for (int i = 0; i < m_canBridges.size(); i++) {
+        QString errorMessage;
+        if (!m_canBridges[i]->compile(&errorMessage)) {
+            qWarning() << "[ModbusSlaveService] CAN映射编译失败:" << errorMessage;
+            continue;
+        }
+        m_bridgeCans[i]->setFrameListener(m_canBridges[i]);
+        qInfo() << "[ModbusSlaveService] ✓ CAN→Modbus桥接已挂接:"
+                 << m_bridgeCans[i]->getInterfaceName()
+                 << m_canBridges[i]->mappingCount() << "个信号";
+    }
+}
+
+/***************************************************************
+ * 取下CAN→Modbus桥接
+ ***************************************************************/
+void ModbusSlaveService::detachCanBridges()
+{
+    // setFrameListener返回时正在执行的canFrameReceived已结束（见CANFrameListener.h），
+    // 之后释放桥接、结束从站线程都不会再有接收线程访问
+    for (int i = 0; i < m_bridgeCans.size(); i++) {
+        if (m_bridgeCans[i]->getFrameListener() == m_canBridges[i]) {
+            m_bridgeCans[i]->setFrameListener(nullptr);
+        }
+    }
+    
+    // 桥接引用的从站对象随线程结束释放，桥接不能留到下次启动
+    qDeleteAll(m_canBridges);
+    m_canBridges.clear();
+    m_bridgeCans.clear();
+}
+
 /***************************************************************
  * Modbus写请求槽函数
  ***************************************************************/
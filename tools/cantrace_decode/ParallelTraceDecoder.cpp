@@ -0,0 +1,289 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: ParallelTraceDecoder.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN抓包文件的多核离线解码实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "ParallelTraceDecoder.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QThread>
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+#define DECODE_WRITE_BATCH      65536   // 每次写入输出的行数（列式文件的行组大小）
+#define DECODE_CHUNKS_PER_THREAD 8      // 自动划分时每个线程分到的段数
+
+/***************************************************************
+ * 类名: TraceDecodeTask
+ * 功能: 线程池任务，解码一段
+ ***************************************************************/
+class TraceDecodeTask : public QRunnable
+{
+public:
+    TraceDecodeTask(ParallelTraceDecoder *decoder, int index)
+        : m_decoder(decoder), m_index(index)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        m_decoder->decodeChunk(m_index);
+    }
+
+private:
+    ParallelTraceDecoder *m_decoder;
+    int m_index;
+};
+
+static bool rowEarlier(const DecodedRow &a, const DecodedRow &b)
+{
+    return a.timestampUs < b.timestampUs;
+}
+
+/***************************************************************
+ * 构造函数
+ ***************************************************************/
+ParallelTraceDecoder::ParallelTraceDecoder(const CANDbcDatabase *dbc)
+    : m_dbc(dbc)
+    , m_threadCount(qMax(1, QThread::idealThreadCount()))
+    , m_chunkBlocks(0)
+    , m_fromUs(std::numeric_limits<qint64>::min())
+    , m_toUs(std::numeric_limits<qint64>::max())
+    , m_framesDecoded(0)
+    , m_rowsWritten(0)
+    , m_maxPendingRows(0)
+{
+}
+
+void ParallelTraceDecoder::setThreadCount(int count)
+{
+    m_threadCount = qMax(1, count);
+}
+
+void ParallelTraceDecoder::setChunkBlocks(int blocks)
+{
+    m_chunkBlocks = qMax(0, blocks);
+}
+
+void ParallelTraceDecoder::setTimeRange(qint64 fromUs, qint64 toUs)
+{
+    m_fromUs = fromUs;
+    m_toUs = toUs;
+}
+
+/***************************************************************
+ * 解码抓包文件
+ ***************************************************************/
+bool ParallelTraceDecoder::run(const QString &tracePath, const QString &outputPath,
+                               TraceDecodeSink *sink)
+{
+    m_framesDecoded = 0;
+    m_rowsWritten = 0;
+    m_maxPendingRows = 0;
+    m_blocks.clear();
+    m_chunks.clear();
+
+    // 只用读取器加载（或重建）块索引，数据由各线程自己读取
+    CANTraceReader reader;
+    if (!reader.open(tracePath)) {
+        m_lastError = reader.getLastError();
+        return false;
+    }
+    for (const CANTraceBlock &block : reader.blocks()) {
+        if (block.maxUs >= m_fromUs && block.minUs <= m_toUs) {
+            m_blocks.append(block);
+        }
+    }
+    reader.close();
+    m_tracePath = tracePath;
+
+    // 切段
+    int chunkBlocks = m_chunkBlocks;
+    if (chunkBlocks <= 0) {
+        chunkBlocks = qMax(1, m_blocks.size() / (m_threadCount * DECODE_CHUNKS_PER_THREAD));
+    }
+    for (int first = 0; first < m_blocks.size(); first += chunkBlocks) {
+        Chunk chunk;
+        chunk.firstBlock = first;
+        chunk.blockCount = qMin(chunkBlocks, m_blocks.size() - first);
+        chunk.frames = 0;
+        chunk.done = false;
+        chunk.ok = false;
+        m_chunks.append(chunk);
+    }
+
+    // 水位：之后所有段的最早时间戳，早于水位的行不会再有更早的行插入
+    qint64 suffixMin = std::numeric_limits<qint64>::max();
+    for (int i = m_chunks.size() - 1; i >= 0; i--) {
+        m_chunks[i].watermarkUs = suffixMin;
+        for (int b = 0; b < m_chunks[i].blockCount; b++) {
+            suffixMin = qMin(suffixMin, m_blocks.at(m_chunks[i].firstBlock + b).minUs);
+        }
+    }
+
+    if (!sink->begin(outputPath, *m_dbc)) {
+        m_lastError = sink->getLastError();
+        return false;
+    }
+
+    qInfo() << "[ParallelTraceDecoder] 块数:" << m_blocks.size() << "段数:" << m_chunks.size()
+            << "线程数:" << m_threadCount;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(m_threadCount);
+
+    // 在途段数有上限，内存占用与文件大小无关
+    const int maxInFlight = m_threadCount * 2;
+    int submitted = 0;
+    bool ok = true;
+    QVector<DecodedRow> pending;
+    QVector<DecodedRow> merged;
+
+    for (int k = 0; k < m_chunks.size() && ok; k++) {
+        while (submitted < m_chunks.size() && submitted < k + maxInFlight) {
+            pool.start(new TraceDecodeTask(this, submitted));
+            submitted++;
+        }
+
+        QVector<DecodedRow> rows;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_chunks[k].done) {
+                m_chunkDone.wait(&m_mutex);
+            }
+            if (!m_chunks[k].ok) {
+                ok = false;
+                break;
+            }
+            rows.swap(m_chunks[k].rows);
+            m_framesDecoded += m_chunks[k].frames;
+        }
+
+        // 与上一段的剩余行归并（相同时间戳保持文件顺序）
+        merged.resize(pending.size() + rows.size());
+        std::merge(pending.constBegin(), pending.constEnd(), rows.constBegin(), rows.constEnd(),
+                   merged.begin(), rowEarlier);
+
+        DecodedRow bound;
+        bound.timestampUs = m_chunks[k].watermarkUs;
+        const DecodedRow *split = std::lower_bound(merged.constBegin(), merged.constEnd(),
+                                                   bound, rowEarlier);
+        const int emitCount = static_cast<int>(split - merged.constBegin());
+
+        if (!emitRows(sink, merged.constData(), emitCount)) {
+            ok = false;
+            break;
+        }
+
+        pending = merged.mid(emitCount);
+        m_maxPendingRows = qMax(m_maxPendingRows, static_cast<qint64>(pending.size()));
+    }
+
+    // 失败时等待在途任务结束，它们仍引用本对象
+    pool.waitForDone();
+
+    if (ok) {
+        ok = emitRows(sink, pending.constData(), pending.size());
+    }
+    if (!sink->finish() && ok) {
+        m_lastError = sink->getLastError();
+        ok = false;
+    }
+    return ok;
+}
+
+/***************************************************************
+ * 解码一段
+ ***************************************************************/
+void ParallelTraceDecoder::decodeChunk(int index)
+{
+    const int firstBlock = m_chunks.at(index).firstBlock;
+    const int blockCount = m_chunks.at(index).blockCount;
+    const qint64 fromUs = m_fromUs;
+    const qint64 toUs = m_toUs;
+    const CANDbcDatabase *dbc = m_dbc;
+
+    QVector<DecodedRow> rows;
+    qint64 frames = 0;
+    bool ok = true;
+
+    QFile file(m_tracePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        ok = false;
+    }
+
+    QByteArray buffer;
+    uchar padded[CAN_SIGNAL_MAX_PAYLOAD + CAN_SIGNAL_PAD_BYTES];
+    DecodedRow row;
+
+    for (int b = 0; b < blockCount && ok; b++) {
+        if (!CANTraceReader::readBlock(file, m_blocks.at(firstBlock + b), buffer)) {
+            ok = false;
+            break;
+        }
+
+        CANTraceReader::decodeBlock(buffer, [&](const CANTraceRecord &record) {
+            if (record.remote || record.timestampUs < fromUs || record.timestampUs > toUs) {
+                return true;
+            }
+            frames++;
+
+            // 8字节提取窗口需要余量，尾部补零
+            memcpy(padded, record.data, record.length);
+            memset(padded + record.length, 0, sizeof(padded) - record.length);
+
+            row.timestampUs = record.timestampUs;
+            dbc->decode(record.frameId, record.extended, padded, record.length,
+                        [&](int signalIndex, double value) {
+                row.signalIndex = static_cast<quint32>(signalIndex);
+                row.value = value;
+                rows.append(row);
+            });
+            return true;
+        });
+    }
+
+    // 块内记录按接收顺序写入，基本有序，稳定排序代价很小
+    std::stable_sort(rows.begin(), rows.end(), rowEarlier);
+
+    if (!ok) {
+        qWarning() << "[ParallelTraceDecoder] 段" << index << "读取失败:" << file.errorString();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Chunk &chunk = m_chunks[index];
+    chunk.rows.swap(rows);
+    chunk.frames = frames;
+    chunk.ok = ok;
+    chunk.done = true;
+    if (!ok) {
+        m_lastError = QString("读取段%1失败: %2").arg(index).arg(file.errorString());
+    }
+    m_chunkDone.wakeAll();
+}
+
+/***************************************************************
+ * 按批次写入输出
+ ***************************************************************/
+bool ParallelTraceDecoder::emitRows(TraceDecodeSink *sink, const DecodedRow *rows, int count)
+{
+    for (int offset = 0; offset < count; offset += DECODE_WRITE_BATCH) {
+        int batch = qMin(DECODE_WRITE_BATCH, count - offset);
+        if (!sink->write(rows + offset, batch)) {
+            m_lastError = sink->getLastError();
+            return false;
+        }
+        m_rowsWritten += batch;
+    }
+    return true;
+}
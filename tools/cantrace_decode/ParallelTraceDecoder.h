@@ -0,0 +1,123 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: ParallelTraceDecoder.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CAN抓包文件的多核离线解码
+ *
+ * 功能说明:
+ *   按抓包索引的检查点（块）把文件切成若干段，线程池中每个线程
+ *   用自己的文件句柄读取一段、按DBC规则解码（与设备端同一套
+ *   CANSignalExtractor），段内按时间排序；合并线程按段顺序取回
+ *   结果，与上一段的剩余行归并后，输出早于后续所有段最早时间戳
+ *   （水位）的行，保证输出严格按时间排序且内存只保留在途段。
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_TOOLS_PARALLEL_TRACE_DECODER_H
+#define IMX6ULL_TOOLS_PARALLEL_TRACE_DECODER_H
+
+#include "TraceDecodeSink.h"
+#include "drivers/can/CANTraceReader.h"
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+
+class TraceDecodeTask;
+
+/***************************************************************
+ * 类名: ParallelTraceDecoder
+ * 功能: 分段并行解码并按时间归并输出
+ *
+ * 使用示例:
+ *   ParallelTraceDecoder decoder(&dbc);
+ *   decoder.setThreadCount(QThread::idealThreadCount());
+ *   CsvDecodeSink sink;
+ *   decoder.run("can0.cantrace", "can0.csv", &sink);
+ ***************************************************************/
+class ParallelTraceDecoder
+{
+public:
+    explicit ParallelTraceDecoder(const CANDbcDatabase *dbc);
+
+    /**
+     * @brief 设置解码线程数（默认CPU核数）
+     */
+    void setThreadCount(int count);
+
+    /**
+     * @brief 设置每段的块数（0=按线程数自动划分）
+     */
+    void setChunkBlocks(int blocks);
+
+    /**
+     * @brief 只解码时间窗口内的帧
+     */
+    void setTimeRange(qint64 fromUs, qint64 toUs);
+
+    /**
+     * @brief 解码抓包文件并写入输出
+     * @return true=成功, false=失败（见getLastError）
+     */
+    bool run(const QString &tracePath, const QString &outputPath, TraceDecodeSink *sink);
+
+    QString getLastError() const { return m_lastError; }
+
+    // ========== 统计 ==========
+
+    int getChunkCount() const { return m_chunks.size(); }
+    qint64 getFramesDecoded() const { return m_framesDecoded; }
+    qint64 getRowsWritten() const { return m_rowsWritten; }
+    qint64 getMaxPendingRows() const { return m_maxPendingRows; }
+
+private:
+    friend class TraceDecodeTask;
+
+    /**
+     * @brief 一段的输入范围与解码结果
+     */
+    struct Chunk
+    {
+        int firstBlock;             // 起始块
+        int blockCount;             // 块数
+        qint64 watermarkUs;         // 之后所有段的最早时间戳
+        QVector<DecodedRow> rows;   // 解码结果（段内按时间排序）
+        qint64 frames;              // 解码的帧数
+        bool done;                  // 已完成
+        bool ok;                    // 成功
+    };
+
+    /**
+     * @brief 解码一段（线程池线程）
+     */
+    void decodeChunk(int index);
+
+    /**
+     * @brief 按输出批次写入
+     */
+    bool emitRows(TraceDecodeSink *sink, const DecodedRow *rows, int count);
+
+    const CANDbcDatabase *m_dbc;        // 解码规则（只读共享）
+    int m_threadCount;                  // 解码线程数
+    int m_chunkBlocks;                  // 每段块数
+    qint64 m_fromUs;                    // 时间窗口起点
+    qint64 m_toUs;                      // 时间窗口终点
+
+    QString m_tracePath;                // 抓包文件路径
+    QVector<CANTraceBlock> m_blocks;    // 参与解码的块
+    QVector<Chunk> m_chunks;            // 段
+
+    QMutex m_mutex;                     // 保护段完成状态
+    QWaitCondition m_chunkDone;         // 段完成通知
+
+    QString m_lastError;                // 最后错误
+    qint64 m_framesDecoded;             // 解码帧数
+    qint64 m_rowsWritten;               // 输出行数
+    qint64 m_maxPendingRows;            // 归并时滞留的最大行数
+};
+
+#endif // IMX6ULL_TOOLS_PARALLEL_TRACE_DECODER_H
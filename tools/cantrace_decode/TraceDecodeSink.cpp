@@ -0,0 +1,158 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: TraceDecodeSink.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 离线解码结果输出实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "TraceDecodeSink.h"
+#include <QtEndian>
+
+/***************************************************************
+ * CSV: 创建输出文件
+ ***************************************************************/
+bool CsvDecodeSink::begin(const QString &path, const CANDbcDatabase &dbc)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_lastError = QString("无法创建%1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+
+    // 报文名、信号名和单位在每行中重复，预先拼好
+    const QVector<CANDbcDatabase::Message> &messages = dbc.messages();
+    const QVector<CANDbcDatabase::Signal> &signalDefs = dbc.signalList();
+    m_prefixes.resize(signalDefs.size());
+    m_suffixes.resize(signalDefs.size());
+    for (int i = 0; i < signalDefs.size(); i++) {
+        const CANDbcDatabase::Signal &sig = signalDefs.at(i);
+        m_prefixes[i] = "," + messages.at(sig.message).name.toUtf8() + "," + sig.name.toUtf8() + ",";
+        m_suffixes[i] = "," + sig.unit.toUtf8() + "\n";
+    }
+
+    m_buffer.reserve(1024 * 1024);
+    m_buffer = "timestamp_us,message,signal,value,unit\n";
+    return true;
+}
+
+/***************************************************************
+ * CSV: 写入一批行
+ ***************************************************************/
+bool CsvDecodeSink::write(const DecodedRow *rows, int count)
+{
+    for (int i = 0; i < count; i++) {
+        const DecodedRow &row = rows[i];
+        m_buffer += QByteArray::number(row.timestampUs);
+        m_buffer += m_prefixes.at(static_cast<int>(row.signalIndex));
+        m_buffer += QByteArray::number(row.value, 'g', 12);
+        m_buffer += m_suffixes.at(static_cast<int>(row.signalIndex));
+
+        if (m_buffer.size() >= 1024 * 1024) {
+            if (m_file.write(m_buffer) != m_buffer.size()) {
+                m_lastError = QString("写入失败: %1").arg(m_file.errorString());
+                return false;
+            }
+            m_buffer.resize(0);
+        }
+    }
+    return true;
+}
+
+/***************************************************************
+ * CSV: 写完并关闭
+ ***************************************************************/
+bool CsvDecodeSink::finish()
+{
+    bool ok = m_file.write(m_buffer) == m_buffer.size();
+    m_buffer.clear();
+    if (!ok) {
+        m_lastError = QString("写入失败: %1").arg(m_file.errorString());
+    }
+    m_file.close();
+    return ok;
+}
+
+/***************************************************************
+ * 列式: 创建输出文件并写入信号表
+ ***************************************************************/
+bool ColumnarDecodeSink::begin(const QString &path, const CANDbcDatabase &dbc)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_lastError = QString("无法创建%1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+
+    const QVector<CANDbcDatabase::Message> &messages = dbc.messages();
+    const QVector<CANDbcDatabase::Signal> &signalDefs = dbc.signalList();
+
+    QByteArray header(16, '\0');
+    memcpy(header.data(), "CANCOLS1", 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(signalDefs.size()),
+                             reinterpret_cast<uchar *>(header.data()) + 8);
+
+    uchar length[2];
+    for (const CANDbcDatabase::Signal &sig : signalDefs) {
+        QByteArray name = (messages.at(sig.message).name + "." + sig.name).toUtf8();
+        QByteArray unit = sig.unit.toUtf8();
+        qToLittleEndian<quint16>(static_cast<quint16>(name.size()), length);
+        header.append(reinterpret_cast<const char *>(length), 2).append(name);
+        qToLittleEndian<quint16>(static_cast<quint16>(unit.size()), length);
+        header.append(reinterpret_cast<const char *>(length), 2).append(unit);
+    }
+
+    if (m_file.write(header) != header.size()) {
+        m_lastError = QString("写入失败: %1").arg(m_file.errorString());
+        return false;
+    }
+    return true;
+}
+
+/***************************************************************
+ * 列式: 一批行写为一个行组
+ ***************************************************************/
+bool ColumnarDecodeSink::write(const DecodedRow *rows, int count)
+{
+    if (count <= 0) {
+        return true;
+    }
+
+    m_buffer.resize(4 + count * (8 + 4 + 8));
+    uchar *p = reinterpret_cast<uchar *>(m_buffer.data());
+    qToLittleEndian<quint32>(static_cast<quint32>(count), p);
+
+    uchar *timestamps = p + 4;
+    uchar *indexes = timestamps + 8 * count;
+    uchar *values = indexes + 4 * count;
+    for (int i = 0; i < count; i++) {
+        quint64 bits;
+        memcpy(&bits, &rows[i].value, sizeof(bits));
+        qToLittleEndian<quint64>(static_cast<quint64>(rows[i].timestampUs), timestamps + 8 * i);
+        qToLittleEndian<quint32>(rows[i].signalIndex, indexes + 4 * i);
+        qToLittleEndian<quint64>(bits, values + 8 * i);
+    }
+
+    if (m_file.write(m_buffer) != m_buffer.size()) {
+        m_lastError = QString("写入失败: %1").arg(m_file.errorString());
+        return false;
+    }
+    return true;
+}
+
+/***************************************************************
+ * 列式: 关闭
+ ***************************************************************/
+bool ColumnarDecodeSink::finish()
+{
+    bool ok = m_file.flush();
+    if (!ok) {
+        m_lastError = QString("写入失败: %1").arg(m_file.errorString());
+    }
+    m_file.close();
+    return ok;
+}
@@ -0,0 +1,107 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: TraceDecodeSink.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 离线解码结果输出（CSV / 列式二进制）
+ *
+ * 功能说明:
+ *   解码结果按时间顺序分批写入输出文件:
+ *   - CSV: timestamp_us,message,signal,value,unit，每个信号值一行
+ *   - 列式二进制（*.cancol，小端）:
+ *       文件头16字节: magic(8)="CANCOLS1" signalCount(4) reserved(4)
+ *       信号表: 每个信号 nameLength(2) name(UTF-8, "报文.信号")
+ *                        unitLength(2) unit(UTF-8)
+ *       行组: rowCount(4) timestampUs(8*rowCount) signalIndex(4*rowCount)
+ *             value(8*rowCount, double)
+ *     每列连续存放，分析工具可只读取需要的列
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_TOOLS_TRACE_DECODE_SINK_H
+#define IMX6ULL_TOOLS_TRACE_DECODE_SINK_H
+
+#include "drivers/can/CANDbc.h"
+#include <QString>
+#include <QFile>
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief 一个解码后的信号值
+ */
+struct DecodedRow
+{
+    qint64 timestampUs;     // 帧时间戳
+    quint32 signalIndex;    // CANDbcDatabase::signalList()中的序号
+    double value;           // 物理值
+};
+
+/***************************************************************
+ * 类名: TraceDecodeSink
+ * 功能: 解码结果输出接口（只在合并线程中调用）
+ ***************************************************************/
+class TraceDecodeSink
+{
+public:
+    virtual ~TraceDecodeSink() {}
+
+    /**
+     * @brief 创建输出文件
+     */
+    virtual bool begin(const QString &path, const CANDbcDatabase &dbc) = 0;
+
+    /**
+     * @brief 写入一批按时间排序的行
+     */
+    virtual bool write(const DecodedRow *rows, int count) = 0;
+
+    /**
+     * @brief 写完并关闭
+     */
+    virtual bool finish() = 0;
+
+    QString getLastError() const { return m_lastError; }
+
+protected:
+    QString m_lastError;    // 最后错误
+};
+
+/***************************************************************
+ * 类名: CsvDecodeSink
+ * 功能: CSV输出
+ ***************************************************************/
+class CsvDecodeSink : public TraceDecodeSink
+{
+public:
+    bool begin(const QString &path, const CANDbcDatabase &dbc) override;
+    bool write(const DecodedRow *rows, int count) override;
+    bool finish() override;
+
+private:
+    QFile m_file;                       // 输出文件
+    QVector<QByteArray> m_prefixes;     // 每个信号的",报文,信号,"前缀
+    QVector<QByteArray> m_suffixes;     // 每个信号的",单位\n"后缀
+    QByteArray m_buffer;                // 格式化缓冲区
+};
+
+/***************************************************************
+ * 类名: ColumnarDecodeSink
+ * 功能: 列式二进制输出
+ ***************************************************************/
+class ColumnarDecodeSink : public TraceDecodeSink
+{
+public:
+    bool begin(const QString &path, const CANDbcDatabase &dbc) override;
+    bool write(const DecodedRow *rows, int count) override;
+    bool finish() override;
+
+private:
+    QFile m_file;                       // 输出文件
+    QByteArray m_buffer;                // 行组缓冲区
+};
+
+#endif // IMX6ULL_TOOLS_TRACE_DECODE_SINK_H
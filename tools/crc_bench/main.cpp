@@ -0,0 +1,205 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: main.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: CRC16/MODBUS各实现速度对比命令行工具
+ *
+ * 用法:
+ *   crc-bench [选项]
+ *     -m, --method <list>           实现列表（默认bitwise,table,slicing8,neon）
+ *     -s, --size <n,...>            帧长列表（默认8,64,256,4096）
+ *     -d, --duration <ms>           每项测试时长（默认500）
+ *     --csv <文件>                   同时输出CSV
+ *
+ *   先对各长度、各起始对齐的随机数据交叉校验所有实现与逐位实现的
+ *   结果，不一致时退出码为1；当前平台不可用的实现跳过。
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "drivers/serial/SerialCrc16.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+#include <stdio.h>
+
+static QList<int> parseList(const QString &text)
+{
+    QList<int> values;
+    const QStringList parts = text.split(',', QString::SkipEmptyParts);
+    for (const QString &part : parts) {
+        bool ok = false;
+        const int value = part.trimmed().toInt(&ok);
+        if (ok && value > 0) {
+            values.append(value);
+        }
+    }
+    return values;
+}
+
+static bool parseMethod(const QString &name, SerialCrc16::Method &method)
+{
+    const SerialCrc16::Method all[] = { SerialCrc16::Bitwise, SerialCrc16::Table,
+                                        SerialCrc16::Slicing8, SerialCrc16::Neon };
+    for (SerialCrc16::Method m : all) {
+        if (name.trimmed() == QLatin1String(SerialCrc16::methodName(m))) {
+            method = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+/***************************************************************
+ * 交叉校验: 所有长度0~maxSize、起始偏移0~7，与逐位实现比较
+ ***************************************************************/
+static int crossCheck(const QVector<SerialCrc16::Method> &methods, const QByteArray &data, int maxSize)
+{
+    int mismatches = 0;
+    for (int offset = 0; offset < 8; ++offset) {
+        for (int size = 0; size <= maxSize && offset + size <= data.size(); ++size) {
+            const char *p = data.constData() + offset;
+            const quint16 reference = SerialCrc16::modbusUpdate(SerialCrc16::ModbusInit, p, size,
+                                                                SerialCrc16::Bitwise);
+            for (SerialCrc16::Method method : methods) {
+                const quint16 crc = SerialCrc16::modbusUpdate(SerialCrc16::ModbusInit, p, size, method);
+                if (crc != reference) {
+                    if (mismatches < 10) {
+                        fprintf(stderr, "mismatch: %s size=%d offset=%d crc=%04X expected=%04X\n",
+                                SerialCrc16::methodName(method), size, offset, crc, reference);
+                    }
+                    ++mismatches;
+                }
+            }
+        }
+    }
+
+    // 增量接口: 分两段计算与一次计算相同
+    SerialCrc16 incremental;
+    const int half = qMin(maxSize, data.size()) / 2;
+    incremental.update(data.constData(), half);
+    incremental.update(data.constData() + half, half);
+    if (incremental.value() != SerialCrc16::modbus(data.constData(), half * 2)) {
+        fprintf(stderr, "mismatch: incremental update\n");
+        ++mismatches;
+    }
+
+    return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("crc-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("CRC16/MODBUS各实现速度对比");
+    parser.addHelpOption();
+
+    QCommandLineOption methodOption(QStringList() << "m" << "method", "实现: bitwise,table,slicing8,neon",
+                                    "list", "bitwise,table,slicing8,neon");
+    QCommandLineOption sizeOption(QStringList() << "s" << "size", "帧长列表", "list", "8,64,256,4096");
+    QCommandLineOption durationOption(QStringList() << "d" << "duration", "每项测试时长（毫秒）", "ms", "500");
+    QCommandLineOption csvOption("csv", "CSV输出文件", "file");
+    parser.addOption(methodOption);
+    parser.addOption(sizeOption);
+    parser.addOption(durationOption);
+    parser.addOption(csvOption);
+    parser.process(app);
+
+    QVector<SerialCrc16::Method> methods;
+    const QStringList names = parser.value(methodOption).split(',', QString::SkipEmptyParts);
+    for (const QString &name : names) {
+        SerialCrc16::Method method;
+        if (!parseMethod(name, method)) {
+            fprintf(stderr, "unknown method: %s\n", qPrintable(name));
+            return 2;
+        }
+        if (!SerialCrc16::isAvailable(method)) {
+            printf("%s: not available on this platform, skipped\n", SerialCrc16::methodName(method));
+            continue;
+        }
+        methods.append(method);
+    }
+
+    const QList<int> sizes = parseList(parser.value(sizeOption));
+    const qint64 durationNs = qMax(1, parser.value(durationOption).toInt()) * 1000000LL;
+    if (methods.isEmpty() || sizes.isEmpty()) {
+        fprintf(stderr, "nothing to run\n");
+        return 2;
+    }
+
+    int maxSize = 0;
+    for (int size : sizes) {
+        maxSize = qMax(maxSize, size);
+    }
+
+    // 固定种子的伪随机数据，多留8字节用于对齐偏移
+    QByteArray data(maxSize + 8, '\0');
+    quint32 seed = 0x12345678;
+    for (int i = 0; i < data.size(); ++i) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = static_cast<char>(seed >> 24);
+    }
+
+    const int mismatches = crossCheck(methods, data, qMin(maxSize, 1024));
+    printf("cross-check: %s (default method: %s)\n", mismatches ? "FAILED" : "ok",
+           SerialCrc16::methodName(SerialCrc16::defaultMethod()));
+
+    QFile csvFile;
+    QTextStream csv;
+    if (parser.isSet(csvOption)) {
+        csvFile.setFileName(parser.value(csvOption));
+        if (!csvFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            fprintf(stderr, "cannot open %s\n", qPrintable(csvFile.fileName()));
+            return 2;
+        }
+        csv.setDevice(&csvFile);
+        csv << "method,size,ns_per_frame,ns_per_byte,mb_per_s\n";
+    }
+
+    printf("%-10s %8s %14s %12s %10s\n", "method", "size", "ns/frame", "ns/byte", "MB/s");
+
+    volatile quint16 sink = 0;
+    for (int size : sizes) {
+        for (SerialCrc16::Method method : methods) {
+            // 预热（建表、缓存）
+            sink = sink ^ SerialCrc16::modbusUpdate(SerialCrc16::ModbusInit, data.constData(), size, method);
+
+            // 按块计时，块内次数随帧长调整，减少读时钟的开销
+            const int batch = qMax(1, 65536 / size);
+            qint64 frames = 0;
+            QElapsedTimer timer;
+            timer.start();
+            qint64 elapsed = 0;
+            quint16 crc = SerialCrc16::ModbusInit;
+            while (elapsed < durationNs) {
+                for (int i = 0; i < batch; ++i) {
+                    // 上一次结果参与下一次计算，避免被编译器合并
+                    crc = SerialCrc16::modbusUpdate(crc, data.constData(), size, method);
+                }
+                frames += batch;
+                elapsed = timer.nsecsElapsed();
+            }
+            sink = sink ^ crc;
+
+            const double nsPerFrame = static_cast<double>(elapsed) / frames;
+            const double nsPerByte = nsPerFrame / size;
+            const double mbPerSec = 1000.0 / nsPerByte;
+            printf("%-10s %8d %14.1f %12.3f %10.1f\n", SerialCrc16::methodName(method), size,
+                   nsPerFrame, nsPerByte, mbPerSec);
+            if (csvFile.isOpen()) {
+                csv << SerialCrc16::methodName(method) << ',' << size << ','
+                    << nsPerFrame << ',' << nsPerByte << ',' << mbPerSec << '\n';
+            }
+        }
+    }
+
+    return mismatches ? 1 : 0;
+}
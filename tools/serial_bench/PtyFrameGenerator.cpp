@@ -0,0 +1,230 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: PtyFrameGenerator.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 伪终端对 + 测试帧发生器实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "PtyFrameGenerator.h"
+#include "drivers/serial/SerialFramer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <sys/resource.h>
+
+static void putBigEndian(char *dst, quint64 value, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; --i) {
+        dst[i] = static_cast<char>(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+/***************************************************************
+ * 构造函数
+ ***************************************************************/
+PtyFrameGenerator::PtyFrameGenerator(QObject *parent)
+    : QThread(parent)
+    , m_masterFd(-1)
+    , m_frameSize(64)
+    , m_chunkSize(64)
+    , m_rate(0)
+    , m_durationMs(1000)
+    , m_running(0)
+    , m_framesSent(0)
+    , m_bytesSent(0)
+    , m_cpuUs(0)
+{
+}
+
+PtyFrameGenerator::~PtyFrameGenerator()
+{
+    stop();
+    wait();
+    closePty();
+}
+
+/***************************************************************
+ * 单调时钟（纳秒）
+ ***************************************************************/
+qint64 PtyFrameGenerator::monotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+/***************************************************************
+ * 打开伪终端对
+ ***************************************************************/
+bool PtyFrameGenerator::openPty()
+{
+    closePty();
+
+    m_masterFd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (m_masterFd < 0 || grantpt(m_masterFd) < 0 || unlockpt(m_masterFd) < 0) {
+        m_lastError = QString("创建伪终端失败: %1").arg(strerror(errno));
+        closePty();
+        return false;
+    }
+
+    const char *name = ptsname(m_masterFd);
+    if (!name) {
+        m_lastError = QString("ptsname失败: %1").arg(strerror(errno));
+        closePty();
+        return false;
+    }
+    m_slavePath = QString::fromLocal8Bit(name);
+
+    // 主端原始模式，发出的字节不做任何转换
+    struct termios tio;
+    if (tcgetattr(m_masterFd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(m_masterFd, TCSANOW, &tio);
+    }
+    return true;
+}
+
+void PtyFrameGenerator::closePty()
+{
+    if (m_masterFd >= 0) {
+        ::close(m_masterFd);
+        m_masterFd = -1;
+    }
+}
+
+void PtyFrameGenerator::configure(int frameSize, int chunkSize, int rate, int durationMs)
+{
+    m_frameSize = qBound(BENCH_FRAME_MIN_SIZE, frameSize, BENCH_FRAME_MAX_SIZE);
+    m_chunkSize = qMax(1, chunkSize);
+    m_rate = qMax(0, rate);
+    m_durationMs = qMax(1, durationMs);
+}
+
+/***************************************************************
+ * 写出全部数据（主端非阻塞，满时poll等待）
+ ***************************************************************/
+bool PtyFrameGenerator::writeAll(const char *data, int length)
+{
+    int offset = 0;
+    while (offset < length && m_running.load() != 0) {
+        const ssize_t n = ::write(m_masterFd, data + offset, static_cast<size_t>(length - offset));
+        if (n > 0) {
+            offset += static_cast<int>(n);
+            m_bytesSent += static_cast<quint64>(n);
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            m_lastError = QString("写伪终端失败: %1").arg(strerror(errno));
+            return false;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = m_masterFd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        poll(&pfd, 1, 100);
+    }
+    return offset == length;
+}
+
+/***************************************************************
+ * 发生器主循环
+ ***************************************************************/
+void PtyFrameGenerator::run()
+{
+    m_framesSent = 0;
+    m_bytesSent = 0;
+    m_running.store(1);
+
+    QByteArray frame(m_frameSize, '\0');
+    char *f = frame.data();
+    f[0] = static_cast<char>(0xA5);
+    f[1] = static_cast<char>(0x5A);
+    putBigEndian(f + 2, static_cast<quint64>(m_frameSize), 2);
+    for (int i = 16; i < m_frameSize - 2; ++i) {
+        f[i] = static_cast<char>(i);
+    }
+
+    // 尽可能快时多帧合并到一个写入块；定速时每帧立即写出
+    QByteArray pending;
+    pending.reserve(m_chunkSize + m_frameSize);
+
+    const qint64 start = monotonicNs();
+    const qint64 end = start + static_cast<qint64>(m_durationMs) * 1000000;
+    const qint64 interval = m_rate > 0 ? 1000000000LL / m_rate : 0;
+    qint64 next = start;
+    quint32 seq = 0;
+    bool failed = false;
+
+    while (m_running.load() != 0) {
+        qint64 now = monotonicNs();
+        if (now >= end) {
+            break;
+        }
+
+        if (interval > 0) {
+            if (now < next) {
+                struct timespec ts;
+                ts.tv_sec = next / 1000000000LL;
+                ts.tv_nsec = next % 1000000000LL;
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+            }
+            next += interval;
+            now = monotonicNs();
+        }
+
+        putBigEndian(f + 4, seq++, 4);
+        putBigEndian(f + 8, static_cast<quint64>(now), 8);
+        const quint16 crc = SerialFramer::crc16Modbus(f, m_frameSize - 2);
+        f[m_frameSize - 2] = static_cast<char>(crc & 0xFF);
+        f[m_frameSize - 1] = static_cast<char>(crc >> 8);
+        pending.append(frame);
+        m_framesSent++;
+
+        if (interval == 0 && pending.size() < m_chunkSize) {
+            continue;
+        }
+
+        // 按写入块大小切分写出
+        int offset = 0;
+        while (offset < pending.size()) {
+            const int len = qMin(m_chunkSize, pending.size() - offset);
+            if (interval == 0 && len < m_chunkSize) {
+                break;
+            }
+            if (!writeAll(pending.constData() + offset, len)) {
+                failed = true;
+                break;
+            }
+            offset += len;
+        }
+        pending.remove(0, offset);
+        if (failed) {
+            break;
+        }
+    }
+
+    // 时长到达后写出剩余不足一块的数据
+    if (!failed && !pending.isEmpty()) {
+        writeAll(pending.constData(), pending.size());
+    }
+    m_running.store(0);
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+        m_cpuUs = static_cast<qint64>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+                + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    }
+}
@@ -0,0 +1,96 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: PtyFrameGenerator.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 伪终端对 + 测试帧发生器
+ *
+ * 功能说明:
+ *   打开一对伪终端，主端由发生器线程写入带序号和发送时刻的测试帧，
+ *   从端路径交给DriverSerial打开，无需串口硬件。
+ *
+ * 帧格式（大端）:
+ *   [A5 5A][总长(2)][序号(4)][发送时刻ns(8)][填充...][CRC16 Modbus(2)]
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_TOOLS_PTY_FRAME_GENERATOR_H
+#define IMX6ULL_TOOLS_PTY_FRAME_GENERATOR_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QString>
+
+#define BENCH_FRAME_MIN_SIZE    18      // 帧头2 + 长度2 + 序号4 + 时刻8 + CRC2
+#define BENCH_FRAME_MAX_SIZE    65535
+
+/***************************************************************
+ * 类名: PtyFrameGenerator
+ * 功能: 在伪终端主端按指定速率、帧长、写入块大小发送测试帧
+ ***************************************************************/
+class PtyFrameGenerator : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit PtyFrameGenerator(QObject *parent = nullptr);
+    ~PtyFrameGenerator();
+
+    /**
+     * @brief 打开伪终端对
+     * @return true=成功；从端路径见getSlavePath()
+     */
+    bool openPty();
+    void closePty();
+
+    QString getSlavePath() const { return m_slavePath; }
+    QString getLastError() const { return m_lastError; }
+
+    /**
+     * @brief 设置发送参数（start()前调用）
+     * @param frameSize 帧长（字节）
+     * @param chunkSize 每次write()的字节数（帧会跨块拆分或多帧合并）
+     * @param rate 帧/秒，0=尽可能快
+     * @param durationMs 发送时长
+     */
+    void configure(int frameSize, int chunkSize, int rate, int durationMs);
+
+    void stop() { m_running.store(0); }
+
+    // ========== 结果（线程结束后读取） ==========
+
+    quint64 getFramesSent() const { return m_framesSent; }
+    quint64 getBytesSent() const { return m_bytesSent; }
+    qint64 getCpuUs() const { return m_cpuUs; }
+
+    /**
+     * @brief 单调时钟（纳秒），收发两端共用
+     */
+    static qint64 monotonicNs();
+
+protected:
+    void run() override;
+
+private:
+    bool writeAll(const char *data, int length);
+
+    int m_masterFd;
+    QString m_slavePath;
+    QString m_lastError;
+
+    int m_frameSize;
+    int m_chunkSize;
+    int m_rate;
+    int m_durationMs;
+    QAtomicInt m_running;
+
+    quint64 m_framesSent;
+    quint64 m_bytesSent;
+    qint64 m_cpuUs;                 // 发生器线程CPU时间（用于从进程CPU中扣除）
+};
+
+#endif // IMX6ULL_TOOLS_PTY_FRAME_GENERATOR_H
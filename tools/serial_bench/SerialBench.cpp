@@ -0,0 +1,199 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialBench.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: DriverSerial吞吐/延迟/CPU基准测试实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "SerialBench.h"
+#include "PtyFrameGenerator.h"
+#include <QEventLoop>
+#include <QTimer>
+#include <algorithm>
+
+#include <sys/resource.h>
+
+#define BENCH_DRAIN_TIMEOUT_MS  1000    // 发生器结束后等待收齐的最长时间
+
+static quint64 getBigEndian(const char *src, int bytes)
+{
+    quint64 value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | static_cast<quint8>(src[i]);
+    }
+    return value;
+}
+
+static qint64 processCpuUs()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return static_cast<qint64>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+         + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static qint64 percentile(const QVector<qint64> &sorted, double p)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    const int index = qBound(0, static_cast<int>(p * (sorted.size() - 1) + 0.5), sorted.size() - 1);
+    return sorted.at(index);
+}
+
+/***************************************************************
+ * 构造函数
+ ***************************************************************/
+SerialBench::SerialBench(QObject *parent)
+    : QObject(parent)
+    , m_processUs(0)
+    , m_expectedSeq(0)
+    , m_framesReceived(0)
+    , m_framesLost(0)
+    , m_bytesReceived(0)
+{
+}
+
+/***************************************************************
+ * 分帧回调：计算延迟、检查序号
+ ***************************************************************/
+void SerialBench::onFrame(const SerialFrameView &frame)
+{
+    const qint64 now = PtyFrameGenerator::monotonicNs();
+    if (frame.length < BENCH_FRAME_MIN_SIZE) {
+        return;
+    }
+
+    const quint32 seq = static_cast<quint32>(getBigEndian(frame.data + 4, 4));
+    const qint64 sentNs = static_cast<qint64>(getBigEndian(frame.data + 8, 8));
+
+    if (seq > m_expectedSeq) {
+        m_framesLost += seq - m_expectedSeq;
+    }
+    m_expectedSeq = seq + 1;
+    m_framesReceived++;
+    m_bytesReceived += static_cast<quint64>(frame.length);
+    m_latencies.append((now - sentNs) / 1000);
+
+    // 模拟上层处理耗时
+    if (m_processUs > 0) {
+        const qint64 until = now + static_cast<qint64>(m_processUs) * 1000;
+        while (PtyFrameGenerator::monotonicNs() < until) {
+        }
+    }
+}
+
+/***************************************************************
+ * 执行一轮测试
+ ***************************************************************/
+BenchResult SerialBench::run(const BenchConfig &config)
+{
+    BenchResult result;
+
+    m_processUs = config.processUs;
+    m_expectedSeq = 0;
+    m_framesReceived = 0;
+    m_framesLost = 0;
+    m_bytesReceived = 0;
+    m_latencies.clear();
+    if (config.rate > 0) {
+        m_latencies.reserve(static_cast<int>(qMin<qint64>(static_cast<qint64>(config.rate) * config.durationMs / 1000 + 16,
+                                                          16 * 1024 * 1024)));
+    }
+
+    PtyFrameGenerator generator;
+    if (!generator.openPty()) {
+        result.error = generator.getLastError();
+        return result;
+    }
+    generator.configure(config.frameSize, config.chunkSize, config.rate, config.durationMs);
+
+    DriverSerial serial(generator.getSlavePath());
+    serial.configure(115200);   // 伪终端不限速，波特率只影响I/O线程的默认字节间隔
+    serial.setReadBufferSize(config.readBufferSize);
+    if (config.ioThread) {
+        serial.setIoThreadEnabled(true, config.ioOptions);
+    }
+
+    SerialLengthPrefixFramer *framer = new SerialLengthPrefixFramer(QByteArray("\xA5\x5A", 2), 2, 2,
+                                                                    true, 0, BENCH_FRAME_MAX_SIZE);
+    framer->setCrc(SerialFramer::CrcModbus);
+    serial.setFramer(framer);
+    connect(&serial, &DriverSerial::frameReceived, this, &SerialBench::onFrame);
+
+    if (!serial.open(QIODevice::ReadWrite)) {
+        result.error = serial.getErrorString();
+        return result;
+    }
+
+    const qint64 cpuStart = processCpuUs();
+    const qint64 start = PtyFrameGenerator::monotonicNs();
+    qint64 generatorDone = 0;
+    qint64 lastReceiveNs = start;
+    quint64 lastReceived = 0;
+
+    // 发生器结束后等到收齐；持续无进展超过排空超时则结束（有丢帧）
+    QEventLoop loop;
+    QTimer poller;
+    poller.setInterval(10);
+    connect(&poller, &QTimer::timeout, [&]() {
+        const qint64 now = PtyFrameGenerator::monotonicNs();
+        if (m_framesReceived != lastReceived) {
+            lastReceived = m_framesReceived;
+            lastReceiveNs = now;
+        }
+        if (generatorDone == 0 && generator.isFinished()) {
+            generatorDone = now;
+        }
+        if (generatorDone != 0 &&
+            (m_framesReceived + m_framesLost >= generator.getFramesSent() ||
+             now - qMax(generatorDone, lastReceiveNs) > BENCH_DRAIN_TIMEOUT_MS * 1000000LL)) {
+            loop.quit();
+        }
+    });
+
+    generator.start();
+    poller.start();
+    loop.exec();
+    poller.stop();
+
+    const qint64 end = qMax(lastReceiveNs, start + 1);
+    const qint64 cpuUs = processCpuUs() - cpuStart - generator.getCpuUs();
+
+    result.framesSent = generator.getFramesSent();
+    result.framesReceived = m_framesReceived;
+    result.framesLost = m_framesLost + (result.framesSent - qMin(result.framesSent, m_framesReceived + m_framesLost));
+    result.bytesReceived = m_bytesReceived;
+    result.seconds = (end - start) / 1e9;
+    result.bytesPerSec = m_bytesReceived / result.seconds;
+    result.framesPerSec = m_framesReceived / result.seconds;
+
+    std::sort(m_latencies.begin(), m_latencies.end());
+    result.latencyP50Us = percentile(m_latencies, 0.50);
+    result.latencyP90Us = percentile(m_latencies, 0.90);
+    result.latencyP99Us = percentile(m_latencies, 0.99);
+    result.latencyP999Us = percentile(m_latencies, 0.999);
+    result.latencyMaxUs = m_latencies.isEmpty() ? 0 : m_latencies.last();
+
+    result.crcErrors = framer->getCrcErrorCount();
+    result.discardedBytes = framer->getDiscardedBytes();
+    result.readOverflows = serial.getReadOverflowCount();
+    if (serial.getIoThread()) {
+        result.stageDroppedBytes = serial.getIoThread()->getStageDroppedBytes();
+    }
+
+    result.cpuMs = qMax<qint64>(0, cpuUs) / 1000.0;
+    result.cpuPercent = result.cpuMs / (result.seconds * 1000.0) * 100.0;
+
+    serial.close();
+    generator.closePty();
+    result.ok = true;
+    return result;
+}
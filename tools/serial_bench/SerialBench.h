@@ -0,0 +1,118 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: SerialBench.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: DriverSerial吞吐/延迟/CPU基准测试
+ *
+ * 功能说明:
+ *   每轮测试打开一对伪终端，发生器线程在主端发送测试帧，
+ *   DriverSerial在从端接收并用长度前缀分帧器（CRC16）取帧，
+ *   统计:
+ *   - 吞吐（字节/秒、帧/秒）
+ *   - 单帧延迟百分位（发生器写出前取时刻，分帧回调中取时刻）
+ *   - 丢帧（序号不连续）、CRC错误、读缓冲区/暂存区溢出
+ *   - 接收侧CPU时间（进程CPU减去发生器线程CPU）
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_TOOLS_SERIAL_BENCH_H
+#define IMX6ULL_TOOLS_SERIAL_BENCH_H
+
+#include "drivers/serial/DriverSerial.h"
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 单轮测试参数
+ */
+struct BenchConfig
+{
+    bool ioThread;              // true=独立I/O线程后端, false=QSerialPort后端
+    int frameSize;              // 帧长
+    int chunkSize;              // 发生器每次写入字节数
+    int rate;                   // 帧/秒（0=尽可能快）
+    int durationMs;             // 发送时长
+    int readBufferSize;         // DriverSerial读缓冲区大小
+    int processUs;              // 每帧模拟处理耗时（忙等，用于制造积压）
+    SerialIoOptions ioOptions;  // I/O线程参数
+
+    BenchConfig()
+        : ioThread(false), frameSize(64), chunkSize(64), rate(0)
+        , durationMs(2000), readBufferSize(65536), processUs(0)
+    {
+    }
+};
+
+/**
+ * @brief 单轮测试结果
+ */
+struct BenchResult
+{
+    bool ok;
+    QString error;
+
+    quint64 framesSent;
+    quint64 framesReceived;
+    quint64 framesLost;
+    quint64 bytesReceived;
+    double seconds;             // 从开始发送到收齐（或排空超时）的时间
+    double bytesPerSec;
+    double framesPerSec;
+
+    qint64 latencyP50Us;
+    qint64 latencyP90Us;
+    qint64 latencyP99Us;
+    qint64 latencyP999Us;
+    qint64 latencyMaxUs;
+
+    quint64 crcErrors;
+    quint64 discardedBytes;
+    quint64 readOverflows;      // 读缓冲区溢出次数
+    quint64 stageDroppedBytes;  // I/O线程暂存区丢弃字节数
+
+    double cpuMs;               // 接收侧CPU时间
+    double cpuPercent;          // 接收侧CPU占用（相对单核）
+
+    BenchResult()
+        : ok(false), framesSent(0), framesReceived(0), framesLost(0), bytesReceived(0)
+        , seconds(0), bytesPerSec(0), framesPerSec(0)
+        , latencyP50Us(0), latencyP90Us(0), latencyP99Us(0), latencyP999Us(0), latencyMaxUs(0)
+        , crcErrors(0), discardedBytes(0), readOverflows(0), stageDroppedBytes(0)
+        , cpuMs(0), cpuPercent(0)
+    {
+    }
+};
+
+/***************************************************************
+ * 类名: SerialBench
+ * 功能: 执行单轮测试
+ ***************************************************************/
+class SerialBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SerialBench(QObject *parent = nullptr);
+
+    /**
+     * @brief 执行一轮测试（内部运行事件循环直到收齐或超时）
+     */
+    BenchResult run(const BenchConfig &config);
+
+private:
+    void onFrame(const SerialFrameView &frame);
+
+    int m_processUs;
+    quint32 m_expectedSeq;
+    quint64 m_framesReceived;
+    quint64 m_framesLost;
+    quint64 m_bytesReceived;
+    QVector<qint64> m_latencies;    // 微秒
+};
+
+#endif // IMX6ULL_TOOLS_SERIAL_BENCH_H
@@ -0,0 +1,218 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: TraceExportSink.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口抓包导出实现
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "TraceExportSink.h"
+#include "drivers/serial/SerialTraceFormat.h"
+#include <QDateTime>
+
+#define PCAPNG_BLOCK_SHB        0x0A0D0D0A
+#define PCAPNG_BLOCK_IDB        0x00000001
+#define PCAPNG_BLOCK_EPB        0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define PCAPNG_LINKTYPE_USER0   147
+
+#define PCAPNG_OPT_END          0
+#define PCAPNG_OPT_IF_NAME      2
+#define PCAPNG_OPT_IF_DESC      3
+#define PCAPNG_OPT_IF_TSRESOL   9
+#define PCAPNG_OPT_EPB_FLAGS    2
+
+#define PCAPNG_FLAG_INBOUND     0x1
+#define PCAPNG_FLAG_OUTBOUND    0x2
+
+static void appendLe16(QByteArray &out, quint16 value)
+{
+    uchar buf[2];
+    qToLittleEndian<quint16>(value, buf);
+    out.append(reinterpret_cast<const char *>(buf), sizeof(buf));
+}
+
+static void appendLe32(QByteArray &out, quint32 value)
+{
+    uchar buf[4];
+    qToLittleEndian<quint32>(value, buf);
+    out.append(reinterpret_cast<const char *>(buf), sizeof(buf));
+}
+
+static void appendPadding(QByteArray &out)
+{
+    while (out.size() % 4 != 0) {
+        out.append('\0');
+    }
+}
+
+/***************************************************************
+ * 写完并关闭
+ ***************************************************************/
+bool TraceExportSink::finish()
+{
+    if (!flushBuffer(true)) {
+        return false;
+    }
+    m_file.close();
+    return true;
+}
+
+/***************************************************************
+ * 缓冲区超过1MB或强制时写入文件
+ ***************************************************************/
+bool TraceExportSink::flushBuffer(bool force)
+{
+    if (m_buffer.isEmpty() || (!force && m_buffer.size() < 1024 * 1024)) {
+        return true;
+    }
+    if (m_file.write(m_buffer) != m_buffer.size()) {
+        m_lastError = QString("写入失败: %1").arg(m_file.errorString());
+        return false;
+    }
+    m_buffer.resize(0);
+    return true;
+}
+
+TextExportSink::TextExportSink()
+    : m_lastWallUs(-1)
+{
+}
+
+/***************************************************************
+ * 文本: 创建输出文件
+ ***************************************************************/
+bool TextExportSink::begin(const QString &path, const QString &portName, qint32 baudRate)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_lastError = QString("无法创建%1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+
+    m_buffer.reserve(1024 * 1024);
+    m_buffer = QString("# %1 %2bps\n").arg(portName).arg(baudRate).toUtf8();
+    m_lastWallUs = -1;
+    return true;
+}
+
+/***************************************************************
+ * 文本: 写入一个数据块
+ ***************************************************************/
+bool TextExportSink::write(const ExportChunk &chunk)
+{
+    const QDateTime time = QDateTime::fromMSecsSinceEpoch(chunk.wallUs / 1000, Qt::UTC);
+    m_buffer += time.toString("yyyy-MM-dd HH:mm:ss.zzz").toLatin1();
+    m_buffer += QByteArray::number(chunk.wallUs % 1000).rightJustified(3, '0');
+
+    const qint64 delta = (m_lastWallUs < 0) ? 0 : chunk.wallUs - m_lastWallUs;
+    m_lastWallUs = chunk.wallUs;
+    m_buffer += QString(" %1%2.%3 ")
+                .arg(delta < 0 ? '-' : '+')
+                .arg(qAbs(delta) / 1000000)
+                .arg(qAbs(delta) % 1000000, 6, 10, QChar('0'))
+                .toLatin1();
+
+    m_buffer += (chunk.direction == SERIAL_TRACE_DIR_TX) ? "TX " : "RX ";
+    m_buffer += QByteArray::number(chunk.data.size()).rightJustified(4, ' ');
+    m_buffer += ' ';
+    m_buffer += chunk.data.toHex(' ').toUpper();
+    if (chunk.dropped) {
+        m_buffer += "  [此前有记录丢弃]";
+    }
+    m_buffer += '\n';
+
+    return flushBuffer(false);
+}
+
+/***************************************************************
+ * pcapng: 追加一个选项
+ ***************************************************************/
+void PcapngExportSink::appendOption(QByteArray &block, quint16 code, const QByteArray &value)
+{
+    appendLe16(block, code);
+    appendLe16(block, static_cast<quint16>(value.size()));
+    block += value;
+    appendPadding(block);
+}
+
+/***************************************************************
+ * pcapng: 追加一个块（类型 + 长度 + 内容 + 长度）
+ ***************************************************************/
+void PcapngExportSink::appendBlock(quint32 type, const QByteArray &body)
+{
+    const quint32 totalLength = static_cast<quint32>(12 + ((body.size() + 3) & ~3));
+    appendLe32(m_buffer, type);
+    appendLe32(m_buffer, totalLength);
+    m_buffer += body;
+    appendPadding(m_buffer);
+    appendLe32(m_buffer, totalLength);
+}
+
+/***************************************************************
+ * pcapng: 创建输出文件，写入节头和接口描述
+ ***************************************************************/
+bool PcapngExportSink::begin(const QString &path, const QString &portName, qint32 baudRate)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_lastError = QString("无法创建%1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+    m_buffer.reserve(1024 * 1024);
+    m_buffer.resize(0);
+
+    // 节头: 字节序标识、版本1.0、节长度未知(-1)
+    QByteArray shb;
+    appendLe32(shb, PCAPNG_BYTE_ORDER_MAGIC);
+    appendLe16(shb, 1);
+    appendLe16(shb, 0);
+    appendLe32(shb, 0xFFFFFFFF);
+    appendLe32(shb, 0xFFFFFFFF);
+    appendBlock(PCAPNG_BLOCK_SHB, shb);
+
+    // 接口描述: 每个串口一个接口，时间精度微秒
+    QByteArray idb;
+    appendLe16(idb, PCAPNG_LINKTYPE_USER0);
+    appendLe16(idb, 0);
+    appendLe32(idb, 0);
+    appendOption(idb, PCAPNG_OPT_IF_NAME, portName.toUtf8());
+    appendOption(idb, PCAPNG_OPT_IF_DESC, QString("%1bps").arg(baudRate).toUtf8());
+    appendOption(idb, PCAPNG_OPT_IF_TSRESOL, QByteArray(1, 6));
+    appendLe32(idb, PCAPNG_OPT_END);
+    appendBlock(PCAPNG_BLOCK_IDB, idb);
+
+    return flushBuffer(false);
+}
+
+/***************************************************************
+ * pcapng: 写入一个增强分组块
+ ***************************************************************/
+bool PcapngExportSink::write(const ExportChunk &chunk)
+{
+    const quint64 ts = static_cast<quint64>(chunk.wallUs);
+    const quint32 length = static_cast<quint32>(chunk.data.size());
+
+    QByteArray epb;
+    epb.reserve(static_cast<int>(length) + 40);
+    appendLe32(epb, 0);                                     // 接口0
+    appendLe32(epb, static_cast<quint32>(ts >> 32));
+    appendLe32(epb, static_cast<quint32>(ts & 0xFFFFFFFF));
+    appendLe32(epb, length);                                // 捕获长度
+    appendLe32(epb, length);                                // 原始长度
+    epb += chunk.data;
+    appendPadding(epb);
+
+    QByteArray flags;
+    appendLe32(flags, (chunk.direction == SERIAL_TRACE_DIR_TX) ? PCAPNG_FLAG_OUTBOUND
+                                                               : PCAPNG_FLAG_INBOUND);
+    appendOption(epb, PCAPNG_OPT_EPB_FLAGS, flags);
+    appendLe32(epb, PCAPNG_OPT_END);
+    appendBlock(PCAPNG_BLOCK_EPB, epb);
+
+    return flushBuffer(false);
+}
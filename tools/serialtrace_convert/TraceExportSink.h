@@ -0,0 +1,107 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: TraceExportSink.h
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口抓包导出（文本 / pcapng）
+ *
+ * 功能说明:
+ *   - 文本: 每个数据块一行
+ *       2026-10-18 08:00:00.123456 +0.001250 TX   8 01 03 00 00 00 02 C4 0B
+ *     时间为UTC，+后为与上一行的间隔（秒），有记录被丢弃时行尾标注
+ *   - pcapng: 链路类型LINKTYPE_USER0(147)，方向写入epb_flags
+ *     （接收=inbound，发送=outbound）。Wireshark中把USER0映射到
+ *     mbrtu等解析器即可按协议查看
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#ifndef IMX6ULL_TOOLS_TRACE_EXPORT_SINK_H
+#define IMX6ULL_TOOLS_TRACE_EXPORT_SINK_H
+
+#include <QString>
+#include <QFile>
+#include <QByteArray>
+
+/**
+ * @brief 一个导出的数据块（合并后的一次收发）
+ */
+struct ExportChunk
+{
+    qint64 wallUs;          // UTC时间（微秒）
+    quint8 direction;       // SERIAL_TRACE_DIR_*
+    bool dropped;           // 之前有记录被丢弃
+    QByteArray data;        // 数据
+};
+
+/***************************************************************
+ * 类名: TraceExportSink
+ * 功能: 导出输出接口
+ ***************************************************************/
+class TraceExportSink
+{
+public:
+    virtual ~TraceExportSink() {}
+
+    /**
+     * @brief 创建输出文件
+     */
+    virtual bool begin(const QString &path, const QString &portName, qint32 baudRate) = 0;
+
+    /**
+     * @brief 写入一个数据块（按时间顺序调用）
+     */
+    virtual bool write(const ExportChunk &chunk) = 0;
+
+    /**
+     * @brief 写完并关闭
+     */
+    virtual bool finish();
+
+    QString getLastError() const { return m_lastError; }
+
+protected:
+    /**
+     * @brief 缓冲区超过1MB时写入文件
+     */
+    bool flushBuffer(bool force);
+
+    QString m_lastError;    // 最后错误
+    QFile m_file;           // 输出文件
+    QByteArray m_buffer;    // 写缓冲区
+};
+
+/***************************************************************
+ * 类名: TextExportSink
+ * 功能: 文本输出
+ ***************************************************************/
+class TextExportSink : public TraceExportSink
+{
+public:
+    TextExportSink();
+
+    bool begin(const QString &path, const QString &portName, qint32 baudRate) override;
+    bool write(const ExportChunk &chunk) override;
+
+private:
+    qint64 m_lastWallUs;    // 上一行时间，-1表示第一行
+};
+
+/***************************************************************
+ * 类名: PcapngExportSink
+ * 功能: pcapng输出
+ ***************************************************************/
+class PcapngExportSink : public TraceExportSink
+{
+public:
+    bool begin(const QString &path, const QString &portName, qint32 baudRate) override;
+    bool write(const ExportChunk &chunk) override;
+
+private:
+    void appendOption(QByteArray &block, quint16 code, const QByteArray &value);
+    void appendBlock(quint32 type, const QByteArray &body);
+};
+
+#endif // IMX6ULL_TOOLS_TRACE_EXPORT_SINK_H
@@ -0,0 +1,135 @@
+/***************************************************************
+ * Copyright: Alex
+ * FileName: main.cpp
+ * Author: Alex
+ * Version: 1.0
+ * Date: 2026-10-18
+ * Description: 串口抓包转换命令行工具（主机端）
+ *
+ * 用法:
+ *   serialtrace-convert [选项] <抓包文件> <输出文件>
+ *     -f, --format <text|pcap>  输出格式（默认按输出文件扩展名，.pcapng/.pcap为pcapng）
+ *     --merge-gap-us <us>       同方向、间隔小于该值的数据块合并为一帧
+ *                               （默认按波特率取3.5个字符时间，0=只合并分片）
+ *
+ *   串口驱动每次读到多少字节就记录多少，一帧Modbus RTU常被拆成
+ *   几次读取；按帧间隔合并后Wireshark的mbrtu解析器才能看到整帧。
+ *
+ * History:
+ *   1. 2026-10-18 创建文件
+ ***************************************************************/
+
+#include "TraceExportSink.h"
+#include "drivers/serial/SerialTraceReader.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QScopedPointer>
+#include <QDebug>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("serialtrace-convert");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("把串口抓包文件转换为文本或pcapng");
+    parser.addHelpOption();
+    parser.addPositionalArgument("trace", "抓包文件（*.sertrace）");
+    parser.addPositionalArgument("output", "输出文件（.txt / .pcapng）");
+
+    QCommandLineOption formatOption(QStringList() << "f" << "format", "输出格式: text / pcap", "format");
+    QCommandLineOption gapOption("merge-gap-us", "合并间隔（微秒，默认3.5个字符时间）", "us");
+    parser.addOption(formatOption);
+    parser.addOption(gapOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 2) {
+        parser.showHelp(1);
+    }
+
+    QString format = parser.value(formatOption).toLower();
+    if (format.isEmpty()) {
+        format = (args.at(1).endsWith(".pcapng", Qt::CaseInsensitive) ||
+                  args.at(1).endsWith(".pcap", Qt::CaseInsensitive)) ? "pcap" : "text";
+    }
+    QScopedPointer<TraceExportSink> sink;
+    if (format == "text" || format == "txt") {
+        sink.reset(new TextExportSink);
+    } else if (format == "pcap" || format == "pcapng") {
+        sink.reset(new PcapngExportSink);
+    } else {
+        qCritical() << "[TraceConvert] 不支持的输出格式:" << format;
+        return 1;
+    }
+
+    SerialTraceReader reader;
+    if (!reader.open(args.at(0))) {
+        qCritical() << "[TraceConvert] 打开抓包文件失败:" << reader.getLastError();
+        return 1;
+    }
+
+    // 默认合并间隔: 3.5个字符（按11位/字符），与Modbus RTU帧间隔一致
+    qint64 mergeGapUs = 0;
+    if (parser.isSet(gapOption)) {
+        mergeGapUs = parser.value(gapOption).toLongLong();
+    } else if (reader.getBaudRate() > 0) {
+        mergeGapUs = 11LL * 1000000 * 35 / 10 / reader.getBaudRate();
+    }
+
+    if (!sink->begin(args.at(1), reader.getPortName(), reader.getBaudRate())) {
+        qCritical() << "[TraceConvert]" << sink->getLastError();
+        return 1;
+    }
+
+    ExportChunk pending;
+    bool hasPending = false;
+    qint64 lastUs = 0;
+    qint64 chunks = 0;
+    bool failed = false;
+
+    auto flushPending = [&]() -> bool {
+        if (!hasPending) {
+            return true;
+        }
+        hasPending = false;
+        chunks++;
+        return sink->write(pending);
+    };
+
+    const qint64 records = reader.forEach([&](const SerialTraceRecord &record) {
+        // 分片总是并入前一块；其他记录同方向且间隔足够小才合并，丢弃标志处断开
+        const bool merge = hasPending && record.direction == pending.direction &&
+                           !(record.flags & SERIAL_TRACE_FLAG_DROPPED) &&
+                           ((record.flags & SERIAL_TRACE_FLAG_CONTINUATION) ||
+                            record.timestampUs - lastUs < mergeGapUs);
+        if (!merge) {
+            if (!flushPending()) {
+                failed = true;
+                return false;
+            }
+            pending.wallUs = record.wallUs;
+            pending.direction = record.direction;
+            pending.dropped = (record.flags & SERIAL_TRACE_FLAG_DROPPED) != 0;
+            pending.data.resize(0);
+            hasPending = true;
+        }
+        pending.data.append(reinterpret_cast<const char *>(record.data), record.length);
+        lastUs = record.timestampUs;
+        return true;
+    });
+
+    if (records < 0) {
+        qCritical() << "[TraceConvert] 读取失败:" << reader.getLastError();
+        return 1;
+    }
+    if (failed || !flushPending() || !sink->finish()) {
+        qCritical() << "[TraceConvert]" << sink->getLastError();
+        return 1;
+    }
+
+    qInfo() << "[TraceConvert] 完成:" << records << "条记录," << chunks << "个数据块,"
+            << reader.getUsedBlocks() << "个块," << reader.getCorruptBlocks() << "个损坏块,"
+            << "合并间隔" << mergeGapUs << "us";
+    return 0;
+}